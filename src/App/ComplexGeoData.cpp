@@ -25,8 +25,14 @@
 
 #ifndef _PreComp_
 # include <cstdlib>
+# include <cstring>
+# include <algorithm>
 #endif
 
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/bimap.hpp>
 #include <boost/bimap/multiset_of.hpp>
@@ -35,6 +41,8 @@
 #include <Base/Reader.h>
 #include <Base/Exception.h>
 #include <Base/Console.h>
+#include <Base/Stream.h>
+#include "Application.h"
 #include "ComplexGeoData.h"
 
 FC_LOG_LEVEL_INIT("ComplexGeoData", true,true);
@@ -42,11 +50,609 @@ FC_LOG_LEVEL_INIT("ComplexGeoData", true,true);
 using namespace Data;
 
 namespace Data {
-typedef boost::bimap<
-            boost::bimaps::set_of<std::string>,
-            boost::bimaps::multiset_of<std::string>,
-            boost::bimaps::with_info<std::vector<App::StringIDRef> > > ElementMapBase;
-class ElementMap: public ElementMapBase {};
+
+/** Storage of the element map
+ *
+ * The map is from a unique mapped name to an element name, e.g. Face1. An
+ * element may have more than one mapped names. There are two
+ * implementations. The default one uses boost::bimap with std::string keys.
+ * The flat one (see FlatElementMap) is selected by parameter
+ * 'FlatElementMap' in Preferences/Document at the time a new map is created.
+ */
+class ElementMap {
+public:
+    typedef std::function<void(const char *name, const char *element,
+                               const App::StringIDRef *sids, std::size_t count)> Visitor;
+
+    virtual ~ElementMap() {}
+
+    /// Create an element map using the current preferred storage
+    static ElementMapPtr create();
+
+    /// Return the number of mapped names
+    virtual std::size_t size() const = 0;
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /// Find the element of a mapped name, or return 0 if not found
+    virtual const char *findElement(const char *name,
+                                    std::vector<App::StringIDRef> *sids) const = 0;
+
+    /// Find the first mapped name of an element, or return 0 if not found
+    virtual const char *findName(const char *element,
+                                 std::vector<App::StringIDRef> *sids) const = 0;
+
+    /// Visit all mapped names of an element in the order of insertion
+    virtual void visitNames(const char *element, const Visitor &visitor) const = 0;
+
+    /** Add a new mapping
+     *
+     * @return Return the stored name and element. If the name is already
+     * mapped, the existing mapping is returned with \c inserted set to false.
+     */
+    virtual std::pair<const char*, const char*> insert(const char *name, const char *element,
+            const std::vector<App::StringIDRef> &sids, bool &inserted) = 0;
+
+    /// Remove a mapped name
+    virtual void eraseName(const char *name) = 0;
+
+    /// Remove all mapped names of an element
+    virtual void eraseElement(const char *element) = 0;
+
+    /// Visit the mapping sorted by mapped name, optionally with a name prefix
+    virtual void visitByName(const Visitor &visitor, const char *prefix=0) const = 0;
+
+    /// Visit the mapping sorted by element name, and then by insertion order
+    virtual void visitByElement(const Visitor &visitor) const = 0;
+
+    /// Return the estimated memory usage in bytes
+    virtual std::size_t getMemSize() const = 0;
+};
+
+} // namespace Data
+
+namespace {
+
+std::size_t stringMemSize(const std::string &s) {
+    // Assume short strings are stored inside the string object
+    return s.capacity() >= sizeof(std::string) ? s.capacity() + 1 : 0;
+}
+
+class BimapElementMap: public ElementMap {
+public:
+    typedef boost::bimap<
+                boost::bimaps::set_of<std::string>,
+                boost::bimaps::multiset_of<std::string>,
+                boost::bimaps::with_info<std::vector<App::StringIDRef> > > Map;
+
+    virtual std::size_t size() const override {
+        return map.size();
+    }
+
+    virtual const char *findElement(const char *name,
+                                    std::vector<App::StringIDRef> *sids) const override
+    {
+        auto it = map.left.find(name);
+        if(it == map.left.end())
+            return 0;
+        if(sids) sids->insert(sids->end(),it->info.begin(),it->info.end());
+        return it->second.c_str();
+    }
+
+    virtual const char *findName(const char *element,
+                                 std::vector<App::StringIDRef> *sids) const override
+    {
+        auto it = map.right.find(element);
+        if(it == map.right.end())
+            return 0;
+        if(sids) sids->insert(sids->end(),it->info.begin(),it->info.end());
+        return it->second.c_str();
+    }
+
+    virtual void visitNames(const char *element, const Visitor &visitor) const override {
+        auto range = map.right.equal_range(element);
+        for(auto it=range.first;it!=range.second;++it)
+            visitor(it->second.c_str(),it->first.c_str(),it->info.data(),it->info.size());
+    }
+
+    virtual std::pair<const char*, const char*> insert(const char *name, const char *element,
+            const std::vector<App::StringIDRef> &sids, bool &inserted) override
+    {
+        auto ret = map.left.insert(Map::left_map::value_type(name,element,sids));
+        inserted = ret.second;
+        return std::make_pair(ret.first->first.c_str(), ret.first->second.c_str());
+    }
+
+    virtual void eraseName(const char *name) override {
+        map.left.erase(name);
+    }
+
+    virtual void eraseElement(const char *element) override {
+        map.right.erase(element);
+    }
+
+    virtual void visitByName(const Visitor &visitor, const char *prefix) const override {
+        auto it = prefix ? map.left.lower_bound(prefix) : map.left.begin();
+        for(;it!=map.left.end();++it) {
+            if(prefix && !boost::starts_with(it->first,prefix))
+                break;
+            visitor(it->first.c_str(),it->second.c_str(),it->info.data(),it->info.size());
+        }
+    }
+
+    virtual void visitByElement(const Visitor &visitor) const override {
+        for(auto &v : map.right)
+            visitor(v.second.c_str(),v.first.c_str(),v.info.data(),v.info.size());
+    }
+
+    virtual std::size_t getMemSize() const override {
+        std::size_t size = sizeof(*this);
+        for(auto &v : map.left) {
+            // one node holding both keys and the ID vector, linked in two trees
+            size += 2*sizeof(std::string) + stringMemSize(v.first) + stringMemSize(v.second)
+                  + sizeof(v.info) + v.info.capacity()*sizeof(App::StringIDRef)
+                  + 6*sizeof(void*);
+        }
+        return size;
+    }
+
+private:
+    Map map;
+};
+
+const uint32_t FlatNoEntry = 0xffffffff;
+const uint32_t FlatTombstone = 0xfffffffe;
+const uint32_t FlatOtherType = 0xffffffff;
+const uint32_t FlatMaxIndex = 1<<20;
+const std::size_t FlatChunkSize = 16*1024;
+
+// Split an element name, e.g. Face12, into type length and index
+bool splitElementName(const char *element, std::size_t &len, int &index) {
+    const char *c = element;
+    for(;*c && !std::isdigit((unsigned char)*c);++c);
+    if(c==element || *c<'1' || *c>'9')
+        return false;
+    uint32_t value = 0;
+    for(const char *d=c;*d;++d) {
+        if(!std::isdigit((unsigned char)*d))
+            return false;
+        value = value*10 + (*d - '0');
+        if(value >= FlatMaxIndex)
+            return false;
+    }
+    len = c - element;
+    index = (int)value;
+    return true;
+}
+
+/** Flat element map storage
+ *
+ * All names are interned in a chunked string pool owned by the map. Each
+ * mapping is a fixed size entry in a single array, and the string IDs of all
+ * entries are kept in another array. Mapped names are looked up through an
+ * open addressing hash table of entry indices.
+ *
+ * The element side is decomposed into element type and index, e.g. Face12,
+ * and kept in a contiguous array per element type indexed by the element
+ * index. Each slot links the entries of the same element in insertion order.
+ * Elements not in the form of non-digit type plus index (or with index
+ * exceeding FlatMaxIndex) are kept in a separate hash map.
+ *
+ * Erased entries are only unlinked, because erasing is rare in practice.
+ * Their storage is reclaimed once the map is released.
+ *
+ * Visiting by name uses an array of entry indices sorted by mapped name. It
+ * is rebuilt on the first visit after the map is changed, so that a prefix
+ * query is a binary search into it.
+ */
+class FlatElementMap: public ElementMap {
+public:
+    virtual std::size_t size() const override {
+        return _count;
+    }
+
+    virtual const char *findElement(const char *name,
+                                    std::vector<App::StringIDRef> *sids) const override
+    {
+        std::size_t len;
+        std::size_t pos = findPosition(name,hashName(name,len));
+        if(pos == std::string::npos)
+            return 0;
+        const auto &entry = _entries[_table[pos]];
+        if(sids) appendIDs(entry,*sids);
+        return entry.element;
+    }
+
+    virtual const char *findName(const char *element,
+                                 std::vector<App::StringIDRef> *sids) const override
+    {
+        auto slot = findSlot(element);
+        if(!slot || slot->first == FlatNoEntry)
+            return 0;
+        const auto &entry = _entries[slot->first];
+        if(sids) appendIDs(entry,*sids);
+        return entry.name;
+    }
+
+    virtual void visitNames(const char *element, const Visitor &visitor) const override {
+        auto slot = findSlot(element);
+        if(!slot)
+            return;
+        for(uint32_t id=slot->first;id!=FlatNoEntry;id=_entries[id].next)
+            visit(_entries[id],visitor);
+    }
+
+    virtual std::pair<const char*, const char*> insert(const char *name, const char *element,
+            const std::vector<App::StringIDRef> &sids, bool &inserted) override
+    {
+        std::size_t len;
+        uint32_t hash = hashName(name,len);
+        std::size_t pos = findPosition(name,hash);
+        if(pos != std::string::npos) {
+            inserted = false;
+            const auto &entry = _entries[_table[pos]];
+            return std::make_pair(entry.name, entry.element);
+        }
+        inserted = true;
+
+        Entry entry;
+        entry.hash = hash;
+        entry.next = FlatNoEntry;
+        Slot &slot = getSlot(element,entry.type,entry.index);
+        if(slot.first == FlatNoEntry)
+            entry.element = intern(element,std::strlen(element));
+        else
+            entry.element = _entries[slot.first].element;
+        entry.name = intern(name,len);
+        entry.sidOffset = (uint32_t)_sids.size();
+        entry.sidCount = (uint32_t)sids.size();
+        _sids.insert(_sids.end(),sids.begin(),sids.end());
+
+        uint32_t id = (uint32_t)_entries.size();
+        if(slot.last == FlatNoEntry)
+            slot.first = id;
+        else
+            _entries[slot.last].next = id;
+        slot.last = id;
+        _entries.push_back(entry);
+        ++_count;
+        addToTable(id);
+        _sortedValid = false;
+        return std::make_pair(entry.name, entry.element);
+    }
+
+    virtual void eraseName(const char *name) override {
+        std::size_t len;
+        std::size_t pos = findPosition(name,hashName(name,len));
+        if(pos == std::string::npos)
+            return;
+        uint32_t id = _table[pos];
+        auto &entry = _entries[id];
+        Slot &slot = getSlot(entry);
+        uint32_t prev = FlatNoEntry;
+        for(uint32_t i=slot.first;i!=id;i=_entries[i].next)
+            prev = i;
+        if(prev == FlatNoEntry)
+            slot.first = entry.next;
+        else
+            _entries[prev].next = entry.next;
+        if(slot.last == id)
+            slot.last = prev;
+        if(entry.type == FlatOtherType && slot.first == FlatNoEntry)
+            _others.erase(entry.element);
+        removeEntry(id,pos);
+    }
+
+    virtual void eraseElement(const char *element) override {
+        auto slot = const_cast<Slot*>(findSlot(element));
+        if(!slot)
+            return;
+        for(uint32_t id=slot->first;id!=FlatNoEntry;) {
+            uint32_t next = _entries[id].next;
+            removeEntry(id,findPosition(_entries[id].name,_entries[id].hash));
+            id = next;
+        }
+        slot->first = slot->last = FlatNoEntry;
+        if(_others.size())
+            _others.erase(element);
+    }
+
+    virtual void visitByName(const Visitor &visitor, const char *prefix) const override {
+        const auto &ids = sortedByName();
+        auto it = ids.begin();
+        std::size_t len = 0;
+        if(prefix) {
+            len = std::strlen(prefix);
+            it = std::lower_bound(ids.begin(),ids.end(),prefix,[this](uint32_t id, const char *name) {
+                return std::strcmp(_entries[id].name,name) < 0;
+            });
+        }
+        for(;it!=ids.end();++it) {
+            const auto &entry = _entries[*it];
+            if(len && std::strncmp(entry.name,prefix,len)!=0)
+                break;
+            visit(entry,visitor);
+        }
+    }
+
+    virtual void visitByElement(const Visitor &visitor) const override {
+        std::vector<uint32_t> ids;
+        for(auto &type : _types) {
+            for(auto &slot : type.slots) {
+                if(slot.first != FlatNoEntry)
+                    ids.push_back(slot.first);
+            }
+        }
+        for(auto &v : _others) {
+            if(v.second.first != FlatNoEntry)
+                ids.push_back(v.second.first);
+        }
+        std::sort(ids.begin(),ids.end(),[this](uint32_t a, uint32_t b) {
+            return std::strcmp(_entries[a].element,_entries[b].element) < 0;
+        });
+        for(auto first : ids) {
+            for(uint32_t id=first;id!=FlatNoEntry;id=_entries[id].next)
+                visit(_entries[id],visitor);
+        }
+    }
+
+    virtual std::size_t getMemSize() const override {
+        std::size_t size = sizeof(*this)
+            + _poolSize
+            + _chunks.capacity()*sizeof(std::unique_ptr<char[]>)
+            + _entries.capacity()*sizeof(Entry)
+            + _sids.capacity()*sizeof(App::StringIDRef)
+            + _table.capacity()*sizeof(uint32_t)
+            + _sorted.capacity()*sizeof(uint32_t)
+            + _types.capacity()*sizeof(TypeSlots);
+        for(auto &type : _types)
+            size += type.slots.capacity()*sizeof(Slot) + stringMemSize(type.type);
+        for(auto &v : _others)
+            size += sizeof(v) + stringMemSize(v.first) + 2*sizeof(void*);
+        return size;
+    }
+
+private:
+    struct Entry {
+        const char *name; // null if erased
+        const char *element;
+        uint32_t hash;
+        uint32_t next; // next entry of the same element
+        uint32_t type;
+        int index;
+        uint32_t sidOffset;
+        uint32_t sidCount;
+    };
+
+    struct Slot {
+        uint32_t first = FlatNoEntry;
+        uint32_t last = FlatNoEntry;
+    };
+
+    struct TypeSlots {
+        std::string type;
+        std::vector<Slot> slots;
+    };
+
+    // FNV-1a
+    static uint32_t hashName(const char *name, std::size_t &len) {
+        uint32_t hash = 2166136261u;
+        const char *c = name;
+        for(;*c;++c) {
+            hash ^= (unsigned char)*c;
+            hash *= 16777619u;
+        }
+        len = c - name;
+        return hash;
+    }
+
+    std::size_t findPosition(const char *name, uint32_t hash) const {
+        if(_table.empty())
+            return std::string::npos;
+        std::size_t mask = _table.size()-1;
+        for(std::size_t i=hash&mask;;i=(i+1)&mask) {
+            uint32_t id = _table[i];
+            if(id == FlatNoEntry)
+                return std::string::npos;
+            if(id != FlatTombstone
+                    && _entries[id].hash == hash
+                    && std::strcmp(_entries[id].name,name)==0)
+                return i;
+        }
+    }
+
+    void addToTable(uint32_t id) {
+        if((_count+_tombstones)*4 > _table.size()*3) {
+            std::size_t size = _table.empty()?16:_table.size();
+            while(_count*2 > size)
+                size *= 2;
+            rehash(size);
+            return;
+        }
+        std::size_t mask = _table.size()-1;
+        for(std::size_t i=_entries[id].hash&mask;;i=(i+1)&mask) {
+            if(_table[i] == FlatTombstone)
+                --_tombstones;
+            else if(_table[i] != FlatNoEntry)
+                continue;
+            _table[i] = id;
+            return;
+        }
+    }
+
+    void rehash(std::size_t size) {
+        std::vector<uint32_t> table(size,FlatNoEntry);
+        std::size_t mask = size-1;
+        for(uint32_t id=0;id<(uint32_t)_entries.size();++id) {
+            if(!_entries[id].name)
+                continue;
+            std::size_t i = _entries[id].hash&mask;
+            while(table[i] != FlatNoEntry)
+                i = (i+1)&mask;
+            table[i] = id;
+        }
+        _table.swap(table);
+        _tombstones = 0;
+    }
+
+    // Remove an entry that is already unlinked from its element slot
+    void removeEntry(uint32_t id, std::size_t pos) {
+        auto &entry = _entries[id];
+        for(uint32_t i=0;i<entry.sidCount;++i)
+            _sids[entry.sidOffset+i] = App::StringIDRef();
+        entry.name = 0;
+        entry.next = FlatNoEntry;
+        _table[pos] = FlatTombstone;
+        ++_tombstones;
+        --_count;
+        _sortedValid = false;
+    }
+
+    // Return the indices of all entries sorted by mapped name. The map may be
+    // shared by shapes read in different threads, hence the lock.
+    const std::vector<uint32_t> &sortedByName() const {
+        if(_sortedValid.load(std::memory_order_acquire))
+            return _sorted;
+        std::lock_guard<std::mutex> lock(_sortedMutex);
+        if(!_sortedValid.load(std::memory_order_relaxed)) {
+            _sorted.clear();
+            _sorted.reserve(_count);
+            for(uint32_t id=0;id<(uint32_t)_entries.size();++id) {
+                if(_entries[id].name)
+                    _sorted.push_back(id);
+            }
+            std::sort(_sorted.begin(),_sorted.end(),[this](uint32_t a, uint32_t b) {
+                return std::strcmp(_entries[a].name,_entries[b].name) < 0;
+            });
+            _sortedValid.store(true,std::memory_order_release);
+        }
+        return _sorted;
+    }
+
+    const Slot *findSlot(const char *element) const {
+        std::size_t len;
+        int index;
+        if(!splitElementName(element,len,index)) {
+            if(_others.empty())
+                return 0;
+            auto it = _others.find(element);
+            return it==_others.end()?0:&it->second;
+        }
+        for(auto &type : _types) {
+            if(type.type.size()==len && std::strncmp(type.type.c_str(),element,len)==0)
+                return (std::size_t)index<type.slots.size()?&type.slots[index]:0;
+        }
+        return 0;
+    }
+
+    Slot &getSlot(const char *element, uint32_t &type, int &index) {
+        std::size_t len;
+        if(!splitElementName(element,len,index)) {
+            type = FlatOtherType;
+            index = 0;
+            return _others[element];
+        }
+        for(type=0;type<(uint32_t)_types.size();++type) {
+            auto &t = _types[type];
+            if(t.type.size()==len && std::strncmp(t.type.c_str(),element,len)==0)
+                break;
+        }
+        if(type == (uint32_t)_types.size()) {
+            _types.emplace_back();
+            _types.back().type.assign(element,len);
+        }
+        auto &slots = _types[type].slots;
+        if((std::size_t)index >= slots.size())
+            slots.resize(index+1);
+        return slots[index];
+    }
+
+    Slot &getSlot(const Entry &entry) {
+        if(entry.type == FlatOtherType)
+            return _others[entry.element];
+        return _types[entry.type].slots[entry.index];
+    }
+
+    const char *intern(const char *s, std::size_t len) {
+        char *p;
+        if(len+1 > FlatChunkSize/4) {
+            // dedicated chunk for long string
+            _chunks.emplace_back(new char[len+1]);
+            p = _chunks.back().get();
+            _poolSize += len+1;
+        } else {
+            if(!_chunk || _chunkUsed+len+1 > FlatChunkSize) {
+                _chunks.emplace_back(new char[FlatChunkSize]);
+                _chunk = _chunks.back().get();
+                _chunkUsed = 0;
+                _poolSize += FlatChunkSize;
+            }
+            p = _chunk + _chunkUsed;
+            _chunkUsed += len+1;
+        }
+        std::memcpy(p,s,len);
+        p[len] = 0;
+        return p;
+    }
+
+    void appendIDs(const Entry &entry, std::vector<App::StringIDRef> &sids) const {
+        auto it = _sids.begin() + entry.sidOffset;
+        sids.insert(sids.end(),it,it+entry.sidCount);
+    }
+
+    void visit(const Entry &entry, const Visitor &visitor) const {
+        visitor(entry.name,entry.element,
+                entry.sidCount?&_sids[entry.sidOffset]:nullptr,entry.sidCount);
+    }
+
+private:
+    std::vector<Entry> _entries;
+    std::vector<App::StringIDRef> _sids;
+    std::vector<uint32_t> _table;
+    std::vector<TypeSlots> _types;
+    std::unordered_map<std::string, Slot> _others;
+    std::vector<std::unique_ptr<char[]> > _chunks;
+    char *_chunk = nullptr;
+    std::size_t _chunkUsed = 0;
+    std::size_t _poolSize = 0;
+    std::size_t _count = 0;
+    std::size_t _tombstones = 0;
+    mutable std::vector<uint32_t> _sorted;
+    mutable std::atomic<bool> _sortedValid{false};
+    mutable std::mutex _sortedMutex;
+};
+
+class ElementMapParams: public ParameterGrp::ObserverType {
+public:
+    ElementMapParams() {
+        handle = App::GetApplication().GetParameterGroupByPath(
+                "User parameter:BaseApp/Preferences/Document");
+        handle->Attach(this);
+        flat = handle->GetBool("FlatElementMap",false);
+    }
+
+    void OnChange(Base::Subject<const char*> &, const char* sReason) {
+        if(sReason && strcmp(sReason,"FlatElementMap")==0)
+            flat = handle->GetBool("FlatElementMap",false);
+    }
+
+    static ElementMapParams &instance() {
+        static ElementMapParams *inst = new ElementMapParams;
+        return *inst;
+    }
+
+    std::atomic<bool> flat;
+    ParameterGrp::handle handle;
+};
+
+} // anonymous namespace
+
+ElementMapPtr ElementMap::create() {
+    if(ElementMapParams::instance().flat)
+        return std::make_shared<FlatElementMap>();
+    return std::make_shared<BimapElementMap>();
 }
 
 TYPESYSTEM_SOURCE_ABSTRACT(Data::Segment , Base::BaseClass);
@@ -268,11 +874,8 @@ const char *ComplexGeoData::getElementName(const char *name, int direction,
     }
 
     if(direction==1) {
-        auto it = _ElementMap->right.find(name);
-        if(it == _ElementMap->right.end())
-            return name;
-        if(sid) sid->insert(sid->end(),it->info.begin(),it->info.end());
-        return it->second.c_str();
+        auto res = _ElementMap->findName(name,sid);
+        return res?res:name;
     }
     const char *txt = isMappedElement(name);
     if(!txt) {
@@ -287,27 +890,20 @@ const char *ComplexGeoData::getElementName(const char *name, int direction,
         _txt = std::string(txt,dot-txt);
         txt = _txt.c_str();
     }
-    auto it = _ElementMap->left.find(txt);
-    if(it == _ElementMap->left.end())
-        return name;
-    if(sid) sid->insert(sid->end(),it->info.begin(),it->info.end());
-    return it->second.c_str();
+    auto res = _ElementMap->findElement(txt,sid);
+    return res?res:name;
 }
 
 std::vector<std::pair<std::string, std::vector<App::StringIDRef> > >
 ComplexGeoData::getElementMappedNames(const char *element, bool needUnmapped) const {
     std::vector<std::pair<std::string, std::vector<App::StringIDRef> > > names;
     if(_ElementMap) {
-        auto ret = _ElementMap->right.equal_range(element);
-        size_t count=0;
-        for(auto it=ret.first;it!=ret.second;++it)
-            ++count;
-        if(count) {
-            names.reserve(count);
-            for(auto it=ret.first;it!=ret.second;++it)
-                names.emplace_back(it->second,it->info);
+        _ElementMap->visitNames(element,
+            [&](const char *name, const char *, const App::StringIDRef *sids, std::size_t count) {
+                names.emplace_back(name,std::vector<App::StringIDRef>(sids,sids+count));
+            });
+        if(names.size())
             return names;
-        }
     }
     if(needUnmapped)
         names.emplace_back(element,std::vector<App::StringIDRef>());
@@ -322,18 +918,20 @@ ComplexGeoData::getElementNamesWithPrefix(const char *prefix) const {
     const auto &p = elementMapPrefix();
     if(boost::starts_with(prefix,p))
         prefix += p.size();
-    for(auto it=_ElementMap->left.lower_bound(prefix);it!=_ElementMap->left.end();++it) {
-        if(boost::starts_with(it->first,prefix))
-            names.emplace_back(it->first,it->second);
-    }
+    _ElementMap->visitByName(
+        [&](const char *name, const char *element, const App::StringIDRef *, std::size_t) {
+            names.emplace_back(name,element);
+        }, prefix);
     return names;
 }
 
 std::map<std::string, std::string> ComplexGeoData::getElementMap() const {
     std::map<std::string, std::string> ret;
     if(!_ElementMap) return ret;
-    for(auto &v : _ElementMap->left)
-        ret.emplace_hint(ret.cend(),v.first,v.second);
+    _ElementMap->visitByName(
+        [&](const char *name, const char *element, const App::StringIDRef *, std::size_t) {
+            ret.emplace_hint(ret.cend(),name,element);
+        });
     return ret;
 }
 
@@ -354,20 +952,22 @@ void ComplexGeoData::copyElementMap(const ComplexGeoData &data, const char *post
     if(!Hasher)
         Hasher = data.Hasher;
 
-    for(const auto &v : data._ElementMap->left) {
-        auto name = v.first.c_str();
-        if(Hasher==data.Hasher || !data.Hasher) {
-            setElementName(v.second.c_str(), name, postfix, &v.info);
-            continue;
-        }
-        if(postfix)
-            setElementName(v.second.c_str(),name,postfix);
-        else {
-            // In case we have different hasher, but no additional postfix. 
-            // Copy the element name as it is without hashing.
-            setElementName(v.second.c_str(),name,0,false,true);
-        }
-    }
+    std::vector<App::StringIDRef> info;
+    data._ElementMap->visitByName(
+        [&](const char *name, const char *element, const App::StringIDRef *sids, std::size_t count) {
+            if(Hasher==data.Hasher || !data.Hasher) {
+                info.assign(sids,sids+count);
+                setElementName(element, name, postfix, &info);
+                return;
+            }
+            if(postfix)
+                setElementName(element,name,postfix);
+            else {
+                // In case we have different hasher, but no additional postfix. 
+                // Copy the element name as it is without hashing.
+                setElementName(element,name,0,false,true);
+            }
+        });
 }
 
 const char *ComplexGeoData::setElementName(const char *element, const char *name, 
@@ -441,7 +1041,7 @@ const char *ComplexGeoData::setElementName(const char *element, const char *name
         throw Base::ValueError("Invalid input");
     if(!name || !name[0])  {
         if(_ElementMap)
-            _ElementMap->right.erase(element);
+            _ElementMap->eraseElement(element);
         return element;
     }
 
@@ -460,7 +1060,7 @@ const char *ComplexGeoData::setElementName(const char *element, const char *name
     const char *mapped = isMappedElement(name);
     if(mapped)
         name = mapped;
-    if(!_ElementMap) _ElementMap = std::make_shared<ElementMap>();
+    if(!_ElementMap) _ElementMap = ElementMap::create();
     std::string _name;
     if((!sid||sid->empty()) && Hasher && !nohash) {
         sid = &_sid;
@@ -476,21 +1076,22 @@ const char *ComplexGeoData::setElementName(const char *element, const char *name
     std::ostringstream ss;
     std::string retry_name;
     while(1) {
-        auto ret = _ElementMap->left.insert(ElementMap::left_map::value_type(mapped,element,*sid));
-        if(ret.second || ret.first->second==element) {
+        bool inserted;
+        auto ret = _ElementMap->insert(mapped,element,*sid,inserted);
+        if(inserted || strcmp(ret.second,element)==0) {
             FC_TRACE(element << " -> " << name);
-            return ret.first->first.c_str();
+            return ret.first;
         }
         if(overwrite) {
             overwrite = false;
-            _ElementMap->left.erase(ret.first);
+            _ElementMap->eraseName(mapped);
             continue;
         }
         if(sid!=&_sid)
             _sid.insert(_sid.end(),sid->begin(),sid->end());
-        retry_name = renameDuplicateElement(retry++,element,ret.first->second.c_str(),name,_sid);
+        retry_name = renameDuplicateElement(retry++,element,ret.second,name,_sid);
         if(retry_name.empty())
-            return ret.first->first.c_str();
+            return ret.first;
         mapped = retry_name.c_str();
         sid = &_sid;
     }
@@ -691,37 +1292,98 @@ void ComplexGeoData::Save(Base::Writer &writer) const {
         return;
     }
     if(_PersistenceName.size()) {
+        const char *ext = writer.getMode("BinaryElementMap")?".bin":".txt";
         writer.Stream() << " file=\"" 
-            << writer.addFile(_PersistenceName+".txt",this) 
+            << writer.addFile(_PersistenceName+ext,this) 
             << "\"/>\n";
         return;
     }
-    writer.Stream() << " count=\"" << _ElementMap->left.size() << "\">\n";
+    writer.Stream() << " count=\"" << _ElementMap->size() << "\">\n";
     if(writer.getFileVersion() > 1) {
         saveStream(writer.beginCharStream(false) << '\n');
         writer.endCharStream() << '\n';
     } else {
-        for(auto &v : _ElementMap->left) {
-            // We are omitting indentation here to save some space in case of long list of elements
-            writer.Stream() << "<Element key=\"" << encodeAttribute(v.first) 
-                            << "\" value=\"" << encodeAttribute(v.second);
-            if(v.info.size()) {
-                writer.Stream() << "\" sid=\"" << v.info.front()->value();
-                for(size_t i=1;i<v.info.size();++i)
-                    writer.Stream() << '.' << v.info[i]->value();
-            }
-            writer.Stream() << "\"/>\n";
-        }
+        _ElementMap->visitByName(
+            [&](const char *name, const char *element, const App::StringIDRef *sids, std::size_t count) {
+                // We are omitting indentation here to save some space in case of long list of elements
+                writer.Stream() << "<Element key=\"" << encodeAttribute(name) 
+                                << "\" value=\"" << encodeAttribute(element);
+                if(count) {
+                    writer.Stream() << "\" sid=\"" << sids[0]->value();
+                    for(size_t i=1;i<count;++i)
+                        writer.Stream() << '.' << sids[i]->value();
+                }
+                writer.Stream() << "\"/>\n";
+            });
     }
     writer.Stream() << writer.ind() << "</ElementMap>\n" ;
 }
 
 void ComplexGeoData::saveStream(std::ostream &s)  const {
-    for(auto &v : _ElementMap->right) {
-        s << v.first << '\t' << v.second << ' ' << v.info.size();
-        for(auto &sid : v.info)
-            s << ' ' << sid->value();
-        s << '\n';
+    _ElementMap->visitByElement(
+        [&](const char *name, const char *element, const App::StringIDRef *sids, std::size_t count) {
+            s << element << '\t' << name << ' ' << count;
+            for(std::size_t i=0;i<count;++i)
+                s << ' ' << sids[i]->value();
+            s << '\n';
+        });
+}
+
+void ComplexGeoData::saveBinaryStream(Base::OutputStream &str) const {
+    struct Item {
+        const char *name;
+        const char *element;
+        const App::StringIDRef *sids;
+        std::size_t count;
+    };
+    std::vector<Item> items;
+    items.reserve(_ElementMap->size());
+    _ElementMap->visitByElement(
+        [&](const char *name, const char *element, const App::StringIDRef *sids, std::size_t count) {
+            items.push_back({name,element,sids,count});
+        });
+
+    // Group the names by element, and split the element names into type and
+    // index, e.g. Face12 -> type Face, index 12
+    std::vector<std::string> types;
+    std::vector<std::pair<int,int> > elements;
+    std::vector<std::size_t> starts;
+    for(std::size_t i=0;i<items.size();++i) {
+        if(i && std::strcmp(items[i].element,items[i-1].element)==0)
+            continue;
+        starts.push_back(i);
+        std::size_t len;
+        int index = 0;
+        int type = -1;
+        if(splitElementName(items[i].element,len,index)) {
+            for(type=0;type<(int)types.size();++type) {
+                if(types[type].size()==len && std::strncmp(types[type].c_str(),items[i].element,len)==0)
+                    break;
+            }
+            if(type == (int)types.size())
+                types.emplace_back(items[i].element,len);
+        }
+        elements.emplace_back(type,index);
+    }
+    starts.push_back(items.size());
+
+    str << (uint32_t)1 << (uint32_t)types.size();
+    for(auto &type : types)
+        str << type;
+    str << (uint32_t)elements.size();
+    for(std::size_t i=0;i<elements.size();++i) {
+        str << (int32_t)elements[i].first;
+        if(elements[i].first < 0)
+            str << items[starts[i]].element;
+        else
+            str << (uint32_t)elements[i].second;
+        str << (uint32_t)(starts[i+1]-starts[i]);
+        for(std::size_t j=starts[i];j<starts[i+1];++j) {
+            const auto &item = items[j];
+            str << item.name << (uint32_t)item.count;
+            for(std::size_t k=0;k<item.count;++k)
+                str << (int32_t)item.sids[k]->value();
+        }
     }
 }
 
@@ -814,20 +1476,102 @@ void ComplexGeoData::restoreStream(std::istream &s, std::size_t count) {
         FC_ERR("Found " << invalid_count << " invalid string id");
 }
 
+void ComplexGeoData::restoreBinaryStream(Base::InputStream &str) {
+    resetElementMap();
+
+    uint32_t version = 0;
+    str >> version;
+    if(version != 1)
+        FC_THROWM(Base::RuntimeError,"Unsupported element map format " << version);
+
+    uint32_t typeCount = 0;
+    str >> typeCount;
+    std::vector<std::string> types(typeCount);
+    for(auto &type : types)
+        str >> type;
+
+    std::vector<App::StringIDRef> sids;
+    size_t invalid_count = 0;
+    std::string element,name;
+    bool warned = false;
+
+    uint32_t count = 0;
+    str >> count;
+    for(uint32_t i=0;i<count;++i) {
+        int32_t type = -1;
+        str >> type;
+        if(type < 0)
+            str >> element;
+        else {
+            uint32_t index = 0;
+            str >> index;
+            if(type >= (int32_t)types.size())
+                throw Base::RuntimeError("Failed to restore element map");
+            element = types[type] + std::to_string(index);
+        }
+        uint32_t nameCount = 0;
+        str >> nameCount;
+        for(uint32_t j=0;j<nameCount;++j) {
+            uint32_t scount = 0;
+            str >> name >> scount;
+            sids.clear();
+            for(uint32_t k=0;k<scount;++k) {
+                int32_t id;
+                str >> id;
+                if(!Hasher) {
+                    if(!warned) {
+                        warned = true;
+                        FC_ERR("missing hasher");
+                    }
+                    continue;
+                }
+                auto sid = Hasher->getID(id);
+                if(!sid) 
+                    ++invalid_count;
+                else
+                    sids.push_back(sid);
+            }
+            if(!str)
+                throw Base::RuntimeError("Failed to restore element map");
+            setElementName(element.c_str(),"",name.c_str(),&sids);
+        }
+    }
+    if(invalid_count)
+        FC_ERR("Found " << invalid_count << " invalid string id");
+}
+
 void ComplexGeoData::SaveDocFile(Base::Writer &writer) const {
-    writer.Stream() << _ElementMap->left.size() << '\n';
-    saveStream(writer.Stream());
+    if(writer.getMode("BinaryElementMap")) {
+        Base::OutputStream str(writer.Stream());
+        if(_ElementMap)
+            saveBinaryStream(str);
+        else
+            str << (uint32_t)1 << (uint32_t)0 << (uint32_t)0;
+        return;
+    }
+    writer.Stream() << getElementMapSize() << '\n';
+    if(_ElementMap)
+        saveStream(writer.Stream());
 }
 
 void ComplexGeoData::RestoreDocFile(Base::Reader &reader) {
+    if(boost::ends_with(reader.getFileName(),".bin")) {
+        Base::InputStream str(reader);
+        restoreBinaryStream(str);
+        return;
+    }
     std::size_t count;
     reader >> count;
     restoreStream(reader,count);
 }
 
 unsigned int ComplexGeoData::getMemSize(void) const {
+    return (unsigned int)getElementMapMemSize();
+}
+
+size_t ComplexGeoData::getElementMapMemSize() const {
     if(_ElementMap)
-        return _ElementMap->size()*10;
+        return _ElementMap->getMemSize();
     return 0;
 }
 
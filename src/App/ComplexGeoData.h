@@ -38,6 +38,10 @@
 # include <stdint.h>
 #endif
 
+namespace Base {
+class InputStream;
+class OutputStream;
+}
 
 namespace Data
 {
@@ -301,6 +305,9 @@ public:
     /// Get the current element map size
     size_t getElementMapSize() const;
 
+    /// Get the estimated memory usage of the element map in bytes
+    size_t getElementMapMemSize() const;
+
     virtual std::string getElementMapVersion() const;
     //@}
 
@@ -327,6 +334,8 @@ protected:
 
     void saveStream(std::ostream &s) const;
     void restoreStream(std::istream &s, std::size_t count);
+    void saveBinaryStream(Base::OutputStream &s) const;
+    void restoreBinaryStream(Base::InputStream &s);
 
     /// from local to outside
     inline Base::Vector3d transformToOutside(const Base::Vector3f& vec) const
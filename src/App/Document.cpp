@@ -79,10 +79,17 @@ recompute path. Also enables more complicated dependencies beyond trees.
 #include <unordered_set>
 #include <unordered_map>
 #include <random>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <chrono>
 
 #include <QMap>
 #include <QCoreApplication>
 #include <QCryptographicHash>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
 
 #include "Document.h"
 #include "Application.h"
@@ -157,6 +164,24 @@ typedef boost::bimap<StringHasherRef,int> HasherMap;
 static bool _IsRestoring;
 static bool _IsRelabeling;
 
+// Calls deferred by an object executing in a worker thread during concurrent
+// recompute. Non-null only inside such a worker thread. See
+// Document::callInMainThread()
+static thread_local std::vector<std::function<void()> > *_DeferredCalls;
+
+class RecomputeRunnable : public QRunnable
+{
+public:
+    RecomputeRunnable(std::function<void()> &&f)
+        :func(std::move(f))
+    {}
+    virtual void run() {
+        func();
+    }
+private:
+    std::function<void()> func;
+};
+
 // Pimpl class
 struct DocumentP
 {
@@ -175,7 +200,7 @@ struct DocumentP
     bool committing;
     std::bitset<32> StatusBits;
     int iUndoMode;
-    unsigned int UndoMemSize;
+    unsigned int UndoMemLimit;
     unsigned int UndoMaxStackSize;
     mutable HasherMap hashers;
 #ifdef USE_OLD_DAG
@@ -189,6 +214,88 @@ struct DocumentP
     // restored files
     std::set<std::string> files;
 
+    enum RecomputeStep {
+        // evaluate non-output expressions
+        RecomputeStepPre = 1,
+        // call DocumentObject::recompute()
+        RecomputeStepExecute = 2,
+        // evaluate output expressions
+        RecomputeStepPost = 4,
+        RecomputeStepAll = 7,
+    };
+
+    struct ConcurrentResult {
+        // result of RecomputeStepPre, the object is not executed if non zero
+        int res = 0;
+        // set by the worker thread when DocumentObject::recompute() returned
+        bool done = false;
+        DocumentObjectExecReturn *returnCode = 0;
+        std::exception_ptr exception;
+        // calls deferred by the worker thread, see Document::callInMainThread()
+        std::vector<std::function<void()> > calls;
+    };
+    // objects started by Document::_recomputeConcurrently()
+    std::unordered_map<const App::DocumentObject*, ConcurrentResult> concurrentResults;
+    // guards the changes added to the undo transaction and
+    // ConcurrentResult::done during concurrent recompute
+    std::mutex recomputeMutex;
+    std::condition_variable recomputeDone;
+
+    // Ready queue of the concurrent recompute. Tracks for each object that
+    // can be recomputed concurrently the number of its dependencies that
+    // are not yet finished by Document::recompute().
+    struct RecomputeQueue {
+        std::unordered_map<App::DocumentObject*, size_t> order;
+        std::unordered_map<App::DocumentObject*, int> pendingDeps;
+        const std::vector<App::DocumentObject*> *objs = 0;
+        size_t finished = 0;
+        std::vector<App::DocumentObject*> ready;
+
+        // Called at the start of each recompute pass
+        void reset(const std::vector<App::DocumentObject*> &objects, size_t start) {
+            objs = &objects;
+            finished = start;
+            ready.clear();
+            pendingDeps.clear();
+            if(order.empty()) {
+                for(size_t i=0; i<objects.size(); ++i)
+                    order.emplace(objects[i], i);
+            }
+            for(size_t i=start; i<objects.size(); ++i) {
+                auto obj = objects[i];
+                if(!obj->getNameInDocument() || !obj->canRecomputeConcurrently())
+                    continue;
+                std::set<App::DocumentObject*> deps;
+                for(auto dep : obj->getOutList()) {
+                    auto it = order.find(dep);
+                    if(it != order.end() && it->second >= start)
+                        deps.insert(dep);
+                }
+                pendingDeps[obj] = (int)deps.size();
+                if(deps.empty())
+                    ready.push_back(obj);
+            }
+        }
+
+        // Marks all objects before \a idx as finished and returns the
+        // objects whose dependencies are all finished now
+        std::vector<App::DocumentObject*> advance(size_t idx) {
+            for(; finished < idx; ++finished) {
+                std::set<App::DocumentObject*> inList;
+                for(auto obj : (*objs)[finished]->getInList())
+                    inList.insert(obj);
+                for(auto obj : inList) {
+                    auto it = pendingDeps.find(obj);
+                    if(it != pendingDeps.end() && --it->second == 0)
+                        ready.push_back(obj);
+                }
+            }
+            std::vector<App::DocumentObject*> res;
+            res.swap(ready);
+            return res;
+        }
+    };
+
     DocumentP() {
         static std::random_device _RD;
         static std::mt19937 _RGEN(_RD());
@@ -207,7 +314,7 @@ struct DocumentP
         StatusBits.set((size_t)Document::KeepTrailingDigits, true);
         StatusBits.set((size_t)Document::Restoring, false);
         iUndoMode = 0;
-        UndoMemSize = 0;
+        UndoMemLimit = 0;
         UndoMaxStackSize = 20;
     }
 
@@ -235,6 +342,35 @@ struct DocumentP
             _RecomputeLog.erase(obj);
     }
 
+    static QThreadPool &recomputePool() {
+        static QThreadPool pool;
+        return pool;
+    }
+
+    // Waits for the worker thread executing the object and runs the calls
+    // it has deferred
+    void finishConcurrentResult(ConcurrentResult &result) {
+        {
+            std::unique_lock<std::mutex> lock(recomputeMutex);
+            recomputeDone.wait(lock, [&result]() {return result.done;});
+        }
+        auto calls = std::move(result.calls);
+        result.calls.clear();
+        for(auto &call : calls)
+            call();
+    }
+
+    // Waits for all objects left over by an aborted recompute. They have
+    // been executed anyway, so their deferred calls are run, too.
+    void clearConcurrentResults() {
+        for(auto &v : concurrentResults) {
+            finishConcurrentResult(v.second);
+            if(v.second.returnCode != DocumentObject::StdReturn)
+                delete v.second.returnCode;
+        }
+        concurrentResults.clear();
+    }
+
     const char *findRecomputeLog(const App::DocumentObject *obj) {
         auto range = _RecomputeLog.equal_range(obj);
         if(range.first == range.second)
@@ -1193,6 +1329,22 @@ void Document::_commitTransaction(bool notify)
             delete mUndoTransactions.front();
             mUndoTransactions.pop_front();
         }
+        if(d->UndoMemLimit) {
+            // The size of older transactions grows when the data they share
+            // with the document gets modified, so sum them all up again.
+            // The transaction just committed is always kept, even if it
+            // exceeds the limit on its own, so that it can be undone.
+            std::size_t size = 0;
+            for(auto trans : mUndoTransactions)
+                size += trans->getTotalMemSize();
+            while(size > d->UndoMemLimit && mUndoTransactions.size() > 1) {
+                Transaction *trans = mUndoTransactions.front();
+                size -= std::min(size, trans->getTotalMemSize());
+                mUndoMap.erase(trans->getID());
+                delete trans;
+                mUndoTransactions.pop_front();
+            }
+        }
         signalCommitTransaction(*this);
 
         if(notify)
@@ -1356,14 +1508,24 @@ int Document::getUndoMode(void) const
     return d->iUndoMode;
 }
 
-unsigned int Document::getUndoMemSize (void) const
+std::size_t Document::getUndoMemSize (void) const
 {
-    return d->UndoMemSize;
+    std::size_t size = 0;
+    for (auto trans : mUndoTransactions)
+        size += trans->getTotalMemSize();
+    for (auto trans : mRedoTransactions)
+        size += trans->getTotalMemSize();
+    return size;
 }
 
 void Document::setUndoLimit(unsigned int UndoMemSize)
 {
-    d->UndoMemSize = UndoMemSize;
+    d->UndoMemLimit = UndoMemSize;
+}
+
+unsigned int Document::getUndoLimit(void) const
+{
+    return d->UndoMemLimit;
 }
 
 void Document::setMaxUndoStackSize(unsigned int UndoMaxStackSize)
@@ -1435,18 +1597,36 @@ void Document::onChanged(const Property* prop)
 
 void Document::onBeforeChangeProperty(const TransactionalObject *Who, const Property *What)
 {
-    if(Who->isDerivedFrom(App::DocumentObject::getClassTypeId()))
-        signalBeforeChangeObject(*static_cast<const App::DocumentObject*>(Who), *What);
+    if(Who->isDerivedFrom(App::DocumentObject::getClassTypeId())) {
+        auto obj = static_cast<const App::DocumentObject*>(Who);
+        callInMainThread([this,obj,What]() {
+            signalBeforeChangeObject(*obj, *What);
+        });
+    }
     if(!d->rollback && !_IsRelabeling) {
         _checkTransaction(0,What,__LINE__);
-        if (d->activeUndoTransaction)
+        if (d->activeUndoTransaction) {
+            // worker threads of concurrent recompute may record their
+            // changes at the same time
+            std::lock_guard<std::mutex> lock(d->recomputeMutex);
             d->activeUndoTransaction->addObjectChange(Who,What);
+        }
     }
 }
 
 void Document::onChangedProperty(const DocumentObject *Who, const Property *What)
 {
-    signalChangedObject(*Who, *What);
+    callInMainThread([this,Who,What]() {
+        signalChangedObject(*Who, *What);
+    });
+}
+
+void Document::callInMainThread(const std::function<void()> &func)
+{
+    if(_DeferredCalls)
+        _DeferredCalls->push_back(func);
+    else
+        func();
 }
 
 void Document::setTransactionMode(int iMode)
@@ -2267,7 +2447,7 @@ Document::importObjects(Base::XMLReader& reader)
 
 unsigned int Document::getMemSize (void) const
 {
-    unsigned int size = 0;
+    std::size_t size = 0;
 
     // size of the DocObjects in the document
     std::vector<DocumentObject*>::const_iterator it;
@@ -2282,7 +2462,7 @@ unsigned int Document::getMemSize (void) const
     // Undo Redo size
     size += getUndoMemSize();
 
-    return size;
+    return (unsigned int)std::min<std::size_t>(size, UINT_MAX);
 }
 
 static std::string checkFileName(const char *file) {
@@ -2411,6 +2591,12 @@ bool Document::saveToFile(const char* filename) const
             _writer.reset(zipwriter);
             zipwriter->setComment("FreeCAD Document");
             zipwriter->setLevel(compression);
+            if(hGrp->GetBool("ConcurrentSave",false)) {
+                int threads = hGrp->GetInt("SaveThreads",0);
+                if(threads <= 0)
+                    threads = QThread::idealThreadCount();
+                zipwriter->setThreadCount(threads);
+            }
         } else {
             _writer.reset(new Base::FileWriter(tmp.filePath().c_str()));
         }
@@ -2430,6 +2616,10 @@ bool Document::saveToFile(const char* filename) const
         } else if(writer.getFileVersion() > 1)
             writer.setPreferBinary(false);
 
+        // Compact binary element map, not readable by older versions
+        if (hGrp->GetBool("BinaryElementMap",false))
+            writer.setMode("BinaryElementMap");
+
         writer.Stream() << "<?xml version='1.0' encoding='utf-8'?>\n"
                         << "<!--\n"
                         << " FreeCAD Document, see http://www.freecadweb.org for more information...\n"
@@ -3358,9 +3548,18 @@ int Document::recompute(const std::vector<App::DocumentObject*> &objs, bool forc
     ParameterGrp::handle hGrp = GetApplication().GetParameterGroupByPath(
             "User parameter:BaseApp/Preferences/Document");
     bool canAbort = hGrp->GetBool("CanAbortRecompute",true);
+    bool concurrent = hGrp->GetBool("ConcurrentRecompute",false);
+    if(concurrent) {
+        int threads = hGrp->GetInt("RecomputeThreads",0);
+        if(threads <= 0)
+            threads = QThread::idealThreadCount();
+        concurrent = threads > 1;
+        DocumentP::recomputePool().setMaxThreadCount(threads);
+    }
 
     std::set<App::DocumentObject *> filter;
     size_t idx = 0;
+    DocumentP::RecomputeQueue queue;
 
     FC_TIME_INIT(t2);
 
@@ -3371,16 +3570,36 @@ int Document::recompute(const std::vector<App::DocumentObject*> &objs, bool forc
             if(canAbort)
                 seq.reset(new Base::SequencerLauncher("Recompute...", topoSortedObjects.size()));
             FC_LOG("Recompute pass " << passes);
+            if(concurrent)
+                queue.reset(topoSortedObjects, idx);
             for (;idx<topoSortedObjects.size();(seq?seq->next(true):true),++idx) {
+                if(concurrent) {
+                    // Start all objects whose dependencies have been
+                    // finished by this loop. Their results are picked up
+                    // below in the same order as serial recompute.
+                    for(auto o : queue.advance(idx)) {
+                        if(o->getNameInDocument() && !filter.count(o) && o->mustRecompute())
+                            _recomputeConcurrently(o);
+                    }
+                }
                 auto obj = topoSortedObjects[idx];
                 if(!obj->getNameInDocument() || filter.find(obj)!=filter.end())
                     continue;
                 // ask the object if it should be recomputed
                 bool doRecompute = false;
-                if (obj->mustRecompute()) {
+                auto it = d->concurrentResults.find(obj);
+                if (it != d->concurrentResults.end() || obj->mustRecompute()) {
                     doRecompute = true;
                     ++objectCount;
-                    int res = _recomputeFeature(obj);
+                    int res;
+                    if(it != d->concurrentResults.end()) {
+                        res = it->second.res;
+                        if(!res)
+                            res = _recomputeFeature(obj, DocumentP::RecomputeStepExecute
+                                                        | DocumentP::RecomputeStepPost);
+                        d->concurrentResults.erase(obj);
+                    } else
+                        res = _recomputeFeature(obj);
                     if(res) {
                         if(hasError)
                             *hasError = true;
@@ -3425,6 +3644,8 @@ int Document::recompute(const std::vector<App::DocumentObject*> &objs, bool forc
         e.ReportException();
     }
 
+    d->clearConcurrentResults();
+
     FC_TIME_LOG(t2, "Recompute");
 
     for(auto obj : topoSortedObjects) {
@@ -3623,16 +3844,35 @@ const char * Document::getErrorDescription(const App::DocumentObject*Obj) const
 // call the recompute of the Feature and handle the exceptions and errors.
 int Document::_recomputeFeature(DocumentObject* Feat)
 {
-    FC_LOG("Recomputing " << Feat->getFullName());
+    return _recomputeFeature(Feat, DocumentP::RecomputeStepAll);
+}
+
+int Document::_recomputeFeature(DocumentObject* Feat, int steps)
+{
+    if(steps & DocumentP::RecomputeStepPre)
+        FC_LOG("Recomputing " << Feat->getFullName());
 
-    DocumentObjectExecReturn  *returnCode = 0;
+    DocumentObjectExecReturn  *returnCode = DocumentObject::StdReturn;
     try {
-        returnCode = Feat->ExpressionEngine.execute(PropertyExpressionEngine::ExecuteNonOutput);
-        if (returnCode == DocumentObject::StdReturn) {
-            returnCode = Feat->recompute();
-            if(returnCode == DocumentObject::StdReturn)
-                returnCode = Feat->ExpressionEngine.execute(PropertyExpressionEngine::ExecuteOutput);
+        if(steps & DocumentP::RecomputeStepPre)
+            returnCode = Feat->ExpressionEngine.execute(PropertyExpressionEngine::ExecuteNonOutput);
+        if (returnCode == DocumentObject::StdReturn && (steps & DocumentP::RecomputeStepExecute)) {
+            auto it = d->concurrentResults.find(Feat);
+            if(it == d->concurrentResults.end())
+                returnCode = _executeFeature(Feat);
+            else {
+                // Executed by a worker thread, see _recomputeConcurrently().
+                // Report the result here as if it was executed in this thread.
+                auto &result = it->second;
+                d->finishConcurrentResult(result);
+                returnCode = result.returnCode;
+                result.returnCode = DocumentObject::StdReturn;
+                if(result.exception)
+                    std::rethrow_exception(result.exception);
+            }
         }
+        if (returnCode == DocumentObject::StdReturn && (steps & DocumentP::RecomputeStepPost))
+            returnCode = Feat->ExpressionEngine.execute(PropertyExpressionEngine::ExecuteOutput);
     }
     catch(Base::AbortException &e){
         e.ReportException();
@@ -3677,6 +3917,51 @@ int Document::_recomputeFeature(DocumentObject* Feat)
     return 0;
 }
 
+DocumentObjectExecReturn *Document::_executeFeature(DocumentObject* Feat)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto returnCode = Feat->recompute();
+    auto &stats = Feat->_executeStats;
+    stats.last = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats.total += stats.last;
+    ++stats.count;
+    return returnCode;
+}
+
+// Start the recompute of an object whose dependencies are all finished.
+// Expressions are evaluated in this thread, because they may involve Python,
+// only DocumentObject::recompute() is run in a worker thread. The result is
+// stored in DocumentP::concurrentResults, and is picked up and reported by
+// _recomputeFeature() when Document::recompute() reaches the object.
+void Document::_recomputeConcurrently(DocumentObject* Feat)
+{
+    auto &result = d->concurrentResults[Feat];
+    result.res = _recomputeFeature(Feat, DocumentP::RecomputeStepPre);
+    if(result.res) {
+        result.done = true;
+        return;
+    }
+
+    // Open the pending auto transaction here, so that the worker thread only
+    // has to add its changes
+    _checkTransaction(0,0,__LINE__);
+
+    auto pResult = &result;
+    DocumentP::recomputePool().start(new RecomputeRunnable([this, Feat, pResult]() {
+        _DeferredCalls = &pResult->calls;
+        try {
+            pResult->returnCode = _executeFeature(Feat);
+        } catch (...) {
+            pResult->exception = std::current_exception();
+        }
+        _DeferredCalls = nullptr;
+
+        std::lock_guard<std::mutex> lock(d->recomputeMutex);
+        pResult->done = true;
+        d->recomputeDone.notify_all();
+    }));
+}
+
 bool Document::recomputeFeature(DocumentObject* Feat, bool recursive)
 {
     if (d->undoing && d->rollback) {
@@ -3702,6 +3987,42 @@ bool Document::recomputeFeature(DocumentObject* Feat, bool recursive)
         return false;
 }
 
+std::vector<App::DocumentObject*> Document::getRecomputeImpact(
+        const std::vector<App::Property*> &props) const
+{
+    std::set<App::DocumentObject*> objSet;
+    for(auto prop : props) {
+        auto obj = Base::freecad_dynamic_cast<DocumentObject>(prop->getContainer());
+        if(!obj || !obj->getNameInDocument())
+            continue;
+        // Same logic as DocumentObject::onChanged(). Changing an output
+        // property does not touch its owner.
+        if(obj->testStatus(ObjectStatus::NoTouch)
+                || (prop->getType() & Prop_Output)
+                || prop->testStatus(Property::Output))
+            continue;
+        if(!(prop->getType() & Prop_NoRecompute))
+            objSet.insert(obj);
+        // Document::recompute() enforces recompute of the InList of any
+        // touched object, which then propagates to the InList of those.
+        obj->getInListEx(objSet,true);
+    }
+    if(objSet.empty())
+        return {};
+
+    // Sort in recompute order. getDependencyList() adds the dependencies of
+    // the affected objects, which are filtered out again.
+    std::vector<App::DocumentObject*> res;
+    res.reserve(objSet.size());
+    for(auto obj : getDependencyList(
+                std::vector<App::DocumentObject*>(objSet.begin(),objSet.end()),DepSort))
+    {
+        if(objSet.count(obj))
+            res.push_back(obj);
+    }
+    return res;
+}
+
 DocumentObject * Document::addObject(const char* sType, const char* pObjectName, 
         bool isNew, const char *viewType, bool isPartial)
 {
@@ -344,6 +344,27 @@ public:
             bool force=false,bool *hasError=0, int options=0);
     /// Recompute only one feature
     bool recomputeFeature(DocumentObject* Feat,bool recursive=false);
+    /** Return the objects that recompute() would execute if the given properties were changed
+     *
+     * @param props: the properties to be changed
+     *
+     * @return Return the affected objects in recompute order, possibly
+     * including objects of other documents. The cost of the change can be
+     * estimated from the recorded DocumentObject::getExecuteStats() of each
+     * object. Objects that are already touched are not included unless
+     * affected by the change.
+     */
+    std::vector<App::DocumentObject*> getRecomputeImpact(
+            const std::vector<App::Property*> &props) const;
+    /** Call a function in the main thread
+     *
+     * If called by an object executing in a worker thread of concurrent
+     * recompute, the function is queued and called in the main thread when
+     * recompute() picks up the result of the object. Otherwise the function
+     * is called immediately. Use it for signals, console output and anything
+     * else that touches more than the executing object.
+     */
+    static void callInMainThread(const std::function<void()> &func);
     /// get the text of the error of a specified object
     const char* getErrorDescription(const App::DocumentObject*) const;
     /// return the status bits
@@ -398,10 +419,12 @@ public:
     /// Check if a transaction is open and its list is empty.
     /// If no transaction is open true is returned.
     bool isTransactionEmpty() const;
-    /// Set the Undo limit in Byte!
+    /// Set the Undo limit in Byte! Zero means no limit.
     void setUndoLimit(unsigned int UndoMemSize=0);
+    /// Returns the Undo limit in Byte
+    unsigned int getUndoLimit(void) const;
     /// Returns the actual memory consumption of the Undo redo stuff.
-    unsigned int getUndoMemSize (void) const;
+    std::size_t getUndoMemSize (void) const;
     /// Set the Undo limit as stack size
     void setMaxUndoStackSize(unsigned int UndoMaxStackSize=20);
     /// Set the Undo limit as stack size
@@ -567,6 +590,12 @@ protected:
     /// helper which Recompute only this feature
     /// @return True if the recompute process of the Document shall be stopped, False if it shall be continued.
     int _recomputeFeature(DocumentObject* Feat);
+    /// helper which runs only the given steps (DocumentP::RecomputeStep) of the feature recompute
+    int _recomputeFeature(DocumentObject* Feat, int steps);
+    /// helper which starts the recompute of a feature in a worker thread
+    void _recomputeConcurrently(DocumentObject* Feat);
+    /// helper which calls DocumentObject::recompute() and records the execution time
+    static DocumentObjectExecReturn *_executeFeature(DocumentObject* Feat);
     void _clearRedos();
 
     /// refresh the internal dependency graph
@@ -24,6 +24,7 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+# include <atomic>
 #endif
 
 #include <Base/Writer.h>
@@ -52,6 +53,9 @@ PROPERTY_SOURCE(App::DocumentObject, App::TransactionalObject)
 
 DocumentObjectExecReturn *DocumentObject::StdReturn = 0;
 
+// Properties may be changed by objects recomputed in worker threads
+static std::atomic<unsigned long long> _ChangeStamp;
+
 //===========================================================================
 // DocumentObject
 //===========================================================================
@@ -59,6 +63,8 @@ DocumentObjectExecReturn *DocumentObject::StdReturn = 0;
 DocumentObject::DocumentObject(void)
     : ExpressionEngine(),_pDoc(0),pcNameInDocument(0),_Id(0)
 {
+    _changeStamp = ++_ChangeStamp;
+
     // define Label of type 'Output' to avoid being marked as touched after relabeling
     ADD_PROPERTY_TYPE(Label,("Unnamed"),"Base",Prop_Output,"User name of the object (UTF8)");
     ADD_PROPERTY_TYPE(Label2,(""),"Base",Prop_Hidden,"User description of the object (UTF8)");
@@ -95,7 +101,9 @@ App::DocumentObjectExecReturn *DocumentObject::recompute(void)
     //check if the links are valid before making the recompute
     if(!GeoFeatureGroupExtension::areLinksValid(this)) {
 #if 1
-        Base::Console().Warning("%s / %s: Links go out of the allowed scope\n", getTypeId().getName(), getNameInDocument());
+        Document::callInMainThread([this]() {
+            Base::Console().Warning("%s / %s: Links go out of the allowed scope\n", getTypeId().getName(), getNameInDocument());
+        });
 #else
         return new App::DocumentObjectExecReturn("Links go out of the allowed scope", this);
 #endif
@@ -139,8 +147,11 @@ void DocumentObject::touch(bool noRecompute)
     if(!noRecompute)
         StatusBits.set(ObjectStatus::Enforce);
     StatusBits.set(ObjectStatus::Touch);
-    if (_pDoc)
-        _pDoc->signalTouchedObject(*this);
+    if (_pDoc) {
+        Document::callInMainThread([this]() {
+            _pDoc->signalTouchedObject(*this);
+        });
+    }
 }
 
 /**
@@ -681,7 +692,14 @@ void DocumentObject::onBeforeChange(const Property* prop)
     if (_pDoc)
         onBeforeChangeProperty(_pDoc, prop);
 
-    signalBeforeChange(*this,*prop);
+    Document::callInMainThread([this,prop]() {
+        signalBeforeChange(*this,*prop);
+    });
+}
+
+unsigned long long DocumentObject::currentChangeStamp()
+{
+    return _ChangeStamp;
 }
 
 /// get called by the container when a Property was changed
@@ -703,7 +721,11 @@ void DocumentObject::onChanged(const Property* prop)
         }
     }
 
-    signalEarlyChanged(*this,*prop);
+    _changeStamp = ++_ChangeStamp;
+
+    Document::callInMainThread([this,prop]() {
+        signalEarlyChanged(*this,*prop);
+    });
 
     // Delay signaling view provider until the document object has handled the
     // change
@@ -719,7 +741,11 @@ void DocumentObject::onChanged(const Property* prop)
             && !prop->testStatus(Property::Output)) 
     {
         if(!StatusBits.test(ObjectStatus::Touch)) {
-            FC_TRACE("touch " << prop->getFullName());
+            if(FC_LOG_INSTANCE.isEnabled(FC_LOGLEVEL_TRACE)) {
+                Document::callInMainThread([prop]() {
+                    FC_TRACE("touch " << prop->getFullName());
+                });
+            }
             StatusBits.set(ObjectStatus::Touch);
         }
         // must execute on document recompute
@@ -734,7 +760,9 @@ void DocumentObject::onChanged(const Property* prop)
     if (_pDoc)
         _pDoc->onChangedProperty(this,prop);
 
-    signalChanged(*this,*prop);
+    Document::callInMainThread([this,prop]() {
+        signalChanged(*this,*prop);
+    });
 }
 
 void DocumentObject::clearOutListCache() const {
@@ -168,6 +168,31 @@ public:
     void setStatus(ObjectStatus pos, bool on) {StatusBits.set((size_t)pos, on);}
     //@}
 
+    /// Execution time statistics recorded by Document on each call of recompute()
+    struct ExecuteStats {
+        /// number of recorded executions
+        unsigned long count = 0;
+        /// duration of the last execution in seconds
+        double last = 0.0;
+        /// accumulated duration of all recorded executions in seconds
+        double total = 0.0;
+
+        double average() const {return count?total/count:0.0;}
+    };
+    /// Return the execution time statistics of this object in the current session
+    const ExecuteStats &getExecuteStats() const {return _executeStats;}
+
+    /** Return the change stamp of this object
+     *
+     * The stamp is taken from a global counter on construction and on every
+     * property change. Unlike the touched status, it is not reset by
+     * recompute, so it can be compared against currentChangeStamp() to tell
+     * whether the object has changed since then.
+     */
+    unsigned long long getChangeStamp() const {return _changeStamp;}
+    /// Return the current value of the global change stamp counter
+    static unsigned long long currentChangeStamp();
+
     int isExporting() const;
 
     /** Child element handling
@@ -300,6 +325,20 @@ public:
      */
     bool recomputeFeature(bool recursive=false);
 
+    /** Whether this object can be recomputed in a worker thread
+     *
+     * Return true to let Document::recompute() execute this object in a
+     * worker thread as soon as all its dependencies are recomputed, if
+     * concurrent recompute is enabled by the user preference
+     * 'ConcurrentRecompute'. Expressions of the object are still evaluated
+     * in the main thread, and the signals raised during execution are
+     * deferred with Document::callInMainThread(). The object's execute()
+     * must not modify any other object, nor call into Python or the GUI, and
+     * must only read objects it depends on. The default implementation
+     * returns false.
+     */
+    virtual bool canRecomputeConcurrently() const {return false;}
+
     /// get the status Message
     const char *getStatusString(void) const;
 
@@ -616,6 +655,12 @@ private:
 
     // unique identifier (ammong a document) of this object.
     long _Id;
+
+    // accessed by App::Document to record the execution time
+    ExecuteStats _executeStats;
+
+    // updated on every property change, see getChangeStamp()
+    unsigned long long _changeStamp;
     
 private:
     // Back pointer to all the fathers in a DAG of the document
@@ -633,7 +633,20 @@ void  DocumentPy::setUndoMode(Py::Int arg)
 
 Py::Int DocumentPy::getUndoRedoMemSize(void) const
 {
-    return Py::Int((long)getDocumentPtr()->getUndoMemSize());
+    return Py::Long(static_cast<unsigned PY_LONG_LONG>(getDocumentPtr()->getUndoMemSize()));
+}
+
+Py::Int DocumentPy::getUndoMemLimit(void) const
+{
+    return Py::Int((long)getDocumentPtr()->getUndoLimit());
+}
+
+void DocumentPy::setUndoMemLimit(Py::Int arg)
+{
+    long limit = arg;
+    if (limit < 0)
+        throw Py::ValueError("Memory limit must not be negative");
+    getDocumentPtr()->setUndoLimit((unsigned int)limit);
 }
 
 Py::Int DocumentPy::getUndoCount(void) const
@@ -838,6 +851,69 @@ PyObject *DocumentPy::getDependentDocuments(PyObject *args) {
     } PY_CATCH;
 }
 
+PyObject *DocumentPy::getRecomputeImpact(PyObject *args) {
+    PyObject *pyprops;
+    if (!PyArg_ParseTuple(args, "O", &pyprops))
+        return 0;
+    PY_TRY {
+        if(!PySequence_Check(pyprops)) {
+            PyErr_SetString(PyExc_TypeError, "expect input of sequence of (object, property name)");
+            return 0;
+        }
+        std::vector<App::Property*> props;
+        Py::Sequence seq(pyprops);
+        for(size_t i=0;i<seq.size();++i) {
+            PyObject *pyobj;
+            const char *name;
+            if(!PyArg_ParseTuple(seq[i].ptr(), "O!s", &DocumentObjectPy::Type, &pyobj, &name)) {
+                PyErr_SetString(PyExc_TypeError, "expect input of sequence of (object, property name)");
+                return 0;
+            }
+            auto obj = static_cast<DocumentObjectPy*>(pyobj)->getDocumentObjectPtr();
+            auto prop = obj->getPropertyByName(name);
+            if(!prop) {
+                PyErr_Format(PyExc_AttributeError, "Property '%s' not found in %s",
+                        name, obj->getFullName().c_str());
+                return 0;
+            }
+            props.push_back(prop);
+        }
+        Py::List ret;
+        for(auto obj : getDocumentPtr()->getRecomputeImpact(props)) {
+            const auto &stats = obj->getExecuteStats();
+            Py::Tuple item(4);
+            item.setItem(0, Py::Object(obj->getPyObject(), true));
+            item.setItem(1, Py::Float(stats.last));
+            item.setItem(2, Py::Float(stats.average()));
+            item.setItem(3, Py::Int((long)stats.count));
+            ret.append(item);
+        }
+        return Py::new_reference_to(ret);
+    } PY_CATCH;
+}
+
+PyObject *DocumentPy::getExpressionStats(PyObject *args) {
+    PyObject *reset = Py_False;
+    if (!PyArg_ParseTuple(args, "|O", &reset))
+        return 0;
+    PY_TRY {
+        unsigned long evaluated = 0, skipped = 0, graphBuilds = 0;
+        for(auto obj : getDocumentPtr()->getObjects()) {
+            const auto &stats = obj->ExpressionEngine.getExecuteStats();
+            evaluated += stats.evaluated;
+            skipped += stats.skipped;
+            graphBuilds += stats.graphBuilds;
+            if(PyObject_IsTrue(reset))
+                obj->ExpressionEngine.resetExecuteStats();
+        }
+        Py::Dict ret;
+        ret.setItem("evaluated", Py::Int((long)evaluated));
+        ret.setItem("skipped", Py::Int((long)skipped));
+        ret.setItem("graphBuilds", Py::Int((long)graphBuilds));
+        return Py::new_reference_to(ret);
+    } PY_CATCH;
+}
+
 Py::Boolean DocumentPy::getRestoring(void) const
 {
     return Py::Boolean(getDocumentPtr()->testStatus(Document::Status::Restoring));
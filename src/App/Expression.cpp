@@ -52,6 +52,7 @@
 #include <cctype>
 #include <algorithm>
 #include <climits>
+#include <cmath>
 #include "Expression.h"
 #include "ExpressionParser.h"
 #include <Base/Unit.h>
@@ -2632,153 +2633,13 @@ Py::Object FunctionExpression::evalAggregate(const Expression *owner, int f, con
     return pyFromQuantity(c->getQuantity());
 }
 
-Py::Object FunctionExpression::evaluate(const Expression *expr, int f, const ExpressionList &args) 
+/**
+  * Evaluate the math function \a f, shared by FunctionExpression and ExpressionProgram.
+  * \a v2 and \a v3 are null if the corresponding argument is not given.
+  */
+static Quantity evalMathFunction(const Expression *expr, int f,
+        const Quantity &v1, const Quantity *v2, const Quantity *v3)
 {
-    if(!expr || !expr->getOwner())
-        _EXPR_THROW("Invalid owner.", expr);
-
-    if(args.empty())
-        _EXPR_THROW("Function requires at least one argument.",expr);
-
-    // Handle aggregate functions
-    if (f > AGGREGATES)
-        return evalAggregate(expr, f, args);
-
-    switch(f) {
-    case GET_VAR: 
-        if(args.size()<2)
-            _EXPR_THROW("Function expects 2 or 3 arguments.",expr);
-        // fall through
-    case HAS_VAR: {
-        Py::Object value = args[0]->getPyValue();
-        if(!value.isString())
-            _EXPR_THROW("Expects the first argument evaluating to a string.",expr);
-        Py::Object pyobj;
-        bool found = Base::Interpreter().getVariable(value.as_string().c_str(),pyobj);
-        if(f == HAS_VAR)
-            return Py::Boolean(found);
-#if 1
-        // getvar() may pose as a security problem. Disable it for now.
-        __EXPR_THROW(Base::NotImplementedError, "getvar() is disabled.", expr);
-#else
-        if(!found) {
-            if(args.size()==2)
-                return args[1]->getPyValue();
-            _EXPR_THROW("Variable not found.",expr);
-        }
-        return pyobj;
-#endif
-    } case LIST: {
-        if(args.size() == 1 && args[0]->isDerivedFrom(RangeExpression::getClassTypeId()))
-            return args[0]->getPyValue();
-        Py::List list(args.size());
-        int i=0;
-        for(auto &arg : args)
-            list.setItem(i++,arg->getPyValue());
-        return list;
-    } case TUPLE: {
-        if(args.size() == 1 && args[0]->isDerivedFrom(RangeExpression::getClassTypeId()))
-            return Py::Tuple(args[0]->getPyValue());
-        Py::Tuple tuple(args.size());
-        int i=0;
-        for(auto &arg : args)
-            tuple.setItem(i++,arg->getPyValue());
-        return tuple;
-    } case MSCALE: {
-        if(args.size() < 2)
-            _EXPR_THROW("Function requires at least two arguments.",expr);
-        Py::Object pymat = args[0]->getPyValue();
-        Py::Object pyscale;
-        if(PyObject_TypeCheck(pymat.ptr(),&Base::MatrixPy::Type)) {
-            if(args.size() == 2) {
-                Py::Object obj = args[1]->getPyValue();
-                if(obj.isSequence() && PySequence_Size(obj.ptr())==3)
-                    pyscale = Py::Tuple(Py::Sequence(obj));
-            } else if(args.size() == 4) {
-                Py::Tuple tuple(3);
-                tuple.setItem(0,args[1]->getPyValue());
-                tuple.setItem(1,args[2]->getPyValue());
-                tuple.setItem(2,args[3]->getPyValue());
-                pyscale = tuple;
-            }
-        }
-        if(!pyscale.isNone()) {
-            Base::Vector3d vec;
-            if (!PyArg_ParseTuple(pyscale.ptr(), "ddd", &vec.x,&vec.y,&vec.z))
-                PyErr_Clear();
-            else {
-                auto mat = static_cast<Base::MatrixPy*>(pymat.ptr())->value();
-                mat.scale(vec);
-                return Py::Object(new Base::MatrixPy(mat));
-            }
-        }
-        _EXPR_THROW("Function requires arguments to be either "
-                "(matrix,vector) or (matrix,number,number,number).", expr);
-
-    } case MINVERT: {
-        Py::Object pyobj = args[0]->getPyValue();
-        Py::Tuple args;
-        if (PyObject_TypeCheck(pyobj.ptr(),&Base::MatrixPy::Type)) {
-            auto m = static_cast<Base::MatrixPy*>(pyobj.ptr())->value();
-            if (fabs(m.determinant()) <= DBL_EPSILON)
-                _EXPR_THROW("Cannot invert singular matrix.",expr);
-            m.inverseGauss();
-            return Py::Object(new Base::MatrixPy(m));
-
-        } else if (PyObject_TypeCheck(pyobj.ptr(),&Base::PlacementPy::Type)) {
-            const auto &pla = *static_cast<Base::PlacementPy*>(pyobj.ptr())->getPlacementPtr();
-            return Py::Object(new Base::PlacementPy(pla.inverse()));
-
-        } else if (PyObject_TypeCheck(pyobj.ptr(),&Base::RotationPy::Type)) {
-            const auto &rot = *static_cast<Base::RotationPy*>(pyobj.ptr())->getRotationPtr();
-            return Py::Object(new Base::RotationPy(rot.inverse()));
-        }
-        _EXPR_THROW("Function requires the first argument to be either Matrix, Placement or Rotation.",expr);
-
-    } case CREATE: {
-        Py::Object pytype = args[0]->getPyValue();
-        if(!pytype.isString())
-            _EXPR_THROW("Function requires the first argument to be a string.",expr);
-        std::string type(pytype.as_string());
-        Py::Object res;
-        if(boost::iequals(type,"matrix")) 
-            res = Py::Object(new Base::MatrixPy(Base::Matrix4D()));
-        else if(boost::iequals(type,"vector"))
-            res = Py::Object(new Base::VectorPy(Base::Vector3d()));
-        else if(boost::iequals(type,"placement"))
-            res = Py::Object(new Base::PlacementPy(Base::Placement()));
-        else if(boost::iequals(type,"rotation"))
-            res = Py::Object(new Base::RotationPy(Base::Rotation()));
-        else
-            _EXPR_THROW("Unknown type '" << type << "'.",expr);
-        if(args.size()>1) {
-            Py::Tuple tuple(args.size()-1);
-            for(unsigned i=1;i<args.size();++i)
-                tuple.setItem(i-1,args[i]->getPyValue());
-            Py::Dict dict;
-            PyObjectBase::__PyInit(res.ptr(),tuple.ptr(),dict.ptr());
-        }
-        return res;
-
-    } default:
-        break;
-    }
-
-    Py::Object e1 = args[0]->getPyValue();
-    Quantity v1 = pyToQuantity(e1,expr,"Invalid first argument.");
-    Py::Object e2;
-    Quantity v2;
-    if(args.size()>1) {
-        e2 = args[1]->getPyValue();
-        v2 = pyToQuantity(e2,expr,"Invalid second argument.");
-    }
-    Py::Object e3;
-    Quantity v3;
-    if(args.size()>2) {
-        e3 = args[2]->getPyValue();
-        v3 = pyToQuantity(e3,expr,"Invalid third argument.");
-    }
-
     double output;
     Unit unit;
     double scaler = 1;
@@ -2848,28 +2709,28 @@ Py::Object FunctionExpression::evaluate(const Expression *expr, int f, const Exp
         break;
     }
     case ATAN2:
-        if (e2.isNone())
+        if (!v2)
             _EXPR_THROW("Invalid second argument.",expr);
 
-        if (v1.getUnit() != v2.getUnit())
+        if (v1.getUnit() != v2->getUnit())
             _EXPR_THROW("Units must be equal.",expr);
         unit = Unit::Angle;
         scaler = 180.0 / M_PI;
         break;
     case FMOD:
-        if (e2.isNone())
+        if (!v2)
             _EXPR_THROW("Invalid second argument.",expr);
-        unit = v1.getUnit() / v2.getUnit();
+        unit = v1.getUnit() / v2->getUnit();
         break;
     case FPOW: {
-        if (e2.isNone())
+        if (!v2)
             _EXPR_THROW("Invalid second argument.",expr);
 
-        if (!v2.getUnit().isEmpty())
+        if (!v2->getUnit().isEmpty())
             _EXPR_THROW("Exponent is not allowed to have a unit.",expr);
 
         // Compute new unit for exponentiation
-        double exponent = v2.getValue();
+        double exponent = v2->getValue();
         if (!v1.getUnit().isEmpty()) {
             if (exponent - boost::math::round(exponent) < 1e-9)
                 unit = v1.getUnit().pow(exponent);
@@ -2880,17 +2741,13 @@ Py::Object FunctionExpression::evaluate(const Expression *expr, int f, const Exp
     }
     case HYPOT:
     case CATH:
-        if (e2.isNone())
+        if (!v2)
             _EXPR_THROW("Invalid second argument.",expr);
-        if (v1.getUnit() != v2.getUnit())
+        if (v1.getUnit() != v2->getUnit())
             _EXPR_THROW("Units must be equal.",expr);
 
-        if (args.size() > 2) {
-            if (e3.isNone())
-                _EXPR_THROW("Invalid second argument.",expr);
-            if (v2.getUnit() != v3.getUnit())
-                _EXPR_THROW("Units must be equal.",expr);
-        }
+        if (v3 && v2->getUnit() != v3->getUnit())
+            _EXPR_THROW("Units must be equal.",expr);
         unit = v1.getUnit();
         break;
     default:
@@ -2942,23 +2799,23 @@ Py::Object FunctionExpression::evaluate(const Expression *expr, int f, const Exp
         output = cosh(value);
         break;
     case FMOD: {
-        output = fmod(value, v2.getValue());
+        output = fmod(value, v2->getValue());
         break;
     }
     case ATAN2: {
-        output = atan2(value, v2.getValue());
+        output = atan2(value, v2->getValue());
         break;
     }
     case FPOW: {
-        output = pow(value, v2.getValue());
+        output = pow(value, v2->getValue());
         break;
     }
     case HYPOT: {
-        output = sqrt(pow(v1.getValue(), 2) + pow(v2.getValue(), 2) + (!e3.isNone() ? pow(v3.getValue(), 2) : 0));
+        output = sqrt(pow(v1.getValue(), 2) + pow(v2->getValue(), 2) + (v3 ? pow(v3->getValue(), 2) : 0));
         break;
     }
     case CATH: {
-        output = sqrt(pow(v1.getValue(), 2) - pow(v2.getValue(), 2) - (!e3.isNone() ? pow(v3.getValue(), 2) : 0));
+        output = sqrt(pow(v1.getValue(), 2) - pow(v2->getValue(), 2) - (v3 ? pow(v3->getValue(), 2) : 0));
         break;
     }
     case ROUND:
@@ -2977,45 +2834,194 @@ Py::Object FunctionExpression::evaluate(const Expression *expr, int f, const Exp
         _EXPR_THROW("Unknown function: " << f,expr);
     }
 
-    return Py::Object(new QuantityPy(new Quantity(scaler * output, unit)));
-}
-
-Py::Object FunctionExpression::_getPyValue(int *) const {
-    return evaluate(this,f,args);
+    return Quantity(scaler * output, unit);
 }
 
-/**
-  * Try to simplify the expression, i.e calculate all constant expressions.
-  *
-  * @returns A simplified expression.
-  */
-
-ExpressionPtr FunctionExpression::simplify() const
+Py::Object FunctionExpression::evaluate(const Expression *expr, int f, const ExpressionList &args) 
 {
-    size_t numerics = 0;
-    ExpressionList a;
+    if(!expr || !expr->getOwner())
+        _EXPR_THROW("Invalid owner.", expr);
 
-    // Try to simplify each argument to function
-    for (auto &arg : args) {
-        auto v = arg->simplify();
-        if (freecad_dynamic_cast<NumberExpression>(v.get()))
-            ++numerics;
-        a.push_back(std::move(v));
-    }
+    if(args.empty())
+        _EXPR_THROW("Function requires at least one argument.",expr);
 
-    if (numerics == args.size()) {
-        // All constants, then evaluation must also be constant
-        return eval();
-    }
-    else
-        return create(owner, f, std::move(a));
-}
+    // Handle aggregate functions
+    if (f > AGGREGATES)
+        return evalAggregate(expr, f, args);
 
-/**
-  * Create a string representation of the expression.
-  *
-  * @returns A string representing the expression.
-  */
+    switch(f) {
+    case GET_VAR: 
+        if(args.size()<2)
+            _EXPR_THROW("Function expects 2 or 3 arguments.",expr);
+        // fall through
+    case HAS_VAR: {
+        Py::Object value = args[0]->getPyValue();
+        if(!value.isString())
+            _EXPR_THROW("Expects the first argument evaluating to a string.",expr);
+        Py::Object pyobj;
+        bool found = Base::Interpreter().getVariable(value.as_string().c_str(),pyobj);
+        if(f == HAS_VAR)
+            return Py::Boolean(found);
+#if 1
+        // getvar() may pose as a security problem. Disable it for now.
+        __EXPR_THROW(Base::NotImplementedError, "getvar() is disabled.", expr);
+#else
+        if(!found) {
+            if(args.size()==2)
+                return args[1]->getPyValue();
+            _EXPR_THROW("Variable not found.",expr);
+        }
+        return pyobj;
+#endif
+    } case LIST: {
+        if(args.size() == 1 && args[0]->isDerivedFrom(RangeExpression::getClassTypeId()))
+            return args[0]->getPyValue();
+        Py::List list(args.size());
+        int i=0;
+        for(auto &arg : args)
+            list.setItem(i++,arg->getPyValue());
+        return list;
+    } case TUPLE: {
+        if(args.size() == 1 && args[0]->isDerivedFrom(RangeExpression::getClassTypeId()))
+            return Py::Tuple(args[0]->getPyValue());
+        Py::Tuple tuple(args.size());
+        int i=0;
+        for(auto &arg : args)
+            tuple.setItem(i++,arg->getPyValue());
+        return tuple;
+    } case MSCALE: {
+        if(args.size() < 2)
+            _EXPR_THROW("Function requires at least two arguments.",expr);
+        Py::Object pymat = args[0]->getPyValue();
+        Py::Object pyscale;
+        if(PyObject_TypeCheck(pymat.ptr(),&Base::MatrixPy::Type)) {
+            if(args.size() == 2) {
+                Py::Object obj = args[1]->getPyValue();
+                if(obj.isSequence() && PySequence_Size(obj.ptr())==3)
+                    pyscale = Py::Tuple(Py::Sequence(obj));
+            } else if(args.size() == 4) {
+                Py::Tuple tuple(3);
+                tuple.setItem(0,args[1]->getPyValue());
+                tuple.setItem(1,args[2]->getPyValue());
+                tuple.setItem(2,args[3]->getPyValue());
+                pyscale = tuple;
+            }
+        }
+        if(!pyscale.isNone()) {
+            Base::Vector3d vec;
+            if (!PyArg_ParseTuple(pyscale.ptr(), "ddd", &vec.x,&vec.y,&vec.z))
+                PyErr_Clear();
+            else {
+                auto mat = static_cast<Base::MatrixPy*>(pymat.ptr())->value();
+                mat.scale(vec);
+                return Py::Object(new Base::MatrixPy(mat));
+            }
+        }
+        _EXPR_THROW("Function requires arguments to be either "
+                "(matrix,vector) or (matrix,number,number,number).", expr);
+
+    } case MINVERT: {
+        Py::Object pyobj = args[0]->getPyValue();
+        Py::Tuple args;
+        if (PyObject_TypeCheck(pyobj.ptr(),&Base::MatrixPy::Type)) {
+            auto m = static_cast<Base::MatrixPy*>(pyobj.ptr())->value();
+            if (fabs(m.determinant()) <= DBL_EPSILON)
+                _EXPR_THROW("Cannot invert singular matrix.",expr);
+            m.inverseGauss();
+            return Py::Object(new Base::MatrixPy(m));
+
+        } else if (PyObject_TypeCheck(pyobj.ptr(),&Base::PlacementPy::Type)) {
+            const auto &pla = *static_cast<Base::PlacementPy*>(pyobj.ptr())->getPlacementPtr();
+            return Py::Object(new Base::PlacementPy(pla.inverse()));
+
+        } else if (PyObject_TypeCheck(pyobj.ptr(),&Base::RotationPy::Type)) {
+            const auto &rot = *static_cast<Base::RotationPy*>(pyobj.ptr())->getRotationPtr();
+            return Py::Object(new Base::RotationPy(rot.inverse()));
+        }
+        _EXPR_THROW("Function requires the first argument to be either Matrix, Placement or Rotation.",expr);
+
+    } case CREATE: {
+        Py::Object pytype = args[0]->getPyValue();
+        if(!pytype.isString())
+            _EXPR_THROW("Function requires the first argument to be a string.",expr);
+        std::string type(pytype.as_string());
+        Py::Object res;
+        if(boost::iequals(type,"matrix")) 
+            res = Py::Object(new Base::MatrixPy(Base::Matrix4D()));
+        else if(boost::iequals(type,"vector"))
+            res = Py::Object(new Base::VectorPy(Base::Vector3d()));
+        else if(boost::iequals(type,"placement"))
+            res = Py::Object(new Base::PlacementPy(Base::Placement()));
+        else if(boost::iequals(type,"rotation"))
+            res = Py::Object(new Base::RotationPy(Base::Rotation()));
+        else
+            _EXPR_THROW("Unknown type '" << type << "'.",expr);
+        if(args.size()>1) {
+            Py::Tuple tuple(args.size()-1);
+            for(unsigned i=1;i<args.size();++i)
+                tuple.setItem(i-1,args[i]->getPyValue());
+            Py::Dict dict;
+            PyObjectBase::__PyInit(res.ptr(),tuple.ptr(),dict.ptr());
+        }
+        return res;
+
+    } default:
+        break;
+    }
+
+    Py::Object e1 = args[0]->getPyValue();
+    Quantity v1 = pyToQuantity(e1,expr,"Invalid first argument.");
+    Quantity v2;
+    if(args.size()>1) {
+        Py::Object e2 = args[1]->getPyValue();
+        v2 = pyToQuantity(e2,expr,"Invalid second argument.");
+    }
+    Quantity v3;
+    if(args.size()>2) {
+        Py::Object e3 = args[2]->getPyValue();
+        v3 = pyToQuantity(e3,expr,"Invalid third argument.");
+    }
+
+    return Py::Object(new QuantityPy(new Quantity(evalMathFunction(expr, f, v1,
+                        args.size()>1?&v2:nullptr, args.size()>2?&v3:nullptr))));
+}
+
+Py::Object FunctionExpression::_getPyValue(int *) const {
+    return evaluate(this,f,args);
+}
+
+/**
+  * Try to simplify the expression, i.e calculate all constant expressions.
+  *
+  * @returns A simplified expression.
+  */
+
+ExpressionPtr FunctionExpression::simplify() const
+{
+    size_t numerics = 0;
+    ExpressionList a;
+
+    // Try to simplify each argument to function
+    for (auto &arg : args) {
+        auto v = arg->simplify();
+        if (freecad_dynamic_cast<NumberExpression>(v.get()))
+            ++numerics;
+        a.push_back(std::move(v));
+    }
+
+    if (numerics == args.size()) {
+        // All constants, then evaluation must also be constant
+        return eval();
+    }
+    else
+        return create(owner, f, std::move(a));
+}
+
+/**
+  * Create a string representation of the expression.
+  *
+  * @returns A string representing the expression.
+  */
 
 void FunctionExpression::_toString(std::ostream &ss, bool persistent,int) const
 {
@@ -6366,6 +6372,781 @@ Py::Object FromStatement::_getPyValue(int *) const {
     return Py::Object();
 }
 
+////////////////////////////////////////////////////////////////////////////////////
+//
+// ExpressionProgram class
+//
+
+enum ProgramOpCode {
+    PROG_PUSH,          // push constant 'arg'
+    PROG_LOAD,          // push the value of property slot 'arg'
+    PROG_EVAL,          // evaluate node 'arg' with the tree walker and push the result
+    PROG_UNARY,         // apply unary operator 'arg' on the top value
+    PROG_BINARY,        // apply binary operator 'arg' on the top two values
+    PROG_FUNC,          // call math function 'arg' on the arguments at the top
+    PROG_TEST,          // convert the top value to boolean
+    PROG_JUMP,          // jump to 'arg'
+    PROG_JUMP_FALSE,    // pop the top value, jump to 'arg' if it is false
+    PROG_AND,           // if the top value is false, replace it with False and jump to 'arg', or else pop it
+    PROG_OR,            // if the top value is true, replace it with True and jump to 'arg', or else pop it
+};
+
+struct ProgramInstruction {
+    int code;
+    int arg;
+};
+
+// Value on the program stack. The type mirrors the Python type the tree
+// walker would produce for the same value, so that the final result and the
+// arithmetic rules are the same.
+struct ProgramValue {
+    enum Type {
+        TypeBool,
+        TypeInt,
+        TypeFloat,
+        TypeQuantity,
+    };
+    Type type = TypeFloat;
+    double value = 0.0;
+    Unit unit;
+
+    bool isTrue() const {
+        return value != 0.0;
+    }
+
+    void setBool(bool v) {
+        type = TypeBool;
+        value = v?1.0:0.0;
+        unit = Unit();
+    }
+};
+
+// Thrown when the program cannot reproduce what the tree walker does, e.g. on
+// a Python exception. The evaluation is then redone by the tree walker, which
+// takes care of reporting any error. If 'permanent', the program is disabled
+// for good.
+struct ProgramBailout {
+    bool permanent;
+    explicit ProgramBailout(bool permanent=false) :permanent(permanent) {}
+};
+
+// Largest integer that can be represented exactly by double. Python integer
+// beyond that is left to the tree walker.
+static const double _MaxExactInt = 9007199254740992.0;
+
+enum ProgramSlotType {
+    SlotUnresolved,
+    SlotPython,
+    SlotBool,
+    SlotInt,
+    SlotFloat,
+    SlotQuantity,
+};
+
+static unsigned long _ProgramEpoch = 1;
+
+static bool pyToProgramValue(const Py::Object &pyobj, ProgramValue &v) {
+    PyObject *obj = pyobj.ptr();
+    if (PyObject_TypeCheck(obj, &Base::QuantityPy::Type)) {
+        const Quantity *q = static_cast<Base::QuantityPy*>(obj)->getQuantityPtr();
+        v.type = ProgramValue::TypeQuantity;
+        v.value = q->getValue();
+        v.unit = q->getUnit();
+        return true;
+    }
+    v.unit = Unit();
+    if (PyBool_Check(obj)) {
+        v.setBool(obj == Py_True);
+        return true;
+    }
+    if (PyFloat_Check(obj)) {
+        v.type = ProgramValue::TypeFloat;
+        v.value = PyFloat_AsDouble(obj);
+        return true;
+    }
+#if PY_MAJOR_VERSION < 3
+    if (PyInt_Check(obj)) {
+        v.type = ProgramValue::TypeInt;
+        v.value = (double)PyInt_AsLong(obj);
+        return true;
+    }
+#endif
+    if (PyLong_Check(obj)) {
+        int overflow = 0;
+        long l = PyLong_AsLongAndOverflow(obj, &overflow);
+        if (overflow || std::fabs((double)l) > _MaxExactInt)
+            return false;
+        v.type = ProgramValue::TypeInt;
+        v.value = (double)l;
+        return true;
+    }
+    return false;
+}
+
+static App::any programValueToAny(const ProgramValue &v, bool keepBool=false) {
+    switch(v.type) {
+    case ProgramValue::TypeQuantity:
+        return App::any(Quantity(v.value, v.unit));
+    case ProgramValue::TypeFloat:
+        return App::any(v.value);
+    case ProgramValue::TypeBool:
+        if (keepBool)
+            return App::any(v.isTrue());
+        // fall through
+    default:
+        // same as pyObjectToAny(), which returns both Python bool and int as long
+        return App::any((long)v.value);
+    }
+}
+
+// Python float modulo, the result takes the sign of the divisor
+static double pyModulo(double vx, double wx) {
+    double mod = std::fmod(vx, wx);
+    if (mod) {
+        if ((wx < 0) != (mod < 0))
+            mod += wx;
+    }
+    else
+        mod = std::copysign(0.0, wx);
+    return mod;
+}
+
+// Python float floor division
+static double pyFloorDivide(double vx, double wx) {
+    double mod = std::fmod(vx, wx);
+    double div = (vx - mod) / wx;
+    if (mod && ((wx < 0) != (mod < 0)))
+        div -= 1.0;
+    if (!div)
+        return std::copysign(0.0, vx / wx);
+    double floordiv = std::floor(div);
+    if (div - floordiv > 0.5)
+        floordiv += 1.0;
+    return floordiv;
+}
+
+static void programUnary(int op, ProgramValue &v) {
+    switch(op) {
+    case OP_NOT:
+        v.setBool(!v.isTrue());
+        return;
+    case OP_NEG:
+        v.value = -v.value;
+        break;
+    case OP_POS:
+        break;
+    default:
+        throw ProgramBailout(true);
+    }
+    if (v.type == ProgramValue::TypeBool)
+        v.type = ProgramValue::TypeInt;
+}
+
+// Follows the Python number protocol for int and float, and QuantityPy for
+// Quantity, i.e. the result is a Quantity if any of the operands is.
+static void programBinary(int op, ProgramValue &l, const ProgramValue &r) {
+    bool quantity = l.type == ProgramValue::TypeQuantity || r.type == ProgramValue::TypeQuantity;
+    bool isFloat = l.type == ProgramValue::TypeFloat || r.type == ProgramValue::TypeFloat;
+
+    switch(op) {
+    case OP_ADD:
+    case OP_SUB:
+        if (quantity && l.unit != r.unit)
+            throw ProgramBailout();
+        if (op == OP_ADD)
+            l.value += r.value;
+        else
+            l.value -= r.value;
+        break;
+    case OP_MUL:
+    case OP_UNIT:
+        l.value *= r.value;
+        if (quantity)
+            l.unit = l.unit * r.unit;
+        break;
+    case OP_DIV:
+        if (quantity)
+            l.unit = l.unit / r.unit;
+        else if (r.value == 0.0)
+            throw ProgramBailout();
+        l.value /= r.value;
+        isFloat = true;
+        break;
+    case OP_FDIV:
+        if (quantity || r.value == 0.0)
+            throw ProgramBailout();
+        l.value = pyFloorDivide(l.value, r.value);
+        break;
+    case OP_MOD:
+        // QuantityPy only accepts Quantity as the first argument, and keeps its unit
+        if (r.value == 0.0 || (quantity && l.type != ProgramValue::TypeQuantity))
+            throw ProgramBailout();
+        l.value = pyModulo(l.value, r.value);
+        break;
+    case OP_POW:
+    case OP_POW2:
+        if (quantity) {
+            // Same as Quantity::pow()
+            if (l.type != ProgramValue::TypeQuantity || !r.unit.isEmpty())
+                throw ProgramBailout();
+            l.value = std::pow(l.value, r.value);
+            l.unit = l.unit.pow((short)r.value);
+            break;
+        }
+        if (l.value == 0.0 && r.value < 0.0)
+            throw ProgramBailout();
+        if (!isFloat && r.value < 0.0)
+            isFloat = true;
+        else if (isFloat && l.value < 0.0 && std::floor(r.value) != r.value)
+            throw ProgramBailout(); // complex result
+        {
+            double res = std::pow(l.value, r.value);
+            if (std::isinf(res) && std::isfinite(l.value) && std::isfinite(r.value))
+                throw ProgramBailout();
+            l.value = res;
+        }
+        break;
+    case OP_EQ:
+    case OP_NE:
+    case OP_LT:
+    case OP_GT:
+    case OP_LE:
+    case OP_GE: {
+        bool res;
+        if (l.type == ProgramValue::TypeQuantity && r.type == ProgramValue::TypeQuantity) {
+            // Same as QuantityPy::richCompare()
+            bool eq = l.value == r.value && l.unit == r.unit;
+            if (op == OP_EQ)
+                res = eq;
+            else if (op == OP_NE)
+                res = !eq;
+            else {
+                if (l.unit != r.unit)
+                    throw ProgramBailout();
+                bool lt = l.value < r.value;
+                if (op == OP_LT)
+                    res = lt;
+                else if (op == OP_LE)
+                    res = lt || eq;
+                else if (op == OP_GT)
+                    res = !lt && !eq;
+                else
+                    res = !lt;
+            }
+        }
+        else {
+            switch(op) {
+            case OP_EQ:
+                res = l.value == r.value;
+                break;
+            case OP_NE:
+                res = l.value != r.value;
+                break;
+            case OP_LT:
+                res = l.value < r.value;
+                break;
+            case OP_GT:
+                res = l.value > r.value;
+                break;
+            case OP_LE:
+                res = l.value <= r.value;
+                break;
+            default:
+                res = l.value >= r.value;
+                break;
+            }
+        }
+        l.setBool(res);
+        return;
+    }
+    default:
+        throw ProgramBailout(true);
+    }
+
+    if (quantity)
+        l.type = ProgramValue::TypeQuantity;
+    else if (isFloat)
+        l.type = ProgramValue::TypeFloat;
+    else {
+        l.type = ProgramValue::TypeInt;
+        if (std::fabs(l.value) > _MaxExactInt)
+            throw ProgramBailout();
+    }
+}
+
+struct ExpressionProgram::Private {
+    struct Slot {
+        const VariableExpression *node;
+        Property *prop = nullptr;
+        int type = SlotUnresolved;
+
+        Slot(const VariableExpression *node)
+            :node(node)
+        {}
+    };
+
+    struct Function {
+        const Expression *expr;
+        int type;
+        int argc;
+    };
+
+    std::vector<ProgramInstruction> code;
+    std::vector<ProgramValue> constants;
+    std::vector<Slot> slots;
+    std::vector<const Expression*> nodes;
+    std::vector<Function> functions;
+    int depth = 0;
+    int maxDepth = 0;
+    unsigned long epoch = 0;
+    bool disabled = false;
+    bool invalid = false;
+    // evaluating in a worker thread, Python must not be touched
+    bool concurrent = false;
+
+    int emit(int op, int arg, int stackChange) {
+        code.push_back({op, arg});
+        depth += stackChange;
+        if (depth > maxDepth)
+            maxDepth = depth;
+        return (int)code.size()-1;
+    }
+
+    void compileEval(const Expression *e) {
+        nodes.push_back(e);
+        emit(PROG_EVAL, (int)nodes.size()-1, 1);
+    }
+
+    bool compileFunction(const Expression *e, int type, const Expression::ExpressionList &args) {
+        // Only the math functions. FunctionExpression::evaluate() ignores
+        // arguments after the third one, leave it to the tree walker.
+        if (type < ACOS || type > CATH || args.empty() || args.size() > 3 || !e->getOwner())
+            return false;
+        for (auto &arg : args)
+            compile(arg.get());
+        functions.push_back({e, type, (int)args.size()});
+        emit(PROG_FUNC, (int)functions.size()-1, 1-(int)args.size());
+        return true;
+    }
+
+    void compile(const Expression *e) {
+        if (e->hasComponent()) {
+            compileEval(e);
+            return;
+        }
+
+        if (e->isDerivedFrom(UnitExpression::getClassTypeId())) {
+            // Numbers, units, booleans and constants. Obtain the value from
+            // the tree walker so that the type is exactly the same.
+            ProgramValue v;
+            if (!pyToProgramValue(e->getPyValue(), v)) {
+                compileEval(e);
+                return;
+            }
+            constants.push_back(v);
+            emit(PROG_PUSH, (int)constants.size()-1, 1);
+            return;
+        }
+
+        if (e->isDerivedFrom(VariableExpression::getClassTypeId())) {
+            slots.emplace_back(static_cast<const VariableExpression*>(e));
+            emit(PROG_LOAD, (int)slots.size()-1, 1);
+            return;
+        }
+
+        if (e->isDerivedFrom(OperatorExpression::getClassTypeId())) {
+            auto oe = static_cast<const OperatorExpression*>(e);
+            int op = oe->getOperator();
+            switch(op) {
+            case OP_NEG:
+            case OP_POS:
+            case OP_NOT:
+                compile(oe->getLeft());
+                emit(PROG_UNARY, op, 0);
+                return;
+            case OP_AND:
+            case OP_OR: {
+                compile(oe->getLeft());
+                int jump = emit(op==OP_AND?PROG_AND:PROG_OR, 0, -1);
+                compile(oe->getRight());
+                emit(PROG_TEST, 0, 0);
+                code[jump].arg = (int)code.size();
+                return;
+            }
+            case OP_ADD:
+            case OP_SUB:
+            case OP_MUL:
+            case OP_UNIT:
+            case OP_DIV:
+            case OP_FDIV:
+            case OP_MOD:
+            case OP_POW:
+            case OP_POW2:
+            case OP_EQ:
+            case OP_NE:
+            case OP_LT:
+            case OP_GT:
+            case OP_LE:
+            case OP_GE:
+                compile(oe->getLeft());
+                compile(oe->getRight());
+                emit(PROG_BINARY, op, -1);
+                return;
+            default:
+                break;
+            }
+        }
+        else if (e->isDerivedFrom(ConditionalExpression::getClassTypeId())) {
+            auto ce = static_cast<const ConditionalExpression*>(e);
+            compile(ce->condition.get());
+            int jumpFalse = emit(PROG_JUMP_FALSE, 0, -1);
+            compile(ce->trueExpr.get());
+            // the false branch pushes its own value
+            int jump = emit(PROG_JUMP, 0, -1);
+            code[jumpFalse].arg = (int)code.size();
+            compile(ce->falseExpr.get());
+            code[jump].arg = (int)code.size();
+            return;
+        }
+        else if (e->isDerivedFrom(FunctionExpression::getClassTypeId())) {
+            auto fe = static_cast<const FunctionExpression*>(e);
+            if (compileFunction(e, fe->f, fe->args))
+                return;
+        }
+        else if (e->isDerivedFrom(CallableExpression::getClassTypeId())) {
+            auto ce = static_cast<const CallableExpression*>(e);
+            bool named = false;
+            for (auto &name : ce->names) {
+                if (name.size()) {
+                    named = true;
+                    break;
+                }
+            }
+            if (!ce->expr && !named && compileFunction(e, ce->ftype, ce->args))
+                return;
+        }
+        else if (e->isDerivedFrom(AssignmentExpression::getClassTypeId())) {
+            // Assignment binds variable in the evaluation frame, which is not
+            // shared among nodes evaluated through the tree walker.
+            invalid = true;
+        }
+
+        compileEval(e);
+    }
+
+    void resolve(Slot &slot) {
+        slot.type = SlotPython;
+        slot.prop = nullptr;
+
+        const ObjectIdentifier &path = slot.node->getPath();
+        if (path.getSubObjectName().size())
+            return;
+
+        Property *prop;
+        int ptype = 0;
+        try {
+            prop = path.getProperty(&ptype);
+            // Only plain property reference, i.e. no pseudo property, no sub
+            // path, and no link indirection, which may change without notice.
+            if (!prop || ptype
+                      || path.numSubComponents() != 1
+                      || prop->getContainer() != path.getDocumentObject())
+                return;
+        } catch (Base::Exception &) {
+            return;
+        }
+
+        Base::Type type = prop->getTypeId();
+        if (type.isDerivedFrom(PropertyQuantity::getClassTypeId()))
+            slot.type = SlotQuantity;
+        else if (type == PropertyFloat::getClassTypeId()
+                || type == PropertyFloatConstraint::getClassTypeId()
+                || type == PropertyPrecision::getClassTypeId())
+            slot.type = SlotFloat;
+        else if (type == PropertyInteger::getClassTypeId()
+                || type == PropertyIntegerConstraint::getClassTypeId()
+                || type == PropertyPercent::getClassTypeId())
+            slot.type = SlotInt;
+        else if (type == PropertyBool::getClassTypeId())
+            slot.type = SlotBool;
+        else
+            return;
+        slot.prop = prop;
+    }
+
+    bool run(App::any &value);
+
+    void checkEpoch() {
+        if (epoch != _ProgramEpoch) {
+            for (auto &slot : slots)
+                slot.type = SlotUnresolved;
+            epoch = _ProgramEpoch;
+        }
+    }
+
+    void load(Slot &slot, ProgramValue &v) {
+        if (slot.type == SlotUnresolved) {
+            if (concurrent)
+                throw ProgramBailout();
+            resolve(slot);
+        }
+
+        switch(slot.type) {
+        case SlotQuantity: {
+            auto prop = static_cast<PropertyQuantity*>(slot.prop);
+            v.type = ProgramValue::TypeQuantity;
+            v.value = prop->getValue();
+            v.unit = prop->getUnit();
+            return;
+        }
+        case SlotFloat:
+            v.type = ProgramValue::TypeFloat;
+            v.value = static_cast<PropertyFloat*>(slot.prop)->getValue();
+            v.unit = Unit();
+            return;
+        case SlotInt:
+            v.type = ProgramValue::TypeInt;
+            v.value = (double)static_cast<PropertyInteger*>(slot.prop)->getValue();
+            v.unit = Unit();
+            if (std::fabs(v.value) <= _MaxExactInt)
+                return;
+            break;
+        case SlotBool:
+            v.setBool(static_cast<PropertyBool*>(slot.prop)->getValue());
+            return;
+        default:
+            break;
+        }
+        eval(slot.node, v);
+    }
+
+    void eval(const Expression *e, ProgramValue &v) {
+        if (concurrent)
+            throw ProgramBailout();
+        Base::PyGILStateLocker lock;
+        if (!pyToProgramValue(e->getPyValue(Expression::OptionCallFrame), v))
+            throw ProgramBailout(true);
+    }
+
+    void call(const Function &func, ProgramValue *args) {
+        Quantity v[3];
+        for (int i=0; i<func.argc; ++i)
+            v[i] = Quantity(args[i].value, args[i].unit);
+        Quantity res;
+        try {
+            res = evalMathFunction(func.expr, func.type, v[0],
+                    func.argc>1?&v[1]:nullptr, func.argc>2?&v[2]:nullptr);
+        } catch (Base::Exception &) {
+            // let the tree walker report the error in the calling thread
+            if (concurrent)
+                throw ProgramBailout();
+            throw;
+        }
+        args[0].type = ProgramValue::TypeQuantity;
+        args[0].value = res.getValue();
+        args[0].unit = res.getUnit();
+    }
+};
+
+static void initProgramSignals() {
+    static bool inited;
+    if (inited)
+        return;
+    inited = true;
+
+    auto &app = GetApplication();
+    auto objectChanged = [](const App::DocumentObject &) {
+        ExpressionProgram::invalidateSlots();
+    };
+    auto documentChanged = [](const App::Document &) {
+        ExpressionProgram::invalidateSlots();
+    };
+    auto propertyChanged = [](const App::Property &) {
+        ExpressionProgram::invalidateSlots();
+    };
+    app.signalNewObject.connect(objectChanged);
+    app.signalDeletedObject.connect(objectChanged);
+    app.signalRelabelObject.connect(objectChanged);
+    app.signalAppendDynamicProperty.connect(propertyChanged);
+    app.signalRemoveDynamicProperty.connect(propertyChanged);
+    app.signalDeleteDocument.connect(documentChanged);
+    app.signalRelabelDocument.connect(documentChanged);
+    app.signalRenameDocument.connect(documentChanged);
+    app.signalUndoDocument.connect(documentChanged);
+    app.signalRedoDocument.connect(documentChanged);
+}
+
+ExpressionProgram::ExpressionProgram()
+    :d(new Private)
+{
+}
+
+ExpressionProgram::~ExpressionProgram()
+{
+}
+
+std::unique_ptr<ExpressionProgram> ExpressionProgram::compile(const Expression *expr)
+{
+    std::unique_ptr<ExpressionProgram> program;
+    if (!expr)
+        return program;
+
+    initProgramSignals();
+
+    program.reset(new ExpressionProgram);
+    auto &d = *program->d;
+    try {
+        Base::PyGILStateLocker lock;
+        d.compile(expr);
+    } catch (Base::Exception &e) {
+        FC_LOG("Failed to compile expression " << expr->toStr() << ": " << e.what());
+        program.reset();
+        return program;
+    }
+
+    // Nothing to gain if the whole expression goes through the tree walker
+    if (d.invalid || (d.code.size()==1 && d.code[0].code==PROG_EVAL))
+        program.reset();
+    return program;
+}
+
+bool ExpressionProgram::evaluate(App::any &value) const
+{
+    // Local variables are not visible to the program, so only handle top
+    // level evaluation.
+    if (d->disabled || !_EvalStack.empty())
+        return false;
+
+    d->checkEpoch();
+    d->concurrent = false;
+    return d->run(value);
+}
+
+bool ExpressionProgram::prepareConcurrent() const
+{
+    if (d->disabled || d->nodes.size())
+        return false;
+
+    d->checkEpoch();
+    Base::PyGILStateLocker lock;
+    for (auto &slot : d->slots) {
+        if (slot.type == SlotUnresolved)
+            d->resolve(slot);
+        if (slot.type == SlotPython)
+            return false;
+    }
+    return true;
+}
+
+bool ExpressionProgram::evaluateConcurrent(App::any &value) const
+{
+    // The slots are resolved by prepareConcurrent(), and the epoch is only
+    // changed in the main thread.
+    if (d->disabled || d->epoch != _ProgramEpoch)
+        return false;
+
+    d->concurrent = true;
+    return d->run(value);
+}
+
+bool ExpressionProgram::Private::run(App::any &value)
+{
+    ProgramValue buffer[16];
+    std::vector<ProgramValue> heap;
+    ProgramValue *stack = buffer;
+    if (maxDepth > 16) {
+        heap.resize(maxDepth);
+        stack = &heap[0];
+    }
+    ProgramValue *sp = stack;
+
+    try {
+        std::size_t pc = 0;
+        std::size_t count = code.size();
+        while (pc < count) {
+            const auto &inst = code[pc++];
+            switch(inst.code) {
+            case PROG_PUSH:
+                *sp++ = constants[inst.arg];
+                break;
+            case PROG_LOAD:
+                load(slots[inst.arg], *sp++);
+                break;
+            case PROG_EVAL:
+                eval(nodes[inst.arg], *sp++);
+                break;
+            case PROG_UNARY:
+                programUnary(inst.arg, sp[-1]);
+                break;
+            case PROG_BINARY:
+                --sp;
+                try {
+                    programBinary(inst.arg, sp[-1], *sp);
+                } catch (Base::Exception &) {
+                    // unit overflow
+                    throw ProgramBailout();
+                }
+                break;
+            case PROG_FUNC: {
+                const auto &func = functions[inst.arg];
+                sp -= func.argc;
+                call(func, sp);
+                ++sp;
+                break;
+            }
+            case PROG_TEST:
+                sp[-1].setBool(sp[-1].isTrue());
+                break;
+            case PROG_JUMP:
+                pc = inst.arg;
+                break;
+            case PROG_JUMP_FALSE:
+                --sp;
+                if (!sp->isTrue())
+                    pc = inst.arg;
+                break;
+            case PROG_AND:
+            case PROG_OR: {
+                bool test = sp[-1].isTrue();
+                if (test == (inst.code == PROG_OR)) {
+                    sp[-1].setBool(test);
+                    pc = inst.arg;
+                }
+                else
+                    --sp;
+                break;
+            }
+            default:
+                assert(0);
+                throw ProgramBailout(true);
+            }
+        }
+    } catch (ProgramBailout &e) {
+        if (e.permanent)
+            disabled = true;
+        return false;
+    }
+
+    assert(sp == stack + 1);
+    value = programValueToAny(stack[0], concurrent);
+    return true;
+}
+
+std::size_t ExpressionProgram::size() const
+{
+    return d->code.size();
+}
+
+std::size_t ExpressionProgram::fallbackCount() const
+{
+    return d->nodes.size();
+}
+
+void ExpressionProgram::invalidateSlots()
+{
+    ++_ProgramEpoch;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 
 static Base::XMLReader *_Reader = 0;
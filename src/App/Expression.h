@@ -24,6 +24,7 @@
 #define EXPRESSION_H
 
 #include <string>
+#include <memory>
 #include <boost/pool/pool_alloc.hpp>
 #include <boost/tuple/tuple.hpp>
 #include <Base/Exception.h>
@@ -299,6 +300,83 @@ public:
     std::string comment;
 };
 
+/** Flat bytecode form of an expression
+ *
+ * The program is lowered from an expression tree by compiling numerical nodes,
+ * i.e. numbers, units, arithmetic and comparison operators, conditionals and
+ * the built-in math functions, into a linear list of instructions working on a
+ * stack of typed values. Values carrying a unit use Base::Quantity arithmetic.
+ *
+ * Property references are compiled into slots that are resolved on first use,
+ * and re-resolved after any change that may invalidate the resolution, e.g.
+ * object deletion, relabel, or dynamic property addition and removal. Nodes
+ * that cannot be lowered, e.g. those involving Python objects, are evaluated
+ * through the normal tree walker, and their result is pushed on the stack.
+ *
+ * The program produces the same result as
+ * Expression::getValueAsAny(Expression::OptionCallFrame). It holds raw
+ * pointers to the nodes of the expression, and must not outlive it.
+ */
+class AppExport ExpressionProgram {
+public:
+    ~ExpressionProgram();
+
+    /** Compile the given expression
+     *
+     * @return Return the compiled program, or null if there is nothing to
+     * gain by compiling, e.g. for a Python statement.
+     */
+    static std::unique_ptr<ExpressionProgram> compile(const Expression *expr);
+
+    /** Evaluate the program
+     *
+     * @param value: returns the evaluated value
+     *
+     * @return Return false if the program cannot handle this evaluation, in
+     * which case the caller shall evaluate the expression tree instead. Errors
+     * are reported by exception the same way as the tree walker.
+     */
+    bool evaluate(App::any &value) const;
+
+    /** Prepare the program for evaluateConcurrent()
+     *
+     * Resolves the property slots in the calling thread.
+     *
+     * @return Return true if the program can be evaluated without the tree
+     * walker, i.e. it has no node left to the tree walker and only reads
+     * plain numeric properties.
+     */
+    bool prepareConcurrent() const;
+
+    /** Evaluate a prepared program without Python and the evaluation stack
+     *
+     * Several programs can be evaluated at the same time this way, as long
+     * as the properties they read are not modified meanwhile. Unlike
+     * evaluate(), a boolean result is returned as bool.
+     *
+     * @return Return false if the program cannot handle this evaluation, in
+     * which case the caller shall evaluate the expression tree instead. This
+     * includes errors, which are reported by the tree walker.
+     */
+    bool evaluateConcurrent(App::any &value) const;
+
+    /// Return the number of instructions
+    std::size_t size() const;
+
+    /// Return the number of nodes evaluated through the tree walker
+    std::size_t fallbackCount() const;
+
+    /// Mark all resolved property slots of all programs as invalid
+    static void invalidateSlots();
+
+private:
+    ExpressionProgram();
+
+private:
+    struct Private;
+    std::unique_ptr<Private> d;
+};
+
 } // end of namespace App
 
 #endif // EXPRESSION_H
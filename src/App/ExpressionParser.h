@@ -482,6 +482,8 @@ protected:
     virtual ExpressionPtr _copy() const;
     virtual Py::Object _getPyValue(int *jumpCode=0) const;
 
+    friend class ExpressionProgram;
+
     ExpressionPtr condition;  /**< Condition */
     ExpressionPtr trueExpr;  /**< Expression if abs(condition) is > 0.5 */
     ExpressionPtr falseExpr; /**< Expression if abs(condition) is < 0.5 */
@@ -515,6 +517,8 @@ protected:
     virtual Py::Object _getPyValue(int *jumpCode=0) const;
     static Py::Object evalAggregate(const Expression *owner, int type, const ExpressionList &args);
 
+    friend class ExpressionProgram;
+
     int f;        /**< Function to execute */
     ExpressionList args; /** Arguments to function*/
 };
@@ -554,6 +558,8 @@ protected:
     virtual void _toString(std::ostream &ss, bool persistent, int indent) const;
     virtual ExpressionPtr _copy() const;
 
+    friend class ExpressionProgram;
+
 protected:
     ExpressionPtr expr;
     std::string name;
@@ -279,6 +279,11 @@ public:
         return FeatureT::canLoadPartial();
     }
 
+    /// Python feature must always be recomputed in the main thread
+    virtual bool canRecomputeConcurrently() const override {
+        return false;
+    }
+
     PyObject *getPyObject(void) {
         if (FeatureT::PythonObject.is(Py::_None())) {
             // ref counter is set to 1
@@ -212,8 +212,12 @@ void GeoFeature::updateElementReference() {
 
 void GeoFeature::onChanged(const Property *prop) {
     if(prop==getPropertyOfGeometry()) {
-        if(!isRestoring() && getDocument() && !getDocument()->isPerformingTransaction())
-            updateElementReference();
+        if(!isRestoring() && getDocument() && !getDocument()->isPerformingTransaction()) {
+            // this updates the links of other objects
+            Document::callInMainThread([this]() {
+                updateElementReference();
+            });
+        }
     }
     DocumentObject::onChanged(prop);
 }
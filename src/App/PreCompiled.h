@@ -72,6 +72,7 @@
 #include <queue>
 #include <bitset>
 #include <exception>
+#include <atomic>
 #include <random>
 #include <unordered_set>
 #include <unordered_map>
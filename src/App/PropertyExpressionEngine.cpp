@@ -120,6 +120,14 @@ Property *PropertyExpressionEngine::Copy() const
 
 void PropertyExpressionEngine::hasSetValue()
 {
+    // Expressions may have been modified in place, recompile on next execute
+    for(auto &e : expressions) {
+        e.second.program.reset();
+        e.second.compiled = false;
+        e.second.stamp = 0;
+    }
+    evaluationOrderValid = false;
+
     App::DocumentObject *owner = dynamic_cast<App::DocumentObject*>(getContainer());
     if(!owner || !owner->getNameInDocument() || owner->isRestoring() || testFlag(LinkDetached)) {
         PropertyExpressionContainer::hasSetValue();
@@ -431,6 +439,26 @@ struct cycle_detector : public boost::dfs_visitor<> {
     int & _src;
 };
 
+/**
+ * @brief Check whether the binding of the given property is selected by \a option.
+ */
+
+static bool isSelected(const Property *prop, PropertyExpressionEngine::ExecuteOption option)
+{
+    if(option == PropertyExpressionEngine::ExecuteAll)
+        return true;
+    bool is_output = prop->testStatus(App::Property::Output)||(prop->getType()&App::Prop_Output);
+    if((is_output && option==PropertyExpressionEngine::ExecuteNonOutput)
+            || (!is_output && option==PropertyExpressionEngine::ExecuteOutput))
+        return false;
+    if(option == PropertyExpressionEngine::ExecuteOnRestore
+            && !prop->testStatus(Property::Transient)
+            && !(prop->getType() & Prop_Transient)
+            && !prop->testStatus(Property::EvalOnRestore))
+        return false;
+    return true;
+}
+
 /**
  * @brief Build a graph of all expressions in \a exprs.
  * @param exprs Expressions to use in graph
@@ -451,13 +479,7 @@ void PropertyExpressionEngine::buildGraph(const ExpressionMap & exprs,
             auto prop = it->first.getProperty();
             if(!prop)
                 throw Base::RuntimeError("Path does not resolve to a property.");
-            bool is_output = prop->testStatus(App::Property::Output)||(prop->getType()&App::Prop_Output);
-            if((is_output && option==ExecuteNonOutput) || (!is_output && option==ExecuteOutput))
-                continue;
-            if(option == ExecuteOnRestore 
-                    && !prop->testStatus(Property::Transient)
-                    && !(prop->getType() & Prop_Transient)
-                    && !prop->testStatus(Property::EvalOnRestore))
+            if(!isSelected(prop, option))
                 continue;
         }
         buildGraphStructures(it->first, it->second.expression, nodes, revNodes, edges);
@@ -509,6 +531,99 @@ std::vector<App::ObjectIdentifier> PropertyExpressionEngine::computeEvaluationOr
     return evaluationOrder;
 }
 
+/**
+ * @brief Return the evaluation order for \a option.
+ *
+ * The order of all expressions is computed once and cached until the
+ * expressions are changed. Since any subset of a topological order is still
+ * in topological order, the caller only needs to skip the expressions not
+ * selected by \a option.
+ */
+
+const std::vector<App::ObjectIdentifier> &PropertyExpressionEngine::getEvaluationOrder(ExecuteOption option)
+{
+    if(!evaluationOrderValid) {
+        ++executeStats.graphBuilds;
+        try {
+            evaluationOrder = computeEvaluationOrder(ExecuteAll);
+            evaluationOrderValid = true;
+        } catch (Base::Exception &) {
+            // Expressions restored from file are not validated, so the full
+            // graph may be cyclic while the selected subset is not. Fall back
+            // to the subset graph, which reports the cycle if there is one.
+            evaluationOrder.clear();
+            if(option == ExecuteAll)
+                throw;
+            tmpEvaluationOrder = computeEvaluationOrder(option);
+            return tmpEvaluationOrder;
+        }
+    }
+    return evaluationOrder;
+}
+
+/**
+ * @brief Check whether any input of an expression has changed since its last evaluation.
+ * @param info Expression to check
+ * @param prop The bound property
+ * @return True if the expression must be evaluated.
+ *
+ * Properties of the owner object are checked by their touched status, which
+ * is kept until the owner is recomputed, and by the change stamp of the owner,
+ * because the owner's execute() may change them after the expression was
+ * checked. Other objects are purged right after their own recompute, so only
+ * their change stamp is checked. Unresolved
+ * dependencies are not reported by Expression::getDeps(), so the number of
+ * dependencies is compared, too, to catch deleted objects.
+ */
+
+bool PropertyExpressionEngine::needEvaluate(ExpressionInfo &info, const Property *prop)
+{
+    // Never evaluated, or the bound property was changed by someone else
+    bool changed = !info.stamp || prop->isTouched();
+
+    auto owner = getContainer();
+    std::size_t count = 0;
+    try {
+        for(auto &dep : info.expression->getDeps()) {
+            for(auto &v : dep.second) {
+                if(v.first.empty()) {
+                    // reference to the object itself
+                    ++count;
+                    if(dep.first == owner || dep.first->getChangeStamp() > info.stamp)
+                        changed = true;
+                    continue;
+                }
+                for(auto &path : v.second) {
+                    ++count;
+                    int ptype;
+                    Property *p = path.getProperty(&ptype);
+                    // Pseudo properties are not tracked
+                    if(!p || ptype) {
+                        changed = true;
+                        continue;
+                    }
+                    auto obj = freecad_dynamic_cast<DocumentObject>(p->getContainer());
+                    if(!obj)
+                        changed = true;
+                    else if(obj == owner) {
+                        if(p->isTouched() || obj->getChangeStamp() > info.ownerStamp)
+                            changed = true;
+                    } else if(obj->getChangeStamp() > info.stamp)
+                        changed = true;
+                }
+            }
+        }
+    } catch (Base::Exception &) {
+        // let evaluation report the error
+        return true;
+    }
+    if(count != info.depCount) {
+        info.depCount = count;
+        changed = true;
+    }
+    return changed;
+}
+
 /**
  * @brief Compute and update values of all registered expressions.
  * @return StdReturn on success.
@@ -521,7 +636,7 @@ DocumentObjectExecReturn *App::PropertyExpressionEngine::execute(ExecuteOption o
     if (!docObj)
         throw Base::RuntimeError("PropertyExpressionEngine must be owned by a DocumentObject.");
 
-    if (running)
+    if (running || expressions.empty())
         return DocumentObject::StdReturn;
 
     if(option == ExecuteOnRestore) {
@@ -557,16 +672,27 @@ DocumentObjectExecReturn *App::PropertyExpressionEngine::execute(ExecuteOption o
 
     resetter r(running);
 
-    // Compute evaluation order
-    std::vector<App::ObjectIdentifier> evaluationOrder = computeEvaluationOrder(option);
-    std::vector<ObjectIdentifier>::const_iterator it = evaluationOrder.begin();
+    auto hGrp = GetApplication().GetParameterGroupByPath(
+            "User parameter:BaseApp/Preferences/Expression");
+    bool compile = hGrp->GetBool("CompileExpression",false);
+    // Transient bindings evaluated on restore have no value yet
+    bool incremental = option != ExecuteOnRestore && hGrp->GetBool("IncrementalExecute",true);
+
+    // Take the stamp before evaluation, so that any change made during
+    // evaluation is caught next time.
+    auto stamp = DocumentObject::currentChangeStamp();
+
+    // Get evaluation order
+    const auto &order = getEvaluationOrder(option);
+    std::vector<ObjectIdentifier>::const_iterator it = order.begin();
+    std::vector<ExpressionInfo*> checked;
 
 #ifdef FC_PROPERTYEXPRESSIONENGINE_LOG
     std::clog << "Computing expressions for " << getName() << std::endl;
 #endif
 
     /* Evaluate the expressions, and update properties */
-    for (;it != evaluationOrder.end();++it) {
+    for (;it != order.end();++it) {
 
         // Get property to update
         Property * prop = it->getProperty();
@@ -574,23 +700,48 @@ DocumentObjectExecReturn *App::PropertyExpressionEngine::execute(ExecuteOption o
         if (!prop)
             throw Base::RuntimeError("Path does not resolve to a property.");
 
+        if (!isSelected(prop, option))
+            continue;
+
         DocumentObject* parent = freecad_dynamic_cast<DocumentObject>(prop->getContainer());
 
         /* Make sure property belongs to the same container as this PropertyExpressionEngine */
         if (parent != docObj)
             throw Base::RuntimeError("Invalid property owner.");
 
+        auto iter = expressions.find(*it);
+        if (iter == expressions.end())
+            continue;
+        auto &info = iter->second;
+        checked.push_back(&info);
+
+        if (incremental && !needEvaluate(info, prop)) {
+            ++executeStats.skipped;
+            continue;
+        }
+        ++executeStats.evaluated;
+        // stays cleared on error, so that the error is reported again next time
+        info.stamp = 0;
+
         /* Set value of property */
         App::any value;
         try {
-            value = expressions[*it].expression->getValueAsAny(Expression::OptionCallFrame);
+            if(compile && !info.compiled) {
+                info.compiled = true;
+                info.program = ExpressionProgram::compile(info.expression.get());
+            }
+            if(!compile || !info.program || !info.program->evaluate(value))
+                value = info.expression->getValueAsAny(Expression::OptionCallFrame);
             if(option == ExecuteOnRestore && prop->testStatus(Property::EvalOnRestore)) {
-                if(isAnyEqual(value, prop->getPathValue(*it)))
+                if(isAnyEqual(value, prop->getPathValue(*it))) {
+                    info.stamp = stamp;
                     continue;
+                }
                 if(touched)
                     *touched = true;
             }
             prop->setPathValue(*it, value);
+            info.stamp = stamp;
         }catch(Base::Exception &e) {
             std::ostringstream ss;
             ss << e.what() << "\nin property binding '" << prop->getName() << "'";
@@ -607,6 +758,12 @@ DocumentObjectExecReturn *App::PropertyExpressionEngine::execute(ExecuteOption o
             throw Base::RuntimeError(ss.str().c_str());
         }
     }
+
+    // Changes of the owner made by the bindings above have been checked in
+    // order, only later changes matter from now on.
+    auto ownerStamp = docObj->getChangeStamp();
+    for(auto info : checked)
+        info->ownerStamp = ownerStamp;
     return DocumentObject::StdReturn;
 }
 
@@ -85,6 +85,17 @@ public:
 
     struct ExpressionInfo {
         boost::shared_ptr<App::Expression> expression; /**< The actual expression tree */
+        /** Compiled form of the expression, created on demand and not copied */
+        std::unique_ptr<App::ExpressionProgram> program;
+        bool compiled = false;
+        /** Global change stamp of the last evaluation, zero if not yet
+         * evaluated. See DocumentObject::getChangeStamp() */
+        unsigned long long stamp = 0;
+        /** Change stamp of the owner at the end of the last execute() that
+         * checked the expression */
+        unsigned long long ownerStamp = 0;
+        /** Number of resolved dependencies on the last check */
+        std::size_t depCount = 0;
 
         ExpressionInfo(boost::shared_ptr<App::Expression> expression = boost::shared_ptr<App::Expression>()) {
             this->expression = expression;
@@ -96,6 +107,11 @@ public:
 
         ExpressionInfo & operator=(const ExpressionInfo & other) {
             expression = other.expression;
+            program.reset();
+            compiled = false;
+            stamp = 0;
+            ownerStamp = 0;
+            depCount = 0;
             return *this;
         }
     };
@@ -140,6 +156,20 @@ public:
      */
     DocumentObjectExecReturn * execute(ExecuteOption option=ExecuteAll, bool *touched=0);
 
+    /// Statistics of execute()
+    struct ExecuteStats {
+        /// number of evaluated expressions
+        unsigned long evaluated = 0;
+        /// number of expressions skipped because none of their inputs changed
+        unsigned long skipped = 0;
+        /// number of times the dependency graph was built
+        unsigned long graphBuilds = 0;
+    };
+    /// Return the statistics of execute() since creation or the last reset
+    const ExecuteStats &getExecuteStats() const { return executeStats; }
+    /// Reset the statistics of execute()
+    void resetExecuteStats() { executeStats = ExecuteStats(); }
+
     void getPathsToDocumentObject(DocumentObject*, std::vector<App::ObjectIdentifier> & paths) const;
 
     bool depsAreTouched() const;
@@ -178,6 +208,10 @@ private:
 
     std::vector<App::ObjectIdentifier> computeEvaluationOrder(ExecuteOption option);
 
+    const std::vector<App::ObjectIdentifier> &getEvaluationOrder(ExecuteOption option);
+
+    bool needEvaluate(ExpressionInfo &info, const Property *prop);
+
     void buildGraphStructures(const App::ObjectIdentifier &path,
                               const boost::shared_ptr<Expression> expression, boost::unordered_map<App::ObjectIdentifier, int> &nodes,
                               boost::unordered_map<int, App::ObjectIdentifier> &revNodes, std::vector<Edge> &edges) const;
@@ -193,6 +227,14 @@ private:
 
     ValidatorFunc validator; /**< Valdiator functor */
 
+    /**< Evaluation order of all expressions, cached until the expressions are changed */
+    std::vector<App::ObjectIdentifier> evaluationOrder;
+    bool evaluationOrderValid = false;
+    /**< Evaluation order used if the cached one is not applicable */
+    std::vector<App::ObjectIdentifier> tmpEvaluationOrder;
+
+    ExecuteStats executeStats;
+
     struct RestoredExpression {
         std::string path;
         std::string expr;
@@ -24,7 +24,9 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+# include <algorithm>
 # include <cassert>
+# include <climits>
 #endif
 
 #include <atomic>
@@ -111,7 +113,21 @@ int Transaction::getLastID() {
 
 unsigned int Transaction::getMemSize (void) const
 {
-    return 0;
+    return (unsigned int)std::min<std::size_t>(getTotalMemSize(), UINT_MAX);
+}
+
+std::size_t Transaction::getTotalMemSize (void) const
+{
+    std::size_t size = 0;
+    auto &index = _Objects.get<0>();
+    for (auto &info : index) {
+        size += info.second->getTotalMemSize();
+        // an object removed from the document is owned by the transaction
+        if (info.second->status == TransactionObject::New
+                && !info.first->isAttachedToDocument())
+            size += info.first->getMemSize();
+    }
+    return size;
 }
 
 void Transaction::Save (Base::Writer &/*writer*/) const
@@ -405,7 +421,19 @@ void TransactionObject::addOrRemoveProperty(const Property* pcProp, bool add)
 
 unsigned int TransactionObject::getMemSize (void) const
 {
-    return 0;
+    return (unsigned int)std::min<std::size_t>(getTotalMemSize(), UINT_MAX);
+}
+
+std::size_t TransactionObject::getTotalMemSize (void) const
+{
+    // Note: properties sharing their data with the document only count
+    // what they hold on their own
+    std::size_t size = 0;
+    for (auto &v : _PropChangeMap) {
+        if (v.second.property)
+            size += v.second.property->getMemSize();
+    }
+    return size;
 }
 
 void TransactionObject::Save (Base::Writer &/*writer*/) const
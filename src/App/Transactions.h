@@ -64,6 +64,8 @@ public:
     std::string Name;
 
     virtual unsigned int getMemSize (void) const;
+    /// Return the memory size in bytes, not limited to the range of unsigned int
+    std::size_t getTotalMemSize (void) const;
     virtual void Save (Base::Writer &writer) const;
     /// This method is used to restore properties from an XML document.
     virtual void Restore(Base::XMLReader &reader);
@@ -119,6 +121,8 @@ public:
     void addOrRemoveProperty(const Property* pcProp, bool add);
 
     virtual unsigned int getMemSize (void) const;
+    /// Return the memory size in bytes, not limited to the range of unsigned int
+    std::size_t getTotalMemSize (void) const;
     virtual void Save (Base::Writer &writer) const;
     /// This method is used to restore properties from an XML document.
     virtual void Restore(Base::XMLReader &reader);
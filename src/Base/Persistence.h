@@ -146,6 +146,15 @@ public:
      * @see Base::Reader,Base::XMLReader
      */
     virtual void RestoreDocFile(Reader &/*reader*/);
+    /** Whether SaveDocFile() can be called in a worker thread
+     *
+     * ZipWriter may serialize and compress the requested files concurrently
+     * if enabled. An object shall only return true if its SaveDocFile()
+     * reads nothing but its own data, does not call Writer::addFile(), and
+     * does not touch any Python or GUI object. The default implementation
+     * returns false, i.e. SaveDocFile() is always called in the main thread.
+     */
+    virtual bool canSaveDocFileConcurrently() const {return false;}
     /// Encodes an attribute upon saving.
     static std::string encodeAttribute(const std::string&);
 
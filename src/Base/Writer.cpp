@@ -31,6 +31,7 @@
 #include "Persistence.h"
 #include "Exception.h"
 #include "Base64.h"
+#include "Console.h"
 #include "FileInfo.h"
 #include "Stream.h"
 #include "Tools.h"
@@ -39,6 +40,16 @@
 #include <locale>
 #include <limits>
 #include <iomanip>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <zlib.h>
+
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+
+FC_LOG_LEVEL_INIT("Writer",true,true);
 
 using namespace Base;
 using namespace std;
@@ -349,6 +360,11 @@ void ZipWriter::putNextEntry(const char *file, const char *obj) {
 
 void ZipWriter::writeFiles(void)
 {
+    if (ThreadCount > 1) {
+        writeFilesConcurrently();
+        return;
+    }
+
     // use a while loop because it is possible that while
     // processing the files new ones can be added
     size_t index = 0;
@@ -362,6 +378,200 @@ void ZipWriter::writeFiles(void)
     }
 }
 
+namespace {
+
+// Writer used by the worker threads of ZipWriter::writeFilesConcurrently()
+// to serialize an object into memory
+class BufferWriter : public Writer
+{
+public:
+    explicit BufferWriter(Writer &parent)
+    {
+        setModes(parent.getModes());
+        setFileVersion(parent.getFileVersion());
+        setPreferBinary(parent.isPreferBinary());
+        setForceXML(parent.isForceXML());
+        setSplitXML(parent.isSplitXML());
+        // same stream setup as ZipWriter
+#ifdef _MSC_VER
+        OutStream.imbue(std::locale::empty());
+#else
+        OutStream.imbue(std::locale::classic());
+#endif
+        OutStream.precision(std::numeric_limits<double>::digits10 + 1);
+        OutStream.setf(ios::fixed,ios::floatfield);
+    }
+
+    virtual std::ostream &Stream(void) {return OutStream;}
+    virtual void writeFiles(void) {}
+
+    std::ostringstream OutStream;
+};
+
+class SaveRunnable : public QRunnable
+{
+public:
+    explicit SaveRunnable(std::function<void()> &&func)
+        :func(std::move(func))
+    {}
+
+    virtual void run() {
+        func();
+    }
+
+private:
+    std::function<void()> func;
+};
+
+struct SaveTask
+{
+    std::string FileName;
+    const Base::Persistence *Object;
+    bool concurrent = false;
+    std::unique_ptr<BufferWriter> writer;
+    std::string data;
+    uint32 crc = 0;
+    uint32 size = 0;
+    std::exception_ptr error;
+    FC_DURATION serializeTime = FC_DURATION(0);
+    FC_DURATION deflateTime = FC_DURATION(0);
+    QSemaphore done;
+
+    void run(int level) {
+        try {
+            FC_TIME_INIT(t);
+            writer->putNextEntry(FileName.c_str());
+            Object->SaveDocFile(*writer);
+            std::string raw = writer->OutStream.str();
+            writer->OutStream.str(std::string());
+            serializeTime = Base::GetDuration(t);
+
+            FC_TIME_INIT(t1);
+            if (raw.size() > std::numeric_limits<uInt>::max())
+                throw Base::FileException("File too large for the archive", FileName.c_str());
+            size = static_cast<uint32>(raw.size());
+            crc = crc32(crc32(0, Z_NULL, 0),
+                    reinterpret_cast<const Bytef*>(raw.data()), static_cast<uInt>(raw.size()));
+
+            // raw deflate stream without zlib header as required by zip
+            z_stream zs;
+            zs.zalloc = Z_NULL;
+            zs.zfree = Z_NULL;
+            zs.opaque = Z_NULL;
+            if (deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+                throw Base::RuntimeError("Failed to initialize deflate");
+            data.resize(deflateBound(&zs, static_cast<uLong>(raw.size())));
+            zs.next_in = reinterpret_cast<Bytef*>(&raw[0]);
+            zs.avail_in = static_cast<uInt>(raw.size());
+            zs.next_out = reinterpret_cast<Bytef*>(&data[0]);
+            zs.avail_out = static_cast<uInt>(data.size());
+            int err = deflate(&zs, Z_FINISH);
+            data.resize(zs.total_out);
+            deflateEnd(&zs);
+            if (err != Z_STREAM_END)
+                throw Base::RuntimeError("Failed to deflate file content");
+            deflateTime = Base::GetDuration(t1);
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        done.release();
+    }
+};
+
+} // anonymous namespace
+
+void ZipWriter::writeFilesConcurrently()
+{
+    FC_TIME_INIT(t);
+    FC_DURATION_DECL_INIT2(dSerialize,dDeflate);
+    FC_DURATION_DECL_INIT2(dWrite,dMain);
+    double rawSize = 0, zipSize = 0;
+    std::size_t concurrentCount = 0;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(ThreadCount);
+
+    // limit the number of buffered files
+    const std::size_t window = 2 * ThreadCount;
+    std::deque<std::shared_ptr<SaveTask> > pending;
+
+    // use index because it is possible that while processing the files new
+    // ones can be added
+    size_t index = 0;
+    auto schedule = [&]() {
+        while (index < FileList.size() && pending.size() < window) {
+            const FileEntry &entry = FileList[index++];
+            auto task = std::make_shared<SaveTask>();
+            task->FileName = entry.FileName;
+            task->Object = entry.Object;
+            if (entry.Object->canSaveDocFileConcurrently()) {
+                task->concurrent = true;
+                task->writer.reset(new BufferWriter(*this));
+                int level = Level;
+                pool.start(new SaveRunnable([task,level]() {task->run(level);}));
+            }
+            pending.push_back(task);
+        }
+    };
+
+    for (schedule(); pending.size(); schedule()) {
+        auto task = pending.front();
+        pending.pop_front();
+
+        if (!task->concurrent) {
+            FC_TIME_INIT(t1);
+            putNextEntry(task->FileName.c_str());
+            indent = 0;
+            indBuf[0] = 0;
+            task->Object->SaveDocFile(*this);
+            FC_DURATION_PLUS(dMain,t1);
+            continue;
+        }
+
+        task->done.acquire();
+        if (task->error)
+            std::rethrow_exception(task->error);
+
+        for (auto &error : task->writer->getErrors())
+            addError(error);
+        if (task->writer->getFilenames().size())
+            addError(std::string("Cannot add file while saving ") + task->FileName + " concurrently");
+
+        FC_TIME_INIT(t1);
+        Writer::putNextEntry(task->FileName.c_str());
+        ZipStream.putDeflatedEntry(task->FileName, task->data.c_str(),
+                static_cast<uint32>(task->data.size()), task->crc, task->size);
+        FC_DURATION_PLUS(dWrite,t1);
+
+        ++concurrentCount;
+        rawSize += task->size;
+        zipSize += task->data.size();
+        dSerialize += task->serializeTime;
+        dDeflate += task->deflateTime;
+    }
+
+    if (FC_LOG_INSTANCE.isEnabled(FC_LOGLEVEL_LOG)) {
+        const double MB = 1024.0 * 1024.0;
+        auto rate = [](double size, const FC_DURATION &d) {
+            return d.count() > 0 ? size / d.count() : 0.0;
+        };
+        FC_DURATION total = Base::GetDuration(t);
+        FC_LOG("saved " << FileList.size() << " files, " << concurrentCount
+                << " concurrently using " << ThreadCount << " threads, "
+                << rawSize/MB << " MB -> " << zipSize/MB << " MB\n"
+                << "    serialize: " << dSerialize.count() << "s, "
+                    << rate(rawSize/MB, dSerialize) << " MB/s per thread\n"
+                << "    deflate: " << dDeflate.count() << "s, "
+                    << rate(rawSize/MB, dDeflate) << " MB/s per thread\n"
+                << "    write: " << dWrite.count() << "s, "
+                    << rate(zipSize/MB, dWrite) << " MB/s\n"
+                << "    main thread files: " << dMain.count() << "s\n"
+                << "    total: " << total.count() << "s, "
+                    << rate(rawSize/MB, total) << " MB/s");
+    }
+}
+
 ZipWriter::~ZipWriter()
 {
     ZipStream.close();
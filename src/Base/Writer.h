@@ -208,11 +208,26 @@ public:
     virtual std::ostream &Stream(void){return ZipStream;}
 
     void setComment(const char* str){ZipStream.setComment(str);}
-    void setLevel(int level){ZipStream.setLevel( level );}
+    void setLevel(int level){ZipStream.setLevel( level ); Level = level;}
     virtual void putNextEntry(const char *filename, const char *objName=0);
 
+    /** Set the number of threads used by writeFiles()
+     *
+     * With more than one thread, the content of the objects that support
+     * concurrent saving (see Persistence::canSaveDocFileConcurrently()) is
+     * serialized and deflated into memory buffers by worker threads, and
+     * then written into the archive in the original order.
+     */
+    void setThreadCount(int count) {ThreadCount = count;}
+    int getThreadCount() const {return ThreadCount;}
+
+private:
+    void writeFilesConcurrently();
+
 private:
     zipios::ZipOutputStream ZipStream;
+    int Level = 6;
+    int ThreadCount = 0;
 };
 
 /** The StringWriter class 
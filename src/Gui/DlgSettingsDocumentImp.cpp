@@ -83,6 +83,9 @@ void DlgSettingsDocumentImp::saveSettings()
     prefAutoSaveEnabled->onSave();
     prefAutoSaveTimeout->onSave();
     prefCanAbortRecompute->onSave();
+    prefConcurrentRecompute->onSave();
+    prefConcurrentSave->onSave();
+    prefLazyRestore->onSave();
 
     int timeout = prefAutoSaveTimeout->value();
     if (!prefAutoSaveEnabled->isChecked())
@@ -114,6 +117,9 @@ void DlgSettingsDocumentImp::loadSettings()
     prefAutoSaveEnabled->onRestore();
     prefAutoSaveTimeout->onRestore();
     prefCanAbortRecompute->onRestore();
+    prefConcurrentRecompute->onRestore();
+    prefConcurrentSave->onRestore();
+    prefLazyRestore->onRestore();
 }
 
 /**
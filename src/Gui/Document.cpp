@@ -217,6 +217,13 @@ Document::Document(App::Document* pcDocument,Application * app)
         d->_pcDocument->setUndoMode(1);
         // set the maximum stack size
         d->_pcDocument->setMaxUndoStackSize(App::GetApplication().GetParameterGroupByPath("User parameter:BaseApp/Preferences/Document")->GetInt("MaxUndoSize",20));
+        // set the memory limit of the undo stack in MB, zero means no limit.
+        // Note: a shape snapshot is counted with its full size because OCC
+        // cannot tell whether its sub-shapes are shared with the document,
+        // so the limit over-counts documents with many shape changes.
+        unsigned long undoMem = App::GetApplication().GetParameterGroupByPath
+            ("User parameter:BaseApp/Preferences/Document")->GetUnsigned("MaxUndoMemory",0);
+        d->_pcDocument->setUndoLimit((unsigned int)std::min<unsigned long>(undoMem, 4095) * 1024 * 1024);
     }
 }
 
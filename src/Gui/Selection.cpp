@@ -83,14 +83,14 @@ bool SelectionGateFilterExternal::allow(App::Document *doc ,App::DocumentObject
 //////////////////////////////////////////////////////////////////////////////////////////
 
 SelectionObserver::SelectionObserver(bool attach,int resolve)
-    :resolve(resolve),blockSelection(false)
+    :resolve(resolve),blockSelection(false),batchSelection(false)
 {
     if(attach)
         attachSelection();
 }
 
 SelectionObserver::SelectionObserver(const ViewProviderDocumentObject *vp,bool attach,int resolve)
-    :resolve(resolve),blockSelection(false)
+    :resolve(resolve),blockSelection(false),batchSelection(false)
 {
     if(vp && vp->getObject() && vp->getObject()->getDocument()) {
         filterDocName = vp->getObject()->getDocument()->getName();
@@ -126,6 +126,16 @@ bool SelectionObserver::isConnectionAttached() const
     return connectSelection.connected();
 }
 
+void SelectionObserver::setBatchSelection(bool enable)
+{
+    batchSelection = enable;
+}
+
+bool SelectionObserver::isBatchSelection() const
+{
+    return batchSelection;
+}
+
 void SelectionObserver::attachSelection()
 {
     if (!connectSelection.connected()) {
@@ -144,6 +154,9 @@ void SelectionObserver::_onSelectionChanged(const SelectionChanges& msg) {
     try {
         if (blockSelection)
             return;
+        // a batched change is either notified as a whole or per sub-element
+        if (batchSelection ? msg.BatchElement : !msg.SubNames.empty())
+            return;
         onSelectionChanged(msg);
     } catch (Base::Exception &e) {
         e.ReportException();
@@ -595,7 +608,9 @@ void SelectionSingleton::notify(SelectionChanges &&Chng) {
             notify = true;
         }
         if(notify) {
-            Notify(msg);
+            // the observers of the subject get the messages per sub-element
+            if(msg.SubNames.empty())
+                Notify(msg);
             signalSelectionChanged(msg);
         }
         NotificationQueue.pop_front();
@@ -737,6 +752,7 @@ void SelectionSingleton::slotSelectionChanged(const SelectionChanges& msg) {
         msg2.pOriginalMsg = &msg;
         msg2.pParentObject = pParent;
         msg2.pSubObject = pObject;
+        msg2.BatchElement = msg.BatchElement;
         signalSelectionChanged3(msg2);
 
         msg2.SubName = oldElementName;
@@ -988,6 +1004,153 @@ void SelectionSingleton::_SelObj::log(bool remove, bool clearPreselect) {
     Application::Instance->macroManager()->addLine(MacroManager::Cmt, ss.str().c_str());
 }
 
+static std::string selectionKey(const std::string &docName,
+        const std::string &objName, const char *subName)
+{
+    std::string key;
+    key.reserve(docName.size()+objName.size()+(subName?strlen(subName):0)+2);
+    key += docName;
+    key += '#';
+    key += objName;
+    key += '.';
+    if(subName)
+        key += subName;
+    return key;
+}
+
+// Key of the element matched by checkSelection() with resolve==1, which is
+// the new style element name if available or else the sub name
+static std::string elementKey(const std::string &newName, const std::string &oldName)
+{
+    if(newName.size())
+        return std::string("N") + newName;
+    return std::string("O") + oldName;
+}
+
+SelectionSingleton::_SelIter SelectionSingleton::addSelObj(const _SelObj &sel) {
+    auto it = _SelList.insert(_SelList.end(),sel);
+    it->order = ++_SelCounter;
+    _SelMap[selectionKey(it->DocName,it->FeatName,it->SubName.c_str())] = it;
+    _SelObjMap[it->pObject].entries[it->order] = it;
+    auto &index = _SelResolvedMap[it->pResolvedObject];
+    index.entries[it->order] = it;
+    ++index.elements[elementKey(it->elementName.first,it->SubName)];
+    return it;
+}
+
+SelectionSingleton::_SelIter SelectionSingleton::eraseSelObj(_SelIter it) {
+    _SelMap.erase(selectionKey(it->DocName,it->FeatName,it->SubName.c_str()));
+    auto iter = _SelObjMap.find(it->pObject);
+    if(iter != _SelObjMap.end()) {
+        iter->second.entries.erase(it->order);
+        if(iter->second.entries.empty())
+            _SelObjMap.erase(iter);
+    }
+    iter = _SelResolvedMap.find(it->pResolvedObject);
+    if(iter != _SelResolvedMap.end()) {
+        auto &index = iter->second;
+        index.entries.erase(it->order);
+        auto element = index.elements.find(elementKey(it->elementName.first,it->SubName));
+        if(element != index.elements.end() && --element->second <= 0)
+            index.elements.erase(element);
+        if(index.entries.empty())
+            _SelResolvedMap.erase(iter);
+    }
+    return _SelList.erase(it);
+}
+
+void SelectionSingleton::clearSelObjs() {
+    _SelList.clear();
+    _SelMap.clear();
+    _SelObjMap.clear();
+    _SelResolvedMap.clear();
+}
+
+void SelectionSingleton::removeSelObjs(const _SelObj &temp, std::vector<SelectionChanges> &changes) {
+    std::vector<_SelIter> matches;
+    // if no subname is specified, remove all subobjects of the matching object,
+    // otherwise match subobjects with common prefix, separated by '.'
+    if(temp.SubName.size() && temp.SubName.back()!='.') {
+        auto it = _SelMap.find(selectionKey(temp.DocName,temp.FeatName,temp.SubName.c_str()));
+        if(it != _SelMap.end())
+            matches.push_back(it->second);
+    }else{
+        auto it = _SelObjMap.find(temp.pObject);
+        if(it != _SelObjMap.end()) {
+            for(auto &v : it->second.entries) {
+                auto &sel = *v.second;
+                if(sel.DocName==temp.DocName && sel.FeatName==temp.FeatName
+                        && boost::starts_with(sel.SubName,temp.SubName))
+                    matches.push_back(v.second);
+            }
+        }
+    }
+
+    for(auto it : matches) {
+        it->log(true);
+
+        changes.emplace_back(SelectionChanges::RmvSelection,
+                it->DocName,it->FeatName,it->SubName,it->TypeName);
+
+        // destroy the _SelObj item
+        eraseSelObj(it);
+    }
+}
+
+bool SelectionSingleton::allowSelection(_SelObj &temp) const {
+    if (!ActiveGate)
+        return true;
+    const char *subelement = 0;
+    auto pObject = getObjectOfType(temp,App::DocumentObject::getClassTypeId(),gateResolve,&subelement);
+    return ActiveGate->allow(pObject?pObject->getDocument():temp.pDoc,pObject,subelement);
+}
+
+void SelectionSingleton::notAllowedSelection() {
+    if (getMainWindow()) {
+        QString msg;
+        if (ActiveGate->notAllowedReason.length() > 0) {
+            msg = QObject::tr(ActiveGate->notAllowedReason.c_str());
+        } else {
+            msg = QCoreApplication::translate("SelectionFilter","Selection not allowed by filter");
+        }
+        getMainWindow()->showMessage(msg);
+        Gui::MDIView* mdi = Gui::Application::Instance->activeDocument()->getActiveView();
+        mdi->setOverrideCursor(Qt::ForbiddenCursor);
+    }
+    ActiveGate->notAllowedReason.clear();
+    QApplication::beep();
+}
+
+void SelectionSingleton::notifyChanges(std::vector<SelectionChanges> &&changes) {
+    if(changes.empty())
+        return;
+
+    if(changes.size() == 1) {
+        auto &Chng = changes.front();
+        FC_LOG((Chng.Type==SelectionChanges::AddSelection?"Add":"Rmv") << " Selection "
+                << Chng.DocName << '#' << Chng.ObjName << '.' << Chng.SubName);
+        notify(std::move(Chng));
+    }else{
+        // The observers accepting batched changes update their state of the
+        // object at once instead of handling each sub-element. All changes
+        // of a batch belong to the same object.
+        auto &front = changes.front();
+        FC_LOG("Batch selection " << front.DocName << '#' << front.ObjName
+                << " (" << changes.size() << " changes)");
+        SelectionChanges batch(SelectionChanges::SetSelection,
+                front.DocName,front.ObjName,std::string(),front.TypeName);
+        batch.BatchType = front.Type;
+        batch.SubNames.reserve(changes.size());
+        for(auto &Chng : changes) {
+            batch.SubNames.push_back(Chng.SubName);
+            Chng.BatchElement = true;
+            notify(std::move(Chng));
+        }
+        notify(std::move(batch));
+    }
+    getMainWindow()->updateActions();
+}
+
 bool SelectionSingleton::addSelection(const char* pDocName, const char* pObjectName, 
         const char* pSubName, float x, float y, float z, 
         const std::vector<SelObj> *pickedList, bool clearPreselect)
@@ -1020,31 +1183,15 @@ bool SelectionSingleton::addSelection(const char* pDocName, const char* pObjectN
     temp.z        = z;
 
     // check for a Selection Gate
-    if (ActiveGate) {
-        const char *subelement = 0;
-        auto pObject = getObjectOfType(temp,App::DocumentObject::getClassTypeId(),gateResolve,&subelement);
-        if (!ActiveGate->allow(pObject?pObject->getDocument():temp.pDoc,pObject,subelement)) {
-            if (getMainWindow()) {
-                QString msg;
-                if (ActiveGate->notAllowedReason.length() > 0) {
-                    msg = QObject::tr(ActiveGate->notAllowedReason.c_str());
-                } else {
-                    msg = QCoreApplication::translate("SelectionFilter","Selection not allowed by filter");
-                }
-                getMainWindow()->showMessage(msg);
-                Gui::MDIView* mdi = Gui::Application::Instance->activeDocument()->getActiveView();
-                mdi->setOverrideCursor(Qt::ForbiddenCursor);
-            }
-            ActiveGate->notAllowedReason.clear();
-            QApplication::beep();
-            return false;
-        }
+    if (!allowSelection(temp)) {
+        notAllowedSelection();
+        return false;
     }
 
     if(!logDisabled)
         temp.log(false,clearPreselect);
 
-    _SelList.push_back(temp);
+    addSelObj(temp);
     _SelStackForward.clear();
 
     if(clearPreselect)
@@ -1174,14 +1321,16 @@ std::vector<SelectionObject> SelectionSingleton::selStackGet(
     return getObjectList(pDocName,App::DocumentObject::getClassTypeId(),selList,resolve);
 }
 
-bool SelectionSingleton::addSelections(const char* pDocName, const char* pObjectName, const std::vector<std::string>& pSubNames)
+bool SelectionSingleton::addSelections(const char* pDocName, const char* pObjectName,
+        const std::vector<std::string>& pSubNames, bool clearPreselect)
 {
     if(_PickedList.size()) {
         _PickedList.clear();
         notify(SelectionChanges(SelectionChanges::PickedListChanged));
     }
 
-    bool update = false;
+    std::vector<SelectionChanges> changes;
+    bool allowed = true;
     for(std::vector<std::string>::const_iterator it = pSubNames.begin(); it != pSubNames.end(); ++it) {
         _SelObj temp;
         int ret = checkSelection(pDocName,pObjectName,it->c_str(),0,temp);
@@ -1192,20 +1341,32 @@ bool SelectionSingleton::addSelections(const char* pDocName, const char* pObject
         temp.y        = 0;
         temp.z        = 0;
 
-        _SelList.push_back(temp);
-        _SelStackForward.clear();
+        if (!allowSelection(temp)) {
+            allowed = false;
+            continue;
+        }
 
-        SelectionChanges Chng(SelectionChanges::AddSelection,
-                temp.DocName,temp.FeatName,temp.SubName,temp.TypeName);
+        if(!logDisabled)
+            temp.log(false,clearPreselect);
 
-        FC_LOG("Add Selection "<<Chng.DocName<<'#'<<Chng.ObjName<<'.'<<Chng.SubName);
+        addSelObj(temp);
 
-        notify(std::move(Chng));
-        update = true;
+        changes.emplace_back(SelectionChanges::AddSelection,
+                temp.DocName,temp.FeatName,temp.SubName,temp.TypeName);
     }
 
-    if(update)
-        getMainWindow()->updateActions();
+    if(!allowed)
+        notAllowedSelection();
+
+    if(changes.empty())
+        return true;
+
+    _SelStackForward.clear();
+
+    if(clearPreselect)
+        rmvPreselect();
+
+    notifyChanges(std::move(changes));
     return true;
 }
 
@@ -1298,26 +1459,7 @@ void SelectionSingleton::rmvSelection(const char* pDocName, const char* pObjectN
         return;
 
     std::vector<SelectionChanges> changes;
-    for(auto It=_SelList.begin(),ItNext=It;It!=_SelList.end();It=ItNext) {
-        ++ItNext;
-        if(It->DocName!=temp.DocName || It->FeatName!=temp.FeatName) 
-            continue;
-        // if no subname is specified, remove all subobjects of the matching object
-        if(temp.SubName.size()) {
-            // otherwise, match subojects with common prefix, separated by '.'
-            if(!boost::starts_with(It->SubName,temp.SubName) ||
-               (It->SubName.length()!=temp.SubName.length() && It->SubName[temp.SubName.length()-1]!='.'))
-                continue;
-        }
-
-        It->log(true);
-
-        changes.emplace_back(SelectionChanges::RmvSelection,
-                It->DocName,It->FeatName,It->SubName,It->TypeName);
-
-        // destroy the _SelObj item
-        _SelList.erase(It);
-    }
+    removeSelObjs(temp,changes);
 
     // NOTE: It can happen that there are nested calls of rmvSelection()
     // so that it's not safe to invoke the notifications inside the loop
@@ -1333,6 +1475,23 @@ void SelectionSingleton::rmvSelection(const char* pDocName, const char* pObjectN
     }
 }
 
+void SelectionSingleton::rmvSelections(const char* pDocName, const char* pObjectName,
+        const std::vector<std::string>& pSubNames)
+{
+    if(!pDocName) return;
+
+    std::vector<SelectionChanges> changes;
+    for(auto &subname : pSubNames) {
+        _SelObj temp;
+        int ret = checkSelection(pDocName,pObjectName,subname.c_str(),0,temp);
+        if(ret<0)
+            continue;
+        removeSelObjs(temp,changes);
+    }
+
+    notifyChanges(std::move(changes));
+}
+
 struct SelInfo {
     std::string DocName;
     std::string FeatName;
@@ -1451,7 +1610,7 @@ void SelectionSingleton::setSelection(const char* pDocName, const std::vector<Ap
         if(ret!=0)
             continue;
         touched = true;
-        _SelList.push_back(temp);
+        addSelObj(temp);
     }
 
     if(touched) {
@@ -1492,7 +1651,7 @@ void SelectionSingleton::clearSelection(const char* pDocName, bool clearPreSelec
         for(auto it=_SelList.begin();it!=_SelList.end();) {
             if(it->DocName == docName) {
                 touched = true;
-                it = _SelList.erase(it);
+                it = eraseSelObj(it);
             }else
                 ++it;
         }
@@ -1532,7 +1691,7 @@ void SelectionSingleton::clearCompleteSelection(bool clearPreSelect)
                 clearPreSelect?"Gui.Selection.clearSelection()"
                               :"Gui.Selection.clearSelection(False)");
 
-    _SelList.clear();
+    clearSelObjs();
 
     SelectionChanges Chng(SelectionChanges::ClrSelection);
 
@@ -1605,12 +1764,39 @@ int SelectionSingleton::checkSelection(const char *pDocName, const char *pObject
             sel.SubName = subname;
         }
     }
-    if(!selList)
-        selList = &_SelList;
-
     if(!pSubName)
         pSubName = "";
 
+    if(!selList || selList == &_SelList) {
+        if(_SelMap.count(selectionKey(sel.DocName,sel.FeatName,pSubName)))
+            return 1;
+        if(resolve>1) {
+            auto it = _SelObjMap.find(sel.pObject);
+            if(it != _SelObjMap.end()) {
+                for(auto &v : it->second.entries) {
+                    auto &s = *v.second;
+                    if(s.DocName==pDocName && s.FeatName==sel.FeatName
+                            && boost::starts_with(s.SubName,prefix))
+                        return 1;
+                }
+            }
+        }
+        if(resolve==1) {
+            auto it = _SelResolvedMap.find(sel.pResolvedObject);
+            if(it != _SelResolvedMap.end()) {
+                if(!pSubName[0])
+                    return 1;
+                auto &elements = it->second.elements;
+                if(sel.elementName.first.size()
+                        && elements.count(elementKey(sel.elementName.first,std::string())))
+                    return 1;
+                if(elements.count(elementKey(std::string(),sel.elementName.second)))
+                    return 1;
+            }
+        }
+        return 0;
+    }
+
     for (auto &s : *selList) {
         if (s.DocName==pDocName && s.FeatName==sel.FeatName) {
             if(s.SubName==pSubName)
@@ -1639,15 +1825,18 @@ const char *SelectionSingleton::getSelectedElement(App::DocumentObject *obj, con
 {
     if (!obj) return 0;
 
-    for(list<_SelObj>::const_iterator It = _SelList.begin();It != _SelList.end();++It) {
-        if (It->pObject == obj) {
-            auto len = It->SubName.length();
-            if(!len)
-                return "";
-            if (pSubName && strncmp(pSubName,It->SubName.c_str(),It->SubName.length())==0){
-                if(pSubName[len]==0 || pSubName[len-1] == '.')
-                    return It->SubName.c_str();
-            }
+    auto iter = _SelObjMap.find(obj);
+    if (iter == _SelObjMap.end())
+        return 0;
+
+    for(auto &v : iter->second.entries) {
+        const auto &sel = *v.second;
+        auto len = sel.SubName.length();
+        if(!len)
+            return "";
+        if (pSubName && strncmp(pSubName,sel.SubName.c_str(),sel.SubName.length())==0){
+            if(pSubName[len]==0 || pSubName[len-1] == '.')
+                return sel.SubName.c_str();
         }
     }
     return 0;
@@ -1662,14 +1851,20 @@ void SelectionSingleton::slotDeletedObject(const App::DocumentObject& Obj)
 
     // Remove also from the selection, if selected
     // We don't walk down the hierarchy for each selection, so there may be stray selection
+    std::map<std::size_t,_SelIter> matches;
+    auto iter = _SelObjMap.find(&Obj);
+    if(iter != _SelObjMap.end())
+        matches.insert(iter->second.entries.begin(),iter->second.entries.end());
+    iter = _SelResolvedMap.find(&Obj);
+    if(iter != _SelResolvedMap.end())
+        matches.insert(iter->second.entries.begin(),iter->second.entries.end());
+
     std::vector<SelectionChanges> changes;
-    for(auto it=_SelList.begin(),itNext=it;it!=_SelList.end();it=itNext) {
-        ++itNext;
-        if(it->pResolvedObject == &Obj || it->pObject==&Obj) {
-            changes.emplace_back(SelectionChanges::RmvSelection,
-                    it->DocName,it->FeatName,it->SubName,it->TypeName);
-            _SelList.erase(it);
-        }
+    for(auto &v : matches) {
+        auto it = v.second;
+        changes.emplace_back(SelectionChanges::RmvSelection,
+                it->DocName,it->FeatName,it->SubName,it->TypeName);
+        eraseSelObj(it);
     }
     if(changes.size()) {
         for(auto &Chng : changes) {
@@ -1753,7 +1948,8 @@ PyMethodDef SelectionSingleton::Methods[] = {
      "updateSelection(show,object,[string]) -- update an object in the selection\n"
      "where string is the sub-element name and the three floats represent a 3d point"},
     {"removeSelection",      (PyCFunction) SelectionSingleton::sRemoveSelection, METH_VARARGS,
-     "removeSelection(object) -- Remove an object from the selection"},
+     "removeSelection(object,[string]) -- Remove an object from the selection\n"
+     "where string is the sub-element name or a list or tuple of sub-element names"},
     {"clearSelection"  ,     (PyCFunction) SelectionSingleton::sClearSelection, METH_VARARGS,
      "clearSelection(doc=None,clearPreSelect=True) -- Clear the selection\n"
      "Clear the selection to the given document name. If no document is\n"
@@ -1887,14 +2083,15 @@ PyObject *SelectionSingleton::sAddSelection(PyObject * /*self*/, PyObject *args)
 
         try {
             if (PyTuple_Check(sequence) || PyList_Check(sequence)) {
+                std::vector<std::string> subnames;
                 Py::Sequence list(sequence);
                 for (Py::Sequence::iterator it = list.begin(); it != list.end(); ++it) {
-                    std::string subname = static_cast<std::string>(Py::String(*it));
-                    Selection().addSelection(docObj->getDocument()->getName(),
-                                             docObj->getNameInDocument(),
-                                             subname.c_str(),0,0,0,0,PyObject_IsTrue(clearPreselect));
+                    subnames.push_back(static_cast<std::string>(Py::String(*it)));
                 }
 
+                Selection().addSelections(docObj->getDocument()->getName(),
+                                          docObj->getNameInDocument(),
+                                          subnames,PyObject_IsTrue(clearPreselect));
                 Py_Return;
             }
         }
@@ -1940,21 +2137,52 @@ PyObject *SelectionSingleton::sRemoveSelection(PyObject * /*self*/, PyObject *ar
 
     PyObject *object;
     subname = 0;
-    if (!PyArg_ParseTuple(args, "O!|s", &(App::DocumentObjectPy::Type),&object,&subname))
-        return NULL;
+    if (PyArg_ParseTuple(args, "O!|s", &(App::DocumentObjectPy::Type),&object,&subname)) {
+        App::DocumentObjectPy* docObjPy = static_cast<App::DocumentObjectPy*>(object);
+        App::DocumentObject* docObj = docObjPy->getDocumentObjectPtr();
+        if (!docObj || !docObj->getNameInDocument()) {
+            PyErr_SetString(Base::BaseExceptionFreeCADError, "Cannot check invalid object");
+            return NULL;
+        }
 
-    App::DocumentObjectPy* docObjPy = static_cast<App::DocumentObjectPy*>(object);
-    App::DocumentObject* docObj = docObjPy->getDocumentObjectPtr();
-    if (!docObj || !docObj->getNameInDocument()) {
-        PyErr_SetString(Base::BaseExceptionFreeCADError, "Cannot check invalid object");
-        return NULL;
+        Selection().rmvSelection(docObj->getDocument()->getName(),
+                                 docObj->getNameInDocument(),
+                                 subname);
+
+        Py_Return;
     }
 
-    Selection().rmvSelection(docObj->getDocument()->getName(),
-                             docObj->getNameInDocument(),
-                             subname);
+    PyErr_Clear();
+    PyObject *sequence;
+    if (PyArg_ParseTuple(args, "O!O", &(App::DocumentObjectPy::Type),&object,&sequence)) {
+        App::DocumentObjectPy* docObjPy = static_cast<App::DocumentObjectPy*>(object);
+        App::DocumentObject* docObj = docObjPy->getDocumentObjectPtr();
+        if (!docObj || !docObj->getNameInDocument()) {
+            PyErr_SetString(Base::BaseExceptionFreeCADError, "Cannot check invalid object");
+            return NULL;
+        }
+
+        try {
+            if (PyTuple_Check(sequence) || PyList_Check(sequence)) {
+                std::vector<std::string> subnames;
+                Py::Sequence list(sequence);
+                for (Py::Sequence::iterator it = list.begin(); it != list.end(); ++it) {
+                    subnames.push_back(static_cast<std::string>(Py::String(*it)));
+                }
 
-    Py_Return;
+                Selection().rmvSelections(docObj->getDocument()->getName(),
+                                          docObj->getNameInDocument(),
+                                          subnames);
+                Py_Return;
+            }
+        }
+        catch (const Py::Exception&) {
+            // do nothing here
+        }
+    }
+
+    PyErr_SetString(PyExc_ValueError, "type must be 'DocumentObject[,subname]' or 'DocumentObject, list or tuple of subnames'");
+    return 0;
 }
 
 PyObject *SelectionSingleton::sClearSelection(PyObject * /*self*/, PyObject *args)
@@ -30,6 +30,7 @@
 #include <vector>
 #include <list>
 #include <map>
+#include <unordered_map>
 #include <deque>
 #include <boost/signals2.hpp>
 #include <CXX/Objects.hxx>
@@ -129,6 +130,9 @@ public:
         ObjName = other.ObjName;
         SubName = other.SubName;
         TypeName = other.TypeName;
+        SubNames = other.SubNames;
+        BatchType = other.BatchType;
+        BatchElement = other.BatchElement;
         pDocName = DocName.c_str();
         pObjectName = ObjName.c_str();
         pSubName = SubName.c_str();
@@ -153,6 +157,9 @@ public:
         ObjName = std::move(other.ObjName);
         SubName = std::move(other.SubName);
         TypeName = std::move(other.TypeName);
+        SubNames = std::move(other.SubNames);
+        BatchType = other.BatchType;
+        BatchElement = other.BatchElement;
         pDocName = DocName.c_str();
         pObjectName = ObjName.c_str();
         pSubName = SubName.c_str();
@@ -182,6 +189,15 @@ public:
     std::string SubName;
     std::string TypeName;
 
+    // The sub-elements of ObjName of a batched change, which is notified as a
+    // single SetSelection message to the observers that accept it, see
+    // SelectionObserver::setBatchSelection(). BatchType is either
+    // AddSelection or RmvSelection.
+    std::vector<std::string> SubNames;
+    MsgType BatchType = ClrSelection;
+    // Whether this is the message of a single sub-element of a batched change
+    bool BatchElement = false;
+
     // Resolved sub object in case resolve!=0, otherwise this is null
     App::DocumentObject *pSubObject = 0;
     // Resolved parent object in case resolve!=0, otherwise this is null
@@ -262,6 +278,13 @@ public:
     /** Detaches from the selection. */
     void detachSelection();
 
+    /** Whether to receive a batched change of several sub-elements as a
+     * single SetSelection message with SelectionChanges::SubNames instead
+     * of one AddSelection or RmvSelection message per sub-element.
+     */
+    void setBatchSelection(bool enable);
+    bool isBatchSelection() const;
+
 private:
     virtual void onSelectionChanged(const SelectionChanges& msg) = 0;
     void _onSelectionChanged(const SelectionChanges& msg);
@@ -273,6 +296,7 @@ private:
     std::string filterObjName;
     int resolve;
     bool blockSelection;
+    bool batchSelection;
 };
 
 /**
@@ -396,13 +420,25 @@ public:
 
     /// Add to selection
     bool addSelection(const SelectionObject&, bool clearPreSelect=true);
-    /// Add to selection with several sub-elements
-    bool addSelections(const char* pDocName, const char* pObjectName, const std::vector<std::string>& pSubNames);
+    /** Add to selection with several sub-elements
+     * If more than one sub-element is added the observers which accept
+     * batched changes get a single SetSelection message with the list of
+     * sub-elements, all others one AddSelection message per sub-element.
+     */
+    bool addSelections(const char* pDocName, const char* pObjectName,
+            const std::vector<std::string>& pSubNames, bool clearPreSelect=true);
     /// Update a selection 
     bool updateSelection(bool show, const char* pDocName, const char* pObjectName=0, const char* pSubName=0);
     /// Remove from selection (for internal use)
     void rmvSelection(const char* pDocName, const char* pObjectName=0, const char* pSubName=0, 
             const std::vector<SelObj> *pickedList = 0);
+    /** Remove several sub-elements from selection
+     * Like addSelections() the removal of more than one sub-element is
+     * notified with a single SetSelection message to the observers which
+     * accept batched changes.
+     */
+    void rmvSelections(const char* pDocName, const char* pObjectName,
+            const std::vector<std::string>& pSubNames);
     /// Set the selection for a document
     void setSelection(const char* pDocName, const std::vector<App::DocumentObject*>&);
     /// Clear the selection of document \a pDocName. If the document name is not given the selection of the active document is cleared.
@@ -717,11 +753,36 @@ protected:
 
         std::pair<std::string,std::string> elementName;
         App::DocumentObject* pResolvedObject = 0;
+        // position in the order of selection
+        std::size_t order = 0;
 
         void log(bool remove=false, bool clearPreselect=true);
     };
     mutable std::list<_SelObj> _SelList;
 
+    typedef std::list<_SelObj>::iterator _SelIter;
+    /// The selected entries of an object in the order of selection
+    struct _SelIndex {
+        std::map<std::size_t,_SelIter> entries;
+        /// number of entries per element name of a resolved object
+        std::unordered_map<std::string,int> elements;
+    };
+    /// _SelList indexed by document, object and sub name
+    std::unordered_map<std::string,_SelIter> _SelMap;
+    /// _SelList indexed by the top level object
+    std::unordered_map<const App::DocumentObject*,_SelIndex> _SelObjMap;
+    /// _SelList indexed by the resolved object
+    std::unordered_map<const App::DocumentObject*,_SelIndex> _SelResolvedMap;
+    std::size_t _SelCounter = 0;
+
+    _SelIter addSelObj(const _SelObj &sel);
+    _SelIter eraseSelObj(_SelIter it);
+    void clearSelObjs();
+    void removeSelObjs(const _SelObj &sel, std::vector<SelectionChanges> &changes);
+    bool allowSelection(_SelObj &sel) const;
+    void notAllowedSelection();
+    void notifyChanges(std::vector<SelectionChanges> &&changes);
+
     mutable std::list<_SelObj> _PickedList;
     bool _needPickedList;
 
@@ -433,6 +433,29 @@ void SoFCUnifiedSelection::doAction(SoAction *action)
                     action.apply(vpd->getRoot());
                 }
             }
+
+            // highlight the selected sub-elements again
+            for(auto &sel : Selection().getSelection(selaction->SelChange.pDocName,0)) {
+                if(!sel.SubName || !sel.SubName[0])
+                    continue;
+                ViewProvider *vp = Application::Instance->getViewProvider(sel.pObject);
+                if (!vp || !(useNewSelection.getValue()||vp->useNewSelectionModel()) || !vp->isSelectable())
+                    continue;
+                SoDetail *detail = nullptr;
+                detailPath->truncate(0);
+                if(vp->getDetailPath(sel.SubName,detailPath,true,detail)) {
+                    SoSelectionElementAction action(detail?SoSelectionElementAction::Append
+                                                          :SoSelectionElementAction::All);
+                    action.setColor(this->colorSelection.getValue());
+                    action.setElement(detail);
+                    if(detailPath->getLength())
+                        action.apply(detailPath);
+                    else
+                        action.apply(vp->getRoot());
+                }
+                detailPath->truncate(0);
+                delete detail;
+            }
         } else if (selaction->SelChange.Type == SelectionChanges::SetPreselectSignal) {
             // selection changes inside the 3d view are handled in handleEvent()
             App::Document* doc = App::GetApplication().getDocument(selaction->SelChange.pDocName);
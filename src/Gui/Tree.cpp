@@ -434,6 +434,9 @@ TreeWidget::TreeWidget(const char *name, QWidget* parent)
     if(!_LastSelectedTreeWidget)
         _LastSelectedTreeWidget = this;
 
+    // the tree items are synchronized with the whole selection anyway
+    setBatchSelection(true);
+
     this->setDragEnabled(true);
     this->setAcceptDrops(true);
     this->setDropIndicatorShown(false);
@@ -384,6 +384,8 @@ void View3DInventorViewer::init()
     vboEnabled = false;
 
     attachSelection();
+    // a batch of sub-elements is highlighted at once on SetSelection
+    setBatchSelection(true);
 
     // Coin should not clear the pixel-buffer, so the background image
     // is not removed.
@@ -728,6 +730,13 @@ void View3DInventorViewer::checkGroupOnTop(const SelectionChanges &Reason) {
         clearGroupOnTop();
         if(Reason.Type == SelectionChanges::ClrSelection)
             return;
+        // the selection of the document is replaced as a whole
+        for(auto &sel : Selection().getSelection(Reason.pDocName,0)) {
+            SelectionChanges msg(SelectionChanges::AddSelection,
+                    sel.DocName,sel.FeatName,sel.SubName);
+            checkGroupOnTop(msg);
+        }
+        return;
     }
     if(Reason.Type == SelectionChanges::RmvPreselect ||
        Reason.Type == SelectionChanges::RmvPreselectSignal) 
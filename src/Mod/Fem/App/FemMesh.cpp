@@ -24,8 +24,11 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+# include <algorithm>
 # include <cstdlib>
 # include <memory>
+# include <sstream>
+# include <thread>
 # include <Bnd_Box.hxx>
 # include <BRep_Tool.hxx>
 # include <BRepBndLib.hxx>
@@ -79,12 +82,17 @@
 #include <Mod/Mesh/App/Core/Iterator.h>
 
 #include "FemMesh.h"
+#include "FemMeshReader.h"
 #ifdef FC_USE_VTK
 #include "FemVTKTools.h"
 #endif
 
 # include <FemMeshPy.h>
 
+#if defined(FC_OS_LINUX) || defined(FC_OS_MACOSX) || defined(FC_OS_BSD)
+# include <sys/resource.h>
+#endif
+
 
 
 
@@ -996,178 +1004,182 @@ std::set<int> FemMesh::getFacesOnly(void) const
     return resultIDs;
 }
 
-void FemMesh::readNastran(const std::string &Filename)
+namespace {
+
+// Returns the peak resident set size of the process in kB, or 0 if it is not known
+unsigned long peakResidentSetSize()
 {
-    Base::TimeInfo Start;
-    Base::Console().Log("Start: FemMesh::readNastran() =================================\n");
+#if defined(FC_OS_LINUX) || defined(FC_OS_MACOSX) || defined(FC_OS_BSD)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(FC_OS_MACOSX)
+        // bytes on macOS, kB elsewhere
+        return static_cast<unsigned long>(usage.ru_maxrss / 1024);
+#else
+        return static_cast<unsigned long>(usage.ru_maxrss);
+#endif
+    }
+#endif
+    return 0;
+}
 
-    _Mtrx = Base::Matrix4D();
+// Adds the blocks of a MeshFileReader to the mesh. Elements referring to
+// nodes which are not yet known are kept back and added at the end.
+class MeshBlockInserter
+{
+public:
+    MeshBlockInserter(SMESHDS_Mesh* meshds)
+      : nodes(0), elements(0), skipped(0), failed(0), meshds(meshds)
+    {
+    }
 
-    std::ifstream inputfile;
-    inputfile.open(Filename.c_str());
-    inputfile.seekg(std::ifstream::beg);
-    std::string line1,line2,temp;
-    std::vector<string> token_results;
-    token_results.clear();
-    Base::Vector3d current_node;
-    std::vector<Base::Vector3d> vertices;
-    vertices.clear();
-    std::vector<unsigned int> nodal_id;
-    nodal_id.clear();
-    std::vector<unsigned int> tetra_element;
-    std::vector<std::vector<unsigned int> > all_elements;
-    std::vector<unsigned int> element_id;
-    element_id.clear();
-    bool nastran_free_format = false;
-    do
+    void add(const MeshBlock& block)
     {
-        std::getline(inputfile,line1);
-        if (line1.size() == 0) continue;
-        if (!nastran_free_format && line1.find(",")!= std::string::npos)
-            nastran_free_format = true;
-        if (!nastran_free_format && line1.find("GRID*")!= std::string::npos ) //We found a Grid line
-        {
-            //Now lets extract the GRID Points = Nodes
-            //As each GRID Line consists of two subsequent lines we have to
-            //take care of that as well
-            std::getline(inputfile,line2);
-            //Get the Nodal ID
-            nodal_id.push_back(atoi(line1.substr(8,24).c_str()));
-            //Extract X Value
-            current_node.x = atof(line1.substr(40,56).c_str());
-            //Extract Y Value
-            current_node.y = atof(line1.substr(56,72).c_str());
-            //Extract Z Value
-            current_node.z = atof(line2.substr(8,24).c_str());
-
-            vertices.push_back(current_node);
-        }
-        else if (!nastran_free_format && line1.find("CTETRA")!= std::string::npos)
-        {
-            tetra_element.clear();
-            //Lets extract the elements
-            //As each Element Line consists of two subsequent lines as well
-            //we have to take care of that
-            //At a first step we only extract Quadratic Tetrahedral Elements
-            std::getline(inputfile,line2);
-            unsigned int id = atoi(line1.substr(8,16).c_str());
-            int offset = 0;
-
-            if(id < 1000000)
-                offset = 0;
-            else if (id < 10000000)
-                offset = 1;
-            else if (id < 100000000)
-                offset = 2;
-
-
-            element_id.push_back(id);
-            tetra_element.push_back(atoi(line1.substr(24,32).c_str()));
-            tetra_element.push_back(atoi(line1.substr(32,40).c_str()));
-            tetra_element.push_back(atoi(line1.substr(40,48).c_str()));
-            tetra_element.push_back(atoi(line1.substr(48,56).c_str()));
-            tetra_element.push_back(atoi(line1.substr(56,64).c_str()));
-            tetra_element.push_back(atoi(line1.substr(64,72).c_str()));
-            tetra_element.push_back(atoi(line2.substr(8+offset,16+offset).c_str()));
-            tetra_element.push_back(atoi(line2.substr(16+offset,24+offset).c_str()));
-            tetra_element.push_back(atoi(line2.substr(24+offset,32+offset).c_str()));
-            tetra_element.push_back(atoi(line2.substr(32+offset,40+offset).c_str()));
-
-            all_elements.push_back(tetra_element);
+        for (std::size_t i = 0; i < block.nodeIds.size(); ++i) {
+            const double* xyz = &block.nodeCoords[3 * i];
+            if (meshds->AddNodeWithID(xyz[0], xyz[1], xyz[2], block.nodeIds[i]))
+                nodes++;
+            else
+                failed++;
         }
-        else if (nastran_free_format && line1.find("GRID")!= std::string::npos ) //We found a Grid line
-        {
-            char_separator<char> sep(",");
-            tokenizer<char_separator<char> > tokens(line1, sep);
-            token_results.assign(tokens.begin(),tokens.end());
-            if (token_results.size() < 3)
-                continue;//Line does not include Nodal coordinates
-            nodal_id.push_back(atoi(token_results[1].c_str()));
-            current_node.x = atof(token_results[3].c_str());
-            current_node.y = atof(token_results[4].c_str());
-            current_node.z = atof(token_results[5].c_str());
-            vertices.push_back(current_node);
-        }
-        else if (nastran_free_format && line1.find("CTETRA")!= std::string::npos)
-        {
-            tetra_element.clear();
-            //Lets extract the elements
-            //As each Element Line consists of two subsequent lines as well
-            //we have to take care of that
-            //At a first step we only extract Quadratic Tetrahedral Elements
-            std::getline(inputfile,line2);
-            char_separator<char> sep(",");
-            tokenizer<char_separator<char> > tokens(line1.append(line2), sep);
-            token_results.assign(tokens.begin(),tokens.end());
-            if (token_results.size() < 11)
-                continue;//Line does not include enough nodal IDs
-            element_id.push_back(atoi(token_results[1].c_str()));
-            tetra_element.push_back(atoi(token_results[3].c_str()));
-            tetra_element.push_back(atoi(token_results[4].c_str()));
-            tetra_element.push_back(atoi(token_results[5].c_str()));
-            tetra_element.push_back(atoi(token_results[6].c_str()));
-            tetra_element.push_back(atoi(token_results[7].c_str()));
-            tetra_element.push_back(atoi(token_results[8].c_str()));
-            tetra_element.push_back(atoi(token_results[10].c_str()));
-            tetra_element.push_back(atoi(token_results[11].c_str()));
-            tetra_element.push_back(atoi(token_results[12].c_str()));
-            tetra_element.push_back(atoi(token_results[13].c_str()));
-
-            all_elements.push_back(tetra_element);
+        for (std::size_t i = 0; i < block.elemIds.size(); ++i) {
+            const int* ids = &block.elemNodes[block.elemOffsets[i]];
+            std::size_t count = block.elemOffsets[i+1] - block.elemOffsets[i];
+            if (!findNodes(ids, count)) {
+                deferred.elemIds.push_back(block.elemIds[i]);
+                deferred.elemDims.push_back(block.elemDims[i]);
+                deferred.elemNodes.insert(deferred.elemNodes.end(), ids, ids + count);
+                deferred.elemOffsets.push_back(deferred.elemNodes.size());
+            }
+            else if (addElement(block.elemIds[i], block.elemDims[i], count)) {
+                elements++;
+            }
+            else {
+                failed++;
+            }
         }
+        skipped += block.skipped;
+    }
 
+    void finish()
+    {
+        for (std::size_t i = 0; i < deferred.elemIds.size(); ++i) {
+            const int* ids = &deferred.elemNodes[deferred.elemOffsets[i]];
+            std::size_t count = deferred.elemOffsets[i+1] - deferred.elemOffsets[i];
+            if (findNodes(ids, count) && addElement(deferred.elemIds[i], deferred.elemDims[i], count))
+                elements++;
+            else
+                failed++;
+        }
+        deferred.clear();
     }
-    while (inputfile.good());
-    inputfile.close();
 
-    Base::Console().Log("    %f: File read, start building mesh\n",Base::TimeInfo::diffTimeF(Start,Base::TimeInfo()));
+    std::size_t nodes;
+    std::size_t elements;
+    std::size_t skipped;
+    std::size_t failed;
 
-    //Now fill the SMESH datastructure
-    std::vector<Base::Vector3d>::const_iterator anodeiterator;
-    SMESHDS_Mesh* meshds = this->myMesh->GetMeshDS();
-    meshds->ClearMesh();
-    unsigned int j=0;
-    for(anodeiterator=vertices.begin(); anodeiterator!=vertices.end(); anodeiterator++)
+private:
+    bool findNodes(const int* ids, std::size_t count)
     {
-        meshds->AddNodeWithID((*anodeiterator).x,(*anodeiterator).y,(*anodeiterator).z,nodal_id[j]);
-        j++;
+        nodePtrs.resize(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            nodePtrs[i] = meshds->FindNode(ids[i]);
+            if (!nodePtrs[i])
+                return false;
+        }
+        return true;
     }
 
-    for(unsigned int i=0;i<all_elements.size();i++)
+    bool addElement(int id, unsigned char dim, std::size_t count)
     {
-        //Die Reihenfolge wie hier die Elemente hinzugefügt werden ist sehr wichtig.
-        //Ansonsten ist eine konsistente Datenstruktur nicht möglich
-        //meshds->AddVolumeWithID
-        //(
-        //    meshds->FindNode(all_elements[i][0]),
-        //    meshds->FindNode(all_elements[i][2]),
-        //    meshds->FindNode(all_elements[i][1]),
-        //    meshds->FindNode(all_elements[i][3]),
-        //    meshds->FindNode(all_elements[i][6]),
-        //    meshds->FindNode(all_elements[i][5]),
-        //    meshds->FindNode(all_elements[i][4]),
-        //    meshds->FindNode(all_elements[i][9]),
-        //    meshds->FindNode(all_elements[i][7]),
-        //    meshds->FindNode(all_elements[i][8]),
-        //    element_id[i]
-        //);
-        meshds->AddVolumeWithID
-        (
-            meshds->FindNode(all_elements[i][1]),
-            meshds->FindNode(all_elements[i][0]),
-            meshds->FindNode(all_elements[i][2]),
-            meshds->FindNode(all_elements[i][3]),
-            meshds->FindNode(all_elements[i][4]),
-            meshds->FindNode(all_elements[i][6]),
-            meshds->FindNode(all_elements[i][5]),
-            meshds->FindNode(all_elements[i][8]),
-            meshds->FindNode(all_elements[i][7]),
-            meshds->FindNode(all_elements[i][9]),
-            element_id[i]
-        );
+        const SMDS_MeshNode** n = &nodePtrs[0];
+        const SMDS_MeshElement* elem = 0;
+        if (dim == 1) {
+            switch (count) {
+            case 2: elem = meshds->AddEdgeWithID(n[0], n[1], id); break;
+            case 3: elem = meshds->AddEdgeWithID(n[0], n[1], n[2], id); break;
+            }
+        }
+        else if (dim == 2) {
+            switch (count) {
+            case 3: elem = meshds->AddFaceWithID(n[0], n[1], n[2], id); break;
+            case 4: elem = meshds->AddFaceWithID(n[0], n[1], n[2], n[3], id); break;
+            case 6: elem = meshds->AddFaceWithID(n[0], n[1], n[2], n[3], n[4], n[5], id); break;
+            case 8: elem = meshds->AddFaceWithID(n[0], n[1], n[2], n[3], n[4], n[5], n[6], n[7], id); break;
+            }
+        }
+        else if (dim == 3) {
+            switch (count) {
+            case 4: elem = meshds->AddVolumeWithID(n[0], n[1], n[2], n[3], id); break;
+            case 6: elem = meshds->AddVolumeWithID(n[0], n[1], n[2], n[3], n[4], n[5], id); break;
+            case 8: elem = meshds->AddVolumeWithID(n[0], n[1], n[2], n[3], n[4], n[5], n[6], n[7], id); break;
+            case 10:
+                elem = meshds->AddVolumeWithID(n[0], n[1], n[2], n[3], n[4], n[5], n[6], n[7], n[8], n[9], id);
+                break;
+            case 15:
+                elem = meshds->AddVolumeWithID(n[0], n[1], n[2], n[3], n[4], n[5], n[6], n[7], n[8], n[9],
+                                               n[10], n[11], n[12], n[13], n[14], id);
+                break;
+            case 20:
+                elem = meshds->AddVolumeWithID(n[0], n[1], n[2], n[3], n[4], n[5], n[6], n[7], n[8], n[9],
+                                               n[10], n[11], n[12], n[13], n[14], n[15], n[16], n[17], n[18], n[19], id);
+                break;
+            }
+        }
+        return elem != 0;
     }
-    Base::Console().Log("    %f: Done \n",Base::TimeInfo::diffTimeF(Start,Base::TimeInfo()));
 
+    SMESHDS_Mesh* meshds;
+    MeshBlock deferred;
+    std::vector<const SMDS_MeshNode*> nodePtrs;
+};
+
+// Streams a Nastran or Abaqus file into the mesh
+void readMeshFile(SMESHDS_Mesh* meshds, const std::string& fileName, bool abaqus,
+                  const Base::TimeInfo& Start)
+{
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath("User parameter:BaseApp/Preferences/Mod/Fem/General");
+    int threads = hGrp->GetInt("MeshReaderThreads", 0);
+    unsigned long blockSize = hGrp->GetUnsigned("MeshReaderBlockSize", 0);
+
+    meshds->ClearMesh();
+    MeshBlockInserter inserter(meshds);
+    MeshFileReader reader([&inserter](const MeshBlock& block) {
+        inserter.add(block);
+    });
+    reader.setThreadCount(threads);
+    if (blockSize > 0)
+        reader.setBlockSize(blockSize);
+    if (abaqus)
+        reader.readAbaqus(fileName);
+    else
+        reader.readNastran(fileName);
+    inserter.finish();
+
+    double time = Base::TimeInfo::diffTimeF(Start,Base::TimeInfo());
+    Base::Console().Log("    %f: %lu nodes and %lu elements read from %lu bytes (%.0f elements/s, peak RSS %lu kB)\n",
+        time, (unsigned long)inserter.nodes, (unsigned long)inserter.elements,
+        (unsigned long)reader.bytesRead(), time > 0 ? inserter.elements / time : 0.0,
+        peakResidentSetSize());
+    if (inserter.skipped > 0)
+        Base::Console().Warning("%lu unsupported or incomplete elements skipped in %s\n",
+            (unsigned long)inserter.skipped, fileName.c_str());
+    if (inserter.failed > 0)
+        Base::Console().Warning("%lu nodes or elements with duplicate ids or unknown nodes not added from %s\n",
+            (unsigned long)inserter.failed, fileName.c_str());
+}
+
+} // namespace
+
+void FemMesh::readNastran(const std::string &Filename)
+{
+    Base::TimeInfo Start;
+    Base::Console().Log("Start: FemMesh::readNastran() =================================\n");
+
+    _Mtrx = Base::Matrix4D();
+    readMeshFile(this->myMesh->GetMeshDS(), Filename, false, Start);
+    Base::Console().Log("    %f: Done \n",Base::TimeInfo::diffTimeF(Start,Base::TimeInfo()));
 }
 
 void FemMesh::readAbaqus(const std::string &FileName)
@@ -1175,34 +1187,8 @@ void FemMesh::readAbaqus(const std::string &FileName)
     Base::TimeInfo Start;
     Base::Console().Log("Start: FemMesh::readAbaqus() =================================\n");
 
-    /*
-    Python command to read Abaqus inp mesh file from test suite:
-    from feminout.importInpMesh import read as read_inp
-    femmesh = read_inp(FreeCAD.ConfigGet("AppHomePath") + 'Mod/Fem/femtest/testfiles/mesh/tetra10_mesh.inp')
-    */
-
-    PyObject* module = PyImport_ImportModule("feminout.importInpMesh");
-    if (!module)
-        return;
-    try {
-        Py::Module abaqusmod(module, true);
-        Py::Callable method(abaqusmod.getAttr("read"));
-        Py::Tuple args(1);
-        args.setItem(0, Py::String(FileName));
-        Py::Object mesh(method.apply(args));
-        if (PyObject_TypeCheck(mesh.ptr(), &FemMeshPy::Type)) {
-            FemMeshPy* fempy = static_cast<FemMeshPy*>(mesh.ptr());
-            FemMesh* fem = fempy->getFemMeshPtr();
-            *this = *fem; // the deep copy should be avoided, a pointer swap method could be implemented
-                          // see https://forum.freecadweb.org/viewtopic.php?f=10&t=31999&start=10#p274241
-        }
-        else {
-            throw Base::FileException("Problems reading file");
-        }
-    }
-    catch (Py::Exception& e) {
-        e.clear();
-    }
+    _Mtrx = Base::Matrix4D();
+    readMeshFile(this->myMesh->GetMeshDS(), FileName, true, Start);
     Base::Console().Log("    %f: Done \n",Base::TimeInfo::diffTimeF(Start,Base::TimeInfo()));
 }
 
@@ -1292,6 +1278,110 @@ void FemMesh::read(const char *FileName)
     }
 }
 
+namespace {
+
+// Elements of one inp element type, the nodes are in the order of the inp file
+struct AbaqusElements
+{
+    std::vector<int> ids;
+    std::vector<int> nodes;
+    std::size_t nodesPerElement;
+
+    AbaqusElements() : nodesPerElement(0) {}
+
+    void add(const SMDS_MeshElement* elem, const std::vector<int>& order)
+    {
+        nodesPerElement = order.size();
+        ids.push_back(elem->GetID());
+        for (std::vector<int>::const_iterator it = order.begin(); it != order.end(); ++it)
+            nodes.push_back(elem->GetNode(*it)->GetID());
+    }
+
+    // the elements are written sorted by their id
+    void sort()
+    {
+        if (std::is_sorted(ids.begin(), ids.end()))
+            return;
+        std::vector<std::size_t> index(ids.size());
+        for (std::size_t i = 0; i < index.size(); ++i)
+            index[i] = i;
+        std::sort(index.begin(), index.end(), [this](std::size_t a, std::size_t b) {
+            return ids[a] < ids[b];
+        });
+        std::vector<int> sortedIds(ids.size());
+        std::vector<int> sortedNodes(nodes.size());
+        for (std::size_t i = 0; i < index.size(); ++i) {
+            sortedIds[i] = ids[index[i]];
+            std::copy(nodes.begin() + index[i] * nodesPerElement,
+                      nodes.begin() + (index[i] + 1) * nodesPerElement,
+                      sortedNodes.begin() + i * nodesPerElement);
+        }
+        ids.swap(sortedIds);
+        nodes.swap(sortedNodes);
+    }
+};
+
+// Writes count lines formatted by format(out, begin, end). Large numbers of
+// lines are formatted in parallel in batches which are written in order, the
+// output is the same as if written directly to the stream.
+template <typename Format>
+void writeLines(std::ostream& out, std::size_t count, const Format& format)
+{
+    const std::size_t batch = 65536;
+    std::size_t threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    if (threads == 1 || count <= batch) {
+        format(out, 0, count);
+        return;
+    }
+
+    std::vector<std::string> texts(threads);
+    for (std::size_t begin = 0; begin < count; begin += threads * batch) {
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0; t < threads && begin + t * batch < count; ++t) {
+            std::size_t first = begin + t * batch;
+            std::size_t last = std::min(first + batch, count);
+            workers.push_back(std::thread([&out, &format, &texts, t, first, last]() {
+                std::ostringstream str;
+                str.imbue(out.getloc());
+                str.flags(out.flags());
+                str.precision(out.precision());
+                format(str, first, last);
+                texts[t] = str.str();
+            }));
+        }
+        for (std::size_t t = 0; t < workers.size(); ++t) {
+            workers[t].join();
+            out.write(texts[t].data(), texts[t].size());
+            std::string().swap(texts[t]);
+        }
+    }
+}
+
+void writeAbaqusElements(std::ostream& out, const AbaqusElements& elements)
+{
+    writeLines(out, elements.ids.size(), [&elements](std::ostream& str, std::size_t begin, std::size_t end) {
+        const std::size_t count = elements.nodesPerElement;
+        for (std::size_t i = begin; i < end; ++i) {
+            str << elements.ids[i];
+            const int* nodes = &elements.nodes[i * count];
+            // Calculix allows max 16 entries in one line, a hexa20 has more !
+            for (std::size_t k = 0; k < count; ++k) {
+                if (k < 15) {
+                    str << ", " << nodes[k];
+                }
+                else {
+                    if (k == 15)
+                        str << ",\n";
+                    str << nodes[k] << ", ";
+                }
+            }
+            str << '\n';
+        }
+    });
+}
+
+} // namespace
+
 void FemMesh::writeABAQUS(const std::string &Filename, int elemParam, bool groupParam) const
 {
     /*
@@ -1415,36 +1505,35 @@ void FemMesh::writeABAQUS(const std::string &Filename, int elemParam, bool group
     }
 
     // get all data --> Extract Nodes and Elements of the current SMESH datastructure
-    typedef std::map<int, Base::Vector3d> VertexMap;
-    typedef std::map<int, std::vector<int> > NodesMap;
-    typedef std::map<std::string, NodesMap> ElementsMap;
+    typedef std::vector<std::pair<int, Base::Vector3d> > VertexList;
+    typedef std::map<std::string, AbaqusElements> ElementsMap;
 
     // get nodes
-    VertexMap vertexMap;  // empty nodes map
+    VertexList vertexList;  // empty nodes list
+    vertexList.reserve(myMesh->GetMeshDS()->NbNodes());
     SMDS_NodeIteratorPtr aNodeIter = myMesh->GetMeshDS()->nodesIterator();
     Base::Vector3d current_node;
     while (aNodeIter->more()) {
         const SMDS_MeshNode* aNode = aNodeIter->next();
         current_node.Set(aNode->X(),aNode->Y(),aNode->Z());
         current_node = _Mtrx * current_node;
-        vertexMap[aNode->GetID()] = current_node;
+        vertexList.push_back(std::make_pair(aNode->GetID(), current_node));
     }
+    // This way we get sorted output.
+    // See http://forum.freecadweb.org/viewtopic.php?f=18&t=12646&start=40#p103004
+    std::sort(vertexList.begin(), vertexList.end(),
+              [](const VertexList::value_type& a, const VertexList::value_type& b) {
+        return a.first < b.first;
+    });
 
     // get volumes
     ElementsMap elementsMapVol;  // empty volumes map
     SMDS_VolumeIteratorPtr aVolIter = myMesh->GetMeshDS()->volumesIterator();
     while (aVolIter->more()) {
         const SMDS_MeshVolume* aVol = aVolIter->next();
-        std::pair<int, std::vector<int> > apair;
-        apair.first = aVol->GetID();
-        int numNodes = aVol->NbNodes();
-        std::map<int, std::string>::iterator it = volTypeMap.find(numNodes);
-        if (it != volTypeMap.end()) {
-            const std::vector<int>& order = elemOrderMap[it->second];
-            for (std::vector<int>::const_iterator jt = order.begin(); jt != order.end(); ++jt)
-                apair.second.push_back(aVol->GetNode(*jt)->GetID());
-            elementsMapVol[it->second].insert(apair);
-        }
+        std::map<int, std::string>::iterator it = volTypeMap.find(aVol->NbNodes());
+        if (it != volTypeMap.end())
+            elementsMapVol[it->second].add(aVol, elemOrderMap[it->second]);
     }
 
     //get faces
@@ -1455,33 +1544,19 @@ void FemMesh::writeABAQUS(const std::string &Filename, int elemParam, bool group
         SMDS_FaceIteratorPtr aFaceIter = myMesh->GetMeshDS()->facesIterator();
         while (aFaceIter->more()) {
             const SMDS_MeshFace* aFace = aFaceIter->next();
-            std::pair<int, std::vector<int> > apair;
-            apair.first = aFace->GetID();
-            int numNodes = aFace->NbNodes();
-            std::map<int, std::string>::iterator it = faceTypeMap.find(numNodes);
-            if (it != faceTypeMap.end()) {
-                const std::vector<int>& order = elemOrderMap[it->second];
-                for (std::vector<int>::const_iterator jt = order.begin(); jt != order.end(); ++jt)
-                    apair.second.push_back(aFace->GetNode(*jt)->GetID());
-                elementsMapFac[it->second].insert(apair);
-            }
+            std::map<int, std::string>::iterator it = faceTypeMap.find(aFace->NbNodes());
+            if (it != faceTypeMap.end())
+                elementsMapFac[it->second].add(aFace, elemOrderMap[it->second]);
         }
     }
     if (elemParam == 2) {
         // we're going to fill the elementsMapFac with the facesOnly
         std::set<int> facesOnly = getFacesOnly();
         for (std::set<int>::iterator itfa = facesOnly.begin(); itfa != facesOnly.end(); ++itfa) {
-            std::pair<int, std::vector<int> > apair;
-            apair.first = *itfa;
             const SMDS_MeshElement* aFace = myMesh->GetMeshDS()->FindElement(*itfa);
-            int numNodes = aFace->NbNodes();
-            std::map<int, std::string>::iterator it = faceTypeMap.find(numNodes);
-            if (it != faceTypeMap.end()) {
-                const std::vector<int>& order = elemOrderMap[it->second];
-                for (std::vector<int>::const_iterator jt = order.begin(); jt != order.end(); ++jt)
-                    apair.second.push_back(aFace->GetNode(*jt)->GetID());
-                elementsMapFac[it->second].insert(apair);
-            }
+            std::map<int, std::string>::iterator it = faceTypeMap.find(aFace->NbNodes());
+            if (it != faceTypeMap.end())
+                elementsMapFac[it->second].add(aFace, elemOrderMap[it->second]);
         }
     }
 
@@ -1493,47 +1568,34 @@ void FemMesh::writeABAQUS(const std::string &Filename, int elemParam, bool group
         SMDS_EdgeIteratorPtr aEdgeIter = myMesh->GetMeshDS()->edgesIterator();
         while (aEdgeIter->more()) {
             const SMDS_MeshEdge* aEdge = aEdgeIter->next();
-            std::pair<int, std::vector<int> > apair;
-            apair.first = aEdge->GetID();
-            int numNodes = aEdge->NbNodes();
-            std::map<int, std::string>::iterator it = edgeTypeMap.find(numNodes);
-            if (it != edgeTypeMap.end()) {
-                const std::vector<int>& order = elemOrderMap[it->second];
-                for (std::vector<int>::const_iterator jt = order.begin(); jt != order.end(); ++jt)
-                    apair.second.push_back(aEdge->GetNode(*jt)->GetID());
-                elementsMapEdg[it->second].insert(apair);
-            }
+            std::map<int, std::string>::iterator it = edgeTypeMap.find(aEdge->NbNodes());
+            if (it != edgeTypeMap.end())
+                elementsMapEdg[it->second].add(aEdge, elemOrderMap[it->second]);
         }
     }
     if (elemParam == 2) {
         // we're going to fill the elementsMapEdg with the edgesOnly
         std::set<int> edgesOnly = getEdgesOnly();
         for (std::set<int>::iterator ited = edgesOnly.begin(); ited != edgesOnly.end(); ++ited) {
-            std::pair<int, std::vector<int> > apair;
-            apair.first = *ited;
             const SMDS_MeshElement* aEdge = myMesh->GetMeshDS()->FindElement(*ited);
-            int numNodes = aEdge->NbNodes();
-            std::map<int, std::string>::iterator it = edgeTypeMap.find(numNodes);
-            if (it != edgeTypeMap.end()) {
-                const std::vector<int>& order = elemOrderMap[it->second];
-                for (std::vector<int>::const_iterator jt = order.begin(); jt != order.end(); ++jt)
-                    apair.second.push_back(aEdge->GetNode(*jt)->GetID());
-                elementsMapEdg[it->second].insert(apair);
-            }
+            std::map<int, std::string>::iterator it = edgeTypeMap.find(aEdge->NbNodes());
+            if (it != edgeTypeMap.end())
+                elementsMapEdg[it->second].add(aEdge, elemOrderMap[it->second]);
         }
     }
 
     // write all data to file
+    // the lines are ended with '\n' instead of std::endl to not flush the stream after each line
     std::ofstream anABAQUS_Output;
     anABAQUS_Output.open(Filename.c_str());
     anABAQUS_Output.precision(13);  // https://forum.freecadweb.org/viewtopic.php?f=18&t=22759#p176669
 
     // add some text and make sure one of the known elemParam values is used
-    anABAQUS_Output << "** written by FreeCAD inp file writer for CalculiX,Abaqus meshes" << std::endl;
+    anABAQUS_Output << "** written by FreeCAD inp file writer for CalculiX,Abaqus meshes\n";
     switch(elemParam){
-        case 0: anABAQUS_Output << "** all mesh elements." << std::endl << std::endl; break;
-        case 1: anABAQUS_Output << "** highest dimension mesh elements only." << std::endl << std::endl; break;
-        case 2: anABAQUS_Output << "** FEM mesh elements only (edges if they do not belong to faces and faces if they do not belong to volumes)." << std::endl << std::endl; break;
+        case 0: anABAQUS_Output << "** all mesh elements.\n\n"; break;
+        case 1: anABAQUS_Output << "** highest dimension mesh elements only.\n\n"; break;
+        case 2: anABAQUS_Output << "** FEM mesh elements only (edges if they do not belong to faces and faces if they do not belong to volumes).\n\n"; break;
         default:
             anABAQUS_Output << "** Problem on writing" << std::endl;
             anABAQUS_Output.close();
@@ -1541,93 +1603,67 @@ void FemMesh::writeABAQUS(const std::string &Filename, int elemParam, bool group
     }
 
     // write nodes
-    anABAQUS_Output << "** Nodes" << std::endl;
-    anABAQUS_Output << "*Node, NSET=Nall" << std::endl;
-    // This way we get sorted output.
-    // See http://forum.freecadweb.org/viewtopic.php?f=18&t=12646&start=40#p103004
-    for (VertexMap::iterator it = vertexMap.begin(); it != vertexMap.end(); ++it) {
-        anABAQUS_Output << it->first << ", "
-            << it->second.x << ", "
-            << it->second.y << ", "
-            << it->second.z << std::endl;
-    }
-    anABAQUS_Output << std::endl << std::endl;;
+    anABAQUS_Output << "** Nodes\n";
+    anABAQUS_Output << "*Node, NSET=Nall\n";
+    writeLines(anABAQUS_Output, vertexList.size(), [&vertexList](std::ostream& str, std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const VertexList::value_type& node = vertexList[i];
+            str << node.first << ", "
+                << node.second.x << ", "
+                << node.second.y << ", "
+                << node.second.z << '\n';
+        }
+    });
+    anABAQUS_Output << "\n\n";
 
 
     // write volumes to file
     std::string elsetname = "";
     if (!elementsMapVol.empty()) {
         for (ElementsMap::iterator it = elementsMapVol.begin(); it != elementsMapVol.end(); ++it) {
-            anABAQUS_Output << "** Volume elements" << std::endl;
-            anABAQUS_Output << "*Element, TYPE=" << it->first << ", ELSET=Evolumes" << std::endl;
-            for (NodesMap::iterator jt = it->second.begin(); jt != it->second.end(); ++jt) {
-                anABAQUS_Output << jt->first;
-                // Calculix allows max 16 entries in one line, a hexa20 has more !
-                int ct = 0;  // counter
-                bool first_line = true;
-                for (std::vector<int>::iterator kt = jt->second.begin(); kt != jt->second.end(); ++kt, ++ct) {
-                    if (ct < 15) {
-                        anABAQUS_Output  << ", " << *kt;
-                    }
-                    else {
-                        if (first_line == true) {
-                            anABAQUS_Output << "," << std::endl;
-                            first_line = false;
-                        }
-                        anABAQUS_Output << *kt << ", ";
-                    }
-                }
-                anABAQUS_Output << std::endl;
-            }
+            anABAQUS_Output << "** Volume elements\n";
+            anABAQUS_Output << "*Element, TYPE=" << it->first << ", ELSET=Evolumes\n";
+            it->second.sort();
+            writeAbaqusElements(anABAQUS_Output, it->second);
         }
         elsetname += "Evolumes";
-        anABAQUS_Output << std::endl;
+        anABAQUS_Output << '\n';
     }
 
     // write faces to file
     if (!elementsMapFac.empty()) {
         for (ElementsMap::iterator it = elementsMapFac.begin(); it != elementsMapFac.end(); ++it) {
-            anABAQUS_Output << "** Face elements" << std::endl;
-            anABAQUS_Output << "*Element, TYPE=" << it->first << ", ELSET=Efaces" << std::endl;
-            for (NodesMap::iterator jt = it->second.begin(); jt != it->second.end(); ++jt) {
-                anABAQUS_Output << jt->first;
-                for (std::vector<int>::iterator kt = jt->second.begin(); kt != jt->second.end(); ++kt) {
-                    anABAQUS_Output << ", " << *kt;
-                }
-                anABAQUS_Output << std::endl;
-            }
+            anABAQUS_Output << "** Face elements\n";
+            anABAQUS_Output << "*Element, TYPE=" << it->first << ", ELSET=Efaces\n";
+            it->second.sort();
+            writeAbaqusElements(anABAQUS_Output, it->second);
         }
         if (elsetname == "")
             elsetname += "Efaces";
         else
             elsetname += ", Efaces";
-        anABAQUS_Output << std::endl;
+        anABAQUS_Output << '\n';
     }
 
     // write edges to file
     if (!elementsMapEdg.empty()) {
         for (ElementsMap::iterator it = elementsMapEdg.begin(); it != elementsMapEdg.end(); ++it) {
-            anABAQUS_Output << "** Edge elements" << std::endl;
-            anABAQUS_Output << "*Element, TYPE=" << it->first << ", ELSET=Eedges" << std::endl;
-            for (NodesMap::iterator jt = it->second.begin(); jt != it->second.end(); ++jt) {
-                anABAQUS_Output << jt->first;
-                for (std::vector<int>::iterator kt = jt->second.begin(); kt != jt->second.end(); ++kt) {
-                    anABAQUS_Output << ", " << *kt;
-                }
-                anABAQUS_Output << std::endl;
-            }
+            anABAQUS_Output << "** Edge elements\n";
+            anABAQUS_Output << "*Element, TYPE=" << it->first << ", ELSET=Eedges\n";
+            it->second.sort();
+            writeAbaqusElements(anABAQUS_Output, it->second);
         }
         if (elsetname == "")
             elsetname += "Eedges";
         else
             elsetname += ", Eedges";
-        anABAQUS_Output << std::endl;
+        anABAQUS_Output << '\n';
     }
 
     // write elset Eall
-    anABAQUS_Output << "** Define element set Eall" << std::endl;
-    anABAQUS_Output << "*ELSET, ELSET=Eall" << std::endl;
-    anABAQUS_Output << elsetname << std::endl;
+    anABAQUS_Output << "** Define element set Eall\n";
+    anABAQUS_Output << "*ELSET, ELSET=Eall\n";
+    anABAQUS_Output << elsetname << '\n';
 
     // groups
     if (groupParam == false) {
@@ -1635,7 +1671,7 @@ void FemMesh::writeABAQUS(const std::string &Filename, int elemParam, bool group
     }
     else {
         // get and write group data
-        anABAQUS_Output  << std::endl << "** Group data" << std::endl;
+        anABAQUS_Output  << "\n** Group data\n";
 
         std::list<int> groupIDs = myMesh->GetGroupIds();
         for (std::list<int>::iterator it = groupIDs.begin(); it != groupIDs.end(); ++it) {
@@ -1655,13 +1691,13 @@ void FemMesh::writeABAQUS(const std::string &Filename, int elemParam, bool group
                 default                     : groupElementType = "Unknown"; break;
             }
             const char* groupName = myMesh->GetGroup(*it)->GetName();
-            anABAQUS_Output << "** GroupID: " << (*it) << " --> GroupName: " << groupName << " --> GroupElementType: " << groupElementType << std::endl;
+            anABAQUS_Output << "** GroupID: " << (*it) << " --> GroupName: " << groupName << " --> GroupElementType: " << groupElementType << '\n';
 
             if (aElementType == SMDSAbs_Node) {
-                anABAQUS_Output << "*NSET, NSET=" << groupName << std::endl;
+                anABAQUS_Output << "*NSET, NSET=" << groupName << '\n';
             }
             else {
-                anABAQUS_Output << "*ELSET, ELSET=" << groupName << std::endl;
+                anABAQUS_Output << "*ELSET, ELSET=" << groupName << '\n';
             }
 
             // get and write group elements
@@ -1672,17 +1708,16 @@ void FemMesh::writeABAQUS(const std::string &Filename, int elemParam, bool group
                 ids.insert(aElement->GetID());
             }
             for (std::set<int>::iterator it = ids.begin(); it != ids.end(); ++it) {
-                anABAQUS_Output << *it << std::endl;
+                anABAQUS_Output << *it << '\n';
             }
 
             // write newline after each group
-            anABAQUS_Output << std::endl;
+            anABAQUS_Output << '\n';
         }
         anABAQUS_Output.close();
     }
 }
 
-
 void FemMesh::writeZ88(const std::string &FileName) const
 {
     Base::TimeInfo Start;
@@ -0,0 +1,784 @@
+/***************************************************************************
+ *   Copyright (c) 2020 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <atomic>
+# include <cctype>
+# include <condition_variable>
+# include <cstdlib>
+# include <cstring>
+# include <exception>
+# include <map>
+# include <mutex>
+# include <thread>
+#endif
+
+#include <Base/Console.h>
+#include <Base/Exception.h>
+#include <Base/FileInfo.h>
+#include <Base/Stream.h>
+
+#include "FemMeshReader.h"
+
+using namespace Fem;
+
+namespace {
+
+typedef std::pair<const char*, const char*> Field;
+
+// Abaqus element types and the mapping of their nodes to the SMESH order,
+// it must be kept in sync with FemMesh::writeABAQUS()
+struct AbaqusType {
+    const char* name;
+    unsigned char dim;
+    int nodes;
+    const int* order;
+};
+
+const int c3d4[]  = {1, 0, 2, 3};
+const int c3d10[] = {1, 0, 2, 3, 4, 6, 5, 8, 7, 9};
+const int c3d8[]  = {5, 6, 7, 4, 1, 2, 3, 0};
+const int c3d20[] = {5, 6, 7, 4, 1, 2, 3, 0, 13, 14, 15, 12, 9, 10, 11, 8, 17, 18, 19, 16};
+const int c3d6[]  = {4, 5, 3, 1, 2, 0};
+const int c3d15[] = {4, 5, 3, 1, 2, 0, 10, 11, 9, 7, 8, 6, 13, 14, 12};
+const int b32[]   = {0, 2, 1};
+
+const AbaqusType abaqusTypes[] = {
+    {"S3", 2, 3, 0}, {"CPS3", 2, 3, 0}, {"CPE3", 2, 3, 0}, {"CAX3", 2, 3, 0},
+    {"S6", 2, 6, 0}, {"CPS6", 2, 6, 0}, {"CPE6", 2, 6, 0}, {"CAX6", 2, 6, 0},
+    {"S4", 2, 4, 0}, {"S4R", 2, 4, 0}, {"CPS4", 2, 4, 0}, {"CPS4R", 2, 4, 0},
+    {"CPE4", 2, 4, 0}, {"CPE4R", 2, 4, 0}, {"CAX4", 2, 4, 0}, {"CAX4R", 2, 4, 0},
+    {"S8", 2, 8, 0}, {"S8R", 2, 8, 0}, {"CPS8", 2, 8, 0}, {"CPS8R", 2, 8, 0},
+    {"CPE8", 2, 8, 0}, {"CPE8R", 2, 8, 0}, {"CAX8", 2, 8, 0}, {"CAX8R", 2, 8, 0},
+    {"C3D4", 3, 4, c3d4}, {"C3D10", 3, 10, c3d10},
+    {"C3D8", 3, 8, c3d8}, {"C3D8R", 3, 8, c3d8}, {"C3D8I", 3, 8, c3d8},
+    {"C3D20", 3, 20, c3d20}, {"C3D20R", 3, 20, c3d20}, {"C3D20RI", 3, 20, c3d20},
+    {"C3D6", 3, 6, c3d6}, {"C3D15", 3, 15, c3d15},
+    {"B31", 1, 2, 0}, {"B31R", 1, 2, 0}, {"T3D2", 1, 2, 0},
+    {"B32", 1, 3, b32}, {"B32R", 1, 3, b32}, {"T3D3", 1, 3, b32},
+};
+
+// Sections of an Abaqus file, element sections are SectionElements plus
+// the index into abaqusTypes
+const int SectionNone = 0;
+const int SectionNodes = 1;
+const int SectionElements = 2;
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+inline Field trimmed(const char* begin, const char* end)
+{
+    while (begin < end && isSpace(*begin))
+        ++begin;
+    while (end > begin && isSpace(end[-1]))
+        --end;
+    return Field(begin, end);
+}
+
+inline const char* endOfLine(const char* begin, const char* end)
+{
+    const char* eol = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+    return eol ? eol : end;
+}
+
+inline bool isBlank(const char* begin, const char* end)
+{
+    Field f = trimmed(begin, end);
+    return f.first == f.second;
+}
+
+bool toInt(const Field& field, int& value)
+{
+    Field f = trimmed(field.first, field.second);
+    const char* it = f.first;
+    bool negative = false;
+    if (it < f.second && (*it == '-' || *it == '+'))
+        negative = (*it++ == '-');
+    if (it == f.second)
+        return false;
+    long result = 0;
+    for (; it < f.second; ++it) {
+        if (*it < '0' || *it > '9') {
+            // accept integers written as reals, e.g. '12.'
+            if (*it == '.' && it + 1 == f.second)
+                break;
+            return false;
+        }
+        result = result * 10 + (*it - '0');
+    }
+    value = static_cast<int>(negative ? -result : result);
+    return true;
+}
+
+// Nastran allows to omit the 'E' of the exponent (1.5-3) and uses 'D' for
+// double precision, so the field is rewritten before it is passed to strtod.
+double toReal(const Field& field, bool nastran)
+{
+    Field f = trimmed(field.first, field.second);
+    char buf[64];
+    std::size_t len = 0;
+    for (const char* it = f.first; it < f.second && len < sizeof(buf) - 2; ++it) {
+        char c = *it;
+        if (nastran) {
+            if (c == 'D' || c == 'd') {
+                c = 'E';
+            }
+            else if ((c == '-' || c == '+') && len > 0
+                     && buf[len-1] != 'E' && buf[len-1] != 'e') {
+                buf[len++] = 'E';
+            }
+        }
+        buf[len++] = c;
+    }
+    buf[len] = 0;
+    return std::strtod(buf, 0);
+}
+
+// Splits a line at the commas, empty fields are kept
+void splitLine(const char* begin, const char* end, std::vector<Field>& fields)
+{
+    fields.clear();
+    const char* it = begin;
+    for (;;) {
+        const char* comma = static_cast<const char*>(std::memchr(it, ',', end - it));
+        if (!comma) {
+            fields.push_back(Field(it, end));
+            break;
+        }
+        fields.push_back(Field(it, comma));
+        it = comma + 1;
+    }
+}
+
+// Number of values of a data line, a trailing comma doesn't start a value
+int countValues(const char* begin, const char* end)
+{
+    int count = 1;
+    const char* last = begin;
+    for (const char* it = begin; it < end; ++it) {
+        if (*it == ',') {
+            ++count;
+            last = it + 1;
+        }
+    }
+    if (isBlank(last, end))
+        --count;
+    return count;
+}
+
+void addElement(MeshBlock& block, int id, unsigned char dim,
+                const std::vector<int>& nodes, const int* order)
+{
+    block.elemIds.push_back(id);
+    block.elemDims.push_back(dim);
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+        block.elemNodes.push_back(order ? nodes[order[i]] : nodes[i]);
+    block.elemOffsets.push_back(block.elemNodes.size());
+}
+
+// ----------------------------------------------------------------------------
+
+inline bool isCardStart(char c)
+{
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+void parseNastranCard(const std::vector<Field>& lines, MeshBlock& block,
+                      std::vector<Field>& fields, std::vector<Field>& tokens,
+                      std::vector<int>& nodes)
+{
+    const Field& first = lines.front();
+    bool freeField = std::memchr(first.first, ',', first.second - first.first) != 0;
+
+    Field name = freeField
+        ? trimmed(first.first, static_cast<const char*>(std::memchr(first.first, ',', first.second - first.first)))
+        : trimmed(first.first, std::min(first.first + 8, first.second));
+    std::string card(name.first, name.second);
+    for (std::string::iterator it = card.begin(); it != card.end(); ++it)
+        *it = static_cast<char>(std::toupper(static_cast<unsigned char>(*it)));
+    bool largeField = !card.empty() && card[card.size()-1] == '*';
+    if (largeField)
+        card.resize(card.size()-1);
+    if (card != "GRID" && card != "CTETRA")
+        return;
+
+    // collect the data fields without the card name and continuation markers
+    fields.clear();
+    const std::size_t perLine = largeField ? 4 : 8;
+    if (freeField) {
+        for (std::vector<Field>::const_iterator it = lines.begin(); it != lines.end(); ++it) {
+            splitLine(it->first, it->second, tokens);
+            std::size_t count = tokens.size() - 1;
+            // a single long line without continuation
+            if (count > perLine + 1)
+                fields.insert(fields.end(), tokens.begin() + 1, tokens.end());
+            else
+                fields.insert(fields.end(), tokens.begin() + 1, tokens.begin() + 1 + std::min(count, perLine));
+        }
+    }
+    else {
+        const std::size_t width = largeField ? 16 : 8;
+        int offset = 0;
+        for (std::vector<Field>::const_iterator it = lines.begin(); it != lines.end(); ++it) {
+            if (it != lines.begin() && offset > 0) {
+                // some writers shift the continuation lines of elements with large ids
+                for (std::size_t i = 0; i < perLine; ++i) {
+                    const char* b = std::min(it->first + 8 + offset + i * width, it->second);
+                    const char* e = std::min(b + width, it->second);
+                    fields.push_back(Field(b, e));
+                }
+                continue;
+            }
+            for (std::size_t i = 0; i < perLine; ++i) {
+                const char* b = std::min(it->first + 8 + i * width, it->second);
+                const char* e = std::min(b + width, it->second);
+                fields.push_back(Field(b, e));
+            }
+            if (it == lines.begin() && card == "CTETRA" && !largeField) {
+                int id = 0;
+                toInt(fields[0], id);
+                if (id >= 1000000 && id < 10000000)
+                    offset = 1;
+                else if (id >= 10000000 && id < 100000000)
+                    offset = 2;
+            }
+        }
+    }
+
+    int id = 0;
+    if (fields.empty() || !toInt(fields[0], id))
+        return;
+
+    if (card == "GRID") {
+        block.nodeIds.push_back(id);
+        for (std::size_t i = 2; i < 5; ++i)
+            block.nodeCoords.push_back(i < fields.size() ? toReal(fields[i], true) : 0.0);
+    }
+    else {
+        nodes.clear();
+        for (std::size_t i = 2; i < fields.size() && nodes.size() < 10; ++i) {
+            int node;
+            if (!toInt(fields[i], node))
+                break;
+            nodes.push_back(node);
+        }
+        if (nodes.size() == 10) {
+            addElement(block, id, 3, nodes, c3d10);
+        }
+        else if (nodes.size() >= 4) {
+            nodes.resize(4);
+            addElement(block, id, 3, nodes, c3d4);
+        }
+        else {
+            block.skipped++;
+        }
+    }
+}
+
+void parseNastran(const char* begin, const char* end, MeshBlock& block)
+{
+    std::vector<Field> lines, fields, tokens;
+    std::vector<int> nodes;
+    for (const char* line = begin; line < end;) {
+        const char* eol = endOfLine(line, end);
+        if (isCardStart(*line)) {
+            if (!lines.empty())
+                parseNastranCard(lines, block, fields, tokens, nodes);
+            lines.clear();
+            lines.push_back(Field(line, eol));
+        }
+        else if (*line != '$' && !lines.empty() && !isBlank(line, eol)) {
+            lines.push_back(Field(line, eol));
+        }
+        line = eol + 1;
+    }
+    if (!lines.empty())
+        parseNastranCard(lines, block, fields, tokens, nodes);
+}
+
+void parseAbaqus(const char* begin, const char* end, int section, MeshBlock& block)
+{
+    std::vector<Field> tokens;
+    std::vector<int> values, nodes;
+    const AbaqusType* type = section >= SectionElements ? &abaqusTypes[section - SectionElements] : 0;
+    bool valid = true;
+
+    for (const char* line = begin; line < end;) {
+        const char* eol = endOfLine(line, end);
+        const char* next = eol + 1;
+        if ((*line == '*' && line + 1 < eol && line[1] == '*') || isBlank(line, eol)) {
+            line = next;
+            continue;
+        }
+        splitLine(line, eol, tokens);
+        line = next;
+
+        if (!type) {
+            int id;
+            if (!toInt(tokens[0], id))
+                continue;
+            block.nodeIds.push_back(id);
+            for (std::size_t i = 1; i < 4; ++i)
+                block.nodeCoords.push_back(i < tokens.size() ? toReal(tokens[i], false) : 0.0);
+            continue;
+        }
+
+        // the nodes of an element may be spread over several lines
+        for (std::vector<Field>::iterator it = tokens.begin(); it != tokens.end(); ++it) {
+            if (isBlank(it->first, it->second))
+                continue;
+            int value;
+            if (toInt(*it, value))
+                values.push_back(value);
+            else
+                valid = false;
+        }
+        if (static_cast<int>(values.size()) > type->nodes) {
+            if (valid) {
+                nodes.assign(values.begin() + 1, values.begin() + 1 + type->nodes);
+                addElement(block, values[0], type->dim, nodes, type->order);
+            }
+            else {
+                block.skipped++;
+            }
+            values.clear();
+            valid = true;
+        }
+    }
+    if (!values.empty())
+        block.skipped++;
+}
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+MeshBlock::MeshBlock()
+  : skipped(0)
+{
+    elemOffsets.push_back(0);
+}
+
+void MeshBlock::clear()
+{
+    nodeIds.clear();
+    nodeCoords.clear();
+    elemIds.clear();
+    elemDims.clear();
+    elemOffsets.clear();
+    elemOffsets.push_back(0);
+    elemNodes.clear();
+    skipped = 0;
+}
+
+// ----------------------------------------------------------------------------
+
+struct MeshFileReader::State
+{
+    bool modelDefinition;
+    int section;
+    // values still missing of the current element
+    int remaining;
+    int depth;
+
+    State() : modelDefinition(true), section(SectionNone), remaining(0), depth(0) {}
+};
+
+MeshFileReader::MeshFileReader(const Sink& sink)
+  : sink(sink)
+  , threads(0)
+  , blockSize(16 * 1024 * 1024)
+  , pieceSize(0)
+  , bytes(0)
+  , abaqus(false)
+{
+}
+
+MeshFileReader::~MeshFileReader()
+{
+}
+
+void MeshFileReader::setThreadCount(int count)
+{
+    threads = count;
+}
+
+void MeshFileReader::setBlockSize(std::size_t size)
+{
+    // very small blocks are only useful to test records crossing blocks
+    blockSize = std::max<std::size_t>(size, 16);
+}
+
+void MeshFileReader::readNastran(const std::string& fileName)
+{
+    abaqus = false;
+    State state;
+    readFile(fileName, state);
+}
+
+void MeshFileReader::readAbaqus(const std::string& fileName)
+{
+    abaqus = true;
+    State state;
+    readFile(fileName, state);
+}
+
+void MeshFileReader::readFile(const std::string& fileName, State& state)
+{
+    Base::FileInfo fi(fileName);
+    if (!fi.isReadable())
+        throw Base::FileException("File to load not existing or not readable", fi);
+    Base::ifstream str(fi, std::ios::in | std::ios::binary);
+    if (!str)
+        throw Base::FileException("Failed to open file", fi);
+
+    if (threads <= 0)
+        threads = std::max<int>(1, std::thread::hardware_concurrency());
+    // several pieces per thread to balance the load
+    pieceSize = std::max<std::size_t>(blockSize / (threads * 4),
+                                      std::min<std::size_t>(blockSize / 4, 64 * 1024));
+
+    // Each block is cut after the last complete record and the rest is
+    // carried over to the next block. A record longer than a block simply
+    // makes the buffer grow.
+    std::vector<char> buffer;
+    std::size_t carry = 0;
+    bool atEnd = false;
+    while (!atEnd) {
+        buffer.resize(carry + blockSize);
+        str.read(&buffer[carry], blockSize);
+        if (str.bad())
+            throw Base::FileException("Failed to read file", fi);
+        std::size_t count = static_cast<std::size_t>(str.gcount());
+        atEnd = count < blockSize;
+        bytes += count;
+
+        std::size_t size = carry + count;
+        std::size_t used = abaqus ? scanAbaqus(&buffer[0], size, atEnd, fileName, state)
+                                  : scanNastran(&buffer[0], size, atEnd);
+        flush();
+
+        carry = size - used;
+        if (carry > 0 && used > 0)
+            std::memmove(&buffer[0], &buffer[used], carry);
+    }
+}
+
+void MeshFileReader::addPiece(const char* begin, const char* end, int section)
+{
+    if (begin < end) {
+        Piece piece = {begin, end, section};
+        pieces.push_back(piece);
+    }
+}
+
+std::size_t MeshFileReader::scanNastran(const char* data, std::size_t size, bool atEnd)
+{
+    // A card starts with a letter in the first column and may be followed by
+    // continuation lines. So a piece may end before every line that starts
+    // with a letter.
+    const char* end = data + size;
+    const char* start = data;
+    const char* card = data;
+    for (const char* line = data; line < end;) {
+        const char* eol = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        if (!eol)
+            break;
+        if (isCardStart(*line)) {
+            card = line;
+            if (static_cast<std::size_t>(line - start) >= pieceSize) {
+                addPiece(start, line, SectionNone);
+                start = line;
+            }
+        }
+        line = eol + 1;
+    }
+
+    if (atEnd) {
+        addPiece(start, end, SectionNone);
+        return size;
+    }
+
+    // the last card may have continuation lines in the next block
+    addPiece(start, card, SectionNone);
+    return std::max(card, start) - data;
+}
+
+std::size_t MeshFileReader::scanAbaqus(const char* data, std::size_t size, bool atEnd,
+                                       const std::string& fileName, State& state)
+{
+    const char* end = data + size;
+    // begin of the current piece if inside of a node or element section
+    const char* start = state.section != SectionNone ? data : 0;
+    // where to continue with the next block
+    const char* resume = data;
+    state.remaining = 0;
+
+    const char* line = data;
+    while (line < end) {
+        const char* eol = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        if (!eol) {
+            if (!atEnd)
+                break;
+            eol = end;
+        }
+        const char* next = std::min(eol + 1, end);
+
+        if (*line == '*') {
+            if (line + 1 < eol && line[1] == '*') {
+                // comment
+                if (state.remaining <= 0)
+                    resume = next;
+                line = next;
+                continue;
+            }
+
+            // a keyword line ending with a comma is continued on the next line
+            std::string keyword(line + 1, eol);
+            bool complete = true;
+            while (complete) {
+                Field f = trimmed(keyword.data(), keyword.data() + keyword.size());
+                keyword.assign(f.first, f.second);
+                if (keyword.empty() || keyword[keyword.size()-1] != ',' || next >= end)
+                    break;
+                const char* eol2 = static_cast<const char*>(std::memchr(next, '\n', end - next));
+                if (!eol2) {
+                    if (!atEnd)
+                        complete = false;
+                    eol2 = end;
+                }
+                keyword.append(next, eol2);
+                next = std::min(eol2 + 1, end);
+            }
+
+            if (start) {
+                addPiece(start, line, state.section);
+                start = 0;
+            }
+            if (!complete) {
+                resume = line;
+                break;
+            }
+
+            // keyword name and parameters
+            std::vector<std::string> parts(1);
+            for (std::string::iterator it = keyword.begin(); it != keyword.end(); ++it) {
+                if (*it == ',')
+                    parts.push_back(std::string());
+                else
+                    parts.back() += *it;
+            }
+            std::string name;
+            for (std::string::iterator it = parts[0].begin(); it != parts[0].end(); ++it) {
+                if (!isSpace(*it))
+                    name += static_cast<char>(std::toupper(static_cast<unsigned char>(*it)));
+            }
+            std::map<std::string, std::string> params;
+            for (std::size_t i = 1; i < parts.size(); ++i) {
+                std::string::size_type pos = parts[i].find('=');
+                std::string key;
+                for (std::size_t j = 0; j < std::min(pos, parts[i].size()); ++j) {
+                    if (!isSpace(parts[i][j]))
+                        key += static_cast<char>(std::toupper(static_cast<unsigned char>(parts[i][j])));
+                }
+                std::string value;
+                if (pos != std::string::npos) {
+                    Field f = trimmed(parts[i].data() + pos + 1, parts[i].data() + parts[i].size());
+                    value.assign(f.first, f.second);
+                    if (value.size() >= 2 && value[0] == '"' && value[value.size()-1] == '"')
+                        value = value.substr(1, value.size()-2);
+                }
+                params[key] = value;
+            }
+
+            state.section = SectionNone;
+            state.remaining = 0;
+            if (name == "NODE") {
+                if (state.modelDefinition)
+                    state.section = SectionNodes;
+            }
+            else if (name == "ELEMENT") {
+                std::string type = params["TYPE"];
+                for (std::string::iterator it = type.begin(); it != type.end(); ++it)
+                    *it = static_cast<char>(std::toupper(static_cast<unsigned char>(*it)));
+                for (std::size_t i = 0; i < sizeof(abaqusTypes) / sizeof(abaqusTypes[0]); ++i) {
+                    if (type == abaqusTypes[i].name) {
+                        state.section = SectionElements + static_cast<int>(i);
+                        break;
+                    }
+                }
+                if (state.section == SectionNone)
+                    Base::Console().Warning("Abaqus element type '%s' is not supported\n", type.c_str());
+            }
+            else if (name == "STEP") {
+                state.modelDefinition = false;
+            }
+            else if (name == "INCLUDE") {
+                std::string input = params["INPUT"];
+                Base::FileInfo fi(input);
+                if (!fi.exists())
+                    fi.setFile(Base::FileInfo(fileName).dirPath() + "/" + input);
+                if (state.depth >= 16)
+                    throw Base::FileException("Too many nested *INCLUDE", fi);
+
+                // the pending pieces refer to this block and must be
+                // parsed before the included file is read
+                flush();
+                state.depth++;
+                readFile(fi.filePath(), state);
+                state.depth--;
+                state.remaining = 0;
+            }
+
+            line = next;
+            resume = next;
+            if (state.section != SectionNone)
+                start = next;
+            continue;
+        }
+
+        if (start && !isBlank(line, eol)) {
+            if (state.section >= SectionElements) {
+                if (state.remaining <= 0) {
+                    resume = line;
+                    if (static_cast<std::size_t>(line - start) >= pieceSize) {
+                        addPiece(start, line, state.section);
+                        start = line;
+                    }
+                    state.remaining = abaqusTypes[state.section - SectionElements].nodes + 1;
+                }
+                state.remaining -= countValues(line, eol);
+            }
+            else {
+                resume = line;
+                if (static_cast<std::size_t>(line - start) >= pieceSize) {
+                    addPiece(start, line, state.section);
+                    start = line;
+                }
+            }
+        }
+        else if (state.remaining <= 0) {
+            resume = line;
+        }
+        line = next;
+    }
+
+    if (atEnd) {
+        if (start)
+            addPiece(start, end, state.section);
+        return size;
+    }
+
+    // the last record may be incomplete
+    if (state.remaining <= 0)
+        resume = line;
+    if (start)
+        addPiece(start, resume, state.section);
+    return resume - data;
+}
+
+void MeshFileReader::flush()
+{
+    if (pieces.empty())
+        return;
+
+    std::vector<MeshBlock> blocks(pieces.size());
+    std::vector<std::exception_ptr> errors(pieces.size());
+    std::vector<char> done(pieces.size(), 0);
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::atomic<std::size_t> next(0);
+    std::atomic<bool> cancel(false);
+
+    auto parse = [&](std::size_t i) {
+        try {
+            if (abaqus)
+                parseAbaqus(pieces[i].begin, pieces[i].end, pieces[i].section, blocks[i]);
+            else
+                parseNastran(pieces[i].begin, pieces[i].end, blocks[i]);
+        }
+        catch (...) {
+            errors[i] = std::current_exception();
+        }
+    };
+    auto work = [&]() {
+        for (;;) {
+            std::size_t i = next++;
+            if (i >= pieces.size() || cancel)
+                break;
+            parse(i);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                done[i] = 1;
+            }
+            cond.notify_all();
+        }
+    };
+
+    // The pieces are parsed by the worker threads while the calling thread
+    // hands them over to the sink in file order.
+    std::vector<std::thread> workers;
+    std::size_t count = std::min<std::size_t>(threads, pieces.size());
+    if (count > 1) {
+        for (std::size_t i = 0; i < count; ++i)
+            workers.push_back(std::thread(work));
+    }
+
+    std::exception_ptr error;
+    for (std::size_t i = 0; i < pieces.size(); ++i) {
+        if (workers.empty()) {
+            parse(i);
+        }
+        else {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait(lock, [&]() { return done[i] != 0; });
+        }
+        if (errors[i]) {
+            error = errors[i];
+            break;
+        }
+        try {
+            sink(blocks[i]);
+        }
+        catch (...) {
+            error = std::current_exception();
+            break;
+        }
+        // release the memory as early as possible
+        blocks[i] = MeshBlock();
+    }
+
+    if (error)
+        cancel = true;
+    for (std::vector<std::thread>::iterator it = workers.begin(); it != workers.end(); ++it)
+        it->join();
+    pieces.clear();
+    if (error)
+        std::rethrow_exception(error);
+}
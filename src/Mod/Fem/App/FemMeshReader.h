@@ -0,0 +1,116 @@
+/***************************************************************************
+ *   Copyright (c) 2020 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef FEM_MESHREADER_H
+#define FEM_MESHREADER_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Fem
+{
+
+/*!
+ Nodes and elements parsed from a part of a mesh file. The node ids of
+ the elements are already in SMESH order.
+ */
+struct AppFemExport MeshBlock
+{
+    std::vector<int> nodeIds;
+    /// x, y, z of each node
+    std::vector<double> nodeCoords;
+    std::vector<int> elemIds;
+    /// 1 = edge, 2 = face, 3 = volume
+    std::vector<unsigned char> elemDims;
+    /// start of the nodes of each element in elemNodes, plus the end
+    std::vector<std::size_t> elemOffsets;
+    std::vector<int> elemNodes;
+    /// number of unsupported or incomplete elements
+    std::size_t skipped;
+
+    MeshBlock();
+    void clear();
+};
+
+/*!
+ Streaming reader for Nastran bulk data and Abaqus input files.
+ The file is read in blocks of fixed size. Each block is cut at record
+ boundaries into pieces which are parsed in parallel, and the parsed
+ pieces are handed over to the sink in file order. So only a small part
+ of the file is held in memory at any time and the sink can insert the
+ data into the mesh while the rest of the file is being parsed.
+ */
+class AppFemExport MeshFileReader
+{
+public:
+    typedef std::function<void (const MeshBlock&)> Sink;
+
+    MeshFileReader(const Sink&);
+    ~MeshFileReader();
+
+    /// Number of parser threads, 0 means the number of cores
+    void setThreadCount(int);
+    /// Number of bytes read from the file at once, at least 16
+    void setBlockSize(std::size_t);
+
+    /// Reads GRID and CTETRA cards in small, large or free field format
+    void readNastran(const std::string& fileName);
+    /// Reads the nodes and elements of the model definition, follows *INCLUDE
+    void readAbaqus(const std::string& fileName);
+
+    /// Number of bytes read, including included files
+    std::size_t bytesRead() const {
+        return bytes;
+    }
+
+private:
+    struct Piece {
+        const char* begin;
+        const char* end;
+        int section;
+    };
+    struct State;
+
+    void readFile(const std::string& fileName, State&);
+    std::size_t scanNastran(const char* data, std::size_t size, bool atEnd);
+    std::size_t scanAbaqus(const char* data, std::size_t size, bool atEnd,
+                           const std::string& fileName, State&);
+    void addPiece(const char* begin, const char* end, int section);
+    void flush();
+
+private:
+    Sink sink;
+    int threads;
+    std::size_t blockSize;
+    std::size_t pieceSize;
+    std::size_t bytes;
+    bool abaqus;
+    std::vector<Piece> pieces;
+};
+
+} //namespace Fem
+
+
+#endif // FEM_MESHREADER_H
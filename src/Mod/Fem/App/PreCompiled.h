@@ -66,6 +66,12 @@
 
 #include <algorithm>
 #include <stdexcept>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
 // Python
 #include <Python.h>
 
@@ -0,0 +1,131 @@
+# ***************************************************************************
+# *   This file is part of the FreeCAD CAx development system.              *
+# *                                                                         *
+# *   This program is free software; you can redistribute it and/or modify  *
+# *   it under the terms of the GNU Lesser General Public License (LGPL)    *
+# *   as published by the Free Software Foundation; either version 2 of     *
+# *   the License, or (at your option) any later version.                   *
+# *   for detail see the LICENCE text file.                                 *
+# *                                                                         *
+# *   FreeCAD is distributed in the hope that it will be useful,            *
+# *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+# *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+# *   GNU Library General Public License for more details.                  *
+# *                                                                         *
+# *   You should have received a copy of the GNU Library General Public     *
+# *   License along with FreeCAD; if not, write to the Free Software        *
+# *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+# *   USA                                                                   *
+# *                                                                         *
+# ***************************************************************************/
+
+# Benchmarks of reading and writing large mesh files. They are not part of
+# the unit tests, run them explicitly with
+#   FreeCAD -t FemBenchmark
+
+import Fem
+import FreeCAD
+import os
+import shutil
+import tempfile
+import time
+import unittest
+
+
+def peak_rss():
+    # peak resident set size of the process in kB, it never decreases
+    try:
+        import resource
+    except ImportError:
+        return 0
+    return resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+
+
+class MeshFileBenchmarkCases(unittest.TestCase):
+    # structured meshes with n*n*n cubes
+    Sizes = [50, 100]
+
+    def setUp(self):
+        self.temp_dir = tempfile.mkdtemp()
+
+    def tearDown(self):
+        shutil.rmtree(self.temp_dir, ignore_errors=True)
+
+    def node_id(self, n, i, j, k):
+        return 1 + i + (n + 1) * (j + (n + 1) * k)
+
+    def write_abaqus(self, path, n):
+        with open(path, 'w') as f:
+            f.write("*Node, NSET=Nall\n")
+            for k in range(n + 1):
+                for j in range(n + 1):
+                    for i in range(n + 1):
+                        f.write("{}, {}, {}, {}\n".format(self.node_id(n, i, j, k), i, j, k))
+            f.write("*Element, TYPE=C3D8, ELSET=Evolumes\n")
+            elem = 0
+            for k in range(n):
+                for j in range(n):
+                    for i in range(n):
+                        elem += 1
+                        f.write("{}, {}, {}, {}, {}, {}, {}, {}, {}\n".format(
+                            elem,
+                            self.node_id(n, i, j, k), self.node_id(n, i + 1, j, k),
+                            self.node_id(n, i + 1, j + 1, k), self.node_id(n, i, j + 1, k),
+                            self.node_id(n, i, j, k + 1), self.node_id(n, i + 1, j, k + 1),
+                            self.node_id(n, i + 1, j + 1, k + 1), self.node_id(n, i, j + 1, k + 1)
+                        ))
+        return n ** 3
+
+    def write_nastran(self, path, n):
+        # each cube is split into six tetrahedra along its diagonal
+        cube = [(0, 1, 3, 7), (0, 1, 5, 7), (0, 2, 3, 7), (0, 2, 6, 7), (0, 4, 5, 7), (0, 4, 6, 7)]
+        with open(path, 'w') as f:
+            f.write("BEGIN BULK\n")
+            for k in range(n + 1):
+                for j in range(n + 1):
+                    for i in range(n + 1):
+                        f.write("GRID,{},,{},{},{}\n".format(self.node_id(n, i, j, k), i, j, k))
+            elem = 0
+            for k in range(n):
+                for j in range(n):
+                    for i in range(n):
+                        corners = [self.node_id(n, i + (c & 1), j + ((c >> 1) & 1), k + ((c >> 2) & 1))
+                                   for c in range(8)]
+                        for tet in cube:
+                            elem += 1
+                            f.write("CTETRA,{},1,{},{},{},{}\n".format(
+                                elem, *[corners[c] for c in tet]))
+            f.write("ENDDATA\n")
+        return 6 * n ** 3
+
+    def report(self, what, path, count, t):
+        FreeCAD.Console.PrintMessage(
+            "{:<16} {:>9} elements {:>8.1f} MB: {:>10.0f} elements/s, peak RSS {} kB\n".format(
+                what, count, os.path.getsize(path) / 1e6, count / max(t, 1e-6), peak_rss()))
+
+    def testAbaqus(self):
+        for n in self.Sizes:
+            path = os.path.join(self.temp_dir, "hexa8_{}.inp".format(n))
+            count = self.write_abaqus(path, n)
+
+            start = time.time()
+            mesh = Fem.read(path)
+            self.report("Read Abaqus", path, count, time.time() - start)
+            self.assertEqual(mesh.VolumeCount, count)
+
+            out = os.path.join(self.temp_dir, "hexa8_{}_out.inp".format(n))
+            start = time.time()
+            mesh.writeABAQUS(out, 1, False)
+            self.report("Write Abaqus", out, count, time.time() - start)
+            del mesh
+
+    def testNastran(self):
+        for n in self.Sizes:
+            path = os.path.join(self.temp_dir, "tetra4_{}.bdf".format(n))
+            count = self.write_nastran(path, n)
+
+            start = time.time()
+            mesh = Fem.read(path)
+            self.report("Read Nastran", path, count, time.time() - start)
+            self.assertEqual(mesh.VolumeCount, count)
+            del mesh
@@ -202,6 +202,133 @@ class TestMeshCommon(unittest.TestCase):
             )
         )
 
+    # ********************************************************************************************
+    def test_read_nastran(
+        self
+    ):
+        self.read_nastran()
+
+    # ********************************************************************************************
+    def test_read_nastran_small_blocks(
+        self
+    ):
+        # cards and continuation lines span several blocks read from the file
+        self.with_block_size(32, self.read_nastran)
+
+    # ********************************************************************************************
+    def with_block_size(
+        self,
+        block_size,
+        test
+    ):
+        param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Fem/General")
+        old_block_size = param.GetUnsigned("MeshReaderBlockSize", 0)
+        old_threads = param.GetInt("MeshReaderThreads", 0)
+        param.SetUnsigned("MeshReaderBlockSize", block_size)
+        param.SetInt("MeshReaderThreads", 4)
+        try:
+            test()
+        finally:
+            param.SetUnsigned("MeshReaderBlockSize", old_block_size)
+            param.SetInt("MeshReaderThreads", old_threads)
+
+    # ********************************************************************************************
+    def read_nastran(
+        self
+    ):
+        # GRID and CTETRA cards in free field, small field and large field format
+        bdf_file = testtools.get_fem_test_tmp_dir() + '/tetra10_mesh.bdf'
+        f = open(bdf_file, 'w')
+        f.write(
+            "$ tetra10 in several Nastran formats\n"
+            "BEGIN BULK\n"
+            "GRID,1,,6.0,12.0,18.0\n"
+            "GRID,2,,0.0,0.0,18.0\n"
+            "GRID    3               12.0    0.0     18.0\n"
+            "GRID    4               6.0     6.0     0.0\n"
+            "GRID*   5                               3.0             6.0             *G5\n"
+            "*G5     18.0\n"
+            "GRID*   6                               6.0             0.0             *G6\n"
+            "*G6     18.0\n"
+            "GRID,7,,9.0,6.0,1.8+1\n"
+            "GRID,8,,6.0,9.0,9.0\n"
+            "GRID,9,,3.0,3.0,9.0\n"
+            "GRID,10,,9.0,3.0,.9+1\n"
+            "$ elements\n"
+            "CTETRA  1       1       2       1       3       4       5       7       +E1\n"
+            "+E1     6       9       8       10\n"
+            "CTETRA,2,1,2,1,3,4,5,7,+E2\n"
+            "+E2,6,9,8,10\n"
+            "CTETRA,3,1,2,1,3,4\n"
+            "ENDDATA\n"
+        )
+        f.close()
+
+        femmesh = Fem.read(bdf_file)
+        self.assertEqual(femmesh.NodeCount, 10, "Nodes of Nastran file are unexpected")
+        self.assertEqual(femmesh.VolumeCount, 3, "Volumes of Nastran file are unexpected")
+        self.assertEqual(femmesh.Nodes[7], FreeCAD.Vector(9, 6, 18))
+        self.assertEqual(femmesh.Nodes[10], FreeCAD.Vector(9, 3, 9))
+        expected = (1, 2, 3, 4, 5, 6, 7, 8, 9, 10)
+        self.assertEqual(femmesh.getElementNodes(1), expected)
+        self.assertEqual(femmesh.getElementNodes(2), expected)
+        self.assertEqual(femmesh.getElementNodes(3), (1, 2, 3, 4))
+
+    # ********************************************************************************************
+    def test_inp_read_write_hexa8(
+        self
+    ):
+        self.inp_read_write_hexa8(30)
+
+    # ********************************************************************************************
+    def test_inp_read_write_hexa8_small_blocks(
+        self
+    ):
+        # node and element lines span several blocks read from the file
+        self.with_block_size(100, lambda: self.inp_read_write_hexa8(6))
+
+    # ********************************************************************************************
+    def inp_read_write_hexa8(
+        self,
+        n
+    ):
+        # structured hexa8 mesh read by the streaming reader and written back
+        def node_id(i, j, k):
+            return 1 + i + (n + 1) * (j + (n + 1) * k)
+
+        inp_file = testtools.get_fem_test_tmp_dir() + '/hexa8_structured.inp'
+        f = open(inp_file, 'w')
+        f.write("*Node, NSET=Nall\n")
+        for k in range(n + 1):
+            for j in range(n + 1):
+                for i in range(n + 1):
+                    f.write("{}, {}, {}, {}\n".format(node_id(i, j, k), 0.5 * i, 0.5 * j, 0.5 * k))
+        f.write("*Element, TYPE=C3D8, ELSET=Evolumes\n")
+        elem = 0
+        for k in range(n):
+            for j in range(n):
+                for i in range(n):
+                    elem += 1
+                    f.write("{}, {}, {}, {}, {}, {}, {}, {}, {}\n".format(
+                        elem,
+                        node_id(i, j, k), node_id(i + 1, j, k),
+                        node_id(i + 1, j + 1, k), node_id(i, j + 1, k),
+                        node_id(i, j, k + 1), node_id(i + 1, j, k + 1),
+                        node_id(i + 1, j + 1, k + 1), node_id(i, j + 1, k + 1)
+                    ))
+        f.close()
+
+        femmesh = Fem.read(inp_file)
+        self.assertEqual(femmesh.NodeCount, (n + 1) ** 3)
+        self.assertEqual(femmesh.VolumeCount, n ** 3)
+
+        out_file = testtools.get_fem_test_tmp_dir() + '/hexa8_structured_out.inp'
+        femmesh.writeABAQUS(out_file, 1, False)
+        newmesh = Fem.read(out_file)
+        self.assertEqual(newmesh.NodeCount, femmesh.NodeCount)
+        self.assertEqual(newmesh.VolumeCount, femmesh.VolumeCount)
+        self.assertEqual(newmesh.getElementNodes(n ** 3), femmesh.getElementNodes(n ** 3))
+
     # ********************************************************************************************
     def tearDown(
         self
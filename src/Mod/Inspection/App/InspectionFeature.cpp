@@ -27,21 +27,33 @@
 #include <BRepBuilderAPI_MakeVertex.hxx>
 #include <BRepClass3d_SolidClassifier.hxx>
 #include <BRepGProp_Face.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepExtrema_ExtPC.hxx>
+#include <BRepExtrema_ExtPF.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <Bnd_Box.hxx>
+#include <Poly_Triangulation.hxx>
+#include <TopExp.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopTools_IndexedDataMapOfShapeListOfShape.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
 #include <TopoDS.hxx>
+#include <TopoDS_Edge.hxx>
+#include <TopoDS_Face.hxx>
 #include <TopoDS_Vertex.hxx>
 
-#include <QEventLoop>
-#include <QFuture>
-#include <QFutureWatcher>
+#include <QMutex>
 #include <QtConcurrentMap>
 
-#include <boost/bind.hpp>
+#include <memory>
 
 #include <Base/Console.h>
 #include <Base/Exception.h>
-#include <Base/FutureWatcherProgress.h>
 #include <Base/Parameter.h>
 #include <Base/Sequencer.h>
+#include <Base/TimeInfo.h>
 #include <Base/Tools.h>
 #include <App/Application.h>
 #include <Mod/Mesh/App/Mesh.h>
@@ -50,6 +62,7 @@
 #include <Mod/Mesh/App/Core/Grid.h>
 #include <Mod/Mesh/App/Core/Iterator.h>
 #include <Mod/Mesh/App/Core/MeshKernel.h>
+#include <Mod/Points/App/PagedPoints.h>
 #include <Mod/Points/App/PointsFeature.h>
 #include <Mod/Points/App/PointsGrid.h>
 #include <Mod/Part/App/PartFeature.h>
@@ -76,8 +89,10 @@ unsigned long InspectActualMesh::countPoints() const
 
 Base::Vector3f InspectActualMesh::getPoint(unsigned long index)
 {
-    _iter.Set(index);
-    return *_iter;
+    // work on a copy to allow concurrent calls
+    MeshCore::MeshPointIterator iter(_iter);
+    iter.Set(index);
+    return *iter;
 }
 
 // ----------------------------------------------------------------
@@ -178,7 +193,7 @@ namespace Inspection {
             assert((rulX < _ulCtGridsX) && (rulY < _ulCtGridsY) && (rulZ < _ulCtGridsZ));
         }
 
-        void AddFacet (const MeshCore::MeshGeomFacet &rclFacet, unsigned long ulFacetIndex)
+        void GetFacetCells (const MeshCore::MeshGeomFacet &rclFacet, std::vector<unsigned long> &raulCells) const
         {
             unsigned long ulX, ulY, ulZ;
             unsigned long ulX1, ulY1, ulZ1, ulX2, ulY2, ulZ2;
@@ -197,19 +212,17 @@ namespace Inspection {
                     for (ulY = ulY1; ulY <= ulY2; ulY++) {
                         for (ulZ = ulZ1; ulZ <= ulZ2; ulZ++) {
                             if (rclFacet.IntersectBoundingBox(GetBoundBox(ulX, ulY, ulZ)))
-                                _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
+                                raulCells.push_back(CellIndex(ulX, ulY, ulZ));
                         }
                     }
                 }
             }
             else
-                _aulGrid[ulX1][ulY1][ulZ1].insert(ulFacetIndex);
+                raulCells.push_back(CellIndex(ulX1, ulY1, ulZ1));
         }
 
         void InitGrid (void)
         {
-            unsigned long i, j;
-
             Base::BoundBox3f clBBMesh = _pclMesh->GetBoundBox().Transformed(_transform);
 
             float fLengthX = clBBMesh.LengthX(); 
@@ -225,26 +238,22 @@ namespace Inspection {
             _fGridLenZ = (1.0f + fLengthZ) / float(_ulCtGridsZ);
             _fMinZ = clBBMesh.MinZ - 0.5f;
 
-            _aulGrid.clear();
-            _aulGrid.resize(_ulCtGridsX);
-            for (i = 0; i < _ulCtGridsX; i++) {
-                _aulGrid[i].resize(_ulCtGridsY);
-                for (j = 0; j < _ulCtGridsY; j++)
-                    _aulGrid[i][j].resize(_ulCtGridsZ);
-            }
+            _aulCellOffsets.assign(_ulCtGridsX * _ulCtGridsY * _ulCtGridsZ + 1, 0);
+            _aulCellElements.clear();
         }
 
         void RebuildGrid (void)
         {
             _ulCtElements = _pclMesh->CountFacets();
             InitGrid();
- 
-            unsigned long i = 0;
-            MeshCore::MeshFacetIterator clFIter(*_pclMesh);
-            clFIter.Transform(_transform);
-            for (clFIter.Init(); clFIter.More(); clFIter.Next()) {
-                AddFacet(*clFIter, i++);
-            }
+
+            const MeshCore::MeshKernel& kernel = *_pclMesh;
+            BuildGrid(_ulCtElements, [this, &kernel](unsigned long index, std::vector<unsigned long>& cells) {
+                MeshCore::MeshGeomFacet facet = kernel.GetFacet(index);
+                for (int i = 0; i < 3; i++)
+                    facet._aclPoints[i] = _transform * facet._aclPoints[i];
+                GetFacetCells(facet, cells);
+            });
         }
 
     private:
@@ -295,14 +304,16 @@ float InspectNominalMesh::getDistance(const Base::Vector3f& point)
         indices.insert(indices.begin(), inds.begin(), inds.end());
     }
 
+    // work on a copy to allow concurrent calls
+    MeshCore::MeshFacetIterator iter(_iter);
     float fMinDist=FLT_MAX;
     bool positive = true;
     for (std::vector<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
-        _iter.Set(*it);
-        float fDist = _iter->DistanceToPoint(point);
+        iter.Set(*it);
+        float fDist = iter->DistanceToPoint(point);
         if (fabs(fDist) < fabs(fMinDist)) {
             fMinDist = fDist;
-            positive = point.DistanceToPlane(_iter->_aclPoints[0], _iter->GetNormal()) > 0;
+            positive = point.DistanceToPlane(iter->_aclPoints[0], iter->GetNormal()) > 0;
         }
     }
 
@@ -368,14 +379,16 @@ float InspectNominalFastMesh::getDistance(const Base::Vector3f& point)
         _pGrid->GetHull(ulX, ulY, ulZ, ulLevel, indices);
 #endif
 
+    // work on a copy to allow concurrent calls
+    MeshCore::MeshFacetIterator iter(_iter);
     float fMinDist=FLT_MAX;
     bool positive = true;
     for (std::set<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
-        _iter.Set(*it);
-        float fDist = _iter->DistanceToPoint(point);
+        iter.Set(*it);
+        float fDist = iter->DistanceToPoint(point);
         if (fabs(fDist) < fabs(fMinDist)) {
             fMinDist = fDist;
-            positive = point.DistanceToPlane(_iter->_aclPoints[0], _iter->GetNormal()) > 0;
+            positive = point.DistanceToPlane(iter->_aclPoints[0], iter->GetNormal()) > 0;
         }
     }
 
@@ -421,7 +434,577 @@ float InspectNominalPoints::getDistance(const Base::Vector3f& point)
 
 // ----------------------------------------------------------------
 
-InspectNominalShape::InspectNominalShape(const TopoDS_Shape& shape, float /*radius*/)
+InspectNominalPagedPoints::InspectNominalPagedPoints(const Points::PagedPointKernel& Kernel, float offset)
+  : _rKernel(Kernel)
+  , _maxDist(offset > 0 ? offset : DBL_MAX)
+{
+}
+
+float InspectNominalPagedPoints::getDistance(const Base::Vector3f& point)
+{
+    unsigned long index;
+    double fDist;
+    if (!_rKernel.findNearest(Base::Vector3d(point.x,point.y,point.z), _maxDist, index, fDist))
+        return FLT_MAX;
+    return (float)fDist;
+}
+
+// ----------------------------------------------------------------
+
+namespace Inspection {
+
+/** Triangle bounding volume hierarchy of the tessellated shape to find the
+ * faces near to a point and per-thread projectors for the exact distance.
+ */
+class ShapeDistance
+{
+public:
+    ShapeDistance(const TopoDS_Shape& shape, float radius);
+    ~ShapeDistance();
+
+    float getDistance(const Base::Vector3f& point);
+
+private:
+    struct Triangle {
+        Base::Vector3d points[3];
+        int face;
+    };
+
+    struct Node {
+        Base::BoundBox3d box;
+        // children if count is 0, otherwise the range of triangles
+        int left, right;
+        int first, count;
+    };
+
+    /** The BRepExtrema classes modify their state with each computation, so
+     * each thread uses its own instances which are created on demand.
+     */
+    struct Projector {
+        std::vector<std::unique_ptr<BRepExtrema_ExtPF> > faces;
+        std::vector<std::unique_ptr<BRepExtrema_ExtPC> > edges;
+        std::unique_ptr<BRepClass3d_SolidClassifier> classifier;
+        std::vector<unsigned long> faceStamps;
+        std::vector<unsigned long> edgeStamps;
+        unsigned long stamp;
+        std::vector<int> stack;
+        std::vector<int> candidates;
+
+        Projector(std::size_t numFaces, std::size_t numEdges)
+            : faces(numFaces), edges(numEdges)
+            , faceStamps(numFaces, 0), edgeStamps(numEdges, 0), stamp(0)
+        {
+        }
+    };
+
+    int build(int first, int count);
+    double nearestTriangle(const Base::Vector3d& point, Projector& proj, int& face) const;
+    void collectFaces(const Base::Vector3d& point, double maxDist, Projector& proj) const;
+    Projector* acquireProjector();
+    void releaseProjector(Projector*);
+
+    static double distanceToTriangle(const Base::Vector3d& p, const Triangle& t);
+    static double distanceToBox(const Base::Vector3d& p, const Base::BoundBox3d& box);
+
+private:
+    TopoDS_Shape shape;
+    bool isSolid;
+    float radius;
+    double margin;
+    std::vector<TopoDS_Face> faces;
+    std::vector<TopoDS_Edge> edges;
+    std::vector<std::vector<int> > faceEdges;
+    std::vector<std::vector<gp_Pnt> > faceVertexes;
+    // faces without triangulation are always checked
+    std::vector<int> untriangulated;
+    // edges and vertexes not bounding a face, e.g. of a wire or a compound
+    std::vector<int> freeEdges;
+    std::vector<Base::BoundBox3d> freeEdgeBoxes;
+    std::vector<gp_Pnt> freeVertexes;
+    std::vector<Triangle> triangles;
+    std::vector<Node> nodes;
+
+    QMutex mutex;
+    std::vector<Projector*> projectors;
+    std::vector<Projector*> freeProjectors;
+};
+
+ShapeDistance::ShapeDistance(const TopoDS_Shape& s, float radius)
+    : shape(s)
+    , isSolid(false)
+    , radius(radius)
+    , margin(0.0)
+{
+    // When having a solid then use its shell because otherwise the distance
+    // for inner points will always be zero
+    TopoDS_Shape surface = shape;
+    if (!shape.IsNull() && shape.ShapeType() == TopAbs_SOLID) {
+        TopExp_Explorer xp;
+        xp.Init(shape, TopAbs_SHELL);
+        if (xp.More()) {
+            surface = xp.Current();
+            isSolid = true;
+        }
+    }
+    if (surface.IsNull())
+        return;
+
+    TopTools_IndexedMapOfShape faceMap, edgeMap;
+    TopExp::MapShapes(surface, TopAbs_FACE, faceMap);
+    TopExp::MapShapes(surface, TopAbs_EDGE, edgeMap);
+    TopTools_IndexedDataMapOfShapeListOfShape edgeFaces, vertexFaces;
+    TopExp::MapShapesAndAncestors(surface, TopAbs_EDGE, TopAbs_FACE, edgeFaces);
+    TopExp::MapShapesAndAncestors(surface, TopAbs_VERTEX, TopAbs_FACE, vertexFaces);
+    for (int i = 1; i <= edgeMap.Extent(); i++) {
+        const TopoDS_Edge& edge = TopoDS::Edge(edgeMap(i));
+        if (BRep_Tool::Degenerated(edge)) {
+            edges.push_back(TopoDS_Edge());
+            continue;
+        }
+
+        // edges without a face are always checked unless their bounding box is too far away
+        if (edgeFaces.FindFromKey(edge).IsEmpty()) {
+            Bnd_Box box;
+            BRepBndLib::Add(edge, box);
+            Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
+            box.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+            freeEdges.push_back(static_cast<int>(edges.size()));
+            freeEdgeBoxes.push_back(Base::BoundBox3d(xMin, yMin, zMin, xMax, yMax, zMax));
+        }
+        edges.push_back(edge);
+    }
+    for (int i = 1; i <= vertexFaces.Extent(); i++) {
+        if (vertexFaces(i).IsEmpty())
+            freeVertexes.push_back(BRep_Tool::Pnt(TopoDS::Vertex(vertexFaces.FindKey(i))));
+    }
+
+    // use the same accuracy as for the tessellation of an actual shape
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Part");
+    float deviation = hGrp->GetFloat("MeshDeviation",0.2);
+    Bnd_Box bounds;
+    BRepBndLib::Add(surface, bounds);
+    bounds.SetGap(0.0);
+    Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
+    bounds.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+    Standard_Real deflection = ((xMax-xMin) + (yMax-yMin) + (zMax-zMin))/300.0 * deviation;
+    if (faceMap.IsEmpty())
+        return;
+    BRepMesh_IncrementalMesh mesh(surface, deflection);
+    margin = deflection;
+
+    for (int i = 1; i <= faceMap.Extent(); i++) {
+        const TopoDS_Face& face = TopoDS::Face(faceMap(i));
+        int index = static_cast<int>(faces.size());
+        faces.push_back(face);
+
+        std::vector<int> edgeIndexes;
+        std::vector<gp_Pnt> vertexes;
+        for (TopExp_Explorer xp(face, TopAbs_EDGE); xp.More(); xp.Next()) {
+            int edgeIndex = edgeMap.FindIndex(xp.Current()) - 1;
+            if (edgeIndex >= 0 && !edges[edgeIndex].IsNull()
+                    && std::find(edgeIndexes.begin(), edgeIndexes.end(), edgeIndex) == edgeIndexes.end())
+                edgeIndexes.push_back(edgeIndex);
+        }
+        for (TopExp_Explorer xp(face, TopAbs_VERTEX); xp.More(); xp.Next())
+            vertexes.push_back(BRep_Tool::Pnt(TopoDS::Vertex(xp.Current())));
+        faceEdges.push_back(edgeIndexes);
+        faceVertexes.push_back(vertexes);
+
+        TopLoc_Location loc;
+        Handle(Poly_Triangulation) triangulation = BRep_Tool::Triangulation(face, loc);
+        if (triangulation.IsNull() || triangulation->NbTriangles() == 0) {
+            untriangulated.push_back(index);
+            continue;
+        }
+
+        // an existing triangulation may be coarser than the requested one
+        margin = std::max<double>(margin, triangulation->Deflection());
+        const TColgp_Array1OfPnt& points = triangulation->Nodes();
+        const Poly_Array1OfTriangle& facets = triangulation->Triangles();
+        for (int j = facets.Lower(); j <= facets.Upper(); j++) {
+            Standard_Integer n[3];
+            facets(j).Get(n[0], n[1], n[2]);
+            Triangle tria;
+            tria.face = index;
+            for (int k = 0; k < 3; k++) {
+                gp_Pnt p = points(n[k]).Transformed(loc.Transformation());
+                tria.points[k].Set(p.X(), p.Y(), p.Z());
+            }
+            triangles.push_back(tria);
+        }
+    }
+
+    if (!triangles.empty()) {
+        nodes.reserve(triangles.size());
+        build(0, static_cast<int>(triangles.size()));
+    }
+}
+
+ShapeDistance::~ShapeDistance()
+{
+    for (std::vector<Projector*>::iterator it = projectors.begin(); it != projectors.end(); ++it)
+        delete *it;
+}
+
+int ShapeDistance::build(int first, int count)
+{
+    int index = static_cast<int>(nodes.size());
+    nodes.push_back(Node());
+    Base::BoundBox3d box;
+    for (int i = first; i < first + count; i++) {
+        for (int k = 0; k < 3; k++)
+            box.Add(triangles[i].points[k]);
+    }
+    nodes[index].box = box;
+
+    const int maxLeafSize = 4;
+    if (count <= maxLeafSize) {
+        nodes[index].left = nodes[index].right = -1;
+        nodes[index].first = first;
+        nodes[index].count = count;
+        return index;
+    }
+
+    // split at the median of the triangle centers along the longest axis
+    int axis = 0;
+    if (box.LengthY() > box.LengthX())
+        axis = 1;
+    if (box.LengthZ() > std::max(box.LengthX(), box.LengthY()))
+        axis = 2;
+    auto center = [axis](const Triangle& t) {
+        return t.points[0][axis] + t.points[1][axis] + t.points[2][axis];
+    };
+    int half = count / 2;
+    std::nth_element(triangles.begin() + first, triangles.begin() + first + half,
+                     triangles.begin() + first + count,
+                     [&center](const Triangle& a, const Triangle& b) {
+        return center(a) < center(b);
+    });
+
+    int left = build(first, half);
+    int right = build(first + half, count - half);
+    nodes[index].left = left;
+    nodes[index].right = right;
+    nodes[index].first = 0;
+    nodes[index].count = 0;
+    return index;
+}
+
+double ShapeDistance::distanceToBox(const Base::Vector3d& p, const Base::BoundBox3d& box)
+{
+    double dx = std::max(std::max(box.MinX - p.x, p.x - box.MaxX), 0.0);
+    double dy = std::max(std::max(box.MinY - p.y, p.y - box.MaxY), 0.0);
+    double dz = std::max(std::max(box.MinZ - p.z, p.z - box.MaxZ), 0.0);
+    return sqrt(dx*dx + dy*dy + dz*dz);
+}
+
+double ShapeDistance::distanceToTriangle(const Base::Vector3d& p, const Triangle& t)
+{
+    // closest point on triangle, see Ericson: Real-Time Collision Detection
+    const Base::Vector3d& a = t.points[0];
+    const Base::Vector3d& b = t.points[1];
+    const Base::Vector3d& c = t.points[2];
+    Base::Vector3d ab = b - a, ac = c - a, ap = p - a;
+    double d1 = ab * ap, d2 = ac * ap;
+    if (d1 <= 0.0 && d2 <= 0.0)
+        return Base::Distance(p, a);
+
+    Base::Vector3d bp = p - b;
+    double d3 = ab * bp, d4 = ac * bp;
+    if (d3 >= 0.0 && d4 <= d3)
+        return Base::Distance(p, b);
+
+    double vc = d1*d4 - d3*d2;
+    if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0)
+        return Base::Distance(p, a + ab * (d1 / (d1 - d3)));
+
+    Base::Vector3d cp = p - c;
+    double d5 = ab * cp, d6 = ac * cp;
+    if (d6 >= 0.0 && d5 <= d6)
+        return Base::Distance(p, c);
+
+    double vb = d5*d2 - d1*d6;
+    if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0)
+        return Base::Distance(p, a + ac * (d2 / (d2 - d6)));
+
+    double va = d3*d6 - d5*d4;
+    if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0)
+        return Base::Distance(p, b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))));
+
+    double denom = va + vb + vc;
+    if (denom == 0.0) // degenerated triangle
+        return std::min(Base::Distance(p, a), std::min(Base::Distance(p, b), Base::Distance(p, c)));
+    double v = vb / denom;
+    double w = vc / denom;
+    return Base::Distance(p, a + ab * v + ac * w);
+}
+
+double ShapeDistance::nearestTriangle(const Base::Vector3d& point, Projector& proj, int& face) const
+{
+    double minDist = DBL_MAX;
+    face = -1;
+    if (nodes.empty())
+        return minDist;
+
+    std::vector<int>& stack = proj.stack;
+    stack.clear();
+    stack.push_back(0);
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        if (distanceToBox(point, node.box) >= minDist)
+            continue;
+        if (node.count > 0) {
+            for (int i = node.first; i < node.first + node.count; i++) {
+                double dist = distanceToTriangle(point, triangles[i]);
+                if (dist < minDist) {
+                    minDist = dist;
+                    face = triangles[i].face;
+                }
+            }
+        }
+        else {
+            // visit the nearer child first
+            double dl = distanceToBox(point, nodes[node.left].box);
+            double dr = distanceToBox(point, nodes[node.right].box);
+            if (dl < dr) {
+                stack.push_back(node.right);
+                stack.push_back(node.left);
+            }
+            else {
+                stack.push_back(node.left);
+                stack.push_back(node.right);
+            }
+        }
+    }
+    return minDist;
+}
+
+void ShapeDistance::collectFaces(const Base::Vector3d& point, double maxDist, Projector& proj) const
+{
+    proj.candidates.clear();
+    proj.stamp++;
+    for (std::vector<int>::const_iterator it = untriangulated.begin(); it != untriangulated.end(); ++it) {
+        proj.faceStamps[*it] = proj.stamp;
+        proj.candidates.push_back(*it);
+    }
+    if (nodes.empty())
+        return;
+
+    std::vector<int>& stack = proj.stack;
+    stack.clear();
+    stack.push_back(0);
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        if (distanceToBox(point, node.box) > maxDist)
+            continue;
+        if (node.count > 0) {
+            for (int i = node.first; i < node.first + node.count; i++) {
+                int face = triangles[i].face;
+                if (proj.faceStamps[face] != proj.stamp && distanceToTriangle(point, triangles[i]) <= maxDist) {
+                    proj.faceStamps[face] = proj.stamp;
+                    proj.candidates.push_back(face);
+                }
+            }
+        }
+        else {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+
+ShapeDistance::Projector* ShapeDistance::acquireProjector()
+{
+    QMutexLocker locker(&mutex);
+    if (freeProjectors.empty()) {
+        Projector* proj = new Projector(faces.size(), edges.size());
+        projectors.push_back(proj);
+        return proj;
+    }
+    Projector* proj = freeProjectors.back();
+    freeProjectors.pop_back();
+    return proj;
+}
+
+void ShapeDistance::releaseProjector(Projector* proj)
+{
+    QMutexLocker locker(&mutex);
+    freeProjectors.push_back(proj);
+}
+
+float ShapeDistance::getDistance(const Base::Vector3f& point)
+{
+    if (faces.empty() && freeEdges.empty() && freeVertexes.empty())
+        return FLT_MAX;
+
+    Projector* proj = acquireProjector();
+    Base::Vector3d pnt(point.x, point.y, point.z);
+    gp_Pnt pnt3d(point.x, point.y, point.z);
+    TopoDS_Vertex vertex;
+    BRep_Builder builder;
+    builder.MakeVertex(vertex, pnt3d, Precision::Confusion());
+
+    int nearestFace;
+    double triaDist = nearestTriangle(pnt, *proj, nearestFace);
+
+    double minDist = triaDist;
+    int minFace = -1;
+    Standard_Real minU = 0, minV = 0;
+
+    // Points which are farther away than the search radius are not refined
+    // because their distance is clamped anyway. Otherwise the exact distance
+    // is computed for all faces which may contain the nearest point.
+    if (untriangulated.size() > 0 || triaDist - margin <= radius) {
+        collectFaces(pnt, triaDist + 2 * margin, *proj);
+
+        double minSqDist = DBL_MAX;
+        for (std::vector<int>::iterator it = proj->candidates.begin(); it != proj->candidates.end(); ++it) {
+            int index = *it;
+            std::unique_ptr<BRepExtrema_ExtPF>& ext = proj->faces[index];
+            if (!ext) {
+                ext.reset(new BRepExtrema_ExtPF());
+                ext->Initialize(faces[index], Extrema_ExtFlag_MIN);
+            }
+            ext->Perform(vertex, faces[index]);
+            if (ext->IsDone()) {
+                for (int i = 1; i <= ext->NbExt(); i++) {
+                    if (ext->SquareDistance(i) < minSqDist) {
+                        minSqDist = ext->SquareDistance(i);
+                        minFace = index;
+                        ext->Parameter(i, minU, minV);
+                    }
+                }
+            }
+
+            // the nearest point may be on the boundary of the face
+            const std::vector<int>& edgeIndexes = faceEdges[index];
+            for (std::vector<int>::const_iterator jt = edgeIndexes.begin(); jt != edgeIndexes.end(); ++jt) {
+                if (proj->edgeStamps[*jt] == proj->stamp)
+                    continue;
+                proj->edgeStamps[*jt] = proj->stamp;
+                std::unique_ptr<BRepExtrema_ExtPC>& extc = proj->edges[*jt];
+                if (!extc) {
+                    extc.reset(new BRepExtrema_ExtPC());
+                    extc->Initialize(edges[*jt]);
+                }
+                extc->Perform(vertex);
+                if (extc->IsDone()) {
+                    for (int i = 1; i <= extc->NbExt(); i++) {
+                        if (extc->IsMin(i) && extc->SquareDistance(i) < minSqDist) {
+                            minSqDist = extc->SquareDistance(i);
+                            minFace = -1;
+                        }
+                    }
+                }
+            }
+
+            const std::vector<gp_Pnt>& vertexes = faceVertexes[index];
+            for (std::vector<gp_Pnt>::const_iterator jt = vertexes.begin(); jt != vertexes.end(); ++jt) {
+                double sqDist = jt->SquareDistance(pnt3d);
+                if (sqDist < minSqDist) {
+                    minSqDist = sqDist;
+                    minFace = -1;
+                }
+            }
+        }
+
+        if (minSqDist < DBL_MAX)
+            minDist = sqrt(minSqDist);
+    }
+
+    // edges and vertexes without a face may be nearer than the faces
+    if (!freeEdges.empty() || !freeVertexes.empty()) {
+        double minSqDist = minDist < DBL_MAX ? minDist * minDist : DBL_MAX;
+        bool nearer = false;
+        for (std::vector<gp_Pnt>::const_iterator it = freeVertexes.begin(); it != freeVertexes.end(); ++it) {
+            double sqDist = it->SquareDistance(pnt3d);
+            if (sqDist < minSqDist) {
+                minSqDist = sqDist;
+                nearer = true;
+            }
+        }
+        for (std::size_t i = 0; i < freeEdges.size(); i++) {
+            double boxDist = distanceToBox(pnt, freeEdgeBoxes[i]);
+            if (boxDist * boxDist >= minSqDist)
+                continue;
+            int index = freeEdges[i];
+            std::unique_ptr<BRepExtrema_ExtPC>& extc = proj->edges[index];
+            if (!extc) {
+                extc.reset(new BRepExtrema_ExtPC());
+                extc->Initialize(edges[index]);
+            }
+            extc->Perform(vertex);
+            if (extc->IsDone()) {
+                for (int j = 1; j <= extc->NbExt(); j++) {
+                    if (extc->IsMin(j) && extc->SquareDistance(j) < minSqDist) {
+                        minSqDist = extc->SquareDistance(j);
+                        nearer = true;
+                    }
+                }
+            }
+        }
+
+        if (nearer) {
+            minDist = sqrt(minSqDist);
+            minFace = -1;
+        }
+    }
+
+    float fMinDist = minDist < DBL_MAX ? (float)minDist : FLT_MAX;
+    if (fMinDist < FLT_MAX) {
+        // the shape is a solid, check if the vertex is inside
+        if (isSolid) {
+            if (!proj->classifier) {
+                proj->classifier.reset(new BRepClass3d_SolidClassifier());
+                proj->classifier->Load(shape);
+            }
+            const Standard_Real tol = 0.001;
+            proj->classifier->Perform(pnt3d, tol);
+            if (proj->classifier->State() == TopAbs_IN) {
+                fMinDist = -fMinDist;
+            }
+        }
+        else if (fMinDist > 0 && minFace >= 0) {
+            // the distance was computed from a face
+            BRepGProp_Face props(faces[minFace]);
+            gp_Vec normal;
+            gp_Pnt center;
+            props.Normal(minU, minV, center, normal);
+            gp_Vec dir(center, pnt3d);
+            Standard_Real scalar = normal.Dot(dir);
+            if (scalar < 0) {
+                fMinDist = -fMinDist;
+            }
+        }
+    }
+
+    releaseProjector(proj);
+    return fMinDist;
+}
+
+} // namespace Inspection
+
+InspectNominalShape::InspectNominalShape(const TopoDS_Shape& shape, float radius)
+    : _pDistance(new ShapeDistance(shape, radius))
+{
+}
+
+InspectNominalShape::~InspectNominalShape()
+{
+    delete _pDistance;
+}
+
+float InspectNominalShape::getDistance(const Base::Vector3f& point)
+{
+    return _pDistance->getDistance(point);
+}
+
+// ----------------------------------------------------------------
+
+InspectNominalShapeLegacy::InspectNominalShapeLegacy(const TopoDS_Shape& shape, float /*radius*/)
     : _rShape(shape)
     , isSolid(false)
 {
@@ -442,12 +1025,12 @@ InspectNominalShape::InspectNominalShape(const TopoDS_Shape& shape, float /*radi
     //distss->SetDeflection(radius);
 }
 
-InspectNominalShape::~InspectNominalShape()
+InspectNominalShapeLegacy::~InspectNominalShapeLegacy()
 {
     delete distss;
 }
 
-float InspectNominalShape::getDistance(const Base::Vector3f& point)
+float InspectNominalShapeLegacy::getDistance(const Base::Vector3f& point)
 {
     gp_Pnt pnt3d(point.x,point.y,point.z);
     BRepBuilderAPI_MakeVertex mkVert(pnt3d);
@@ -581,6 +1164,11 @@ App::DocumentObjectExecReturn* Feature::execute(void)
         throw Base::TypeError("Unknown geometric type");
     }
 
+    // the former distance computation for shapes can be selected for comparison
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Inspection/Inspection");
+    bool useLegacy = hGrp->GetBool("UseLegacyShapeDistance", false);
+
     // get a list of nominals
     std::vector<InspectNominalGeometry*> inspectNominal;
     const std::vector<App::DocumentObject*>& nominals = Nominals.getValues();
@@ -594,61 +1182,63 @@ App::DocumentObjectExecReturn* Feature::execute(void)
             Points::Feature* pts = static_cast<Points::Feature*>(*it);
             nominal = new InspectNominalPoints(pts->Points.getValue(), this->SearchRadius.getValue());
         }
+        else if ((*it)->getTypeId().isDerivedFrom(Points::PagedFeature::getClassTypeId())) {
+            Points::PagedFeature* pts = static_cast<Points::PagedFeature*>(*it);
+            nominal = new InspectNominalPagedPoints(pts->Points.getValue(), this->SearchRadius.getValue());
+        }
         else if ((*it)->getTypeId().isDerivedFrom(Part::Feature::getClassTypeId())) {
             Part::Feature* part = static_cast<Part::Feature*>(*it);
-            nominal = new InspectNominalShape(part->Shape.getValue(), this->SearchRadius.getValue());
+            if (useLegacy)
+                nominal = new InspectNominalShapeLegacy(part->Shape.getValue(), this->SearchRadius.getValue());
+            else
+                nominal = new InspectNominalShape(part->Shape.getValue(), this->SearchRadius.getValue());
         }
 
         if (nominal)
             inspectNominal.push_back(nominal);
     }
 
-#if 0 // test with some huge data sets
-    Standard::SetReentrant(Standard_True);
-    std::vector<unsigned long> index(actual->countPoints());
-    std::generate(index.begin(), index.end(), Base::iotaGen<unsigned long>(0));
-    DistanceInspection check(this->SearchRadius.getValue(), actual, inspectNominal);
-    QFuture<float> future = QtConcurrent::mapped
-        (index, boost::bind(&DistanceInspection::mapped, &check, _1));
-    //future.waitForFinished(); // blocks the GUI
-    Base::FutureWatcherProgress progress("Inspecting...", actual->countPoints());
-    QFutureWatcher<float> watcher;
-    QObject::connect(&watcher, SIGNAL(progressValueChanged(int)),
-                     &progress, SLOT(progressValueChanged(int)));
-    watcher.setFuture(future);
-
-    // keep it responsive during computation
-    QEventLoop loop;
-    QObject::connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
-    loop.exec();
-
-    std::vector<float> vals;
-    vals.insert(vals.end(), future.begin(), future.end());
-#else
+    // The nominal shapes are computed in parallel unless the former
+    // implementation is requested which is not thread-safe
     unsigned long count = actual->countPoints();
     std::stringstream str;
     str << "Inspecting " << this->Label.getValue() << "...";
-    Base::SequencerLauncher seq(str.str().c_str(), count);
 
+    Base::TimeInfo start;
     std::vector<float> vals(count);
-    for (unsigned long index = 0; index < count; index++) {
-        Base::Vector3f pnt = actual->getPoint(index);
-
-        float fMinDist=FLT_MAX;
-        for (std::vector<InspectNominalGeometry*>::iterator it = inspectNominal.begin(); it != inspectNominal.end(); ++it) {
-            float fDist = (*it)->getDistance(pnt);
-            if (fabs(fDist) < fabs(fMinDist))
-                fMinDist = fDist;
+    DistanceInspection check(this->SearchRadius.getValue(), actual, inspectNominal);
+    if (useLegacy) {
+        Base::SequencerLauncher seq(str.str().c_str(), count);
+        for (unsigned long index = 0; index < count; index++) {
+            vals[index] = check.mapped(index);
+            seq.next();
         }
-
-        if (fMinDist > this->SearchRadius.getValue())
-            fMinDist = FLT_MAX;
-        else if (-fMinDist > this->SearchRadius.getValue())
-            fMinDist = -FLT_MAX;
-        vals[index] = fMinDist;
-        seq.next();
     }
-#endif
+    else {
+        // handle the points block-wise to keep the progress indicator alive
+        const unsigned long blockSize = 10000;
+        unsigned long numBlocks = (count + blockSize - 1) / blockSize;
+        Base::SequencerLauncher seq(str.str().c_str(), numBlocks);
+
+        std::vector<unsigned long> index;
+        index.reserve(blockSize);
+        for (unsigned long block = 0; block < numBlocks; block++) {
+            unsigned long first = block * blockSize;
+            unsigned long last = std::min<unsigned long>(first + blockSize, count);
+            index.clear();
+            for (unsigned long i = first; i < last; i++)
+                index.push_back(i);
+
+            QtConcurrent::blockingMap(index, [&check, &vals](unsigned long i) {
+                vals[i] = check.mapped(i);
+            });
+            seq.next();
+        }
+    }
+
+    float seconds = Base::TimeInfo::diffTimeF(start, Base::TimeInfo());
+    Base::Console().Log("Inspection of %lu points took %.3f s (%.0f points/s)\n",
+        count, seconds, seconds > 0 ? count / seconds : 0.0);
 
     Distances.setValues(vals);
 
@@ -41,12 +41,14 @@ class MeshGrid;
 }
 
 namespace Mesh   { class MeshObject; }
-namespace Points { class PointsGrid; }
+namespace Points { class PointsGrid; class PagedPointKernel; }
 namespace Part   { class TopoShape;  }
 
 namespace Inspection
 {
 
+class ShapeDistance;
+
 /** Delivers the number of points to be checked and returns the appropriate point to an index. */
 class InspectionExport InspectActualGeometry
 {
@@ -94,7 +96,9 @@ private:
     std::vector<Base::Vector3d> points;
 };
 
-/** Calculates the shortest distance of the underlying geometry to a given point. */
+/** Calculates the shortest distance of the underlying geometry to a given point.
+ * getDistance() may be called from several threads at the same time.
+ */
 class InspectionExport InspectNominalGeometry
 {
 public:
@@ -142,6 +146,24 @@ private:
     Points::PointsGrid* _pGrid;
 };
 
+/** Uses the octree of a paged point cloud instead of a PointsGrid, so only
+ * the leaves within the search radius are loaded.
+ */
+class InspectionExport InspectNominalPagedPoints : public InspectNominalGeometry
+{
+public:
+    InspectNominalPagedPoints(const Points::PagedPointKernel&, float offset);
+    virtual float getDistance(const Base::Vector3f&);
+
+private:
+    const Points::PagedPointKernel& _rKernel;
+    double _maxDist;
+};
+
+/** Computes the distance to a shape. The shape is tessellated once and the
+ * triangles are kept in a bounding volume hierarchy which gives the faces near
+ * to a point. Only these faces are used for the exact distance computation.
+ */
 class InspectionExport InspectNominalShape : public InspectNominalGeometry
 {
 public:
@@ -149,6 +171,21 @@ public:
     ~InspectNominalShape();
     virtual float getDistance(const Base::Vector3f&);
 
+private:
+    ShapeDistance* _pDistance;
+};
+
+/** The former implementation which computes the distance with
+ * BRepExtrema_DistShapeShape for each point. It is not thread-safe and only
+ * kept for comparison.
+ */
+class InspectionExport InspectNominalShapeLegacy : public InspectNominalGeometry
+{
+public:
+    InspectNominalShapeLegacy(const TopoDS_Shape&, float offset);
+    ~InspectNominalShapeLegacy();
+    virtual float getDistance(const Base::Vector3f&);
+
 private:
     BRepExtrema_DistShapeShape* distss;
     const TopoDS_Shape& _rShape;
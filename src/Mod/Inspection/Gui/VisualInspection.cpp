@@ -116,6 +116,7 @@ VisualInspection::VisualInspection(QWidget* parent, Qt::WindowFlags fl)
     Base::Type point = Base::Type::fromName("Points::Feature");
     Base::Type mesh  = Base::Type::fromName("Mesh::Feature");
     Base::Type shape = Base::Type::fromName("Part::Feature");
+    Base::Type paged = Base::Type::fromName("Points::PagedFeature");
     for (std::vector<App::DocumentObject*>::iterator it = obj.begin(); it != obj.end(); ++it) {
         if ((*it)->getTypeId().isDerivedFrom(point) ||
             (*it)->getTypeId().isDerivedFrom(mesh)  ||
@@ -137,6 +138,15 @@ VisualInspection::VisualInspection(QWidget* parent, Qt::WindowFlags fl)
             item1->setCompetitiveItem(item2);
             item2->setCompetitiveItem(item1);
         }
+        else if ((*it)->getTypeId().isDerivedFrom(paged)) {
+            // paged point clouds are too big to be shown as actual geometry
+            Gui::ViewProvider* view = gui->getViewProvider(*it);
+            SingleSelectionItem* item = new SingleSelectionItem(ui->treeWidgetNominal);
+            item->setText(0, QString::fromUtf8((*it)->Label.getValue()));
+            item->setData(0, Qt::UserRole, QString::fromLatin1((*it)->getNameInDocument()));
+            item->setCheckState(0, Qt::Unchecked);
+            item->setIcon(0, view->getIcon());
+        }
     }
 
     loadSettings();
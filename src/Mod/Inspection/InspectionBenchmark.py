@@ -0,0 +1,94 @@
+#***************************************************************************
+#*   This file is part of the FreeCAD CAx development system.              *
+#*                                                                         *
+#*   This program is free software; you can redistribute it and/or modify  *
+#*   it under the terms of the GNU Lesser General Public License (LGPL)    *
+#*   as published by the Free Software Foundation; either version 2 of     *
+#*   the License, or (at your option) any later version.                   *
+#*   for detail see the LICENCE text file.                                 *
+#*                                                                         *
+#*   FreeCAD is distributed in the hope that it will be useful,            *
+#*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+#*   GNU Library General Public License for more details.                  *
+#*                                                                         *
+#*   You should have received a copy of the GNU Library General Public     *
+#*   License along with FreeCAD; if not, write to the Free Software        *
+#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+#*   USA                                                                   *
+#*                                                                         *
+#***************************************************************************/
+
+# Benchmarks of the distance computation to a shape against the former
+# implementation. They are not part of the unit tests, run them explicitly with
+#   FreeCAD -t InspectionBenchmark
+
+import FreeCAD, unittest
+import time, math
+
+
+class ShapeDistanceBenchmarkCases(unittest.TestCase):
+    # the number of cylinders along each axis of the grid and inspected points
+    Grids = [2, 5, 10]
+    Count = 5000
+
+    def setUp(self):
+        import Part, Points, Inspection
+        self.param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Inspection/Inspection")
+        self.legacy = self.param.GetBool("UseLegacyShapeDistance", False)
+        self.doc = FreeCAD.newDocument("InspectionBenchmark")
+
+    def tearDown(self):
+        self.param.SetBool("UseLegacyShapeDistance", self.legacy)
+        FreeCAD.closeDocument(self.doc.Name)
+
+    def makeShape(self, n):
+        # a compound of n*n cylinders on a plate
+        import Part
+        shapes = [Part.makeBox(20.0 * n, 20.0 * n, 2.0, FreeCAD.Vector(0, 0, -2))]
+        for i in range(n):
+            for j in range(n):
+                shapes.append(Part.makeCylinder(5.0, 10.0, FreeCAD.Vector(20.0 * i + 10, 20.0 * j + 10, 0)))
+        return Part.makeCompound(shapes)
+
+    def makePoints(self, n):
+        # points on a sine wave surface above the compound
+        points = []
+        side = int(math.sqrt(self.Count))
+        size = 20.0 * n
+        for i in range(side):
+            for j in range(side):
+                x = size * (i + 0.5) / side
+                y = size * (j + 0.5) / side
+                points.append(FreeCAD.Vector(x, y, 6.0 + 5.0 * math.sin(x) * math.cos(y)))
+        return points
+
+    def inspect(self, legacy):
+        self.param.SetBool("UseLegacyShapeDistance", legacy)
+        self.inspection.touch()
+        start = time.time()
+        self.doc.recompute()
+        return time.time() - start
+
+    def testShapeDistance(self):
+        import Points
+        for n in self.Grids:
+            shape = self.makeShape(n)
+            points = self.makePoints(n)
+            nominal = self.doc.addObject("Part::Feature", "Nominal")
+            nominal.Shape = shape
+            actual = self.doc.addObject("Points::Feature", "Actual")
+            actual.Points = Points.Points(points)
+            self.inspection = self.doc.addObject("Inspection::Feature", "Inspect")
+            self.inspection.Actual = actual
+            self.inspection.Nominals = [nominal]
+            self.inspection.SearchRadius = 10.0
+
+            t1 = self.inspect(True)
+            t2 = self.inspect(False)
+            count = len(points)
+            FreeCAD.Console.PrintMessage("%4d faces, %6d points: legacy %8.0f points/s, new %8.0f points/s, speed-up %.2f\n"
+                    % (len(shape.Faces), count, count / max(t1, 1e-6), count / max(t2, 1e-6), t1 / max(t2, 1e-6)))
+
+            for obj in [self.inspection, actual, nominal]:
+                self.doc.removeObject(obj.Name)
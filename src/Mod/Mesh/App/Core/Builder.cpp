@@ -320,13 +320,36 @@ void MeshFastBuilder::AddFacet (const MeshGeomFacet& facetPoints)
     }
 }
 
+void MeshFastBuilder::AddFacets (unsigned long ctFacets,
+                                 const std::function<void(unsigned long, Base::Vector3f*)>& getFacet)
+{
+    int offset = p->verts.size();
+    p->verts.resize(offset + 3 * ctFacets);
+    Private::Vertex* verts = p->verts.data() + offset;
+
+    MeshCore::parallel_blocks(ctFacets, 0x10000, [verts, &getFacet](std::size_t begin, std::size_t end) {
+        Base::Vector3f facetPoints[3];
+        for (std::size_t i=begin; i < end; ++i) {
+            getFacet(i, facetPoints);
+            for (int j=0; j<3; j++) {
+                Private::Vertex& v = verts[3*i + j];
+                v.x = facetPoints[j].x;
+                v.y = facetPoints[j].y;
+                v.z = facetPoints[j].z;
+            }
+        }
+    });
+}
+
 void MeshFastBuilder::Finish ()
 {
     QVector<Private::Vertex>& verts = p->verts;
     size_t ulCtPts = verts.size();
-    for (size_t i=0; i < ulCtPts; ++i) {
-        verts[i].i = i;
-    }
+    Private::Vertex* data = verts.data();
+    MeshCore::parallel_blocks(ulCtPts, 0x40000, [data](std::size_t begin, std::size_t end) {
+        for (size_t i=begin; i < end; ++i)
+            data[i].i = i;
+    });
 
     //std::sort(verts.begin(), verts.end());
     int threads = std::max(1, QThread::idealThreadCount());
@@ -344,19 +367,23 @@ void MeshFastBuilder::Finish ()
 
     size_t ulCt = verts.size()/3;
     MeshFacetArray rFacets(ulCt);
-    for (size_t i=0; i < ulCt; ++i) {
-        rFacets[i]._aulPoints[0] = indices[3*i];
-        rFacets[i]._aulPoints[1] = indices[3*i + 1];
-        rFacets[i]._aulPoints[2] = indices[3*i + 2];
-    }
+    const unsigned long* index = indices.constData();
+    MeshCore::parallel_blocks(ulCt, 0x10000, [&rFacets, index](std::size_t begin, std::size_t end) {
+        for (size_t i=begin; i < end; ++i) {
+            rFacets[i]._aulPoints[0] = index[3*i];
+            rFacets[i]._aulPoints[1] = index[3*i + 1];
+            rFacets[i]._aulPoints[2] = index[3*i + 2];
+        }
+    });
 
     verts.resize(vertex_count);
 
-    MeshPointArray rPoints;
-    rPoints.reserve(vertex_count);
-    for (QVector<Private::Vertex>::iterator v = verts.begin(); v != verts.end(); ++v) {
-        rPoints.push_back(MeshPoint(v->x, v->y, v->z));
-    }
+    MeshPointArray rPoints(vertex_count);
+    const Private::Vertex* unique = verts.constData();
+    MeshCore::parallel_blocks(vertex_count, 0x10000, [&rPoints, unique](std::size_t begin, std::size_t end) {
+        for (size_t i=begin; i < end; ++i)
+            rPoints[i].Set(unique[i].x, unique[i].y, unique[i].z);
+    });
 
     _meshKernel.Adopt(rPoints, rFacets, true);
 }
@@ -23,6 +23,7 @@
 #ifndef MESH_BUILDER_H
 #define MESH_BUILDER_H
 
+#include <functional>
 #include <set>
 #include <vector>
 
@@ -200,6 +201,13 @@ public:
     /** Add new facet
      */
     void AddFacet (const MeshGeomFacet& facetPoints);
+    /** Add new facets using multiple threads
+     * @param ctFacets count of facets to add.
+     * @param getFacet function to get the three points of the facet with the
+     * given index in [0, ctFacets). It is called concurrently.
+     */
+    void AddFacets (unsigned long ctFacets,
+                    const std::function<void(unsigned long, Base::Vector3f*)>& getFacet);
 
     /** Finishes building up the mesh structure. Must be done after adding facets.
      */
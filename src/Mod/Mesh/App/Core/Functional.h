@@ -25,6 +25,9 @@
 #define MESH_FUNCTIONAL_H
 
 #include <algorithm>
+#include <utility>
+#include <vector>
+#include <QtConcurrentMap>
 #include <QtConcurrentRun>
 #include <QFuture>
 #include <QThread>
@@ -58,6 +61,28 @@ namespace MeshCore
         }
     }
 
+    /** Process the index range [0, count) in blocks of the given size using
+     * multiple threads. The function is called with the begin and end index
+     * of each block.
+     */
+    template <class Func>
+    static void parallel_blocks(std::size_t count, std::size_t blockSize, Func func)
+    {
+        if (count <= blockSize)
+        {
+            func(std::size_t(0), count);
+            return;
+        }
+
+        std::vector<std::pair<std::size_t, std::size_t> > blocks;
+        blocks.reserve(count / blockSize + 1);
+        for (std::size_t i = 0; i < count; i += blockSize)
+            blocks.push_back(std::make_pair(i, std::min(count, i + blockSize)));
+        QtConcurrent::blockingMap(blocks, [&func](std::pair<std::size_t, std::size_t>& block) {
+            func(block.first, block.second);
+        });
+    }
+
 } // namespace MeshCore
 
 
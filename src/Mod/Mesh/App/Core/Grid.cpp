@@ -25,15 +25,20 @@
 
 #ifndef _PreComp_
 # include <algorithm>
+# include <atomic>
 #endif
 
 #include "Grid.h"
 #include "Iterator.h"
+#include "Functional.h"
 
 #include "MeshKernel.h"
 #include "Algorithm.h"
 #include "Tools.h"
 
+#include <Base/Console.h>
+#include <Base/TimeInfo.h>
+
 using namespace MeshCore;
 
 MeshGrid::MeshGrid (const MeshKernel &rclM)
@@ -62,7 +67,8 @@ void MeshGrid::Attach (const MeshKernel &rclM)
 
 void MeshGrid::Clear (void)
 {
-  _aulGrid.clear();
+  _aulCellOffsets.clear();
+  _aulCellElements.clear();
   _pclMesh = NULL;  
 }
 
@@ -93,8 +99,6 @@ void MeshGrid::InitGrid (void)
 {
   assert(_pclMesh != NULL);
 
-  unsigned long i, j;
-
   // Grid Laengen berechnen wenn nicht initialisiert
   //
   if ((_ulCtGridsX == 0) || (_ulCtGridsY == 0) || (_ulCtGridsZ == 0))
@@ -128,14 +132,70 @@ void MeshGrid::InitGrid (void)
   }
 
   // Daten-Struktur anlegen
-  _aulGrid.clear();
-  _aulGrid.resize(_ulCtGridsX);
-  for (i = 0; i < _ulCtGridsX; i++)
-  {
-    _aulGrid[i].resize(_ulCtGridsY);
-    for (j = 0; j < _ulCtGridsY; j++)
-      _aulGrid[i][j].resize(_ulCtGridsZ);
-  }
+  _aulCellOffsets.assign(_ulCtGridsX * _ulCtGridsY * _ulCtGridsZ + 1, 0);
+  _aulCellElements.clear();
+}
+
+void MeshGrid::BuildGrid (unsigned long ulCtElements,
+                          const std::function<void (unsigned long, std::vector<unsigned long>&)>& getCells)
+{
+  typedef std::pair<unsigned long, unsigned long> CellEntry; // (grid element, element index)
+  const std::size_t blockSize = 4096;
+  const std::size_t ctBlocks = (ulCtElements + blockSize - 1) / blockSize;
+  const std::size_t ctCells = _aulCellOffsets.size() - 1;
+
+  _aulCellElements.clear();
+  std::fill(_aulCellOffsets.begin(), _aulCellOffsets.end(), 0);
+  if (ctBlocks == 0)
+    return;
+
+  Base::TimeInfo start;
+
+  // counting pass: collect the grid elements of each element block-wise and count the entries per grid element
+  std::vector<std::vector<CellEntry> > blockEntries(ctBlocks);
+  std::vector<std::atomic<unsigned long> > counts(ctCells);
+  parallel_blocks(ulCtElements, blockSize, [&](std::size_t begin, std::size_t end) {
+    std::vector<CellEntry>& entries = blockEntries[begin / blockSize];
+    std::vector<unsigned long> cells;
+    for (std::size_t i = begin; i < end; i++)
+    {
+      cells.clear();
+      getCells((unsigned long)i, cells);
+      std::sort(cells.begin(), cells.end());
+      cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+      for (std::vector<unsigned long>::iterator it = cells.begin(); it != cells.end(); ++it)
+      {
+        entries.push_back(std::make_pair(*it, (unsigned long)i));
+        counts[*it].fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  });
+
+  for (std::size_t i = 0; i < ctCells; i++)
+    _aulCellOffsets[i + 1] = _aulCellOffsets[i] + counts[i].load(std::memory_order_relaxed);
+  _aulCellElements.resize(_aulCellOffsets.back());
+
+  // fill pass: the counters are reused as insert positions
+  for (std::size_t i = 0; i < ctCells; i++)
+    counts[i].store(_aulCellOffsets[i], std::memory_order_relaxed);
+  parallel_blocks(ctBlocks, 1, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; i++)
+    {
+      const std::vector<CellEntry>& entries = blockEntries[i];
+      for (std::vector<CellEntry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+        _aulCellElements[counts[it->first].fetch_add(1, std::memory_order_relaxed)] = it->second;
+    }
+  });
+
+  // blocks are filled in arbitrary order, keep the indices of a grid element sorted
+  parallel_blocks(ctCells, 1024, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; i++)
+      std::sort(_aulCellElements.begin() + _aulCellOffsets[i], _aulCellElements.begin() + _aulCellOffsets[i + 1]);
+  });
+
+  float seconds = Base::TimeInfo::diffTimeF(start, Base::TimeInfo());
+  Base::Console().Log("Built grid of %lu cells with %lu elements in %.3f s (%.0f elements/s)\n",
+    (unsigned long)ctCells, ulCtElements, seconds, seconds > 0 ? ulCtElements / seconds : 0.0);
 }
 
 unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::vector<unsigned long> &raulElements,
@@ -155,7 +215,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::vector<unsig
     {
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
-        raulElements.insert(raulElements.end(), _aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+        raulElements.insert(raulElements.end(), CellBegin(i, j, k), CellEnd(i, j, k));
       }
     }
   }  
@@ -190,7 +250,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::vector<unsig
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
         if (Base::DistanceP2(GetBoundBox(i, j, k).GetCenter(), rclOrg) < fMinDistP2)
-          raulElements.insert(raulElements.end(), _aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+          raulElements.insert(raulElements.end(), CellBegin(i, j, k), CellEnd(i, j, k));
       }
     }
   }  
@@ -221,7 +281,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::set<unsigned
     {
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
-        raulElements.insert(_aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+        raulElements.insert(CellBegin(i, j, k), CellEnd(i, j, k));
       }
     }
   }  
@@ -478,7 +538,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsY; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[nX][i][j].begin(), _aulGrid[nX][i][j].end());
+              raclInd.insert(CellBegin(nX, i, j), CellEnd(nX, i, j));
           }
           nX++;
         }
@@ -492,7 +552,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsY; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[nX][i][j].begin(), _aulGrid[nX][i][j].end());
+              raclInd.insert(CellBegin(nX, i, j), CellEnd(nX, i, j));
           }
           nX++;
         }
@@ -506,7 +566,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[i][nY][j].begin(), _aulGrid[i][nY][j].end());
+              raclInd.insert(CellBegin(i, nY, j), CellEnd(i, nY, j));
           }
           nY++;
         }
@@ -520,7 +580,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[i][nY][j].begin(), _aulGrid[i][nY][j].end());
+              raclInd.insert(CellBegin(i, nY, j), CellEnd(i, nY, j));
           }
           nY--;
         }
@@ -534,7 +594,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsY; j++)
-              raclInd.insert(_aulGrid[i][j][nZ].begin(), _aulGrid[i][j][nZ].end());
+              raclInd.insert(CellBegin(i, j, nZ), CellEnd(i, j, nZ));
           }
           nZ++;
         }
@@ -548,7 +608,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsY; j++)
-              raclInd.insert(_aulGrid[i][j][nZ].begin(), _aulGrid[i][j][nZ].end());
+              raclInd.insert(CellBegin(i, j, nZ), CellEnd(i, j, nZ));
           }
           nZ--;
         }
@@ -614,11 +674,12 @@ void MeshGrid::GetHull (unsigned long ulX, unsigned long ulY, unsigned long ulZ,
 unsigned long MeshGrid::GetElements (unsigned long ulX, unsigned long ulY, unsigned long ulZ,  
                                      std::set<unsigned long> &raclInd) const
 {
-  const std::set<unsigned long> &rclSet = _aulGrid[ulX][ulY][ulZ];
-  if (rclSet.size() > 0)
+  const unsigned long* pBegin = CellBegin(ulX, ulY, ulZ);
+  const unsigned long* pEnd = CellEnd(ulX, ulY, ulZ);
+  if (pBegin != pEnd)
   {
-    raclInd.insert(rclSet.begin(), rclSet.end());
-    return rclSet.size();
+    raclInd.insert(pBegin, pEnd);
+    return (unsigned long)(pEnd - pBegin);
   }
 
   return 0;
@@ -630,9 +691,7 @@ unsigned long MeshGrid::GetElements(const Base::Vector3f &rclPoint, std::vector<
   if (!CheckPosition(rclPoint, ulX, ulY, ulZ))
     return 0;
 
-  aulFacets.resize(_aulGrid[ulX][ulY][ulZ].size());
-
-  std::copy(_aulGrid[ulX][ulY][ulZ].begin(), _aulGrid[ulX][ulY][ulZ].end(), aulFacets.begin());
+  aulFacets.assign(CellBegin(ulX, ulY, ulZ), CellEnd(ulX, ulY, ulZ));
   return aulFacets.size();
 }
 
@@ -737,15 +796,10 @@ void MeshFacetGrid::RebuildGrid (void)
   InitGrid();
  
   // Daten-Struktur fuellen
-  MeshFacetIterator clFIter(*_pclMesh);
-
-  unsigned long i = 0;
-  for (clFIter.Init(); clFIter.More(); clFIter.Next())
-  {
-//    AddFacet(*clFIter, i++, 2.0f);
-    AddFacet(*clFIter, i++);
-  }
-
+  const MeshKernel& rclMesh = *_pclMesh;
+  BuildGrid(_ulCtElements, [this, &rclMesh](unsigned long ulIndex, std::vector<unsigned long>& raulCells) {
+    GetFacetCells(rclMesh.GetFacet(ulIndex), raulCells);
+  });
 }
 
 unsigned long MeshFacetGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt) const
@@ -946,8 +1000,8 @@ void MeshFacetGrid::SearchNearestFacetInGrid(unsigned long ulX, unsigned long ul
                                              const Base::Vector3f &rclPt, float &rfMinDist,
                                              unsigned long &rulFacetInd) const
 {
-  const std::set<unsigned long> &rclSet = _aulGrid[ulX][ulY][ulZ];
-  for (std::set<unsigned long>::const_iterator pI = rclSet.begin(); pI != rclSet.end(); ++pI)
+  const unsigned long* pEnd = CellEnd(ulX, ulY, ulZ);
+  for (const unsigned long* pI = CellBegin(ulX, ulY, ulZ); pI != pEnd; ++pI)
   {
     float fDist = _pclMesh->GetFacet(*pI).DistanceToPoint(rclPt);
     if (fDist < rfMinDist)
@@ -992,13 +1046,12 @@ MeshPointGrid::MeshPointGrid (const MeshKernel &rclM, float fGridLen)
           std::max<unsigned long>((unsigned long)(clBBMesh.LengthZ() / fGridLen), 1));
 }
 
-void MeshPointGrid::AddPoint (const MeshPoint &rclPt, unsigned long ulPtIndex, float fEpsilon)
+void MeshPointGrid::GetPointCells (const MeshPoint &rclPt, std::vector<unsigned long> &raulCells) const
 {
-  (void)fEpsilon;
   unsigned long ulX, ulY, ulZ;
   Pos(Base::Vector3f(rclPt.x, rclPt.y, rclPt.z), ulX, ulY, ulZ);
   if ( (ulX < _ulCtGridsX) && (ulY < _ulCtGridsY) && (ulZ < _ulCtGridsZ) )
-    _aulGrid[ulX][ulY][ulZ].insert(ulPtIndex);
+    raulCells.push_back(CellIndex(ulX, ulY, ulZ));
 }
 
 void MeshPointGrid::Validate (const MeshKernel &rclMesh)
@@ -1049,14 +1102,10 @@ void MeshPointGrid::RebuildGrid (void)
   InitGrid();
  
   // Daten-Struktur fuellen
-
-  MeshPointIterator cPIter(*_pclMesh);
-
-  unsigned long i = 0;
-  for (cPIter.Init(); cPIter.More(); cPIter.Next())
-  {
-    AddPoint(*cPIter, i++);
-  }
+  const MeshPointArray& rclPoints = _pclMesh->GetPoints();
+  BuildGrid(_ulCtElements, [this, &rclPoints](unsigned long ulIndex, std::vector<unsigned long>& raulCells) {
+    GetPointCells(rclPoints[ulIndex], raulCells);
+  });
 }
 
 void MeshPointGrid::Pos (const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const
@@ -1118,7 +1167,7 @@ bool MeshGridIterator::InitOnRay (const Base::Vector3f &rclPt, const Base::Vecto
   if ((_rclGrid.GetBoundBox().IsInBox(rclPt)) == true)
   {  // Voxel bestimmen, indem der Startpunkt liegt
     _rclGrid.Position(rclPt, _ulX, _ulY, _ulZ);
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+    raulElements.insert(raulElements.end(), _rclGrid.CellBegin(_ulX, _ulY, _ulZ), _rclGrid.CellEnd(_ulX, _ulY, _ulZ));
     _bValidRay = true;
   }
   else
@@ -1131,7 +1180,7 @@ bool MeshGridIterator::InitOnRay (const Base::Vector3f &rclPt, const Base::Vecto
       else
         _rclGrid.Position(cP1, _ulX, _ulY, _ulZ);
 
-      raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+      raulElements.insert(raulElements.end(), _rclGrid.CellBegin(_ulX, _ulY, _ulZ), _rclGrid.CellEnd(_ulX, _ulY, _ulZ));
       _bValidRay = true;
     }
   }
@@ -1182,7 +1231,7 @@ bool MeshGridIterator::NextOnRay (std::vector<unsigned long> &raulElements)
   if ((_bValidRay == true) && (_rclGrid.CheckPos(_ulX, _ulY, _ulZ) == true))
   {
     GridElement pos(_ulX, _ulY, _ulZ); _cSearchPositions.insert(pos);
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end()); 
+    raulElements.insert(raulElements.end(), _rclGrid.CellBegin(_ulX, _ulY, _ulZ), _rclGrid.CellEnd(_ulX, _ulY, _ulZ)); 
   }
   else
     _bValidRay = false;  // Strahl ausgetreten
@@ -29,6 +29,7 @@
 #include "MeshIO.h"
 #include "Algorithm.h"
 #include "Builder.h"
+#include "Functional.h"
 
 #include <Base/Builder3D.h>
 #include <Base/Console.h>
@@ -40,6 +41,7 @@
 #include <Base/Stream.h>
 #include <Base/Placement.h>
 #include <Base/Tools.h>
+#include <Base/TimeInfo.h>
 #include <zipios++/gzipoutputstream.h>
 
 #include <cmath>
@@ -49,6 +51,9 @@
 #include <boost/regex.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
+#include <atomic>
+#include <cstring>
+#include <QFile>
 
 
 using namespace MeshCore;
@@ -137,6 +142,69 @@ struct Color_Less  : public std::binary_function<const App::Color&,
 
 }
 
+namespace {
+
+/* Read-only stream buffer on a block of memory, e.g. a memory mapped file.
+ * The stream based readers use it to parse the file header as usual, and then
+ * access the bulk data directly without copying.
+ */
+class MemoryStreambuf : public std::streambuf
+{
+public:
+    MemoryStreambuf(const char* data, std::size_t size)
+    {
+        char* begin = const_cast<char*>(data);
+        setg(begin, begin, begin + size);
+    }
+    const char* current() const
+    {
+        return gptr();
+    }
+    std::size_t available() const
+    {
+        return static_cast<std::size_t>(egptr() - gptr());
+    }
+    void skip(std::size_t n)
+    {
+        setg(eback(), gptr() + std::min(n, available()), egptr());
+    }
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir way,
+                     std::ios_base::openmode which = std::ios::in)
+    {
+        if (!(which & std::ios::in))
+            return pos_type(off_type(-1));
+        off_type pos;
+        if (way == std::ios::beg)
+            pos = off;
+        else if (way == std::ios::cur)
+            pos = (gptr() - eback()) + off;
+        else
+            pos = (egptr() - eback()) + off;
+        if (pos < 0 || pos > egptr() - eback())
+            return pos_type(off_type(-1));
+        setg(eback(), eback() + pos, egptr());
+        return pos_type(pos);
+    }
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios::in)
+    {
+        return seekoff(off_type(pos), std::ios::beg, which);
+    }
+};
+
+/* Reports the number of triangles read per second, so that the memory mapped
+ * and the stream based readers can be compared.
+ */
+void logThroughput(const char* format, const char* source, unsigned long numFacets, const Base::TimeInfo& start)
+{
+    float seconds = Base::TimeInfo::diffTimeF(start, Base::TimeInfo());
+    Base::Console().Log("Read %lu triangles from %s %s in %.3f s (%.0f triangles/s)\n",
+        numFacets, source, format, seconds, seconds > 0 ? numFacets / seconds : 0.0);
+}
+
+}
+
 // --------------------------------------------------------------
 
 bool MeshInput::LoadAny(const char* FileName)
@@ -157,8 +225,30 @@ bool MeshInput::LoadAny(const char* FileName)
     else {
         // read file
         bool ok = false;
-        if (fi.hasExtension("stl") || fi.hasExtension("ast")) {
-            ok = LoadSTL(str);
+        if (fi.hasExtension("stl") || fi.hasExtension("ast") || fi.hasExtension("ply")) {
+            // Map the file into memory, so that the readers can access the
+            // facet data directly
+            QFile file(QString::fromUtf8(fi.filePath().c_str()));
+            uchar* data = 0;
+            if (file.open(QIODevice::ReadOnly) && file.size() > 0)
+                data = file.map(0, file.size());
+            Base::TimeInfo start;
+            if (data) {
+                MemoryStreambuf mem(reinterpret_cast<const char*>(data),
+                                    static_cast<std::size_t>(file.size()));
+                std::istream memstr(&mem);
+                ok = fi.hasExtension("ply") ? LoadPLY(memstr) : LoadSTL(memstr);
+                file.unmap(data);
+            }
+            else if (fi.hasExtension("ply")) {
+                ok = LoadPLY(str);
+            }
+            else {
+                ok = LoadSTL(str);
+            }
+            if (ok)
+                logThroughput(fi.hasExtension("ply") ? "PLY" : "STL", data ? "mapped" : "stream",
+                              _rclMesh.CountFacets(), start);
         }
         else if (fi.hasExtension("iv")) {
             ok = LoadInventor( str );
@@ -177,9 +267,6 @@ bool MeshInput::LoadAny(const char* FileName)
         else if (fi.hasExtension("off")) {
             ok = LoadOFF( str );
         }
-        else if (fi.hasExtension("ply")) {
-            ok = LoadPLY( str );
-        }
         else {
             throw Base::FileException("File extension not supported",FileName);
         }
@@ -196,11 +283,23 @@ bool  MeshInput::LoadFormat(std::istream &str, MeshIO::Format fmt)
         return true;
     case MeshIO::APLY:
     case MeshIO::PLY:
-        return LoadPLY(str);
+        {
+            Base::TimeInfo start;
+            bool ok = LoadPLY(str);
+            if (ok)
+                logThroughput("PLY", "stream", _rclMesh.CountFacets(), start);
+            return ok;
+        }
     case MeshIO::ASTL:
         return LoadAsciiSTL(str);
     case MeshIO::BSTL:
-        return LoadBinarySTL(str);
+        {
+            Base::TimeInfo start;
+            bool ok = LoadBinarySTL(str);
+            if (ok)
+                logThroughput("STL", "stream", _rclMesh.CountFacets(), start);
+            return ok;
+        }
     case MeshIO::OBJ:
         return LoadOBJ(str);
     case MeshIO::SMF:
@@ -673,6 +772,163 @@ namespace MeshCore {
     using namespace Ply;
 }
 
+namespace {
+
+std::size_t numberSize(Ply::Number number)
+{
+    switch (number) {
+    case Ply::int8:
+    case Ply::uint8:
+        return 1;
+    case Ply::int16:
+    case Ply::uint16:
+        return 2;
+    case Ply::int32:
+    case Ply::uint32:
+    case Ply::float32:
+        return 4;
+    case Ply::float64:
+        return 8;
+    }
+    return 0;
+}
+
+template <typename T>
+inline T readValue(const char* data, bool swap)
+{
+    T value;
+    if (swap) {
+        char bytes[sizeof(T)];
+        std::reverse_copy(data, data + sizeof(T), bytes);
+        std::memcpy(&value, bytes, sizeof(T));
+    }
+    else {
+        std::memcpy(&value, data, sizeof(T));
+    }
+    return value;
+}
+
+float readNumber(const char* data, Ply::Number number, bool swap)
+{
+    switch (number) {
+    case Ply::int8:
+        return static_cast<float>(readValue<int8_t>(data, swap));
+    case Ply::uint8:
+        return static_cast<float>(readValue<uint8_t>(data, swap));
+    case Ply::int16:
+        return static_cast<float>(readValue<int16_t>(data, swap));
+    case Ply::uint16:
+        return static_cast<float>(readValue<uint16_t>(data, swap));
+    case Ply::int32:
+        return static_cast<float>(readValue<int32_t>(data, swap));
+    case Ply::uint32:
+        return static_cast<float>(readValue<uint32_t>(data, swap));
+    case Ply::float32:
+        return readValue<float>(data, swap);
+    case Ply::float64:
+        return static_cast<float>(readValue<double>(data, swap));
+    }
+    return 0.0f;
+}
+
+/* Reads the binary data of a PLY file directly from a memory mapped file.
+ * Vertices and triangles are parsed in parallel. Return false if the data
+ * cannot be read this way, and nothing is changed then.
+ */
+bool loadBinaryPLY(MemoryStreambuf* mem, bool littleEndian,
+                   const std::vector<std::pair<std::string, Ply::Number> >& vertex_props,
+                   std::size_t v_count, std::size_t f_count,
+                   MeshPointArray& meshPoints, MeshFacetArray& meshFacets,
+                   std::vector<App::Color>* colors)
+{
+    if (!mem)
+        return false;
+
+    uint16_t test = 1;
+    unsigned char first;
+    std::memcpy(&first, &test, 1);
+    bool swap = littleEndian != (first == 1);
+
+    // the vertex records have a fixed size
+    typedef std::pair<std::size_t, Ply::Number> Layout;
+    std::map<std::string, Layout> layout;
+    std::size_t stride = 0;
+    for (std::vector<std::pair<std::string, Ply::Number> >::const_iterator it =
+        vertex_props.begin(); it != vertex_props.end(); ++it) {
+        layout[it->first] = Layout(stride, it->second);
+        stride += numberSize(it->second);
+    }
+
+    const char* data = mem->current();
+    std::size_t size = mem->available();
+    if (stride * v_count > size)
+        return false;
+
+    Layout x = layout["x"], y = layout["y"], z = layout["z"];
+    Layout r = layout["red"], g = layout["green"], b = layout["blue"];
+    meshPoints.resize(v_count);
+    if (colors)
+        colors->resize(v_count);
+
+    MeshCore::parallel_blocks(v_count, 0x10000, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            const char* record = data + i * stride;
+            meshPoints[i].Set(readNumber(record + x.first, x.second, swap),
+                              readNumber(record + y.first, y.second, swap),
+                              readNumber(record + z.first, z.second, swap));
+            if (colors) {
+                (*colors)[i] = App::Color(readNumber(record + r.first, r.second, swap) / 255.0f,
+                                          readNumber(record + g.first, g.second, swap) / 255.0f,
+                                          readNumber(record + b.first, b.second, swap) / 255.0f);
+            }
+        }
+    });
+    data += stride * v_count;
+    size -= stride * v_count;
+
+    // Like the stream based reader assume uint32 vertex indices. If all faces
+    // are triangles the records have a fixed size, too.
+    const std::size_t triangleSize = 1 + 3 * sizeof(uint32_t);
+    std::atomic<bool> triangles(triangleSize * f_count <= size);
+    if (triangles) {
+        meshFacets.resize(f_count);
+        MeshCore::parallel_blocks(f_count, 0x10000, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                const char* record = data + i * triangleSize;
+                if (static_cast<unsigned char>(record[0]) != 3) {
+                    triangles = false;
+                    return;
+                }
+                meshFacets[i] = MeshFacet(readValue<uint32_t>(record + 1, swap),
+                                          readValue<uint32_t>(record + 5, swap),
+                                          readValue<uint32_t>(record + 9, swap));
+            }
+        });
+        if (triangles)
+            return true;
+        meshFacets.clear();
+    }
+
+    // polygons of any size, only triangles are used
+    meshFacets.reserve(f_count);
+    const char* end = data + size;
+    for (std::size_t i = 0; i < f_count && data < end; i++) {
+        std::size_t n = static_cast<unsigned char>(*data++);
+        if (data + n * sizeof(uint32_t) > end)
+            break;
+        if (n == 3) {
+            meshFacets.push_back(MeshFacet(readValue<uint32_t>(data, swap),
+                                           readValue<uint32_t>(data + 4, swap),
+                                           readValue<uint32_t>(data + 8, swap)));
+        }
+        data += n * sizeof(uint32_t);
+    }
+
+    return true;
+}
+
+}
+
 bool MeshInput::LoadPLY (std::istream &inp)
 {
     // http://local.wasp.uwa.edu.au/~pbourke/dataformats/ply/
@@ -991,6 +1247,13 @@ bool MeshInput::LoadPLY (std::istream &inp)
             }
         }
     }
+    // binary, mapped into memory
+    else if (face_props.empty() &&
+             loadBinaryPLY(dynamic_cast<MemoryStreambuf*>(buf), format == binary_little_endian,
+                           vertex_props, v_count, f_count, meshPoints, meshFacets,
+                           (_material && rgb_value == MeshIO::PER_VERTEX) ? &_material->diffuseColor : 0)) {
+        // Invalid vertex indices are removed by the cleanup below
+    }
     // binary
     else {
         Base::InputStream is(inp);
@@ -1297,6 +1560,24 @@ bool MeshInput::LoadBinarySTL (std::istream &rstrIn)
     if (ulCt > ulFac)
         return false;// not a valid STL file
 
+    // If the file is mapped into memory the facets are read in parallel
+    MemoryStreambuf* mem = dynamic_cast<MemoryStreambuf*>(buf);
+    if (mem && mem->available() >= 50 * static_cast<std::size_t>(ulCt)) {
+        const char* data = mem->current();
+        MeshFastBuilder builder(this->_rclMesh);
+        builder.Initialize(ulCt);
+        builder.AddFacets(ulCt, [data](unsigned long i, Base::Vector3f* facetPoints) {
+            // Each record has the normal, the three points and two bytes
+            // attribute. Use the same point order as below.
+            const char* record = data + 50 * static_cast<std::size_t>(i);
+            std::memcpy(&facetPoints[1], record + 12, 2 * sizeof(Base::Vector3f));
+            std::memcpy(&facetPoints[0], record + 36, sizeof(Base::Vector3f));
+        });
+        mem->skip(50 * static_cast<std::size_t>(ulCt));
+        builder.Finish();
+        return true;
+    }
+
 #if 0
     MeshBuilder builder(this->_rclMesh);
 #else
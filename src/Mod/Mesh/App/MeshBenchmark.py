@@ -0,0 +1,74 @@
+#   This file is part of the FreeCAD CAx development system.      LGPL
+
+# Benchmarks of the mesh module. They are not part of the unit tests, run
+# them explicitly with
+#   FreeCAD -t MeshBenchmark
+
+import FreeCAD, unittest, Mesh
+import time, math
+
+
+def spherePoints(radius, count):
+    # evenly distributed points on a sphere
+    points = []
+    for i in range(count):
+        phi = math.acos(1.0 - 2.0 * (i + 0.5) / count)
+        theta = math.pi * (1.0 + math.sqrt(5.0)) * i
+        points.append(FreeCAD.Vector(radius * math.sin(phi) * math.cos(theta),
+                                     radius * math.sin(phi) * math.sin(theta),
+                                     radius * math.cos(phi)))
+    return points
+
+
+class FacetGridBenchmarkCases(unittest.TestCase):
+    # sampling of the spheres, which have about 2*n*n facets
+    Samplings = [1000, 2000]
+
+    def testBuild(self):
+        # a cross section with a single plane is dominated by building the facet grid
+        for sampling in self.Samplings:
+            mesh = Mesh.createSphere(10.0, sampling)
+            start = time.time()
+            mesh.crossSections([(FreeCAD.Vector(0, 0, 0), FreeCAD.Vector(0, 0, 1))])
+            t = time.time() - start
+            FreeCAD.Console.PrintMessage("Build facet grid of %d triangles: %.3f s\n"
+                    % (mesh.CountFacets, t))
+
+    def inspect(self, doc, nominal, points):
+        import Points
+        actual = doc.addObject("Points::Feature", "Actual")
+        actual.Points = Points.Points(points)
+        inspect = doc.addObject("Inspection::Feature", "Inspect")
+        inspect.Actual = actual
+        inspect.Nominals = [nominal]
+        inspect.SearchRadius = 1.0
+        start = time.time()
+        doc.recompute()
+        t = time.time() - start
+        doc.removeObject(inspect.Name)
+        doc.removeObject(actual.Name)
+        return t
+
+    def testSearchNearestFromPoint(self):
+        try:
+            import Points, Inspection
+        except ImportError:
+            self.skipTest("Inspection module not available")
+
+        # The inspection feature builds a grid of the mesh and then searches
+        # the nearest facets of each point in it. Two runs with a different
+        # number of points separate the grid build from the search.
+        few, many = 10000, 200000
+        for sampling in self.Samplings:
+            doc = FreeCAD.newDocument("FacetGridBenchmark")
+            try:
+                nominal = doc.addObject("Mesh::Feature", "Nominal")
+                nominal.Mesh = Mesh.createSphere(10.0, sampling)
+                t1 = self.inspect(doc, nominal, spherePoints(10.1, few))
+                t2 = self.inspect(doc, nominal, spherePoints(10.1, many))
+                rate = (many - few) / max(t2 - t1, 1e-6)
+                FreeCAD.Console.PrintMessage("Nearest facet search in %d triangles: "
+                        "grid %.3f s, %.0f points/s\n"
+                        % (nominal.Mesh.CountFacets, max(t1 - few / rate, 0.0), rate))
+            finally:
+                FreeCAD.closeDocument(doc.Name)
@@ -23,6 +23,7 @@
 
 #include "PreCompiled.h"
 #ifndef _PreComp_
+# include <algorithm>
 #endif
 
 #include <CXX/Objects.hxx>
@@ -269,7 +270,7 @@ void PropertyCurvatureList::Paste(const App::Property &from)
 // ----------------------------------------------------------------------------
 
 PropertyMeshKernel::PropertyMeshKernel()
-  : _meshObject(new MeshObject()), meshPyObject(0)
+  : _meshObject(new MeshObject()), meshPyObject(0), sharedFrom(0)
 {
     // Note: Normally this property is a member of a document object, i.e. the setValue()
     // method gets called in the constructor of a sublcass of DocumentObject, e.g. Mesh::Feature.
@@ -285,6 +286,60 @@ PropertyMeshKernel::~PropertyMeshKernel()
         meshPyObject->parentProperty = 0;
         Py_DECREF(meshPyObject);
     }
+
+    // the copies keep the mesh object alive
+    unshareMesh();
+}
+
+void PropertyMeshKernel::unshareMesh()
+{
+    if (sharedFrom) {
+        std::vector<PropertyMeshKernel*>& copies = sharedFrom->sharedCopies;
+        copies.erase(std::find(copies.begin(), copies.end(), this));
+        sharedFrom = 0;
+    }
+    else if (!sharedCopies.empty()) {
+        // the first copy takes over the role of this property
+        PropertyMeshKernel* owner = sharedCopies.front();
+        owner->sharedFrom = 0;
+        owner->sharedCopies.assign(sharedCopies.begin() + 1, sharedCopies.end());
+        for (std::vector<PropertyMeshKernel*>::iterator it = owner->sharedCopies.begin(); it != owner->sharedCopies.end(); ++it)
+            (*it)->sharedFrom = owner;
+        sharedCopies.clear();
+    }
+}
+
+void PropertyMeshKernel::detachMesh(bool keepData)
+{
+    if (!sharedFrom && sharedCopies.empty())
+        return;
+
+    Base::Reference<MeshObject> mesh(new MeshObject());
+    if (keepData) {
+        *mesh = *_meshObject;
+    }
+    else if (sharedFrom) {
+        mesh->setTransform(_meshObject->getTransform());
+    }
+    else {
+        // The content gets replaced anyway, so move it over to the copies
+        // but keep the placement of the mesh.
+        mesh->swap(*_meshObject);
+        _meshObject->setTransform(mesh->getTransform());
+    }
+
+    if (sharedFrom) {
+        // a copy gets its own mesh object
+        unshareMesh();
+        _meshObject = mesh;
+    }
+    else {
+        // this property keeps its mesh object because it may be referenced
+        // by the Python wrapper
+        for (std::vector<PropertyMeshKernel*>::iterator it = sharedCopies.begin(); it != sharedCopies.end(); ++it)
+            (*it)->_meshObject = mesh;
+        unshareMesh();
+    }
 }
 
 void PropertyMeshKernel::setValuePtr(MeshObject* mesh)
@@ -293,6 +348,11 @@ void PropertyMeshKernel::setValuePtr(MeshObject* mesh)
     // before calling hasSetValue()
     Base::Reference<MeshObject> tmp(_meshObject);
     aboutToSetValue();
+    // the copies keep the old mesh object
+    if (mesh != getValuePtr())
+        unshareMesh();
+    else
+        detachMesh(true);
     _meshObject = mesh;
     hasSetValue();
 }
@@ -300,6 +360,7 @@ void PropertyMeshKernel::setValuePtr(MeshObject* mesh)
 void PropertyMeshKernel::setValue(const MeshObject& mesh)
 {
     aboutToSetValue();
+    detachMesh(&mesh == getValuePtr());
     *_meshObject = mesh;
     hasSetValue();
 }
@@ -307,6 +368,7 @@ void PropertyMeshKernel::setValue(const MeshObject& mesh)
 void PropertyMeshKernel::setValue(const MeshCore::MeshKernel& mesh)
 {
     aboutToSetValue();
+    detachMesh(&mesh == &_meshObject->getKernel());
     _meshObject->setKernel(mesh);
     hasSetValue();
 }
@@ -314,6 +376,7 @@ void PropertyMeshKernel::setValue(const MeshCore::MeshKernel& mesh)
 void PropertyMeshKernel::swapMesh(MeshObject& mesh)
 {
     aboutToSetValue();
+    detachMesh(true);
     _meshObject->swap(mesh);
     hasSetValue();
 }
@@ -321,6 +384,7 @@ void PropertyMeshKernel::swapMesh(MeshObject& mesh)
 void PropertyMeshKernel::swapMesh(MeshCore::MeshKernel& mesh)
 {
     aboutToSetValue();
+    detachMesh(true);
     _meshObject->swap(mesh);
     hasSetValue();
 }
@@ -348,7 +412,9 @@ Base::BoundBox3d PropertyMeshKernel::getBoundingBox() const
 unsigned int PropertyMeshKernel::getMemSize (void) const
 {
     unsigned int size = 0;
-    size += _meshObject->getMemSize();
+    // a shared mesh object is counted only once
+    if (!sharedFrom)
+        size += _meshObject->getMemSize();
     
     return size;
 }
@@ -356,6 +422,7 @@ unsigned int PropertyMeshKernel::getMemSize (void) const
 MeshObject* PropertyMeshKernel::startEditing()
 {
     aboutToSetValue();
+    detachMesh(true);
     return (MeshObject*)_meshObject;
 }
 
@@ -367,6 +434,7 @@ void PropertyMeshKernel::finishEditing()
 void PropertyMeshKernel::transformGeometry(const Base::Matrix4D &rclMat)
 {
     aboutToSetValue();
+    detachMesh(true);
     _meshObject->transformGeometry(rclMat);
     hasSetValue();
 }
@@ -374,15 +442,25 @@ void PropertyMeshKernel::transformGeometry(const Base::Matrix4D &rclMat)
 void PropertyMeshKernel::setPointIndices(const std::vector<std::pair<unsigned long, Base::Vector3f> >& inds)
 {
     aboutToSetValue();
+    detachMesh(true);
     MeshCore::MeshKernel& kernel = _meshObject->getKernel();
     for (std::vector<std::pair<unsigned long, Base::Vector3f> >::const_iterator it = inds.begin(); it != inds.end(); ++it)
         kernel.SetPoint(it->first, it->second);
     hasSetValue();
 }
 
+void PropertyMeshKernel::setTransform(const Base::Matrix4D &rclMat)
+{
+    detachMesh(true);
+    _meshObject->setTransform(rclMat);
+}
+
 PyObject *PropertyMeshKernel::getPyObject(void)
 {
     if (!meshPyObject) {
+        // the wrapper may modify the mesh object
+        if (sharedFrom)
+            detachMesh(true);
         meshPyObject = new MeshPy(&*_meshObject);
         meshPyObject->setConst(); // set immutable
         meshPyObject->parentProperty = this;
@@ -445,6 +523,7 @@ void PropertyMeshKernel::Restore(Base::XMLReader &reader)
         kernel.Adopt(points, facets);
 
         aboutToSetValue();
+        detachMesh(false);
         _meshObject->getKernel().Adopt(points, facets);
         hasSetValue();
     } 
@@ -462,23 +541,32 @@ void PropertyMeshKernel::SaveDocFile (Base::Writer &writer) const
 void PropertyMeshKernel::RestoreDocFile(Base::Reader &reader)
 {
     aboutToSetValue();
+    detachMesh(false);
     _meshObject->load(reader);
     hasSetValue();
 }
 
 App::Property *PropertyMeshKernel::Copy(void) const
 {
-    // Note: Copy the content, do NOT reference the same mesh object
+    // Note: Reference the same mesh object, it gets copied by whichever
+    // property is modified first
     PropertyMeshKernel *prop = new PropertyMeshKernel();
-    *(prop->_meshObject) = *(this->_meshObject);
+    PropertyMeshKernel *owner = sharedFrom ? sharedFrom : const_cast<PropertyMeshKernel*>(this);
+    prop->_meshObject = this->_meshObject;
+    prop->sharedFrom = owner;
+    owner->sharedCopies.push_back(prop);
     return prop;
 }
 
 void PropertyMeshKernel::Paste(const App::Property &from)
 {
-    // Note: Copy the content, do NOT reference the same mesh object
+    // Note: Copy the content, do NOT reference the same mesh object because
+    // the Python wrapper must keep referencing the mesh of this property
     aboutToSetValue();
     const PropertyMeshKernel& prop = dynamic_cast<const PropertyMeshKernel&>(from);
-    *(this->_meshObject) = *(prop._meshObject);
+    if (prop.getValuePtr() != this->getValuePtr()) {
+        detachMesh(false);
+        *(this->_meshObject) = *(prop._meshObject);
+    }
     hasSetValue();
 }
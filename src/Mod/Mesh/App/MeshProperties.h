@@ -159,6 +159,8 @@ public:
     /// Transform the real mesh data
     void transformGeometry(const Base::Matrix4D &rclMat);
     void setPointIndices( const std::vector<std::pair<unsigned long, Base::Vector3f> >& );
+    /** Sets the placement of the mesh without touching the property. */
+    void setTransform(const Base::Matrix4D &rclMat);
     //@}
 
     /** @name Python interface */
@@ -187,14 +189,33 @@ public:
 
     void SaveDocFile (Base::Writer &writer) const;
     void RestoreDocFile(Base::Reader &reader);
+    bool canSaveDocFileConcurrently() const {return true;}
 
+    /** Returns a copy of the property which references the same mesh object.
+     * The mesh object is shared until one of the properties gets modified,
+     * so that a copy made for undo/redo doesn't cost any memory as long as
+     * the mesh isn't changed.
+     */
     App::Property *Copy(void) const;
     void Paste(const App::Property &from);
     //@}
 
+private:
+    /** Makes sure that this property is the only one referencing its mesh
+     * object. If \a keepData is false the content is about to be replaced
+     * and the other properties take over the current data without copying.
+     */
+    void detachMesh(bool keepData);
+    /// Leaves the group of properties sharing the same mesh object
+    void unshareMesh();
+
 private:
     Base::Reference<MeshObject> _meshObject;
     MeshPy* meshPyObject;
+    /// the property whose mesh object is shared, or null
+    PropertyMeshKernel* sharedFrom;
+    /// the copies sharing the mesh object of this property
+    std::vector<PropertyMeshKernel*> sharedCopies;
 };
 
 } // namespace Mesh
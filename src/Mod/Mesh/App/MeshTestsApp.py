@@ -168,6 +168,164 @@ class LoadMeshInThreadsCases(unittest.TestCase):
         pass
 
 
+class LoadMappedMeshCases(unittest.TestCase):
+    def setUp(self):
+        self.mesh = Mesh.createSphere(10.0, 600)
+
+    def loadFile(self, ext, fmt):
+        name = tempfile.gettempdir() + os.sep + "mapped" + ext
+        self.mesh.write(name)
+        try:
+            # reading from a file maps it into memory
+            mapped = Mesh.Mesh(name)
+
+            # reading from a stream uses the sequential code
+            stream = Mesh.Mesh()
+            with open(name, "rb") as f:
+                stream.read(Stream=f, Format=fmt)
+        finally:
+            os.remove(name)
+
+        self.assertEqual(mapped.CountFacets, self.mesh.CountFacets)
+        self.assertEqual(mapped.CountPoints, stream.CountPoints)
+        self.assertEqual(mapped.CountFacets, stream.CountFacets)
+        self.assertEqual(mapped.Topology, stream.Topology)
+
+    def testBinarySTL(self):
+        self.loadFile(".stl", "STL")
+
+    def testBinaryPLY(self):
+        self.loadFile(".ply", "PLY")
+
+    def tearDown(self):
+        pass
+
+
+class FacetGridCases(unittest.TestCase):
+    def setUp(self):
+        self.mesh = Mesh.createSphere(10.0, 600)
+
+    def testBuild(self):
+        # a cross section builds a facet grid of the whole mesh
+        sections = self.mesh.crossSections([(FreeCAD.Vector(0, 0, 0), FreeCAD.Vector(0, 0, 1))])
+        self.assertEqual(len(sections), 1)
+        self.assertTrue(len(sections[0]) > 0)
+
+    def testSearchNearestFromPoint(self):
+        try:
+            import Points, Inspection
+        except ImportError:
+            self.skipTest("Inspection module not available")
+
+        # the inspection feature searches the nearest facets of each point in a grid
+        count = 20000
+        points = []
+        for i in range(count):
+            phi = math.acos(1.0 - 2.0 * (i + 0.5) / count)
+            theta = math.pi * (1.0 + math.sqrt(5.0)) * i
+            points.append(FreeCAD.Vector(10.1 * math.sin(phi) * math.cos(theta),
+                                         10.1 * math.sin(phi) * math.sin(theta),
+                                         10.1 * math.cos(phi)))
+
+        doc = FreeCAD.newDocument("FacetGrid")
+        try:
+            nominal = doc.addObject("Mesh::Feature", "Nominal")
+            nominal.Mesh = self.mesh
+            actual = doc.addObject("Points::Feature", "Actual")
+            actual.Points = Points.Points(points)
+            inspect = doc.addObject("Inspection::Feature", "Inspect")
+            inspect.Actual = actual
+            inspect.Nominals = [nominal]
+            inspect.SearchRadius = 1.0
+
+            doc.recompute()
+
+            distances = inspect.Distances
+            self.assertEqual(len(distances), count)
+            for d in distances:
+                self.assertAlmostEqual(d, 0.1, delta=0.01)
+        finally:
+            FreeCAD.closeDocument(doc.Name)
+
+
+class ShapeInspectionCases(unittest.TestCase):
+    # compare the distances to a shape with the former implementation
+    def setUp(self):
+        try:
+            import Part, Points, Inspection
+        except ImportError:
+            self.skipTest("Inspection module not available")
+
+        self.param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Inspection/Inspection")
+        self.legacy = self.param.GetBool("UseLegacyShapeDistance", False)
+        self.doc = FreeCAD.newDocument("ShapeInspection")
+        self.nominal = self.doc.addObject("Part::Feature", "Nominal")
+        self.actual = self.doc.addObject("Points::Feature", "Actual")
+        self.inspect = self.doc.addObject("Inspection::Feature", "Inspect")
+        self.inspect.Actual = self.actual
+        self.inspect.Nominals = [self.nominal]
+        self.inspect.SearchRadius = 100.0
+
+        # points around and inside of a 10x10x10 box, none of them on its surface
+        coords = [-2.5, 0.5, 3.5, 6.5, 9.5, 12.5]
+        self.points = [FreeCAD.Vector(x, y, z) for x in coords for y in coords for z in coords]
+
+    def tearDown(self):
+        self.param.SetBool("UseLegacyShapeDistance", self.legacy)
+        FreeCAD.closeDocument(self.doc.Name)
+
+    def distances(self, shape, points, legacy):
+        import Points
+        self.param.SetBool("UseLegacyShapeDistance", legacy)
+        self.nominal.Shape = shape
+        self.actual.Points = Points.Points(points)
+        self.inspect.touch()
+        self.doc.recompute()
+        return self.inspect.Distances
+
+    def compare(self, shape, points, signed=True):
+        new = self.distances(shape, points, False)
+        old = self.distances(shape, points, True)
+        self.assertEqual(len(new), len(points))
+        self.assertEqual(len(old), len(points))
+        for p, d1, d2 in zip(points, new, old):
+            if not signed:
+                d1, d2 = abs(d1), abs(d2)
+            self.assertAlmostEqual(d1, d2, places=3, msg="Distance of {} differs".format(p))
+
+    def testSolid(self):
+        import Part
+        self.compare(Part.makeBox(10, 10, 10), self.points)
+
+    def testOpenShell(self):
+        import Part
+        box = Part.makeBox(10, 10, 10)
+        shell = Part.Shell(box.Faces[0:5])
+        self.compare(shell, self.points, signed=False)
+
+        # the sign is only well-defined if the nearest point is inside of a face
+        coords = [3.5, 5.0, 6.5]
+        points = [FreeCAD.Vector(x, y, z) for x in coords for y in coords for z in [-1.0, 1.0]]
+        points += [FreeCAD.Vector(x, y, z) for x in [-1.0, 1.0] for y in coords for z in coords]
+        self.compare(shell, points)
+
+    def testWire(self):
+        import Part
+        wire = Part.makePolygon([FreeCAD.Vector(0, 0, 0), FreeCAD.Vector(10, 0, 0),
+                                 FreeCAD.Vector(10, 10, 5), FreeCAD.Vector(0, 10, 10)])
+        distances = self.distances(wire, self.points, False)
+        self.assertTrue(max(distances) < 100.0)
+        self.compare(wire, self.points)
+
+    def testCompound(self):
+        # free edges and vertexes of a compound are taken into account
+        import Part
+        face = Part.makePlane(10, 10)
+        edge = Part.makeLine(FreeCAD.Vector(0, 0, 5), FreeCAD.Vector(10, 10, 5))
+        vertex = Part.Vertex(FreeCAD.Vector(5, 5, 12))
+        self.compare(Part.makeCompound([face, edge, vertex]), self.points)
+
+
 class PolynomialFitCases(unittest.TestCase):
     def setUp(self):
         pass
@@ -225,3 +383,75 @@ class PolynomialFitCases(unittest.TestCase):
 
     def tearDown(self):
         pass
+
+
+class MeshUndoCases(unittest.TestCase):
+    def setUp(self):
+        self.doc = FreeCAD.newDocument("MeshUndo")
+        self.doc.UndoMode = 1
+        self.obj = self.doc.addObject("Mesh::Feature", "Mesh")
+
+    def testUndoRedo(self):
+        self.doc.openTransaction("Sphere")
+        self.obj.Mesh = Mesh.createSphere(1.0, 20)
+        self.doc.commitTransaction()
+        count = self.obj.Mesh.CountFacets
+
+        self.doc.openTransaction("Box")
+        self.obj.Mesh = Mesh.createBox(1.0, 1.0, 1.0)
+        self.doc.commitTransaction()
+        mesh = self.obj.Mesh
+        normal = mesh.Facets[0].Normal
+
+        # modify the mesh in place
+        self.doc.openTransaction("Flip")
+        mesh.flipNormals()
+        self.doc.commitTransaction()
+        self.assertEqual(mesh.Facets[0].Normal, -normal)
+        self.assertGreater(self.doc.UndoRedoMemSize, 0)
+
+        self.doc.undo()
+        self.assertEqual(mesh.Facets[0].Normal, normal)
+        self.doc.undo()
+        self.assertEqual(self.obj.Mesh.CountFacets, count)
+        self.assertEqual(mesh.CountFacets, count)
+        self.doc.redo()
+        self.assertEqual(self.obj.Mesh.CountFacets, 12)
+        self.doc.redo()
+        self.assertEqual(self.obj.Mesh.Facets[0].Normal, -normal)
+
+    def testUndoMemLimit(self):
+        def replace(radius):
+            self.doc.openTransaction("Sphere")
+            self.obj.Mesh = Mesh.createSphere(radius, 20)
+            self.doc.commitTransaction()
+
+        replace(1.0)
+        size = self.doc.UndoRedoMemSize
+        replace(2.0)
+        snapshot = self.doc.UndoRedoMemSize - size
+        self.assertGreater(snapshot, 0)
+
+        # the oldest transactions are removed until the stack fits again
+        limit = int(2.5 * snapshot)
+        self.doc.UndoMemLimit = limit
+        self.assertEqual(self.doc.UndoMemLimit, limit)
+        replace(3.0)
+        self.assertEqual(self.doc.UndoCount, 3)
+        replace(4.0)
+        self.assertEqual(self.doc.UndoCount, 2)
+        self.assertLessEqual(self.doc.UndoRedoMemSize, limit)
+        box = self.obj.Mesh.BoundBox
+
+        # the last transaction is kept even if it exceeds the limit alone
+        self.doc.UndoMemLimit = 1
+        replace(5.0)
+        self.assertEqual(self.doc.UndoCount, 1)
+        self.doc.undo()
+        self.assertEqual(self.obj.Mesh.BoundBox, box)
+
+        with self.assertRaises(ValueError):
+            self.doc.UndoMemLimit = -1
+
+    def tearDown(self):
+        FreeCAD.closeDocument(self.doc.Name)
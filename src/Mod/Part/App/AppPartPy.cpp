@@ -128,6 +128,7 @@
 #include "FaceMaker.h"
 #include "PartFeature.h"
 #include "PartPyCXX.h"
+#include "ShapeCache.h"
 #include "TopoShapeOpCode.h"
 
 #ifdef FCUseFreeType
@@ -504,6 +505,15 @@ public:
         add_varargs_method("joinSubname",&Module::joinSubname,
             "joinSubname(sub,mapped,subElement) -> subname\n"
         );
+        add_varargs_method("getShapeCacheStats",&Module::getShapeCacheStats,
+            "getShapeCacheStats(reset=False) -> dict\n"
+            "Return the statistics of the persistent shape cache\n\n"
+            "reset: if True, reset the hit/miss/store/eviction/error counters"
+        );
+        add_varargs_method("clearShapeCache",&Module::clearShapeCache,
+            "clearShapeCache()\n"
+            "Remove all entries of the persistent shape cache"
+        );
         initialize("This is a module working with shapes."); // register with Python
     }
 
@@ -2308,6 +2318,30 @@ private:
         return Py::String(subname);
     }
 
+    Py::Object getShapeCacheStats(const Py::Tuple& args) {
+        PyObject *reset = Py_False;
+        if (!PyArg_ParseTuple(args.ptr(), "|O",&reset))
+            throw Py::Exception();
+        auto stats = ShapeCache::instance().getStats(PyObject_IsTrue(reset));
+        Py::Dict dict;
+        dict.setItem("Enabled",Py::Boolean(ShapeCache::instance().isEnabled()));
+        dict.setItem("Hits",Py::Long(stats.hits));
+        dict.setItem("Misses",Py::Long(stats.misses));
+        dict.setItem("Stores",Py::Long(stats.stores));
+        dict.setItem("Evictions",Py::Long(stats.evictions));
+        dict.setItem("Errors",Py::Long(stats.errors));
+        dict.setItem("Entries",Py::Long(stats.entries));
+        dict.setItem("Size",Py::Long((unsigned long)stats.size));
+        return dict;
+    }
+
+    Py::Object clearShapeCache(const Py::Tuple& args) {
+        if (!PyArg_ParseTuple(args.ptr(), ""))
+            throw Py::Exception();
+        ShapeCache::instance().clear();
+        return Py::None();
+    }
+
 
 };
 
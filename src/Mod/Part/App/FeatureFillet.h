@@ -46,6 +46,10 @@ public:
         return "PartGui::ViewProviderFillet";
     }
     //@}
+protected:
+#ifndef FC_NO_ELEMENT_MAP
+    virtual bool isShapeCacheable() const override {return true;}
+#endif
 };
 
 } //namespace Part
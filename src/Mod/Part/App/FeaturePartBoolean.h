@@ -58,6 +58,9 @@ public:
 
 protected:
     virtual BRepAlgoAPI_BooleanOperation* makeOperation(const TopoDS_Shape&, const TopoDS_Shape&) const = 0;
+#ifndef FC_NO_ELEMENT_MAP
+    virtual bool isShapeCacheable() const override {return true;}
+#endif
     virtual const char *opCode() const;
 };
 
@@ -82,6 +82,12 @@ App::DocumentObjectExecReturn *Box::execute(void)
     }
 }
 
+bool Box::canRecomputeConcurrently() const
+{
+    // Without support the shape is made from the own properties only
+    return Support.getValues().empty();
+}
+
 /**
  * This method was added for backward-compatibility. In former versions
  * of Box we had the properties x,y,z and l,h,w which have changed to
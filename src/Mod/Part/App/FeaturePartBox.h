@@ -47,6 +47,8 @@ public:
     /// recalculate the Feature
     App::DocumentObjectExecReturn *execute(void);
     short mustExecute() const;
+    /// the box can be recomputed in a worker thread if not attached
+    virtual bool canRecomputeConcurrently() const;
     /// returns the type name of the ViewProvider
     const char* getViewProviderName(void) const {
         return "PartGui::ViewProviderBox";
@@ -68,6 +68,10 @@ public:
         return "PartGui::ViewProviderMultiFuse";
     }
 
+protected:
+#ifndef FC_NO_ELEMENT_MAP
+    virtual bool isShapeCacheable() const override {return true;}
+#endif
 };
 
 }
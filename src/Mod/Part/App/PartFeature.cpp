@@ -71,6 +71,7 @@
 #include "PartPyCXX.h"
 #include "PartFeature.h"
 #include "PartFeaturePy.h"
+#include "ShapeCache.h"
 #include "TopoShapePy.h"
 
 using namespace Part;
@@ -99,7 +100,21 @@ short Feature::mustExecute(void) const
 App::DocumentObjectExecReturn *Feature::recompute(void)
 {
     try {
-        return App::GeoFeature::recompute();
+        std::string key;
+        auto &cache = ShapeCache::instance();
+        if(isShapeCacheable() && cache.isEnabled()) {
+            key = cache.getKey(this);
+            if(key.size() && cache.restore(key,this)) {
+                _ShapeContentKey = key;
+                return App::DocumentObject::StdReturn;
+            }
+        }
+        auto ret = App::GeoFeature::recompute();
+        if(!ret && key.size()) {
+            cache.store(key,this);
+            _ShapeContentKey = key;
+        }
+        return ret;
     }
     catch (Standard_Failure& e) {
 
@@ -611,8 +626,18 @@ App::DocumentObject *Feature::getShapeOwner(const App::DocumentObject *obj, cons
     return owner;
 }
 
+const std::string &Feature::getShapeContentKey() const
+{
+    if(_ShapeContentKey.empty())
+        _ShapeContentKey = ShapeCache::hashShape(Shape.getShape());
+    return _ShapeContentKey;
+}
+
 void Feature::onChanged(const App::Property* prop)
 {
+    if (prop == &this->Placement || prop == &this->Shape)
+        _ShapeContentKey.clear();
+
     // if the placement has changed apply the change to the point data as well
     if (prop == &this->Placement) {
         TopoShape& shape = const_cast<TopoShape&>(this->Shape.getShape());
@@ -624,7 +649,7 @@ void Feature::onChanged(const App::Property* prop)
             TopoShape& shape = const_cast<TopoShape&>(this->Shape.getShape());
             shape.setTransform(this->Placement.getValue().toMatrix());
         }
-        else {
+        else if (!this->Shape.isRestorePending()) {
             Base::Placement p;
             // shape must not be null to override the placement
             if (!this->Shape.getValue().IsNull()) {
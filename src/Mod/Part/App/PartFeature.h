@@ -125,6 +125,14 @@ public:
     getRelatedElements(App::DocumentObject *obj, const char *name, bool sameType=true, bool withCache=true);
 
     TopLoc_Location getLocation() const;
+
+    /** Return a key identifying the content of the shape
+     *
+     * The key is either the shape cache key used to produce the current
+     * shape, or a hash of the shape content. It is used by the shape cache
+     * to compute the key of the dependent features.
+     */
+    const std::string &getShapeContentKey() const;
     
 protected:
     /// recompute only this object
@@ -132,6 +140,17 @@ protected:
     /// recalculate the feature
     virtual App::DocumentObjectExecReturn *execute(void);
     virtual void onChanged(const App::Property* prop);
+
+    /** Whether the feature shape can be obtained from ShapeCache
+     *
+     * A feature that opts in must produce its shape (including the element
+     * map) solely from its non output properties and the shapes of its
+     * linked Part::Feature objects.
+     */
+    virtual bool isShapeCacheable() const {return false;}
+
+private:
+    mutable std::string _ShapeContentKey;
 };
 
 class FilletBase : public Part::Feature
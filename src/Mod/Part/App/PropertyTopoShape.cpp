@@ -32,12 +32,20 @@
 # include <Bnd_Box.hxx>
 # include <BRepTools.hxx>
 # include <BRepTools_ShapeSet.hxx>
+# include <BRep_Builder.hxx>
+# include <BRep_Tool.hxx>
+# include <Poly_Polygon3D.hxx>
+# include <Poly_PolygonOnTriangulation.hxx>
+# include <Poly_Triangulation.hxx>
+# include <TColStd_HArray1OfReal.hxx>
+# include <TopTools_IndexedMapOfShape.hxx>
 # include <BRepBuilderAPI_Copy.hxx>
 # include <TopTools_HSequenceOfShape.hxx>
 # include <TopTools_MapOfShape.hxx>
 # include <TopoDS.hxx>
 # include <TopoDS_Iterator.hxx>
 # include <TopExp.hxx>
+# include <TopExp_Explorer.hxx>
 # include <Standard_Failure.hxx>
 # include <Standard_Version.hxx>
 # include <gp_GTrsf.hxx>
@@ -63,6 +71,14 @@
 #include <App/ObjectIdentifier.h>
 #include <App/GeoFeature.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <QRunnable>
+#include <QThreadPool>
+
 #include "PartPyCXX.h"
 #include "PropertyTopoShape.h"
 #include "TopoShapePy.h"
@@ -81,17 +97,537 @@ using namespace Part;
 
 TYPESYSTEM_SOURCE(Part::PropertyPartShape , App::PropertyComplexGeoData);
 
+namespace {
+
+// Read-only stream buffer on the content of a pending restore, so that
+// decoding does not copy it once more
+class StringStreambuf : public std::streambuf
+{
+public:
+    explicit StringStreambuf(const std::string &data)
+    {
+        char *begin = const_cast<char*>(data.data());
+        setg(begin, begin, begin + data.size());
+    }
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir way,
+                     std::ios_base::openmode which = std::ios::in)
+    {
+        if (!(which & std::ios::in))
+            return pos_type(off_type(-1));
+        off_type pos;
+        if (way == std::ios::beg)
+            pos = off;
+        else if (way == std::ios::cur)
+            pos = (gptr() - eback()) + off;
+        else
+            pos = (egptr() - eback()) + off;
+        if (pos < 0 || pos > egptr() - eback())
+            return pos_type(off_type(-1));
+        setg(eback(), eback() + pos, egptr());
+        return pos_type(pos);
+    }
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios::in)
+    {
+        return seekoff(off_type(pos), std::ios::beg, which);
+    }
+};
+
+}
+
+struct PropertyPartShape::PendingRestore
+{
+    enum State {
+        Queued,
+        Running,
+        Done,
+    };
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    State state = Queued;
+    bool applied = false;
+    bool binary = false;
+    std::string fileName;
+    std::string data;
+    std::string tessellation;
+    TopoDS_Shape shape;
+    std::string error;
+
+    // Decode the buffered shape content. Return false if it is already
+    // taken by another thread.
+    bool decode() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (state != Queued)
+                return false;
+            state = Running;
+        }
+
+        TopoDS_Shape sh;
+        std::string msg;
+        try {
+            StringStreambuf buf(data);
+            std::istream iss(&buf);
+            if (binary) {
+                TopoShape shape;
+                shape.importBinary(iss);
+                sh = shape.getShape();
+            }
+            else {
+                BRep_Builder builder;
+                BRepTools::Read(sh, iss, builder);
+            }
+        }
+        catch (Standard_Failure &e) {
+            msg = e.GetMessageString();
+            if (msg.empty())
+                msg = "Unknown OCC exception";
+        }
+        catch (std::exception &e) {
+            msg = e.what();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            shape = sh;
+            error = msg;
+            data.clear();
+            data.shrink_to_fit();
+            state = Done;
+        }
+        cv.notify_all();
+        return true;
+    }
+
+    void wait() {
+        if (decode())
+            return;
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this]{return state == Done;});
+    }
+
+    void cancel() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (state == Queued)
+            state = Done;
+        applied = true;
+        // a running decode reads the buffer and releases it when done
+        if (state == Done)
+            data.clear();
+        tessellation.clear();
+    }
+};
+
+namespace {
+
+class RestoreRunnable : public QRunnable
+{
+public:
+    explicit RestoreRunnable(std::function<void()> &&func)
+        :func(std::move(func))
+    {}
+
+    virtual void run() {
+        func();
+    }
+
+private:
+    std::function<void()> func;
+};
+
+// The pool is joined when the last document is closed, which the application
+// does before it exits, so that no decoding task runs OCC code at shutdown.
+QThreadPool &restorePool()
+{
+    static QThreadPool pool;
+    static bool initialized = []() {
+        int threads = App::GetApplication().GetParameterGroupByPath(
+                "User parameter:BaseApp/Preferences/Document")->GetInt("RestoreThreads",0);
+        if (threads > 0)
+            pool.setMaxThreadCount(threads);
+        App::GetApplication().signalDeletedDocument.connect([]() {
+            if (App::GetApplication().getDocuments().empty())
+                pool.waitForDone();
+        });
+        return true;
+    }();
+    (void)initialized;
+    return pool;
+}
+
+// The tessellation file stores the triangulation of each face of the shape,
+// the polygons of the face edges on the triangulation, and the 3D polygons of
+// the free edges. The sub-shapes are referred to by their index in the shape
+// map, so the file is only valid for the shape saved along with it.
+const uint32_t TessellationMagic = 0x53534554; // "TESS"
+const uint32_t TessellationVersion = 1;
+
+struct EdgePolygon {
+    int edge;
+    bool reversed;
+    Handle(Poly_PolygonOnTriangulation) polygon;
+};
+
+struct FaceTessellation {
+    Handle(Poly_Triangulation) mesh;
+    std::vector<EdgePolygon> edges;
+};
+
+void writeTessellation(std::ostream &s, const TopoDS_Shape &shape,
+                       double deflection, double angularDeflection)
+{
+    Base::OutputStream str(s);
+
+    TopTools_IndexedMapOfShape faceMap, edgeMap;
+    TopExp::MapShapes(shape, TopAbs_FACE, faceMap);
+    TopExp::MapShapes(shape, TopAbs_EDGE, edgeMap);
+
+    str << TessellationMagic << TessellationVersion << deflection << angularDeflection
+        << (int32_t)faceMap.Extent() << (int32_t)edgeMap.Extent();
+
+    std::vector<bool> faceEdges(edgeMap.Extent()+1, false);
+    for (int i=1; i<=faceMap.Extent(); ++i) {
+        const TopoDS_Face &face = TopoDS::Face(faceMap(i));
+        for (TopExp_Explorer xp(face, TopAbs_EDGE); xp.More(); xp.Next())
+            faceEdges[edgeMap.FindIndex(xp.Current())] = true;
+
+        TopLoc_Location loc;
+        Handle(Poly_Triangulation) mesh = BRep_Tool::Triangulation(face, loc);
+        if (mesh.IsNull() || mesh->NbTriangles() == 0) {
+            str << (int32_t)0;
+            continue;
+        }
+
+        const TColgp_Array1OfPnt &nodes = mesh->Nodes();
+        const Poly_Array1OfTriangle &triangles = mesh->Triangles();
+        str << (int32_t)mesh->NbNodes() << (int32_t)mesh->NbTriangles()
+            << (double)mesh->Deflection() << (bool)mesh->HasUVNodes();
+        for (int j=nodes.Lower(); j<=nodes.Upper(); ++j) {
+            const gp_Pnt &pnt = nodes(j);
+            str << pnt.X() << pnt.Y() << pnt.Z();
+        }
+        if (mesh->HasUVNodes()) {
+            const TColgp_Array1OfPnt2d &uvs = mesh->UVNodes();
+            for (int j=uvs.Lower(); j<=uvs.Upper(); ++j)
+                str << uvs(j).X() << uvs(j).Y();
+        }
+        for (int j=triangles.Lower(); j<=triangles.Upper(); ++j) {
+            Standard_Integer n1, n2, n3;
+            triangles(j).Get(n1, n2, n3);
+            str << (int32_t)n1 << (int32_t)n2 << (int32_t)n3;
+        }
+
+        std::vector<EdgePolygon> polygons;
+        for (TopExp_Explorer xp(face, TopAbs_EDGE); xp.More(); xp.Next()) {
+            const TopoDS_Edge &edge = TopoDS::Edge(xp.Current());
+            Handle(Poly_PolygonOnTriangulation) polygon =
+                BRep_Tool::PolygonOnTriangulation(edge, mesh, loc);
+            if (!polygon.IsNull())
+                polygons.push_back({edgeMap.FindIndex(edge),
+                                    edge.Orientation() == TopAbs_REVERSED, polygon});
+        }
+        str << (int32_t)polygons.size();
+        for (auto &info : polygons) {
+            const TColStd_Array1OfInteger &indices = info.polygon->Nodes();
+            str << (int32_t)info.edge << info.reversed << (int32_t)info.polygon->NbNodes()
+                << (double)info.polygon->Deflection() << (bool)info.polygon->HasParameters();
+            for (int j=indices.Lower(); j<=indices.Upper(); ++j)
+                str << (int32_t)indices(j);
+            if (info.polygon->HasParameters()) {
+                const TColStd_Array1OfReal &params = info.polygon->Parameters()->Array1();
+                for (int j=params.Lower(); j<=params.Upper(); ++j)
+                    str << (double)params(j);
+            }
+        }
+    }
+
+    std::vector<int> freeEdges;
+    for (int i=1; i<=edgeMap.Extent(); ++i) {
+        TopLoc_Location loc;
+        if (!faceEdges[i] && !BRep_Tool::Polygon3D(TopoDS::Edge(edgeMap(i)), loc).IsNull())
+            freeEdges.push_back(i);
+    }
+    str << (int32_t)freeEdges.size();
+    for (int idx : freeEdges) {
+        const TopoDS_Edge &edge = TopoDS::Edge(edgeMap(idx));
+        TopLoc_Location loc;
+        Handle(Poly_Polygon3D) polygon = BRep_Tool::Polygon3D(edge, loc);
+        // store the nodes relative to the edge location
+        gp_Trsf trsf = loc.Predivided(edge.Location()).Transformation();
+        const TColgp_Array1OfPnt &nodes = polygon->Nodes();
+        str << (int32_t)idx << (int32_t)polygon->NbNodes()
+            << (double)polygon->Deflection() << (bool)polygon->HasParameters();
+        for (int j=nodes.Lower(); j<=nodes.Upper(); ++j) {
+            gp_Pnt pnt = nodes(j).Transformed(trsf);
+            str << pnt.X() << pnt.Y() << pnt.Z();
+        }
+        if (polygon->HasParameters()) {
+            const TColStd_Array1OfReal &params = polygon->Parameters();
+            for (int j=params.Lower(); j<=params.Upper(); ++j)
+                str << (double)params(j);
+        }
+    }
+}
+
+bool readTessellation(std::istream &s, const TopoDS_Shape &shape,
+                      double &deflection, double &angularDeflection)
+{
+    Base::InputStream str(s);
+
+    TopTools_IndexedMapOfShape faceMap, edgeMap;
+    TopExp::MapShapes(shape, TopAbs_FACE, faceMap);
+    TopExp::MapShapes(shape, TopAbs_EDGE, edgeMap);
+
+    uint32_t magic = 0, version = 0;
+    int32_t faceCount = 0, edgeCount = 0;
+    str >> magic >> version >> deflection >> angularDeflection >> faceCount >> edgeCount;
+    if (!str || magic != TessellationMagic || version != TessellationVersion) {
+        FC_WARN("Unknown tessellation file format");
+        return false;
+    }
+    if (faceCount != faceMap.Extent() || edgeCount != edgeMap.Extent()) {
+        FC_WARN("Tessellation does not match the shape");
+        return false;
+    }
+
+    auto checkEdge = [&](int32_t idx) {
+        if (idx < 1 || idx > edgeCount)
+            FC_THROWM(Base::FileException, "Invalid edge index in tessellation file");
+    };
+
+    // Read everything before modifying the shape
+    std::vector<FaceTessellation> faces(faceCount);
+    for (auto &face : faces) {
+        int32_t nbNodes = 0, nbTriangles = 0;
+        str >> nbNodes;
+        if (nbNodes <= 0)
+            continue;
+        double faceDeflection;
+        bool hasUV;
+        str >> nbTriangles >> faceDeflection >> hasUV;
+        if (!str || nbTriangles <= 0)
+            FC_THROWM(Base::FileException, "Invalid tessellation file");
+
+        TColgp_Array1OfPnt nodes(1, nbNodes);
+        for (int j=1; j<=nbNodes; ++j) {
+            double x, y, z;
+            str >> x >> y >> z;
+            nodes(j).SetCoord(x, y, z);
+        }
+        TColgp_Array1OfPnt2d uvs(1, hasUV ? nbNodes : 1);
+        if (hasUV) {
+            for (int j=1; j<=nbNodes; ++j) {
+                double u, v;
+                str >> u >> v;
+                uvs(j).SetCoord(u, v);
+            }
+        }
+        Poly_Array1OfTriangle triangles(1, nbTriangles);
+        for (int j=1; j<=nbTriangles; ++j) {
+            int32_t n1, n2, n3;
+            str >> n1 >> n2 >> n3;
+            if (n1 < 1 || n1 > nbNodes || n2 < 1 || n2 > nbNodes || n3 < 1 || n3 > nbNodes)
+                FC_THROWM(Base::FileException, "Invalid node index in tessellation file");
+            triangles(j).Set(n1, n2, n3);
+        }
+        if (hasUV)
+            face.mesh = new Poly_Triangulation(nodes, uvs, triangles);
+        else
+            face.mesh = new Poly_Triangulation(nodes, triangles);
+        face.mesh->Deflection(faceDeflection);
+
+        int32_t count = 0;
+        str >> count;
+        for (int32_t k=0; k<count && str; ++k) {
+            int32_t idx = 0, nbIndices = 0;
+            double polyDeflection;
+            bool reversed, hasParams;
+            str >> idx >> reversed >> nbIndices >> polyDeflection >> hasParams;
+            checkEdge(idx);
+            if (nbIndices <= 0)
+                FC_THROWM(Base::FileException, "Invalid tessellation file");
+            TColStd_Array1OfInteger indices(1, nbIndices);
+            for (int j=1; j<=nbIndices; ++j) {
+                int32_t n;
+                str >> n;
+                if (n < 1 || n > nbNodes)
+                    FC_THROWM(Base::FileException, "Invalid node index in tessellation file");
+                indices(j) = n;
+            }
+            Handle(Poly_PolygonOnTriangulation) polygon;
+            if (hasParams) {
+                TColStd_Array1OfReal params(1, nbIndices);
+                for (int j=1; j<=nbIndices; ++j)
+                    str >> params(j);
+                polygon = new Poly_PolygonOnTriangulation(indices, params);
+            }
+            else
+                polygon = new Poly_PolygonOnTriangulation(indices);
+            polygon->Deflection(polyDeflection);
+            face.edges.push_back({idx, reversed, polygon});
+        }
+    }
+
+    int32_t count = 0;
+    str >> count;
+    std::vector<std::pair<int, Handle(Poly_Polygon3D)> > freeEdges;
+    for (int32_t k=0; k<count && str; ++k) {
+        int32_t idx = 0, nbNodes = 0;
+        double polyDeflection;
+        bool hasParams;
+        str >> idx >> nbNodes >> polyDeflection >> hasParams;
+        checkEdge(idx);
+        if (nbNodes <= 0)
+            FC_THROWM(Base::FileException, "Invalid tessellation file");
+        TColgp_Array1OfPnt nodes(1, nbNodes);
+        for (int j=1; j<=nbNodes; ++j) {
+            double x, y, z;
+            str >> x >> y >> z;
+            nodes(j).SetCoord(x, y, z);
+        }
+        Handle(Poly_Polygon3D) polygon;
+        if (hasParams) {
+            TColStd_Array1OfReal params(1, nbNodes);
+            for (int j=1; j<=nbNodes; ++j)
+                str >> params(j);
+            polygon = new Poly_Polygon3D(nodes, params);
+        }
+        else
+            polygon = new Poly_Polygon3D(nodes);
+        polygon->Deflection(polyDeflection);
+        freeEdges.emplace_back(idx, polygon);
+    }
+    if (!str)
+        FC_THROWM(Base::FileException, "Truncated tessellation file");
+
+    BRep_Builder builder;
+    for (int i=1; i<=faceCount; ++i) {
+        auto &info = faces[i-1];
+        if (info.mesh.IsNull())
+            continue;
+        const TopoDS_Face &face = TopoDS::Face(faceMap(i));
+        builder.UpdateFace(face, info.mesh);
+
+        // Closed edges have separate polygons for each orientation
+        std::map<int, std::pair<Handle(Poly_PolygonOnTriangulation),
+                                Handle(Poly_PolygonOnTriangulation)> > polygons;
+        for (auto &edge : info.edges) {
+            auto &entry = polygons[edge.edge];
+            (edge.reversed ? entry.second : entry.first) = edge.polygon;
+        }
+        for (auto &v : polygons) {
+            const TopoDS_Edge &edge = TopoDS::Edge(edgeMap(v.first));
+            if (!v.second.first.IsNull() && !v.second.second.IsNull())
+                builder.UpdateEdge(edge, v.second.first, v.second.second, info.mesh, face.Location());
+            else
+                builder.UpdateEdge(edge, v.second.first.IsNull() ? v.second.second : v.second.first,
+                                   info.mesh, face.Location());
+        }
+    }
+    for (auto &info : freeEdges) {
+        const TopoDS_Edge &edge = TopoDS::Edge(edgeMap(info.first));
+        builder.UpdateEdge(edge, info.second, edge.Location());
+    }
+    return true;
+}
+
+void loadTessellation(std::istream &s, const TopoDS_Shape &shape, const std::string &fileName,
+                      double &deflection, double &angularDeflection)
+{
+    std::string msg;
+    try {
+        if (readTessellation(s, shape, deflection, angularDeflection))
+            return;
+    }
+    catch (Standard_Failure &e) {
+        msg = e.GetMessageString();
+    }
+    catch (Base::Exception &e) {
+        msg = e.what();
+    }
+    catch (std::exception &e) {
+        msg = e.what();
+    }
+    if (msg.size())
+        FC_ERR("Reading failed from embedded file: " << fileName << ", " << msg);
+    deflection = 0.0;
+    angularDeflection = 0.0;
+}
+
+} // anonymous namespace
+
 PropertyPartShape::PropertyPartShape()
+    :_Tessellation(this)
 {
 }
 
 PropertyPartShape::~PropertyPartShape()
 {
+    cancelPending();
+}
+
+bool PropertyPartShape::isRestorePending() const
+{
+    return !!std::atomic_load(&_Pending);
+}
+
+void PropertyPartShape::restorePending() const
+{
+    auto pending = std::atomic_load(&_Pending);
+    if (!pending)
+        return;
+
+    pending->wait();
+
+    std::lock_guard<std::mutex> lock(pending->mutex);
+    if (pending->applied)
+        return;
+    pending->applied = true;
+
+    if (pending->error.size()) {
+        FC_ERR("Reading failed from embedded file: " << pending->fileName
+                << ", " << pending->error);
+    }
+
+    // Same as RestoreDocFile() below, except that no change is signaled,
+    // because the property is considered restored already
+    auto elementMap = _Shape.resetElementMap();
+    auto hasher = _Shape.Hasher;
+    long tag = _Shape.Tag;
+    TopoShape shape;
+    shape.setShape(pending->shape);
+    shape.Hasher = hasher;
+    shape.resetElementMap(elementMap);
+    shape.Tag = tag;
+    _Shape = shape;
+    pending->shape.Nullify();
+
+    if (pending->tessellation.size()) {
+        std::istringstream iss(pending->tessellation);
+        loadTessellation(iss, _Shape.getShape(), pending->fileName,
+                         _TessDeflection, _TessAngularDeflection);
+        pending->tessellation.clear();
+    }
+
+    std::atomic_store(&_Pending, std::shared_ptr<PendingRestore>());
+}
+
+void PropertyPartShape::cancelPending()
+{
+    auto pending = std::atomic_load(&_Pending);
+    if (pending) {
+        pending->cancel();
+        std::atomic_store(&_Pending, std::shared_ptr<PendingRestore>());
+    }
 }
 
 void PropertyPartShape::setValue(const TopoShape& sh)
 {
     aboutToSetValue();
+    cancelPending();
+    resetTessellationParams();
     _Shape = sh;
     auto obj = dynamic_cast<App::DocumentObject*>(getContainer());
     if(obj) {
@@ -109,6 +645,8 @@ void PropertyPartShape::setValue(const TopoShape& sh)
 void PropertyPartShape::setValue(const TopoDS_Shape& sh, bool resetElementMap)
 {
     aboutToSetValue();
+    cancelPending();
+    resetTessellationParams();
     auto obj = dynamic_cast<App::DocumentObject*>(getContainer());
     if(obj)
         _Shape.Tag = obj->getID();
@@ -119,23 +657,27 @@ void PropertyPartShape::setValue(const TopoDS_Shape& sh, bool resetElementMap)
 
 const TopoDS_Shape& PropertyPartShape::getValue(void)const
 {
+    restorePending();
     return _Shape.getShape();
 }
 
 const TopoShape& PropertyPartShape::getShape() const
 {
+    restorePending();
     _Shape.initCache(-1);
     return this->_Shape;
 }
 
 const Data::ComplexGeoData* PropertyPartShape::getComplexData() const
 {
+    restorePending();
     _Shape.initCache(-1);
     return &(this->_Shape);
 }
 
 Base::BoundBox3d PropertyPartShape::getBoundingBox() const
 {
+    restorePending();
     Base::BoundBox3d box;
     if (_Shape.getShape().IsNull())
         return box;
@@ -162,13 +704,39 @@ Base::BoundBox3d PropertyPartShape::getBoundingBox() const
 
 void PropertyPartShape::transformGeometry(const Base::Matrix4D &rclTrf)
 {
+    restorePending();
     aboutToSetValue();
+    resetTessellationParams();
     _Shape.transformGeometry(rclTrf);
     hasSetValue();
 }
 
+void PropertyPartShape::setTessellationParams(double deflection, double angularDeflection) const
+{
+    restorePending();
+    _TessDeflection = deflection;
+    _TessAngularDeflection = angularDeflection;
+}
+
+bool PropertyPartShape::getTessellationParams(double &deflection, double &angularDeflection) const
+{
+    restorePending();
+    if (_TessDeflection <= 0.0)
+        return false;
+    deflection = _TessDeflection;
+    angularDeflection = _TessAngularDeflection;
+    return true;
+}
+
+void PropertyPartShape::resetTessellationParams()
+{
+    _TessDeflection = 0.0;
+    _TessAngularDeflection = 0.0;
+}
+
 PyObject *PropertyPartShape::getPyObject(void)
 {
+    restorePending();
     auto prop = static_cast<Base::PyObjectBase*>(Py::new_reference_to(shape2pyshape(_Shape)));
     if (prop) prop->setConst();
     return prop;
@@ -202,8 +770,19 @@ void PropertyPartShape::setPyObject(PyObject *value)
 
 App::Property *PropertyPartShape::Copy(void) const
 {
+    restorePending();
     PropertyPartShape *prop = new PropertyPartShape();
-    prop->_Shape = this->_Shape.makECopy();
+    // The shape is not modified in place once it is assigned to the property,
+    // so the copy taken for undo/redo can share the geometry and triangulation.
+    if (App::GetApplication().GetParameterGroupByPath
+            ("User parameter:BaseApp/Preferences/Mod/Part/General")->GetBool("CopyShapeOnUndo", false)) {
+        prop->_Shape = this->_Shape.makECopy();
+    }
+    else {
+        prop->_Shape = this->_Shape;
+        prop->_TessDeflection = this->_TessDeflection;
+        prop->_TessAngularDeflection = this->_TessAngularDeflection;
+    }
     prop->_Ver = this->_Ver;
     return prop;
 }
@@ -212,14 +791,23 @@ void PropertyPartShape::Paste(const App::Property &from)
 {
     auto prop = Base::freecad_dynamic_cast<const PropertyPartShape>(&from);
     if(prop) {
-        setValue(prop->_Shape);
+        setValue(prop->getShape());
         _Ver = prop->_Ver;
+        // The triangulation is shared with the source shape
+        _TessDeflection = prop->_TessDeflection;
+        _TessAngularDeflection = prop->_TessAngularDeflection;
     }
 }
 
 unsigned int PropertyPartShape::getMemSize (void) const
 {
-    return _Shape.getMemSize();
+    unsigned int size = _Shape.getMemSize();
+    auto pending = std::atomic_load(&_Pending);
+    if (pending) {
+        std::lock_guard<std::mutex> lock(pending->mutex);
+        size += pending->data.size();
+    }
+    return size;
 }
 
 void PropertyPartShape::getPaths(std::vector<App::ObjectIdentifier> &paths) const
@@ -240,6 +828,9 @@ static void BRepTools_Write(const TopoDS_Shape& Sh, Standard_OStream& S);
 
 void PropertyPartShape::Save (Base::Writer &writer) const
 {
+    // Materialize here, because SaveDocFile() may be called in a worker thread
+    restorePending();
+
     //See SaveDocFile(), RestoreDocFile()
     writer.Stream() << writer.ind() << "<Part";
     bool saveHasher=false;
@@ -264,9 +855,16 @@ void PropertyPartShape::Save (Base::Writer &writer) const
     bool binary = writer.getMode("BinaryBrep");
     bool toXML = writer.getFileVersion()>1 && writer.isForceXML()>=(binary?3:2);
     if(!toXML) {
-        writer.Stream() << " file=\""
-            << writer.addFile(getFileName(binary?".bin":".brp"), this)
-            << "\"/>\n";
+        std::string file = writer.addFile(getFileName(binary?".bin":".brp"), this);
+        writer.Stream() << " file=\"" << file << '"';
+        if (_TessDeflection > 0.0 && !_Shape.isNull()
+                && App::GetApplication().GetParameterGroupByPath(
+                    "User parameter:BaseApp/Preferences/Mod/Part/General")->GetBool("SaveTessellation", false))
+        {
+            writer.Stream() << " tessellation=\""
+                << writer.addFile(getFileName(".tess"), &_Tessellation) << '"';
+        }
+        writer.Stream() << "/>\n";
     } else if(binary) {
         writer.Stream() << " binary=\"1\">\n";
         TopoShape shape;
@@ -321,6 +919,13 @@ void PropertyPartShape::Restore(Base::XMLReader &reader)
         if (!file.empty()) {
             // initiate a file read
             reader.addFile(file.c_str(),this);
+
+            // The tessellation file must be read after the shape file
+            if (reader.hasAttribute("tessellation")) {
+                file = reader.getAttribute("tessellation");
+                if (!file.empty())
+                    reader.addFile(file.c_str(),&_Tessellation);
+            }
         }
     } else if(reader.getAttributeAsInteger("binary","")) {
         TopoShape shape;
@@ -377,6 +982,7 @@ void PropertyPartShape::Restore(Base::XMLReader &reader)
     }
 
     aboutToSetValue();
+    resetTessellationParams();
     _Shape.setShape(sh,false);
     hasSetValue();
 }
@@ -434,6 +1040,7 @@ void PropertyPartShape::SaveDocFile (Base::Writer &writer) const
     // if (_Shape.getShape().IsNull())
     //     return;
 
+    restorePending();
     TopoDS_Shape myShape = _Shape.getShape();
     if(writer.getMode("BinaryBrep")) {
         TopoShape shape;
@@ -497,13 +1104,75 @@ void PropertyPartShape::SaveDocFile (Base::Writer &writer) const
     }
 }
 
+void PropertyPartShape::saveTessellation(Base::Writer &writer) const
+{
+    writeTessellation(writer.Stream(), _Shape.getShape(),
+                      _TessDeflection, _TessAngularDeflection);
+}
+
+void PropertyPartShape::restoreTessellation(Base::Reader &reader)
+{
+    auto pending = std::atomic_load(&_Pending);
+    if (pending) {
+        std::lock_guard<std::mutex> lock(pending->mutex);
+        if (!pending->applied) {
+            // Attach the triangulation when the shape is materialized
+            std::ostringstream ss;
+            if (reader.peek() != EOF)
+                ss << reader.rdbuf();
+            pending->tessellation = ss.str();
+            return;
+        }
+    }
+    loadTessellation(reader, _Shape.getShape(), reader.getFileName(),
+                     _TessDeflection, _TessAngularDeflection);
+}
+
+bool PropertyPartShape::canSaveDocFileConcurrently() const
+{
+    // The indirect access goes through a shared temporary file
+    return App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Part/General")->GetBool("DirectAccess", true);
+}
+
 void PropertyPartShape::RestoreDocFile(Base::Reader &reader)
 {
+    cancelPending();
+
+    Base::FileInfo brep(reader.getFileName());
+
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath(
+            "User parameter:BaseApp/Preferences/Document");
+    if (hGrp->GetBool("LazyRestore", false)
+            && (brep.hasExtension("bin")
+                || App::GetApplication().GetParameterGroupByPath(
+                    "User parameter:BaseApp/Preferences/Mod/Part/General")->GetBool("DirectAccess", true)))
+    {
+        // Only buffer the file content here. Decoding is done by the
+        // background threads, or on first access of the shape. zipios reads
+        // the archive sequentially and cannot seek back to an entry later, so
+        // the decompressed content is kept in memory instead of the entry
+        // location. The buffer is released as soon as the shape is decoded.
+        auto pending = std::make_shared<PendingRestore>();
+        pending->binary = brep.hasExtension("bin");
+        pending->fileName = reader.getFileName();
+        pending->data.assign(std::istreambuf_iterator<char>(reader),
+                             std::istreambuf_iterator<char>());
+
+        aboutToSetValue();
+        auto obj = dynamic_cast<App::DocumentObject*>(getContainer());
+        if(obj)
+            _Shape.Tag = obj->getID();
+        std::atomic_store(&_Pending, pending);
+        restorePool().start(new RestoreRunnable([pending]() {pending->decode();}));
+        hasSetValue();
+        return;
+    }
+
     // save the element map
     auto elementMap = _Shape.resetElementMap();
     auto hasher = _Shape.Hasher;
 
-    Base::FileInfo brep(reader.getFileName());
     TopoShape shape;
     if (brep.hasExtension("bin")) {
         shape.importBinary(reader);
@@ -29,6 +29,7 @@
 #include <App/DocumentObject.h>
 #include <App/PropertyGeo.h>
 #include <map>
+#include <memory>
 #include <vector>
 
 class BRepBuilderAPI_MakeShape;
@@ -84,6 +85,7 @@ public:
 
     void SaveDocFile (Base::Writer &writer) const;
     void RestoreDocFile(Base::Reader &reader);
+    bool canSaveDocFileConcurrently() const;
 
     App::Property *Copy(void) const;
     void Paste(const App::Property &from);
@@ -96,9 +98,73 @@ public:
     virtual std::string getElementMapVersion(bool restored=false) const override;
     void resetElementMapVersion() {_Ver.clear();}
 
+    /** Check whether the shape content is still being restored
+     *
+     * If parameter 'LazyRestore' in Preferences/Document is enabled, the
+     * shape file content is only buffered in RestoreDocFile(), and decoded
+     * in background threads. The shape is materialized on first access, and
+     * the caller waits for the decoding if necessary.
+     */
+    bool isRestorePending() const;
+
+    /** @name Tessellation cache */
+    //@{
+    /** Record the parameters used to tessellate the current shape
+     *
+     * @param deflection: the absolute linear deflection
+     * @param angularDeflection: the angular deflection in radians
+     *
+     * This is called by the view provider after meshing the shape. If
+     * parameter 'SaveTessellation' in Preferences/Mod/Part/General is
+     * enabled, the triangulation of the shape is saved to a separate file
+     * along with the shape, and is attached to the shape again on restore,
+     * so that the view provider can skip meshing if the parameters match.
+     * The parameters are reset on any change of the shape.
+     */
+    void setTessellationParams(double deflection, double angularDeflection) const;
+    /// Obtain the recorded tessellation parameters. Return false if there is none.
+    bool getTessellationParams(double &deflection, double &angularDeflection) const;
+    //@}
+
+private:
+    /// Materialize the lazily restored shape, if any
+    void restorePending() const;
+    /// Discard the lazily restored shape, if any
+    void cancelPending();
+
+    void saveTessellation(Base::Writer &writer) const;
+    void restoreTessellation(Base::Reader &reader);
+    void resetTessellationParams();
+
+    /// Helper to save the triangulation of the shape in its own file
+    class TessellationFile : public Base::Persistence
+    {
+    public:
+        explicit TessellationFile(PropertyPartShape *prop)
+            :owner(prop)
+        {}
+
+        unsigned int getMemSize (void) const {return 0;}
+        void Save (Base::Writer &) const {}
+        void Restore(Base::XMLReader &) {}
+        void SaveDocFile (Base::Writer &writer) const {owner->saveTessellation(writer);}
+        void RestoreDocFile(Base::Reader &reader) {owner->restoreTessellation(reader);}
+        bool canSaveDocFileConcurrently() const {return true;}
+
+    private:
+        PropertyPartShape *owner;
+    };
+
 private:
-    TopoShape _Shape;
+    mutable TopoShape _Shape;
     std::string _Ver;
+
+    struct PendingRestore;
+    mutable std::shared_ptr<PendingRestore> _Pending;
+
+    TessellationFile _Tessellation;
+    mutable double _TessDeflection = 0.0;
+    mutable double _TessAngularDeflection = 0.0;
 };
 
 struct PartExport ShapeHistory {
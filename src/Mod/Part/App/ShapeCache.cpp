@@ -0,0 +1,541 @@
+/***************************************************************************
+ *   Copyright (c) 2020 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <sstream>
+# include <Standard_Failure.hxx>
+#endif
+
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <set>
+#include <QCryptographicHash>
+
+#include <Base/Console.h>
+#include <Base/Exception.h>
+#include <Base/FileInfo.h>
+#include <Base/Reader.h>
+#include <Base/Stream.h>
+#include <Base/Tools.h>
+#include <Base/Writer.h>
+#include <App/Application.h>
+#include <App/Document.h>
+#include <App/DocumentObject.h>
+
+#include "PartFeature.h"
+#include "ShapeCache.h"
+
+FC_LOG_LEVEL_INIT("ShapeCache",true,true);
+
+using namespace Part;
+
+static std::mutex _ShapeCacheMutex;
+
+static const char *_ShapeCacheMagic = "FCShapeCache";
+static const int _ShapeCacheVersion = 1;
+
+ShapeCache::ShapeCache()
+{
+}
+
+ShapeCache &ShapeCache::instance()
+{
+    // The feature recompute may run in several threads, and the
+    // initialization of a local static is guaranteed to happen only once.
+    static ShapeCache inst;
+    return inst;
+}
+
+namespace {
+// Removes the temporary file of a cache entry on any exit path, unless it
+// has been renamed to the entry
+struct TempFileGuard {
+    Base::FileInfo fi;
+    bool released = false;
+
+    TempFileGuard(const std::string &name)
+        :fi(name)
+    {}
+
+    ~TempFileGuard() {
+        if(!released && fi.exists() && !fi.deleteFile())
+            FC_WARN("Failed to remove temporary shape cache entry " << fi.filePath());
+    }
+};
+}
+
+static ParameterGrp::handle getParameters()
+{
+    return App::GetApplication().GetParameterGroupByPath(
+            "User parameter:BaseApp/Preferences/Mod/Part/General");
+}
+
+bool ShapeCache::isEnabled() const
+{
+    return getParameters()->GetBool("ShapeCache",false);
+}
+
+std::string ShapeCache::getDirectory() const
+{
+    std::string dir = getParameters()->GetASCII("ShapeCacheDir","");
+    if(dir.empty())
+        dir = App::Application::getUserAppDataDir() + "ShapeCache";
+    if(dir.back()!='/' && dir.back()!='\\')
+        dir += "/";
+    return dir;
+}
+
+std::string ShapeCache::getFileName(const std::string &key) const
+{
+    return _dir + key + ".fcsc";
+}
+
+void ShapeCache::init()
+{
+    std::string dir = getDirectory();
+    if(_inited && dir == _dir)
+        return;
+
+    _inited = true;
+    _dir = dir;
+    _entries.clear();
+    _entryMap.clear();
+
+    Base::FileInfo fi(_dir);
+    if(!fi.exists() && !fi.createDirectory()) {
+        FC_ERR("Failed to create shape cache directory " << _dir);
+        return;
+    }
+
+    // Seed the LRU list with the existing entries, ordered by their
+    // modification time
+    std::vector<std::pair<Base::TimeInfo, Base::FileInfo> > files;
+    for(auto &file : fi.getDirectoryContent()) {
+        if(!file.isFile())
+            continue;
+        if(file.extension() == "fcsc")
+            files.emplace_back(file.lastModified(), file);
+        else if(file.completeExtension() == "fcsc.tmp") {
+            // left behind by a store that was interrupted
+            file.deleteFile();
+        }
+    }
+    std::sort(files.begin(), files.end(),
+        [](const std::pair<Base::TimeInfo, Base::FileInfo> &a,
+           const std::pair<Base::TimeInfo, Base::FileInfo> &b)
+        {
+            return a.first < b.first;
+        });
+    for(auto &v : files)
+        touchEntry(v.second.fileNamePure(), v.second.size());
+    evict();
+}
+
+void ShapeCache::touchEntry(const std::string &key, unsigned long long size)
+{
+    auto it = _entryMap.find(key);
+    if(it != _entryMap.end()) {
+        _stats.size -= it->second->size;
+        _entries.erase(it->second);
+    }
+    _stats.size += size;
+    _entries.push_back(Entry{key,size});
+    _entryMap[key] = std::prev(_entries.end());
+}
+
+void ShapeCache::evict()
+{
+    unsigned long long limit = (unsigned long long)std::max(
+            0L, getParameters()->GetInt("ShapeCacheSize",1024)) * 1024 * 1024;
+    while(_entries.size() && _stats.size > limit) {
+        auto &entry = _entries.front();
+        Base::FileInfo fi(getFileName(entry.key));
+        if(fi.exists() && !fi.deleteFile())
+            FC_WARN("Failed to remove shape cache entry " << fi.filePath());
+        _stats.size -= entry.size;
+        ++_stats.evictions;
+        _entryMap.erase(entry.key);
+        _entries.pop_front();
+    }
+}
+
+ShapeCache::Stats ShapeCache::getStats(bool reset)
+{
+    std::lock_guard<std::mutex> lock(_ShapeCacheMutex);
+    init();
+    Stats stats = _stats;
+    stats.entries = _entries.size();
+    if(reset) {
+        _stats.hits = 0;
+        _stats.misses = 0;
+        _stats.stores = 0;
+        _stats.evictions = 0;
+        _stats.errors = 0;
+    }
+    return stats;
+}
+
+void ShapeCache::clear()
+{
+    std::lock_guard<std::mutex> lock(_ShapeCacheMutex);
+    init();
+    for(auto &entry : _entries) {
+        Base::FileInfo fi(getFileName(entry.key));
+        if(fi.exists())
+            fi.deleteFile();
+    }
+    _entries.clear();
+    _entryMap.clear();
+    _stats.size = 0;
+}
+
+static std::string getElementMapText(const TopoShape &shape)
+{
+    Base::StringWriter writer;
+    if(!shape.getElementMapSize())
+        writer.Stream() << "0\n";
+    else
+        shape.Data::ComplexGeoData::SaveDocFile(writer);
+    return writer.getString();
+}
+
+std::string ShapeCache::hashShape(const TopoShape &shape)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    std::ostringstream ss;
+    TopoShape(shape).exportBinary(ss);
+    const std::string &data = ss.str();
+    hash.addData(data.c_str(), (int)data.size());
+    std::string map = getElementMapText(shape);
+    hash.addData(map.c_str(), (int)map.size());
+    return hash.result().toHex().constData();
+}
+
+std::string ShapeCache::getKey(const Feature *feature) const
+{
+    if(!feature || !feature->getNameInDocument()
+                || feature->hasExtensions()
+                || feature->getPropertyByName("Proxy"))
+        return std::string();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    auto addData = [&hash](const std::string &s) {
+        hash.addData(s.c_str(), (int)s.size()+1);
+    };
+
+    std::ostringstream ss;
+    ss << _ShapeCacheVersion << ' ' << feature->getTypeId().getName()
+       << ' ' << feature->getID()
+       << ' ' << feature->Shape.getShape().getElementMapVersion();
+    addData(ss.str());
+
+    std::map<std::string,App::Property*> props;
+    feature->getPropertyMap(props);
+    for(auto &v : props) {
+        auto prop = v.second;
+        if(prop == &feature->Shape
+                || prop == &feature->Label
+                || prop == &feature->Label2
+                || prop == &feature->Visibility
+                || prop == &feature->ExpressionEngine
+                || prop == &feature->ColoredElements
+                || prop->testStatus(App::Property::Output)
+                || prop->testStatus(App::Property::Transient)
+                || (feature->getPropertyType(prop) & (App::Prop_Output|App::Prop_Transient)))
+            continue;
+        Base::StringWriter writer;
+        writer.setForceXML(true);
+        prop->Save(writer);
+        // Properties that save into separate files are not supported
+        if(writer.getFilenames().size())
+            return std::string();
+        addData(v.first);
+        addData(writer.getString());
+    }
+
+    for(auto obj : feature->getOutList(App::DocumentObject::OutListNoExpression)) {
+        if(!obj->isDerivedFrom(Feature::getClassTypeId()))
+            return std::string();
+        std::ostringstream ss;
+        ss << obj->getID() << ' '
+           << static_cast<const Feature*>(obj)->getShapeContentKey();
+        addData(ss.str());
+    }
+    return hash.result().toHex().constData();
+}
+
+bool ShapeCache::restore(const std::string &key, Feature *feature)
+{
+    std::lock_guard<std::mutex> lock(_ShapeCacheMutex);
+    init();
+
+    auto it = _entryMap.find(key);
+    if(it == _entryMap.end()) {
+        ++_stats.misses;
+        return false;
+    }
+
+    Base::FileInfo fi(getFileName(key));
+    try {
+        Base::ifstream file(fi, std::ios::in | std::ios::binary);
+        if(!file)
+            throw Base::FileException("Failed to open shape cache entry", fi);
+
+        std::string magic;
+        int version = 0;
+        if(!(file >> magic >> version) || magic!=_ShapeCacheMagic || version!=_ShapeCacheVersion)
+            throw Base::RuntimeError("Invalid shape cache entry");
+
+        auto hasher = feature->getDocument()->getStringHasher();
+        std::size_t count = 0;
+        file >> count;
+        for(std::size_t i=0;i<count;++i) {
+            long id;
+            int binary, hashed;
+            std::string hex;
+            if(!(file >> id >> binary >> hashed >> hex))
+                throw Base::RuntimeError("Invalid shape cache entry");
+            // Make sure the string IDs referenced by the element map are
+            // mapped to the same content in the current document. If not,
+            // the entry was created by a different document, or the hasher
+            // has been reset.
+            App::StringIDRef sid;
+            if(hasher)
+                sid = hasher->getID(id);
+            if(!sid || sid->isBinary()!=!!binary || sid->isHashed()!=!!hashed
+                    || sid->data().toHex().constData()!=hex)
+            {
+                FC_LOG("shape cache string id mismatch " << feature->getFullName());
+                ++_stats.misses;
+                return false;
+            }
+        }
+
+        std::size_t mapSize = 0;
+        if(!(file >> mapSize) || file.get()!='\n')
+            throw Base::RuntimeError("Invalid shape cache entry");
+        std::string mapText(mapSize,0);
+        if(mapSize && !file.read(&mapText[0],mapSize))
+            throw Base::RuntimeError("Invalid shape cache entry");
+
+        TopoShape shape(feature->getID(), hasher);
+        shape.importBinary(file);
+        if(shape.isNull())
+            throw Base::RuntimeError("Invalid shape cache entry");
+
+        std::istringstream iss(mapText);
+        Base::Reader reader(iss, fi.filePath());
+        shape.Data::ComplexGeoData::RestoreDocFile(reader);
+
+        Base::ObjectStatusLocker<App::ObjectStatus, App::DocumentObject> guard(App::Recompute, feature);
+        feature->Shape.setValue(shape);
+    }
+    catch (Base::Exception &e) {
+        FC_WARN("Failed to restore shape cache entry " << fi.filePath() << ": " << e.what());
+        ++_stats.errors;
+        ++_stats.misses;
+        return false;
+    }
+    catch (Standard_Failure &e) {
+        FC_WARN("Failed to restore shape cache entry " << fi.filePath() << ": " << e.GetMessageString());
+        ++_stats.errors;
+        ++_stats.misses;
+        return false;
+    }
+
+    touchEntry(key, it->second->size);
+    ++_stats.hits;
+    FC_LOG("shape cache hit " << feature->getFullName() << ' ' << key);
+    return true;
+}
+
+void ShapeCache::store(const std::string &key, const Feature *feature)
+{
+    const TopoShape &shape = feature->Shape.getShape();
+    if(shape.isNull())
+        return;
+
+    std::lock_guard<std::mutex> lock(_ShapeCacheMutex);
+    init();
+
+    try {
+        std::string mapText = getElementMapText(shape);
+
+        // Collect the string IDs referenced by the element map, which has
+        // the format of 'element\tmapped count id id...'
+        std::set<long> ids;
+        std::istringstream iss(mapText);
+        std::string line;
+        std::getline(iss,line);
+        while(std::getline(iss,line)) {
+            std::istringstream ls(line);
+            std::string element, mapped;
+            std::size_t count = 0;
+            ls >> element >> mapped >> count;
+            for(std::size_t i=0;i<count;++i) {
+                long id;
+                if(ls >> id)
+                    ids.insert(id);
+            }
+        }
+
+        auto hasher = feature->getDocument()->getStringHasher();
+        if(ids.size() && !hasher) {
+            FC_LOG("shape cache skip " << feature->getFullName() << ", no string hasher");
+            return;
+        }
+
+        std::ostringstream ss;
+        ss << ids.size() << '\n';
+        for(long id : ids) {
+            auto sid = hasher->getID(id);
+            if(!sid) {
+                FC_LOG("shape cache skip " << feature->getFullName() << ", unknown string id " << id);
+                return;
+            }
+            ss << id << ' ' << (sid->isBinary()?1:0) << ' ' << (sid->isHashed()?1:0)
+               << ' ' << sid->data().toHex().constData() << '\n';
+        }
+        writeEntry(key, ss.str(), mapText, shape);
+    }
+    catch (Base::Exception &e) {
+        FC_WARN("Failed to store shape cache entry " << key << ": " << e.what());
+        ++_stats.errors;
+    }
+    catch (Standard_Failure &e) {
+        FC_WARN("Failed to store shape cache entry " << key << ": " << e.GetMessageString());
+        ++_stats.errors;
+    }
+    catch (std::exception &e) {
+        FC_WARN("Failed to store shape cache entry " << key << ": " << e.what());
+        ++_stats.errors;
+    }
+}
+
+void ShapeCache::writeEntry(const std::string &key, const std::string &idText,
+                            const std::string &mapText, const TopoShape &shape)
+{
+    std::string filename = getFileName(key);
+    TempFileGuard guard(filename + ".tmp");
+    Base::FileInfo &tmp = guard.fi;
+    try {
+        {
+            Base::ofstream file(tmp, std::ios::out | std::ios::binary);
+            if(!file)
+                throw Base::FileException("Failed to create shape cache entry", tmp);
+
+            file << _ShapeCacheMagic << ' ' << _ShapeCacheVersion << '\n';
+            file << idText;
+            file << mapText.size() << '\n';
+            file.write(mapText.c_str(), mapText.size());
+            TopoShape(shape).exportBinary(file);
+            if(!file)
+                throw Base::FileException("Failed to write shape cache entry", tmp);
+        }
+
+        Base::FileInfo fi(filename);
+        if(fi.exists())
+            fi.deleteFile();
+        if(!tmp.renameFile(filename.c_str()))
+            throw Base::FileException("Failed to rename shape cache entry", tmp);
+        guard.released = true;
+
+        touchEntry(key, Base::FileInfo(filename).size());
+        ++_stats.stores;
+        evict();
+    }
+    catch (Base::Exception &e) {
+        FC_WARN("Failed to store shape cache entry " << filename << ": " << e.what());
+        ++_stats.errors;
+    }
+    catch (Standard_Failure &e) {
+        FC_WARN("Failed to store shape cache entry " << filename << ": " << e.GetMessageString());
+        ++_stats.errors;
+    }
+    catch (std::exception &e) {
+        FC_WARN("Failed to store shape cache entry " << filename << ": " << e.what());
+        ++_stats.errors;
+    }
+}
+
+bool ShapeCache::restoreShape(const std::string &key, TopoDS_Shape &shape)
+{
+    std::lock_guard<std::mutex> lock(_ShapeCacheMutex);
+    init();
+
+    auto it = _entryMap.find(key);
+    if(it == _entryMap.end()) {
+        ++_stats.misses;
+        return false;
+    }
+
+    Base::FileInfo fi(getFileName(key));
+    try {
+        Base::ifstream file(fi, std::ios::in | std::ios::binary);
+        if(!file)
+            throw Base::FileException("Failed to open shape cache entry", fi);
+
+        std::string magic;
+        int version = 0;
+        std::size_t count = 0, mapSize = 0;
+        if(!(file >> magic >> version) || magic!=_ShapeCacheMagic || version!=_ShapeCacheVersion
+                || !(file >> count >> mapSize) || count || mapSize || file.get()!='\n')
+            throw Base::RuntimeError("Invalid shape cache entry");
+
+        TopoShape s;
+        s.importBinary(file);
+        if(s.isNull())
+            throw Base::RuntimeError("Invalid shape cache entry");
+        shape = s.getShape();
+    }
+    catch (Base::Exception &e) {
+        FC_WARN("Failed to restore shape cache entry " << fi.filePath() << ": " << e.what());
+        ++_stats.errors;
+        ++_stats.misses;
+        return false;
+    }
+    catch (Standard_Failure &e) {
+        FC_WARN("Failed to restore shape cache entry " << fi.filePath() << ": " << e.GetMessageString());
+        ++_stats.errors;
+        ++_stats.misses;
+        return false;
+    }
+
+    touchEntry(key, it->second->size);
+    ++_stats.hits;
+    FC_LOG("shape cache hit " << key);
+    return true;
+}
+
+void ShapeCache::storeShape(const std::string &key, const TopoDS_Shape &shape)
+{
+    if(shape.IsNull())
+        return;
+
+    std::lock_guard<std::mutex> lock(_ShapeCacheMutex);
+    init();
+    writeEntry(key, "0\n", std::string(), TopoShape(shape));
+}
@@ -0,0 +1,135 @@
+/***************************************************************************
+ *   Copyright (c) 2020 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef PART_SHAPECACHE_H
+#define PART_SHAPECACHE_H
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+class TopoDS_Shape;
+
+namespace Part
+{
+
+class Feature;
+class TopoShape;
+
+/** Persistent on-disk cache of feature shapes
+ *
+ * The cache is content addressed. The key of a feature is the SHA1 hash of
+ * its type, its input property values and the content key of each of its
+ * input shapes (see Feature::getShapeContentKey()). An entry stores the
+ * binary BRep of the resulting shape together with its element map, so that
+ * Feature::recompute() can skip execute() on a cache hit.
+ *
+ * Element map entries reference string IDs of the document StringHasher.
+ * The referenced IDs are stored along with the entry, and an entry is only
+ * reused if the current hasher maps those IDs to the same content.
+ *
+ * The cache is disabled by default, and controlled by the following
+ * parameters in "User parameter:BaseApp/Preferences/Mod/Part/General",
+ *
+ *  - ShapeCache: bool, enables the cache
+ *  - ShapeCacheDir: string, cache directory, default to 'ShapeCache' inside
+ *    the user data directory
+ *  - ShapeCacheSize: int, maximum size of the cache in MB, default 1024. The
+ *    least recently used entries are evicted once exceeded.
+ */
+class PartExport ShapeCache
+{
+public:
+    static ShapeCache &instance();
+
+    /// Check the user parameter whether the cache is enabled
+    bool isEnabled() const;
+
+    /** Compute the cache key of a feature
+     *
+     * @return Return the hex encoded key, or an empty string if the feature
+     * cannot be cached, e.g. because it has non shape inputs.
+     */
+    std::string getKey(const Feature *feature) const;
+
+    /// Try restoring the shape of the feature from the given cache entry
+    bool restore(const std::string &key, Feature *feature);
+
+    /// Store the current shape of the feature as the given cache entry
+    void store(const std::string &key, const Feature *feature);
+
+    /** Try restoring a plain shape from the given cache entry
+     *
+     * Plain shape entries have no element map, and are meant for caching
+     * results that are not feature shapes, e.g. projections. The caller
+     * is responsible for choosing a key that does not clash with the
+     * feature keys.
+     */
+    bool restoreShape(const std::string &key, TopoDS_Shape &shape);
+
+    /// Store a plain shape as the given cache entry
+    void storeShape(const std::string &key, const TopoDS_Shape &shape);
+
+    /// Remove all cache entries
+    void clear();
+
+    /// Compute a content hash of the given shape including its element map
+    static std::string hashShape(const TopoShape &shape);
+
+    struct Stats {
+        unsigned long hits = 0;
+        unsigned long misses = 0;
+        unsigned long stores = 0;
+        unsigned long evictions = 0;
+        unsigned long errors = 0;
+        unsigned long long size = 0;
+        unsigned long entries = 0;
+    };
+    /// Return the cache statistics, optionally resetting the counters
+    Stats getStats(bool reset=false);
+
+private:
+    ShapeCache();
+    void init();
+    std::string getDirectory() const;
+    std::string getFileName(const std::string &key) const;
+    void touchEntry(const std::string &key, unsigned long long size);
+    void writeEntry(const std::string &key, const std::string &idText,
+                    const std::string &mapText, const TopoShape &shape);
+    void evict();
+
+private:
+    struct Entry {
+        std::string key;
+        unsigned long long size;
+    };
+    // least recently used entry first
+    std::list<Entry> _entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> _entryMap;
+    std::string _dir;
+    Stats _stats;
+    bool _inited = false;
+};
+
+} //namespace Part
+
+#endif // PART_SHAPECACHE_H
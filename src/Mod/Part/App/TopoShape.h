@@ -192,6 +192,7 @@ public:
 
     void SaveDocFile (Base::Writer &writer) const;
     void RestoreDocFile(Base::Reader &reader);
+    virtual bool canSaveDocFileConcurrently() const {return true;}
     unsigned int getMemSize (void) const;
     //@}
 
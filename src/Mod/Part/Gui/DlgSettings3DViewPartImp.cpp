@@ -76,6 +76,8 @@ void DlgSettings3DViewPart::saveSettings()
 {
     ui->maxDeviation->onSave();
     ui->maxAngularDeflection->onSave();
+    ui->parallelMesh->onSave();
+    ui->saveTessellation->onSave();
 
     // search for Part view providers and apply the new settings
     std::vector<App::Document*> docs = App::GetApplication().getDocuments();
@@ -92,6 +94,8 @@ void DlgSettings3DViewPart::loadSettings()
 {
     ui->maxDeviation->onRestore();
     ui->maxAngularDeflection->onRestore();
+    ui->parallelMesh->onRestore();
+    ui->saveTessellation->onRestore();
 }
 
 /**
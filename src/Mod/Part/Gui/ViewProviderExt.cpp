@@ -97,6 +97,9 @@
 # include <QMenu>
 #endif
 
+#include <atomic>
+#include <QtConcurrentMap>
+
 #include <boost/algorithm/string/predicate.hpp>
 
 /// Here the FreeCAD includes sorted by Base,App,Gui......
@@ -239,6 +242,7 @@ ViewProviderPartExt::ViewProviderPartExt()
 {
     UpdatingColor = false;
     VisualTouched = true;
+    BoundingBoxTouched = false;
     forceUpdateCount = 0;
     NormalsFromUV = true;
 
@@ -519,6 +523,11 @@ void ViewProviderPartExt::onChanged(const App::Property* prop)
             updateVisual();
             // The material has to be checked again (#0001736)
             onChanged(&DiffuseColor);
+            if (BoundingBoxTouched) {
+                BoundingBoxTouched = false;
+                if (auto propShape = pcObject->getPropertyByName("Shape"))
+                    Gui::ViewProviderGeometryObject::updateData(propShape);
+            }
         }
     }
 
@@ -1409,9 +1418,18 @@ void ViewProviderPartExt::updateData(const App::Property* prop)
         // calculate the visual only if visible
         if (isUpdateForced()||Visibility.getValue())
             updateVisual();
-        else 
+        else {
             VisualTouched = true;
 
+            // Do not force decoding of a lazily restored shape of an
+            // invisible object just for its bounding box
+            auto propShape = Base::freecad_dynamic_cast<const Part::PropertyPartShape>(prop);
+            if (propShape && propShape->isRestorePending()) {
+                BoundingBoxTouched = true;
+                return;
+            }
+        }
+
         updateColors();
 
         if (!VisualTouched) {
@@ -1472,6 +1490,23 @@ void ViewProviderPartExt::unsetEdit(int ModNum)
     }
 }
 
+static inline bool isSameParam(double a, double b)
+{
+    return std::fabs(a-b) <= 1e-7 * std::max(std::fabs(a), std::fabs(b));
+}
+
+// Check whether all faces have a triangulation with at least the given precision
+static bool hasTriangulation(const TopoDS_Shape &shape, double deflection)
+{
+    TopLoc_Location loc;
+    for (TopExp_Explorer xp(shape, TopAbs_FACE); xp.More(); xp.Next()) {
+        Handle(Poly_Triangulation) mesh = BRep_Tool::Triangulation(TopoDS::Face(xp.Current()), loc);
+        if (mesh.IsNull() || mesh->Deflection() > deflection * (1.0 + 1e-7))
+            return false;
+    }
+    return true;
+}
+
 void ViewProviderPartExt::updateVisual()
 {
     Gui::SoUpdateVBOAction action;
@@ -1506,6 +1541,11 @@ void ViewProviderPartExt::updateVisual()
     int numTriangles=0,numNodes=0,numNorms=0,numFaces=0,numEdges=0,numLines=0;
     std::set<int> faceEdges;
 
+    // Use multiple threads for meshing and for filling the face arrays
+    ParameterGrp::handle hPart = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Part");
+    bool parallel = hPart->GetBool("ParallelMesh", true);
+
     try {
         // calculating the deflection value
         Bnd_Box bounds;
@@ -1516,36 +1556,70 @@ void ViewProviderPartExt::updateVisual()
         Standard_Real deflection = ((xMax-xMin)+(yMax-yMin)+(zMax-zMin))/300.0 *
             Deviation.getValue();
 
+        Standard_Real AngDeflectionRads = AngularDeflection.getValue() / 180.0 * M_PI;
+
+        // The triangulation may have been restored along with the shape, see
+        // PropertyPartShape::setTessellationParams()
+        const Part::PropertyPartShape *propShape = nullptr;
+        auto feature = dynamic_cast<Part::Feature*>(getObject());
+        if (feature && cShape.IsPartner(feature->Shape.getValue()))
+            propShape = &feature->Shape;
+
         // create or use the mesh on the data structure
+        FC_TIME_INIT(t);
+        double meshDeflection, meshAngularDeflection;
+        if (propShape
+                && propShape->getTessellationParams(meshDeflection, meshAngularDeflection)
+                && isSameParam(meshDeflection, deflection)
+                && isSameParam(meshAngularDeflection, AngDeflectionRads)
+                && hasTriangulation(cShape, deflection))
+        {
+            FC_TIME_LOG(t, "Reuse mesh " << pcObject->getFullName());
+        }
+        else {
 #if OCC_VERSION_HEX >= 0x060600
-        Standard_Real AngDeflectionRads = AngularDeflection.getValue() / 180.0 * M_PI;
-        BRepMesh_IncrementalMesh(cShape,deflection,Standard_False,
-                AngDeflectionRads,Standard_True);
+            BRepMesh_IncrementalMesh(cShape,deflection,Standard_False,
+                    AngDeflectionRads,parallel ? Standard_True : Standard_False);
 #else
-        BRepMesh_IncrementalMesh(cShape,deflection);
+            BRepMesh_IncrementalMesh(cShape,deflection);
 #endif
+            FC_TIME_LOG(t, "Mesh " << pcObject->getFullName() << (parallel?" (parallel)":""));
+            if (propShape)
+                propShape->setTessellationParams(deflection, AngDeflectionRads);
+        }
+        FC_TIME_INIT(t1);
+
         // We must reset the location here because the transformation data
         // are set in the placement property
         TopLoc_Location aLoc;
         cShape.Location(aLoc);
 
-        // count triangles and nodes in the mesh
+        // count triangles and nodes in the mesh, and record the offsets of
+        // each face into the node and index arrays, so that the faces can be
+        // filled independently below
         TopTools_IndexedMapOfShape faceMap;
         TopExp::MapShapes(cShape, TopAbs_FACE, faceMap);
+        std::vector<int> faceNodeOffsets(faceMap.Extent()+1, 0);
+        std::vector<int> faceTriaOffsets(faceMap.Extent()+1, 0);
         for (int i=1; i <= faceMap.Extent(); i++) {
             Handle (Poly_Triangulation) mesh = BRep_Tool::Triangulation(TopoDS::Face(faceMap(i)), aLoc);
+            int nbNodesInFace = 0, nbTriInFace = 0;
             // Note: we must also count empty faces
             if (!mesh.IsNull()) {
-                numTriangles += mesh->NbTriangles();
-                numNodes     += mesh->NbNodes();
-                numNorms     += mesh->NbNodes();
+                nbTriInFace   = mesh->NbTriangles();
+                nbNodesInFace = mesh->NbNodes();
             }
+            faceNodeOffsets[i] = faceNodeOffsets[i-1] + nbNodesInFace;
+            faceTriaOffsets[i] = faceTriaOffsets[i-1] + nbTriInFace;
 
             TopExp_Explorer xp;
             for (xp.Init(faceMap(i),TopAbs_EDGE);xp.More();xp.Next())
                 faceEdges.insert(xp.Current().HashCode(INT_MAX));
             numFaces++;
         }
+        numTriangles = faceTriaOffsets[numFaces];
+        numNodes     = faceNodeOffsets[numFaces];
+        numNorms     = numNodes;
 
         // get an indexed map of edges
         TopTools_IndexedMapOfShape edgeMap;
@@ -1601,13 +1675,21 @@ void ViewProviderPartExt::updateVisual()
         for (int i=0;i < numNorms;i++)
             norms[i]= SbVec3f(0.0,0.0,0.0);
 
-        int ii = 0,faceNodeOffset=0,faceTriaOffset=0;
-        for (int i=1; i <= faceMap.Extent(); i++, ii++) {
+        // fill in the triangles and normals of one face
+        auto harvestFace = [&](int i) {
             TopLoc_Location aLoc;
             const TopoDS_Face &actFace = TopoDS::Face(faceMap(i));
+            int faceNodeOffset = faceNodeOffsets[i-1];
+            int faceTriaOffset = faceTriaOffsets[i-1];
+            int nbTriInFace = faceTriaOffsets[i] - faceTriaOffset;
+            parts[i-1] = nbTriInFace; // new part
+            if (!nbTriInFace && faceNodeOffsets[i] == faceNodeOffset)
+                return;
+
             // get the mesh of the shape
             Handle (Poly_Triangulation) mesh = BRep_Tool::Triangulation(actFace,aLoc);
-            if (mesh.IsNull()) continue;
+            if (mesh.IsNull())
+                return;
 
             // getting the transformation of the shape/face
             gp_Trsf myTransf;
@@ -1617,13 +1699,9 @@ void ViewProviderPartExt::updateVisual()
                 myTransf = aLoc.Transformation();
             }
 
-            // getting size of node and triangle array of this face
-            int nbNodesInFace = mesh->NbNodes();
-            int nbTriInFace   = mesh->NbTriangles();
             // check orientation
             TopAbs_Orientation orient = actFace.Orientation();
 
-
             // cycling through the poly mesh
             const Poly_Array1OfTriangle& Triangles = mesh->Triangles();
             const TColgp_Array1OfPnt& Nodes = mesh->Nodes();
@@ -1692,9 +1770,52 @@ void ViewProviderPartExt::updateVisual()
                 index[faceTriaOffset*4+4*(g-1)+3] = SO_END_FACE_INDEX;
             }
 
-            parts[ii] = nbTriInFace; // new part
+            // normalize the normals of this face
+            for (int n=faceNodeOffset; n<faceNodeOffsets[i]; n++)
+                norms[n].normalize();
+        };
+
+        // Each face writes to its own range of the arrays, so they can be
+        // processed concurrently.
+        if (parallel && numFaces > 1) {
+            std::vector<int> faces(numFaces);
+            for (int i=0; i<numFaces; i++)
+                faces[i] = i+1;
+            std::atomic<bool> failed(false);
+            QtConcurrent::blockingMap(faces, [&](int i) {
+                try {
+                    harvestFace(i);
+                } catch (...) {
+                    failed = true;
+                }
+            });
+            if (failed)
+                throw Base::RuntimeError("Failed to triangulate face");
+        }
+        else {
+            for (int i=1; i <= numFaces; i++)
+                harvestFace(i);
+        }
+        FC_TIME_LOG(t1, "Triangles " << pcObject->getFullName() << ", faces: "
+                << numFaces << ", triangles: " << numTriangles);
+
+        // handling the edges lying on the faces. This has to be done in
+        // order, because the first face of an edge takes it.
+        for (int i=1; i <= faceMap.Extent(); i++) {
+            TopLoc_Location aLoc;
+            const TopoDS_Face &actFace = TopoDS::Face(faceMap(i));
+            Handle (Poly_Triangulation) mesh = BRep_Tool::Triangulation(actFace,aLoc);
+            if (mesh.IsNull()) continue;
+
+            gp_Trsf myTransf;
+            Standard_Boolean identity = true;
+            if (!aLoc.IsIdentity()) {
+                identity = false;
+                myTransf = aLoc.Transformation();
+            }
+            const TColgp_Array1OfPnt& Nodes = mesh->Nodes();
+            int faceNodeOffset = faceNodeOffsets[i-1];
 
-            // handling the edges lying on this face
             TopExp_Explorer Exp;
             for(Exp.Init(actFace,TopAbs_EDGE);Exp.More();Exp.Next()) {
                 const TopoDS_Edge &curEdge = TopoDS::Edge(Exp.Current());
@@ -1733,11 +1854,8 @@ void ViewProviderPartExt::updateVisual()
             }
 
             edgeVector.push_back(-1);
-            
-            // counting up the per Face offsets
-            faceNodeOffset += nbNodesInFace;
-            faceTriaOffset += nbTriInFace;
         }
+        int faceNodeOffset = faceNodeOffsets[numFaces];
 
         // handling of the free edges
         for (int i=1; i <= edgeMap.Extent(); i++) {
@@ -1781,10 +1899,6 @@ void ViewProviderPartExt::updateVisual()
             verts[faceNodeOffset+i].setValue((float)(pnt.X()),(float)(pnt.Y()),(float)(pnt.Z()));
         }
 
-        // normalize all normals 
-        for (int i = 0; i< numNorms ;i++)
-            norms[i].normalize();
-        
         std::vector<int32_t> lineSetCoords;
         for (std::map<int, std::vector<int32_t> >::iterator it = lineSetMap.begin(); it != lineSetMap.end(); ++it) {
             lineSetCoords.insert(lineSetCoords.end(), it->second.begin(), it->second.end());
@@ -196,6 +196,7 @@ protected:
     SoBrepPointSet    * nodeset;
 
     bool VisualTouched;
+    bool BoundingBoxTouched;
     bool NormalsFromUV;
     bool UpdatingColor;
 
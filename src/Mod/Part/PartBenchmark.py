@@ -0,0 +1,91 @@
+#**************************************************************************
+#                                                                         *
+#   This file is part of the FreeCAD CAx development system.              *
+#                                                                         *
+#   This program is free software; you can redistribute it and/or modify  *
+#   it under the terms of the GNU Lesser General Public License (LGPL)    *
+#   as published by the Free Software Foundation; either version 2 of     *
+#   the License, or (at your option) any later version.                   *
+#   for detail see the LICENCE text file.                                 *
+#                                                                         *
+#   FreeCAD is distributed in the hope that it will be useful,            *
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+#   GNU Library General Public License for more details.                  *
+#                                                                         *
+#   You should have received a copy of the GNU Library General Public     *
+#   License along with FreeCAD; if not, write to the Free Software        *
+#   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+#   USA                                                                   *
+#**************************************************************************
+
+# Benchmarks of the Part module. They are not part of the unit tests, run
+# them explicitly with
+#   FreeCAD -t PartBenchmark
+
+import FreeCAD, time, unittest, Part
+App = FreeCAD
+
+class PartBenchmarkElementMap(unittest.TestCase):
+    # holes per side of the plate
+    Sizes = [10, 20]
+
+    def setUp(self):
+        self.hGrp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+        self.flat = self.hGrp.GetBool("FlatElementMap", False)
+        self.docs = []
+
+    def makeBody(self, name, count):
+        # A plate with a grid of holes, which is heavy on sub-element mapping
+        doc = FreeCAD.newDocument(name)
+        self.docs.append(doc.Name)
+        base = doc.addObject("Part::Box", "Base")
+        base.Length = count*20
+        base.Width = count*20
+        base.Height = 10
+        tools = []
+        for i in range(count):
+            for j in range(count):
+                cyl = doc.addObject("Part::Cylinder", "Hole")
+                cyl.Radius = 4
+                cyl.Height = 20
+                cyl.Placement.Base = App.Vector(10+i*20, 10+j*20, -5)
+                tools.append(cyl)
+        fusion = doc.addObject("Part::MultiFuse", "Tools")
+        fusion.Shapes = tools
+        cut = doc.addObject("Part::Cut", "Cut")
+        cut.Base = base
+        cut.Tool = fusion
+        start = time.time()
+        doc.recompute()
+        return cut, time.time() - start
+
+    def lookup(self, shape):
+        # look up every mapped name and every indexed name once
+        elementMap = shape.ElementMap
+        start = time.time()
+        for mapped, indexed in elementMap.items():
+            shape.getElementName(mapped)
+            shape.getElementName(indexed, 1)
+        return time.time() - start
+
+    def testFlatElementMap(self):
+        for count in self.Sizes:
+            results = []
+            for flat in (False, True):
+                self.hGrp.SetBool("FlatElementMap", flat)
+                cut, t = self.makeBody("ElementMapBenchmark", count)
+                shape = cut.Shape
+                results.append((t, self.lookup(shape), shape.ElementMapMemSize))
+                size = shape.ElementMapSize
+                FreeCAD.closeDocument(cut.Document.Name)
+            FreeCAD.Console.PrintMessage("Element map of %d entries, "
+                    "bimap: recompute %.3f s, lookup %.3f s, %d bytes, "
+                    "flat: recompute %.3f s, lookup %.3f s, %d bytes\n"
+                    % ((size,) + results[0] + results[1]))
+
+    def tearDown(self):
+        self.hGrp.SetBool("FlatElementMap", self.flat)
+        for name in self.docs:
+            if name in FreeCAD.listDocuments():
+                FreeCAD.closeDocument(name)
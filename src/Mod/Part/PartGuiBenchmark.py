@@ -0,0 +1,69 @@
+#**************************************************************************
+#                                                                         *
+#   This file is part of the FreeCAD CAx development system.              *
+#                                                                         *
+#   This program is free software; you can redistribute it and/or modify  *
+#   it under the terms of the GNU Lesser General Public License (LGPL)    *
+#   as published by the Free Software Foundation; either version 2 of     *
+#   the License, or (at your option) any later version.                   *
+#   for detail see the LICENCE text file.                                 *
+#                                                                         *
+#   FreeCAD is distributed in the hope that it will be useful,            *
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+#   GNU Library General Public License for more details.                  *
+#                                                                         *
+#   You should have received a copy of the GNU Library General Public     *
+#   License along with FreeCAD; if not, write to the Free Software        *
+#   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+#   USA                                                                   *
+#**************************************************************************
+
+# Benchmarks of the Part view providers. They are not part of the unit tests,
+# run them explicitly with
+#   FreeCAD -t PartGuiBenchmark
+# It only needs the view providers, not an open 3D view.
+
+import FreeCAD, FreeCADGui, time, unittest, Part, PartGui
+
+class PartGuiBenchmarkTessellation(unittest.TestCase):
+    # spheres per side of the compound
+    Sizes = [10, 20, 40]
+
+    def setUp(self):
+        self.Doc = FreeCAD.newDocument("PartGuiBenchmark")
+        self.hGrp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Part")
+        self.parallel = self.hGrp.GetBool("ParallelMesh", True)
+
+    def makeCompound(self, name, count):
+        # Synthetic compound of many curved faces. A new one is made for each
+        # run, because an existing triangulation is reused by the mesher.
+        shapes = []
+        for i in range(count):
+            for j in range(count):
+                shapes.append(Part.makeSphere(4, FreeCAD.Vector(i*10, j*10, 0)))
+        obj = self.Doc.addObject("Part::Feature", name)
+        obj.Shape = Part.makeCompound(shapes)
+        return obj
+
+    def updateVisual(self, obj, parallel):
+        self.hGrp.SetBool("ParallelMesh", parallel)
+        start = time.time()
+        # changing the deviation of a visible object calls updateVisual()
+        obj.ViewObject.Deviation = 0.05
+        return time.time() - start
+
+    def testUpdateVisual(self):
+        for count in self.Sizes:
+            obj1 = self.makeCompound("Serial", count)
+            obj2 = self.makeCompound("Parallel", count)
+            t1 = self.updateVisual(obj1, False)
+            t2 = self.updateVisual(obj2, True)
+            FreeCAD.Console.PrintMessage("updateVisual of %d faces, serial: %.3f s, parallel: %.3f s\n"
+                    % (len(obj1.Shape.Faces), t1, t2))
+            self.Doc.removeObject(obj1.Name)
+            self.Doc.removeObject(obj2.Name)
+
+    def tearDown(self):
+        self.hGrp.SetBool("ParallelMesh", self.parallel)
+        FreeCAD.closeDocument(self.Doc.Name)
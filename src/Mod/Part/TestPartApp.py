@@ -21,6 +21,8 @@
 
 import FreeCAD, os, sys, unittest, Part
 import copy 
+import shutil
+import tempfile
 from FreeCAD import Units
 App = FreeCAD
 
@@ -57,6 +59,242 @@ class PartTestCases(unittest.TestCase):
         FreeCAD.closeDocument("PartTest")
         #print ("omit closing document for debugging")
 
+class PartTestElementMap(unittest.TestCase):
+    def setUp(self):
+        self.hGrp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+        self.flat = self.hGrp.GetBool("FlatElementMap", False)
+        self.binary = self.hGrp.GetBool("BinaryElementMap", False)
+        self.docs = []
+        self.tempDir = None
+
+    def makeBody(self, name):
+        # A plate with a grid of holes, which is heavy on sub-element mapping
+        doc = FreeCAD.newDocument(name)
+        self.docs.append(doc.Name)
+        base = doc.addObject("Part::Box", "Base")
+        base.Length = 200
+        base.Width = 200
+        base.Height = 10
+        tools = []
+        for i in range(10):
+            for j in range(10):
+                cyl = doc.addObject("Part::Cylinder", "Hole")
+                cyl.Radius = 4
+                cyl.Height = 20
+                cyl.Placement.Base = App.Vector(10+i*20, 10+j*20, -5)
+                tools.append(cyl)
+        fusion = doc.addObject("Part::MultiFuse", "Tools")
+        fusion.Shapes = tools
+        cut = doc.addObject("Part::Cut", "Cut")
+        cut.Base = base
+        cut.Tool = fusion
+        doc.recompute()
+        return doc, cut
+
+    def testFlatElementMap(self):
+        self.hGrp.SetBool("FlatElementMap", False)
+        doc1, cut1 = self.makeBody("ElementMapBimap")
+        self.hGrp.SetBool("FlatElementMap", True)
+        doc2, cut2 = self.makeBody("ElementMapFlat")
+        self.assertTrue(cut1.Shape.ElementMapSize > 0)
+        self.assertEqual(cut1.Shape.ElementMap, cut2.Shape.ElementMap)
+        self.assertEqual(cut1.Shape.ElementReverseMap, cut2.Shape.ElementReverseMap)
+        self.assertEqual(cut1.Shape.getElementName("Face1", 1), cut2.Shape.getElementName("Face1", 1))
+        self.assertLess(cut2.Shape.ElementMapMemSize, cut1.Shape.ElementMapMemSize)
+
+    def testBinaryElementMap(self):
+        self.hGrp.SetBool("FlatElementMap", True)
+        self.hGrp.SetBool("BinaryElementMap", True)
+        doc, cut = self.makeBody("ElementMapBinary")
+        elementMap = cut.Shape.ElementMap
+        self.tempDir = tempfile.mkdtemp()
+        path = os.path.join(self.tempDir, "ElementMapBinary.FCStd")
+        doc.saveAs(path)
+        FreeCAD.closeDocument(doc.Name)
+        doc = FreeCAD.openDocument(path)
+        self.assertEqual(doc.getObject("Cut").Shape.ElementMap, elementMap)
+
+    def tearDown(self):
+        self.hGrp.SetBool("FlatElementMap", self.flat)
+        self.hGrp.SetBool("BinaryElementMap", self.binary)
+        for name in self.docs:
+            if name in FreeCAD.listDocuments():
+                FreeCAD.closeDocument(name)
+        if self.tempDir:
+            shutil.rmtree(self.tempDir, ignore_errors=True)
+
+class PartTestConcurrentRecompute(unittest.TestCase):
+    class Observer:
+        def __init__(self):
+            self.changes = {}
+
+        def slotChangedObject(self, obj, prop):
+            if prop == "Shape":
+                self.changes.setdefault(obj.Document.Name, []).append(obj.Name)
+
+    def setUp(self):
+        self.hGrp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+        self.concurrent = self.hGrp.GetBool("ConcurrentRecompute", False)
+        self.threads = self.hGrp.GetInt("RecomputeThreads", 0)
+        self.hGrp.SetInt("RecomputeThreads", 4)
+        self.obs = self.Observer()
+        FreeCAD.addDocumentObserver(self.obs)
+        self.docs = []
+
+    def makeDocument(self, name):
+        doc = FreeCAD.newDocument(name)
+        self.docs.append(doc.Name)
+        doc.UndoMode = 1
+        boxes = []
+        for i in range(20):
+            box = doc.addObject("Part::Box", "Box")
+            box.Length = 10 + i
+            box.Placement.Base = App.Vector(i*5, 0, 0)
+            boxes.append(box)
+        # boxes depending on other boxes
+        for i in range(1, 20, 2):
+            boxes[i].setExpression("Height", "%s.Length / 2" % boxes[i-1].Name)
+        # features which are recomputed in the main thread
+        fusion = doc.addObject("Part::MultiFuse", "Fusion")
+        fusion.Shapes = boxes[:10]
+        tail = doc.addObject("Part::Box", "Tail")
+        tail.setExpression("Width", "Fusion.Shape.BoundBox.XLength")
+        # a failing box and its dependent
+        bad = doc.addObject("Part::Box", "Bad")
+        bad.setExpression("Length", "Box.Length - 10")
+        cut = doc.addObject("Part::Cut", "Cut")
+        cut.Base = boxes[2]
+        cut.Tool = bad
+        return doc
+
+    def recompute(self, doc, concurrent):
+        self.hGrp.SetBool("ConcurrentRecompute", concurrent)
+        doc.recompute()
+        self.hGrp.SetBool("ConcurrentRecompute", False)
+
+    def compare(self, serial, concurrent):
+        for obj in serial.Objects:
+            other = concurrent.getObject(obj.Name)
+            self.assertEqual(obj.State, other.State, obj.Name)
+            if obj.isValid():
+                self.assertAlmostEqual(obj.Shape.Volume, other.Shape.Volume, 6, obj.Name)
+                bbox1 = obj.Shape.BoundBox
+                bbox2 = other.Shape.BoundBox
+                self.assertTrue(bbox1.isInside(bbox2) and bbox2.isInside(bbox1), obj.Name)
+        # the changes of the objects executed by the worker threads are
+        # signaled in the same order as by serial recompute
+        self.assertEqual(self.obs.changes.get(serial.Name), self.obs.changes.get(concurrent.Name))
+        self.obs.changes = {}
+
+    def testConcurrentRecompute(self):
+        serial = self.makeDocument("SerialRecompute")
+        concurrent = self.makeDocument("ConcurrentRecompute")
+        self.recompute(serial, False)
+        self.recompute(concurrent, True)
+        self.assertFalse(serial.Bad.isValid())
+        self.assertTrue(serial.Tail.isValid())
+        self.assertEqual(len(serial.Fusion.Shape.Solids), 1)
+        self.compare(serial, concurrent)
+
+        # change some of the boxes in a transaction
+        for doc in (serial, concurrent):
+            doc.openTransaction("Change")
+            doc.Box.Length = 30
+            doc.Box004.Width = 5
+            doc.Box019.Height = 15
+        self.recompute(serial, False)
+        self.recompute(concurrent, True)
+        self.assertTrue(serial.Bad.isValid())
+        self.assertTrue(serial.Cut.isValid())
+        self.compare(serial, concurrent)
+
+        for doc in (serial, concurrent):
+            doc.commitTransaction()
+            doc.undo()
+        self.recompute(serial, False)
+        self.recompute(concurrent, True)
+        self.assertEqual(concurrent.Box.Length, 10)
+        self.compare(serial, concurrent)
+
+    def tearDown(self):
+        FreeCAD.removeDocumentObserver(self.obs)
+        self.hGrp.SetBool("ConcurrentRecompute", self.concurrent)
+        self.hGrp.SetInt("RecomputeThreads", self.threads)
+        for name in self.docs:
+            if name in FreeCAD.listDocuments():
+                FreeCAD.closeDocument(name)
+
+class PartTestShapeCache(unittest.TestCase):
+    def setUp(self):
+        self.hGrp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Part/General")
+        self.enabled = self.hGrp.GetBool("ShapeCache", False)
+        self.dir = self.hGrp.GetString("ShapeCacheDir", "")
+        self.cacheDir = tempfile.mkdtemp()
+        self.hGrp.SetBool("ShapeCache", True)
+        self.hGrp.SetString("ShapeCacheDir", self.cacheDir)
+        self.doc = FreeCAD.newDocument("ShapeCache")
+
+    def makeCut(self):
+        base = self.doc.addObject("Part::Box", "Base")
+        tool = self.doc.addObject("Part::Box", "Tool")
+        tool.Placement.Base = App.Vector(5, 5, 5)
+        cut = self.doc.addObject("Part::Cut", "Cut")
+        cut.Base = base
+        cut.Tool = tool
+        return cut
+
+    def stats(self):
+        return Part.getShapeCacheStats(True)
+
+    def testHitMiss(self):
+        cut = self.makeCut()
+        self.stats()
+        self.doc.recompute()
+        stats = self.stats()
+        self.assertEqual(stats["Hits"], 0)
+        self.assertEqual(stats["Misses"], 1)
+        self.assertEqual(stats["Stores"], 1)
+        self.assertEqual(stats["Entries"], 1)
+        volume = cut.Shape.Volume
+
+        # the inputs are unchanged, so the shape is restored from the cache
+        cut.touch()
+        self.doc.recompute()
+        stats = self.stats()
+        self.assertEqual(stats["Hits"], 1)
+        self.assertEqual(stats["Misses"], 0)
+        self.assertEqual(stats["Stores"], 0)
+        self.assertAlmostEqual(cut.Shape.Volume, volume)
+
+        self.doc.Tool.Length = 20
+        self.doc.recompute()
+        stats = self.stats()
+        self.assertEqual(stats["Hits"], 0)
+        self.assertEqual(stats["Misses"], 1)
+        self.assertEqual(stats["Stores"], 1)
+        self.assertEqual(stats["Entries"], 2)
+        self.assertEqual(stats["Errors"], 0)
+        self.assertTrue(all(f.endswith(".fcsc") for f in os.listdir(self.cacheDir)))
+
+        Part.clearShapeCache()
+        self.assertEqual(self.stats()["Entries"], 0)
+        cut.touch()
+        self.doc.recompute()
+        self.assertEqual(self.stats()["Misses"], 1)
+
+    def testStaleTemporaryFile(self):
+        # a temporary file of an interrupted store is removed on startup
+        stale = os.path.join(self.cacheDir, "0123456789.fcsc.tmp")
+        open(stale, "w").close()
+        self.assertEqual(self.stats()["Entries"], 0)
+        self.assertFalse(os.path.exists(stale))
+
+    def tearDown(self):
+        FreeCAD.closeDocument(self.doc.Name)
+        self.hGrp.SetBool("ShapeCache", self.enabled)
+        self.hGrp.SetString("ShapeCacheDir", self.dir)
+        shutil.rmtree(self.cacheDir)
+
 class PartTestBSplineCurve(unittest.TestCase):
     def setUp(self):
         self.Doc = FreeCAD.newDocument("PartTest")
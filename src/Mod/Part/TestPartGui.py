@@ -20,6 +20,7 @@
 #**************************************************************************
 
 import FreeCAD, FreeCADGui, os, sys, unittest, Part, PartGui
+import tempfile
 
 
 #---------------------------------------------------------------------------
@@ -41,3 +42,195 @@ import FreeCAD, FreeCADGui, os, sys, unittest, Part, PartGui
 #	def tearDown(self):
 #		#closing doc
 #		FreeCAD.closeDocument("PartGuiTest")
+
+class PartGuiTestTessellation(unittest.TestCase):
+    def setUp(self):
+        self.Doc = FreeCAD.newDocument("PartGuiTessellation")
+        self.hGrp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Part")
+        self.parallel = self.hGrp.GetBool("ParallelMesh", True)
+
+    def makeCompound(self, name):
+        # Synthetic compound of many curved faces. A new one is made for each
+        # run, because an existing triangulation is reused by the mesher.
+        shapes = []
+        for i in range(20):
+            for j in range(20):
+                shapes.append(Part.makeSphere(4, FreeCAD.Vector(i*10, j*10, 0)))
+        obj = self.Doc.addObject("Part::Feature", name)
+        obj.Shape = Part.makeCompound(shapes)
+        return obj
+
+    def updateVisual(self, obj, parallel):
+        self.hGrp.SetBool("ParallelMesh", parallel)
+        # changing the deviation of a visible object calls updateVisual()
+        obj.ViewObject.Deviation = 0.05
+
+    def getCoordinates(self, obj):
+        from pivy import coin
+        sa = coin.SoSearchAction()
+        sa.setType(coin.SoCoordinate3.getClassTypeId())
+        sa.apply(obj.ViewObject.RootNode)
+        return [tuple(p.getValue()) for p in sa.getPath().getTail().point.getValues()]
+
+    def testParallelTessellation(self):
+        try:
+            import pivy
+        except ImportError:
+            self.skipTest("pivy is needed to compare the coordinates")
+        obj1 = self.makeCompound("Serial")
+        obj2 = self.makeCompound("Parallel")
+        self.updateVisual(obj1, False)
+        self.updateVisual(obj2, True)
+        self.assertEqual(self.getCoordinates(obj1), self.getCoordinates(obj2))
+
+    def testSaveTessellation(self):
+        hGeneral = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Part/General")
+        saveTessellation = hGeneral.GetBool("SaveTessellation", False)
+        hGeneral.SetBool("SaveTessellation", True)
+        try:
+            import pivy
+        except ImportError:
+            pivy = None
+        try:
+            obj = self.makeCompound("Saved")
+            self.updateVisual(obj, False)
+            coords = self.getCoordinates(obj) if pivy else None
+            path = os.path.join(tempfile.gettempdir(), "PartGuiTessellation.FCStd")
+            self.Doc.saveAs(path)
+            FreeCAD.closeDocument(self.Doc.Name)
+
+            self.Doc = FreeCAD.openDocument(path)
+            FreeCADGui.updateGui()
+            obj = self.Doc.getObject("Saved")
+            if pivy:
+                self.assertEqual(self.getCoordinates(obj), coords)
+        finally:
+            hGeneral.SetBool("SaveTessellation", saveTessellation)
+
+    def tearDown(self):
+        self.hGrp.SetBool("ParallelMesh", self.parallel)
+        FreeCAD.closeDocument(self.Doc.Name)
+
+
+class SelectionObserver:
+    def __init__(self):
+        self.added = []
+        self.removed = []
+        self.set = []
+
+    def addSelection(self, doc, obj, sub, pnt):
+        self.added.append((obj, sub))
+
+    def removeSelection(self, doc, obj, sub):
+        self.removed.append((obj, sub))
+
+    def setSelection(self, doc):
+        self.set.append(doc)
+
+class PartGuiTestSelection(unittest.TestCase):
+    def setUp(self):
+        self.Doc = FreeCAD.newDocument("PartGuiSelection")
+        self.Box = self.Doc.addObject("Part::Box", "Box")
+        self.Doc.recompute()
+        FreeCADGui.Selection.clearSelection()
+        self.Observer = SelectionObserver()
+        FreeCADGui.Selection.addObserver(self.Observer)
+
+    def testAddRemove(self):
+        FreeCADGui.Selection.addSelection(self.Box, ["Face1", "Face2", "Edge1"])
+        sel = FreeCADGui.Selection.getSelectionEx()
+        self.assertEqual(len(sel), 1)
+        self.assertEqual(sel[0].SubElementNames, ("Face1", "Face2", "Edge1"))
+        for sub in ["Face1", "Face2", "Edge1"]:
+            self.assertTrue(FreeCADGui.Selection.isSelected(self.Box, sub))
+        self.assertFalse(FreeCADGui.Selection.isSelected(self.Box, "Face3"))
+
+        # adding a selected element again is ignored
+        FreeCADGui.Selection.addSelection(self.Box, ["Face2", "Face3"])
+        self.assertEqual(FreeCADGui.Selection.getSelectionEx()[0].SubElementNames,
+                         ("Face1", "Face2", "Edge1", "Face3"))
+
+        FreeCADGui.Selection.removeSelection(self.Box, ["Face1", "Edge1"])
+        self.assertFalse(FreeCADGui.Selection.isSelected(self.Box, "Face1"))
+        self.assertFalse(FreeCADGui.Selection.isSelected(self.Box, "Edge1"))
+        self.assertTrue(FreeCADGui.Selection.isSelected(self.Box, "Face2"))
+        self.assertEqual(FreeCADGui.Selection.getSelectionEx()[0].SubElementNames, ("Face2", "Face3"))
+
+        # without a sub-element all entries of the object are removed
+        FreeCADGui.Selection.removeSelection(self.Box)
+        self.assertFalse(FreeCADGui.Selection.isSelected(self.Box, "Face2"))
+        self.assertEqual(len(FreeCADGui.Selection.getSelectionEx()), 0)
+
+        FreeCADGui.Selection.addSelection(self.Box, ["Face1", "Face2"])
+        FreeCADGui.Selection.clearSelection()
+        self.assertFalse(FreeCADGui.Selection.isSelected(self.Box, "Face1"))
+        self.assertFalse(FreeCADGui.Selection.isSelected(self.Box))
+        self.assertEqual(len(FreeCADGui.Selection.getSelectionEx()), 0)
+
+        # the index must be empty, otherwise the elements would be skipped
+        FreeCADGui.Selection.addSelection(self.Box, ["Face1", "Face2"])
+        self.assertEqual(FreeCADGui.Selection.getSelectionEx()[0].SubElementNames, ("Face1", "Face2"))
+
+    def testResolve(self):
+        FreeCADGui.Selection.addSelection(self.Box, ["Face1", "Face2"])
+        self.assertTrue(FreeCADGui.Selection.isSelected(self.Box, "Face1", True))
+        self.assertTrue(FreeCADGui.Selection.isSelected(self.Box, "", True))
+        self.assertFalse(FreeCADGui.Selection.isSelected(self.Box, "Face3", True))
+
+        # the new style element name resolves to the same element
+        obj, newName, oldName = self.Box.resolveSubElement("Face2")
+        if newName:
+            self.assertTrue(FreeCADGui.Selection.isSelected(self.Box, newName, True))
+            self.assertTrue(FreeCADGui.Selection.isSelected(self.Box, newName, False))
+
+        FreeCADGui.Selection.removeSelection(self.Box, ["Face1", "Face2"])
+        self.assertFalse(FreeCADGui.Selection.isSelected(self.Box, "Face2", True))
+        self.assertFalse(FreeCADGui.Selection.isSelected(self.Box, "", True))
+
+    def testSubObject(self):
+        part = self.Doc.addObject("App::Part", "Part")
+        part.addObject(self.Box)
+        self.Doc.recompute()
+
+        FreeCADGui.Selection.addSelection(part, ["Box.Face1", "Box.Face2"])
+        self.assertTrue(FreeCADGui.Selection.isSelected(part, "Box.Face1", False))
+        self.assertFalse(FreeCADGui.Selection.isSelected(self.Box, "Face1", False))
+        # the box is selected as resolved object of the part
+        self.assertTrue(FreeCADGui.Selection.isSelected(self.Box, "", True))
+
+        # the selection is indexed by the object name, not by its label
+        self.Box.Label = "Renamed"
+        part.Label = "RenamedPart"
+        self.assertTrue(FreeCADGui.Selection.isSelected(part, "Box.Face1", False))
+        self.assertTrue(FreeCADGui.Selection.isSelected(part, "Box.Face2", False))
+
+        # removing the sub-object removes all its elements
+        FreeCADGui.Selection.removeSelection(part, "Box.")
+        self.assertFalse(FreeCADGui.Selection.isSelected(part, "Box.Face1", False))
+        self.assertFalse(FreeCADGui.Selection.isSelected(self.Box, "", True))
+        self.assertEqual(len(FreeCADGui.Selection.getSelectionEx()), 0)
+
+    def testDeleteObject(self):
+        FreeCADGui.Selection.addSelection(self.Box, ["Face1", "Face2"])
+        self.Doc.removeObject("Box")
+        self.assertEqual(len(FreeCADGui.Selection.getSelectionEx()), 0)
+        # a new object with the same name is not selected
+        box = self.Doc.addObject("Part::Box", "Box")
+        self.Doc.recompute()
+        self.assertEqual(box.Name, "Box")
+        self.assertFalse(FreeCADGui.Selection.isSelected(box, "Face1"))
+
+    def testNotification(self):
+        # observers get one message per sub-element of a batch
+        FreeCADGui.Selection.addSelection(self.Box, ["Face1", "Face2", "Face3"])
+        self.assertEqual(self.Observer.added, [("Box", "Face1"), ("Box", "Face2"), ("Box", "Face3")])
+        FreeCADGui.Selection.removeSelection(self.Box, ["Face1", "Face3"])
+        self.assertEqual(self.Observer.removed, [("Box", "Face1"), ("Box", "Face3")])
+        FreeCADGui.Selection.addSelection(self.Box, ["Edge1"])
+        self.assertEqual(self.Observer.added[-1], ("Box", "Edge1"))
+        self.assertEqual(self.Observer.set, [])
+
+    def tearDown(self):
+        FreeCADGui.Selection.removeObserver(self.Observer)
+        FreeCADGui.Selection.clearSelection()
+        FreeCAD.closeDocument(self.Doc.Name)
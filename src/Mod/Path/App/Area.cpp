@@ -23,6 +23,9 @@
 
 #ifndef _PreComp_
 # include <cfloat>
+# include <deque>
+# include <exception>
+# include <functional>
 # include <boost/version.hpp>
 # include <boost/config.hpp>
 # if defined(BOOST_MSVC) && (BOOST_VERSION == 105500)
@@ -83,6 +86,11 @@
 # include <TopTools_HSequenceOfShape.hxx>
 #endif
 
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+
 #include <Base/Exception.h>
 #include <Base/Tools.h>
 
@@ -1285,6 +1293,46 @@ int Area::project(TopoDS_Shape &shape_out,
     return skips;
 }
 
+namespace {
+
+// Result of slicing the shapes at one height. Console output is not thread
+// safe, so messages are kept here and printed when the result is collected.
+struct SectionTask {
+    std::size_t index = 0;
+    double z = 0.0;
+    shared_ptr<Area> area;
+    std::vector<std::pair<int,std::string> > messages;
+    std::exception_ptr error;
+    FC_DURATION duration = FC_DURATION(0);
+    QSemaphore done;
+};
+
+class SectionRunnable : public QRunnable
+{
+public:
+    explicit SectionRunnable(const std::function<void()> &f)
+        : func(f)
+    {
+    }
+
+    void run() override {
+        func();
+    }
+
+private:
+    std::function<void()> func;
+};
+
+} // anonymous namespace
+
+#define SECTION_MSG(_task,_level,_msg) do {\
+    if(FC_LOG_INSTANCE.isEnabled(FC_LOGLEVEL_##_level)) {\
+        std::ostringstream str;\
+        str << _msg;\
+        (_task).messages.emplace_back(FC_LOGLEVEL_##_level,str.str());\
+    }\
+}while(0)
+
 std::vector<shared_ptr<Area> > Area::makeSections(
         PARAM_ARGS(PARAM_FARG,AREA_PARAMS_SECTION_EXTRA),
         const std::vector<double> &_heights,
@@ -1301,7 +1349,7 @@ std::vector<shared_ptr<Area> > Area::makeSections(
     if(plane.IsNull())
         throw Base::ValueError("failed to obtain section plane");
 
-    FC_TIME_INIT2(t,t1);
+    FC_TIME_INIT(t);
 
     TopLoc_Location loc(trsf);
 
@@ -1429,112 +1477,197 @@ std::vector<shared_ptr<Area> > Area::makeSections(
     bool can_retry = fabs(tolerance)>Precision::Confusion();
     TopLoc_Location locInverse(loc.Inverted());
 
-    for(size_t i=0;i<heights.size();++i) {
-        double z = heights[i];
-        bool retried = !can_retry;
-        while(true) {
-            gp_Pln pln(gp_Pnt(0,0,z),gp_Dir(0,0,1));
-            Standard_Real a,b,c,d;
-            pln.Coefficients(a,b,c,d);
-            BRepLib_MakeFace mkFace(pln,xMin,xMax,yMin,yMax);
-            const TopoDS_Shape &face = mkFace.Face();
-
-            shared_ptr<Area> area(std::make_shared<Area>(&myParams));
-            area->myParams.Outline = false;
-            area->setPlane(face.Moved(locInverse));
-
-            if(project) {
-                for(const auto &s : projectedShapes) {
-                    gp_Trsf t;
-                    t.SetTranslation(gp_Vec(0,0,-d));
-                    TopLoc_Location wloc(t);
-                    area->add(s.shape.Moved(wloc).Moved(locInverse),s.op);
+    // Slice the shapes at the height of the given task. This may run in a
+    // worker thread, so it must only modify the task.
+    auto makeSection = [&](SectionTask &task) {
+        try {
+            FC_TIME_INIT(t1);
+            double z = task.z;
+            bool retried = !can_retry;
+            while(true) {
+                gp_Pln pln(gp_Pnt(0,0,z),gp_Dir(0,0,1));
+                Standard_Real a,b,c,d;
+                pln.Coefficients(a,b,c,d);
+                BRepLib_MakeFace mkFace(pln,xMin,xMax,yMin,yMax);
+                const TopoDS_Shape &face = mkFace.Face();
+
+                shared_ptr<Area> area(std::make_shared<Area>(&myParams));
+                area->myParams.Outline = false;
+                area->setPlane(face.Moved(locInverse));
+
+                if(project) {
+                    for(const auto &s : projectedShapes) {
+                        gp_Trsf t;
+                        t.SetTranslation(gp_Vec(0,0,-d));
+                        TopLoc_Location wloc(t);
+                        area->add(s.shape.Moved(wloc).Moved(locInverse),s.op);
+                    }
+                    task.area = area;
+                    break;
                 }
-                sections.push_back(area);
-                break;
-            }
 
-            for(auto it=myShapes.begin();it!=myShapes.end();++it) {
-                const auto &s = *it;
-                BRep_Builder builder;
-                TopoDS_Compound comp;
-                builder.MakeCompound(comp);
-
-                for(TopExp_Explorer xp(s.shape.Moved(loc), TopAbs_SOLID); xp.More(); xp.Next()) {
-                    showShape(xp.Current(),0,"section_%u_shape",i);
-                    std::list<TopoDS_Wire> wires;
-                    Part::CrossSection section(a,b,c,xp.Current());
-                    wires = section.slice(-d);
-                    showShapes(wires,0,"section_%u_wire",i);
-                    if(wires.empty()) {
-                        AREA_LOG("Section returns no wires");
-                        continue;
-                    }
+                for(auto it=myShapes.begin();it!=myShapes.end();++it) {
+                    const auto &s = *it;
+                    BRep_Builder builder;
+                    TopoDS_Compound comp;
+                    builder.MakeCompound(comp);
+
+                    for(TopExp_Explorer xp(s.shape.Moved(loc), TopAbs_SOLID); xp.More(); xp.Next()) {
+                        showShape(xp.Current(),0,"section_%u_shape",task.index);
+                        std::list<TopoDS_Wire> wires;
+                        Part::CrossSection section(a,b,c,xp.Current());
+                        wires = section.slice(-d);
+                        showShapes(wires,0,"section_%u_wire",task.index);
+                        if(wires.empty()) {
+                            SECTION_MSG(task,LOG,"Section returns no wires");
+                            continue;
+                        }
 
-                    // always try to make face to normalize wire orientation
-                    Part::FaceMakerBullseye mkFace;
-                    mkFace.setPlane(pln);
-                    for(const TopoDS_Wire &wire : wires) {
-                        if(BRep_Tool::IsClosed(wire))
-                            mkFace.addWire(wire);
-                    }
-                    try {
-                        mkFace.Build();
-                        const TopoDS_Shape &shape = mkFace.Shape();
-                        if (shape.IsNull())
-                            AREA_WARN("FaceMakerBullseye return null shape on section");
-                        else {
-                            showShape(shape,0,"section_%u_face",i);
-                            for(auto it=wires.begin(),itNext=it;it!=wires.end();it=itNext) {
-                                ++itNext;
-                                if(BRep_Tool::IsClosed(*it))
-                                    wires.erase(it);
-                            }
-                            for(TopExp_Explorer xp(shape,myParams.Fill==FillNone?TopAbs_WIRE:TopAbs_FACE);
-                                    xp.More();xp.Next())
-                            {
-                                builder.Add(comp,xp.Current());
+                        // always try to make face to normalize wire orientation
+                        Part::FaceMakerBullseye mkFace;
+                        mkFace.setPlane(pln);
+                        for(const TopoDS_Wire &wire : wires) {
+                            if(BRep_Tool::IsClosed(wire))
+                                mkFace.addWire(wire);
+                        }
+                        try {
+                            mkFace.Build();
+                            const TopoDS_Shape &shape = mkFace.Shape();
+                            if (shape.IsNull())
+                                SECTION_MSG(task,WARN,"FaceMakerBullseye return null shape on section");
+                            else {
+                                showShape(shape,0,"section_%u_face",task.index);
+                                for(auto it=wires.begin(),itNext=it;it!=wires.end();it=itNext) {
+                                    ++itNext;
+                                    if(BRep_Tool::IsClosed(*it))
+                                        wires.erase(it);
+                                }
+                                for(TopExp_Explorer xp(shape,myParams.Fill==FillNone?TopAbs_WIRE:TopAbs_FACE);
+                                        xp.More();xp.Next())
+                                {
+                                    builder.Add(comp,xp.Current());
+                                }
                             }
+                        }catch (Base::Exception &e){
+                            SECTION_MSG(task,WARN,"FaceMakerBullseye failed on section: " << e.what());
                         }
-                    }catch (Base::Exception &e){
-                        AREA_WARN("FaceMakerBullseye failed on section: " << e.what());
+                        for(const TopoDS_Wire &wire : wires)
+                            builder.Add(comp,wire);
                     }
-                    for(const TopoDS_Wire &wire : wires)
-                        builder.Add(comp,wire);
-                }
 
-                // Make sure the compound has at least one edge
-                if(TopExp_Explorer(comp,TopAbs_EDGE).More()) {
-                    const TopoDS_Shape &shape = comp.Moved(locInverse);
-                    showShape(shape,0,"section_%u_result",i);
-                    area->add(shape,s.op);
-                }else if(area->myShapes.empty()){
-                    auto itNext = it;
-                    if(++itNext != myShapes.end() &&
-                        (itNext->op==OperationIntersection ||
-                        itNext->op==OperationDifference))
-                    {
-                        break;
+                    // Make sure the compound has at least one edge
+                    if(TopExp_Explorer(comp,TopAbs_EDGE).More()) {
+                        const TopoDS_Shape &shape = comp.Moved(locInverse);
+                        showShape(shape,0,"section_%u_result",task.index);
+                        area->add(shape,s.op);
+                    }else if(area->myShapes.empty()){
+                        auto itNext = it;
+                        if(++itNext != myShapes.end() &&
+                            (itNext->op==OperationIntersection ||
+                            itNext->op==OperationDifference))
+                        {
+                            break;
+                        }
                     }
                 }
+                if(area->myShapes.size()){
+                    task.area = area;
+                    break;
+                }
+                if(retried) {
+                    SECTION_MSG(task,WARN,"Discard empty section");
+                    break;
+                }else{
+                    SECTION_MSG(task,TRACE,"retry section " <<z<<"->"<<z+tolerance);
+                    z += tolerance;
+                    retried = true;
+                }
             }
-            if(area->myShapes.size()){
-                sections.push_back(area);
-                FC_TIME_LOG(t1,"makeSection " << z);
-                showShape(area->getShape(),0,"section_%u_final",i);
+            task.z = z;
+            task.duration = Base::GetDuration(t1);
+        }catch(...) {
+            task.error = std::current_exception();
+        }
+    };
+
+    // Collect the result in the calling thread to keep the section order
+    auto addSection = [&](SectionTask &task) {
+        if(task.error)
+            std::rethrow_exception(task.error);
+        for(const auto &msg : task.messages) {
+            switch(msg.first) {
+            case FC_LOGLEVEL_WARN:
+                AREA_WARN(msg.second);
                 break;
-            }
-            if(retried) {
-                AREA_WARN("Discard empty section");
+            case FC_LOGLEVEL_LOG:
+                AREA_LOG(msg.second);
                 break;
-            }else{
-                AREA_TRACE("retry section " <<z<<"->"<<z+tolerance);
-                z += tolerance;
-                retried = true;
+            default:
+                AREA_TRACE(msg.second);
+            }
+        }
+        if(task.area) {
+            sections.push_back(task.area);
+            FC_DURATION_LOG(task.duration,"makeSection " << task.z);
+            // getShape() builds the area with the global libarea settings
+            // of CAreaConfig, so it must not run in the workers
+            if(!project)
+                showShape(task.area->getShape(),0,"section_%u_final",task.index);
+        }
+    };
+
+    // Projection only adds the already projected shapes, and showShape()
+    // adds document objects, so both are done in the calling thread.
+    int threads = 1;
+    if(!project && heights.size()>1 && FC_LOG_INSTANCE.level()<=FC_LOGLEVEL_TRACE) {
+        threads = App::GetApplication().GetParameterGroupByPath(
+                "User parameter:BaseApp/Preferences/Mod/Path")->GetInt("SectionThreads",0);
+        if(threads <= 0)
+            threads = QThread::idealThreadCount();
+        threads = std::min<int>(threads,heights.size());
+    }
+
+    if(threads <= 1) {
+        for(size_t i=0;i<heights.size();++i) {
+            SectionTask task;
+            task.index = i;
+            task.z = heights[i];
+            makeSection(task);
+            addSection(task);
+        }
+    } else {
+        // The number of threads limits the intermediate data of the
+        // concurrently running sections. Besides, only a small window of
+        // tasks is queued ahead of the one being collected.
+        QThreadPool pool;
+        pool.setMaxThreadCount(threads);
+        const std::size_t window = 2 * threads;
+        std::deque<std::shared_ptr<SectionTask> > pending;
+        size_t index = 0;
+        auto schedule = [&]() {
+            while(index < heights.size() && pending.size() < window) {
+                auto task = std::make_shared<SectionTask>();
+                task->index = index;
+                task->z = heights[index++];
+                pool.start(new SectionRunnable([task,&makeSection]() {
+                    makeSection(*task);
+                    task->done.release();
+                }));
+                pending.push_back(task);
+            }
+        };
+        for(schedule(); pending.size(); schedule()) {
+            auto task = pending.front();
+            pending.pop_front();
+            task->done.acquire();
+            if(task->error) {
+                // discard queued tasks, the pool waits for the running ones
+                pool.clear();
             }
+            addSection(*task);
         }
     }
-    FC_TIME_LOG(t,"makeSection count: " << sections.size()<<", total");
+    FC_TIME_LOG(t,"makeSection count: " << sections.size()<<", threads: " << threads << ", total");
     return sections;
 }
 
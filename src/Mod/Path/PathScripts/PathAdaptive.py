@@ -431,6 +431,9 @@ def Execute(op,obj):
             a2d.tolerance = float(obj.Tolerance)
             a2d.forceInsideOut = obj.ForceInsideOut
             a2d.opType = opType
+            prefs = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Path")
+            a2d.threadCount = prefs.GetInt("AdaptiveThreads", 1)
+            a2d.useRasterClearedArea = prefs.GetBool("AdaptiveRasterClearedArea", False)
 
             # EXECUTE
             results = a2d.Execute(stockPath2d,path2d,progressFn)
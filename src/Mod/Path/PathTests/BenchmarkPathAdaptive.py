@@ -0,0 +1,48 @@
+# -*- coding: utf-8 -*-
+
+# ***************************************************************************
+# *                                                                         *
+# *   Copyright (c) 2020 FreeCAD Developers                                 *
+# *                                                                         *
+# *   This program is free software; you can redistribute it and/or modify  *
+# *   it under the terms of the GNU Lesser General Public License (LGPL)    *
+# *   as published by the Free Software Foundation; either version 2 of     *
+# *   the License, or (at your option) any later version.                   *
+# *   for detail see the LICENCE text file.                                 *
+# *                                                                         *
+# *   This program is distributed in the hope that it will be useful,       *
+# *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+# *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+# *   GNU Library General Public License for more details.                  *
+# *                                                                         *
+# *   You should have received a copy of the GNU Library General Public     *
+# *   License along with this program; if not, write to the Free Software   *
+# *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+# *   USA                                                                   *
+# *                                                                         *
+# ***************************************************************************
+
+# Benchmark harness of Adaptive2d over the reference pockets. It is not part
+# of TestPathApp, run it explicitly with
+#   FreeCAD -t PathTests.BenchmarkPathAdaptive
+
+import FreeCAD
+import time
+import unittest
+
+from PathTests.TestPathAdaptive import Pockets, runAdaptive
+
+class BenchmarkPathAdaptive(unittest.TestCase):
+    '''Benchmark of Adaptive2d over reference pockets, reporting the time and
+    the path length of the serial, multi threaded and raster modes.'''
+
+    def test00(self):
+        '''Time each reference pocket in each mode.'''
+        modes = [(1, False), (0, False), (1, True), (4, True)]
+        for pocket in Pockets:
+            for (threadCount, useRaster) in modes:
+                start = time.time()
+                (cutLength, linkLength, output) = runAdaptive(pocket, threadCount, useRaster)
+                duration = time.time() - start
+                FreeCAD.Console.PrintMessage('Adaptive %s threads %d raster %d: time %.3f s, cut %.1f mm, link %.1f mm\n'
+                        % (pocket[0], threadCount, useRaster, duration, cutLength, linkLength))
@@ -0,0 +1,85 @@
+# -*- coding: utf-8 -*-
+
+# ***************************************************************************
+# *                                                                         *
+# *   Copyright (c) 2020 FreeCAD Developers                                 *
+# *                                                                         *
+# *   This program is free software; you can redistribute it and/or modify  *
+# *   it under the terms of the GNU Lesser General Public License (LGPL)    *
+# *   as published by the Free Software Foundation; either version 2 of     *
+# *   the License, or (at your option) any later version.                   *
+# *   for detail see the LICENCE text file.                                 *
+# *                                                                         *
+# *   This program is distributed in the hope that it will be useful,       *
+# *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+# *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+# *   GNU Library General Public License for more details.                  *
+# *                                                                         *
+# *   You should have received a copy of the GNU Library General Public     *
+# *   License along with this program; if not, write to the Free Software   *
+# *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+# *   USA                                                                   *
+# *                                                                         *
+# ***************************************************************************
+
+import FreeCAD
+import area
+import math
+import unittest
+
+def rect(x, y, w, h):
+    return [(x, y), (x + w, y), (x + w, y + h), (x, y + h)]
+
+def circle(cx, cy, r, n=48):
+    # clockwise, i.e. a hole
+    return [(cx + r * math.cos(-2 * math.pi * i / n), cy + r * math.sin(-2 * math.pi * i / n)) for i in range(n)]
+
+# reference pockets: name, paths, stock, tool diameter, step over factor
+Pockets = [
+    ('rect', [rect(0, 0, 60, 40)], [rect(-5, -5, 70, 50)], 6, 0.2),
+    ('L', [[(0, 0), (50, 0), (50, 15), (15, 15), (15, 45), (0, 45)]], [rect(-5, -5, 60, 55)], 5, 0.25),
+    ('islands', [rect(0, 0, 60, 45), circle(15, 15, 5), circle(40, 28, 7)], [rect(-5, -5, 70, 55)], 4, 0.2),
+    ('multi', [rect(i * 30, j * 30, 25, 25) for i in range(3) for j in range(2)], [rect(-5, -5, 95, 65)], 3, 0.2),
+]
+
+def runAdaptive(pocket, threadCount, useRaster):
+    '''runAdaptive(pocket, threadCount, useRaster) ... returns (cut length, link length, results)'''
+    (name, paths, stock, tool, stepOver) = pocket
+    a2d = area.Adaptive2d()
+    a2d.toolDiameter = tool
+    a2d.stepOverFactor = stepOver
+    a2d.tolerance = 0.1
+    a2d.opType = area.AdaptiveOperationType.ClearingInside
+    a2d.threadCount = threadCount
+    a2d.useRasterClearedArea = useRaster
+    results = a2d.Execute(stock, paths, lambda tpaths: False)
+    cutLength = 0
+    linkLength = 0
+    output = []
+    for region in results:
+        output.append((region.HelixCenterPoint, region.StartPoint, region.ReturnMotionType))
+        for (motionType, points) in region.AdaptivePaths:
+            output.append((motionType, points))
+            length = sum(math.hypot(p2[0] - p1[0], p2[1] - p1[1]) for p1, p2 in zip(points, points[1:]))
+            if motionType == area.AdaptiveMotionType.Cutting:
+                cutLength += length
+            else:
+                linkLength += length
+    return (cutLength, linkLength, output)
+
+class TestPathAdaptive(unittest.TestCase):
+    '''Adaptive2d over reference pockets, verifying that the multi threaded
+    and raster modes produce the same tool paths.'''
+
+    def test00(self):
+        '''Verify multi threaded and raster modes against the serial reference.'''
+        modes = [(1, False), (0, False), (1, True), (4, True)]
+        for pocket in Pockets:
+            reference = None
+            for (threadCount, useRaster) in modes:
+                (cutLength, linkLength, output) = runAdaptive(pocket, threadCount, useRaster)
+                self.assertGreater(cutLength, 0)
+                if reference is None:
+                    reference = output
+                else:
+                    self.assertEqual(output, reference)
@@ -0,0 +1,64 @@
+# -*- coding: utf-8 -*-
+
+# ***************************************************************************
+# *                                                                         *
+# *   Copyright (c) 2020 FreeCAD Developers                                 *
+# *                                                                         *
+# *   This program is free software; you can redistribute it and/or modify  *
+# *   it under the terms of the GNU Lesser General Public License (LGPL)    *
+# *   as published by the Free Software Foundation; either version 2 of     *
+# *   the License, or (at your option) any later version.                   *
+# *   for detail see the LICENCE text file.                                 *
+# *                                                                         *
+# *   This program is distributed in the hope that it will be useful,       *
+# *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+# *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+# *   GNU Library General Public License for more details.                  *
+# *                                                                         *
+# *   You should have received a copy of the GNU Library General Public     *
+# *   License along with this program; if not, write to the Free Software   *
+# *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+# *   USA                                                                   *
+# *                                                                         *
+# ***************************************************************************
+
+import FreeCAD
+import Part
+import Path
+from PathTests.PathTestUtils import PathTestBase
+
+class TestPathArea(PathTestBase):
+    '''Compare the sections of Path.Area made serially and with worker threads.'''
+
+    def setUp(self):
+        self.param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Path")
+        self.threads = self.param.GetInt("SectionThreads", 0)
+
+        box = Part.makeBox(60, 40, 30)
+        hole = Part.makeCylinder(8, 30, FreeCAD.Vector(20, 20, 0))
+        cone = Part.makeCone(12, 4, 30, FreeCAD.Vector(45, 20, 0))
+        self.shape = box.cut(hole).cut(cone)
+        self.heights = [0.5 + i * 1.5 for i in range(20)]
+
+    def tearDown(self):
+        self.param.SetInt("SectionThreads", self.threads)
+
+    def makeSections(self, threads):
+        self.param.SetInt("SectionThreads", threads)
+        area = Path.Area()
+        area.add(self.shape)
+        return [s.getShape() for s in area.makeSections(mode=0, project=False, heights=self.heights)]
+
+    def test00(self):
+        '''Threaded sections match the serial ones'''
+        serial = self.makeSections(1)
+        threaded = self.makeSections(4)
+        self.assertEqual(len(serial), len(self.heights))
+        self.assertEqual(len(threaded), len(serial))
+        for s, t in zip(serial, threaded):
+            self.assertEqual(len(t.Faces), len(s.Faces))
+            self.assertEqual(len(t.Edges), len(s.Edges))
+            self.assertRoughly(t.Area, s.Area)
+            self.assertRoughly(t.BoundBox.ZMin, s.BoundBox.ZMin)
+            self.assertRoughly(t.BoundBox.XLength, s.BoundBox.XLength)
+            self.assertRoughly(t.BoundBox.YLength, s.BoundBox.YLength)
@@ -39,4 +39,6 @@ from PathTests.TestPathTooltable import TestPathTooltable
 from PathTests.TestPathToolController import TestPathToolController
 from PathTests.TestPathSetupSheet import TestPathSetupSheet
 from PathTests.TestPathDeburr  import TestPathDeburr
+from PathTests.TestPathAdaptive import TestPathAdaptive
+from PathTests.TestPathArea import TestPathArea
 
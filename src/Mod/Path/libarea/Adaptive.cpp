@@ -25,6 +25,10 @@
 #include <cstring>
 #include <ctime>
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <random>
 
 namespace ClipperLib
 {
@@ -620,8 +624,9 @@ void SmoothPaths(Paths &paths, double stepSize, long pointCount, long iterations
 				points.push_back(pair<size_t /*path index*/, IntPoint>(i, pt));
 				continue;
 			}
-			const auto &back=points.back();
-			const IntPoint & lastPt = back.second;
+			// copy, points may be reallocated below
+			const auto back=points.back();
+			const IntPoint lastPt = back.second;
 
 
 			const double l = sqrt(DistanceSqrd(lastPt, pt));
@@ -924,6 +929,116 @@ class ClearedArea
 		clearedPaths = paths;
 		bboxPathsInvalid = true;
 		bboxClippedInvalid = true;
+		if (!raster.empty())
+		{
+			std::fill(raster.begin(), raster.end(), rcNoBoundary);
+			for (const auto &pth : clearedPaths)
+			{
+				for (size_t i = 0; i < pth.size(); i++)
+					StampSegment(pth[i > 0 ? i - 1 : pth.size() - 1], pth[i], 0);
+			}
+		}
+	}
+
+	// copy of the cleared area, including the raster
+	void SetCleared(const ClearedArea &other)
+	{
+		clearedPaths = other.clearedPaths;
+		bboxPathsInvalid = true;
+		bboxClippedInvalid = true;
+		raster = other.raster;
+		rasterOrigin = other.rasterOrigin;
+		rasterCols = other.rasterCols;
+		rasterRows = other.rasterRows;
+		cellSize = other.cellSize;
+		rasterTolerance = other.rasterTolerance;
+	}
+
+	// raster of the cells where the boundary of the cleared area may pass (conservative),
+	// allows to skip the cut area calculation when the tool is not engaged
+	enum RasterCell : char
+	{
+		rcNoBoundary = 0,
+		rcBoundary = 1,
+		rcInterior = 2 // entirely inside of the cleared area, boundary cannot pass
+	};
+
+	void InitRaster(const Paths &bounds, double tolerance)
+	{
+		raster.clear();
+		BoundBox bb;
+		bool first = true;
+		for (const auto &pth : bounds)
+		{
+			for (const auto &pt : pth)
+			{
+				if (first)
+					bb.SetFirstPoint(pt);
+				else
+					bb.AddPoint(pt);
+				first = false;
+			}
+		}
+		if (first)
+			return;
+		cellSize = max(toolRadiusScaled / 4, ClipperLib::cInt(1));
+		rasterTolerance = tolerance;
+		// tool center may be at the bounds, cleared boundary is at most tool radius further
+		ClipperLib::cInt margin = 2 * toolRadiusScaled + cellSize;
+		rasterOrigin = IntPoint(bb.minX - margin, bb.minY - margin);
+		rasterCols = long((bb.maxX - bb.minX + 2 * margin) / cellSize) + 1;
+		rasterRows = long((bb.maxY - bb.minY + 2 * margin) / cellSize) + 1;
+		raster.assign(size_t(rasterCols) * size_t(rasterRows), rcNoBoundary);
+		SetClearedPaths(clearedPaths);
+	}
+
+	// returns false only if the cleared area boundary is certainly not within radius of the point
+	bool IsBoundaryNear(const IntPoint &pt, ClipperLib::cInt radius)
+	{
+		if (raster.empty())
+			return true;
+		double halfDiag = M_SQRT1_2 * double(cellSize);
+		double maxDist = double(radius) + halfDiag;
+		long minCol, maxCol, minRow, maxRow;
+		if (!CellRange(pt, pt, maxDist, minCol, maxCol, minRow, maxRow))
+			return true; // outside of the raster, unknown
+		for (long row = minRow; row <= maxRow; row++)
+		{
+			for (long col = minCol; col <= maxCol; col++)
+			{
+				if (raster[size_t(row) * size_t(rasterCols) + size_t(col)] == rcBoundary &&
+					CellDistanceSqrd(col, row, pt, pt) <= maxDist * maxDist)
+					return true;
+			}
+		}
+		return false;
+	}
+
+	// returns true only if all points within distance of the path are certainly inside of the cleared area
+	bool IsInside(const Path &path, double dist)
+	{
+		if (raster.empty() || path.empty())
+			return false;
+		double maxDist = dist + M_SQRT1_2 * double(cellSize) + rasterTolerance;
+		for (size_t i = 0; i < path.size(); i++)
+		{
+			const IntPoint &p1 = path[i > 0 ? i - 1 : 0];
+			const IntPoint &p2 = path[i];
+			long minCol, maxCol, minRow, maxRow;
+			if (!CellRange(p1, p2, maxDist, minCol, maxCol, minRow, maxRow) ||
+				minCol == 0 || minRow == 0 || maxCol == rasterCols - 1 || maxRow == rasterRows - 1)
+				return false; // reaching outside of the raster, unknown
+			for (long row = minRow; row <= maxRow; row++)
+			{
+				for (long col = minCol; col <= maxCol; col++)
+				{
+					if (raster[size_t(row) * size_t(rasterCols) + size_t(col)] != rcInterior &&
+						CellDistanceSqrd(col, row, p1, p2) <= maxDist * maxDist)
+						return false;
+				}
+			}
+		}
+		return true;
 	}
 	void ExpandCleared(const Path toClearToolPath)
 	{
@@ -941,6 +1056,15 @@ class ClearedArea
 		CleanPolygons(clearedPaths);
 		bboxPathsInvalid = true;
 		bboxClippedInvalid = true;
+		if (!raster.empty())
+		{
+			// new boundary is on the boundary of the tool cover, but not in the interior of the union
+			double coverRadius = double(toolRadiusScaled + 1);
+			for (size_t i = 0; i < toClearToolPath.size(); i++)
+				StampSegment(toClearToolPath[i > 0 ? i - 1 : 0], toClearToolPath[i], coverRadius);
+			for (size_t i = 0; i < toClearToolPath.size(); i++)
+				ClearSegmentInterior(toClearToolPath[i > 0 ? i - 1 : 0], toClearToolPath[i], coverRadius);
+		}
 		Perf_ExpandCleared.Stop();
 	}
 
@@ -1028,11 +1152,83 @@ class ClearedArea
 	}
 
   private:
+	// range of raster cells within distance of the segment bound box, false if none
+	bool CellRange(const IntPoint &p1, const IntPoint &p2, double dist, long &minCol, long &maxCol, long &minRow, long &maxRow)
+	{
+		minCol = max(long(floor((min(p1.X, p2.X) - dist - rasterOrigin.X) / cellSize)), 0L);
+		maxCol = min(long(floor((max(p1.X, p2.X) + dist - rasterOrigin.X) / cellSize)), rasterCols - 1);
+		minRow = max(long(floor((min(p1.Y, p2.Y) - dist - rasterOrigin.Y) / cellSize)), 0L);
+		maxRow = min(long(floor((max(p1.Y, p2.Y) + dist - rasterOrigin.Y) / cellSize)), rasterRows - 1);
+		return minCol <= maxCol && minRow <= maxRow;
+	}
+
+	// squared distance from the cell center to the segment
+	double CellDistanceSqrd(long col, long row, const IntPoint &p1, const IntPoint &p2)
+	{
+		double cx = rasterOrigin.X + (col + 0.5) * cellSize;
+		double cy = rasterOrigin.Y + (row + 0.5) * cellSize;
+		double dx = double(p2.X - p1.X);
+		double dy = double(p2.Y - p1.Y);
+		double lenSqrd = dx * dx + dy * dy;
+		double par = lenSqrd > 0 ? ((cx - p1.X) * dx + (cy - p1.Y) * dy) / lenSqrd : 0;
+		par = max(0.0, min(1.0, par));
+		double ex = p1.X + par * dx - cx;
+		double ey = p1.Y + par * dy - cy;
+		return ex * ex + ey * ey;
+	}
+
+	// mark cells that may contain points at the given distance from the segment,
+	// unless already known to be inside of the cleared area
+	void StampSegment(const IntPoint &p1, const IntPoint &p2, double dist)
+	{
+		double halfDiag = M_SQRT1_2 * double(cellSize) + rasterTolerance;
+		double maxDist = dist + halfDiag;
+		double minDist = dist - halfDiag;
+		long minCol, maxCol, minRow, maxRow;
+		if (!CellRange(p1, p2, maxDist, minCol, maxCol, minRow, maxRow))
+			return;
+		for (long row = minRow; row <= maxRow; row++)
+		{
+			for (long col = minCol; col <= maxCol; col++)
+			{
+				char &cell = raster[size_t(row) * size_t(rasterCols) + size_t(col)];
+				if (cell == rcInterior)
+					continue;
+				double d = CellDistanceSqrd(col, row, p1, p2);
+				if (d <= maxDist * maxDist && (minDist <= 0 || d >= minDist * minDist))
+					cell = rcBoundary;
+			}
+		}
+	}
+
+	// mark cells that are entirely inside the given distance from the segment as interior
+	void ClearSegmentInterior(const IntPoint &p1, const IntPoint &p2, double dist)
+	{
+		double maxDist = dist - M_SQRT1_2 * double(cellSize) - rasterTolerance;
+		long minCol, maxCol, minRow, maxRow;
+		if (maxDist <= 0 || !CellRange(p1, p2, maxDist, minCol, maxCol, minRow, maxRow))
+			return;
+		for (long row = minRow; row <= maxRow; row++)
+		{
+			for (long col = minCol; col <= maxCol; col++)
+			{
+				if (CellDistanceSqrd(col, row, p1, p2) <= maxDist * maxDist)
+					raster[size_t(row) * size_t(rasterCols) + size_t(col)] = rcInterior;
+			}
+		}
+	}
+
 	Clipper clip;
 	ClipperOffset clipof;
 	Paths clearedPaths;
 	Paths clearedBoundedClipped;
 	Paths clearedBoundedPaths;
+	vector<char> raster;
+	IntPoint rasterOrigin;
+	long rasterCols = 0;
+	long rasterRows = 0;
+	ClipperLib::cInt cellSize = 1;
+	double rasterTolerance = 0;
 
 	ClipperLib::cInt toolRadiusScaled;
 	BoundBox clearedBBClippedInFocus;
@@ -1111,9 +1307,10 @@ class Interpolation
 		return angle;
 	}
 
+	// own generator, so that the result of a region does not depend on other regions or threads
 	double getRandomAngle()
 	{
-		return MIN_ANGLE + (MAX_ANGLE - MIN_ANGLE) * double(rand()) / double(RAND_MAX);
+		return MIN_ANGLE + (MAX_ANGLE - MIN_ANGLE) * double(generator() - generator.min()) / double(generator.max() - generator.min());
 	}
 	size_t getPointCount()
 	{
@@ -1123,6 +1320,7 @@ class Interpolation
   private:
 	vector<double> angles;
 	vector<double> areas;
+	std::minstd_rand generator;
 };
 
 //***************************************
@@ -1357,6 +1555,10 @@ double Adaptive2d::CalcCutArea(Clipper &clip, const IntPoint &c1, const IntPoint
 	if (dist < NTOL)
 		return 0;
 
+	// no cleared boundary within the tool - area is zero
+	if (!clearedArea.IsBoundaryNear(c2, toolRadiusScaled))
+		return 0;
+
 	Perf_CalcCutAreaCirc.Start();
 
 	/// new alg
@@ -1379,7 +1581,7 @@ double Adaptive2d::CalcCutArea(Clipper &clip, const IntPoint &c1, const IntPoint
 		BoundBox pathBB(path.front());
 		for (const auto &pt : path)
 			pathBB.AddPoint(pt);
-		if (!c2BB.CollidesWith(c2))
+		if (!c2BB.CollidesWith(pathBB))
 			continue; // this path cannot colide with tool
 		//** end of BB check
 
@@ -1683,7 +1885,6 @@ std::list<AdaptiveOutput> Adaptive2d::Execute(const DPaths &stockPaths, const DP
 
 	//scaleFactor = round(scaleFactor);
 
-	current_region=0;
 	cout << "Tool Diameter: " << toolDiameter << endl;
 	cout << "Accuracy: " << round(10000.0/scaleFactor)/10 << " um" << endl;
 	cout << flush;
@@ -1691,7 +1892,7 @@ std::list<AdaptiveOutput> Adaptive2d::Execute(const DPaths &stockPaths, const DP
 	toolRadiusScaled = long(toolDiameter * scaleFactor / 2);
 	stepOverScaled = toolRadiusScaled * stepOverFactor;
 	progressCallback = &progressCallbackFn;
-	lastProgressTime = clock();
+	callerThread = std::this_thread::get_id();
 	stopProcessing = false;
 
 	if(helixRampDiameter<NTOL)
@@ -1772,6 +1973,7 @@ std::list<AdaptiveOutput> Adaptive2d::Execute(const DPaths &stockPaths, const DP
 	//***************************************
 	//	Resolve hierarchy and run processing
 	//***************************************
+	std::vector<Region> regions;
 	double cornerRoundingOffset = 0.15 * toolRadiusScaled / 2;
 	if (opType == OperationType::otClearingInside || opType == OperationType::otClearingOutside)
 	{
@@ -1825,7 +2027,7 @@ std::list<AdaptiveOutput> Adaptive2d::Execute(const DPaths &stockPaths, const DP
 				clipof.Clear();
 				clipof.AddPaths(toolBoundPaths, JoinType::jtRound, EndType::etClosedPolygon);
 				clipof.Execute(boundPaths, toolRadiusScaled + finishPassOffsetScaled);
-				ProcessPolyNode(boundPaths, toolBoundPaths);
+				regions.push_back(Region{boundPaths, toolBoundPaths});
 			}
 		}
 	}
@@ -1884,11 +2086,12 @@ std::list<AdaptiveOutput> Adaptive2d::Execute(const DPaths &stockPaths, const DP
 					clipof.AddPaths(toolBoundPaths, JoinType::jtRound, EndType::etClosedPolygon);
 					clipof.Execute(boundPaths, toolRadiusScaled + finishPassOffsetScaled);
 
-					ProcessPolyNode(boundPaths, toolBoundPaths);
+					regions.push_back(Region{boundPaths, toolBoundPaths});
 				}
 			}
 		}
 	}
+	ProcessRegions(regions);
 	return results;
 }
 
@@ -2055,6 +2258,11 @@ bool Adaptive2d::FindEntryPointOutside(TPaths &progressPaths, const Paths &toolB
 bool Adaptive2d::IsClearPath(const Path &tp, ClearedArea &cleared, double safetyClearance)
 {
 	Perf_IsClearPath.Start();
+	if (cleared.IsInside(tp, toolRadiusScaled + safetyClearance))
+	{
+		Perf_IsClearPath.Stop();
+		return true;
+	}
 	Clipper clip;
 	ClipperOffset clipof;
 	clipof.AddPath(tp, JoinType::jtRound, EndType::etOpenRound);
@@ -2544,7 +2752,7 @@ void Adaptive2d::AppendToolPath(TPaths &progressPaths, AdaptiveOutput &output,
 	Perf_AppendToolPath.Stop();
 }
 
-void Adaptive2d::CheckReportProgress(TPaths &progressPaths, bool force)
+void Adaptive2d::CheckReportProgress(TPaths &progressPaths, clock_t &lastProgressTime, bool force)
 {
 	if (!force && (clock() - lastProgressTime < PROGRESS_TICKS))
 		return; // not yet
@@ -2552,8 +2760,19 @@ void Adaptive2d::CheckReportProgress(TPaths &progressPaths, bool force)
 	if (progressPaths.size() == 0)
 		return;
 	if (progressCallback)
-		if ((*progressCallback)(progressPaths))
-			stopProcessing = true; // call python function, if returns true signal stop processing
+	{
+		if (std::this_thread::get_id() == callerThread)
+		{
+			if ((*progressCallback)(progressPaths))
+				stopProcessing = true; // call python function, if returns true signal stop processing
+		}
+		else
+		{
+			// worker thread - paths are passed to callback by the calling thread, see ProcessRegions
+			std::lock_guard<std::mutex> lock(progressMutex);
+			pendingProgress.insert(pendingProgress.end(), progressPaths.begin(), progressPaths.end());
+		}
+	}
 	// clean the paths - keep the last point
 	if (progressPaths.back().second.size() == 0)
 		return;
@@ -2594,11 +2813,107 @@ void Adaptive2d::AddPathToProgress(TPaths &progressPaths, const Path pth, Motion
 	}
 }
 
-void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
+//********************************************
+// Processing of separate regions
+//********************************************
+
+void Adaptive2d::ProcessRegions(const std::vector<Region> &regions)
+{
+	size_t threads = threadCount > 0 ? size_t(threadCount) : size_t(std::thread::hardware_concurrency());
+#ifdef DEV_MODE
+	threads = 1; // perf counters and debug drawing are not thread safe
+#endif
+	threads = min(threads, regions.size());
+	if (threads <= 1)
+	{
+		for (size_t i = 0; i < regions.size(); i++)
+		{
+			AdaptiveOutput output;
+			if (ProcessPolyNode(i, regions[i].boundPaths, regions[i].toolBoundPaths, output))
+				results.push_back(output);
+		}
+		return;
+	}
+
+	// regions are independent, each worker takes the next unprocessed one
+	// results are collected in region order, so the output does not depend on the number of threads
+	vector<AdaptiveOutput> outputs(regions.size());
+	vector<char> valid(regions.size(), 0);
+	vector<std::exception_ptr> errors(regions.size());
+	std::atomic<size_t> nextRegion{0};
+	size_t finished = 0;
+	std::condition_variable finishedCondition;
+	pendingProgress.clear();
+
+	auto worker = [&]() {
+		for (size_t i = nextRegion++; i < regions.size(); i = nextRegion++)
+		{
+			try
+			{
+				valid[i] = ProcessPolyNode(i, regions[i].boundPaths, regions[i].toolBoundPaths, outputs[i]);
+			}
+			catch (...)
+			{
+				errors[i] = std::current_exception();
+				stopProcessing = true;
+			}
+			std::lock_guard<std::mutex> lock(progressMutex);
+			finished++;
+			finishedCondition.notify_one();
+		}
+	};
+
+	vector<std::thread> workers;
+	for (size_t i = 0; i < threads; i++)
+		workers.emplace_back(worker);
+
+	// progress callback calls python, so the progress of workers is reported from this thread
+	std::exception_ptr callbackError;
+	const auto interval = std::chrono::milliseconds(1000 * PROGRESS_TICKS / CLOCKS_PER_SEC);
+	for (;;)
+	{
+		TPaths progressPaths;
+		bool done;
+		{
+			std::unique_lock<std::mutex> lock(progressMutex);
+			finishedCondition.wait_for(lock, interval, [&]() { return finished == regions.size(); });
+			progressPaths.swap(pendingProgress);
+			done = finished == regions.size();
+		}
+		if (!progressPaths.empty() && progressCallback && !callbackError)
+		{
+			try
+			{
+				if ((*progressCallback)(progressPaths))
+					stopProcessing = true;
+			}
+			catch (...)
+			{
+				callbackError = std::current_exception();
+				stopProcessing = true;
+			}
+		}
+		if (done)
+			break;
+	}
+	for (auto &thread : workers)
+		thread.join();
+
+	if (callbackError)
+		std::rethrow_exception(callbackError);
+	for (size_t i = 0; i < regions.size(); i++)
+	{
+		if (errors[i])
+			std::rethrow_exception(errors[i]);
+		if (valid[i])
+			results.push_back(outputs[i]);
+	}
+}
+
+bool Adaptive2d::ProcessPolyNode(size_t region, Paths boundPaths, Paths toolBoundPaths, AdaptiveOutput &output)
 {
 	Perf_ProcessPolyNode.Start();
-	current_region++;
-	cout << "** Processing region: " << current_region << endl;
+	cout << "** Processing region: " << region + 1 << endl;
 
 	// node paths are already constrained to tool boundary path for adaptive path before finishing pass
 	Clipper clip;
@@ -2607,6 +2922,7 @@ void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
 	IntPoint entryPoint;
 	TPaths progressPaths;
 	progressPaths.reserve(10000);
+	clock_t lastProgressTime = clock();
 
 	CleanPolygons(toolBoundPaths);
 	SimplifyPolygons(toolBoundPaths);
@@ -2619,6 +2935,8 @@ void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
 	IntPoint toolPos;
 	DoublePoint toolDir;
 	ClearedArea cleared(toolRadiusScaled);
+	if (useRasterClearedArea)
+		cleared.InitRaster(toolBoundPaths, RESOLUTION_FACTOR);
 	bool outsideEntry = false;
 	bool firstEngagePoint = true;
 	Paths engageBounds = toolBoundPaths;
@@ -2643,7 +2961,7 @@ void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
 		if (!FindEntryPoint(progressPaths, toolBoundPaths, boundPaths, cleared, entryPoint, toolPos, toolDir))
 		{
 			Perf_ProcessPolyNode.Stop();
-			return;
+			return false;
 		}
 	}
 
@@ -2660,7 +2978,6 @@ void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
 
 	//cout << "Entry point:" << double(entryPoint.X)/scaleFactor << "," << double(entryPoint.Y)/scaleFactor << endl;
 
-	AdaptiveOutput output;
 	output.HelixCenterPoint.first = double(entryPoint.X) / scaleFactor;
 	output.HelixCenterPoint.second = double(entryPoint.Y) / scaleFactor;
 
@@ -2670,7 +2987,7 @@ void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
 	IntPoint newToolPos;
 	DoublePoint newToolDir;
 
-	CheckReportProgress(progressPaths, true);
+	CheckReportProgress(progressPaths, lastProgressTime, true);
 
 	IntPoint startPoint = toolPos;
 	output.StartPoint = DPoint(double(startPoint.X) / scaleFactor, double(startPoint.Y) / scaleFactor);
@@ -2699,7 +3016,7 @@ void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
 	clock_t start_clock = clock();
 #endif
 	ClearedArea clearedBeforePass(toolRadiusScaled);
-	clearedBeforePass.SetClearedPaths(cleared.GetCleared());
+	clearedBeforePass.SetCleared(cleared);
 
 	//*******************************
 	// LOOP - PASSES
@@ -2738,7 +3055,7 @@ void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
 		double clpParamter;
 		double passLength = 0;
 		double noCutDistance=0;
-		clearedBeforePass.SetClearedPaths(cleared.GetCleared());
+		clearedBeforePass.SetCleared(cleared);
 		//*******************************
 		// LOOP - POINTS
 		//*******************************
@@ -2924,7 +3241,7 @@ void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
 				// append gyro
 				gyro.push_back(newToolDir);
 				gyro.erase(gyro.begin());
-				CheckReportProgress(progressPaths);
+				CheckReportProgress(progressPaths, lastProgressTime);
 			}
 			else
 			{
@@ -2951,7 +3268,7 @@ void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
 			CleanPath(passToolPath, cleaned, CLEAN_PATH_TOLERANCE);
 			total_output_points += long(cleaned.size());
 			AppendToolPath(progressPaths, output, cleaned, clearedBeforePass, cleared, toolBoundPaths);
-			CheckReportProgress(progressPaths);
+			CheckReportProgress(progressPaths, lastProgressTime);
 			bad_engage_count = 0;
 			engage.ResetPasses();
 		}
@@ -3116,7 +3433,7 @@ void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
 	Perf_IsAllowedToCutTrough.DumpResults();
 	Perf_IsClearPath.DumpResults();
 #endif
-	CheckReportProgress(progressPaths, true);
+	CheckReportProgress(progressPaths, lastProgressTime, true);
 #ifdef DEV_MODE
 	double duration = ((double)(clock() - start_clock)) / CLOCKS_PER_SEC;
 	cout << "PolyNode perf:" << perf_total_len / double(scaleFactor) / duration << " mm/sec"
@@ -3135,7 +3452,7 @@ void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
 			 << "Hint: try to modify accuracy and/or step-over." << endl;
 	}
 
-	results.push_back(output);
+	return true;
 }
 
 } // namespace AdaptivePath
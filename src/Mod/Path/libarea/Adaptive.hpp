@@ -22,6 +22,10 @@
 #include "clipper.hpp"
 #include <vector>
 #include <list>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
 #include <time.h>
 
 #ifndef ADAPTIVE_HPP
@@ -80,7 +84,7 @@ struct AdaptiveOutput
 	int ReturnMotionType; // MotionType enum, problem with serialization if enum is used
 };
 
-// used to isolate state -> enable potential adding of multi-threaded processing of separate regions
+// used to isolate state -> separate regions may be processed by multiple threads
 
 class Adaptive2d
 {
@@ -94,6 +98,8 @@ class Adaptive2d
 	bool forceInsideOut = true;
 	double keepToolDownDistRatio = 3.0; // keep tool down distance ratio
 	OperationType opType = OperationType::otClearingInside;
+	int threadCount = 1;				// number of threads processing separate regions, 0 - use all cores
+	bool useRasterClearedArea = false;	// use raster of cleared area to speed up engagement and clear path queries
 
 	std::list<AdaptiveOutput> Execute(const DPaths &stockPaths, const DPaths &paths, std::function<bool(TPaths)> progressCallbackFn);
 
@@ -105,6 +111,12 @@ class Adaptive2d
 #endif
 
   private:
+	struct Region
+	{
+		Paths boundPaths;
+		Paths toolBoundPaths;
+	};
+
 	std::list<AdaptiveOutput> results;
 	Paths inputPaths;
 	Paths stockInputPaths;
@@ -116,14 +128,16 @@ class Adaptive2d
 	long helixRampRadiusScaled = 0;
 	double referenceCutArea = 0;
 	double optimalCutAreaPD = 0;
-	bool stopProcessing = false;
-	int current_region=0;
-	clock_t lastProgressTime = 0;
+	std::atomic<bool> stopProcessing{false};
 
 	std::function<bool(TPaths)> *progressCallback = NULL;
+	std::thread::id callerThread; // progress callback is only called from the thread calling Execute
+	std::mutex progressMutex;
+	TPaths pendingProgress; // progress paths reported by worker threads
 	Path toolGeometry; // tool geometry at coord 0,0, should not be modified
 
-	void ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths);
+	void ProcessRegions(const std::vector<Region> &regions);
+	bool ProcessPolyNode(size_t region, Paths boundPaths, Paths toolBoundPaths, AdaptiveOutput &output);
 	bool FindEntryPoint(TPaths &progressPaths, const Paths &toolBoundPaths, const Paths &bound, ClearedArea &cleared /*output*/,
 						IntPoint &entryPoint /*output*/, IntPoint &toolPos, DoublePoint &toolDir);
 	bool FindEntryPointOutside(TPaths &progressPaths, const Paths &toolBoundPaths, const Paths &bound, ClearedArea &cleared /*output*/,
@@ -140,7 +154,7 @@ class Adaptive2d
 
 	friend class EngagePoint; // for CalcCutArea
 
-	void CheckReportProgress(TPaths &progressPaths, bool force = false);
+	void CheckReportProgress(TPaths &progressPaths, clock_t &lastProgressTime, bool force = false);
 	void AddPathsToProgress(TPaths &progressPaths, const Paths paths, MotionType mt = MotionType::mtCutting);
 	void AddPathToProgress(TPaths &progressPaths, const Path pth, MotionType mt = MotionType::mtCutting);
 	void ApplyStockToLeave(Paths &inputPaths);
@@ -29,7 +29,10 @@
 #include <Base/Console.h>
 #include <Base/Interpreter.h>
 
+#include "PagedPoints.h"
+#include "PagedPointsPy.h"
 #include "Points.h"
+#include "PointsFeature.h"
 #include "PointsPy.h"
 #include "Properties.h"
 #include "PropertyPointKernel.h"
@@ -47,6 +50,7 @@ PyMOD_INIT_FUNC(Points)
 
     // add python types
     Base::Interpreter().addType(&Points::PointsPy::Type, pointsModule, "Points");
+    Base::Interpreter().addType(&Points::PagedPointsPy::Type, pointsModule, "PagedPoints");
 
     // add properties
     Points::PropertyGreyValue     ::init();
@@ -54,12 +58,15 @@ PyMOD_INIT_FUNC(Points)
     Points::PropertyNormalList    ::init();
     Points::PropertyCurvatureList ::init();
     Points::PropertyPointKernel   ::init();
+    Points::PropertyPagedPoints   ::init();
 
     // add data types
+    Points::PagedPointKernel      ::init();
     Points::Feature               ::init();
     Points::Structured            ::init();
     Points::FeatureCustom         ::init();
     Points::StructuredCustom      ::init();
     Points::FeaturePython         ::init();
+    Points::PagedFeature          ::init();
     PyMOD_Return(pointsModule);
 }
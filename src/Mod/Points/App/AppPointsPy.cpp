@@ -40,7 +40,9 @@
 #include <App/DocumentObjectPy.h>
 #include <App/Property.h>
 
+#include "PagedPoints.h"
 #include "Points.h"
+#include "PointsFeature.h"
 #include "PointsPy.h"
 #include "PointsAlgos.h"
 #include "Structured.h"
@@ -61,6 +63,12 @@ public:
         add_varargs_method("show",&Module::show,
             "show(points,[string]) -- Add the points to the active document or create one if no document exists."
         );
+        add_varargs_method("buildOctree",&Module::buildOctree,
+            "buildOctree(string,list,[int,int]) -- Write an octree file which can be opened paged.\n"
+            "The list contains Points objects or the names of point files which are read one\n"
+            "after the other. The optional numbers are the maximum number of points of a leaf\n"
+            "and the number of points an inner node keeps as level of detail."
+        );
         initialize("This module is the Points module."); // register with Python
     }
 
@@ -83,6 +91,12 @@ private:
             if (file.extension().empty())
                 throw Py::RuntimeError("No file extension");
 
+            if (file.hasExtension("oct")) {
+                App::Document *pcDoc = App::GetApplication().newDocument("Unnamed");
+                addPagedFeature(pcDoc, file);
+                return Py::None();
+            }
+
             std::unique_ptr<Reader> reader;
             if (file.hasExtension("asc")) {
                 reader.reset(new AscReader);
@@ -195,6 +209,15 @@ private:
             if (file.extension().empty())
                 throw Py::RuntimeError("No file extension");
 
+            if (file.hasExtension("oct")) {
+                App::Document *pcDoc = App::GetApplication().getDocument(DocName);
+                if (!pcDoc) {
+                    pcDoc = App::GetApplication().newDocument(DocName);
+                }
+                addPagedFeature(pcDoc, file);
+                return Py::None();
+            }
+
             std::unique_ptr<Reader> reader;
             if (file.hasExtension("asc")) {
                 reader.reset(new AscReader);
@@ -356,6 +379,11 @@ private:
                         writer->setNormals(nor->getValues());
                     }
 
+                    // PLY and PCD files can be written in binary format
+                    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+                        ("User parameter:BaseApp/Preferences/Mod/Points");
+                    writer->setBinary(hGrp->GetBool("ExportBinary", false));
+
                     writer->setPlacement(globalPlacement);
                     writer->write(encodedName);
 
@@ -392,6 +420,76 @@ private:
 
         return Py::None();
     }
+
+    Py::Object buildOctree(const Py::Tuple& args)
+    {
+        char* Name;
+        PyObject* sources;
+        unsigned long leafSize = 65536;
+        unsigned long detailSize = 8192;
+        if (!PyArg_ParseTuple(args.ptr(), "etO|kk", "utf-8", &Name, &sources, &leafSize, &detailSize))
+            throw Py::Exception();
+        std::string EncodedName = std::string(Name);
+        PyMem_Free(Name);
+
+        try {
+            OctreeBuilder builder(EncodedName);
+            builder.setLeafSize(leafSize);
+            builder.setDetailSize(detailSize);
+
+            Py::Sequence list(sources);
+            for (Py::Sequence::iterator it = list.begin(); it != list.end(); ++it) {
+                PyObject* item = (*it).ptr();
+                if (PyObject_TypeCheck(item, &(PointsPy::Type))) {
+                    builder.addPoints(*static_cast<PointsPy*>(item)->getPointKernelPtr());
+                }
+                else if ((*it).isString()) {
+                    std::string fn = Py::String(*it).as_std_string("utf-8");
+                    Base::FileInfo file(fn);
+                    std::unique_ptr<Reader> reader;
+                    if (file.hasExtension("asc")) {
+                        reader.reset(new AscReader);
+                    }
+                    else if (file.hasExtension("ply")) {
+                        reader.reset(new PlyReader);
+                    }
+                    else if (file.hasExtension("pcd")) {
+                        reader.reset(new PcdReader);
+                    }
+                    else {
+                        throw Py::RuntimeError("Unsupported file extension");
+                    }
+
+                    // only one file is kept in memory at a time
+                    reader->read(fn);
+                    builder.addPoints(reader->getPoints());
+                }
+                else {
+                    throw Py::TypeError("expect a list of Points objects or file names");
+                }
+            }
+
+            builder.build();
+        }
+        catch (const Base::Exception& e) {
+            throw Py::RuntimeError(e.what());
+        }
+
+        return Py::None();
+    }
+
+    void addPagedFeature(App::Document* pcDoc, const Base::FileInfo& file)
+    {
+        // octree files are not loaded but opened paged
+        std::unique_ptr<Points::PagedFeature> feature(new Points::PagedFeature());
+        feature->Points.setValue(file.filePath());
+
+        // delayed adding of the points feature
+        Points::PagedFeature *pcFeature = feature.release();
+        pcDoc->addObject(pcFeature, file.fileNamePure().c_str());
+        pcDoc->recomputeFeature(pcFeature);
+        pcFeature->purgeTouched();
+    }
 };
 
 PyObject* initModule()
@@ -0,0 +1,1043 @@
+/***************************************************************************
+ *   Copyright (c) 2020 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+#ifndef _PreComp_
+# include <algorithm>
+# include <cmath>
+# include <cstring>
+# include <queue>
+# include <sstream>
+#endif
+
+#include <QFile>
+#include <QMutex>
+#include <QReadWriteLock>
+
+#include <Base/Exception.h>
+#include <Base/FileInfo.h>
+#include <Base/Reader.h>
+#include <Base/Stream.h>
+#include <Base/Writer.h>
+
+#include "PagedPoints.h"
+#include "Points.h"
+
+using namespace Points;
+
+namespace {
+
+// The file starts with a header, followed by the points of all leaves, the
+// level of detail of the inner nodes and the node table. The points are
+// mapped into memory as they are, so all numbers are stored in the byte order
+// of the machine which has written the file. The header keeps a marker to
+// detect files of a different byte order.
+const char octreeMagic[8] = { 'F', 'C', 'O', 'C', 'T', 'R', 'E', 'E' };
+const uint32_t octreeVersion = 1;
+const uint32_t byteOrderMark = 0x01020304;
+const uint32_t swappedByteOrderMark = 0x04030201;
+const std::size_t headerSize = 8 + 4 * 4 + 5 * 8 + 6 * 4;
+const std::size_t nodeSize = 6 * 4 + 8 * 4 + 3 * 8 + 2 * 4;
+const std::size_t pointSize = 3 * sizeof(float);
+// limits the depth for clouds with many identical points
+const int maxDepth = 24;
+
+struct OctreeNode
+{
+    Base::BoundBox3f box;
+    int32_t child[8];
+    // the points of a leaf or the level of detail of an inner node
+    uint64_t first;
+    uint64_t count;
+    // number of points in the sub-tree
+    uint64_t total;
+    uint32_t leaf;
+    uint32_t level;
+
+    OctreeNode() : first(0), count(0), total(0), leaf(0), level(0)
+    {
+        for (int i = 0; i < 8; i++)
+            child[i] = -1;
+    }
+};
+
+template <typename T>
+void put(char*& p, T value)
+{
+    memcpy(p, &value, sizeof(T));
+    p += sizeof(T);
+}
+
+template <typename T>
+T get(const char*& p)
+{
+    T value;
+    memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return value;
+}
+
+void putBox(char*& p, const Base::BoundBox3f& box)
+{
+    put(p, box.MinX); put(p, box.MinY); put(p, box.MinZ);
+    put(p, box.MaxX); put(p, box.MaxY); put(p, box.MaxZ);
+}
+
+Base::BoundBox3f getBox(const char*& p)
+{
+    Base::BoundBox3f box;
+    box.MinX = get<float>(p); box.MinY = get<float>(p); box.MinZ = get<float>(p);
+    box.MaxX = get<float>(p); box.MaxY = get<float>(p); box.MaxZ = get<float>(p);
+    return box;
+}
+
+void takeEvery(const std::vector<Base::Vector3f>& points, std::size_t count,
+               std::vector<Base::Vector3f>& sample)
+{
+    if (count >= points.size()) {
+        sample.insert(sample.end(), points.begin(), points.end());
+        return;
+    }
+    for (std::size_t i = 0; i < count; i++)
+        sample.push_back(points[i * points.size() / count]);
+}
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+class OctreeBuilder::Output
+{
+public:
+    Output(const std::string& filename, const std::string& detailFile)
+        : file(Base::FileInfo(filename), std::ios::out | std::ios::binary)
+        , detailName(detailFile)
+        , detail(Base::FileInfo(detailFile), std::ios::out | std::ios::binary)
+        , fileName(filename)
+        , finished(false)
+        , numPoints(0)
+        , numDetail(0)
+    {
+        // only remove the files which have been created here
+        if (!file) {
+            detail.close();
+            Base::FileInfo(detailName).deleteFile();
+            throw Base::FileException("Cannot write octree file", filename.c_str());
+        }
+        if (!detail) {
+            removeFiles();
+            throw Base::FileException("Cannot write octree file", filename.c_str());
+        }
+    }
+
+    ~Output()
+    {
+        // don't leave an incomplete file behind if building has failed
+        if (!finished)
+            removeFiles();
+    }
+
+    void writePoints(const std::vector<Base::Vector3f>& points)
+    {
+        if (!points.empty())
+            file.write(reinterpret_cast<const char*>(&points[0]), points.size() * pointSize);
+        numPoints += points.size();
+    }
+
+    void writeDetail(const std::vector<Base::Vector3f>& points)
+    {
+        if (!points.empty())
+            detail.write(reinterpret_cast<const char*>(&points[0]), points.size() * pointSize);
+        numDetail += points.size();
+    }
+
+    int addNode(const OctreeNode& node)
+    {
+        nodes.push_back(node);
+        return static_cast<int>(nodes.size()) - 1;
+    }
+
+    void finish(const Base::BoundBox3f& bbox, int root)
+    {
+        // append the level of detail
+        detail.close();
+        uint64_t detailOffset = headerSize + numPoints * pointSize;
+        {
+            Base::ifstream in(Base::FileInfo(detailName), std::ios::in | std::ios::binary);
+            std::vector<char> buffer(1024 * 1024);
+            while (in) {
+                in.read(&buffer[0], buffer.size());
+                file.write(&buffer[0], in.gcount());
+            }
+        }
+        Base::FileInfo(detailName).deleteFile();
+        if (!file)
+            throw Base::FileException("Cannot write octree file", fileName.c_str());
+
+        // the node table
+        uint64_t nodeOffset = detailOffset + numDetail * pointSize;
+        std::vector<char> record(nodeSize);
+        for (std::vector<OctreeNode>::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+            char* p = &record[0];
+            putBox(p, it->box);
+            for (int i = 0; i < 8; i++)
+                put<int32_t>(p, it->child[i]);
+            put<uint64_t>(p, it->first);
+            put<uint64_t>(p, it->count);
+            put<uint64_t>(p, it->total);
+            put<uint32_t>(p, it->leaf);
+            put<uint32_t>(p, it->level);
+            file.write(&record[0], record.size());
+        }
+
+        // and finally the header
+        std::vector<char> header(headerSize);
+        char* p = &header[0];
+        memcpy(p, octreeMagic, sizeof(octreeMagic));
+        p += sizeof(octreeMagic);
+        put<uint32_t>(p, octreeVersion);
+        put<uint32_t>(p, static_cast<uint32_t>(nodes.size()));
+        put<int32_t>(p, root);
+        put<uint32_t>(p, byteOrderMark);
+        put<uint64_t>(p, numPoints);
+        put<uint64_t>(p, numDetail);
+        put<uint64_t>(p, headerSize);
+        put<uint64_t>(p, detailOffset);
+        put<uint64_t>(p, nodeOffset);
+        putBox(p, bbox);
+        file.seekp(0);
+        file.write(&header[0], header.size());
+        file.close();
+        if (!file)
+            throw Base::FileException("Cannot write octree file", fileName.c_str());
+        finished = true;
+    }
+
+    void writeHeaderSpace()
+    {
+        std::vector<char> header(headerSize, 0);
+        file.write(&header[0], header.size());
+    }
+
+private:
+    void removeFiles()
+    {
+        file.close();
+        detail.close();
+        Base::FileInfo(detailName).deleteFile();
+        Base::FileInfo(fileName).deleteFile();
+    }
+
+private:
+    Base::ofstream file;
+    std::string detailName;
+    Base::ofstream detail;
+    std::string fileName;
+    std::vector<OctreeNode> nodes;
+    bool finished;
+
+public:
+    uint64_t numPoints;
+    uint64_t numDetail;
+};
+
+OctreeBuilder::OctreeBuilder(const std::string& filename)
+  : fileName(filename)
+  , pointFile(filename + ".tmp")
+  , points(0)
+  , numPoints(0)
+  , leafSize(65536)
+  , detailSize(8192)
+{
+}
+
+OctreeBuilder::~OctreeBuilder()
+{
+    if (points) {
+        delete points;
+        Base::FileInfo(pointFile).deleteFile();
+    }
+}
+
+void OctreeBuilder::setLeafSize(unsigned long size)
+{
+    leafSize = std::max<unsigned long>(size, 1);
+}
+
+void OctreeBuilder::setDetailSize(unsigned long size)
+{
+    detailSize = std::max<unsigned long>(size, 1);
+}
+
+void OctreeBuilder::addPoints(const std::vector<Base::Vector3f>& pts)
+{
+    if (!points) {
+        points = new Base::ofstream(Base::FileInfo(pointFile), std::ios::out | std::ios::binary);
+        if (!*points)
+            throw Base::FileException("Cannot write temporary file", pointFile.c_str());
+    }
+
+    for (std::vector<Base::Vector3f>::const_iterator it = pts.begin(); it != pts.end(); ++it)
+        bbox.Add(*it);
+    if (!pts.empty())
+        points->write(reinterpret_cast<const char*>(&pts[0]), pts.size() * pointSize);
+    numPoints += pts.size();
+}
+
+void OctreeBuilder::addPoints(const PointKernel& kernel)
+{
+    // transform the points in blocks to keep the memory usage low
+    const std::size_t blockSize = 65536;
+    std::vector<Base::Vector3f> block;
+    block.reserve(blockSize);
+    for (PointKernel::size_type i = 0; i < kernel.size(); i++) {
+        block.push_back(Base::convertTo<Base::Vector3f>(kernel.getPoint(i)));
+        if (block.size() == blockSize) {
+            addPoints(block);
+            block.clear();
+        }
+    }
+    addPoints(block);
+}
+
+std::string OctreeBuilder::tempFile(const std::string& base, int index) const
+{
+    std::stringstream str;
+    str << base << "." << index;
+    return str.str();
+}
+
+void OctreeBuilder::build()
+{
+    if (points) {
+        points->close();
+        delete points;
+        points = 0;
+    }
+
+    try {
+        Output out(fileName, pointFile + ".lod");
+        out.writeHeaderSpace();
+
+        int root = -1;
+        if (numPoints > 0) {
+            std::vector<Base::Vector3f> detail;
+            root = buildNode(pointFile, numPoints, bbox, 0, out, detail);
+        }
+
+        out.finish(bbox, root);
+    }
+    catch (...) {
+        // buildNode() removes the files it has consumed
+        Base::FileInfo(pointFile).deleteFile();
+        throw;
+    }
+}
+
+/*!
+ Builds the sub-tree of the points in \a file. The file is always removed,
+ also if an exception is thrown.
+ */
+int OctreeBuilder::buildNode(const std::string& file, uint64_t count, const Base::BoundBox3f& box,
+                             int level, Output& out, std::vector<Base::Vector3f>& detail)
+{
+    OctreeNode node;
+    node.total = count;
+    node.level = level;
+
+    if (count <= leafSize || level >= maxDepth) {
+        std::vector<Base::Vector3f> pts(count);
+        {
+            Base::ifstream in(Base::FileInfo(file), std::ios::in | std::ios::binary);
+            in.read(reinterpret_cast<char*>(&pts[0]), count * pointSize);
+            if (!in) {
+                in.close();
+                Base::FileInfo(file).deleteFile();
+                throw Base::FileException("Cannot read temporary file", file.c_str());
+            }
+        }
+        Base::FileInfo(file).deleteFile();
+
+        for (std::vector<Base::Vector3f>::iterator it = pts.begin(); it != pts.end(); ++it)
+            node.box.Add(*it);
+        node.leaf = 1;
+        node.first = out.numPoints;
+        node.count = count;
+        out.writePoints(pts);
+        takeEvery(pts, detailSize, detail);
+        return out.addNode(node);
+    }
+
+    // distribute the points to the eight octants
+    Base::Vector3f center = box.GetCenter();
+    std::vector<std::string> childFiles(8);
+    std::vector<Base::ofstream*> childStreams(8, static_cast<Base::ofstream*>(0));
+    std::vector<std::vector<Base::Vector3f> > buffers(8);
+    std::vector<uint64_t> childCounts(8, 0);
+    std::vector<Base::BoundBox3f> childBoxes(8);
+
+    const std::size_t blockSize = 65536;
+    try {
+        Base::ifstream in(Base::FileInfo(file), std::ios::in | std::ios::binary);
+        std::vector<Base::Vector3f> block(blockSize);
+        uint64_t remaining = count;
+        while (remaining > 0) {
+            std::size_t num = static_cast<std::size_t>(std::min<uint64_t>(remaining, blockSize));
+            in.read(reinterpret_cast<char*>(&block[0]), num * pointSize);
+            if (!in)
+                throw Base::FileException("Cannot read temporary file", file.c_str());
+            remaining -= num;
+
+            for (std::size_t i = 0; i < num; i++) {
+                const Base::Vector3f& p = block[i];
+                int octant = (p.x >= center.x ? 1 : 0) |
+                             (p.y >= center.y ? 2 : 0) |
+                             (p.z >= center.z ? 4 : 0);
+                buffers[octant].push_back(p);
+                childBoxes[octant].Add(p);
+                childCounts[octant]++;
+            }
+
+            for (int i = 0; i < 8; i++) {
+                if (buffers[i].size() >= blockSize || (remaining == 0 && !buffers[i].empty())) {
+                    if (!childStreams[i]) {
+                        childFiles[i] = tempFile(file, i);
+                        childStreams[i] = new Base::ofstream(Base::FileInfo(childFiles[i]),
+                                                             std::ios::out | std::ios::binary);
+                    }
+                    childStreams[i]->write(reinterpret_cast<const char*>(&buffers[i][0]),
+                                           buffers[i].size() * pointSize);
+                    if (!*childStreams[i])
+                        throw Base::FileException("Cannot write temporary file", childFiles[i].c_str());
+                    buffers[i].clear();
+                }
+            }
+        }
+    }
+    catch (...) {
+        for (int i = 0; i < 8; i++) {
+            delete childStreams[i];
+            if (!childFiles[i].empty())
+                Base::FileInfo(childFiles[i]).deleteFile();
+        }
+        Base::FileInfo(file).deleteFile();
+        throw;
+    }
+
+    for (int i = 0; i < 8; i++)
+        delete childStreams[i];
+    Base::FileInfo(file).deleteFile();
+
+    std::vector<std::vector<Base::Vector3f> > samples;
+    std::vector<uint64_t> sampleCounts;
+    for (int i = 0; i < 8; i++) {
+        if (childCounts[i] == 0)
+            continue;
+        std::vector<Base::Vector3f> sample;
+        try {
+            node.child[i] = buildNode(childFiles[i], childCounts[i], childBoxes[i], level + 1, out, sample);
+        }
+        catch (...) {
+            // the files of the remaining octants haven't been consumed yet
+            for (int j = i + 1; j < 8; j++) {
+                if (!childFiles[j].empty())
+                    Base::FileInfo(childFiles[j]).deleteFile();
+            }
+            throw;
+        }
+        node.box.Add(childBoxes[i]);
+        samples.push_back(sample);
+        sampleCounts.push_back(childCounts[i]);
+    }
+
+    subsample(samples, sampleCounts, detail);
+    node.first = out.numDetail;
+    node.count = detail.size();
+    out.writeDetail(detail);
+    return out.addNode(node);
+}
+
+void OctreeBuilder::subsample(const std::vector<std::vector<Base::Vector3f> >& samples,
+                              const std::vector<uint64_t>& counts,
+                              std::vector<Base::Vector3f>& detail) const
+{
+    // each child contributes according to its number of points
+    uint64_t total = 0;
+    for (std::vector<uint64_t>::const_iterator it = counts.begin(); it != counts.end(); ++it)
+        total += *it;
+
+    for (std::size_t i = 0; i < samples.size(); i++) {
+        std::size_t quota = static_cast<std::size_t>((detailSize * counts[i] + total - 1) / total);
+        takeEvery(samples[i], quota, detail);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+struct PagedPointKernel::Private
+{
+    std::string fileName;
+    mutable QFile file;
+    std::vector<OctreeNode> nodes;
+    // indices of the leaves ordered by their first point
+    std::vector<int> leaves;
+    int root;
+    uint64_t numPoints;
+    uint64_t pointOffset;
+    uint64_t detailOffset;
+    Base::BoundBox3f bbox;
+
+    // Queries hold the lock for reading while they access mapped pages,
+    // unmapping and closing the file need it for writing
+    mutable QReadWriteLock lock;
+    // serializes the mapping of pages by concurrent readers
+    mutable QMutex mutex;
+    mutable std::vector<uchar*> pages;
+    mutable std::size_t mappedBytes;
+
+    Private() : root(-1), numPoints(0), pointOffset(0), detailOffset(0), mappedBytes(0)
+    {
+    }
+
+    /// The points of a leaf or the level of detail of an inner node
+    const Base::Vector3f* nodePoints(int index) const
+    {
+        const OctreeNode& node = nodes[index];
+        if (node.count == 0)
+            return 0;
+
+        QMutexLocker locker(&mutex);
+        if (!pages[index]) {
+            uint64_t offset = (node.leaf ? pointOffset : detailOffset) + node.first * pointSize;
+            uchar* data = file.map(offset, node.count * pointSize);
+            if (!data)
+                throw Base::FileException("Cannot map points of octree file", fileName.c_str());
+            pages[index] = data;
+            mappedBytes += node.count * pointSize;
+        }
+        return reinterpret_cast<const Base::Vector3f*>(pages[index]);
+    }
+
+    /// The estimated distance of the level of detail points of a node
+    double spacing(const OctreeNode& node) const
+    {
+        // scanned points mostly lie on surfaces
+        double len = node.box.CalcDiagonalLength();
+        return node.count > 0 ? len / std::sqrt(static_cast<double>(node.count)) : len;
+    }
+
+    // the caller must hold the lock for writing
+    void unmapPages()
+    {
+        QMutexLocker locker(&mutex);
+        for (std::vector<uchar*>::iterator it = pages.begin(); it != pages.end(); ++it) {
+            if (*it) {
+                file.unmap(*it);
+                *it = 0;
+            }
+        }
+        mappedBytes = 0;
+    }
+
+    // the caller must hold the lock for writing
+    void clear()
+    {
+        unmapPages();
+        file.close();
+        nodes.clear();
+        leaves.clear();
+        pages.clear();
+        fileName.clear();
+        root = -1;
+        numPoints = 0;
+        bbox = Base::BoundBox3f();
+    }
+
+    /** Selects the nodes whose points make up the level of detail and the
+     * step to take every n-th point of them.
+     */
+    void levelOfDetail(unsigned long maxPoints, std::vector<int>& front, uint64_t& step) const
+    {
+        // refine the nodes level by level as long as the points fit into the limit
+        front.push_back(root);
+        uint64_t total = nodes[root].count;
+        bool refined = true;
+        while (refined) {
+            refined = false;
+            std::vector<int> next;
+            for (std::size_t i = 0; i < front.size(); i++) {
+                const OctreeNode& node = nodes[front[i]];
+                if (node.leaf) {
+                    next.push_back(front[i]);
+                    continue;
+                }
+
+                uint64_t childPoints = 0;
+                for (int j = 0; j < 8; j++) {
+                    if (node.child[j] >= 0)
+                        childPoints += nodes[node.child[j]].count;
+                }
+                if (total - node.count + childPoints <= maxPoints) {
+                    total = total - node.count + childPoints;
+                    for (int j = 0; j < 8; j++) {
+                        if (node.child[j] >= 0)
+                            next.push_back(node.child[j]);
+                    }
+                    refined = true;
+                }
+                else {
+                    next.push_back(front[i]);
+                }
+            }
+            front.swap(next);
+        }
+
+        // even the coarsest level may exceed the limit
+        step = (total > maxPoints && maxPoints > 0) ? (total + maxPoints - 1) / maxPoints : 1;
+    }
+
+    /** Collects the indices of the points inside the box and, if \a points
+     * is given, the untransformed points.
+     */
+    void inSide(const Base::BoundBox3d& box, const Base::Matrix4D& mtrx,
+                std::vector<unsigned long>& indices, std::vector<Base::Vector3f>* points) const
+    {
+        // search box in the coordinate system of the file
+        Base::Matrix4D inv(mtrx);
+        inv.inverse();
+        bool identity = (mtrx == Base::Matrix4D());
+        Base::BoundBox3f local;
+        for (int i = 0; i < 8; i++) {
+            Base::Vector3d corner((i & 1) ? box.MaxX : box.MinX,
+                                  (i & 2) ? box.MaxY : box.MinY,
+                                  (i & 4) ? box.MaxZ : box.MinZ);
+            local.Add(Base::convertTo<Base::Vector3f>(inv * corner));
+        }
+
+        std::vector<int> stack;
+        stack.push_back(root);
+        while (!stack.empty()) {
+            int index = stack.back();
+            stack.pop_back();
+            const OctreeNode& node = nodes[index];
+            if (!local.Intersect(node.box))
+                continue;
+
+            if (!node.leaf) {
+                for (int i = 7; i >= 0; i--) {
+                    if (node.child[i] >= 0)
+                        stack.push_back(node.child[i]);
+                }
+            }
+            else if (identity && local.IsInBox(node.box)) {
+                // the points don't need to be tested
+                for (uint64_t i = 0; i < node.count; i++)
+                    indices.push_back(static_cast<unsigned long>(node.first + i));
+                if (points) {
+                    const Base::Vector3f* pts = nodePoints(index);
+                    points->insert(points->end(), pts, pts + node.count);
+                }
+            }
+            else {
+                const Base::Vector3f* pts = nodePoints(index);
+                for (uint64_t i = 0; i < node.count; i++) {
+                    Base::Vector3d p = mtrx * Base::Vector3d(pts[i].x, pts[i].y, pts[i].z);
+                    if (box.IsInBox(p)) {
+                        indices.push_back(static_cast<unsigned long>(node.first + i));
+                        if (points)
+                            points->push_back(pts[i]);
+                    }
+                }
+            }
+        }
+    }
+};
+
+TYPESYSTEM_SOURCE(Points::PagedPointKernel, Data::ComplexGeoData)
+
+PagedPointKernel::PagedPointKernel() : d(new Private)
+{
+}
+
+PagedPointKernel::~PagedPointKernel()
+{
+    close();
+    delete d;
+}
+
+void PagedPointKernel::open(const std::string& filename)
+{
+    QWriteLocker locker(&d->lock);
+    d->clear();
+
+    d->fileName = filename;
+    d->file.setFileName(QString::fromUtf8(filename.c_str()));
+    if (!d->file.open(QIODevice::ReadOnly))
+        throw Base::FileException("File to load not existing or not readable", filename.c_str());
+
+    QByteArray header = d->file.read(headerSize);
+    if (static_cast<std::size_t>(header.size()) != headerSize ||
+        memcmp(header.constData(), octreeMagic, sizeof(octreeMagic)) != 0) {
+        d->clear();
+        throw Base::BadFormatError("Not an octree file");
+    }
+
+    const char* p = header.constData() + sizeof(octreeMagic);
+    uint32_t version = get<uint32_t>(p);
+    uint32_t numNodes = get<uint32_t>(p);
+    int32_t root = get<int32_t>(p);
+    uint32_t byteOrder = get<uint32_t>(p);
+    uint64_t numPoints = get<uint64_t>(p);
+    uint64_t numDetail = get<uint64_t>(p);
+    uint64_t pointOffset = get<uint64_t>(p);
+    uint64_t detailOffset = get<uint64_t>(p);
+    uint64_t nodeOffset = get<uint64_t>(p);
+    Base::BoundBox3f bbox = getBox(p);
+
+    if (byteOrder == swappedByteOrderMark) {
+        d->clear();
+        throw Base::BadFormatError("Octree file has been written with a different byte order");
+    }
+
+    uint64_t fileSize = static_cast<uint64_t>(d->file.size());
+    if (byteOrder != byteOrderMark || version != octreeVersion || root >= static_cast<int32_t>(numNodes) ||
+        pointOffset + numPoints * pointSize > detailOffset ||
+        detailOffset + numDetail * pointSize > nodeOffset ||
+        nodeOffset + static_cast<uint64_t>(numNodes) * nodeSize > fileSize) {
+        d->clear();
+        throw Base::BadFormatError("Invalid octree file");
+    }
+
+    d->file.seek(nodeOffset);
+    QByteArray table = d->file.read(static_cast<qint64>(numNodes) * nodeSize);
+    if (static_cast<uint64_t>(table.size()) != static_cast<uint64_t>(numNodes) * nodeSize) {
+        d->clear();
+        throw Base::BadFormatError("Invalid octree file");
+    }
+
+    d->nodes.resize(numNodes);
+    p = table.constData();
+    for (uint32_t i = 0; i < numNodes; i++) {
+        OctreeNode& node = d->nodes[i];
+        node.box = getBox(p);
+        for (int j = 0; j < 8; j++)
+            node.child[j] = get<int32_t>(p);
+        node.first = get<uint64_t>(p);
+        node.count = get<uint64_t>(p);
+        node.total = get<uint64_t>(p);
+        node.leaf = get<uint32_t>(p);
+        node.level = get<uint32_t>(p);
+
+        uint64_t available = node.leaf ? numPoints : numDetail;
+        bool valid = node.first + node.count <= available;
+        for (int j = 0; j < 8; j++) {
+            if (node.child[j] >= static_cast<int32_t>(i))
+                valid = false;
+        }
+        if (!valid) {
+            d->clear();
+            throw Base::BadFormatError("Invalid octree file");
+        }
+        if (node.leaf)
+            d->leaves.push_back(i);
+    }
+
+    std::sort(d->leaves.begin(), d->leaves.end(), [this](int a, int b) {
+        return d->nodes[a].first < d->nodes[b].first;
+    });
+
+    d->root = root;
+    d->numPoints = numPoints;
+    d->pointOffset = pointOffset;
+    d->detailOffset = detailOffset;
+    d->bbox = bbox;
+    d->pages.resize(numNodes, 0);
+}
+
+void PagedPointKernel::close()
+{
+    QWriteLocker locker(&d->lock);
+    d->clear();
+}
+
+const std::string& PagedPointKernel::getFileName() const
+{
+    return d->fileName;
+}
+
+void PagedPointKernel::releasePages()
+{
+    // waits until no query uses the pages any more
+    QWriteLocker locker(&d->lock);
+    d->unmapPages();
+}
+
+std::vector<const char*> PagedPointKernel::getElementTypes(void) const
+{
+    return std::vector<const char*>();
+}
+
+unsigned long PagedPointKernel::countSubElements(const char* /*Type*/) const
+{
+    return 0;
+}
+
+Data::Segment* PagedPointKernel::getSubElement(const char* /*Type*/, unsigned long /*n*/) const
+{
+    return 0;
+}
+
+void PagedPointKernel::setTransform(const Base::Matrix4D& rclTrf)
+{
+    _Mtrx = rclTrf;
+}
+
+Base::Matrix4D PagedPointKernel::getTransform(void) const
+{
+    return _Mtrx;
+}
+
+void PagedPointKernel::transformGeometry(const Base::Matrix4D &rclMat)
+{
+    // the file is read-only, so only the placement is changed
+    _Mtrx = rclMat * _Mtrx;
+}
+
+Base::BoundBox3d PagedPointKernel::getBoundBox(void) const
+{
+    QReadLocker locker(&d->lock);
+    Base::BoundBox3d bnd;
+    if (d->numPoints == 0)
+        return bnd;
+
+    const Base::BoundBox3f& box = d->bbox;
+    for (int i = 0; i < 8; i++) {
+        Base::Vector3d corner((i & 1) ? box.MaxX : box.MinX,
+                              (i & 2) ? box.MaxY : box.MinY,
+                              (i & 4) ? box.MaxZ : box.MinZ);
+        bnd.Add(_Mtrx * corner);
+    }
+    return bnd;
+}
+
+unsigned long PagedPointKernel::size() const
+{
+    QReadLocker locker(&d->lock);
+    return static_cast<unsigned long>(d->numPoints);
+}
+
+Base::Vector3d PagedPointKernel::getPoint(unsigned long index) const
+{
+    QReadLocker locker(&d->lock);
+    if (index >= d->numPoints)
+        throw Base::IndexError("Point index out of range");
+
+    // find the leaf containing the point
+    std::vector<int>::const_iterator it = std::upper_bound(d->leaves.begin(), d->leaves.end(), index,
+        [this](unsigned long i, int leaf) {
+        return i < d->nodes[leaf].first;
+    });
+    int leaf = *(--it);
+    const Base::Vector3f& p = d->nodePoints(leaf)[index - d->nodes[leaf].first];
+    return _Mtrx * Base::Vector3d(p.x, p.y, p.z);
+}
+
+void PagedPointKernel::getPoints(std::vector<Base::Vector3d> &Points,
+                                 std::vector<Base::Vector3d> &/*Normals*/,
+                                 float Accuracy, uint16_t /*flags*/) const
+{
+    QReadLocker locker(&d->lock);
+    if (d->root < 0)
+        return;
+
+    std::vector<int> stack;
+    stack.push_back(d->root);
+    while (!stack.empty()) {
+        int index = stack.back();
+        stack.pop_back();
+        const OctreeNode& node = d->nodes[index];
+        if (node.leaf || (Accuracy > 0 && d->spacing(node) <= Accuracy)) {
+            const Base::Vector3f* pts = d->nodePoints(index);
+            for (uint64_t i = 0; i < node.count; i++)
+                Points.push_back(_Mtrx * Base::Vector3d(pts[i].x, pts[i].y, pts[i].z));
+        }
+        else {
+            for (int i = 7; i >= 0; i--) {
+                if (node.child[i] >= 0)
+                    stack.push_back(node.child[i]);
+            }
+        }
+    }
+}
+
+void PagedPointKernel::getLevelOfDetail(unsigned long maxPoints, std::vector<Base::Vector3d>& points) const
+{
+    QReadLocker locker(&d->lock);
+    if (d->root < 0)
+        return;
+
+    std::vector<int> front;
+    uint64_t step;
+    d->levelOfDetail(maxPoints, front, step);
+    for (std::vector<int>::iterator it = front.begin(); it != front.end(); ++it) {
+        const OctreeNode& node = d->nodes[*it];
+        const Base::Vector3f* pts = d->nodePoints(*it);
+        for (uint64_t i = 0; i < node.count; i += step)
+            points.push_back(_Mtrx * Base::Vector3d(pts[i].x, pts[i].y, pts[i].z));
+    }
+}
+
+void PagedPointKernel::getLevelOfDetail(unsigned long maxPoints, std::vector<Base::Vector3f>& points) const
+{
+    QReadLocker locker(&d->lock);
+    if (d->root < 0)
+        return;
+
+    std::vector<int> front;
+    uint64_t step;
+    d->levelOfDetail(maxPoints, front, step);
+    for (std::vector<int>::iterator it = front.begin(); it != front.end(); ++it) {
+        const OctreeNode& node = d->nodes[*it];
+        const Base::Vector3f* pts = d->nodePoints(*it);
+        if (step == 1) {
+            points.insert(points.end(), pts, pts + node.count);
+        }
+        else {
+            for (uint64_t i = 0; i < node.count; i += step)
+                points.push_back(pts[i]);
+        }
+    }
+}
+
+unsigned long PagedPointKernel::inSide(const Base::BoundBox3d& box, std::vector<unsigned long>& indices) const
+{
+    QReadLocker locker(&d->lock);
+    if (d->root < 0)
+        return 0;
+
+    std::size_t count = indices.size();
+    d->inSide(box, _Mtrx, indices, 0);
+    return static_cast<unsigned long>(indices.size() - count);
+}
+
+unsigned long PagedPointKernel::extract(const Base::BoundBox3d& box, PointKernel& kernel,
+                                        std::vector<unsigned long>* indices) const
+{
+    QReadLocker locker(&d->lock);
+    std::vector<Base::Vector3f> points;
+    std::vector<unsigned long> found;
+    if (d->root >= 0)
+        d->inSide(box, _Mtrx, found, &points);
+
+    kernel.clear();
+    kernel.setTransform(_Mtrx);
+    kernel.swap(points);
+    if (indices)
+        indices->swap(found);
+    return static_cast<unsigned long>(kernel.size());
+}
+
+bool PagedPointKernel::findNearest(const Base::Vector3d& point, double maxDist,
+                                   unsigned long& index, double& dist) const
+{
+    QReadLocker locker(&d->lock);
+    if (d->root < 0)
+        return false;
+
+    // The transformation is a placement, so distances are the same in the
+    // coordinate system of the file
+    Base::Matrix4D inv(_Mtrx);
+    inv.inverse();
+    Base::Vector3d local = inv * point;
+    Base::Vector3f pnt = Base::convertTo<Base::Vector3f>(local);
+
+    auto boxDistance = [&local](const Base::BoundBox3f& box) {
+        double dx = std::max(std::max(box.MinX - local.x, local.x - box.MaxX), 0.0);
+        double dy = std::max(std::max(box.MinY - local.y, local.y - box.MaxY), 0.0);
+        double dz = std::max(std::max(box.MinZ - local.z, local.z - box.MaxZ), 0.0);
+        return std::sqrt(dx*dx + dy*dy + dz*dz);
+    };
+
+    // visit the nodes ordered by their distance
+    typedef std::pair<double, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > queue;
+    queue.push(Entry(boxDistance(d->nodes[d->root].box), d->root));
+
+    bool found = false;
+    double best = maxDist;
+    while (!queue.empty()) {
+        Entry entry = queue.top();
+        queue.pop();
+        if (entry.first > best)
+            break;
+
+        const OctreeNode& node = d->nodes[entry.second];
+        if (node.leaf) {
+            const Base::Vector3f* pts = d->nodePoints(entry.second);
+            for (uint64_t i = 0; i < node.count; i++) {
+                double dst = Base::Distance(pnt, pts[i]);
+                if (dst <= best) {
+                    best = dst;
+                    index = static_cast<unsigned long>(node.first + i);
+                    found = true;
+                }
+            }
+        }
+        else {
+            for (int i = 0; i < 8; i++) {
+                if (node.child[i] >= 0) {
+                    double dst = boxDistance(d->nodes[node.child[i]].box);
+                    if (dst <= best)
+                        queue.push(Entry(dst, node.child[i]));
+                }
+            }
+        }
+    }
+
+    if (found)
+        dist = best;
+    return found;
+}
+
+unsigned int PagedPointKernel::getMemSize (void) const
+{
+    QReadLocker locker(&d->lock);
+    QMutexLocker mapLocker(&d->mutex);
+    return static_cast<unsigned int>(d->nodes.size() * sizeof(OctreeNode) + d->mappedBytes);
+}
+
+void PagedPointKernel::Save (Base::Writer &writer) const
+{
+    // the octree file is embedded into the document by PropertyPagedPoints
+    writer.Stream() << writer.ind()
+        << "<PagedPoints mtrx=\"" << _Mtrx.toString() << "\"/>\n";
+}
+
+void PagedPointKernel::Restore(Base::XMLReader &reader)
+{
+    reader.readElement("PagedPoints");
+    if (reader.hasAttribute("mtrx")) {
+        std::string Matrix (reader.getAttribute("mtrx") );
+        _Mtrx.fromString(Matrix);
+    }
+}
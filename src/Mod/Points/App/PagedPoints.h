@@ -0,0 +1,180 @@
+/***************************************************************************
+ *   Copyright (c) 2020 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef POINTS_PAGEDPOINTS_H
+#define POINTS_PAGEDPOINTS_H
+
+#include <string>
+#include <vector>
+
+#include <App/ComplexGeoData.h>
+#include <Base/BoundBox.h>
+#include <Base/Matrix.h>
+#include <Base/Vector3D.h>
+
+namespace Base {
+class ofstream;
+}
+
+namespace Points
+{
+
+class PointKernel;
+
+/*!
+ Writes a point cloud into an octree file which can be opened with
+ PagedPointKernel. The points are passed in batches and are distributed
+ into temporary files node by node, so the cloud never has to fit into
+ memory at once.
+
+ The file contains the points of all leaves in one block, so each point
+ has a fixed index. Each inner node keeps a subsample of the points of its
+ children as level of detail.
+ */
+class PointsExport OctreeBuilder
+{
+public:
+    OctreeBuilder(const std::string& filename);
+    ~OctreeBuilder();
+
+    /// Maximum number of points of a leaf
+    void setLeafSize(unsigned long);
+    /// Number of points kept by an inner node as level of detail
+    void setDetailSize(unsigned long);
+
+    void addPoints(const std::vector<Base::Vector3f>&);
+    /// Adds the points of the kernel with its transformation applied
+    void addPoints(const PointKernel&);
+
+    /// Writes the octree file and removes the temporary files
+    void build();
+
+private:
+    class Output;
+
+    int buildNode(const std::string& file, uint64_t count, const Base::BoundBox3f& box,
+                  int level, Output& out, std::vector<Base::Vector3f>& detail);
+    void subsample(const std::vector<std::vector<Base::Vector3f> >& samples,
+                   const std::vector<uint64_t>& counts,
+                   std::vector<Base::Vector3f>& detail) const;
+    std::string tempFile(const std::string& base, int index) const;
+
+private:
+    std::string fileName;
+    std::string pointFile;
+    Base::ofstream* points;
+    uint64_t numPoints;
+    Base::BoundBox3f bbox;
+    unsigned long leafSize;
+    unsigned long detailSize;
+};
+
+/*!
+ Point kernel for clouds which don't fit into memory. The points are kept
+ in an octree file written by OctreeBuilder. Only the node table is held in
+ memory, the points of a node are mapped into memory when they are accessed
+ for the first time. Box and nearest point queries only visit the nodes
+ which intersect the search region, and for viewing the subsampled points
+ of the inner nodes can be used instead of all points.
+
+ Like PointKernel the points are stored untransformed and the placement is
+ kept in the transformation matrix.
+
+ All queries can be used from several threads at the same time.
+ */
+class PointsExport PagedPointKernel : public Data::ComplexGeoData
+{
+    TYPESYSTEM_HEADER();
+
+public:
+    PagedPointKernel();
+    ~PagedPointKernel();
+
+    /// Opens an octree file written by OctreeBuilder
+    void open(const std::string& filename);
+    void close();
+    const std::string& getFileName() const;
+
+    /** @name Subelement management */
+    //@{
+    virtual std::vector<const char*> getElementTypes(void) const;
+    virtual unsigned long countSubElements(const char* Type) const;
+    virtual Data::Segment* getSubElement(const char* Type, unsigned long) const;
+    //@}
+
+    virtual void setTransform(const Base::Matrix4D& rclTrf);
+    virtual Base::Matrix4D getTransform(void) const;
+    virtual void transformGeometry(const Base::Matrix4D &rclMat);
+    virtual Base::BoundBox3d getBoundBox(void) const;
+    /** Returns the points. If \a Accuracy is positive the level of detail is
+     * used for all nodes whose points are closer than the given distance.
+     */
+    virtual void getPoints(std::vector<Base::Vector3d> &Points,
+        std::vector<Base::Vector3d> &Normals,
+        float Accuracy, uint16_t flags=0) const;
+
+    /// Number of points
+    unsigned long size() const;
+    Base::Vector3d getPoint(unsigned long index) const;
+    /** Returns at most \a maxPoints points. The tree is refined breadth-first
+     * as long as the level of detail of the nodes fits into the limit.
+     */
+    void getLevelOfDetail(unsigned long maxPoints, std::vector<Base::Vector3d>&) const;
+    /// The same as above but the points are not transformed
+    void getLevelOfDetail(unsigned long maxPoints, std::vector<Base::Vector3f>&) const;
+    /// Returns the indices of all points inside the box
+    unsigned long inSide(const Base::BoundBox3d&, std::vector<unsigned long>&) const;
+    /** Copies the points inside the box into \a kernel, e.g. to use them with
+     * PointsGrid. The kernel gets the same transformation. If \a indices is
+     * given it is filled with the indices of the copied points.
+     */
+    unsigned long extract(const Base::BoundBox3d&, PointKernel& kernel,
+                          std::vector<unsigned long>* indices = 0) const;
+    /// Searches the nearest point within \a maxDist, returns false if there is none
+    bool findNearest(const Base::Vector3d& point, double maxDist,
+                     unsigned long& index, double& dist) const;
+    /// Unmaps all pages which have been mapped so far, waits for running queries
+    void releasePages();
+
+    /** @name I/O */
+    //@{
+    /// Returns the size of the node table and of the mapped pages
+    unsigned int getMemSize (void) const;
+    /// Only saves the transformation, the file is handled by PropertyPagedPoints
+    void Save (Base::Writer &writer) const;
+    void Restore(Base::XMLReader &reader);
+    //@}
+
+private:
+    PagedPointKernel(const PagedPointKernel&);
+    void operator = (const PagedPointKernel&);
+
+    struct Private;
+    Private* d;
+    Base::Matrix4D _Mtrx;
+};
+
+} // namespace Points
+
+
+#endif // POINTS_PAGEDPOINTS_H
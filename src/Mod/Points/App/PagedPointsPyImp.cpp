@@ -0,0 +1,202 @@
+/***************************************************************************
+ *   Copyright (c) 2020 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <limits>
+#endif
+
+#include <Base/BoundBoxPy.h>
+#include <Base/VectorPy.h>
+#include <Base/GeometryPyCXX.h>
+
+#include "Mod/Points/App/PagedPoints.h"
+#include "Mod/Points/App/Points.h"
+#include "PointsPy.h"
+
+// inclusion of the generated files (generated out of PagedPointsPy.xml)
+#include "PagedPointsPy.h"
+#include "PagedPointsPy.cpp"
+
+using namespace Points;
+
+// returns a string which represents the object e.g. when printed in python
+std::string PagedPointsPy::representation(void) const
+{
+    return std::string("<PagedPointKernel object>");
+}
+
+PyObject *PagedPointsPy::PyMake(struct _typeobject *, PyObject *, PyObject *)  // Python wrapper
+{
+    // create a new instance of PagedPointsPy and the Twin object
+    return new PagedPointsPy(new PagedPointKernel);
+}
+
+// constructor method
+int PagedPointsPy::PyInit(PyObject* args, PyObject* /*kwd*/)
+{
+    char* Name = 0;
+    if (!PyArg_ParseTuple(args, "|et", "utf-8", &Name))
+        return -1;
+
+    if (!Name)
+        return 0;
+
+    std::string EncodedName = std::string(Name);
+    PyMem_Free(Name);
+
+    try {
+        getPagedPointKernelPtr()->open(EncodedName);
+    }
+    catch (const Base::Exception& e) {
+        PyErr_SetString(Base::BaseExceptionFreeCADError, e.what());
+        return -1;
+    }
+
+    return 0;
+}
+
+PyObject* PagedPointsPy::open(PyObject *args)
+{
+    char* Name;
+    if (!PyArg_ParseTuple(args, "et", "utf-8", &Name))
+        return 0;
+
+    std::string EncodedName = std::string(Name);
+    PyMem_Free(Name);
+
+    PY_TRY {
+        getPagedPointKernelPtr()->open(EncodedName);
+    } PY_CATCH;
+
+    Py_Return;
+}
+
+PyObject* PagedPointsPy::releasePages(PyObject *args)
+{
+    if (!PyArg_ParseTuple(args, ""))
+        return 0;
+
+    getPagedPointKernelPtr()->releasePages();
+    Py_Return;
+}
+
+PyObject* PagedPointsPy::getPoint(PyObject *args)
+{
+    unsigned long index;
+    if (!PyArg_ParseTuple(args, "k", &index))
+        return 0;
+
+    PY_TRY {
+        return new Base::VectorPy(getPagedPointKernelPtr()->getPoint(index));
+    } PY_CATCH;
+}
+
+PyObject* PagedPointsPy::getLevelOfDetail(PyObject *args)
+{
+    unsigned long maxPoints;
+    if (!PyArg_ParseTuple(args, "k", &maxPoints))
+        return 0;
+
+    PY_TRY {
+        std::vector<Base::Vector3d> points;
+        getPagedPointKernelPtr()->getLevelOfDetail(maxPoints, points);
+
+        Py::List list;
+        for (std::vector<Base::Vector3d>::iterator it = points.begin(); it != points.end(); ++it)
+            list.append(Py::Vector(*it));
+        return Py::new_reference_to(list);
+    } PY_CATCH;
+}
+
+PyObject* PagedPointsPy::inside(PyObject *args)
+{
+    PyObject* box;
+    if (!PyArg_ParseTuple(args, "O!", &(Base::BoundBoxPy::Type), &box))
+        return 0;
+
+    PY_TRY {
+        std::vector<unsigned long> indices;
+        getPagedPointKernelPtr()->inSide(*static_cast<Base::BoundBoxPy*>(box)->getBoundBoxPtr(), indices);
+
+        Py::List list;
+        for (std::vector<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it)
+            list.append(Py::Long(*it));
+        return Py::new_reference_to(list);
+    } PY_CATCH;
+}
+
+PyObject* PagedPointsPy::extract(PyObject *args)
+{
+    PyObject* box;
+    if (!PyArg_ParseTuple(args, "O!", &(Base::BoundBoxPy::Type), &box))
+        return 0;
+
+    PY_TRY {
+        std::unique_ptr<PointKernel> kernel(new PointKernel());
+        getPagedPointKernelPtr()->extract(*static_cast<Base::BoundBoxPy*>(box)->getBoundBoxPtr(), *kernel);
+        return new PointsPy(kernel.release());
+    } PY_CATCH;
+}
+
+PyObject* PagedPointsPy::findNearest(PyObject *args)
+{
+    PyObject* pnt;
+    double maxDist = std::numeric_limits<double>::max();
+    if (!PyArg_ParseTuple(args, "O!|d", &(Base::VectorPy::Type), &pnt, &maxDist))
+        return 0;
+
+    PY_TRY {
+        unsigned long index;
+        double dist;
+        if (!getPagedPointKernelPtr()->findNearest(*static_cast<Base::VectorPy*>(pnt)->getVectorPtr(),
+                                                   maxDist, index, dist))
+            Py_Return;
+
+        Py::Tuple tuple(2);
+        tuple.setItem(0, Py::Long(index));
+        tuple.setItem(1, Py::Float(dist));
+        return Py::new_reference_to(tuple);
+    } PY_CATCH;
+}
+
+Py::Long PagedPointsPy::getCountPoints(void) const
+{
+    return Py::Long(getPagedPointKernelPtr()->size());
+}
+
+Py::String PagedPointsPy::getFileName(void) const
+{
+    return Py::String(getPagedPointKernelPtr()->getFileName());
+}
+
+PyObject *PagedPointsPy::getCustomAttributes(const char* /*attr*/) const
+{
+    return 0;
+}
+
+int PagedPointsPy::setCustomAttributes(const char* /*attr*/, PyObject* /*obj*/)
+{
+    return 0;
+}
@@ -100,6 +100,7 @@ public:
     unsigned int getMemSize (void) const;
     void Save (Base::Writer &writer) const;
     void SaveDocFile (Base::Writer &writer) const;
+    bool canSaveDocFileConcurrently() const {return true;}
     void Restore(Base::XMLReader &reader);
     void RestoreDocFile(Base::Reader &reader);
     void save(const char* file) const;
@@ -26,6 +26,8 @@
 #ifdef FC_OS_LINUX
 # include <unistd.h>
 #endif
+# include <cstring>
+# include <limits>
 # include <sstream>
 #endif
 
@@ -33,11 +35,20 @@
 #include "PointsAlgos.h"
 #include "Points.h"
 
+#include <App/Application.h>
 #include <Base/Exception.h>
 #include <Base/FileInfo.h>
 #include <Base/Console.h>
 #include <Base/Sequencer.h>
 #include <Base/Stream.h>
+#include <Base/Swap.h>
+#include <Base/TimeInfo.h>
+
+#include <QFile>
+#include <QThreadPool>
+#include <QtConcurrentMap>
+
+#include <Eigen/Core>
 
 #include <boost/shared_ptr.hpp>
 #include <boost/regex.hpp>
@@ -47,73 +58,884 @@
 
 using namespace Points;
 
-void PointsAlgos::Load(PointKernel &points, const char *FileName)
+namespace Points {
+
+/*!
+ The file is mapped into memory if possible, otherwise it is read at once.
+ */
+class MappedFile
 {
-    Base::FileInfo File(FileName);
+public:
+    explicit MappedFile(const std::string& filename)
+        : file(QString::fromUtf8(filename.c_str()))
+        , data(0)
+        , size(0)
+    {
+        if (!file.open(QIODevice::ReadOnly))
+            throw Base::FileException("File to load not existing or not readable", filename);
+        size = static_cast<std::size_t>(file.size());
+        if (size > 0) {
+            data = reinterpret_cast<const char*>(file.map(0, file.size()));
+            if (!data) {
+                buffer.resize(size);
+                if (file.read(&buffer[0], file.size()) != file.size())
+                    throw Base::FileException("Failed to read file", filename);
+                data = &buffer[0];
+            }
+        }
+    }
+    const char* begin() const {
+        return data;
+    }
+    const char* end() const {
+        return data + size;
+    }
 
-    // checking on the file
-    if (!File.isReadable())
-        throw Base::FileException("File to load not existing or not readable", FileName);
+private:
+    QFile file;
+    std::vector<char> buffer;
+    const char* data;
+    std::size_t size;
+};
 
-    if (File.hasExtension("asc"))
-        LoadAscii(points,FileName);
-    else
-        throw Base::RuntimeError("Unknown ending");
+/*!
+ Locale independent conversion of the number at \a str. Returns the position
+ after the number or 0 if there is no valid number.
+ */
+const char* parseNumber(const char* str, const char* end, double& value)
+{
+    static const double powers[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char* p = str;
+    bool negative = false;
+    if (p != end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    // nan, inf or infinity
+    if (p != end && (*p == 'n' || *p == 'N' || *p == 'i' || *p == 'I')) {
+        const char* word = (*p == 'n' || *p == 'N') ? "nan" : "infinity";
+        std::size_t len = 0;
+        while (word[len] && p + len != end && tolower(p[len]) == word[len])
+            len++;
+        if (len == 3 && word[0] == 'n') {
+            value = std::numeric_limits<double>::quiet_NaN();
+            return p + len;
+        }
+        if (len == 3 || len == 8) {
+            value = negative ? -std::numeric_limits<double>::infinity()
+                             : std::numeric_limits<double>::infinity();
+            return p + len;
+        }
+        return 0;
+    }
+
+    // up to 19 significant digits fit into the mantissa
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    while (p != end && *p >= '0' && *p <= '9') {
+        any = true;
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa > 0)
+                digits++;
+        }
+        else {
+            exponent++;
+        }
+        ++p;
+    }
+    if (p != end && *p == '.') {
+        ++p;
+        while (p != end && *p >= '0' && *p <= '9') {
+            any = true;
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                if (mantissa > 0)
+                    digits++;
+                exponent--;
+            }
+            ++p;
+        }
+    }
+    if (!any)
+        return 0;
+
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        bool negativeExp = false;
+        if (q != end && (*q == '-' || *q == '+')) {
+            negativeExp = (*q == '-');
+            ++q;
+        }
+        if (q != end && *q >= '0' && *q <= '9') {
+            int exp = 0;
+            while (q != end && *q >= '0' && *q <= '9') {
+                if (exp < 10000)
+                    exp = exp * 10 + (*q - '0');
+                ++q;
+            }
+            exponent += negativeExp ? -exp : exp;
+            p = q;
+        }
+    }
+
+    double v = static_cast<double>(mantissa);
+    if (mantissa != 0) {
+        if (exponent > 0) {
+            while (exponent > 22) {
+                v *= 1e22;
+                exponent -= 22;
+            }
+            v *= powers[exponent];
+        }
+        else if (exponent < 0) {
+            while (exponent < -22) {
+                v /= 1e22;
+                exponent += 22;
+            }
+            v /= powers[-exponent];
+        }
+    }
+
+    value = negative ? -v : v;
+    return p;
 }
 
-void PointsAlgos::LoadAscii(PointKernel &points, const char *FileName)
+inline bool isBlank(char c)
 {
-    boost::regex rx("^\\s*([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                     "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                     "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
-    //boost::regex rx("(\\b[0-9]+\\.([0-9]+\\b)?|\\.[0-9]+\\b)");
-    //boost::regex rx("^\\s*(-?[0-9]*)\\.([0-9]+)\\s+(-?[0-9]*)\\.([0-9]+)\\s+(-?[0-9]*)\\.([0-9]+)\\s*$");
-    boost::cmatch what;
-
-    Base::Vector3d pt;
-    int LineCnt=0;
-    std::string line;
-    Base::FileInfo fi(FileName);
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/*!
+ Returns the number of threads used to parse the chunks of a file.
+ */
+int threadCount()
+{
+    return std::max(QThreadPool::globalInstance()->maxThreadCount(), 1);
+}
+
+/*!
+ Returns the size of the chunks a text file of \a size bytes is cut into.
+ The parameter ReaderChunkSize overrides the size derived from the number
+ of threads.
+ */
+std::size_t chunkSizeOf(std::size_t size)
+{
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Points");
+    std::size_t chunkSize = hGrp->GetUnsigned("ReaderChunkSize", 0);
+    if (chunkSize > 0)
+        return chunkSize;
+
+    chunkSize = std::max<std::size_t>(size / (threadCount() * 8), 256 * 1024);
+    return std::min<std::size_t>(chunkSize, 32 * 1024 * 1024);
+}
+
+/*!
+ Calls \a func for all chunks in parallel and advances the progress
+ indicator after each group of chunks.
+ */
+template <typename T, typename Func>
+void mapChunks(std::vector<T>& chunks, Func func)
+{
+    Base::SequencerLauncher seq("Reading points...", chunks.size());
+    std::size_t group = static_cast<std::size_t>(threadCount());
+    for (std::size_t i = 0; i < chunks.size(); i += group) {
+        std::size_t last = std::min(chunks.size(), i + group);
+        QtConcurrent::blockingMap(chunks.begin() + i, chunks.begin() + last, func);
+        for (std::size_t j = i; j < last; j++)
+            seq.next();
+    }
+}
+
+/*!
+ Parses the rows of numbers of a text file. The text is cut at line breaks
+ into chunks which are parsed in parallel. In a first pass the lines of each
+ chunk are counted so that the rows can be stored at their final position
+ in the second pass.
+ */
+class AsciiTable
+{
+public:
+    /// In strict mode only lines with exactly the number of columns are rows,
+    /// otherwise each non-empty line is a row and missing values are zero
+    AsciiTable(const char* begin, const char* end, std::size_t numCols, bool strict)
+        : begin(begin), end(end), numCols(numCols), strict(strict)
+        , counted(false), numRows(0)
+    {
+    }
+
+    /// Skips the given number of non-empty lines
+    void skipLines(std::size_t count)
+    {
+        counted = false;
+        chunks.clear();
+        while (count > 0 && begin != end) {
+            const char* eol = static_cast<const char*>(memchr(begin, '\n', end - begin));
+            const char* next = eol ? eol + 1 : end;
+            if (!isEmptyLine(begin, eol ? eol : end))
+                count--;
+            begin = next;
+        }
+    }
+
+    /// Returns the number of non-empty lines
+    std::size_t countRows()
+    {
+        if (!counted) {
+            split(chunks);
+            mapChunks(chunks, [](Chunk& chunk) {
+                chunk.rows = countLines(chunk.begin, chunk.end);
+            });
+            numRows = 0;
+            for (std::vector<Chunk>::iterator it = chunks.begin(); it != chunks.end(); ++it) {
+                it->first = numRows;
+                numRows += it->rows;
+            }
+            counted = true;
+        }
+        return numRows;
+    }
+
+    /*!
+     Parses at most \a maxRows rows and calls \a func(row, values) for each
+     of them. Returns the number of rows. In strict mode the invalid lines
+     leave gaps which are removed with \a move(from, to, count).
+     */
+    template <typename Func, typename Move>
+    std::size_t parse(std::size_t maxRows, Func func, Move move)
+    {
+        countRows();
+
+        std::size_t cols = numCols;
+        bool strictMode = strict;
+        mapChunks(chunks, [cols, strictMode, maxRows, &func](Chunk& chunk) {
+            parseChunk(chunk, cols, strictMode, maxRows, func);
+        });
+
+        std::size_t count = 0;
+        for (std::vector<Chunk>::iterator it = chunks.begin(); it != chunks.end(); ++it) {
+            if (it->failed)
+                throw Base::BadFormatError("Invalid number in row");
+            if (it->first >= maxRows)
+                break;
+            std::size_t valid = std::min(it->valid, maxRows - it->first);
+            if (count != it->first && valid > 0)
+                move(it->first, count, valid);
+            count += valid;
+        }
+
+        return count;
+    }
+
+private:
+    struct Chunk {
+        const char* begin;
+        const char* end;
+        std::size_t rows;
+        std::size_t first;
+        std::size_t valid;
+        bool failed;
+    };
+
+    static bool isEmptyLine(const char* p, const char* end)
+    {
+        while (p != end && isBlank(*p))
+            ++p;
+        return p == end;
+    }
+
+    static std::size_t countLines(const char* p, const char* end)
+    {
+        std::size_t count = 0;
+        while (p != end) {
+            const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+            const char* next = eol ? eol + 1 : end;
+            if (!isEmptyLine(p, eol ? eol : end))
+                count++;
+            p = next;
+        }
+        return count;
+    }
+
+    void split(std::vector<Chunk>& chunks) const
+    {
+        std::size_t chunkSize = chunkSizeOf(end - begin);
+
+        const char* p = begin;
+        while (p != end) {
+            const char* next = end;
+            if (static_cast<std::size_t>(end - p) > chunkSize) {
+                const char* eol = static_cast<const char*>(memchr(p + chunkSize, '\n', end - p - chunkSize));
+                next = eol ? eol + 1 : end;
+            }
+            Chunk chunk;
+            chunk.begin = p;
+            chunk.end = next;
+            chunk.rows = 0;
+            chunk.first = 0;
+            chunk.valid = 0;
+            chunk.failed = false;
+            chunks.push_back(chunk);
+            p = next;
+        }
+    }
+
+    template <typename Func>
+    static void parseChunk(Chunk& chunk, std::size_t numCols, bool strict,
+                           std::size_t maxRows, Func& func)
+    {
+        if (chunk.first >= maxRows)
+            return;
+
+        std::vector<double> values(numCols);
+        std::size_t row = chunk.first;
+        const char* p = chunk.begin;
+        while (p != chunk.end && row < maxRows) {
+            const char* eol = static_cast<const char*>(memchr(p, '\n', chunk.end - p));
+            const char* lineEnd = eol ? eol : chunk.end;
+            const char* next = eol ? eol + 1 : chunk.end;
+
+            while (p != lineEnd && isBlank(*p))
+                ++p;
+            if (p == lineEnd) {
+                p = next;
+                continue;
+            }
+
+            std::size_t col = 0;
+            bool valid = true;
+            while (p != lineEnd && (col < numCols || strict)) {
+                double value;
+                const char* q = parseNumber(p, lineEnd, value);
+                if (!q || (q != lineEnd && !isBlank(*q))) {
+                    valid = false;
+                    break;
+                }
+                if (col < numCols)
+                    values[col] = value;
+                col++;
+                p = q;
+                while (p != lineEnd && isBlank(*p))
+                    ++p;
+            }
+
+            if (strict) {
+                if (valid && col == numCols) {
+                    func(row, &values[0]);
+                    row++;
+                }
+            }
+            else if (!valid) {
+                chunk.failed = true;
+                return;
+            }
+            else {
+                for (; col < numCols; col++)
+                    values[col] = 0.0;
+                func(row, &values[0]);
+                row++;
+            }
 
-    Base::ifstream tmp_str(fi, std::ios::in);
+            p = next;
+        }
 
-    // estimating size
-    while (std::getline(tmp_str,line))
-        LineCnt++;
+        chunk.valid = row - chunk.first;
+    }
 
-    // resize the PointKernel
-    points.resize(LineCnt);
+private:
+    const char* begin;
+    const char* end;
+    std::size_t numCols;
+    bool strict;
+    bool counted;
+    std::size_t numRows;
+    std::vector<Chunk> chunks;
+};
 
-    Base::SequencerLauncher seq( "Loading points...", LineCnt );
+/*!
+ Decodes the rows of a binary file in parallel. Each field has an offset
+ and a stride so that row-wise and column-wise layouts are supported.
+ */
+class BinaryTable
+{
+public:
+    enum Type { Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64 };
 
-    // again to the beginning
-    Base::ifstream file(fi, std::ios::in);
-    LineCnt = 0;
+    BinaryTable(const char* data, bool swapByteOrder)
+        : data(data), swapByteOrder(swapByteOrder)
+    {
+    }
 
-    try {
-        // read file
-        while (std::getline(file, line)) {
-            if (boost::regex_match(line.c_str(), what, rx)) {
-                pt.x = std::atof(what[1].first);
-                pt.y = std::atof(what[4].first);
-                pt.z = std::atof(what[7].first);
+    void addField(Type type, std::size_t offset, std::size_t stride)
+    {
+        Field field;
+        field.type = type;
+        field.offset = offset;
+        field.stride = stride;
+        fields.push_back(field);
+    }
 
-                points.setPoint(LineCnt,pt);
-                seq.next();
-                LineCnt++;
+    static int sizeOf(Type type)
+    {
+        switch (type) {
+        case Int8:
+        case UInt8:
+            return 1;
+        case Int16:
+        case UInt16:
+            return 2;
+        case Int32:
+        case UInt32:
+        case Float32:
+            return 4;
+        default:
+            return 8;
+        }
+    }
+
+    template <typename Func>
+    void parse(std::size_t numRows, Func func) const
+    {
+        const std::size_t blockSize = 65536;
+        std::vector<std::pair<std::size_t, std::size_t> > blocks;
+        for (std::size_t i = 0; i < numRows; i += blockSize)
+            blocks.push_back(std::make_pair(i, std::min(numRows, i + blockSize)));
+
+        const BinaryTable* self = this;
+        mapChunks(blocks, [self, &func](std::pair<std::size_t, std::size_t>& block) {
+            std::vector<double> values(self->fields.size());
+            for (std::size_t row = block.first; row < block.second; row++) {
+                for (std::size_t j = 0; j < self->fields.size(); j++) {
+                    const Field& field = self->fields[j];
+                    values[j] = self->value(self->data + field.offset + row * field.stride, field.type);
+                }
+                func(row, &values[0]);
             }
+        });
+    }
+
+private:
+    template <typename T>
+    T get(const char* p) const
+    {
+        T v;
+        memcpy(&v, p, sizeof(T));
+        if (swapByteOrder)
+            Base::SwapEndian<T>(v);
+        return v;
+    }
+
+    double value(const char* p, Type type) const
+    {
+        switch (type) {
+        case Int8:
+            return get<int8_t>(p);
+        case UInt8:
+            return get<uint8_t>(p);
+        case Int16:
+            return get<int16_t>(p);
+        case UInt16:
+            return get<uint16_t>(p);
+        case Int32:
+            return get<int32_t>(p);
+        case UInt32:
+            return get<uint32_t>(p);
+        case Float32:
+            return get<float>(p);
+        default:
+            return get<double>(p);
         }
     }
-    catch (...) {
-        points.clear();
-        throw Base::BadFormatError("Reading in points failed.");
+
+    struct Field {
+        Type type;
+        std::size_t offset;
+        std::size_t stride;
+    };
+
+    const char* data;
+    bool swapByteOrder;
+    std::vector<Field> fields;
+};
+
+/*!
+ Assigns the values of a row to the points and their properties. The
+ containers are resized in advance so that rows can be assigned in parallel.
+ */
+class RowConverter
+{
+public:
+    enum ColorType { NoColor, ByteColor, FloatColor, PackedUInt, PackedFloat };
+
+    RowConverter(const std::vector<std::string>& fields)
+        : colorType(NoColor)
+        , points(0), normals(0), intensity(0), colors(0)
+    {
+        x = find(fields, "x");
+        y = find(fields, "y");
+        z = find(fields, "z");
+        normal_x = find(fields, "normal_x", "nx");
+        normal_y = find(fields, "normal_y", "ny");
+        normal_z = find(fields, "normal_z", "nz");
+        greyvalue = find(fields, "intensity");
+        red = find(fields, "red");
+        green = find(fields, "green");
+        blue = find(fields, "blue");
+        alpha = find(fields, "alpha");
+        rgba = find(fields, "rgb", "rgba");
+    }
+
+    /// Separate red, green, blue and alpha fields
+    void setColorComponents(const std::vector<std::string>& types)
+    {
+        if (red == npos || green == npos || blue == npos)
+            return;
+        const std::string& type = types[red];
+        if (type == "uchar" || type == "uint8")
+            colorType = ByteColor;
+        else if (type == "float" || type == "float32")
+            colorType = FloatColor;
+    }
+
+    /// A packed rgb or rgba field
+    void setPackedColor(const std::vector<std::string>& types)
+    {
+        if (rgba == npos)
+            return;
+        if (types[rgba] == "U")
+            colorType = PackedUInt;
+        else if (types[rgba] == "F")
+            colorType = PackedFloat;
     }
 
-    // now remove the last points from the kernel
-    // Note: first we allocate memory corresponding to the number of lines (points and comments)
-    //       and read in the file twice. But then the size of the kernel is too high
-    if (LineCnt < (int)points.size())
-        points.erase(LineCnt, points.size());
+    bool hasData() const
+    {
+        return (x != npos && y != npos && z != npos);
+    }
+
+    void prepare(std::size_t numPoints,
+                 std::vector<Base::Vector3f>& pts,
+                 std::vector<Base::Vector3f>& nor,
+                 std::vector<float>& grey,
+                 std::vector<App::Color>& col)
+    {
+        if (!hasData())
+            return;
+        pts.resize(numPoints);
+        points = &pts;
+        if (normal_x != npos && normal_y != npos && normal_z != npos) {
+            nor.resize(numPoints);
+            normals = &nor;
+        }
+        if (greyvalue != npos) {
+            grey.resize(numPoints);
+            intensity = &grey;
+        }
+        if (colorType != NoColor) {
+            col.resize(numPoints);
+            colors = &col;
+        }
+    }
+
+    void operator()(std::size_t row, const double* values) const
+    {
+        if (!points)
+            return;
+
+        (*points)[row].Set(static_cast<float>(values[x]),
+                           static_cast<float>(values[y]),
+                           static_cast<float>(values[z]));
+        if (normals) {
+            (*normals)[row].Set(static_cast<float>(values[normal_x]),
+                                static_cast<float>(values[normal_y]),
+                                static_cast<float>(values[normal_z]));
+        }
+        if (intensity) {
+            (*intensity)[row] = static_cast<float>(values[greyvalue]);
+        }
+        if (colors) {
+            App::Color& c = (*colors)[row];
+            switch (colorType) {
+            case ByteColor:
+                c.set(static_cast<float>(values[red])/255.0f,
+                      static_cast<float>(values[green])/255.0f,
+                      static_cast<float>(values[blue])/255.0f,
+                      static_cast<float>(alpha != npos ? values[alpha] : 1.0)/255.0f);
+                break;
+            case FloatColor:
+                c.set(static_cast<float>(values[red]),
+                      static_cast<float>(values[green]),
+                      static_cast<float>(values[blue]),
+                      alpha != npos ? static_cast<float>(values[alpha]) : 1.0f);
+                break;
+            case PackedUInt:
+                setPacked(c, static_cast<uint32_t>(values[rgba]));
+                break;
+            case PackedFloat:
+                {
+                    // the bits of the float are the packed color
+                    float f = static_cast<float>(values[rgba]);
+                    uint32_t packed;
+                    memcpy(&packed, &f, sizeof(packed));
+                    setPacked(c, packed);
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    /// Removes the gap of rows before \a from
+    void move(std::size_t from, std::size_t to, std::size_t count) const
+    {
+        if (points)
+            std::copy(points->begin() + from, points->begin() + from + count, points->begin() + to);
+        if (normals)
+            std::copy(normals->begin() + from, normals->begin() + from + count, normals->begin() + to);
+        if (intensity)
+            std::copy(intensity->begin() + from, intensity->begin() + from + count, intensity->begin() + to);
+        if (colors)
+            std::copy(colors->begin() + from, colors->begin() + from + count, colors->begin() + to);
+    }
+
+    void resize(std::size_t numPoints) const
+    {
+        if (points)
+            points->resize(numPoints);
+        if (normals)
+            normals->resize(numPoints);
+        if (intensity)
+            intensity->resize(numPoints);
+        if (colors)
+            colors->resize(numPoints);
+    }
+
+private:
+    static const std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    static std::size_t find(const std::vector<std::string>& fields, const char* name,
+                            const char* alias = 0)
+    {
+        std::vector<std::string>::const_iterator it = std::find(fields.begin(), fields.end(), name);
+        if (it == fields.end() && alias)
+            it = std::find(fields.begin(), fields.end(), alias);
+        if (it != fields.end())
+            return std::distance(fields.begin(), it);
+        return npos;
+    }
+
+    static void setPacked(App::Color& c, uint32_t packed)
+    {
+        // http://docs.pointclouds.org/1.3.0/structpcl_1_1_r_g_b.html
+        uint32_t a = (packed >> 24) & 0xff;
+        uint32_t r = (packed >> 16) & 0xff;
+        uint32_t g = (packed >> 8) & 0xff;
+        uint32_t b = packed & 0xff;
+        c.set(static_cast<float>(r)/255.0f,
+              static_cast<float>(g)/255.0f,
+              static_cast<float>(b)/255.0f,
+              static_cast<float>(a)/255.0f);
+    }
+
+    std::size_t x, y, z;
+    std::size_t normal_x, normal_y, normal_z;
+    std::size_t greyvalue;
+    std::size_t red, green, blue, alpha, rgba;
+    ColorType colorType;
+    std::vector<Base::Vector3f>* points;
+    std::vector<Base::Vector3f>* normals;
+    std::vector<float>* intensity;
+    std::vector<App::Color>* colors;
+};
+
+void logThroughput(const char* format, std::size_t numPoints, const Base::TimeInfo& start)
+{
+    float seconds = Base::TimeInfo::diffTimeF(start, Base::TimeInfo());
+    Base::Console().Log("Read %lu points from %s file in %.3f s (%.0f points/s)\n",
+        static_cast<unsigned long>(numPoints), format, seconds,
+        seconds > 0 ? numPoints / seconds : 0.0);
+}
+
+/*!
+ Returns the type of a binary PLY property.
+ */
+BinaryTable::Type plyType(const std::string& t)
+{
+    if (t == "char" || t == "int8")
+        return BinaryTable::Int8;
+    else if (t == "uchar" || t == "uint8")
+        return BinaryTable::UInt8;
+    else if (t == "short" || t == "int16")
+        return BinaryTable::Int16;
+    else if (t == "ushort" || t == "uint16")
+        return BinaryTable::UInt16;
+    else if (t == "int" || t == "int32")
+        return BinaryTable::Int32;
+    else if (t == "uint" || t == "uint32")
+        return BinaryTable::UInt32;
+    else if (t == "float" || t == "float32")
+        return BinaryTable::Float32;
+    else if (t == "double" || t == "float64")
+        return BinaryTable::Float64;
+    throw Base::BadFormatError("Unexpected type");
+}
+
+/*!
+ Returns the type of a binary PCD field.
+ */
+BinaryTable::Type pcdType(char t, int size)
+{
+    switch (size) {
+    case 1:
+        if (t == 'I')
+            return BinaryTable::Int8;
+        else if (t == 'U')
+            return BinaryTable::UInt8;
+        break;
+    case 2:
+        if (t == 'I')
+            return BinaryTable::Int16;
+        else if (t == 'U')
+            return BinaryTable::UInt16;
+        break;
+    case 4:
+        if (t == 'I')
+            return BinaryTable::Int32;
+        else if (t == 'U')
+            return BinaryTable::UInt32;
+        else if (t == 'F')
+            return BinaryTable::Float32;
+        break;
+    case 8:
+        if (t == 'F')
+            return BinaryTable::Float64;
+        break;
+    default:
+        break;
+    }
+    throw Base::BadFormatError("Unexpected type");
+}
+
+/// Returns true if the host stores numbers in big endian order
+bool isBigEndianHost()
+{
+    return Base::SwapOrder() == HIGH_ENDIAN;
+}
+
+/*!
+ Reads the rows of a binary table either stored row by row or, if
+ \a columnWise is true, field by field.
+ */
+void readBinaryTable(bool swapByteOrder, bool columnWise,
+                     const char* begin, const char* end,
+                     const std::vector<BinaryTable::Type>& types,
+                     std::size_t numPoints,
+                     const RowConverter& converter)
+{
+    std::size_t rowSize = 0;
+    for (std::vector<BinaryTable::Type>::const_iterator it = types.begin(); it != types.end(); ++it)
+        rowSize += BinaryTable::sizeOf(*it);
+    if (begin > end || rowSize * numPoints > static_cast<std::size_t>(end - begin))
+        throw Base::BadFormatError("File expects too many elements");
+
+    BinaryTable table(begin, swapByteOrder);
+    std::size_t offset = 0;
+    for (std::vector<BinaryTable::Type>::const_iterator it = types.begin(); it != types.end(); ++it) {
+        std::size_t size = BinaryTable::sizeOf(*it);
+        if (columnWise) {
+            table.addField(*it, offset * numPoints, size);
+        }
+        else {
+            table.addField(*it, offset, rowSize);
+        }
+        offset += size;
+    }
+
+    table.parse(numPoints, converter);
+}
+
+/*!
+ Reads the rows of an ASCII table and shrinks the containers if the file
+ has less rows than expected.
+ */
+void readAsciiTable(const char* begin, const char* end, std::size_t skip,
+                    std::size_t numFields, std::size_t numPoints,
+                    const RowConverter& converter)
+{
+    AsciiTable table(begin, end, numFields, false);
+    table.skipLines(skip);
+    std::size_t count = table.parse(numPoints, converter,
+        [&converter](std::size_t from, std::size_t to, std::size_t count) {
+        converter.move(from, to, count);
+    });
+    if (count < numPoints)
+        converter.resize(count);
+}
+
+} // namespace Points
+
+// ----------------------------------------------------------------------------
+
+void PointsAlgos::Load(PointKernel &points, const char *FileName)
+{
+    Base::FileInfo File(FileName);
+
+    // checking on the file
+    if (!File.isReadable())
+        throw Base::FileException("File to load not existing or not readable", FileName);
+
+    if (File.hasExtension("asc"))
+        LoadAscii(points,FileName);
+    else
+        throw Base::RuntimeError("Unknown ending");
+}
+
+void PointsAlgos::LoadAscii(PointKernel &points, const char *FileName)
+{
+    // Only lines with exactly three numbers are points, all other lines
+    // like comments are ignored
+    Base::TimeInfo start;
+    MappedFile file(FileName);
+    AsciiTable table(file.begin(), file.end(), 3, true);
+
+    Base::Matrix4D mat = points.getTransform();
+    bool identity = (mat == Base::Matrix4D());
+    mat.inverse();
+
+    std::vector<PointKernel::value_type>& pts = points.getBasicPoints();
+    pts.resize(table.countRows());
+
+    std::size_t count = table.parse(pts.size(),
+        [&pts, &mat, identity](std::size_t row, const double* values) {
+        if (identity) {
+            pts[row].Set(static_cast<float>(values[0]),
+                         static_cast<float>(values[1]),
+                         static_cast<float>(values[2]));
+        }
+        else {
+            Base::Vector3d pt = mat * Base::Vector3d(values[0], values[1], values[2]);
+            pts[row].Set(static_cast<float>(pt.x),
+                         static_cast<float>(pt.y),
+                         static_cast<float>(pt.z));
+        }
+    },
+        [&pts](std::size_t from, std::size_t to, std::size_t count) {
+        std::copy(pts.begin() + from, pts.begin() + from + count, pts.begin() + to);
+    });
+
+    // now remove the comment lines which were counted as points
+    pts.resize(count);
+
+    logThroughput("asc", count, start);
 }
 
 // ----------------------------------------------------------------------------
@@ -213,8 +1035,6 @@ public:
     virtual ~Converter() {
     }
     virtual std::string toString(float) const = 0;
-    virtual double toDouble(Base::InputStream&) const = 0;
-    virtual int getSizeOf() const = 0;
 };
 template <typename T>
 class ConverterT : public Converter {
@@ -227,85 +1047,57 @@ public:
         oss << c;
         return oss.str();
     }
-    virtual double toDouble(Base::InputStream& str) const {
-        T c;
-        str >> c;
-        return static_cast<double>(c);
-    }
-    virtual int getSizeOf() const {
-        return sizeof(T);
-    }
 };
 
 typedef boost::shared_ptr<Converter> ConverterPtr;
 
-class DataStreambuf : public std::streambuf
+/*!
+ Collects the values of the rows in a buffer which is written at once
+ when it is full. Like Base::OutputStream the values are written in
+ little endian order, so they are swapped on big endian hosts.
+ */
+class BinaryRowWriter
 {
 public:
-    explicit DataStreambuf(const std::vector<char>& data) : _buffer(data) {
-        _beg = 0;
-        _end = data.size();
-        _cur = 0;
-    }
-    ~DataStreambuf() {
-    }
-
-protected:
-    virtual int_type uflow() {
-        if (_cur == _end)
-            return traits_type::eof();
-
-        return static_cast<DataStreambuf::int_type>(_buffer[_cur++]) & 0x000000ff;
+    explicit BinaryRowWriter(std::ostream& out)
+        : out(out), swapByteOrder(isBigEndianHost()) {
+        buffer.reserve(bufferSize);
     }
-    virtual int_type underflow() {
-        if (_cur == _end)
-            return traits_type::eof();
-
-        return static_cast<DataStreambuf::int_type>(_buffer[_cur]) & 0x000000ff;
+    ~BinaryRowWriter() {
+        flush();
     }
-    virtual int_type pbackfail(int_type ch) {
-        if (_cur == _beg || (ch != traits_type::eof() && ch != _buffer[_cur-1]))
-            return traits_type::eof();
-
-        return static_cast<DataStreambuf::int_type>(_buffer[--_cur]) & 0x000000ff;
+    template <typename T>
+    void add(T value) {
+        if (swapByteOrder)
+            Base::SwapEndian<T>(value);
+        std::size_t pos = buffer.size();
+        buffer.resize(pos + sizeof(T));
+        memcpy(&buffer[pos], &value, sizeof(T));
+        if (buffer.size() >= bufferSize)
+            flush();
     }
-    virtual std::streamsize showmanyc() {
-        return _end - _cur;
-    }
-    virtual pos_type seekoff(std::streambuf::off_type off,
-        std::ios_base::seekdir way,
-        std::ios_base::openmode = 
-            std::ios::in | std::ios::out) {
-        int p_pos=-1;
-        if (way == std::ios_base::beg)
-            p_pos = _beg;
-        else if (way == std::ios_base::end)
-            p_pos = _end;
-        else if (way == std::ios_base::cur)
-            p_pos = _cur;
-
-        if (p_pos > _end)
-            return traits_type::eof();
-
-        if (((p_pos + off) > _end) || ((p_pos + off) < _beg))
-            return traits_type::eof();
-
-        _cur = p_pos+ off;
-
-        return ((p_pos+off) - _beg);
-    }
-    virtual pos_type seekpos(std::streambuf::pos_type pos,
-        std::ios_base::openmode which =
-        std::ios::in | std::ios::out) {
-        (void)which;
-        return seekoff(pos, std::ios_base::beg);
+    void flush() {
+        if (!buffer.empty())
+            out.write(&buffer[0], buffer.size());
+        buffer.clear();
     }
 
 private:
-    const std::vector<char>& _buffer;
-    int _beg, _end, _cur;
+    static const std::size_t bufferSize = 1024 * 1024;
+    std::ostream& out;
+    std::vector<char> buffer;
+    bool swapByteOrder;
 };
 
+uint32_t packedColor(const App::Color& c)
+{
+    // http://docs.pointclouds.org/1.3.0/structpcl_1_1_r_g_b.html
+    return static_cast<uint32_t>(c.a*255.0f + 0.5f) << 24 |
+           static_cast<uint32_t>(c.r*255.0f + 0.5f) << 16 |
+           static_cast<uint32_t>(c.g*255.0f + 0.5f) << 8  |
+           static_cast<uint32_t>(c.b*255.0f + 0.5f);
+}
+
 //Taken from https://github.com/PointCloudLibrary/pcl/blob/master/io/src/lzf.cpp
 unsigned int 
 lzfDecompress (const void *const in_data,  unsigned int in_len,
@@ -503,153 +1295,52 @@ PlyReader::~PlyReader()
 void PlyReader::read(const std::string& filename)
 {
     clear();
+    points.clear();
     this->width = 1;
     this->height = 0;
 
-    Base::FileInfo fi(filename);
-    Base::ifstream inp(fi, std::ios::in | std::ios::binary);
-
+    Base::TimeInfo start;
     std::string format;
     std::vector<std::string> fields;
     std::vector<std::string> types;
     std::vector<int> sizes;
     std::size_t offset = 0;
-    std::size_t numPoints = readHeader(inp, format, offset, fields, types, sizes);
-
-    Eigen::MatrixXd data(numPoints, fields.size());
-    if (format == "ascii") {
-        readAscii(inp, offset, data);
-    }
-    else if (format == "binary_little_endian") {
-        readBinary(false, inp, offset, types, sizes, data);
-    }
-    else if (format == "binary_big_endian") {
-        readBinary(true, inp, offset, types, sizes, data);
-    }
-
-    std::vector<std::string>::iterator it;
-    std::size_t max_size = std::numeric_limits<std::size_t>::max();
-
-    // x field
-    std::size_t x = max_size;
-    it = std::find(fields.begin(), fields.end(), "x");
-    if (it != fields.end())
-        x = std::distance(fields.begin(), it);
-
-    // y field
-    std::size_t y = max_size;
-    it = std::find(fields.begin(), fields.end(), "y");
-    if (it != fields.end())
-        y = std::distance(fields.begin(), it);
-
-    // z field
-    std::size_t z = max_size;
-    it = std::find(fields.begin(), fields.end(), "z");
-    if (it != fields.end())
-        z = std::distance(fields.begin(), it);
-
-    // normal x field
-    std::size_t normal_x = max_size;
-    it = std::find(fields.begin(), fields.end(), "normal_x");
-    if (it == fields.end())
-        it = std::find(fields.begin(), fields.end(), "nx");
-    if (it != fields.end())
-        normal_x = std::distance(fields.begin(), it);
-
-    // normal y field
-    std::size_t normal_y = max_size;
-    it = std::find(fields.begin(), fields.end(), "normal_y");
-    if (it == fields.end())
-        it = std::find(fields.begin(), fields.end(), "ny");
-    if (it != fields.end())
-        normal_y = std::distance(fields.begin(), it);
-
-    // normal z field
-    std::size_t normal_z = max_size;
-    it = std::find(fields.begin(), fields.end(), "normal_z");
-    if (it == fields.end())
-        it = std::find(fields.begin(), fields.end(), "nz");
-    if (it != fields.end())
-        normal_z = std::distance(fields.begin(), it);
-
-    // intensity field
-    std::size_t greyvalue = max_size;
-    it = std::find(fields.begin(), fields.end(), "intensity");
-    if (it != fields.end())
-        greyvalue = std::distance(fields.begin(), it);
-
-    // rgb(a) field
-    std::size_t red = max_size, green = max_size, blue = max_size, alpha = max_size;
-    it = std::find(fields.begin(), fields.end(), "red");
-    if (it != fields.end())
-        red = std::distance(fields.begin(), it);
-
-    it = std::find(fields.begin(), fields.end(), "green");
-    if (it != fields.end())
-        green = std::distance(fields.begin(), it);
-
-    it = std::find(fields.begin(), fields.end(), "blue");
-    if (it != fields.end())
-        blue = std::distance(fields.begin(), it);
-
-    it = std::find(fields.begin(), fields.end(), "alpha");
-    if (it != fields.end())
-        alpha = std::distance(fields.begin(), it);
-
-    // transfer the data
-    bool hasData = (x != max_size && y != max_size && z != max_size);
-    bool hasNormal = (normal_x != max_size && normal_y != max_size && normal_z != max_size);
-    bool hasIntensity = (greyvalue != max_size);
-    bool hasColor = (red != max_size && green != max_size && blue != max_size);
-
-    if (hasData) {
-        points.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            points.push_back(Base::Vector3d(data(i,x),data(i,y),data(i,z)));
-        }
+    std::size_t numPoints = 0;
+    std::streamoff header = 0;
+    {
+        Base::FileInfo fi(filename);
+        Base::ifstream inp(fi, std::ios::in | std::ios::binary);
+        numPoints = readHeader(inp, format, offset, fields, types, sizes);
+        header = inp.tellg();
     }
 
-    if (hasData && hasNormal) {
-        normals.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            normals.push_back(Base::Vector3f(data(i,normal_x),data(i,normal_y),data(i,normal_z)));
-        }
-    }
+    RowConverter converter(fields);
+    converter.setColorComponents(types);
+    if (!converter.hasData())
+        return;
+    converter.prepare(numPoints, points.getBasicPoints(), normals, intensity, colors);
 
-    if (hasData && hasIntensity) {
-        intensity.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            intensity.push_back(data(i,greyvalue));
-        }
-    }
+    // the data is parsed directly from the mapped file
+    MappedFile file(filename);
+    if (header < 0 || header > file.end() - file.begin())
+        throw Base::BadFormatError("Not a valid ply file");
+    const char* data = file.begin() + header;
 
-    if (hasData && hasColor) {
-        colors.reserve(numPoints);
-        float a = 1.0;
-        if (types[red] == "uchar") {
-            for (std::size_t i=0; i<numPoints; i++) {
-                float r = data(i, red);
-                float g = data(i, green);
-                float b = data(i, blue);
-                if (alpha != max_size)
-                    a = data(i, alpha);
-                colors.push_back(App::Color(static_cast<float>(r)/255.0f,
-                                            static_cast<float>(g)/255.0f,
-                                            static_cast<float>(b)/255.0f,
-                                            static_cast<float>(a)/255.0f));
-            }
-        }
-        else if (types[red] == "float") {
-            for (std::size_t i=0; i<numPoints; i++) {
-                float r = data(i, red);
-                float g = data(i, green);
-                float b = data(i, blue);
-                if (alpha != max_size)
-                    a = data(i, alpha);
-                colors.push_back(App::Color(r, g, b, a));
-            }
-        }
+    if (format == "ascii") {
+        readAsciiTable(data, file.end(), offset, fields.size(), numPoints, converter);
     }
+    else if (format == "binary_little_endian" || format == "binary_big_endian") {
+        std::vector<BinaryTable::Type> binaryTypes;
+        for (std::vector<std::string>::iterator it = types.begin(); it != types.end(); ++it)
+            binaryTypes.push_back(plyType(*it));
+        if (static_cast<std::size_t>(file.end() - data) < offset)
+            throw Base::BadFormatError("File expects too many elements");
+        bool swapByteOrder = (format == "binary_big_endian") != isBigEndianHost();
+        readBinaryTable(swapByteOrder, false, data + offset, file.end(), binaryTypes,
+                        numPoints, converter);
+    }
+
+    logThroughput("ply", points.size(), start);
 }
 
 std::size_t PlyReader::readHeader(std::istream& in,
@@ -820,121 +1511,6 @@ std::size_t PlyReader::readHeader(std::istream& in,
     return numPoints;
 }
 
-void PlyReader::readAscii(std::istream& inp, std::size_t offset, Eigen::MatrixXd& data)
-{
-    std::string line;
-    std::size_t row = 0;
-    std::size_t numPoints = data.rows();
-    std::size_t numFields = data.cols();
-    std::vector<std::string> list;
-    while (std::getline(inp, line) && row < numPoints) {
-        if (line.empty())
-            continue;
-
-        if (offset > 0) {
-            offset--;
-            continue;
-        }
-
-        // since the file is loaded in binary mode we may get the CR at the end
-        boost::trim(line);
-        boost::split(list, line, boost::is_any_of ("\t\r "), boost::token_compress_on);
-
-        std::istringstream str(line);
-
-        for (std::size_t col = 0; col < list.size() && col < numFields; col++) {
-            double value = boost::lexical_cast<double>(list[col]);
-            data(row, col) = value;
-        }
-
-        ++row;
-    }
-}
-
-void PlyReader::readBinary(bool swapByteOrder,
-                           std::istream& inp,
-                           std::size_t offset,
-                           const std::vector<std::string>& types,
-                           const std::vector<int>& sizes,
-                           Eigen::MatrixXd& data)
-{
-    std::size_t numPoints = data.rows();
-    std::size_t numFields = data.cols();
-
-    int neededSize = 0;
-    ConverterPtr convert_float32(new ConverterT<float>);
-    ConverterPtr convert_float64(new ConverterT<double>);
-    ConverterPtr convert_int8(new ConverterT<int8_t>);
-    ConverterPtr convert_uint8(new ConverterT<uint8_t>);
-    ConverterPtr convert_int16(new ConverterT<int16_t>);
-    ConverterPtr convert_uint16(new ConverterT<uint16_t>);
-    ConverterPtr convert_int32(new ConverterT<int32_t>);
-    ConverterPtr convert_uint32(new ConverterT<uint32_t>);
-
-    std::vector<ConverterPtr> converters;
-    for (std::size_t j=0; j<numFields; j++) {
-        std::string t = types[j];
-        switch (sizes[j]) {
-        case 1:
-            if (t == "char" || t == "int8")
-                converters.push_back(convert_int8);
-            else if (t == "uchar" || t == "uint8")
-                converters.push_back(convert_uint8);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        case 2:
-            if (t == "short" || t == "int16")
-                converters.push_back(convert_int16);
-            else if (t == "ushort" || t == "uint16")
-                converters.push_back(convert_uint16);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        case 4:
-            if (t == "int" || t == "int32")
-                converters.push_back(convert_int32);
-            else if (t == "uint" || t == "uint32")
-                converters.push_back(convert_uint32);
-            else if (t == "float" || t == "float32")
-                converters.push_back(convert_float32);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        case 8:
-            if (t == "double" || t == "float64")
-                converters.push_back(convert_float64);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        default:
-            throw Base::BadFormatError("Unexpected type");
-        }
-
-        neededSize += converters.back()->getSizeOf();
-    }
-
-    std::streamoff ulSize = 0;
-    std::streamoff ulCurr = 0;
-    std::streambuf* buf = inp.rdbuf();
-    if (buf) {
-        ulCurr = buf->pubseekoff(static_cast<std::streamoff>(offset), std::ios::cur, std::ios::in);
-        ulSize = buf->pubseekoff(0, std::ios::end, std::ios::in);
-        buf->pubseekoff(ulCurr, std::ios::beg, std::ios::in);
-        if (ulCurr + neededSize*static_cast<std::streamoff>(numPoints) > ulSize)
-            throw Base::BadFormatError("File expects too many elements");
-    }
-
-    Base::InputStream str(inp);
-    str.setByteOrder(swapByteOrder ? Base::Stream::BigEndian : Base::Stream::LittleEndian);
-    for (std::size_t i=0; i<numPoints; i++) {
-        for (std::size_t j=0; j<numFields; j++) {
-            double value = converters[j]->toDouble(str);
-            data(i, j) = value;
-        }
-    }
-}
-
 // ----------------------------------------------------------------------------
 
 PcdReader::PcdReader()
@@ -948,166 +1524,72 @@ PcdReader::~PcdReader()
 void PcdReader::read(const std::string& filename)
 {
     clear();
+    points.clear();
     this->width = -1;
     this->height = -1;
 
-    Base::FileInfo fi(filename);
-    Base::ifstream inp(fi, std::ios::in | std::ios::binary);
-
+    Base::TimeInfo start;
     std::string format;
     std::vector<std::string> fields;
     std::vector<std::string> types;
     std::vector<int> sizes;
-    std::size_t numPoints = readHeader(inp, format, fields, types, sizes);
+    std::size_t numPoints = 0;
+    std::streamoff header = 0;
+    {
+        Base::FileInfo fi(filename);
+        Base::ifstream inp(fi, std::ios::in | std::ios::binary);
+        numPoints = readHeader(inp, format, fields, types, sizes);
+        header = inp.tellg();
+    }
+
+    RowConverter converter(fields);
+    converter.setPackedColor(types);
+    if (!converter.hasData())
+        return;
+
+    std::vector<BinaryTable::Type> binaryTypes;
+    if (format != "ascii") {
+        for (std::size_t i = 0; i < types.size(); i++)
+            binaryTypes.push_back(pcdType(types[i][0], sizes[i]));
+    }
+
+    converter.prepare(numPoints, points.getBasicPoints(), normals, intensity, colors);
+
+    // the data is parsed directly from the mapped file
+    MappedFile file(filename);
+    if (header < 0 || header > file.end() - file.begin())
+        throw Base::BadFormatError("Not a valid pcd file");
+    const char* data = file.begin() + header;
 
-    Eigen::MatrixXd data(numPoints, fields.size());
     if (format == "ascii") {
-        readAscii(inp, data);
+        readAsciiTable(data, file.end(), 0, fields.size(), numPoints, converter);
     }
     else if (format == "binary") {
-        readBinary(false, inp, types, sizes, data);
+        // like PCL we expect the binary data in little endian order
+        readBinaryTable(isBigEndianHost(), false, data, file.end(), binaryTypes, numPoints, converter);
     }
     else if (format == "binary_compressed") {
-        unsigned int c, u;
-        Base::InputStream str(inp);
-        str >> c >> u;
+        // sizes of the compressed and uncompressed data
+        uint32_t c, u;
+        if (file.end() - data < 8)
+            throw Base::BadFormatError("Failed to decompress binary data");
+        memcpy(&c, data, sizeof(c));
+        memcpy(&u, data + 4, sizeof(u));
+        data += 8;
+        if (static_cast<std::size_t>(file.end() - data) < c)
+            throw Base::BadFormatError("Failed to decompress binary data");
 
-        std::vector<char> compressed(c);
-        inp.read(&compressed[0], c);
         std::vector<char> uncompressed(u);
-        if (lzfDecompress(&compressed[0], c, &uncompressed[0], u) == u) {
-            DataStreambuf ibuf(uncompressed);
-            std::istream istr(0);
-            istr.rdbuf(&ibuf);
-            readBinary(true, istr, types, sizes, data);
-        }
-        else {
+        if (u > 0 && lzfDecompress(data, c, &uncompressed[0], u) != u)
             throw Base::BadFormatError("Failed to decompress binary data");
-        }
-    }
-
-    std::vector<std::string>::iterator it;
-    std::size_t max_size = std::numeric_limits<std::size_t>::max();
-
-    // x field
-    std::size_t x = max_size;
-    it = std::find(fields.begin(), fields.end(), "x");
-    if (it != fields.end())
-        x = std::distance(fields.begin(), it);
-
-    // y field
-    std::size_t y = max_size;
-    it = std::find(fields.begin(), fields.end(), "y");
-    if (it != fields.end())
-        y = std::distance(fields.begin(), it);
-
-    // z field
-    std::size_t z = max_size;
-    it = std::find(fields.begin(), fields.end(), "z");
-    if (it != fields.end())
-        z = std::distance(fields.begin(), it);
-
-    // normal x field
-    std::size_t normal_x = max_size;
-    it = std::find(fields.begin(), fields.end(), "normal_x");
-    if (it == fields.end())
-        it = std::find(fields.begin(), fields.end(), "nx");
-    if (it != fields.end())
-        normal_x = std::distance(fields.begin(), it);
-
-    // normal y field
-    std::size_t normal_y = max_size;
-    it = std::find(fields.begin(), fields.end(), "normal_y");
-    if (it == fields.end())
-        it = std::find(fields.begin(), fields.end(), "ny");
-    if (it != fields.end())
-        normal_y = std::distance(fields.begin(), it);
-
-    // normal z field
-    std::size_t normal_z = max_size;
-    it = std::find(fields.begin(), fields.end(), "normal_z");
-    if (it == fields.end())
-        it = std::find(fields.begin(), fields.end(), "nz");
-    if (it != fields.end())
-        normal_z = std::distance(fields.begin(), it);
-
-    // intensity field
-    std::size_t greyvalue = max_size;
-    it = std::find(fields.begin(), fields.end(), "intensity");
-    if (it != fields.end())
-        greyvalue = std::distance(fields.begin(), it);
-
-    // rgb(a) field
-    std::size_t rgba = max_size;
-    it = std::find(fields.begin(), fields.end(), "rgb");
-    if (it == fields.end())
-        it = std::find(fields.begin(), fields.end(), "rgba");
-    if (it != fields.end())
-        rgba = std::distance(fields.begin(), it);
-
-    // transfer the data
-    bool hasData = (x != max_size && y != max_size && z != max_size);
-    bool hasNormal = (normal_x != max_size && normal_y != max_size && normal_z != max_size);
-    bool hasIntensity = (greyvalue != max_size);
-    bool hasColor = (rgba != max_size);
-
-    if (hasData) {
-        points.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            points.push_back(Base::Vector3d(data(i,x),data(i,y),data(i,z)));
-        }
-    }
-
-    if (hasData && hasNormal) {
-        normals.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            normals.push_back(Base::Vector3f(data(i,normal_x),data(i,normal_y),data(i,normal_z)));
-        }
-    }
 
-    if (hasData && hasIntensity) {
-        intensity.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            intensity.push_back(data(i,greyvalue));
-        }
+        // the compressed data is stored field by field
+        const char* begin = uncompressed.empty() ? 0 : &uncompressed[0];
+        readBinaryTable(isBigEndianHost(), true, begin, begin + uncompressed.size(), binaryTypes,
+                        numPoints, converter);
     }
 
-    if (hasData && hasColor) {
-        colors.reserve(numPoints);
-        if (types[rgba] == "U") {
-            for (std::size_t i=0; i<numPoints; i++) {
-                uint32_t packed = static_cast<uint32_t>(data(i,rgba));
-                uint32_t a = (packed >> 24) & 0xff;
-                uint32_t r = (packed >> 16) & 0xff;
-                uint32_t g = (packed >> 8) & 0xff;
-                uint32_t b = packed & 0xff;
-                colors.push_back(App::Color(static_cast<float>(r)/255.0f,
-                                            static_cast<float>(g)/255.0f,
-                                            static_cast<float>(b)/255.0f,
-                                            static_cast<float>(a)/255.0f));
-            }
-        }
-        else if (types[rgba] == "F") {
-            union RGBA {
-                uint32_t u;
-                float f;
-            };
-
-            union RGBA v;
-            for (std::size_t i=0; i<numPoints; i++) {
-                v.f = static_cast<float>(data(i,rgba));
-                uint32_t packed = v.u;
-                uint32_t a = (packed >> 24) & 0xff;
-                uint32_t r = (packed >> 16) & 0xff;
-                uint32_t g = (packed >> 8) & 0xff;
-                uint32_t b = packed & 0xff;
-                colors.push_back(App::Color(static_cast<float>(r)/255.0f,
-                                            static_cast<float>(g)/255.0f,
-                                            static_cast<float>(b)/255.0f,
-                                            static_cast<float>(a)/255.0f));
-            }
-        }
-    }
+    logThroughput("pcd", points.size(), start);
 }
 
 std::size_t PcdReader::readHeader(std::istream& in,
@@ -1182,130 +1664,13 @@ std::size_t PcdReader::readHeader(std::istream& in,
     return points;
 }
 
-void PcdReader::readAscii(std::istream& inp, Eigen::MatrixXd& data)
-{
-    std::string line;
-    std::size_t row = 0;
-    std::size_t numPoints = data.rows();
-    std::size_t numFields = data.cols();
-    std::vector<std::string> list;
-    while (std::getline(inp, line) && row < numPoints) {
-        if (line.empty())
-            continue;
-
-        // since the file is loaded in binary mode we may get the CR at the end
-        boost::trim(line);
-        boost::split(list, line, boost::is_any_of ("\t\r "), boost::token_compress_on);
-
-        std::istringstream str(line);
-
-        for (std::size_t col = 0; col < list.size() && col < numFields; col++) {
-            double value = boost::lexical_cast<double>(list[col]);
-            data(row, col) = value;
-        }
-
-        ++row;
-    }
-}
-
-void PcdReader::readBinary(bool transpose,
-                           std::istream& inp,
-                           const std::vector<std::string>& types,
-                           const std::vector<int>& sizes,
-                           Eigen::MatrixXd& data)
-{
-    std::size_t numPoints = data.rows();
-    std::size_t numFields = data.cols();
-
-    int neededSize = 0;
-    ConverterPtr convert_float32(new ConverterT<float>);
-    ConverterPtr convert_float64(new ConverterT<double>);
-    ConverterPtr convert_int8(new ConverterT<int8_t>);
-    ConverterPtr convert_uint8(new ConverterT<uint8_t>);
-    ConverterPtr convert_int16(new ConverterT<int16_t>);
-    ConverterPtr convert_uint16(new ConverterT<uint16_t>);
-    ConverterPtr convert_int32(new ConverterT<int32_t>);
-    ConverterPtr convert_uint32(new ConverterT<uint32_t>);
-
-    std::vector<ConverterPtr> converters;
-    for (std::size_t j=0; j<numFields; j++) {
-        char t = types[j][0];
-        switch (sizes[j]) {
-        case 1:
-            if (t == 'I')
-                converters.push_back(convert_int8);
-            else if (t == 'U')
-                converters.push_back(convert_uint8);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        case 2:
-            if (t == 'I')
-                converters.push_back(convert_int16);
-            else if (t == 'U')
-                converters.push_back(convert_uint16);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        case 4:
-            if (t == 'I')
-                converters.push_back(convert_int32);
-            else if (t == 'U')
-                converters.push_back(convert_uint32);
-            else if (t == 'F')
-                converters.push_back(convert_float32);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        case 8:
-            if (t == 'F')
-                converters.push_back(convert_float64);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        default:
-            throw Base::BadFormatError("Unexpected type");
-        }
-
-        neededSize += converters.back()->getSizeOf();
-    }
-
-    std::streamoff ulSize = 0;
-    std::streamoff ulCurr = 0;
-    std::streambuf* buf = inp.rdbuf();
-    if (buf) {
-        ulCurr = buf->pubseekoff(0, std::ios::cur, std::ios::in);
-        ulSize = buf->pubseekoff(0, std::ios::end, std::ios::in);
-        buf->pubseekoff(ulCurr, std::ios::beg, std::ios::in);
-        if (ulCurr + neededSize*static_cast<std::streamoff>(numPoints) > ulSize)
-            throw Base::BadFormatError("File expects too many elements");
-    }
-
-    Base::InputStream str(inp);
-    if (transpose) {
-        for (std::size_t j=0; j<numFields; j++) {
-            for (std::size_t i=0; i<numPoints; i++) {
-                double value = converters[j]->toDouble(str);
-                data(i, j) = value;
-            }
-        }
-    }
-    else {
-        for (std::size_t i=0; i<numPoints; i++) {
-            for (std::size_t j=0; j<numFields; j++) {
-                double value = converters[j]->toDouble(str);
-                data(i, j) = value;
-            }
-        }
-    }
-}
-
 // ----------------------------------------------------------------------------
 
 Writer::Writer(const PointKernel& p) : points(p)
 {
     width = p.size();
     height = 1;
+    binary = false;
 }
 
 Writer::~Writer()
@@ -1342,6 +1707,11 @@ void Writer::setPlacement(const Base::Placement& p)
     placement = p;
 }
 
+void Writer::setBinary(bool b)
+{
+    binary = b;
+}
+
 // ----------------------------------------------------------------------------
 
 AscWriter::AscWriter(const PointKernel& p) : Writer(p)
@@ -1497,9 +1867,9 @@ void PlyWriter::write(const std::string& filename)
         col += 1;
     }
 
-    Base::ofstream out(filename, std::ios::out);
+    Base::ofstream out(filename, binary ? std::ios::out | std::ios::binary : std::ios::out);
     out << "ply" << std::endl
-        << "format ascii 1.0" << std::endl
+        << (binary ? "format binary_little_endian 1.0" : "format ascii 1.0") << std::endl
         << "comment FreeCAD generated" << std::endl;
     out << "element vertex " << numValid << std::endl;
 
@@ -1508,6 +1878,28 @@ void PlyWriter::write(const std::string& filename)
         out << "property " << *it << std::endl;
     out << "end_header" << std::endl;
 
+    if (binary) {
+        // the colors are stored as uchar, all other properties as float
+        std::vector<bool> bytes;
+        for (std::list<std::string>::iterator it = properties.begin(); it != properties.end(); ++it)
+            bytes.push_back(it->compare(0, 6, "uchar ") == 0);
+
+        BinaryRowWriter writer(out);
+        for (std::size_t r=0; r<numPoints; r++) {
+            if (boost::math::isnan(data(r,0)) ||
+                boost::math::isnan(data(r,1)) ||
+                boost::math::isnan(data(r,2)))
+                continue;
+            for (std::size_t c=0; c<col; c++) {
+                if (bytes[c])
+                    writer.add(static_cast<uint8_t>(data(r,c)));
+                else
+                    writer.add(data(r,c));
+            }
+        }
+        return;
+    }
+
     for (std::size_t r=0; r<numPoints; r++) {
         if (boost::math::isnan(data(r,0)))
             continue;
@@ -1630,17 +2022,12 @@ void PcdWriter::write(const std::string& filename)
         col += 3;
     }
 
+    std::size_t colorCol = std::numeric_limits<std::size_t>::max();
     if (hasColors) {
         for (std::size_t i=0; i<numPoints; i++) {
-            App::Color c = colors[i];
-            // http://docs.pointclouds.org/1.3.0/structpcl_1_1_r_g_b.html
-            uint32_t packed = static_cast<uint32_t>(c.a*255.0f + 0.5f) << 24 |
-                              static_cast<uint32_t>(c.r*255.0f + 0.5f) << 16 |
-                              static_cast<uint32_t>(c.g*255.0f + 0.5f) << 8  |
-                              static_cast<uint32_t>(c.b*255.0f + 0.5f);
-
-            data(i,col) = packed;
+            data(i,col) = packedColor(colors[i]);
         }
+        colorCol = col;
         col += 1;
     }
 
@@ -1652,7 +2039,7 @@ void PcdWriter::write(const std::string& filename)
     }
 
     std::size_t numFields = fields.size();
-    Base::ofstream out(filename, std::ios::out);
+    Base::ofstream out(filename, binary ? std::ios::out | std::ios::binary : std::ios::out);
     out << "# .PCD v0.7 - Point Cloud Data file format" << std::endl
         << "VERSION 0.7" << std::endl;
 
@@ -1691,7 +2078,23 @@ void PcdWriter::write(const std::string& filename)
         << " " << w << " " << x << " " << y << " " << z << std::endl;
 
     out << "POINTS " << numPoints << std::endl
-        << "DATA ascii" << std::endl;
+        << (binary ? "DATA binary" : "DATA ascii") << std::endl;
+
+    if (binary) {
+        BinaryRowWriter writer(out);
+        for (std::size_t r=0; r<numPoints; r++) {
+            for (std::size_t c=0; c<col; c++) {
+                if (c == colorCol) {
+                    // take the packed color directly as it doesn't fit into a float
+                    writer.add(packedColor(colors[r]));
+                }
+                else {
+                    writer.add(data(r,c));
+                }
+            }
+        }
+        return;
+    }
 
     for (std::size_t r=0; r<numPoints; r++) {
         for (std::size_t c=0; c<col; c++) {
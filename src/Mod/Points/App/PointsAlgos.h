@@ -26,7 +26,6 @@
 
 #include "Points.h"
 #include "Properties.h"
-#include <Eigen/Core>
 
 namespace Points
 {
@@ -91,11 +90,6 @@ private:
     std::size_t readHeader(std::istream&, std::string& format, std::size_t& offset,
         std::vector<std::string>& fields, std::vector<std::string>& types,
         std::vector<int>& sizes);
-    void readAscii(std::istream&, std::size_t offset, Eigen::MatrixXd& data);
-    void readBinary(bool swapByteOrder, std::istream&, std::size_t offset,
-        const std::vector<std::string>& types,
-        const std::vector<int>& sizes,
-        Eigen::MatrixXd& data);
 };
 
 class PcdReader : public Reader
@@ -108,11 +102,6 @@ public:
 private:
     std::size_t readHeader(std::istream&, std::string& format, std::vector<std::string>& fields,
         std::vector<std::string>& types, std::vector<int>& sizes);
-    void readAscii(std::istream&, Eigen::MatrixXd& data);
-    void readBinary(bool transpose, std::istream&,
-        const std::vector<std::string>& types,
-        const std::vector<int>& sizes,
-        Eigen::MatrixXd& data);
 };
 
 class Writer
@@ -128,6 +117,8 @@ public:
     void setWidth(int);
     void setHeight(int);
     void setPlacement(const Base::Placement&);
+    /// Write the data in binary instead of ASCII format if supported
+    void setBinary(bool);
 
 protected:
     const PointKernel& points;
@@ -136,6 +127,7 @@ protected:
     std::vector<Base::Vector3f> normals;
     int width, height;
     Base::Placement placement;
+    bool binary;
 };
 
 class AscWriter : public Writer
@@ -80,8 +80,7 @@ void Feature::onChanged(const App::Property* prop)
 {
     // if the placement has changed apply the change to the point data as well
     if (prop == &this->Placement) {
-        PointKernel& pts = const_cast<PointKernel&>(this->Points.getValue());
-        pts.setTransform(this->Placement.getValue().toMatrix());
+        this->Points.setTransform(this->Placement.getValue().toMatrix());
     }
     // if the point data has changed check and adjust the transformation as well
     else if (prop == &this->Points) {
@@ -94,6 +93,48 @@ void Feature::onChanged(const App::Property* prop)
     GeoFeature::onChanged(prop);
 }
 
+//===========================================================================
+// PagedFeature
+//===========================================================================
+
+PROPERTY_SOURCE(Points::PagedFeature, App::GeoFeature)
+
+PagedFeature::PagedFeature()
+{
+    ADD_PROPERTY(Points, (std::string()));
+}
+
+PagedFeature::~PagedFeature()
+{
+}
+
+short PagedFeature::mustExecute() const
+{
+    return 0;
+}
+
+App::DocumentObjectExecReturn *PagedFeature::execute(void)
+{
+    this->Points.touch();
+    return App::DocumentObject::StdReturn;
+}
+
+void PagedFeature::onChanged(const App::Property* prop)
+{
+    // the points can't be transformed, only their placement changes
+    if (prop == &this->Placement) {
+        this->Points.setTransform(this->Placement.getValue().toMatrix());
+    }
+    else if (prop == &this->Points) {
+        Base::Placement p;
+        p.fromMatrix(this->Points.getValue().getTransform());
+        if (p != this->Placement.getValue())
+            this->Placement.setValue(p);
+    }
+
+    GeoFeature::onChanged(prop);
+}
+
 // ---------------------------------------------------------
 
 namespace App {
@@ -84,6 +84,39 @@ public:
 typedef App::FeatureCustomT<Feature> FeatureCustom;
 typedef App::FeaturePythonT<Feature> FeaturePython;
 
+/** Feature of a point cloud kept in an octree file.
+ * Only the level of detail and the queried regions are loaded into memory.
+ */
+class PointsExport PagedFeature : public App::GeoFeature
+{
+    PROPERTY_HEADER(Points::PagedFeature);
+
+public:
+    /// Constructor
+    PagedFeature(void);
+    virtual ~PagedFeature(void);
+
+    /** @name methods override Feature */
+    //@{
+    short mustExecute() const;
+    /// recalculate the Feature
+    virtual App::DocumentObjectExecReturn *execute(void);
+    /// returns the type name of the ViewProvider
+    virtual const char* getViewProviderName(void) const {
+        return "PointsGui::ViewProviderPaged";
+    }
+
+    virtual const App::PropertyComplexGeoData* getPropertyOfGeometry() const {
+        return &Points;
+    }
+protected:
+    void onChanged(const App::Property* prop);
+    //@}
+
+public:
+    PropertyPagedPoints Points; /**< The paged points property. */
+};
+
 } //namespace Points
 
 
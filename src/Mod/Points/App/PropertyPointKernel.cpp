@@ -27,33 +27,91 @@
 # include <cmath>
 # include <iostream>
 # include <algorithm>
+# include <sstream>
 #endif
 
+#include <App/Document.h>
+#include <App/DocumentObject.h>
 #include <Base/Exception.h>
+#include <Base/FileInfo.h>
 #include <Base/Matrix.h>
+#include <Base/Reader.h>
 #include <Base/Stream.h>
 #include <Base/Writer.h>
 
 #include "PropertyPointKernel.h"
 #include "PointsPy.h"
+#include "PagedPointsPy.h"
 
 using namespace Points;
 
 TYPESYSTEM_SOURCE(Points::PropertyPointKernel , App::PropertyComplexGeoData)
 
 PropertyPointKernel::PropertyPointKernel()
-    : _cPoints(new PointKernel())
+    : _cPoints(new PointKernel()), sharedFrom(0)
 {
 
 }
 
 PropertyPointKernel::~PropertyPointKernel()
 {
+    unsharePoints();
+}
+
+void PropertyPointKernel::unsharePoints()
+{
+    if (sharedFrom) {
+        std::vector<PropertyPointKernel*>& copies = sharedFrom->sharedCopies;
+        copies.erase(std::find(copies.begin(), copies.end(), this));
+        sharedFrom = 0;
+    }
+    else if (!sharedCopies.empty()) {
+        // the first copy takes over the role of this property
+        PropertyPointKernel* owner = sharedCopies.front();
+        owner->sharedFrom = 0;
+        owner->sharedCopies.assign(sharedCopies.begin() + 1, sharedCopies.end());
+        for (std::vector<PropertyPointKernel*>::iterator it = owner->sharedCopies.begin(); it != owner->sharedCopies.end(); ++it)
+            (*it)->sharedFrom = owner;
+        sharedCopies.clear();
+    }
+}
+
+void PropertyPointKernel::detachPoints(bool keepData)
+{
+    if (!sharedFrom && sharedCopies.empty())
+        return;
+
+    Base::Reference<PointKernel> points(new PointKernel());
+    if (keepData) {
+        *points = *_cPoints;
+    }
+    else if (sharedFrom) {
+        points->setTransform(_cPoints->getTransform());
+    }
+    else {
+        // the points get replaced anyway, so move them over to the copies
+        std::vector<PointKernel::value_type> pts;
+        _cPoints->swap(pts);
+        points->swap(pts);
+        points->setTransform(_cPoints->getTransform());
+    }
+
+    if (sharedFrom) {
+        unsharePoints();
+        _cPoints = points;
+    }
+    else {
+        // keep the point kernel which may be referenced by Python wrappers
+        for (std::vector<PropertyPointKernel*>::iterator it = sharedCopies.begin(); it != sharedCopies.end(); ++it)
+            (*it)->_cPoints = points;
+        unsharePoints();
+    }
 }
 
 void PropertyPointKernel::setValue(const PointKernel& m)
 {
     aboutToSetValue();
+    detachPoints(&m == &getValue());
     *_cPoints = m;
     hasSetValue();
 }
@@ -102,6 +160,7 @@ void PropertyPointKernel::Save (Base::Writer &writer) const
 void PropertyPointKernel::Restore(Base::XMLReader &reader)
 {
     aboutToSetValue();
+    detachPoints(false);
     _cPoints->Restore(reader);
     hasSetValue();
 }
@@ -119,8 +178,12 @@ void PropertyPointKernel::RestoreDocFile(Base::Reader &reader)
 
 App::Property *PropertyPointKernel::Copy(void) const 
 {
+    // reference the same points, they get copied when modified
     PropertyPointKernel* prop = new PropertyPointKernel();
-    (*prop->_cPoints) = (*this->_cPoints);
+    PropertyPointKernel* owner = sharedFrom ? sharedFrom : const_cast<PropertyPointKernel*>(this);
+    prop->_cPoints = this->_cPoints;
+    prop->sharedFrom = owner;
+    owner->sharedCopies.push_back(prop);
     return prop;
 }
 
@@ -128,18 +191,25 @@ void PropertyPointKernel::Paste(const App::Property &from)
 {
     aboutToSetValue();
     const PropertyPointKernel& prop = dynamic_cast<const PropertyPointKernel&>(from);
-    *(this->_cPoints) = *(prop._cPoints);
+    if (&prop.getValue() != &this->getValue()) {
+        detachPoints(false);
+        *(this->_cPoints) = *(prop._cPoints);
+    }
     hasSetValue();
 }
 
 unsigned int PropertyPointKernel::getMemSize (void) const
 {
+    // shared points are counted only once
+    if (sharedFrom)
+        return 0;
     return sizeof(Base::Vector3f) * this->_cPoints->size();
 }
 
 PointKernel* PropertyPointKernel::startEditing()
 {
     aboutToSetValue();
+    detachPoints(true);
     return static_cast<PointKernel*>(_cPoints);
 }
 
@@ -179,6 +249,212 @@ void PropertyPointKernel::removeIndices( const std::vector<unsigned long>& uIndi
 void PropertyPointKernel::transformGeometry(const Base::Matrix4D &rclMat)
 {
     aboutToSetValue();
+    detachPoints(true);
     _cPoints->transformGeometry(rclMat);
     hasSetValue();
 }
+
+void PropertyPointKernel::setTransform(const Base::Matrix4D &rclMat)
+{
+    detachPoints(true);
+    _cPoints->setTransform(rclMat);
+}
+
+// ----------------------------------------------------------------------------
+
+TYPESYSTEM_SOURCE(Points::PropertyPagedPoints , App::PropertyComplexGeoData)
+
+PropertyPagedPoints::PropertyPagedPoints()
+    : _cPoints(new PagedPointKernel())
+{
+}
+
+PropertyPagedPoints::~PropertyPagedPoints()
+{
+}
+
+void PropertyPagedPoints::detachPoints()
+{
+    if (_cPoints.getRefCount() > 1) {
+        Base::Reference<PagedPointKernel> points(new PagedPointKernel());
+        if (!_cPoints->getFileName().empty())
+            points->open(_cPoints->getFileName());
+        points->setTransform(_cPoints->getTransform());
+        _cPoints = points;
+    }
+}
+
+std::string PropertyPagedPoints::getDocTransientPath() const
+{
+    std::string path;
+    App::PropertyContainer *co = getContainer();
+    if (co && co->isDerivedFrom(App::DocumentObject::getClassTypeId())) {
+        App::Document* doc = static_cast<App::DocumentObject*>(co)->getDocument();
+        if (doc)
+            path = doc->TransientDir.getValue();
+    }
+    if (path.empty())
+        path = Base::FileInfo::getTempPath();
+    return path;
+}
+
+void PropertyPagedPoints::setValue(const std::string& fileName)
+{
+    // open the file first to keep the property unchanged if this fails
+    Base::Reference<PagedPointKernel> points(new PagedPointKernel());
+    if (!fileName.empty())
+        points->open(fileName);
+    points->setTransform(_cPoints->getTransform());
+
+    aboutToSetValue();
+    _cPoints = points;
+    hasSetValue();
+}
+
+const PagedPointKernel& PropertyPagedPoints::getValue(void) const
+{
+    return *_cPoints;
+}
+
+const Data::ComplexGeoData* PropertyPagedPoints::getComplexData() const
+{
+    return _cPoints;
+}
+
+Base::BoundBox3d PropertyPagedPoints::getBoundingBox() const
+{
+    return _cPoints->getBoundBox();
+}
+
+PyObject *PropertyPagedPoints::getPyObject(void)
+{
+    PagedPointsPy* points = new PagedPointsPy(&*_cPoints);
+    points->setConst(); // set immutable
+    return points;
+}
+
+void PropertyPagedPoints::setPyObject(PyObject *value)
+{
+    if (PyObject_TypeCheck(value, &(PagedPointsPy::Type))) {
+        PagedPointsPy  *pcObject = static_cast<PagedPointsPy*>(value);
+        setValue(pcObject->getPagedPointKernelPtr()->getFileName());
+    }
+#if PY_MAJOR_VERSION >= 3
+    else if (PyUnicode_Check(value)) {
+        setValue(std::string(PyUnicode_AsUTF8(value)));
+    }
+#else
+    else if (PyString_Check(value)) {
+        setValue(std::string(PyString_AsString(value)));
+    }
+#endif
+    else {
+        std::string error = std::string("type must be 'PagedPoints' or str, not ");
+        error += value->ob_type->tp_name;
+        throw Base::TypeError(error);
+    }
+}
+
+void PropertyPagedPoints::Save (Base::Writer &writer) const
+{
+    writer.Stream() << writer.ind() << "<PagedPoints file=\"";
+    if (!_cPoints->getFileName().empty())
+        writer.Stream() << writer.addFile(getFileName(".oct").c_str(), this);
+    writer.Stream() << "\" mtrx=\"" << _cPoints->getTransform().toString() << "\"/>\n";
+}
+
+void PropertyPagedPoints::Restore(Base::XMLReader &reader)
+{
+    reader.readElement("PagedPoints");
+    Base::Matrix4D mtrx;
+    if (reader.hasAttribute("mtrx")) {
+        std::string Matrix (reader.getAttribute("mtrx") );
+        mtrx.fromString(Matrix);
+    }
+
+    aboutToSetValue();
+    _cPoints = new PagedPointKernel();
+    _cPoints->setTransform(mtrx);
+    hasSetValue();
+
+    std::string file (reader.getAttribute("file") );
+    if (!file.empty()) {
+        // initiate a file read
+        reader.addFile(file.c_str(),this);
+    }
+}
+
+void PropertyPagedPoints::SaveDocFile (Base::Writer &writer) const
+{
+    Base::ifstream from(Base::FileInfo(_cPoints->getFileName()), std::ios::in | std::ios::binary);
+    if (!from) {
+        std::stringstream str;
+        str << "PropertyPagedPoints::SaveDocFile(): "
+            << "File '" << _cPoints->getFileName() << "' cannot be read.";
+        throw Base::FileSystemError(str.str());
+    }
+
+    writer.Stream() << from.rdbuf();
+}
+
+void PropertyPagedPoints::RestoreDocFile(Base::Reader &reader)
+{
+    // the octree file is opened from the transient directory of the document
+    Base::FileInfo fi(Base::FileInfo::getTempFileName("PagedPoints", getDocTransientPath().c_str()));
+    {
+        Base::ofstream to(fi, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!to) {
+            std::stringstream str;
+            str << "PropertyPagedPoints::RestoreDocFile(): "
+                << "File '" << fi.filePath() << "' in transient directory cannot be created.";
+            throw Base::FileSystemError(str.str());
+        }
+        reader >> to.rdbuf();
+    }
+
+    Base::Reference<PagedPointKernel> points(new PagedPointKernel());
+    points->open(fi.filePath());
+    points->setTransform(_cPoints->getTransform());
+
+    aboutToSetValue();
+    _cPoints = points;
+    hasSetValue();
+}
+
+App::Property *PropertyPagedPoints::Copy(void) const
+{
+    // the file is read-only, so the kernel can be shared
+    PropertyPagedPoints* prop = new PropertyPagedPoints();
+    prop->_cPoints = this->_cPoints;
+    return prop;
+}
+
+void PropertyPagedPoints::Paste(const App::Property &from)
+{
+    aboutToSetValue();
+    const PropertyPagedPoints& prop = dynamic_cast<const PropertyPagedPoints&>(from);
+    this->_cPoints = prop._cPoints;
+    hasSetValue();
+}
+
+unsigned int PropertyPagedPoints::getMemSize (void) const
+{
+    // the properties sharing the kernel count their part of it
+    return _cPoints->getMemSize() / _cPoints.getRefCount();
+}
+
+void PropertyPagedPoints::transformGeometry(const Base::Matrix4D &rclMat)
+{
+    aboutToSetValue();
+    detachPoints();
+    _cPoints->transformGeometry(rclMat);
+    hasSetValue();
+}
+
+void PropertyPagedPoints::setTransform(const Base::Matrix4D &rclMat)
+{
+    if (_cPoints->getTransform() == rclMat)
+        return;
+    detachPoints();
+    _cPoints->setTransform(rclMat);
+}
@@ -25,6 +25,7 @@
 #define POINTS_PROPERTYPOINTKERNEL_H
 
 #include "Points.h"
+#include "PagedPoints.h"
 
 namespace Points
 {
@@ -62,7 +63,9 @@ public:
 
     /** @name Undo/Redo */
     //@{
-    /// returns a new copy of the property (mainly for Undo/Redo and transactions)
+    /** returns a new copy of the property (mainly for Undo/Redo and transactions)
+     * The copy shares the points until one of the properties gets modified.
+     */
     App::Property *Copy(void) const;
     /// paste the value from the property (mainly for Undo/Redo and transactions)
     void Paste(const App::Property &from);
@@ -84,10 +87,90 @@ public:
     /// Transform the real 3d point kernel
     void transformGeometry(const Base::Matrix4D &rclMat);
     void removeIndices( const std::vector<unsigned long>& );
+    /// Sets the placement of the points without touching the property
+    void setTransform(const Base::Matrix4D &rclMat);
     //@}
 
+private:
+    /** Makes sure that the point kernel is not shared with other properties.
+     * If \a keepData is false the points are about to be replaced and the
+     * other properties take them over without copying.
+     */
+    void detachPoints(bool keepData);
+    /// Leaves the group of properties sharing the same point kernel
+    void unsharePoints();
+
 private:
     Base::Reference<PointKernel> _cPoints;
+    /// the property whose point kernel is shared, or null
+    PropertyPointKernel* sharedFrom;
+    /// the copies sharing the point kernel of this property
+    std::vector<PropertyPointKernel*> sharedCopies;
+};
+
+/** The property of a point cloud kept in an octree file
+ * The file is read-only, so copies of the property open the same file. When
+ * saving the document the file is embedded into the project file and when
+ * restoring it is extracted into the transient directory of the document.
+ */
+class PointsExport PropertyPagedPoints : public App::PropertyComplexGeoData
+{
+    TYPESYSTEM_HEADER();
+
+public:
+    PropertyPagedPoints();
+    ~PropertyPagedPoints();
+
+    /** @name Getter/setter */
+    //@{
+    /// Opens the octree file, an empty name closes the file
+    void setValue(const std::string& fileName);
+    /// get the points (only const possible!)
+    const PagedPointKernel &getValue(void) const;
+    const Data::ComplexGeoData* getComplexData() const;
+    //@}
+
+    /** @name Getting basic geometric entities */
+    //@{
+    Base::BoundBox3d getBoundingBox() const;
+    //@}
+
+    /** @name Python interface */
+    //@{
+    PyObject* getPyObject(void);
+    void setPyObject(PyObject *value);
+    //@}
+
+    /** @name Undo/Redo */
+    //@{
+    App::Property *Copy(void) const;
+    void Paste(const App::Property &from);
+    unsigned int getMemSize (void) const;
+    //@}
+
+    /** @name Save/restore */
+    //@{
+    void Save (Base::Writer &writer) const;
+    void Restore(Base::XMLReader &reader);
+    void SaveDocFile (Base::Writer &writer) const;
+    void RestoreDocFile(Base::Reader &reader);
+    //@}
+
+    /** @name Modification */
+    //@{
+    /// Only changes the placement, the file is read-only
+    void transformGeometry(const Base::Matrix4D &rclMat);
+    /// Sets the placement of the points without touching the property
+    void setTransform(const Base::Matrix4D &rclMat);
+    //@}
+
+private:
+    /// Copies share the kernel until the placement of one of them changes
+    void detachPoints();
+    std::string getDocTransientPath() const;
+
+private:
+    Base::Reference<PagedPointKernel> _cPoints;
 };
 
 } // namespace Points
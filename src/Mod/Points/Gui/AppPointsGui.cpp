@@ -95,6 +95,7 @@ PyMOD_INIT_FUNC(PointsGui)
     PointsGui::ViewProviderPoints       ::init();
     PointsGui::ViewProviderScattered    ::init();
     PointsGui::ViewProviderStructured   ::init();
+    PointsGui::ViewProviderPaged        ::init();
     PointsGui::ViewProviderPython       ::init();
     PointsGui::Workbench                ::init();
     Gui::ViewProviderBuilder::add(
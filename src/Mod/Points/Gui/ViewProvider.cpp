@@ -502,6 +502,101 @@ void ViewProviderScattered::cut(const std::vector<SbVec2f>& picked, Gui::View3DI
 
 // -------------------------------------------------
 
+PROPERTY_SOURCE(PointsGui::ViewProviderPaged, PointsGui::ViewProviderPoints)
+
+App::PropertyIntegerConstraint::Constraints ViewProviderPaged::pointRange = {1000,std::numeric_limits<int>::max(),100000};
+
+ViewProviderPaged::ViewProviderPaged()
+{
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Points");
+    long limit = hGrp->GetInt("PagedPointsLimit", 1000000);
+    ADD_PROPERTY(DisplayPoints,(std::max<long>(limit, pointRange.LowerBound)));
+    DisplayPoints.setConstraints(&pointRange);
+
+    pcPoints = new SoPointSet();
+    pcPoints->ref();
+}
+
+ViewProviderPaged::~ViewProviderPaged()
+{
+    pcPoints->unref();
+}
+
+void ViewProviderPaged::attach(App::DocumentObject* pcObj)
+{
+    // call parent's attach to define display modes
+    ViewProviderGeometryObject::attach(pcObj);
+
+    pcHighlight->objectName = pcObj->getNameInDocument();
+    pcHighlight->documentName = pcObj->getDocument()->getName();
+    pcHighlight->subElementName = "Main";
+
+    // Highlight for selection
+    pcHighlight->addChild(pcPointsCoord);
+    pcHighlight->addChild(pcPoints);
+
+    // points part ---------------------------------------------
+    SoGroup* pcPointRoot = new SoGroup();
+    pcPointRoot->addChild(pcPointStyle);
+    pcPointRoot->addChild(pcShapeMaterial);
+    pcPointRoot->addChild(pcHighlight);
+    addDisplayMaskMode(pcPointRoot, "Point");
+}
+
+std::vector<std::string> ViewProviderPaged::getDisplayModes(void) const
+{
+    std::vector<std::string> StrList;
+    StrList.push_back("Points");
+    return StrList;
+}
+
+void ViewProviderPaged::showLevelOfDetail()
+{
+    Points::PagedFeature* fea = static_cast<Points::PagedFeature*>(pcObject);
+    std::vector<Base::Vector3f> points;
+    // the placement is applied by the transform node
+    fea->Points.getValue().getLevelOfDetail(static_cast<unsigned long>(DisplayPoints.getValue()), points);
+
+    pcPointsCoord->point.setNum(points.size());
+    SbVec3f* coords = pcPointsCoord->point.startEditing();
+    std::size_t i=0;
+    for (std::vector<Base::Vector3f>::iterator it = points.begin(); it != points.end(); ++it)
+        coords[i++].setValue(it->x, it->y, it->z);
+    pcPointsCoord->point.finishEditing();
+    pcPoints->numPoints = points.size();
+}
+
+void ViewProviderPaged::updateData(const App::Property* prop)
+{
+    ViewProviderPoints::updateData(prop);
+    if (prop->getTypeId() == Points::PropertyPagedPoints::getClassTypeId()) {
+        showLevelOfDetail();
+
+        // The number of points might have changed, so force also a resize of the Inventor internals
+        setActiveMode();
+    }
+}
+
+void ViewProviderPaged::onChanged(const App::Property* prop)
+{
+    if (prop == &DisplayPoints) {
+        if (pcObject)
+            showLevelOfDetail();
+    }
+    else {
+        ViewProviderPoints::onChanged(prop);
+    }
+}
+
+void ViewProviderPaged::cut(const std::vector<SbVec2f>&, Gui::View3DInventorViewer&)
+{
+    Base::Console().Warning("Points of '%s' are kept in a read-only file and cannot be removed.\n",
+                            pcObject->Label.getValue());
+}
+
+// -------------------------------------------------
+
 PROPERTY_SOURCE(PointsGui::ViewProviderStructured, PointsGui::ViewProviderPoints)
 
 ViewProviderStructured::ViewProviderStructured()
@@ -168,6 +168,40 @@ protected:
     SoIndexedPointSet   * pcPoints;
 };
 
+/**
+ * The ViewProviderPaged class shows a point cloud kept in an octree file.
+ * Only the level of detail with at most DisplayPoints points is shown.
+ */
+class PointsGuiExport ViewProviderPaged : public ViewProviderPoints
+{
+    PROPERTY_HEADER(PointsGui::ViewProviderPaged);
+
+public:
+    ViewProviderPaged();
+    virtual ~ViewProviderPaged();
+
+    App::PropertyIntegerConstraint DisplayPoints;
+
+    virtual void attach(App::DocumentObject *);
+    /// Update the point representation
+    virtual void updateData(const App::Property*);
+    /// only the Points mode is supported
+    virtual std::vector<std::string> getDisplayModes(void) const;
+
+protected:
+    void onChanged(const App::Property* prop);
+    virtual void cut(const std::vector<SbVec2f>& picked, Gui::View3DInventorViewer &Viewer);
+
+private:
+    void showLevelOfDetail();
+
+protected:
+    SoPointSet          * pcPoints;
+
+private:
+    static App::PropertyIntegerConstraint::Constraints pointRange;
+};
+
 typedef Gui::ViewProviderPythonFeatureT<ViewProviderScattered> ViewProviderPython;
 
 } // namespace PointsGui
@@ -30,3 +30,6 @@
 # Append the open handler
 FreeCAD.addImportType("Point formats (*.asc *.pcd *.ply)","Points")
 FreeCAD.addExportType("Point formats (*.asc *.pcd *.ply)","Points")
+FreeCAD.addImportType("Point cloud octree (*.oct)","Points")
+
+FreeCAD.__unit_test__ += [ "TestPointsApp" ]
@@ -0,0 +1,94 @@
+#***************************************************************************
+#*   This file is part of the FreeCAD CAx development system.              *
+#*                                                                         *
+#*   This program is free software; you can redistribute it and/or modify  *
+#*   it under the terms of the GNU Lesser General Public License (LGPL)    *
+#*   as published by the Free Software Foundation; either version 2 of     *
+#*   the License, or (at your option) any later version.                   *
+#*   for detail see the LICENCE text file.                                 *
+#*                                                                         *
+#*   FreeCAD is distributed in the hope that it will be useful,            *
+#*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+#*   GNU Library General Public License for more details.                  *
+#*                                                                         *
+#*   You should have received a copy of the GNU Library General Public     *
+#*   License along with FreeCAD; if not, write to the Free Software        *
+#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+#*   USA                                                                   *
+#*                                                                         *
+#***************************************************************************/
+
+# Throughput of the point cloud readers. They are not part of the unit tests,
+# run them explicitly with
+#   FreeCAD -t PointsBenchmark
+
+import FreeCAD, os, shutil, tempfile, time, unittest, random
+import Points
+
+class PointsReaderBenchmarkCases(unittest.TestCase):
+  Sizes = [100000, 1000000]
+  Repeat = 3
+
+  def setUp(self):
+    self.dir = tempfile.mkdtemp()
+    self.Param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Points")
+    self.Binary = self.Param.GetBool("ExportBinary", False)
+    self.ChunkSize = self.Param.GetUnsigned("ReaderChunkSize", 0)
+    self.Doc = FreeCAD.newDocument("PointsBenchmark")
+
+  def tearDown(self):
+    FreeCAD.closeDocument(self.Doc.Name)
+    self.Param.SetBool("ExportBinary", self.Binary)
+    self.Param.SetUnsigned("ReaderChunkSize", self.ChunkSize)
+    shutil.rmtree(self.dir)
+
+  def makeCloud(self, count):
+    gen = random.Random(4711)
+    obj = self.Doc.addObject("Points::Feature", "Cloud")
+    obj.Points = Points.Points([FreeCAD.Vector(gen.uniform(0, 1000), gen.uniform(0, 1000), gen.uniform(-50, 50))
+                                for i in range(count)])
+    return obj
+
+  def export(self, obj, name, binary):
+    filename = os.path.join(self.dir, name)
+    self.Param.SetBool("ExportBinary", binary)
+    Points.export([obj], filename)
+    return filename
+
+  def read(self, filename, chunkSize=0):
+    # best of several runs, the first run also maps the file into the cache
+    self.Param.SetUnsigned("ReaderChunkSize", chunkSize)
+    best = None
+    for i in range(self.Repeat):
+      start = time.time()
+      Points.insert(filename, self.Doc.Name)
+      t = time.time() - start
+      best = t if best is None else min(best, t)
+      self.Doc.removeObject(self.Doc.Objects[-1].Name)
+    return best
+
+  def report(self, name, count, t, serial=None):
+    text = "%-18s %8d points: %10.0f points/s" % (name, count, count / max(t, 1e-6))
+    if serial is not None:
+      text += ", one chunk %10.0f points/s, speed-up %.2f" % (count / max(serial, 1e-6), serial / max(t, 1e-6))
+    FreeCAD.Console.PrintMessage(text + "\n")
+
+  def testAscii(self):
+    # compare the parallel reader with reading the whole text as one chunk
+    for count in self.Sizes:
+      obj = self.makeCloud(count)
+      for name in ("cloud.asc", "cloud.ply", "cloud.pcd"):
+        filename = self.export(obj, name, False)
+        t = self.read(filename)
+        serial = self.read(filename, os.path.getsize(filename))
+        self.report("ASCII " + name[-3:].upper(), count, t, serial)
+      self.Doc.removeObject(obj.Name)
+
+  def testBinary(self):
+    for count in self.Sizes:
+      obj = self.makeCloud(count)
+      for name in ("cloud.ply", "cloud.pcd"):
+        filename = self.export(obj, name, True)
+        self.report("Binary " + name[-3:].upper(), count, self.read(filename))
+      self.Doc.removeObject(obj.Name)
@@ -0,0 +1,446 @@
+#***************************************************************************
+#*   Copyright (c) 2020 FreeCAD Developers                                 *
+#*                                                                         *
+#*   This file is part of the FreeCAD CAx development system.              *
+#*                                                                         *
+#*   This program is free software; you can redistribute it and/or modify  *
+#*   it under the terms of the GNU Lesser General Public License (LGPL)    *
+#*   as published by the Free Software Foundation; either version 2 of     *
+#*   the License, or (at your option) any later version.                   *
+#*   for detail see the LICENCE text file.                                 *
+#*                                                                         *
+#*   FreeCAD is distributed in the hope that it will be useful,            *
+#*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+#*   GNU Lesser General Public License for more details.                   *
+#*                                                                         *
+#*   You should have received a copy of the GNU Library General Public     *
+#*   License along with FreeCAD; if not, write to the Free Software        *
+#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+#*   USA                                                                   *
+#*                                                                         *
+#***************************************************************************
+
+import FreeCAD, math, os, shutil, struct, tempfile, unittest, random
+import Points
+
+
+#---------------------------------------------------------------------------
+# define the functions to test the paged point clouds
+#---------------------------------------------------------------------------
+
+
+class PagedPointsCases(unittest.TestCase):
+    def setUp(self):
+        self.dir = tempfile.mkdtemp()
+        gen = random.Random(4711)
+        self.cloud = Points.Points([FreeCAD.Vector(gen.uniform(0, 100), gen.uniform(0, 50), gen.uniform(-10, 10))
+                                    for i in range(5000)])
+        self.file = os.path.join(self.dir, "cloud.oct")
+        Points.buildOctree(self.file, [self.cloud], 100, 20)
+
+    def tearDown(self):
+        shutil.rmtree(self.dir)
+
+    def testBuild(self):
+        paged = Points.PagedPoints(self.file)
+        self.assertEqual(paged.CountPoints, self.cloud.CountPoints)
+        self.assertEqual(paged.FileName, self.file)
+        # no temporary files are left
+        self.assertEqual(os.listdir(self.dir), ["cloud.oct"])
+        # every point is written exactly once
+        expected = sorted((p.x, p.y, p.z) for p in self.cloud.Points)
+        found = sorted((p.x, p.y, p.z) for p in [paged.getPoint(i) for i in range(paged.CountPoints)])
+        self.assertEqual(found, expected)
+
+    def testInside(self):
+        paged = Points.PagedPoints(self.file)
+        box = FreeCAD.BoundBox(20, 10, -5, 60, 30, 5)
+        indices = paged.inside(box)
+        expected = [p for p in self.cloud.Points if box.isInside(p)]
+        self.assertEqual(len(indices), len(expected))
+        for i in indices:
+            self.assertTrue(box.isInside(paged.getPoint(i)))
+        self.assertEqual(paged.extract(box).CountPoints, len(expected))
+
+    def testFindNearest(self):
+        paged = Points.PagedPoints(self.file)
+        gen = random.Random(815)
+        for i in range(50):
+            pnt = FreeCAD.Vector(gen.uniform(-10, 110), gen.uniform(-10, 60), gen.uniform(-20, 20))
+            best = min((p - pnt).Length for p in self.cloud.Points)
+            index, dist = paged.findNearest(pnt)
+            self.assertAlmostEqual(dist, best, 4)
+            self.assertAlmostEqual((paged.getPoint(index) - pnt).Length, best, 4)
+        self.assertIsNone(paged.findNearest(FreeCAD.Vector(1000, 1000, 1000), 1.0))
+
+    def testLevelOfDetail(self):
+        paged = Points.PagedPoints(self.file)
+        for limit in (10, 100, 1000):
+            self.assertLessEqual(len(paged.getLevelOfDetail(limit)), limit)
+        self.assertEqual(len(paged.getLevelOfDetail(10000)), self.cloud.CountPoints)
+
+    def testByteOrder(self):
+        # the points are mapped as they are, so the file keeps the byte order
+        with open(self.file, "rb") as f:
+            header = bytearray(f.read(24))
+        self.assertEqual(bytes(header[20:24]), struct.pack("=I", 0x01020304))
+
+        swapped = os.path.join(self.dir, "swapped.oct")
+        header[20:24] = struct.pack("=I", 0x04030201)
+        with open(self.file, "rb") as f:
+            data = bytearray(f.read())
+        data[0:24] = header
+        with open(swapped, "wb") as f:
+            f.write(data)
+        with self.assertRaises(Exception):
+            Points.PagedPoints(swapped)
+
+    def testBuildFailure(self):
+        # the octree file cannot be created, the temporary files must be removed
+        target = os.path.join(self.dir, "folder")
+        os.mkdir(target)
+        with self.assertRaises(Exception):
+            Points.buildOctree(target, [self.cloud])
+        self.assertTrue(os.path.isdir(target))
+        self.assertEqual(sorted(os.listdir(self.dir)), ["cloud.oct", "folder"])
+
+    def testSaveRestore(self):
+        doc = FreeCAD.newDocument("PagedPoints")
+        obj = doc.addObject("Points::PagedFeature", "Cloud")
+        obj.Points = self.file
+        obj.Placement.Base = FreeCAD.Vector(10, 0, 0)
+        doc.recompute()
+        first = obj.Points.getPoint(0)
+
+        # the octree file is embedded into the project file
+        project = os.path.join(self.dir, "paged.FCStd")
+        doc.saveAs(project)
+        FreeCAD.closeDocument(doc.Name)
+        os.remove(self.file)
+
+        doc = FreeCAD.openDocument(project)
+        obj = doc.getObject("Cloud")
+        self.assertEqual(obj.Points.CountPoints, self.cloud.CountPoints)
+        self.assertEqual(obj.Placement.Base, FreeCAD.Vector(10, 0, 0))
+        self.assertEqual(obj.Points.getPoint(0), first)
+        FreeCAD.closeDocument(doc.Name)
+
+    def testUndoPlacement(self):
+        doc = FreeCAD.newDocument("PagedPoints")
+        doc.UndoMode = 1
+        obj = doc.addObject("Points::PagedFeature", "Cloud")
+        obj.Points = self.file
+        first = obj.Points.getPoint(0)
+
+        doc.openTransaction("Move")
+        obj.Placement.Base = FreeCAD.Vector(0, 0, 5)
+        doc.commitTransaction()
+        self.assertEqual(obj.Points.getPoint(0), first + FreeCAD.Vector(0, 0, 5))
+
+        doc.undo()
+        self.assertEqual(obj.Points.getPoint(0), first)
+        FreeCAD.closeDocument(doc.Name)
+
+
+#---------------------------------------------------------------------------
+# define the functions to test undo/redo of the points property
+#---------------------------------------------------------------------------
+
+
+class PointsUndoCases(unittest.TestCase):
+    def setUp(self):
+        self.doc = FreeCAD.newDocument("PointsUndo")
+        self.doc.UndoMode = 1
+        self.obj = self.doc.addObject("Points::Feature", "Points")
+        self.obj.Points = Points.Points([FreeCAD.Vector(i, 0, 0) for i in range(100)])
+
+    def testUndoRedo(self):
+        # the wrapper keeps referencing the data of the property
+        pts = self.obj.Points
+        original = pts.Points
+
+        self.doc.openTransaction("Replace")
+        self.obj.Points = Points.Points([FreeCAD.Vector(0, i, 0) for i in range(50)])
+        self.doc.commitTransaction()
+        self.assertEqual(self.obj.Points.CountPoints, 50)
+        self.assertEqual(pts.CountPoints, 50)
+        # the snapshot has taken over the replaced points
+        self.assertGreaterEqual(self.doc.UndoRedoMemSize, 12 * 100)
+
+        self.doc.undo()
+        self.assertEqual(self.obj.Points.Points, original)
+        self.assertEqual(pts.Points, original)
+        self.doc.redo()
+        self.assertEqual(pts.CountPoints, 50)
+        self.assertEqual(pts.Points[1], FreeCAD.Vector(0, 1, 0))
+
+    def testUndoPlacement(self):
+        pts = self.obj.Points
+        original = pts.Points
+        offset = FreeCAD.Vector(0, 0, 5)
+
+        # only the transformation of the shared points changes
+        self.doc.openTransaction("Move")
+        self.obj.Placement.Base = offset
+        self.doc.commitTransaction()
+        self.assertEqual(pts.Points[1], original[1] + offset)
+
+        self.doc.openTransaction("Replace")
+        self.obj.Points = Points.Points([FreeCAD.Vector(0, i, 0) for i in range(50)])
+        self.doc.commitTransaction()
+        self.assertEqual(self.obj.Placement.Base, FreeCAD.Vector())
+
+        self.doc.undo()
+        self.assertEqual(self.obj.Placement.Base, offset)
+        self.assertEqual(pts.Points[1], original[1] + offset)
+        self.doc.undo()
+        self.assertEqual(self.obj.Placement.Base, FreeCAD.Vector())
+        self.assertEqual(pts.Points, original)
+        self.doc.redo()
+        self.doc.redo()
+        self.assertEqual(pts.CountPoints, 50)
+
+    def tearDown(self):
+        FreeCAD.closeDocument(self.doc.Name)
+
+
+#---------------------------------------------------------------------------
+# define the functions to test the binary export of point clouds
+#---------------------------------------------------------------------------
+
+
+class PointsBinaryExportCases(unittest.TestCase):
+    def setUp(self):
+        self.dir = tempfile.mkdtemp()
+        self.hGrp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Points")
+        self.binary = self.hGrp.GetBool("ExportBinary", False)
+        self.hGrp.SetBool("ExportBinary", True)
+        self.doc = FreeCAD.newDocument("PointsExport")
+        self.obj = self.doc.addObject("Points::Feature", "Points")
+        self.points = [FreeCAD.Vector(1.5, -2.25, 3), FreeCAD.Vector(4, 5, 6)]
+        self.obj.Points = Points.Points(self.points)
+
+    def export(self, name, separator):
+        filename = os.path.join(self.dir, name)
+        Points.export([self.obj], filename)
+        with open(filename, "rb") as f:
+            data = f.read()
+        # the data is little endian regardless of the host
+        pos = data.index(separator) + len(separator)
+        self.assertEqual(struct.unpack_from("<3f", data, pos), (1.5, -2.25, 3.0))
+
+        Points.insert(filename, self.doc.Name)
+        imported = self.doc.Objects[-1]
+        self.assertEqual(imported.Points.Points, self.points)
+
+    def testPly(self):
+        self.export("cloud.ply", b"end_header\n")
+
+    def testPcd(self):
+        self.export("cloud.pcd", b"DATA binary\n")
+
+    def tearDown(self):
+        FreeCAD.closeDocument(self.doc.Name)
+        self.hGrp.SetBool("ExportBinary", self.binary)
+        shutil.rmtree(self.dir)
+
+
+#---------------------------------------------------------------------------
+# define the functions to test the readers of point clouds
+#---------------------------------------------------------------------------
+
+
+def lzfCompress(data):
+    """Compresses data in the LZF format used by binary_compressed PCD files"""
+    out = bytearray()
+    literal = bytearray()
+
+    def flush():
+        # a literal run has at most 32 bytes
+        for i in range(0, len(literal), 32):
+            run = literal[i:i + 32]
+            out.append(len(run) - 1)
+            out.extend(run)
+        del literal[:]
+
+    table = {}
+    pos = 0
+    while pos < len(data):
+        key = bytes(data[pos:pos + 3])
+        ref = table.get(key) if len(key) == 3 else None
+        if ref is not None and pos - ref <= 8192:
+            # a back reference copies 3 to 264 bytes from the last 8 KB
+            length = 3
+            while pos + length < len(data) and length < 264 and data[ref + length] == data[pos + length]:
+                length += 1
+            flush()
+            offset = pos - ref - 1
+            if length < 9:
+                out.append(((length - 2) << 5) | (offset >> 8))
+            else:
+                out.append((7 << 5) | (offset >> 8))
+                out.append(length - 9)
+            out.append(offset & 0xff)
+            for i in range(pos, pos + length):
+                table[bytes(data[i:i + 3])] = i
+            pos += length
+        else:
+            table[key] = pos
+            literal.append(data[pos])
+            pos += 1
+    flush()
+    return bytes(out)
+
+
+class PointsReaderCases(unittest.TestCase):
+    def setUp(self):
+        self.dir = tempfile.mkdtemp()
+        self.hGrp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Points")
+        self.chunkSize = self.hGrp.GetUnsigned("ReaderChunkSize", 0)
+        self.doc = FreeCAD.newDocument("PointsReader")
+
+    def tearDown(self):
+        FreeCAD.closeDocument(self.doc.Name)
+        self.hGrp.SetUnsigned("ReaderChunkSize", self.chunkSize)
+        shutil.rmtree(self.dir)
+
+    def insert(self, name, data, chunkSize=0):
+        # with a small chunk size nearly every row crosses the nominal end of a chunk
+        self.hGrp.SetUnsigned("ReaderChunkSize", chunkSize)
+        filename = os.path.join(self.dir, name)
+        with open(filename, "wb") as f:
+            f.write(data)
+        Points.insert(filename, self.doc.Name)
+        return self.doc.Objects[-1]
+
+    def assertPoints(self, points, expected):
+        self.assertEqual([(p.x, p.y, p.z) for p in points], expected)
+
+    def assertColors(self, colors, expected):
+        self.assertEqual(len(colors), len(expected))
+        for c, e in zip(colors, expected):
+            for i in range(len(e)):
+                self.assertAlmostEqual(c[i], e[i], 6)
+
+    def testAsciiChunks(self):
+        lines = ["# comment", ""]
+        expected = []
+        for i in range(500):
+            expected.append((i * 0.25, -i * 0.5, i * 8.0))
+            # mix line endings, separators and number formats
+            if i % 3 == 0:
+                lines.append("{} {} {}\r".format(i * 0.25, -i * 0.5, i * 8.0))
+            elif i % 3 == 1:
+                lines.append("\t{:.4f}\t{}  {:e}  ".format(i * 0.25, -i * 0.5, i * 8.0))
+            else:
+                lines.append("{} {} {}".format(i * 0.25, -i * 0.5, int(i * 8)))
+            # lines without exactly three numbers are skipped
+            if i % 37 == 0:
+                lines.extend(["  \t", "# x y z", "1 2", "1 2 3 4", "x 1 2"])
+        data = "\n".join(lines).encode("ascii")
+
+        for chunkSize in (0, 1, 7, 100, 4096):
+            obj = self.insert("cloud{}.asc".format(chunkSize), data, chunkSize)
+            self.assertPoints(obj.Points.Points, expected)
+
+    def testAsciiNumbers(self):
+        data = (b"1e3 -2.5E-2 +4\n"
+                b"1.5e+2 .5 -0.\n"
+                b"nan inf -Infinity\n"
+                b"NaN +INF 1E-3\n"
+                b"1e400 -1e-400 12345678901234567890123\n"
+                # invalid numbers make the row invalid
+                b"1e 2 3\n"
+                b"1.2.3 4 5\n"
+                b"- 1 2\n"
+                b"infinit 1 2\n")
+        obj = self.insert("numbers.asc", data)
+        pts = obj.Points.Points
+        self.assertEqual(len(pts), 5)
+
+        self.assertEqual((pts[0].x, pts[0].z), (1000.0, 4.0))
+        self.assertAlmostEqual(pts[0].y, -0.025, 6)
+        self.assertEqual((pts[1].x, pts[1].y, pts[1].z), (150.0, 0.5, 0.0))
+        self.assertTrue(math.isnan(pts[2].x))
+        self.assertEqual((pts[2].y, pts[2].z), (float("inf"), float("-inf")))
+        self.assertTrue(math.isnan(pts[3].x))
+        self.assertEqual(pts[3].y, float("inf"))
+        self.assertAlmostEqual(pts[3].z, 0.001, 6)
+        # out of the range of a float
+        self.assertEqual((pts[4].x, pts[4].y), (float("inf"), 0.0))
+        self.assertAlmostEqual(pts[4].z / 1.2345678901234568e22, 1.0, 6)
+
+    def testAsciiPly(self):
+        header = ("ply\n"
+                  "format ascii 1.0\n"
+                  "comment the lines of a leading element are skipped\n"
+                  "element camera 1\n"
+                  "property float a\n"
+                  "property float b\n"
+                  "element vertex 300\n"
+                  "property float x\n"
+                  "property float y\n"
+                  "property float z\n"
+                  "property float nx\n"
+                  "property float ny\n"
+                  "property float nz\n"
+                  "property uchar red\n"
+                  "property uchar green\n"
+                  "property uchar blue\n"
+                  "element face 2\n"
+                  "property list uchar int vertex_indices\n"
+                  "end_header\n")
+        lines = ["0.5 1.5"]
+        points = []
+        normals = []
+        colors = []
+        for i in range(300):
+            points.append((i * 0.5, i * 0.25, -i * 1.0))
+            normals.append((0.0, 1.0, 0.0) if i % 2 else (0.0, 0.0, -1.0))
+            colors.append((i % 256, 255 - i % 256, 128))
+            lines.append("{} {} {} {} {} {} {} {} {}".format(*(points[-1] + normals[-1] + colors[-1])))
+        lines.extend(["3 0 1 2", "3 2 1 0"])
+        data = (header + "\n".join(lines) + "\n").encode("ascii")
+
+        for chunkSize in (0, 16):
+            obj = self.insert("cloud{}.ply".format(chunkSize), data, chunkSize)
+            self.assertPoints(obj.Points.Points, points)
+            self.assertPoints(obj.Normal, normals)
+            self.assertColors(obj.Color, [(r / 255.0, g / 255.0, b / 255.0) for r, g, b in colors])
+
+    def testBinaryCompressedPcd(self):
+        count = 1000
+        gen = random.Random(4711)
+        points = [(float(gen.randint(-1000, 1000)) / 4, float(i), 0.5) for i in range(count)]
+        normals = [(0.0, 0.0, 1.0)] * count
+        colors = [(i // 100 * 20, 255, 0, 255) for i in range(count)]
+
+        # the fields are stored one after the other
+        fields = [[p[i] for p in points] for i in range(3)] + [[n[i] for n in normals] for i in range(3)]
+        raw = b"".join(struct.pack("<{}f".format(count), *f) for f in fields)
+        raw += struct.pack("<{}I".format(count), *[a << 24 | r << 16 | g << 8 | b for r, g, b, a in colors])
+        compressed = lzfCompress(raw)
+        self.assertLess(len(compressed), len(raw))
+
+        header = ("# .PCD v0.7 - Point Cloud Data file format\n"
+                  "VERSION 0.7\n"
+                  "FIELDS x y z normal_x normal_y normal_z rgba\n"
+                  "SIZE 4 4 4 4 4 4 4\n"
+                  "TYPE F F F F F F U\n"
+                  "COUNT 1 1 1 1 1 1 1\n"
+                  "WIDTH {0}\n"
+                  "HEIGHT 1\n"
+                  "VIEWPOINT 0 0 0 1 0 0 0\n"
+                  "POINTS {0}\n"
+                  "DATA binary_compressed\n").format(count)
+        data = header.encode("ascii") + struct.pack("<II", len(compressed), len(raw)) + compressed
+
+        obj = self.insert("cloud.pcd", data)
+        self.assertPoints(obj.Points.Points, points)
+        self.assertPoints(obj.Normal, normals)
+        self.assertColors(obj.Color, [(r / 255.0, g / 255.0, b / 255.0, a / 255.0) for r, g, b, a in colors])
+
+        # truncated data
+        with self.assertRaises(Exception):
+            self.insert("truncated.pcd", data[:-10])
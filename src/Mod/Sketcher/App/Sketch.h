@@ -439,6 +439,10 @@ public:
     inline void setMaxIterRedundant(int maxiter){GCSsys.maxIterRedundant=maxiter;}
     inline void setSketchSizeMultiplier(bool mult){GCSsys.sketchSizeMultiplier=mult;}
     inline void setSketchSizeMultiplierRedundant(bool mult){GCSsys.sketchSizeMultiplierRedundant=mult;}
+    inline void setJacobianType(GCS::JacobianType type){GCSsys.jacobianType=type;}
+    inline GCS::JacobianType getJacobianType(){return GCSsys.jacobianType;}
+    inline void setSolverThreads(int threads){GCSsys.solverThreads=threads;}
+    inline int getSolverThreads(){return GCSsys.solverThreads;}
     inline void setConvergence(double conv){GCSsys.convergence=conv;}
     inline void setConvergenceRedundant(double conv){GCSsys.convergenceRedundant=conv;}
     inline void setQRAlgorithm(GCS::QRAlgorithm alg){GCSsys.qrAlgorithm=alg;}
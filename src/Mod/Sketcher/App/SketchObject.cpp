@@ -140,6 +140,10 @@ SketchObject::SketchObject()
     ParameterGrp::handle hGrpp = App::GetApplication().GetParameterGroupByPath("User parameter:BaseApp/Preferences/Mod/Sketcher");
     geoHistoryLevel = hGrpp->GetInt("GeometryHistoryLevel",1);
 
+    ParameterGrp::handle hGrps = App::GetApplication().GetParameterGroupByPath("User parameter:BaseApp/Preferences/Mod/Sketcher/SolverAdvanced");
+    solvedSketch.setJacobianType(hGrps->GetBool("SparseJacobian",false)?GCS::SparseJacobian:GCS::DenseJacobian);
+    solvedSketch.setSolverThreads(hGrps->GetInt("SolverThreads",0));
+
     Geometry.setOrderRelevant(true);
 
     allowOtherBody = true;
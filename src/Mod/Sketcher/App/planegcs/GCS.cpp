@@ -52,6 +52,11 @@
 #include <algorithm>
 #include <cfloat>
 #include <limits>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 #include "GCS.h"
 #include "qp_eq.h"
@@ -232,6 +237,8 @@ public:
 
     void LogGroupOfConstraints(const std::string & str, std::vector< std::vector<Constraint *> > constraintgroups);
 
+    void LogComponent(const std::string & str, int component, int paramsNum, int constrNum, double time, const std::string & status);
+
     void LogMatrix(const std::string str, Eigen::MatrixXd matrix);
     void LogMatrix(const std::string str, MatrixIndexType matrix );
 
@@ -372,6 +379,22 @@ void SolverReportingManager::LogGroupOfConstraints(const std::string & str, std:
     LogString(tempstream.str());
 }
 
+void SolverReportingManager::LogComponent(const std::string & str, int component, int paramsNum, int constrNum, double time, const std::string & status)
+{
+    std::stringstream tempstream;
+
+    tempstream  << str << " " << component
+                << ": Params: " << paramsNum
+                << ", Constr: " << constrNum;
+
+    if (time >= 0)
+        tempstream << ", T: " << time*1000 << " ms";
+
+    tempstream << ", " << status << std::endl;
+
+    LogString(tempstream.str());
+}
+
 
 #ifdef _GCS_DEBUG
 void SolverReportingManager::LogMatrix(const std::string str, Eigen::MatrixXd matrix )
@@ -403,6 +426,68 @@ void SolverReportingManager::LogMatrix(const std::string str, MatrixIndexType ma
 
 typedef boost::adjacency_list <boost::vecS, boost::vecS, boost::undirectedS> Graph;
 
+// Minimum number of parameters of the decoupled components to be solved or
+// diagnosed before using several threads
+static const std::size_t ParallelMinParams = 200;
+
+// Calls func(i) for each i in [0, count) using up to the given number of
+// threads. An exception thrown by func is rethrown in the calling thread.
+template <class Func>
+static void parallelFor(int count, int threads, Func func)
+{
+    threads = std::min(threads, count);
+    if (threads < 2) {
+        for (int i=0; i < count; i++)
+            func(i);
+        return;
+    }
+
+    std::atomic<int> next(0);
+    std::exception_ptr error;
+    std::mutex mutex;
+    auto worker = [&]() {
+        try {
+            for (int i=next++; i < count; i=next++)
+                func(i);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error)
+                error = std::current_exception();
+            next = count;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i=1; i < threads; i++)
+        workers.emplace_back(worker);
+    worker();
+    for (std::vector<std::thread>::iterator it=workers.begin(); it != workers.end(); ++it)
+        it->join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+static double elapsedTime(const std::chrono::steady_clock::time_point &start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static const char *solveStatusName(int status)
+{
+    switch (status) {
+        case Success:
+            return "Success";
+        case Converged:
+            return "Converged";
+        case Failed:
+            return "Failed";
+        default:
+            return "SuccessfulSolutionInvalid";
+    }
+}
+
 ///////////////////////////////////////
 // Solver
 ///////////////////////////////////////
@@ -430,6 +515,8 @@ System::System()
   , convergenceRedundant(1e-10)
   , qrAlgorithm(EigenSparseQR)
   , dogLegGaussStep(FullPivLU)
+  , jacobianType(DenseJacobian)
+  , solverThreads(0)
   , qrpivotThreshold(1E-13)
   , debugMode(Minimal)
   , LM_eps(1E-10)
@@ -1467,6 +1554,24 @@ void System::initSolution(Algorithm alg)
         plists[cid].push_back(plist[i]);
     }
 
+    // parameters read by the constraints of a component but not solved for,
+    // e.g. datum values or the target position of a dragged point
+    fixedplists.clear();
+    fixedplists.resize(componentsSize);
+    for (int cid=0; cid < componentsSize; cid++) {
+        SET_pD fixedparams;
+        for (std::vector<Constraint *>::const_iterator constr=clists[cid].begin();
+             constr != clists[cid].end(); ++constr) {
+            VEC_pD &cparams = c2p[*constr];
+            for (VEC_pD::const_iterator param=cparams.begin();
+                 param != cparams.end(); ++param) {
+                if (pIndex.find(*param) == pIndex.end())
+                    fixedparams.insert(*param);
+            }
+        }
+        fixedplists[cid].assign(fixedparams.begin(), fixedparams.end());
+    }
+
     // calculates subSystems and subSystemsAux from clists, plists and reductionmaps
     clearSubSystems();
     for (std::size_t cid=0; cid < clists.size(); cid++) {
@@ -1486,6 +1591,7 @@ void System::initSolution(Algorithm alg)
         if (clist1.size() > 0)
             subSystemsAux[cid] = new SubSystem(clist1, plists[cid], reductionmaps[cid]);
     }
+    solutions.resize(subSystems.size());
 
     isInit = true;
 }
@@ -1521,22 +1627,91 @@ int System::solve(bool isFine, Algorithm alg, bool isRedundantsolving)
     if (!isInit)
         return Failed;
 
-    bool isReset = false;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // The decoupled components are solved independently. A component whose
+    // unknowns and fixed parameters have the same values as in the last solve
+    // is not solved again, but gets the solution of the last solve. This is
+    // typically the case for all but one component while dragging.
+    std::vector<int> pending;
+    std::size_t pendingParams = 0;
+    int componentsNum = 0;
+    for (int cid=0; cid < int(subSystems.size()); cid++) {
+        if (!subSystems[cid] && !subSystemsAux[cid])
+            continue;
+        if (componentsNum++ == 0)
+            resetToReference();
+
+        VEC_D input;
+        input.reserve(plists[cid].size() + fixedplists[cid].size());
+        for (VEC_pD::const_iterator param=plists[cid].begin(); param != plists[cid].end(); ++param)
+            input.push_back(**param);
+        for (VEC_pD::const_iterator param=fixedplists[cid].begin(); param != fixedplists[cid].end(); ++param)
+            input.push_back(**param);
+
+        ComponentSolution &solution = solutions[cid];
+        if (solution.valid && solution.alg == alg && solution.isFine == isFine &&
+            solution.isRedundantsolving == isRedundantsolving && solution.input == input) {
+            if (subSystems[cid])
+                subSystems[cid]->setParams(solution.output);
+            if (subSystemsAux[cid])
+                subSystemsAux[cid]->setParams(solution.outputAux);
+            continue;
+        }
+
+        solution.valid = false;
+        solution.alg = alg;
+        solution.isFine = isFine;
+        solution.isRedundantsolving = isRedundantsolving;
+        solution.input.swap(input);
+        pending.push_back(cid);
+        pendingParams += plists[cid].size();
+    }
+
+    // The components do not share any unknowns, so they can be solved concurrently
+    int threads = getThreadCount(pending.size(), pendingParams);
+    std::vector<double> times(subSystems.size(), -1.);
+    parallelFor(int(pending.size()), threads, [&](int i) {
+        int cid = pending[i];
+        std::chrono::steady_clock::time_point componentStart = std::chrono::steady_clock::now();
+        ComponentSolution &solution = solutions[cid];
+        if (subSystems[cid] && subSystemsAux[cid])
+            solution.result = solve(subSystems[cid], subSystemsAux[cid], isFine, isRedundantsolving);
+        else if (subSystems[cid])
+            solution.result = solve(subSystems[cid], isFine, alg, isRedundantsolving);
+        else
+            solution.result = solve(subSystemsAux[cid], isFine, alg, isRedundantsolving);
+        if (subSystems[cid])
+            subSystems[cid]->getParams(solution.output);
+        if (subSystemsAux[cid])
+            subSystemsAux[cid]->getParams(solution.outputAux);
+        solution.valid = true;
+        times[cid] = elapsedTime(componentStart);
+    });
+
     // return success by default in order to permit coincidence constraints to be applied
     // even if no other system has to be solved
     int res = Success;
     for (int cid=0; cid < int(subSystems.size()); cid++) {
-        if ((subSystems[cid] || subSystemsAux[cid]) && !isReset) {
-             resetToReference();
-             isReset = true;
+        if (subSystems[cid] || subSystemsAux[cid])
+            res = std::max(res, solutions[cid].result);
+    }
+
+    if (debugMode==IterationLevel && componentsNum > 0) {
+        for (int cid=0; cid < int(subSystems.size()); cid++) {
+            if (subSystems[cid] || subSystemsAux[cid])
+                SolverReportingManager::Manager().LogComponent("Solve component", cid, int(plists[cid].size()),
+                    int(clists[cid].size()), times[cid], times[cid] < 0 ? "Unchanged" : solveStatusName(solutions[cid].result));
         }
-        if (subSystems[cid] && subSystemsAux[cid])
-            res = std::max(res, solve(subSystems[cid], subSystemsAux[cid], isFine, isRedundantsolving));
-        else if (subSystems[cid])
-            res = std::max(res, solve(subSystems[cid], isFine, alg, isRedundantsolving));
-        else if (subSystemsAux[cid])
-            res = std::max(res, solve(subSystemsAux[cid], isFine, alg, isRedundantsolving));
+
+        std::stringstream stream;
+        stream  << "Solve: components: "  << componentsNum
+                << ", solved: "           << pending.size()
+                << ", threads: "          << threads
+                << ", T: "                << elapsedTime(start)*1000 << " ms\n";
+        SolverReportingManager::Manager().LogString(stream.str());
     }
+
     if (res == Success) {
         for (std::set<Constraint *>::const_iterator constr=redundant.begin();
              constr != redundant.end(); ++constr){
@@ -1700,11 +1875,23 @@ int System::solve_LM(SubSystem* subsys, bool isRedundantsolving)
     if (xsize == 0)
         return Success;
 
+    bool sparse = (jacobianType == SparseJacobian);
+
     Eigen::VectorXd e(csize), e_new(csize); // vector of all function errors (every constraint is one function)
-    Eigen::MatrixXd J(csize, xsize);        // Jacobi of the subsystem
-    Eigen::MatrixXd A(xsize, xsize);
+    Eigen::MatrixXd J, A;                   // Jacobi of the subsystem and J^T J
+    Eigen::SparseMatrix<double> SJ, SA, SI; // sparse counterparts, SI is the identity
+    Eigen::SimplicialLDLT< Eigen::SparseMatrix<double> > ldlt;
     Eigen::VectorXd x(xsize), h(xsize), x_new(xsize), g(xsize), diag_A(xsize);
 
+    if (sparse) {
+        SI.resize(xsize, xsize);
+        SI.setIdentity();
+    }
+    else {
+        J.resize(csize, xsize);
+        A.resize(xsize, xsize);
+    }
+
     subsys->redirectParams();
 
     subsys->getParams(x);
@@ -1750,14 +1937,26 @@ int System::solve_LM(SubSystem* subsys, bool isRedundantsolving)
         }
 
         // J^T J, J^T e
-        subsys->calcJacobi(J);;
+        if (sparse) {
+            subsys->calcJacobi(SJ);
+
+            SA = SJ.transpose()*SJ;
+            g = SJ.transpose()*e;
+            diag_A = SA.diagonal();
+
+            // the pattern of A+uI does not change while adapting the damping
+            ldlt.analyzePattern(SA + SI);
+        }
+        else {
+            subsys->calcJacobi(J);
 
-        A = J.transpose()*J;
-        g = J.transpose()*e;
+            A = J.transpose()*J;
+            g = J.transpose()*e;
+            diag_A = A.diagonal(); // save diagonal entries so that augmentation can be later canceled
+        }
 
         // Compute ||J^T e||_inf
         double g_inf = g.lpNorm<Eigen::Infinity>();
-        diag_A = A.diagonal(); // save diagonal entries so that augmentation can be later canceled
 
         // check for convergence
         if (g_inf <= eps1) {
@@ -1773,13 +1972,29 @@ int System::solve_LM(SubSystem* subsys, bool isRedundantsolving)
         // determine increment using adaptive damping
         int k=0;
         while (k < 50) {
-            // augment normal equations A = A+uI
-            for (int i=0; i < xsize; ++i)
-                A(i,i) += mu;
+            double rel_error;
+            if (sparse) {
+                // augment normal equations A = A+uI, which is positive definite
+                Eigen::SparseMatrix<double> SA_mu = SA + mu*SI;
+
+                //solve augmented functions A*h=-g
+                ldlt.factorize(SA_mu);
+                if (ldlt.info() == Eigen::Success) {
+                    h = ldlt.solve(g);
+                    rel_error = (SA_mu*h - g).norm() / g.norm();
+                }
+                else
+                    rel_error = 1.;
+            }
+            else {
+                // augment normal equations A = A+uI
+                for (int i=0; i < xsize; ++i)
+                    A(i,i) += mu;
 
-            //solve augmented functions A*h=-g
-            h = A.fullPivLu().solve(g);
-            double rel_error = (A*h - g).norm() / g.norm();
+                //solve augmented functions A*h=-g
+                h = A.fullPivLu().solve(g);
+                rel_error = (A*h - g).norm() / g.norm();
+            }
 
             // check if solving works
             if (rel_error < 1e-5) {
@@ -1826,8 +2041,10 @@ int System::solve_LM(SubSystem* subsys, bool isRedundantsolving)
 
             mu*=nu;
             nu*=2.0;
-            for (int i=0; i < xsize; ++i) // restore diagonal J^T J entries
-                A(i,i) = diag_A(i);
+            if (!sparse) {
+                for (int i=0; i < xsize; ++i) // restore diagonal J^T J entries
+                    A(i,i) = diag_A(i);
+            }
 
             k++;
         }
@@ -1874,6 +2091,8 @@ int System::solve_DL(SubSystem* subsys, bool isRedundantsolving)
     if (xsize == 0)
         return Success;
 
+    bool sparse = (jacobianType == SparseJacobian);
+
     int maxIterNumber = (isRedundantsolving?
         (sketchSizeMultiplierRedundant?maxIterRedundant * xsize:maxIterRedundant):
         (sketchSizeMultiplier?maxIter * xsize:maxIter));
@@ -1885,6 +2104,7 @@ int System::solve_DL(SubSystem* subsys, bool isRedundantsolving)
                 << ", tolf: "           << tolf
                 << ", convergence: "    << (isRedundantsolving?convergenceRedundant:convergence)
                 << ", dogLegGaussStep: " << (dogLegGaussStep==FullPivLU?"FullPivLU":(dogLegGaussStep==LeastNormFullPivLU?"LeastNormFullPivLU":"LeastNormLdlt"))
+                << ", jacobian: "       << (sparse?"Sparse":"Dense")
                 << ", xsize: "          << xsize
                 << ", csize: "          << csize
                 << ", maxIter: "        << maxIterNumber  << "\n";
@@ -1895,17 +2115,29 @@ int System::solve_DL(SubSystem* subsys, bool isRedundantsolving)
 
     Eigen::VectorXd x(xsize), x_new(xsize);
     Eigen::VectorXd fx(csize), fx_new(csize);
-    Eigen::MatrixXd Jx(csize, xsize), Jx_new(csize, xsize);
+    Eigen::MatrixXd Jx, Jx_new;
+    Eigen::SparseMatrix<double> SJx, SJx_new;
+    Eigen::SimplicialLDLT< Eigen::SparseMatrix<double> > ldlt;
     Eigen::VectorXd g(xsize), h_sd(xsize), h_gn(xsize), h_dl(xsize);
 
+    if (!sparse) {
+        Jx.resize(csize, xsize);
+        Jx_new.resize(csize, xsize);
+    }
+
     subsys->redirectParams();
 
     double err;
     subsys->getParams(x);
     subsys->calcResidual(fx, err);
-    subsys->calcJacobi(Jx);
-
-    g = Jx.transpose()*(-fx);
+    if (sparse) {
+        subsys->calcJacobi(SJx);
+        g = SJx.transpose()*(-fx);
+    }
+    else {
+        subsys->calcJacobi(Jx);
+        g = Jx.transpose()*(-fx);
+    }
 
     // get the infinity norm fx_inf and g_inf
     double g_inf = g.lpNorm<Eigen::Infinity>();
@@ -1933,25 +2165,52 @@ int System::solve_DL(SubSystem* subsys, bool isRedundantsolving)
         }
         else {
             // get the steepest descent direction
-            alpha = g.squaredNorm()/(Jx*g).squaredNorm();
+            alpha = g.squaredNorm()/(sparse?(SJx*g).squaredNorm():(Jx*g).squaredNorm());
             h_sd  = alpha*g;
 
             // get the gauss-newton step
             // http://forum.freecadweb.org/viewtopic.php?f=10&t=12769&start=50#p106220
             // https://forum.kde.org/viewtopic.php?f=74&t=129439#p346104
-            switch (dogLegGaussStep){
-                case FullPivLU:
-                    h_gn = Jx.fullPivLu().solve(-fx);
-                    break;
-                case LeastNormFullPivLU:
-                    h_gn = Jx.adjoint()*(Jx*Jx.adjoint()).fullPivLu().solve(-fx);
-                    break;
-                case LeastNormLdlt:
-                    h_gn = Jx.adjoint()*(Jx*Jx.adjoint()).ldlt().solve(-fx);
-                    break;
+            bool solved = false;
+            if (sparse) {
+                // Use the sparse counterpart of the selected step: a basic solution
+                // from a column pivoting QR, or the least norm solution through a
+                // factorization of J J^T. If that fails, e.g. because J J^T is
+                // singular due to redundant constraints, fall back to the dense
+                // decomposition below.
+                if (dogLegGaussStep == FullPivLU) {
+                    Eigen::SparseQR< Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int> > sqr;
+                    sqr.compute(SJx);
+                    if (sqr.info() == Eigen::Success) {
+                        h_gn = sqr.solve(-fx);
+                        solved = (sqr.info() == Eigen::Success) && h_gn.allFinite();
+                    }
+                }
+                else {
+                    ldlt.compute(SJx*SJx.transpose());
+                    if (ldlt.info() == Eigen::Success) {
+                        h_gn = SJx.transpose()*ldlt.solve(-fx);
+                        solved = h_gn.allFinite();
+                    }
+                }
+                if (!solved)
+                    Jx = Eigen::MatrixXd(SJx);
+            }
+            if (!solved) {
+                switch (dogLegGaussStep){
+                    case FullPivLU:
+                        h_gn = Jx.fullPivLu().solve(-fx);
+                        break;
+                    case LeastNormFullPivLU:
+                        h_gn = Jx.adjoint()*(Jx*Jx.adjoint()).fullPivLu().solve(-fx);
+                        break;
+                    case LeastNormLdlt:
+                        h_gn = Jx.adjoint()*(Jx*Jx.adjoint()).ldlt().solve(-fx);
+                        break;
+                }
             }
 
-            double rel_error = (Jx*h_gn + fx).norm() / fx.norm();
+            double rel_error = ((sparse?Eigen::VectorXd(SJx*h_gn):Eigen::VectorXd(Jx*h_gn)) + fx).norm() / fx.norm();
             if (rel_error > 1e15)
                 break;
 
@@ -1999,20 +2258,29 @@ int System::solve_DL(SubSystem* subsys, bool isRedundantsolving)
         x_new = x + h_dl;
         subsys->setParams(x_new);
         subsys->calcResidual(fx_new, err_new);
-        subsys->calcJacobi(Jx_new);
+        if (sparse)
+            subsys->calcJacobi(SJx_new);
+        else
+            subsys->calcJacobi(Jx_new);
 
         // calculate the linear model and the update ratio
-        double dL = err - 0.5*(fx + Jx*h_dl).squaredNorm();
+        double dL = err - 0.5*(fx + (sparse?Eigen::VectorXd(SJx*h_dl):Eigen::VectorXd(Jx*h_dl))).squaredNorm();
         double dF = err - err_new;
         double rho = dL/dF;
 
         if (dF > 0 && dL > 0) {
             x  = x_new;
-            Jx = Jx_new;
             fx = fx_new;
             err = err_new;
 
-            g = Jx.transpose()*(-fx);
+            if (sparse) {
+                SJx = SJx_new;
+                g = SJx.transpose()*(-fx);
+            }
+            else {
+                Jx = Jx_new;
+                g = Jx.transpose()*(-fx);
+            }
 
             // get infinity norms
             g_inf = g.lpNorm<Eigen::Infinity>();
@@ -3779,45 +4047,64 @@ void System::undoSolution()
     resetToReference();
 }
 
-void System::makeReducedJacobian(Eigen::MatrixXd &J,
-                                 std::map<int,int> &jacobianconstraintmap,
-                                 GCS::VEC_pD &pdiagnoselist,
-                                 std::map< int , int> &tagmultiplicity)
+void System::makeReducedJacobianTriplets(std::vector< Eigen::Triplet<double> > &triplets,
+                                         std::map<int,int> &jacobianconstraintmap,
+                                         const std::vector<Constraint *> &clistIn,
+                                         const GCS::VEC_pD &pdiagnoselist)
 {
-    // construct specific parameter list for diagonose ignoring driven constraint parameters
-    for (int j=0; j < int(plist.size()); j++) {
-        auto result1 = std::find(std::begin(pdrivenlist), std::end(pdrivenlist), plist[j]);
-
-        if (result1 == std::end(pdrivenlist)) {
-            pdiagnoselist.push_back(plist[j]);
-        }
-    }
-
-
-    J = Eigen::MatrixXd::Zero(clist.size(), pdiagnoselist.size());
+    MAP_pD_I pdiagnoseindex;
+    for (int j=0; j < int(pdiagnoselist.size()); j++)
+        pdiagnoseindex[pdiagnoselist[j]] = j;
 
     int jacobianconstraintcount=0;
     int allcount=0;
-    for (std::vector<Constraint *>::iterator constr=clist.begin(); constr != clist.end(); ++constr) {
+    for (std::vector<Constraint *>::const_iterator constr=clistIn.begin(); constr != clistIn.end(); ++constr) {
         (*constr)->revertParams();
         ++allcount;
         if ((*constr)->getTag() >= 0 && (*constr)->isDriving()) {
             jacobianconstraintcount++;
-            for (int j=0; j < int(pdiagnoselist.size()); j++) {
-                J(jacobianconstraintcount-1,j) = (*constr)->grad(pdiagnoselist[j]);
+            // only the parameters of the constraint can have a non-zero derivative
+            VEC_pD constr_params_orig = (*constr)->params();
+            SET_pD constr_params(constr_params_orig.begin(), constr_params_orig.end());
+            for (SET_pD::const_iterator p=constr_params.begin(); p != constr_params.end(); ++p) {
+                MAP_pD_I::const_iterator index = pdiagnoseindex.find(*p);
+                if (index == pdiagnoseindex.end())
+                    continue;
+                double value = (*constr)->grad(*p);
+                if (value != 0.)
+                    triplets.push_back(Eigen::Triplet<double>(jacobianconstraintcount-1, index->second, value));
             }
 
-            // parallel processing: create tag multiplicity map
-            if(tagmultiplicity.find((*constr)->getTag()) == tagmultiplicity.end())
-                tagmultiplicity[(*constr)->getTag()] = 0;
-            else
-                tagmultiplicity[(*constr)->getTag()]++;
-
             jacobianconstraintmap[jacobianconstraintcount-1] = allcount-1;
         }
     }
 }
 
+void System::makeReducedJacobian(Eigen::MatrixXd &J,
+                                 std::map<int,int> &jacobianconstraintmap,
+                                 const std::vector<Constraint *> &clistIn,
+                                 const GCS::VEC_pD &pdiagnoselist)
+{
+    std::vector< Eigen::Triplet<double> > triplets;
+    makeReducedJacobianTriplets(triplets, jacobianconstraintmap, clistIn, pdiagnoselist);
+
+    J = Eigen::MatrixXd::Zero(clistIn.size(), pdiagnoselist.size());
+    for (std::vector< Eigen::Triplet<double> >::const_iterator it=triplets.begin(); it != triplets.end(); ++it)
+        J(it->row(), it->col()) = it->value();
+}
+
+void System::makeSparseReducedJacobian(Eigen::SparseMatrix<double> &J,
+                                       std::map<int,int> &jacobianconstraintmap,
+                                       const std::vector<Constraint *> &clistIn,
+                                       const GCS::VEC_pD &pdiagnoselist)
+{
+    std::vector< Eigen::Triplet<double> > triplets;
+    makeReducedJacobianTriplets(triplets, jacobianconstraintmap, clistIn, pdiagnoselist);
+
+    J.resize(clistIn.size(), pdiagnoselist.size());
+    J.setFromTriplets(triplets.begin(), triplets.end());
+}
+
 int System::diagnose(Algorithm alg)
 {
     // Analyses the constrainess grad of the system and provides feedback
@@ -3857,6 +4144,171 @@ SolverReportingManager::Manager().LogToFile("GCS::System::diagnose()\n");
     conflictingTags.clear();
     redundantTags.clear();
 
+#ifndef EIGEN_SPARSEQR_COMPATIBLE
+    if(qrAlgorithm==EigenSparseQR){
+        Base::Console().Warning("SparseQR not supported by you current version of Eigen. It requires Eigen 3.2.2 or higher. Falling back to Dense QR\n");
+        qrAlgorithm=EigenDenseQR;
+    }
+#endif
+
+    // list of parameters to be diagnosed in this routine (removes value parameters from driven constraints)
+    GCS::VEC_pD pdiagnoselist;
+    MAP_pD_I pdiagnoseindex;
+    {
+        SET_pD pdrivenset(pdrivenlist.begin(), pdrivenlist.end());
+        for (int j=0; j < int(plist.size()); j++) {
+            if (pdrivenset.count(plist[j]) == 0) {
+                pdiagnoseindex[plist[j]] = int(pdiagnoselist.size());
+                pdiagnoselist.push_back(plist[j]);
+            }
+        }
+    }
+
+    if (clist.empty()) {
+        hasDiagnosis = true;
+        dofs = pdiagnoselist.size();
+        return dofs;
+    }
+
+    // tag multiplicity gives the number of solver constraints associated with the same tag
+    // A tag generally corresponds to the Sketcher constraint index - There are special tag values, like 0 and -1.
+    std::map< int , int> tagmultiplicity;
+    for (std::vector<Constraint *>::const_iterator constr=clist.begin(); constr != clist.end(); ++constr) {
+        if ((*constr)->getTag() >= 0 && (*constr)->isDriving()) {
+            if(tagmultiplicity.find((*constr)->getTag()) == tagmultiplicity.end())
+                tagmultiplicity[(*constr)->getTag()] = 0;
+            else
+                tagmultiplicity[(*constr)->getTag()]++;
+        }
+    }
+
+    // The Jacobian is block diagonal, with a block for each set of parameters
+    // coupled by constraints. The rank, the dependent parameters and the groups
+    // of conflicting constraints of a block do not depend on the other blocks,
+    // so the blocks are decomposed and checked for redundancy independently.
+    Graph g;
+    for (int i=0; i < int(pdiagnoselist.size() + clist.size()); i++)
+        boost::add_vertex(g);
+
+    int cvtid = int(pdiagnoselist.size());
+    for (std::vector<Constraint *>::const_iterator constr=clist.begin();
+         constr != clist.end(); ++constr, cvtid++) {
+        VEC_pD &cparams = c2p[*constr];
+        for (VEC_pD::const_iterator param=cparams.begin();
+             param != cparams.end(); ++param) {
+            MAP_pD_I::const_iterator it = pdiagnoseindex.find(*param);
+            if (it != pdiagnoseindex.end())
+                boost::add_edge(cvtid, it->second, g);
+        }
+    }
+
+    VEC_I componentIds(boost::num_vertices(g));
+    int componentsSize = boost::connected_components(g, &componentIds[0]);
+
+    std::vector<DiagnosisComponent> components(componentsSize);
+    for (int j=0; j < int(pdiagnoselist.size()); j++)
+        components[componentIds[j]].pdiagnoselist.push_back(pdiagnoselist[j]);
+    for (int i=0; i < int(clist.size()); i++)
+        components[componentIds[pdiagnoselist.size()+i]].clist.push_back(clist[i]);
+
+    int threads = getThreadCount(components.size(), pdiagnoselist.size());
+    parallelFor(componentsSize, threads, [&](int cid) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        diagnose(components[cid], alg, tagmultiplicity);
+        components[cid].time = elapsedTime(start);
+    });
+
+    int paramsNum = 0;
+    int constrNum = 0;
+    int rank = 0;
+    bool redundantSolving = false;
+    bool solutionApplied = false;
+    std::vector< std::vector<Constraint *> > conflictGroups;
+    for (int cid=0; cid < componentsSize; cid++) {
+        DiagnosisComponent &component = components[cid];
+        paramsNum += component.paramsNum;
+        constrNum += component.constrNum;
+        rank += component.rank;
+        pdependentparameters.insert(pdependentparameters.end(),
+            component.pdependentparameters.begin(), component.pdependentparameters.end());
+        conflictGroups.insert(conflictGroups.end(),
+            component.conflictGroups.begin(), component.conflictGroups.end());
+        redundant.insert(component.redundant.begin(), component.redundant.end());
+        redundantSolving = redundantSolving || component.redundantSolving;
+        solutionApplied = solutionApplied || component.solutionApplied;
+
+        if(debugMode==IterationLevel && !component.clist.empty()) {
+            std::stringstream stream;
+            stream << "Rank: " << component.rank;
+            SolverReportingManager::Manager().LogComponent("Diagnose component", cid, component.paramsNum,
+                component.constrNum, component.time, stream.str());
+        }
+    }
+
+    if (redundantSolving) {
+        if (solutionApplied)
+            resetToReference();
+
+        if(debugMode==Minimal || debugMode==IterationLevel) {
+            std::string solvername;
+            switch (alg) {
+                case 0:
+                    solvername = "BFGS";
+                    break;
+                case 1: // solving with the LevenbergMarquardt solver
+                    solvername = "LevenbergMarquardt";
+                    break;
+                case 2: // solving with the BFGS solver
+                    solvername = "DogLeg";
+                    break;
+            }
+
+            Base::Console().Log("Sketcher::RedundantSolving-%s-\n",solvername.c_str());
+            if (solutionApplied)
+                Base::Console().Log("Sketcher Redundant solving: %d redundants\n",redundant.size());
+        }
+
+        // simplified output of conflicting tags
+        SET_I conflictingTagsSet;
+        for (std::size_t i=0; i < conflictGroups.size(); i++) {
+            for (std::size_t j=0; j < conflictGroups[i].size(); j++) {
+                conflictingTagsSet.insert(conflictGroups[i][j]->getTag());
+            }
+        }
+        conflictingTagsSet.erase(0); // exclude constraints tagged with zero
+        conflictingTags.resize(conflictingTagsSet.size());
+        std::copy(conflictingTagsSet.begin(), conflictingTagsSet.end(),
+                  conflictingTags.begin());
+
+        // output of redundant tags
+        SET_I redundantTagsSet;
+        for (std::set<Constraint *>::iterator constr=redundant.begin();
+             constr != redundant.end(); ++constr)
+            redundantTagsSet.insert((*constr)->getTag());
+        // remove tags represented at least in one non-redundant constraint
+        for (std::vector<Constraint *>::iterator constr=clist.begin();
+            constr != clist.end(); ++constr) {
+            if (redundant.count(*constr) == 0)
+                redundantTagsSet.erase((*constr)->getTag());
+        }
+        redundantTags.resize(redundantTagsSet.size());
+        std::copy(redundantTagsSet.begin(), redundantTagsSet.end(),
+                  redundantTags.begin());
+
+        if (paramsNum == rank && constrNum > rank) { // over-constrained
+            hasDiagnosis = true;
+            dofs = paramsNum - constrNum;
+            return dofs;
+        }
+    }
+
+    hasDiagnosis = true;
+    dofs = paramsNum - rank;
+    return dofs;
+}
+
+void System::diagnose(DiagnosisComponent &component, Algorithm alg, const std::map< int , int> &tagmultiplicity)
+{
     // This QR diagnosis uses a reduced Jacobian matrix to calculate the rank of the system and identify
     // conflicting and redundant constraints.
     //
@@ -3871,39 +4323,39 @@ SolverReportingManager::Manager().LogToFile("GCS::System::diagnose()\n");
     std::map<int,int> jacobianconstraintmap;
 
     // list of parameters to be diagnosed in this routine (removes value parameters from driven constraints)
-    GCS::VEC_pD pdiagnoselist;
-
-    // tag multiplicity gives the number of solver constraints associated with the same tag
-    // A tag generally corresponds to the Sketcher constraint index - There are special tag values, like 0 and -1.
-    std::map< int , int> tagmultiplicity;
-
+    GCS::VEC_pD &pdiagnoselist = component.pdiagnoselist;
 
-    makeReducedJacobian(J, jacobianconstraintmap, pdiagnoselist, tagmultiplicity);
+    if (component.clist.empty()) { // unconstrained parameters
+        component.paramsNum = pdiagnoselist.size();
+        component.pdependentparameters = pdiagnoselist;
+        return;
+    }
 
     // QR decomposition method selection: SparseQR vs DenseQR
 
 #ifdef EIGEN_SPARSEQR_COMPATIBLE
     Eigen::SparseMatrix<double> SJ;
 
-    if(qrAlgorithm==EigenSparseQR){
-        // this creation is not optimized (done using triplets)
-        // however the time this takes is negligible compared to the
-        // time the QR decomposition itself takes
-        SJ = J.sparseView();
-        SJ.makeCompressed();
-    }
+    // The sparse Jacobian is assembled directly from the parameters of each
+    // constraint, without creating the dense matrix first.
+    if(qrAlgorithm==EigenSparseQR)
+        makeSparseReducedJacobian(SJ, jacobianconstraintmap, component.clist, pdiagnoselist);
+    else
+        makeReducedJacobian(J, jacobianconstraintmap, component.clist, pdiagnoselist);
 
     Eigen::SparseQR<Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int> > SqrJT;
 #else
-    if(qrAlgorithm==EigenSparseQR){
-        Base::Console().Warning("SparseQR not supported by you current version of Eigen. It requires Eigen 3.2.2 or higher. Falling back to Dense QR\n");
-        qrAlgorithm=EigenDenseQR;
-    }
+    makeReducedJacobian(J, jacobianconstraintmap, component.clist, pdiagnoselist);
 #endif
 
 
 
 #ifdef _GCS_DEBUG
+#ifdef EIGEN_SPARSEQR_COMPATIBLE
+    if(qrAlgorithm==EigenSparseQR)
+        SolverReportingManager::Manager().LogMatrix("J",Eigen::MatrixXd(SJ));
+    else
+#endif
     SolverReportingManager::Manager().LogMatrix("J",J);
 #endif
 
@@ -3918,11 +4370,13 @@ SolverReportingManager::Manager().LogToFile("GCS::System::diagnose()\n");
     int paramsNum = 0;
     int constrNum = 0;
     int rank = 0;
+    bool factorized = false;
     Eigen::FullPivHouseholderQR<Eigen::MatrixXd> qrJT;
 
     if(qrAlgorithm==EigenDenseQR){
-        if (J.rows() > 0) {
+        if (jacobianconstraintmap.size() > 0 && pdiagnoselist.size() > 0) {
             qrJT.compute(J.topRows(jacobianconstraintmap.size()).transpose());
+            factorized = true;
             //Eigen::MatrixXd Q = qrJT.matrixQ ();
 
             paramsNum = qrJT.rows();
@@ -3941,6 +4395,10 @@ SolverReportingManager::Manager().LogToFile("GCS::System::diagnose()\n");
             Q = qrJT.matrixQ();
 #endif
         }
+        else {
+            paramsNum = pdiagnoselist.size();
+            constrNum = jacobianconstraintmap.size();
+        }
     }
 #ifdef EIGEN_SPARSEQR_COMPATIBLE
     else if(qrAlgorithm==EigenSparseQR){
@@ -3948,6 +4406,7 @@ SolverReportingManager::Manager().LogToFile("GCS::System::diagnose()\n");
             auto SJT = SJ.topRows(jacobianconstraintmap.size()).transpose();
             if (SJT.rows() > 0 && SJT.cols() > 0) {
                 SqrJT.compute(SJT);
+                factorized = true;
                 // Do not ask for Q Matrix!!
                 // At Eigen 3.2 still has a bug that this only works for square matrices
                 // if enabled it will crash
@@ -3983,7 +4442,7 @@ SolverReportingManager::Manager().LogToFile("GCS::System::diagnose()\n");
         SolverReportingManager::Manager().LogQRSystemInformation(*this, paramsNum, constrNum, rank);
     }
 
-    if (J.rows() > 0) {
+    if (!component.clist.empty()) {
 #ifdef _GCS_DEBUG_SOLVER_JACOBIAN_QR_DECOMPOSITION_TRIANGULAR_MATRIX
         SolverReportingManager::Manager().LogMatrix("R", R);
 
@@ -4016,7 +4475,7 @@ SolverReportingManager::Manager().LogToFile("GCS::System::diagnose()\n");
 
         rowPermutations.setIdentity(paramsNum);
 
-        if(qrAlgorithm==EigenDenseQR){ // P.J.P' = Q.R see https://eigen.tuxfamily.org/dox/classEigen_1_1FullPivHouseholderQR.html
+        if(qrAlgorithm==EigenDenseQR && factorized){ // P.J.P' = Q.R see https://eigen.tuxfamily.org/dox/classEigen_1_1FullPivHouseholderQR.html
             const MatrixIndexType rowTranspositions = qrJT.rowsTranspositions();
 
             for(int k = 0; k < rank; ++k)
@@ -4106,7 +4565,7 @@ SolverReportingManager::Manager().LogToFile("GCS::System::diagnose()\n");
         SolverReportingManager::Manager().LogString(tmp);
 #endif
         for( auto param : depParamCols) {
-            pdependentparameters.push_back(pdiagnoselist[param]);
+            component.pdependentparameters.push_back(pdiagnoselist[param]);
         }
 
         // Detecting conflicting or redundant constraints
@@ -4122,7 +4581,8 @@ SolverReportingManager::Manager().LogToFile("GCS::System::diagnose()\n");
                     }
                 }
             }
-            std::vector< std::vector<Constraint *> > conflictGroups(constrNum-rank);
+            std::vector< std::vector<Constraint *> > &conflictGroups = component.conflictGroups;
+            conflictGroups.resize(constrNum-rank);
             for (int j=rank; j < constrNum; j++) {
                 for (int row=0; row < rank; row++) {
                     if (fabs(R(row,j)) > 1e-10) {
@@ -4135,20 +4595,20 @@ SolverReportingManager::Manager().LogToFile("GCS::System::diagnose()\n");
                             origCol=SqrJT.colsPermutation().indices()[row];
 #endif
                         //conflictGroups[j-rank].push_back(clist[origCol]);
-                        conflictGroups[j-rank].push_back(clist[jacobianconstraintmap.at(origCol)]);
+                        conflictGroups[j-rank].push_back(component.clist[jacobianconstraintmap.at(origCol)]);
                     }
                 }
-                int origCol = 0;
+                int origCol = j; // there is no factorization without parameters
 
-                if(qrAlgorithm==EigenDenseQR)
+                if(factorized && qrAlgorithm==EigenDenseQR)
                     origCol=qrJT.colsPermutation().indices()[j];
 
 #ifdef EIGEN_SPARSEQR_COMPATIBLE
-                else if(qrAlgorithm==EigenSparseQR)
+                else if(factorized && qrAlgorithm==EigenSparseQR)
                     origCol=SqrJT.colsPermutation().indices()[j];
 #endif
                 //conflictGroups[j-rank].push_back(clist[origCol]);
-                conflictGroups[j-rank].push_back(clist[jacobianconstraintmap.at(origCol)]);
+                conflictGroups[j-rank].push_back(component.clist[jacobianconstraintmap.at(origCol)]);
             }
 
             // Augment the information regarding the group of constraints that are conflicting or redundant.
@@ -4201,9 +4661,9 @@ SolverReportingManager::Manager().LogToFile("GCS::System::diagnose()\n");
             }
 
             std::vector<Constraint *> clistTmp;
-            clistTmp.reserve(clist.size());
-            for (std::vector<Constraint *>::iterator constr=clist.begin();
-                constr != clist.end(); ++constr) {
+            clistTmp.reserve(component.clist.size());
+            for (std::vector<Constraint *>::iterator constr=component.clist.begin();
+                constr != component.clist.end(); ++constr) {
                 if (skipped.count(*constr) == 0)
                     clistTmp.push_back(*constr);
             }
@@ -4211,35 +4671,16 @@ SolverReportingManager::Manager().LogToFile("GCS::System::diagnose()\n");
             SubSystem *subSysTmp = new SubSystem(clistTmp, pdiagnoselist);
             int res = solve(subSysTmp,true,alg,true);
 
-            if(debugMode==Minimal || debugMode==IterationLevel) {
-                std::string solvername;
-                switch (alg) {
-                    case 0:
-                        solvername = "BFGS";
-                        break;
-                    case 1: // solving with the LevenbergMarquardt solver
-                        solvername = "LevenbergMarquardt";
-                        break;
-                    case 2: // solving with the BFGS solver
-                        solvername = "DogLeg";
-                        break;
-                }
-
-                Base::Console().Log("Sketcher::RedundantSolving-%s-\n",solvername.c_str());
-            }
+            component.redundantSolving = true;
 
             if (res == Success) {
                 subSysTmp->applySolution();
+                component.solutionApplied = true;
                 for (std::set<Constraint *>::const_iterator constr=skipped.begin();
                      constr != skipped.end(); ++constr) {
                     double err = (*constr)->error();
                     if (err * err < convergenceRedundant)
-                        redundant.insert(*constr);
-                }
-                resetToReference();
-
-                if(debugMode==Minimal || debugMode==IterationLevel) {
-                    Base::Console().Log("Sketcher Redundant solving: %d redundants\n",redundant.size());
+                        component.redundant.insert(*constr);
                 }
 
                 std::vector< std::vector<Constraint *> > conflictGroupsOrig=conflictGroups;
@@ -4247,7 +4688,7 @@ SolverReportingManager::Manager().LogToFile("GCS::System::diagnose()\n");
                 for (int i=conflictGroupsOrig.size()-1; i >= 0; i--) {
                     bool isRedundant = false;
                     for (std::size_t j=0; j < conflictGroupsOrig[i].size(); j++) {
-                        if (redundant.count(conflictGroupsOrig[i][j]) > 0) {
+                        if (component.redundant.count(conflictGroupsOrig[i][j]) > 0) {
                             isRedundant = true;
                             break;
                         }
@@ -4259,49 +4700,12 @@ SolverReportingManager::Manager().LogToFile("GCS::System::diagnose()\n");
                 }
             }
             delete subSysTmp;
-
-            // simplified output of conflicting tags
-            SET_I conflictingTagsSet;
-            for (std::size_t i=0; i < conflictGroups.size(); i++) {
-                for (std::size_t j=0; j < conflictGroups[i].size(); j++) {
-                    conflictingTagsSet.insert(conflictGroups[i][j]->getTag());
-                }
-            }
-            conflictingTagsSet.erase(0); // exclude constraints tagged with zero
-            conflictingTags.resize(conflictingTagsSet.size());
-            std::copy(conflictingTagsSet.begin(), conflictingTagsSet.end(),
-                      conflictingTags.begin());
-
-            // output of redundant tags
-            SET_I redundantTagsSet;
-            for (std::set<Constraint *>::iterator constr=redundant.begin();
-                 constr != redundant.end(); ++constr)
-                redundantTagsSet.insert((*constr)->getTag());
-            // remove tags represented at least in one non-redundant constraint
-            for (std::vector<Constraint *>::iterator constr=clist.begin();
-                constr != clist.end(); ++constr) {
-                if (redundant.count(*constr) == 0)
-                    redundantTagsSet.erase((*constr)->getTag());
-            }
-            redundantTags.resize(redundantTagsSet.size());
-            std::copy(redundantTagsSet.begin(), redundantTagsSet.end(),
-                      redundantTags.begin());
-
-            if (paramsNum == rank && constrNum > rank) { // over-constrained
-                hasDiagnosis = true;
-                dofs = paramsNum - constrNum;
-                return dofs;
-            }
         }
-
-        hasDiagnosis = true;
-        dofs = paramsNum - rank;
-        return dofs;
     }
 
-    hasDiagnosis = true;
-    dofs = pdiagnoselist.size();
-    return dofs;
+    component.paramsNum = paramsNum;
+    component.constrNum = constrNum;
+    component.rank = rank;
 }
 
 void System::clearSubSystems()
@@ -4311,6 +4715,23 @@ void System::clearSubSystems()
     free(subSystemsAux);
     subSystems.clear();
     subSystemsAux.clear();
+    solutions.clear();
+}
+
+int System::getThreadCount(std::size_t components, std::size_t params) const
+{
+    // The console is not thread safe, so the iteration level output requires a
+    // single thread. Small systems are solved faster than threads are started.
+    if (components < 2 || params < ParallelMinParams || debugMode == IterationLevel)
+        return 1;
+
+#if defined(_GCS_DEBUG) || defined(_DEBUG_TO_FILE) || defined(_GCS_EXTRACT_SOLVER_SUBSYSTEM_)
+    return 1;
+#else
+    if (solverThreads > 0)
+        return solverThreads;
+    return std::max(1, int(std::thread::hardware_concurrency()));
+#endif
 }
 
 double lineSearch(SubSystem *subsys, Eigen::VectorXd &xdir)
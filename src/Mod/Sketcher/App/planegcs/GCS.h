@@ -63,6 +63,11 @@ namespace GCS
         EigenSparseQR = 1
     };
 
+    enum JacobianType {
+        DenseJacobian = 0,  // dense Jacobian and dense linear solvers in DogLeg and LM
+        SparseJacobian = 1  // sparse Jacobian and sparse factorizations in DogLeg and LM
+    };
+
     enum DebugMode {
         NoDebug = 0,
         Minimal = 1,
@@ -94,6 +99,40 @@ namespace GCS
         std::vector< VEC_pD > plists;                    // partitioned plist except equality constraints
         std::vector< std::vector<Constraint *> > clists; // partitioned clist except equality constraints
         std::vector< MAP_pD_pD > reductionmaps;          // for simplification of equality constraints
+        std::vector< VEC_pD > fixedplists;               // parameters of each component that are not unknowns, e.g. datum values
+
+        // Solution of a component of the last solve. The component is not solved
+        // again as long as its input parameters and the solving mode are the same.
+        struct ComponentSolution {
+            ComponentSolution() : valid(false), alg(DogLeg), isFine(true), isRedundantsolving(false), result(0) {}
+            bool valid;
+            Algorithm alg;
+            bool isFine;
+            bool isRedundantsolving;
+            VEC_D input;  // values of plists and fixedplists at the start of the solve
+            Eigen::VectorXd output, outputAux; // solved parameters of subSystems and subSystemsAux
+            int result;
+        };
+        std::vector<ComponentSolution> solutions;
+
+        // Decoupled part of the system that is diagnosed on its own, see diagnose()
+        struct DiagnosisComponent {
+            DiagnosisComponent() : paramsNum(0), constrNum(0), rank(0), redundantSolving(false), solutionApplied(false), time(0) {}
+            std::vector<Constraint *> clist;
+            VEC_pD pdiagnoselist;
+            int paramsNum;
+            int constrNum;
+            int rank;
+            VEC_pD pdependentparameters;
+            std::vector< std::vector<Constraint *> > conflictGroups;
+            std::set<Constraint *> redundant;
+            bool redundantSolving; // if the system had to be solved to detect redundant constraints
+            bool solutionApplied;  // if that solution was applied to the parameters
+            double time;
+        };
+        void diagnose(DiagnosisComponent &component, Algorithm alg, const std::map< int , int> &tagmultiplicity);
+
+        int getThreadCount(std::size_t components, std::size_t params) const;
 
         int dofs;
         std::set<Constraint *> redundant;
@@ -107,7 +146,9 @@ namespace GCS
         int solve_LM(SubSystem *subsys, bool isRedundantsolving=false);
         int solve_DL(SubSystem *subsys, bool isRedundantsolving=false);
 
-        void makeReducedJacobian(Eigen::MatrixXd &J, std::map<int,int> &jacobianconstraintmap, GCS::VEC_pD &pdiagnoselist, std::map< int , int> &tagmultiplicity);
+        void makeReducedJacobian(Eigen::MatrixXd &J, std::map<int,int> &jacobianconstraintmap, const std::vector<Constraint *> &clistIn, const GCS::VEC_pD &pdiagnoselist);
+        void makeSparseReducedJacobian(Eigen::SparseMatrix<double> &J, std::map<int,int> &jacobianconstraintmap, const std::vector<Constraint *> &clistIn, const GCS::VEC_pD &pdiagnoselist);
+        void makeReducedJacobianTriplets(std::vector< Eigen::Triplet<double> > &triplets, std::map<int,int> &jacobianconstraintmap, const std::vector<Constraint *> &clistIn, const GCS::VEC_pD &pdiagnoselist);
 
         #ifdef _GCS_EXTRACT_SOLVER_SUBSYSTEM_
         void extractSubsystem(SubSystem *subsys, bool isRedundantsolving);
@@ -121,6 +162,8 @@ namespace GCS
         double convergenceRedundant;
         QRAlgorithm qrAlgorithm;
         DogLegGaussStep dogLegGaussStep;
+        JacobianType jacobianType;
+        int solverThreads; // threads used for decoupled components, 0 means the number of hardware threads
         double qrpivotThreshold;
         DebugMode debugMode;
         double LM_eps;
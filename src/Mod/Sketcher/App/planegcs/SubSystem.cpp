@@ -107,8 +107,11 @@ void SubSystem::initialize(VEC_pD &params, MAP_pD_pD &reductionmap)
 
     c2p.clear();
     p2c.clear();
+    c2pindex.clear();
+    c2pindex.resize(csize);
+    int i=0;
     for (std::vector<Constraint *>::iterator constr=clist.begin();
-         constr != clist.end(); ++constr) {
+         constr != clist.end(); ++constr, ++i) {
         (*constr)->revertParams(); // ensure that the constraint points to the original parameters
         VEC_pD constr_params_orig = (*constr)->params();
         SET_pD constr_params;
@@ -123,6 +126,7 @@ void SubSystem::initialize(VEC_pD &params, MAP_pD_pD &reductionmap)
 //            jacobi.set(*constr, *p, 0.);
             c2p[*constr].push_back(*p);
             p2c[*p].push_back(*constr);
+            c2pindex[i].push_back(static_cast<int>(*p - &pvals[0]));
         }
 //        (*constr)->redirectParams(pmap); // redirect parameters to pvec
     }
@@ -275,6 +279,23 @@ void SubSystem::calcJacobi(Eigen::MatrixXd &jacobi)
     calcJacobi(plist, jacobi);
 }
 
+void SubSystem::calcJacobi(Eigen::SparseMatrix<double> &jacobi)
+{
+    // Only the parameters a constraint depends on can have a non-zero
+    // derivative, so there is no need to evaluate all (constraint, parameter)
+    // pairs as the dense version does.
+    std::vector< Eigen::Triplet<double> > triplets;
+    for (int i=0; i < csize; i++) {
+        for (VEC_I::const_iterator j=c2pindex[i].begin(); j != c2pindex[i].end(); ++j) {
+            double value = clist[i]->grad(&pvals[*j]);
+            if (value != 0.)
+                triplets.push_back(Eigen::Triplet<double>(i, *j, value));
+        }
+    }
+    jacobi.resize(csize, psize);
+    jacobi.setFromTriplets(triplets.begin(), triplets.end());
+}
+
 void SubSystem::calcGrad(VEC_pD &params, Eigen::VectorXd &grad)
 {
     assert(grad.size() == int(params.size()));
@@ -77,6 +77,7 @@ TaskSketcherSolverAdvanced::TaskSketcherSolverAdvanced(ViewProviderSketch *sketc
     ui->comboBoxDogLegGaussStep->onRestore();
     ui->spinBoxMaxIter->onRestore();
     ui->checkBoxSketchSizeMultiplier->onRestore();
+    ui->checkBoxSparseJacobian->onRestore();
     ui->lineEditConvergence->onRestore();
     ui->comboBoxQRMethod->onRestore();
     ui->lineEditQRPivotThreshold->onRestore();
@@ -426,6 +427,18 @@ void TaskSketcherSolverAdvanced::on_checkBoxSketchSizeMultiplier_stateChanged(in
     }
 }
 
+void TaskSketcherSolverAdvanced::on_checkBoxSparseJacobian_stateChanged(int state)
+{
+    if(state==Qt::Checked) {
+        ui->checkBoxSparseJacobian->onSave();
+        sketchView->getSketchObject()->getSolvedSketch().setJacobianType(GCS::SparseJacobian);
+    }
+    else if (state==Qt::Unchecked) {
+        ui->checkBoxSparseJacobian->onSave();
+        sketchView->getSketchObject()->getSolvedSketch().setJacobianType(GCS::DenseJacobian);
+    }
+}
+
 void TaskSketcherSolverAdvanced::on_lineEditQRPivotThreshold_editingFinished()
 {
     QString text = ui->lineEditQRPivotThreshold->text();
@@ -537,6 +550,7 @@ void TaskSketcherSolverAdvanced::on_pushButtonDefaults_clicked(bool checked/* =
     hGrp->SetInt("RedundantSolverMaxIterations",MAX_ITER);
     hGrp->SetBool("SketchSizeMultiplier",MAX_ITER_MULTIPLIER);
     hGrp->SetBool("RedundantSketchSizeMultiplier",MAX_ITER_MULTIPLIER);
+    hGrp->SetBool("SparseJacobian",false);
     hGrp->SetASCII("Convergence",QString::number(CONVERGENCE).toUtf8());
     hGrp->SetASCII("RedundantConvergence",QString::number(CONVERGENCE).toUtf8());
     hGrp->SetInt("QRMethod",DEFAULT_QRSOLVER);
@@ -547,6 +561,7 @@ void TaskSketcherSolverAdvanced::on_pushButtonDefaults_clicked(bool checked/* =
     ui->comboBoxDogLegGaussStep->onRestore();
     ui->spinBoxMaxIter->onRestore();
     ui->checkBoxSketchSizeMultiplier->onRestore();
+    ui->checkBoxSparseJacobian->onRestore();
     ui->lineEditConvergence->onRestore();
     ui->comboBoxQRMethod->onRestore();
     ui->lineEditQRPivotThreshold->onRestore();
@@ -570,6 +585,7 @@ void TaskSketcherSolverAdvanced::updateSketchObject(void)
     sketchView->getSketchObject()->getSolvedSketch().setConvergenceRedundant(ui->lineEditRedundantConvergence->text().toDouble());
     sketchView->getSketchObject()->getSolvedSketch().setConvergence(ui->lineEditConvergence->text().toDouble());
     sketchView->getSketchObject()->getSolvedSketch().setSketchSizeMultiplier(ui->checkBoxSketchSizeMultiplier->isChecked());
+    sketchView->getSketchObject()->getSolvedSketch().setJacobianType(ui->checkBoxSparseJacobian->isChecked()?GCS::SparseJacobian:GCS::DenseJacobian);
     sketchView->getSketchObject()->getSolvedSketch().setMaxIter(ui->spinBoxMaxIter->value());
     sketchView->getSketchObject()->getSolvedSketch().defaultSolver=(GCS::Algorithm) ui->comboBoxDefaultSolver->currentIndex();
     sketchView->getSketchObject()->getSolvedSketch().setDogLegGaussStep((GCS::DogLegGaussStep) ui->comboBoxDogLegGaussStep->currentIndex());
@@ -50,6 +50,7 @@ private Q_SLOTS:
     void on_comboBoxDogLegGaussStep_currentIndexChanged(int index);    
     void on_spinBoxMaxIter_valueChanged(int i);
     void on_checkBoxSketchSizeMultiplier_stateChanged(int state);    
+    void on_checkBoxSparseJacobian_stateChanged(int state);
     void on_lineEditConvergence_editingFinished();
     void on_comboBoxQRMethod_currentIndexChanged(int index);
     void on_lineEditQRPivotThreshold_editingFinished();
@@ -0,0 +1,81 @@
+#**************************************************************************
+#                                                                         *
+#   This file is part of the FreeCAD CAx development system.              *
+#                                                                         *
+#   This program is free software; you can redistribute it and/or modify  *
+#   it under the terms of the GNU Lesser General Public License (LGPL)    *
+#   as published by the Free Software Foundation; either version 2 of     *
+#   the License, or (at your option) any later version.                   *
+#   for detail see the LICENCE text file.                                 *
+#                                                                         *
+#   FreeCAD is distributed in the hope that it will be useful,            *
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+#   GNU Library General Public License for more details.                  *
+#                                                                         *
+#   You should have received a copy of the GNU Library General Public     *
+#   License along with FreeCAD; if not, write to the Free Software        *
+#   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+#   USA                                                                   *
+#**************************************************************************
+
+# Benchmark of the sketch solver versus the sketch size. It is not part of
+# the unit tests, run it explicitly with
+#   FreeCAD -t SketcherBenchmark
+# solve() sets up and diagnoses the system before solving it. With logging
+# enabled the solver reports both parts separately as
+# 'Sketcher::setUpSketch()-T' and 'Sketcher::Solve()-T'.
+
+import FreeCAD, time, unittest
+from TestSketcherApp import CreateRectangleSketch
+
+class SketcherSolverBenchmarkCases(unittest.TestCase):
+	# number of rectangles of the benchmark sketches, each one adds 8 parameters
+	Sizes = [25, 100, 400]
+
+	def setUp(self):
+		self.Doc = FreeCAD.newDocument("SketchSolverBenchmark")
+		self.Param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Sketcher/SolverAdvanced")
+		self.Sparse = self.Param.GetBool("SparseJacobian", False)
+		self.Threads = self.Param.GetInt("SolverThreads", 0)
+
+	def solve(self, count, sparse, threads=0):
+		# the solver reads the Jacobian type when the sketch is created
+		self.Param.SetBool("SparseJacobian", sparse)
+		self.Param.SetInt("SolverThreads", threads)
+		sketch = self.Doc.addObject('Sketcher::SketchObject','Sketch')
+		for i in range(count):
+			CreateRectangleSketch(sketch, (i*20, (i%10)*15), (10+i%3, 5+i%4))
+		start = time.time()
+		res = sketch.solve()
+		t1 = time.time() - start
+		# drag the top right corner of the last rectangle, which has two degrees
+		# of freedom once its width and height are released
+		sketch.delConstraint(sketch.ConstraintCount-1)
+		sketch.delConstraint(sketch.ConstraintCount-1)
+		start = time.time()
+		sketch.movePoint(sketch.GeometryCount-4, 2, FreeCAD.Vector(count*20+15, 30, 0))
+		t2 = time.time() - start
+		self.Doc.removeObject(sketch.Name)
+		self.assertEqual(res, 0)
+		return t1, t2
+
+	def testSparseJacobian(self):
+		for count in self.Sizes:
+			solve1, move1 = self.solve(count, False)
+			solve2, move2 = self.solve(count, True)
+			FreeCAD.Console.PrintMessage("Solve %d rectangles: dense %.3f s (drag %.3f s), "
+				"sparse %.3f s (drag %.3f s)\n" % (count, solve1, move1, solve2, move2))
+
+	def testSolverThreads(self):
+		# each rectangle is a decoupled component of the system
+		for count in self.Sizes:
+			solve1, move1 = self.solve(count, True, 1)
+			solve2, move2 = self.solve(count, True, 4)
+			FreeCAD.Console.PrintMessage("Solve %d rectangles: 1 thread %.3f s (drag %.3f s), "
+				"4 threads %.3f s (drag %.3f s)\n" % (count, solve1, move1, solve2, move2))
+
+	def tearDown(self):
+		self.Param.SetBool("SparseJacobian", self.Sparse)
+		self.Param.SetInt("SolverThreads", self.Threads)
+		FreeCAD.closeDocument("SketchSolverBenchmark")
@@ -214,3 +214,66 @@ class SketcherSolverTestCases(unittest.TestCase):
 		#closing doc
 		FreeCAD.closeDocument("SketchSolverTest")
 		#print ("omit closing document for debugging")
+
+class SketcherSolverLargeCases(unittest.TestCase):
+	# number of rectangles of the test sketches, each one adds 8 parameters
+	Sizes = [25, 100]
+
+	def setUp(self):
+		self.Doc = FreeCAD.newDocument("SketchSolverLarge")
+		self.Param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Sketcher/SolverAdvanced")
+		self.Sparse = self.Param.GetBool("SparseJacobian", False)
+		self.Threads = self.Param.GetInt("SolverThreads", 0)
+
+	def solve(self, count, sparse, threads=0):
+		# the solver reads the Jacobian type when the sketch is created
+		self.Param.SetBool("SparseJacobian", sparse)
+		self.Param.SetInt("SolverThreads", threads)
+		sketch = self.Doc.addObject('Sketcher::SketchObject','Sketch')
+		for i in range(count):
+			CreateRectangleSketch(sketch, (i*20, (i%10)*15), (10+i%3, 5+i%4))
+		res = sketch.solve()
+		# drag the top right corner of the last rectangle, which has two degrees
+		# of freedom once its width and height are released
+		sketch.delConstraint(sketch.ConstraintCount-1)
+		sketch.delConstraint(sketch.ConstraintCount-1)
+		sketch.movePoint(sketch.GeometryCount-4, 2, FreeCAD.Vector(count*20+15, 30, 0))
+		points = [sketch.getPoint(i, 1) for i in range(sketch.GeometryCount)]
+		self.Doc.removeObject(sketch.Name)
+		return res, points
+
+	def testSparseJacobian(self):
+		for count in self.Sizes:
+			res1, points1 = self.solve(count, False)
+			res2, points2 = self.solve(count, True)
+			self.assertEqual(res1, 0)
+			self.assertEqual(res2, 0)
+			for p1, p2 in zip(points1, points2):
+				self.assertAlmostEqual((p1-p2).Length, 0, 6)
+
+	def testSolverThreads(self):
+		# each rectangle is a decoupled component of the system
+		for count in self.Sizes:
+			res1, points1 = self.solve(count, True, 1)
+			res2, points2 = self.solve(count, True, 4)
+			self.assertEqual(res1, 0)
+			self.assertEqual(res2, 0)
+			for p1, p2 in zip(points1, points2):
+				self.assertAlmostEqual((p1-p2).Length, 0, 6)
+
+	def testComponentRedundancy(self):
+		# a redundant constraint must only be reported for its own component
+		sketch = self.Doc.addObject('Sketcher::SketchObject','Sketch')
+		for i in range(10):
+			CreateRectangleSketch(sketch, (i*20, 0), (10, 5))
+		count = sketch.ConstraintCount
+		sketch.addConstraint(Sketcher.Constraint('Horizontal', 0))
+		self.assertEqual(sketch.solve(), -2)
+		sketch.autoRemoveRedundants()
+		self.assertEqual(sketch.ConstraintCount, count)
+		self.assertEqual(sketch.solve(), 0)
+
+	def tearDown(self):
+		self.Param.SetBool("SparseJacobian", self.Sparse)
+		self.Param.SetInt("SolverThreads", self.Threads)
+		FreeCAD.closeDocument("SketchSolverLarge")
@@ -73,6 +73,8 @@ void PropertySheet::clear()
     cellToPropertyNameMap.clear();
     documentObjectToCellMap.clear();
     cellToDocumentObjectMap.clear();
+    cellDependents.clear();
+    cellPrecedents.clear();
     aliasProp.clear();
     revAliasProp.clear();
 
@@ -186,6 +188,19 @@ App::ExpressionPtr PropertySheet::eval(const App::Expression *expr) const {
     return expr->eval(option);
 }
 
+App::ExpressionProgram *PropertySheet::getProgram(CellAddress address) {
+    const Cell *cell = cellAt(address);
+    const App::Expression *expr = cell ? cell->getExpression() : 0;
+    if(!expr)
+        return 0;
+    auto &entry = programs[address];
+    if(entry.expression != expr) {
+        entry.expression = expr;
+        entry.program = App::ExpressionProgram::compile(expr);
+    }
+    return entry.program.get();
+}
+
 App::ExpressionPtr PropertySheet::parse(const char *txt, std::size_t len, bool verbose) const {
     bool pythonMode = false;
     if(owner)
@@ -216,6 +231,8 @@ PropertySheet::PropertySheet(const PropertySheet &other)
     , cellToPropertyNameMap(other.cellToPropertyNameMap)
     , documentObjectToCellMap(other.documentObjectToCellMap)
     , cellToDocumentObjectMap(other.cellToDocumentObjectMap)
+    , cellDependents(other.cellDependents)
+    , cellPrecedents(other.cellPrecedents)
     , aliasProp(other.aliasProp)
     , revAliasProp(other.revAliasProp)
     , updateCount(other.updateCount)
@@ -1010,9 +1027,11 @@ void PropertySheet::addDependencies(CellAddress key)
 
             // Also an alias?
             if (docObj==owner && props.first.size()) {
+                CellAddress addr;
                 std::map<std::string, CellAddress>::const_iterator j = revAliasProp.find(props.first);
 
                 if (j != revAliasProp.end()) {
+                    addr = j->second;
                     propName = docObjName + "." + j->second.toString();
                     FC_LOG("dep " << key.toString() << " -> " << propName);
 
@@ -1020,6 +1039,14 @@ void PropertySheet::addDependencies(CellAddress key)
                     propertyNameToCellMap[propName].insert(key);
                     cellToPropertyNameMap[key].insert(propName);
                 }
+                else
+                    addr = stringToAddress(props.first.c_str(), true);
+
+                // Insert into the cell dependency graph
+                if (addr.isValid()) {
+                    cellDependents[addr].insert(key);
+                    cellPrecedents[key].insert(addr);
+                }
             }
         }
     }
@@ -1078,6 +1105,25 @@ void PropertySheet::removeDependencies(CellAddress key)
         cellToDocumentObjectMap.erase(i2);
         ++updateCount;
     }
+
+    /* Remove from the cell dependency graph */
+
+    std::map<CellAddress, std::set< CellAddress > >::iterator i3 = cellPrecedents.find(key);
+
+    if (i3 != cellPrecedents.end()) {
+        for (std::set< CellAddress >::const_iterator j = i3->second.begin(); j != i3->second.end(); ++j) {
+            std::map<CellAddress, std::set< CellAddress > >::iterator k = cellDependents.find(*j);
+
+            if (k != cellDependents.end()) {
+                k->second.erase(key);
+
+                if (k->second.size() == 0)
+                    cellDependents.erase(k);
+            }
+        }
+
+        cellPrecedents.erase(i3);
+    }
 }
 
 /**
@@ -1244,6 +1290,28 @@ const std::set<std::string> &PropertySheet::getDeps(CellAddress pos) const
         return empty;
 }
 
+const std::set<CellAddress> &PropertySheet::getDependents(CellAddress pos) const
+{
+    static std::set<CellAddress> empty;
+    std::map<CellAddress, std::set< CellAddress > >::const_iterator i = cellDependents.find(pos);
+
+    if (i != cellDependents.end())
+        return i->second;
+    else
+        return empty;
+}
+
+const std::set<CellAddress> &PropertySheet::getPrecedents(CellAddress pos) const
+{
+    static std::set<CellAddress> empty;
+    std::map<CellAddress, std::set< CellAddress > >::const_iterator i = cellPrecedents.find(pos);
+
+    if (i != cellPrecedents.end())
+        return i->second;
+    else
+        return empty;
+}
+
 void PropertySheet::recomputeDependencies(CellAddress key)
 {
     AtomicPropertyChange signaller(*this);
@@ -1255,6 +1323,9 @@ void PropertySheet::recomputeDependencies(CellAddress key)
 
 void PropertySheet::hasSetValue()
 {
+    // Expressions may have been replaced or modified in place
+    programs.clear();
+
     if(!updateCount || 
        !owner || !owner->getNameInDocument() || owner->isRestoring() ||
        this!=&owner->cells ||
@@ -24,6 +24,7 @@
 #define PROPERTYSHEET_H
 
 #include <map>
+#include <memory>
 #include <App/DocumentObserver.h>
 #include <App/DocumentObject.h>
 #include <App/PropertyLinks.h>
@@ -157,6 +158,12 @@ public:
 
     const std::set<std::string> &getDeps(App::CellAddress pos) const;
 
+    /// Return the cells of this sheet that directly depend on the cell at \a pos
+    const std::set<App::CellAddress> &getDependents(App::CellAddress pos) const;
+
+    /// Return the cells of this sheet that the cell at \a pos directly depends on
+    const std::set<App::CellAddress> &getPrecedents(App::CellAddress pos) const;
+
     void recomputeDependencies(App::CellAddress key);
 
     PyObject *getPyObject(void);
@@ -206,6 +213,11 @@ private:
 
     bool rowSortFunc(const App::CellAddress &a, const App::CellAddress &b);
 
+    /*! Return the compiled expression of the cell, or null if it cannot be
+      compiled. The programs are dropped on any change of this property.
+      */
+    App::ExpressionProgram *getProgram(App::CellAddress address);
+
     /*! Set of cells that have been marked dirty */
     std::set<App::CellAddress> dirty;
 
@@ -245,6 +257,22 @@ private:
     /*! DocumentObject this cell depends on */
     std::map<App::CellAddress, std::set< std::string > > cellToDocumentObjectMap;
 
+    /*! Cell dependency graph inside this sheet, maintained together with the
+      maps above. Cell -> cells of this sheet that need to be recomputed when
+      it changes.
+      */
+    std::map<App::CellAddress, std::set< App::CellAddress > > cellDependents;
+
+    /*! Cells of this sheet this cell depends on */
+    std::map<App::CellAddress, std::set< App::CellAddress > > cellPrecedents;
+
+    /*! Compiled cell expressions, created on demand by getProgram() */
+    struct CellProgram {
+        const App::Expression *expression;
+        std::unique_ptr<App::ExpressionProgram> program;
+    };
+    std::map<App::CellAddress, CellProgram> programs;
+
     /*! Mapping of cell position to alias property */
     std::map<App::CellAddress, std::string> aliasProp;
 
@@ -30,7 +30,8 @@
 #include <boost/range/adaptor/map.hpp>
 #include <boost/range/algorithm/copy.hpp>
 #include <boost/assign.hpp>
-#include <boost/graph/topological_sort.hpp>
+#include <boost/graph/strong_components.hpp>
+#include <QtConcurrentMap>
 #include <App/Application.h>
 #include <App/Document.h>
 #include <App/DynamicProperty.h>
@@ -665,10 +666,12 @@ struct CurrentAddressLock {
   * Update the Property given by \a key. This will also eventually trigger recomputations of cells depending on \a key.
   *
   * @param key The address of the cell we want to recompute.
+  * @param value The value of the cell expression if it has been evaluated
+  * already by evaluateCells().
   *
   */
 
-void Sheet::updateProperty(CellAddress key)
+void Sheet::updateProperty(CellAddress key, const App::any *value)
 {
     Cell * cell = getCell(key);
 
@@ -678,7 +681,13 @@ void Sheet::updateProperty(CellAddress key)
 
         if (input) {
             CurrentAddressLock lock(currentRow,currentCol,key);
-            output = cells.eval(input);
+            if (value) {
+                // convert the value the same way as the tree walker does
+                Base::PyGILStateLocker pyLock;
+                output = expressionFromPy(this, pyObjectFromAny(*value));
+            }
+            else
+                output = cells.eval(input);
         }
         else {
             std::string s;
@@ -758,9 +767,10 @@ void Sheet::touchCells(Range range) {
 /**
  * @brief Recompute cell at address \a p.
  * @param p Address of cell.
+ * @param value Value of the cell expression evaluated by evaluateCells(), or null.
  */
 
-void Sheet::recomputeCell(CellAddress p)
+void Sheet::recomputeCell(CellAddress p, const App::any *value)
 {
     Cell * cell = cells.getValue(p);
 
@@ -769,9 +779,10 @@ void Sheet::recomputeCell(CellAddress p)
             std::string content;
             cell->getStringContent(content);
             cell->setContent(content.c_str());
+            value = 0;
         }
 
-        updateProperty(p);
+        updateProperty(p, value);
 
         if(!cell || !cell->hasException()) {
             cells.clearDirty(p);
@@ -801,6 +812,53 @@ void Sheet::recomputeCell(CellAddress p)
         cellSpanChanged(p);
 }
 
+/**
+ * @brief Evaluate the cells at \a addresses concurrently.
+ *
+ * The cells must not depend on each other. Only the cells whose compiled
+ * expression can be evaluated without Python are handled. Their values are
+ * returned in \a values, and are assigned by recomputeCell() afterwards.
+ */
+
+void Sheet::evaluateCells(const std::vector<CellAddress> &addresses,
+                          std::map<CellAddress, App::any> &values)
+{
+    struct Job {
+        CellAddress address;
+        ExpressionProgram *program;
+        App::any value;
+        bool done;
+    };
+    std::vector<Job> jobs;
+    for(auto &addr : addresses) {
+        Cell * cell = cells.getValue(addr);
+        if(!cell || cell->hasException())
+            continue;
+        ExpressionProgram *program = cells.getProgram(addr);
+        if(program && program->prepareConcurrent())
+            jobs.push_back(Job{addr, program, App::any(), false});
+    }
+
+    // not worth the threads for a few cells
+    if(jobs.size() < 16)
+        return;
+
+    QtConcurrent::blockingMap(jobs, [](Job &job) {
+        try {
+            job.done = job.program->evaluateConcurrent(job.value);
+        }
+        catch (...) {
+            // leave it to the tree walker
+            job.done = false;
+        }
+    });
+
+    for(auto &job : jobs) {
+        if(job.done)
+            values[job.address] = job.value;
+    }
+}
+
 /**
   * Update the document properties.
   *
@@ -820,116 +878,111 @@ DocumentObjectExecReturn *Sheet::execute(void)
          dirtyCells.insert(*i);
     }
 
-    DependencyList graph;
-    std::map<CellAddress, Vertex> VertexList;
-    std::map<Vertex, CellAddress> VertexIndexList;
+    // Collect the cells depending on the dirty cells from the dependency graph
+    // maintained by PropertySheet, and count their precedents to be recomputed.
+    std::map<CellAddress, int> inDegree;
+    for(auto &addr : dirtyCells)
+        inDegree.emplace(addr, 0);
     std::deque<CellAddress> workQueue(dirtyCells.begin(),dirtyCells.end());
     while(workQueue.size()) {
         CellAddress currPos = workQueue.front();
         workQueue.pop_front();
 
-        // Insert into map of CellPos -> Index, if it doesn't exist already
-        auto res = VertexList.emplace(currPos,Vertex());
-        if(res.second) {
-            res.first->second = add_vertex(graph);
-            VertexIndexList[res.first->second] = currPos;
+        // Process cells that depend on the current cell
+        for(auto &dep : cells.getDependents(currPos)) {
+            auto res = inDegree.emplace(dep, 0);
+            ++res.first->second;
+            if(res.second)
+                workQueue.push_back(dep);
         }
+    }
 
-        // Process cells that depend on the current cell
-        for(auto &dep : providesTo(currPos)) {
-            auto resDep = VertexList.emplace(dep,Vertex());
-            if(resDep.second) {
-                resDep.first->second = add_vertex(graph);
-                VertexIndexList[resDep.first->second] = dep;
-                if(dirtyCells.insert(dep).second)
-                    workQueue.push_back(dep);
+    // Recompute cells wavefront by wavefront. Cells of the same wavefront do
+    // not depend on each other, so their compiled expressions are evaluated
+    // concurrently first. The values are assigned in this thread.
+    bool concurrent = !PythonMode.getValue() && GetApplication().GetParameterGroupByPath(
+            "User parameter:BaseApp/Preferences/Expression")->GetBool("CompileExpression",false);
+    std::vector<CellAddress> wavefront;
+    for(auto &v : inDegree) {
+        if(v.second == 0)
+            wavefront.push_back(v.first);
+    }
+    FC_LOG("recomputing " << getFullName());
+    std::size_t recomputed = 0;
+    while(wavefront.size()) {
+        std::map<CellAddress, App::any> values;
+        if(concurrent)
+            evaluateCells(wavefront, values);
+        std::vector<CellAddress> next;
+        for(auto &addr : wavefront) {
+            FC_LOG(addr.toString());
+            auto it = values.find(addr);
+            recomputeCell(addr, it == values.end() ? 0 : &it->second);
+            ++recomputed;
+            for(auto &dep : cells.getDependents(addr)) {
+                auto it = inDegree.find(dep);
+                if(it != inDegree.end() && --it->second == 0)
+                    next.push_back(dep);
             }
-            // Add edge to graph to signal dependency
-            add_edge(res.first->second, resDep.first->second, graph);
         }
+        wavefront.swap(next);
     }
-    // Compute cells
-    std::list<Vertex> make_order;
-    // Sort graph topologically to find evaluation order
-    try {
-        boost::topological_sort(graph, std::front_inserter(make_order));
-        // Recompute cells
-        FC_LOG("recomputing " << getFullName());
-        for(auto &pos : make_order) {
-            const auto &addr = VertexIndexList[pos];
-            FC_LOG(addr.toString());
-            recomputeCell(addr);
+
+    // Cells left with pending precedents are either part of a cycle or depend
+    // on one. Find the strongly connected components among them to report the
+    // cycles only.
+    if(recomputed < inDegree.size()) {
+        DependencyList graph;
+        std::map<CellAddress, Vertex> VertexList;
+        std::vector<CellAddress> VertexIndexList;
+        for(auto &v : inDegree) {
+            if(v.second > 0) {
+                VertexList[v.first] = add_vertex(graph);
+                VertexIndexList.push_back(v.first);
+            }
         }
-    } catch (std::exception &) {
         for(auto &v : VertexList) {
-            Cell * cell = cells.getValue(v.first);
-            // Mark as erroneous
-            if(cell)  {
-                cellErrors.insert(v.first);
-                cell->setException("Pending computation due to cyclic dependency",true);
-                cellUpdated(v.first);
+            for(auto &dep : cells.getDependents(v.first)) {
+                auto it = VertexList.find(dep);
+                if(it != VertexList.end())
+                    add_edge(v.second, it->second, graph);
             }
         }
 
-        // Try to be more user friendly by finding individual loops
-        while(dirtyCells.size()) {
-
-            std::deque<CellAddress> workQueue;
-            DependencyList graph;
-            std::map<CellAddress, Vertex> VertexList;
-            std::map<Vertex, CellAddress> VertexIndexList;
-
-            CellAddress currentAddr = *dirtyCells.begin();
-            workQueue.push_back(currentAddr);
-            dirtyCells.erase(dirtyCells.begin());
-
-            while (workQueue.size() > 0) {
-                CellAddress currPos = workQueue.front();
-                workQueue.pop_front();
-
-                // Insert into map of CellPos -> Index, if it doesn't exist already
-                auto res = VertexList.emplace(currPos,Vertex());
-                if(res.second) {
-                    res.first->second = add_vertex(graph);
-                    VertexIndexList[res.first->second] = currPos;
-                }
-
-                // Process cells that depend on the current cell
-                for(auto &dep : providesTo(currPos)) {
-                    auto resDep = VertexList.emplace(dep,Vertex());
-                    if(resDep.second) {
-                        resDep.first->second = add_vertex(graph);
-                        VertexIndexList[resDep.first->second] = dep;
-                        workQueue.push_back(dep);
-                        dirtyCells.erase(dep);
-                    }
-                    // Add edge to graph to signal dependency
-                    add_edge(res.first->second, resDep.first->second, graph);
-                }
-            }
-
-            std::list<Vertex> make_order;
-            try {
-                boost::topological_sort(graph, std::front_inserter(make_order));
-            } catch (std::exception&) {
-                // Cycle detected; flag all with errors
+        std::vector<int> component(num_vertices(graph));
+        int numComponents = boost::strong_components(graph,
+                boost::make_iterator_property_map(component.begin(), get(boost::vertex_index, graph)));
+        std::vector<std::vector<Vertex> > components(numComponents);
+        for(std::size_t i=0; i<component.size(); ++i)
+            components[component[i]].push_back(i);
+
+        for(auto &vertices : components) {
+            bool cyclic = vertices.size() > 1
+                || boost::edge(vertices.front(), vertices.front(), graph).second;
+            std::string msg;
+            if(!cyclic)
+                msg = "Pending computation due to cyclic dependency";
+            else {
                 std::ostringstream ss;
                 ss << "Cyclic dependency";
                 int count = 0;
-                for(auto &v : VertexList) {
+                for(auto v : vertices) {
                     if(count++%20 == 0)
                         ss << std::endl;
                     else
                         ss << ", ";
-                    ss << v.first.toString();
+                    ss << VertexIndexList[v].toString();
                 }
-                std::string msg = ss.str();
-                for(auto &v : VertexList) {
-                    Cell * cell = cells.getValue(v.first);
-                    if (cell) {
-                        cell->setException(msg.c_str(),true);
-                        cellUpdated(v.first);
-                    }
+                msg = ss.str();
+            }
+            for(auto v : vertices) {
+                const CellAddress &addr = VertexIndexList[v];
+                Cell * cell = cells.getValue(addr);
+                // Mark as erroneous
+                if(cell) {
+                    cellErrors.insert(addr);
+                    cell->setException(msg.c_str(),true);
+                    cellUpdated(addr);
                 }
             }
         }
@@ -1389,7 +1442,7 @@ void Sheet::providesTo(CellAddress address, std::set<std::string> & result) cons
 
 std::set<CellAddress>  Sheet::providesTo(CellAddress address) const
 {
-    return cells.getDeps(getFullName()+"."+address.toString());
+    return cells.getDependents(address);
 }
 
 void Sheet::onDocumentRestored()
@@ -205,7 +205,10 @@ protected:
 
     void onDocumentRestored();
 
-    void recomputeCell(App::CellAddress p);
+    void recomputeCell(App::CellAddress p, const App::any *value = 0);
+
+    void evaluateCells(const std::vector<App::CellAddress> &addresses,
+                       std::map<App::CellAddress, App::any> &values);
 
     App::Property *getProperty(App::CellAddress key) const;
 
@@ -213,7 +216,7 @@ protected:
 
     void updateAlias(App::CellAddress key);
 
-    void updateProperty(App::CellAddress key);
+    void updateProperty(App::CellAddress key, const App::any *value = 0);
 
     App::Property *setStringProperty(App::CellAddress key, const std::string & value) ;
 
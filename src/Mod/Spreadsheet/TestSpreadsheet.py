@@ -1006,6 +1006,79 @@ class SpreadsheetCases(unittest.TestCase):
         self.doc.recompute()
         self.assertEqual(sheet.get('C1'), Units.Quantity('3 mm'))
 
+    def testCyclicDependency(self):
+        """ Cells not involved in a cycle are still recomputed """
+        sheet = self.doc.addObject('Spreadsheet::Sheet','Spreadsheet')
+        sheet.set('A1', '=B1')
+        sheet.set('B1', '=A1')
+        sheet.set('C1', '=A1 + 1')
+        sheet.set('D1', '5')
+        sheet.set('E1', '=D1 * 2')
+        self.doc.recompute()
+        self.assertEqual(sheet.get('E1'), 10)
+        for cell in ('A1', 'B1', 'C1'):
+            with self.assertRaises(ValueError):
+                sheet.get(cell)
+
+        # breaking the cycle recomputes the cells that depend on it
+        sheet.set('B1', '1')
+        self.doc.recompute()
+        self.assertEqual(sheet.get('A1'), 1)
+        self.assertEqual(sheet.get('C1'), 2)
+
+    def testWavefrontRecompute(self):
+        """ A chain of dependent cells is recomputed in order """
+        sheet = self.doc.addObject('Spreadsheet::Sheet','Spreadsheet')
+        sheet.set('A1', '1')
+        for i in range(2, 101):
+            sheet.set('A%d' % i, '=A%d + B%d' % (i - 1, i))
+            sheet.set('B%d' % i, '=A1')
+        self.doc.recompute()
+        self.assertEqual(sheet.get('A100'), 100)
+        sheet.set('A1', '2')
+        self.doc.recompute()
+        self.assertEqual(sheet.get('A100'), 200)
+
+    def testConcurrentRecompute(self):
+        """ Cells evaluated concurrently get the same values as evaluated serially """
+        def run(compile):
+            hGrp.SetBool('CompileExpression', compile)
+            sheet = self.doc.addObject('Spreadsheet::Sheet','Spreadsheet')
+            for i in range(1, 41):
+                sheet.set('A%d' % i, str(i))
+                sheet.set('B%d' % i, '=A%d * 2.5' % i)
+                sheet.set('C%d' % i, '=A%d * 1mm + 1cm' % i)
+                sheet.set('D%d' % i, '=A%d > 20' % i)
+                sheet.set('E%d' % i, '=sqrt(A%d) + floor(B%d)' % (i, i))
+                sheet.set('F%d' % i, '=1 / (A%d - 10)' % i)
+                sheet.set('G%d' % i, '=A%d // 3 + A%d %% 4' % (i, i))
+                sheet.set('H%d' % i, '=B%d + C%d / 1mm' % (i, i))
+                sheet.set('I%d' % i, '=<<row>>')
+            results = []
+            for step in range(2):
+                if step:
+                    for i in range(1, 41):
+                        sheet.set('A%d' % i, str(i + 1))
+                self.doc.recompute()
+                for i in range(1, 41):
+                    for col in 'BCDEFGHI':
+                        try:
+                            value = sheet.get('%s%d' % (col, i))
+                            results.append((type(value), value))
+                        except ValueError:
+                            results.append('error')
+            return results
+
+        hGrp = FreeCAD.ParamGet('User parameter:BaseApp/Preferences/Expression')
+        compile = hGrp.GetBool('CompileExpression', False)
+        try:
+            serial = run(False)
+            concurrent = run(True)
+        finally:
+            hGrp.SetBool('CompileExpression', compile)
+        self.assertIn('error', serial)
+        self.assertEqual(serial, concurrent)
+
 
     def tearDown(self):
         #closing doc
@@ -25,6 +25,10 @@
 
 #ifndef _PreComp_
 # include <sstream>
+# include <unordered_map>
+# include <boost/geometry.hpp>
+# include <boost/geometry/index/rtree.hpp>
+# include <boost/geometry/geometries/geometries.hpp>
 
 #include <BRep_Tool.hxx>
 #include <BRepGProp.hxx>
@@ -88,6 +92,33 @@
 using namespace TechDraw;
 using namespace std;
 
+namespace bg = boost::geometry;
+namespace bgi = boost::geometry::index;
+
+namespace {
+typedef bg::model::point<double,3,bg::cs::cartesian> RPoint;
+typedef bg::model::box<RPoint> RBox;
+typedef std::pair<RBox,int> RValue;
+typedef bgi::rtree<RValue,bgi::linear<16> > RTree;
+
+//cell of the grid used to find duplicate edges by their start point
+struct GridKey {
+    long long x, y, z;
+    bool operator==(const GridKey& other) const {
+        return x == other.x && y == other.y && z == other.z;
+    }
+};
+
+struct GridKeyHash {
+    std::size_t operator()(const GridKey& k) const {
+        std::size_t h = std::hash<long long>()(k.x);
+        h ^= std::hash<long long>()(k.y) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        h ^= std::hash<long long>()(k.z) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        return h;
+    }
+};
+}
+
 
 //===========================================================================
 // DrawProjectSplit
@@ -165,81 +196,99 @@ std::vector<TopoDS_Edge> DrawProjectSplit::getEdges(TechDrawGeometry::GeometryOb
         }
     }
     faceEdges = nonZero;
-    origEdges = nonZero;
 
     //HLR algo does not provide all edge intersections for edge endpoints.
     //need to split long edges touched by Vertex of another edge
-    std::vector<splitPoint> splits;
-    std::vector<TopoDS_Edge>::iterator itOuter = origEdges.begin();
-    int iOuter = 0;
-    for (; itOuter != origEdges.end(); ++itOuter, iOuter++) {
-        TopoDS_Vertex v1 = TopExp::FirstVertex((*itOuter));
-        TopoDS_Vertex v2 = TopExp::LastVertex((*itOuter));
-        Bnd_Box sOuter;
-        BRepBndLib::Add(*itOuter, sOuter);
-        sOuter.SetGap(0.1);
-        if (sOuter.IsVoid()) {
-            Base::Console().Message("DPS::Extract Faces - outer Bnd_Box is void\n");
-            continue;
-        }
-        if (DrawUtil::isZeroEdge(*itOuter)) {
-            Base::Console().Message("DPS::extractFaces - outerEdge: %d is ZeroEdge\n",iOuter);   //this is not finding ZeroEdges
-            continue;  //skip zero length edges. shouldn't happen ;)
-        }
-        int iInner = 0;
-        std::vector<TopoDS_Edge>::iterator itInner = faceEdges.begin();
-        for (; itInner != faceEdges.end(); ++itInner,iInner++) {
-            if (iInner == iOuter) {
-                continue;
-            }
-            if (DrawUtil::isZeroEdge((*itInner))) {
-                continue;  //skip zero length edges. shouldn't happen ;)
-            }
+    std::vector<splitPoint> splits = findSplits(faceEdges);
+
+    std::vector<splitPoint> sorted = sortSplits(splits,true);
+    auto last = std::unique(sorted.begin(), sorted.end(), DrawProjectSplit::splitEqual);  //duplicates to back
+    sorted.erase(last, sorted.end());                         //remove dupls
+    std::vector<TopoDS_Edge> newEdges = splitEdges(faceEdges,sorted);
 
-            Bnd_Box sInner;
-            BRepBndLib::Add(*itInner, sInner);
-            sInner.SetGap(0.1);
-            if (sInner.IsVoid()) {
-                Base::Console().Log("INFO - DPS::Extract Faces - inner Bnd_Box is void\n");
-                continue;
+    if (newEdges.empty()) {
+        Base::Console().Log("LOG - DPS::extractFaces - no newEdges\n");
+    }
+    newEdges = removeDuplicateEdges(newEdges);
+    return newEdges;
+}
+
+
+//find the places where a Vertex of one edge touches the interior of another edge.
+//the edge bound boxes are kept in an rtree, so only edges whose box contains the
+//Vertex are checked with isOnEdge.
+std::vector<splitPoint> DrawProjectSplit::findSplits(const std::vector<TopoDS_Edge>& edges)
+{
+    std::vector<splitPoint> splits;
+    std::vector<Bnd_Box> boxes(edges.size());
+    std::vector<RValue> values;
+    values.reserve(edges.size());
+    int iEdge = 0;
+    for (auto& e: edges) {
+        Bnd_Box& box = boxes[iEdge];
+        if (DrawUtil::isZeroEdge(e)) {
+            Base::Console().Message("DPS::findSplits - edge: %d is ZeroEdge\n",iEdge);
+        } else {
+            BRepBndLib::Add(e, box);
+            box.SetGap(0.1);
+            if (box.IsVoid()) {
+                Base::Console().Log("INFO - DPS::findSplits - Bnd_Box is void for edge: %d\n",iEdge);
+            } else {
+                double xMin, yMin, zMin, xMax, yMax, zMax;
+                box.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+                values.emplace_back(RBox(RPoint(xMin,yMin,zMin),RPoint(xMax,yMax,zMax)),iEdge);
             }
-            if (sOuter.IsOut(sInner)) {      //bboxes of edges don't intersect, don't bother
-                continue;
+        }
+        iEdge++;
+    }
+    RTree rtree(values.begin(), values.end());        //bulk loading
+
+    std::vector<RValue> found;
+    std::vector<int> candidates;
+    for (auto& outer: values) {
+        int iOuter = outer.second;
+        TopoDS_Vertex v1 = TopExp::FirstVertex(edges[iOuter]);
+        TopoDS_Vertex v2 = TopExp::LastVertex(edges[iOuter]);
+        gp_Pnt pnt1 = BRep_Tool::Pnt(v1);
+        gp_Pnt pnt2 = BRep_Tool::Pnt(v2);
+
+        //isOnEdge is false for any edge whose box does not contain the Vertex
+        found.clear();
+        rtree.query(bgi::intersects(RPoint(pnt1.X(),pnt1.Y(),pnt1.Z())), std::back_inserter(found));
+        rtree.query(bgi::intersects(RPoint(pnt2.X(),pnt2.Y(),pnt2.Z())), std::back_inserter(found));
+        candidates.clear();
+        for (auto& f: found) {
+            if (f.second != iOuter) {
+                candidates.push_back(f.second);
             }
+        }
+        std::sort(candidates.begin(), candidates.end());    //keep the order of the edges
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
 
+        for (auto iInner: candidates) {
+            const TopoDS_Edge& inner = edges[iInner];
             double param = -1;
-            if (isOnEdge((*itInner),v1,param,false)) {
-                gp_Pnt pnt1 = BRep_Tool::Pnt(v1);
+            if (!boxes[iInner].IsOut(pnt1) &&
+                isOnEdge(inner,v1,param,false)) {
                 splitPoint s1;
                 s1.i = iInner;
                 s1.v = Base::Vector3d(pnt1.X(),pnt1.Y(),pnt1.Z());
                 s1.param = param;
                 splits.push_back(s1);
             }
-            if (isOnEdge((*itInner),v2,param,false)) {
-                gp_Pnt pnt2 = BRep_Tool::Pnt(v2);
+            if (!boxes[iInner].IsOut(pnt2) &&
+                isOnEdge(inner,v2,param,false)) {
                 splitPoint s2;
                 s2.i = iInner;
                 s2.v = Base::Vector3d(pnt2.X(),pnt2.Y(),pnt2.Z());
                 s2.param = param;
                 splits.push_back(s2);
             }
-        } //inner loop
-    }   //outer loop
-
-    std::vector<splitPoint> sorted = sortSplits(splits,true);
-    auto last = std::unique(sorted.begin(), sorted.end(), DrawProjectSplit::splitEqual);  //duplicates to back
-    sorted.erase(last, sorted.end());                         //remove dupls
-    std::vector<TopoDS_Edge> newEdges = splitEdges(faceEdges,sorted);
-
-    if (newEdges.empty()) {
-        Base::Console().Log("LOG - DPS::extractFaces - no newEdges\n");
+        }
     }
-    newEdges = removeDuplicateEdges(newEdges);
-    return newEdges;
+    return splits;
 }
 
-
 //this routine is the big time consumer.  gets called many times (and is slow?))
 //note param gets modified here
 bool DrawProjectSplit::isOnEdge(TopoDS_Edge e, TopoDS_Vertex v, double& param, bool allowEnds)
@@ -412,10 +461,15 @@ std::vector<splitPoint> DrawProjectSplit::sortSplits(std::vector<splitPoint>& s,
     return result;
 }
 
+//edges are hashed by the grid cell of their start point. the cells are larger than
+//the tolerance, so duplicates are always in the same or in a neighbouring cell.
+//the first of the duplicate edges is kept, in the original order.
 std::vector<TopoDS_Edge> DrawProjectSplit::removeDuplicateEdges(std::vector<TopoDS_Edge>& inEdges)
 {
     std::vector<TopoDS_Edge> result;
-    std::vector<edgeSortItem> temp;
+    const double cellSize = 1000.0 * Precision::Confusion();
+    std::unordered_map<GridKey, std::vector<edgeSortItem>, GridKeyHash> grid;
+    grid.reserve(inEdges.size());
 
     unsigned int idx = 0;
     for (auto& e: inEdges) {
@@ -436,20 +490,31 @@ std::vector<TopoDS_Edge> DrawProjectSplit::removeDuplicateEdges(std::vector<Topo
              item.endAngle = aTemp;
         }
         item.idx = idx;
-        temp.push_back(item);
         idx++;
-    }
-
-    std::vector<edgeSortItem> sorted = sortEdges(temp,true);
-    auto last = std::unique(sorted.begin(), sorted.end(), edgeSortItem::edgeEqual);  //duplicates to back
-    sorted.erase(last, sorted.end());                         //remove dupls
 
-    //TODO: "sorted" turns to garbage if pagescale set to "0.1"!!!!???? ***
-    for (auto e: sorted) {
-        if (e.idx < inEdges.size()) {
-            result.push_back(inEdges.at(e.idx));                  //<<< ***here
-        } else {
-            Base::Console().Message("ERROR - DPS::removeDuplicateEdges - access: %d inEdges: %d\n",e.idx,inEdges.size());
+        GridKey key = { (long long) std::floor(item.start.x / cellSize),
+                        (long long) std::floor(item.start.y / cellSize),
+                        (long long) std::floor(item.start.z / cellSize) };
+        bool duplicate = false;
+        for (long long dx = -1; dx <= 1 && !duplicate; dx++) {
+            for (long long dy = -1; dy <= 1 && !duplicate; dy++) {
+                for (long long dz = -1; dz <= 1 && !duplicate; dz++) {
+                    auto it = grid.find(GridKey{ key.x + dx, key.y + dy, key.z + dz });
+                    if (it == grid.end()) {
+                        continue;
+                    }
+                    for (auto& other: it->second) {
+                        if (edgeSortItem::edgeEqual(item, other)) {
+                            duplicate = true;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+        if (!duplicate) {
+            grid[key].push_back(item);
+            result.push_back(e);
         }
     }
     return result;
@@ -74,7 +74,18 @@
 
 #include <limits>
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <iomanip>
+#include <memory>
+
+#include <QCryptographicHash>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+
+#include <Standard_Version.hxx>
 
 #include <App/Application.h>
 #include <App/Document.h>
@@ -86,6 +97,7 @@
 #include <Base/FileInfo.h>
 #include <Base/Parameter.h>
 #include <Mod/Part/App/PartFeature.h>
+#include <Mod/Part/App/ShapeCache.h>
 #include <Mod/Part/App/TopoShape.h>
 
 #include "DrawUtil.h"
@@ -100,6 +112,7 @@
 #include "DrawViewBalloon.h"
 #include "DrawViewDetail.h"
 #include "DrawPage.h"
+#include "DrawProjGroupItem.h"
 #include "EdgeWalker.h"
 #include "LineGroup.h"
 #include "Cosmetic.h"
@@ -109,6 +122,95 @@
 using namespace TechDraw;
 using namespace std;
 
+namespace {
+
+//! HLR of a view computed ahead of its execute(), see DrawViewPart::prefetchProjections()
+struct ProjectionTask
+{
+    std::string key;
+    TopoDS_Shape shape;                 //scaled, mirrored and rotated source shape
+    Base::Vector3d centroid;
+    gp_Ax2 viewAxis;
+    int isoCount = 0;
+    bool isPersp = false;
+    double focus = 100.0;
+    bool fromCache = false;
+    std::atomic<bool> claimed{false};   //set by whoever computes the result
+    QSemaphore done;
+    TechDrawGeometry::HLRResult result;
+
+    void compute() {
+        TechDrawGeometry::GeometryObject::computeHLR(shape, viewAxis, isoCount, isPersp, focus, result);
+    }
+};
+
+class ProjectionRunnable : public QRunnable
+{
+public:
+    ProjectionRunnable(const std::shared_ptr<ProjectionTask>& t)
+        :task(t)
+    {}
+    virtual void run() {
+        if (!task->claimed.exchange(true)) {
+            task->compute();
+            task->done.release();
+        }
+    }
+private:
+    std::shared_ptr<ProjectionTask> task;
+};
+
+//only accessed from the document thread
+std::map<const DrawViewPart*, std::shared_ptr<ProjectionTask> > _ProjectionTasks;
+
+QThreadPool& projectionPool()
+{
+    static QThreadPool pool;
+    return pool;
+}
+
+Base::Reference<ParameterGrp> getParameters()
+{
+    return App::GetApplication().GetUserParameter().GetGroup("BaseApp")->
+                                 GetGroup("Preferences")->GetGroup("Mod/TechDraw/General");
+}
+
+//number of threads used for projecting the views of a page, 1 disables prefetching
+int getProjectionThreads()
+{
+    int threads = getParameters()->GetInt("ProjectionThreads", 1);
+    if (threads <= 0) {
+        threads = QThread::idealThreadCount();
+    }
+    return threads;
+}
+
+//cache the HLR results with Part::ShapeCache
+bool useHLRCache()
+{
+    return getParameters()->GetBool("HLRCache", false);
+}
+
+bool restoreHLR(const std::string& key, TechDrawGeometry::HLRResult& result)
+{
+    TopoDS_Shape shape;
+    if (!Part::ShapeCache::instance().restoreShape(key, shape)) {
+        return false;
+    }
+    return result.fromShape(shape);
+}
+
+void storeHLR(const std::string& key, const TechDrawGeometry::HLRResult& result)
+{
+    if (result.hlrFailed || result.extractFailed ||
+        !result.hlrError.empty() || !result.extractError.empty()) {
+        return;
+    }
+    Part::ShapeCache::instance().storeShape(key, result.toShape());
+}
+
+}
+
 
 //===========================================================================
 // DrawViewPart
@@ -165,6 +267,11 @@ DrawViewPart::DrawViewPart(void) :
 
 DrawViewPart::~DrawViewPart()
 {
+    auto it = _ProjectionTasks.find(this);
+    if (it != _ProjectionTasks.end()) {
+        it->second->claimed = true;
+        _ProjectionTasks.erase(it);
+    }
     delete geometryObject;
 }
 
@@ -313,37 +420,70 @@ App::DocumentObjectExecReturn *DrawViewPart::execute(void)
         return App::DocumentObject::StdReturn;
     }
 
-    TopoDS_Shape shape = getSourceShape();          //if shape is null, it is probably(?) obj creation time.
-    if (shape.IsNull()) {
-        if (isRestoring) {
-            Base::Console().Warning("DVP::execute - source shape is invalid - (but document is restoring) - %s\n",
-                                getNameInDocument());
-        } else {
-            Base::Console().Error("Error: DVP::execute - Source shape is Null. - %s\n",
-                                  getNameInDocument());
+    //the HLR of the view may have been prefetched on a worker thread, or be in the cache
+    std::string projectionKey;
+    std::shared_ptr<ProjectionTask> task;
+    if (!CoarseView.getValue() &&
+        (getProjectionThreads() > 1 || useHLRCache())) {
+        projectionKey = getProjectionKey();
+        auto it = _ProjectionTasks.find(this);
+        if (it != _ProjectionTasks.end()) {
+            if (it->second->key == projectionKey) {
+                task = it->second;
+            } else {
+                it->second->claimed = true;
+            }
+            _ProjectionTasks.erase(it);
         }
-        return App::DocumentObject::StdReturn;
+        prefetchProjections();
     }
 
-    gp_Pnt inputCenter;
-    Base::Vector3d stdOrg(0.0,0.0,0.0);
-    
-    inputCenter = TechDrawGeometry::findCentroid(shape,
-                                                 getViewAxis(stdOrg,Direction.getValue()));
-                                                 
-    shapeCentroid = Base::Vector3d(inputCenter.X(),inputCenter.Y(),inputCenter.Z());
     TopoDS_Shape mirroredShape;
-    mirroredShape = TechDrawGeometry::mirrorShape(shape,
-                                                  inputCenter,
-                                                  getScale());
+    gp_Ax2 viewAxis;
+    if (task) {
+        mirroredShape = task->shape;
+        shapeCentroid = task->centroid;
+        viewAxis = task->viewAxis;
+    } else {
+        TopoDS_Shape shape = getSourceShape();          //if shape is null, it is probably(?) obj creation time.
+        if (shape.IsNull()) {
+            if (isRestoring) {
+                Base::Console().Warning("DVP::execute - source shape is invalid - (but document is restoring) - %s\n",
+                                    getNameInDocument());
+            } else {
+                Base::Console().Error("Error: DVP::execute - Source shape is Null. - %s\n",
+                                      getNameInDocument());
+            }
+            return App::DocumentObject::StdReturn;
+        }
+        mirroredShape = prepareShape(shape, shapeCentroid, viewAxis);
+    }
 
-    gp_Ax2 viewAxis = getViewAxis(shapeCentroid,Direction.getValue());
-    if (!DrawUtil::fpCompare(Rotation.getValue(),0.0)) {
-        mirroredShape = TechDrawGeometry::rotateShape(mirroredShape,
-                                                      viewAxis,
-                                                      Rotation.getValue());
-     }
-    geometryObject =  buildGeometryObject(mirroredShape,viewAxis);
+    if (projectionKey.empty()) {
+        geometryObject =  buildGeometryObject(mirroredShape,viewAxis);
+    } else {
+        if (!task) {
+            task = std::make_shared<ProjectionTask>();
+            task->fromCache = useHLRCache() && restoreHLR(projectionKey, task->result);
+            task->claimed = true;
+            if (!task->fromCache) {
+                task->shape = mirroredShape;
+                task->viewAxis = viewAxis;
+                task->isoCount = IsoCount.getValue();
+                task->isPersp = Perspective.getValue();
+                task->focus = Focus.getValue();
+                task->compute();
+            }
+        } else if (!task->claimed.exchange(true)) {
+            task->compute();            //not picked up by the pool yet
+        } else if (!task->fromCache) {
+            task->done.acquire();
+        }
+        if (!task->fromCache && useHLRCache()) {
+            storeHLR(projectionKey, task->result);
+        }
+        geometryObject =  buildGeometryObject(mirroredShape,viewAxis,&task->result);
+    }
 
 #if MOD_TECHDRAW_HANDLE_FACES
     auto start = std::chrono::high_resolution_clock::now();
@@ -418,7 +558,8 @@ void DrawViewPart::onChanged(const App::Property* prop)
 }
 
 //note: slightly different than routine with same name in DrawProjectSplit
-TechDrawGeometry::GeometryObject* DrawViewPart::buildGeometryObject(TopoDS_Shape shape, gp_Ax2 viewAxis)
+TechDrawGeometry::GeometryObject* DrawViewPart::buildGeometryObject(TopoDS_Shape shape, gp_Ax2 viewAxis,
+                                                                   const TechDrawGeometry::HLRResult* hlr)
 {
 //    Base::Console().Message("DVP::buildGO() - %s\n", getNameInDocument());
     TechDrawGeometry::GeometryObject* go = new TechDrawGeometry::GeometryObject(getNameInDocument(), this);
@@ -434,6 +575,9 @@ TechDrawGeometry::GeometryObject* DrawViewPart::buildGeometryObject(TopoDS_Shape
         go->projectShapeWithPolygonAlgo(shape,
             viewAxis);
     }
+    else if (hlr != nullptr) {
+        go->setHLRResult(*hlr);
+    }
     else{
         go->projectShape(shape,
             viewAxis);
@@ -488,6 +632,158 @@ TechDrawGeometry::GeometryObject* DrawViewPart::buildGeometryObject(TopoDS_Shape
     return go;
 }
 
+//! scale, mirror and rotate the source shape for projection
+TopoDS_Shape DrawViewPart::prepareShape(const TopoDS_Shape& shape, Base::Vector3d& centroid, gp_Ax2& viewAxis) const
+{
+    gp_Pnt inputCenter;
+    Base::Vector3d stdOrg(0.0,0.0,0.0);
+
+    inputCenter = TechDrawGeometry::findCentroid(shape,
+                                                 getViewAxis(stdOrg,Direction.getValue()));
+
+    centroid = Base::Vector3d(inputCenter.X(),inputCenter.Y(),inputCenter.Z());
+    TopoDS_Shape mirroredShape;
+    mirroredShape = TechDrawGeometry::mirrorShape(shape,
+                                                  inputCenter,
+                                                  getScale());
+
+    viewAxis = getViewAxis(centroid,Direction.getValue());
+    if (!DrawUtil::fpCompare(Rotation.getValue(),0.0)) {
+        mirroredShape = TechDrawGeometry::rotateShape(mirroredShape,
+                                                      viewAxis,
+                                                      Rotation.getValue());
+    }
+    return mirroredShape;
+}
+
+//! hash of everything the HLR of this view depends on: the content of the
+//! source shapes and the projection parameters
+std::string DrawViewPart::getProjectionKey(void) const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    auto addData = [&hash](const std::string& s) {
+        hash.addData(s.c_str(), (int)s.size()+1);
+    };
+
+    Base::Vector3d stdOrg(0.0,0.0,0.0);
+    gp_Ax2 viewAxis = getViewAxis(stdOrg,Direction.getValue());
+    const gp_Dir& dir = viewAxis.Direction();
+    const gp_Dir& xDir = viewAxis.XDirection();
+    std::ostringstream ss;
+    ss << std::setprecision(17) << "TechDraw HLR " << OCC_VERSION_HEX
+       << ' ' << dir.X() << ' ' << dir.Y() << ' ' << dir.Z()
+       << ' ' << xDir.X() << ' ' << xDir.Y() << ' ' << xDir.Z()
+       << ' ' << getScale() << ' ' << Rotation.getValue()
+       << ' ' << IsoCount.getValue() << ' ' << Perspective.getValue()
+       << ' ' << Focus.getValue();
+    addData(ss.str());
+
+    for (auto& l: Source.getValues()) {
+        auto feature = dynamic_cast<Part::Feature*>(l);
+        if (feature != nullptr) {
+            addData(feature->getShapeContentKey());
+            continue;
+        }
+        std::vector<TopoDS_Shape> shapes;
+        TopoDS_Shape shape = Part::Feature::getShape(l);
+        if (!shape.IsNull()) {
+            shapes.push_back(shape);
+        } else {
+            shapes = getShapesFromObject(l);
+        }
+        for (auto& s: shapes) {
+            if (!s.IsNull()) {
+                addData(Part::ShapeCache::hashShape(Part::TopoShape(s)));
+            }
+        }
+    }
+    return hash.result().toHex().constData();
+}
+
+//! start the HLR of the other views on the page that are about to be
+//! recomputed on worker threads. Their execute() picks up the result.
+void DrawViewPart::prefetchProjections(void)
+{
+    //drop the tasks of views that were not recomputed after all
+    for (auto it = _ProjectionTasks.begin(); it != _ProjectionTasks.end(); ) {
+        if (!it->first->isTouched() && !it->first->mustExecute()) {
+            it->second->claimed = true;
+            it = _ProjectionTasks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    int threads = getProjectionThreads();
+    DrawPage* page = findParentPage();
+    if ((threads <= 1) || (page == nullptr)) {
+        return;
+    }
+    bool useCache = useHLRCache();
+    QThreadPool& pool = projectionPool();
+    pool.setMaxThreadCount(threads - 1);           //this thread does its share
+
+    auto start = std::chrono::high_resolution_clock::now();
+    int count = 0;
+    for (auto& obj: page->getAllViews()) {
+        if ((obj == this) ||
+            ((obj->getTypeId() != DrawViewPart::getClassTypeId()) &&
+             (obj->getTypeId() != DrawProjGroupItem::getClassTypeId()))) {
+            continue;                               //Sections, Details etc project their own shapes
+        }
+        auto view = static_cast<DrawViewPart*>(obj);
+        if (_ProjectionTasks.count(view) ||
+            view->CoarseView.getValue() ||
+            !view->keepUpdated() ||
+            !(view->isTouched() || view->mustExecute())) {
+            continue;
+        }
+        auto item = dynamic_cast<DrawProjGroupItem*>(view);
+        if ((item != nullptr) &&
+            DrawUtil::checkParallel(item->Direction.getValue(),
+                                    item->RotationVector.getValue())) {
+            continue;
+        }
+        const std::vector<App::DocumentObject*>& links = view->Source.getValues();
+        bool ready = !links.empty();
+        for (auto& l: links) {
+            if (l->isTouched() || l->mustExecute()) {
+                ready = false;                      //source not recomputed yet
+                break;
+            }
+        }
+        if (!ready) {
+            continue;
+        }
+        TopoDS_Shape shape = view->getSourceShape();
+        if (shape.IsNull()) {
+            continue;
+        }
+
+        auto task = std::make_shared<ProjectionTask>();
+        task->key = view->getProjectionKey();
+        task->shape = view->prepareShape(shape, task->centroid, task->viewAxis);
+        task->isoCount = view->IsoCount.getValue();
+        task->isPersp = view->Perspective.getValue();
+        task->focus = view->Focus.getValue();
+        if (useCache && restoreHLR(task->key, task->result)) {
+            task->fromCache = true;
+            task->claimed = true;
+            task->done.release();
+        } else {
+            pool.start(new ProjectionRunnable(task));
+            ++count;
+        }
+        _ProjectionTasks[view] = task;
+    }
+
+    auto end   = std::chrono::high_resolution_clock::now();
+    auto diff  = end - start;
+    double diffOut = std::chrono::duration <double, std::milli> (diff).count();
+    Base::Console().Log("TIMING - %s DVP spent: %.3f millisecs starting %d projections on %d threads\n",
+                        getNameInDocument(),diffOut,count,threads);
+}
+
 //! make faces from the existing edge geometry
 void DrawViewPart::extractFaces()
 {
@@ -511,72 +807,27 @@ void DrawViewPart::extractFaces()
         }
     }
     faceEdges = nonZero;
-    origEdges = nonZero;
+
+    //log the time spent in each stage
+    auto start = std::chrono::high_resolution_clock::now();
+    auto logStage = [&](const char* stage, std::size_t count) {
+        auto end = std::chrono::high_resolution_clock::now();
+        double diffOut = std::chrono::duration <double, std::milli> (end - start).count();
+        Base::Console().Log("TIMING - %s DVP spent: %.3f millisecs in extractFaces %s (%lu)\n",
+                            getNameInDocument(), diffOut, stage, (unsigned long) count);
+        start = end;
+    };
 
     //HLR algo does not provide all edge intersections for edge endpoints.
     //need to split long edges touched by Vertex of another edge
-    std::vector<splitPoint> splits;
-    std::vector<TopoDS_Edge>::iterator itOuter = origEdges.begin();
-    int iOuter = 0;
-    for (; itOuter != origEdges.end(); ++itOuter, iOuter++) {
-        TopoDS_Vertex v1 = TopExp::FirstVertex((*itOuter));
-        TopoDS_Vertex v2 = TopExp::LastVertex((*itOuter));
-        Bnd_Box sOuter;
-        BRepBndLib::Add(*itOuter, sOuter);
-        sOuter.SetGap(0.1);
-        if (sOuter.IsVoid()) {
-            Base::Console().Message("DVP::Extract Faces - outer Bnd_Box is void for %s\n",getNameInDocument());
-            continue;
-        }
-        if (DrawUtil::isZeroEdge(*itOuter)) {
-            Base::Console().Message("DVP::extractFaces - outerEdge: %d is ZeroEdge\n",iOuter);   //this is not finding ZeroEdges
-            continue;  //skip zero length edges. shouldn't happen ;)
-        }
-        int iInner = 0;
-        std::vector<TopoDS_Edge>::iterator itInner = faceEdges.begin();
-        for (; itInner != faceEdges.end(); ++itInner,iInner++) {
-            if (iInner == iOuter) {
-                continue;
-            }
-            if (DrawUtil::isZeroEdge((*itInner))) {
-                continue;  //skip zero length edges. shouldn't happen ;)
-            }
-
-            Bnd_Box sInner;
-            BRepBndLib::Add(*itInner, sInner);
-            sInner.SetGap(0.1);
-            if (sInner.IsVoid()) {
-                Base::Console().Log("INFO - DVP::Extract Faces - inner Bnd_Box is void for %s\n",getNameInDocument());
-                continue;
-            }
-            if (sOuter.IsOut(sInner)) {      //bboxes of edges don't intersect, don't bother
-                continue;
-            }
-
-            double param = -1;
-            if (DrawProjectSplit::isOnEdge((*itInner),v1,param,false)) {
-                gp_Pnt pnt1 = BRep_Tool::Pnt(v1);
-                splitPoint s1;
-                s1.i = iInner;
-                s1.v = Base::Vector3d(pnt1.X(),pnt1.Y(),pnt1.Z());
-                s1.param = param;
-                splits.push_back(s1);
-            }
-            if (DrawProjectSplit::isOnEdge((*itInner),v2,param,false)) {
-                gp_Pnt pnt2 = BRep_Tool::Pnt(v2);
-                splitPoint s2;
-                s2.i = iInner;
-                s2.v = Base::Vector3d(pnt2.X(),pnt2.Y(),pnt2.Z());
-                s2.param = param;
-                splits.push_back(s2);
-            }
-        } //inner loop
-    }   //outer loop
+    std::vector<splitPoint> splits = DrawProjectSplit::findSplits(faceEdges);
+    logStage("finding splits", splits.size());
 
     std::vector<splitPoint> sorted = DrawProjectSplit::sortSplits(splits,true);
     auto last = std::unique(sorted.begin(), sorted.end(), DrawProjectSplit::splitEqual);  //duplicates to back
     sorted.erase(last, sorted.end());                         //remove dupl splits
     std::vector<TopoDS_Edge> newEdges = DrawProjectSplit::splitEdges(faceEdges,sorted);
+    logStage("splitting edges", newEdges.size());
 
     if (newEdges.empty()) {
         Base::Console().Log("LOG - DVP::extractFaces - no newEdges\n");
@@ -584,6 +835,7 @@ void DrawViewPart::extractFaces()
     }
 
     newEdges = DrawProjectSplit::removeDuplicateEdges(newEdges);        //<<< here
+    logStage("removing duplicate edges", newEdges.size());
 
 //find all the wires in the pile of faceEdges
     EdgeWalker ew;
@@ -596,6 +848,7 @@ void DrawViewPart::extractFaces()
     std::vector<TopoDS_Wire> fw = ew.getResultNoDups();
 
     std::vector<TopoDS_Wire> sortedWires = ew.sortStrip(fw,true);
+    logStage("walking edges", sortedWires.size());
 
     std::vector<TopoDS_Wire>::iterator itWire = sortedWires.begin();
     for (; itWire != sortedWires.end(); itWire++) {
@@ -55,6 +55,7 @@ class Part;
 namespace TechDrawGeometry
 {
 class GeometryObject;
+struct HLRResult;
 class Vertex;
 class BaseGeom;
 class Face;
@@ -192,9 +193,15 @@ protected:
     void onChanged(const App::Property* prop);
     virtual void unsetupObject();
 
-    virtual TechDrawGeometry::GeometryObject*  buildGeometryObject(TopoDS_Shape shape, gp_Ax2 viewAxis);
+    virtual TechDrawGeometry::GeometryObject*  buildGeometryObject(TopoDS_Shape shape, gp_Ax2 viewAxis,
+                                                                   const TechDrawGeometry::HLRResult* hlr = nullptr);
     void extractFaces();
 
+    //Projection of the source shape
+    TopoDS_Shape prepareShape(const TopoDS_Shape& shape, Base::Vector3d& centroid, gp_Ax2& viewAxis) const;
+    std::string getProjectionKey(void) const;
+    void prefetchProjections(void);
+
     //Projection parameter space
     virtual void saveParamSpace(const Base::Vector3d& direction, const Base::Vector3d& xAxis=Base::Vector3d(0.0,0.0,0.0));
     Base::Vector3d uDir;                       //paperspace X
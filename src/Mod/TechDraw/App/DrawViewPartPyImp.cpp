@@ -1,7 +1,12 @@
 
 #include "PreCompiled.h"
 
+#include <CXX/Objects.hxx>
+#include <Base/VectorPy.h>
+#include <Mod/Part/App/TopoShapeEdgePy.h>
+
 #include "DrawViewPart.h"
+#include "Geometry.h"
 
 // inclusion of the generated files (generated out of DrawViewPartPy.xml)
 #include <Mod/TechDraw/App/DrawViewPartPy.h>
@@ -24,6 +29,68 @@ PyObject* DrawViewPartPy::clearCV(PyObject *args)
     return Py_None;
 }
 
+namespace {
+
+PyObject* getEdges(DrawViewPart* dvp, bool visible)
+{
+    Py::List result;
+    if (dvp->hasGeometry()) {
+        for (auto& geom: dvp->getEdgeGeometry()) {
+            if (geom->visible == visible) {
+                result.append(Py::asObject(new Part::TopoShapeEdgePy(new Part::TopoShape(geom->occEdge))));
+            }
+        }
+    }
+    return Py::new_reference_to(result);
+}
+
+PyObject* getVertexes(DrawViewPart* dvp, bool visible)
+{
+    Py::List result;
+    if (dvp->hasGeometry()) {
+        for (auto& vert: dvp->getVertexGeometry()) {
+            if (vert->visible == visible) {
+                result.append(Py::asObject(new Base::VectorPy(vert->getAs3D())));
+            }
+        }
+    }
+    return Py::new_reference_to(result);
+}
+
+}
+
+PyObject* DrawViewPartPy::getVisibleEdges(PyObject *args)
+{
+    if (!PyArg_ParseTuple(args, "")) {
+        return 0;
+    }
+    return getEdges(getDrawViewPartPtr(), true);
+}
+
+PyObject* DrawViewPartPy::getHiddenEdges(PyObject *args)
+{
+    if (!PyArg_ParseTuple(args, "")) {
+        return 0;
+    }
+    return getEdges(getDrawViewPartPtr(), false);
+}
+
+PyObject* DrawViewPartPy::getVisibleVertexes(PyObject *args)
+{
+    if (!PyArg_ParseTuple(args, "")) {
+        return 0;
+    }
+    return getVertexes(getDrawViewPartPtr(), true);
+}
+
+PyObject* DrawViewPartPy::getHiddenVertexes(PyObject *args)
+{
+    if (!PyArg_ParseTuple(args, "")) {
+        return 0;
+    }
+    return getVertexes(getDrawViewPartPtr(), false);
+}
+
 PyObject *DrawViewPartPy::getCustomAttributes(const char* /*attr*/) const
 {
     return 0;
@@ -23,6 +23,7 @@
 #include "PreCompiled.h"
 #ifndef _PreComp_
 
+#include <BRep_Builder.hxx>
 #include <BRep_Tool.hxx>
 #include <BRepMesh_IncrementalMesh.hxx>
 #include <BRepLib.hxx>
@@ -54,6 +55,8 @@
 
 #include <TopoDS.hxx>
 #include <TopoDS_Shape.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Iterator.hxx>
 #include <TopoDS_Vertex.hxx>
 #include <TopoDS_Edge.hxx>
 #include <TopoDS_Wire.hxx>
@@ -163,17 +166,26 @@ void GeometryObject::projectShape(const TopoDS_Shape& input,
                                   const gp_Ax2 viewAxis)
 {
 //    Base::Console().Message("GO::projectShape()\n");
-   // Clear previous Geometry
-    clear();
+    HLRResult result;
+    computeHLR(input, viewAxis, m_isoCount, m_isPersp, m_focus, result);
+    setHLRResult(result);
+}
 
+void GeometryObject::computeHLR(const TopoDS_Shape& input,
+                                const gp_Ax2 viewAxis,
+                                int isoCount,
+                                bool isPersp,
+                                double focus,
+                                HLRResult& result)
+{
     auto start = chrono::high_resolution_clock::now();
 
     Handle(HLRBRep_Algo) brep_hlr = NULL;
     try {
         brep_hlr = new HLRBRep_Algo();
-        brep_hlr->Add(input, m_isoCount);
-        if (m_isPersp) {
-            double fLength = std::max(Precision::Confusion(),m_focus);
+        brep_hlr->Add(input, isoCount);
+        if (isPersp) {
+            double fLength = std::max(Precision::Confusion(),focus);
 //            HLRAlgo_Projector projector( projAxis, fLength );
             HLRAlgo_Projector projector( viewAxis, fLength );
             brep_hlr->Projector(projector);
@@ -186,58 +198,124 @@ void GeometryObject::projectShape(const TopoDS_Shape& input,
         brep_hlr->Hide();
 
     }
-    catch (Standard_Failure e) {
-        Base::Console().Error("GO::projectShape - OCC error - %s - while projecting shape\n",
-                              e.GetMessageString());
-        }
+    catch (Standard_Failure& e) {
+        result.hlrError = e.GetMessageString();
+    }
     catch (...) {
-        throw Base::RuntimeError("GeometryObject::projectShape - unknown error occurred while projecting shape");
-//        Standard_Failure::Raise("GeometryObject::projectShape - error occurred while projecting shape");
+        result.hlrFailed = true;
+        return;
     }
     auto end   = chrono::high_resolution_clock::now();
     auto diff  = end - start;
-    double diffOut = chrono::duration <double, milli> (diff).count();
-    Base::Console().Log("TIMING - %s GO spent: %.3f millisecs in HLRBRep_Algo & co\n",m_parentName.c_str(),diffOut);
+    result.hlrTime = chrono::duration <double, milli> (diff).count();
 
     start = chrono::high_resolution_clock::now();
 
     try {
         HLRBRep_HLRToShape hlrToShape(brep_hlr);
 
-        visHard    = hlrToShape.VCompound();
-        visSmooth  = hlrToShape.Rg1LineVCompound();
-        visSeam    = hlrToShape.RgNLineVCompound();
-        visOutline = hlrToShape.OutLineVCompound();
-        visIso     = hlrToShape.IsoLineVCompound();
-        hidHard    = hlrToShape.HCompound();
-        hidSmooth  = hlrToShape.Rg1LineHCompound();
-        hidSeam    = hlrToShape.RgNLineHCompound();
-        hidOutline = hlrToShape.OutLineHCompound();
-        hidIso     = hlrToShape.IsoLineHCompound();
+        result.visHard    = hlrToShape.VCompound();
+        result.visSmooth  = hlrToShape.Rg1LineVCompound();
+        result.visSeam    = hlrToShape.RgNLineVCompound();
+        result.visOutline = hlrToShape.OutLineVCompound();
+        result.visIso     = hlrToShape.IsoLineVCompound();
+        result.hidHard    = hlrToShape.HCompound();
+        result.hidSmooth  = hlrToShape.Rg1LineHCompound();
+        result.hidSeam    = hlrToShape.RgNLineHCompound();
+        result.hidOutline = hlrToShape.OutLineHCompound();
+        result.hidIso     = hlrToShape.IsoLineHCompound();
 
 //need these 3d curves to prevent "zero edges" later
-        BRepLib::BuildCurves3d(visHard);
-        BRepLib::BuildCurves3d(visSmooth);
-        BRepLib::BuildCurves3d(visSeam);
-        BRepLib::BuildCurves3d(visOutline);
-        BRepLib::BuildCurves3d(visIso);
-        BRepLib::BuildCurves3d(hidHard);
-        BRepLib::BuildCurves3d(hidSmooth);
-        BRepLib::BuildCurves3d(hidSeam);
-        BRepLib::BuildCurves3d(hidOutline);
-        BRepLib::BuildCurves3d(hidIso);
-    }
-    catch (Standard_Failure e) {
-        Base::Console().Error("GO::projectShape - OCC error - %s - while extracting edges\n",
-                              e.GetMessageString());
+        BRepLib::BuildCurves3d(result.visHard);
+        BRepLib::BuildCurves3d(result.visSmooth);
+        BRepLib::BuildCurves3d(result.visSeam);
+        BRepLib::BuildCurves3d(result.visOutline);
+        BRepLib::BuildCurves3d(result.visIso);
+        BRepLib::BuildCurves3d(result.hidHard);
+        BRepLib::BuildCurves3d(result.hidSmooth);
+        BRepLib::BuildCurves3d(result.hidSeam);
+        BRepLib::BuildCurves3d(result.hidOutline);
+        BRepLib::BuildCurves3d(result.hidIso);
+    }
+    catch (Standard_Failure& e) {
+        result.extractError = e.GetMessageString();
     }
     catch (...) {
-        throw Base::RuntimeError("GeometryObject::projectShape - error occurred while extracting edges");
+        result.extractFailed = true;
+        return;
     }
     end   = chrono::high_resolution_clock::now();
     diff  = end - start;
-    diffOut = chrono::duration <double, milli> (diff).count();
-    Base::Console().Log("TIMING - %s GO spent: %.3f millisecs in hlrToShape and BuildCurves\n",m_parentName.c_str(),diffOut);
+    result.extractTime = chrono::duration <double, milli> (diff).count();
+}
+
+void GeometryObject::setHLRResult(const HLRResult& result)
+{
+   // Clear previous Geometry
+    clear();
+
+    if (!result.hlrError.empty()) {
+        Base::Console().Error("GO::projectShape - OCC error - %s - while projecting shape\n",
+                              result.hlrError.c_str());
+    }
+    if (result.hlrFailed) {
+        throw Base::RuntimeError("GeometryObject::projectShape - unknown error occurred while projecting shape");
+    }
+    Base::Console().Log("TIMING - %s GO spent: %.3f millisecs in HLRBRep_Algo & co\n",m_parentName.c_str(),result.hlrTime);
+
+    visHard    = result.visHard;
+    visSmooth  = result.visSmooth;
+    visSeam    = result.visSeam;
+    visOutline = result.visOutline;
+    visIso     = result.visIso;
+    hidHard    = result.hidHard;
+    hidSmooth  = result.hidSmooth;
+    hidSeam    = result.hidSeam;
+    hidOutline = result.hidOutline;
+    hidIso     = result.hidIso;
+
+    if (!result.extractError.empty()) {
+        Base::Console().Error("GO::projectShape - OCC error - %s - while extracting edges\n",
+                              result.extractError.c_str());
+    }
+    if (result.extractFailed) {
+        throw Base::RuntimeError("GeometryObject::projectShape - error occurred while extracting edges");
+    }
+    Base::Console().Log("TIMING - %s GO spent: %.3f millisecs in hlrToShape and BuildCurves\n",m_parentName.c_str(),result.extractTime);
+}
+
+TopoDS_Shape HLRResult::toShape(void) const
+{
+    BRep_Builder builder;
+    TopoDS_Compound comp;
+    builder.MakeCompound(comp);
+    for (auto& s: {visHard, visOutline, visSmooth, visSeam, visIso,
+                   hidHard, hidOutline, hidSmooth, hidSeam, hidIso}) {
+        if (s.IsNull()) {
+            //a null shape is stored as an empty compound
+            TopoDS_Compound empty;
+            builder.MakeCompound(empty);
+            builder.Add(comp, empty);
+        } else {
+            builder.Add(comp, s);
+        }
+    }
+    return comp;
+}
+
+bool HLRResult::fromShape(const TopoDS_Shape& shape)
+{
+    TopoDS_Shape* shapes[] = {&visHard, &visOutline, &visSmooth, &visSeam, &visIso,
+                              &hidHard, &hidOutline, &hidSmooth, &hidSeam, &hidIso};
+    int i = 0;
+    for (TopoDS_Iterator it(shape); it.More(); it.Next(), ++i) {
+        if (i >= 10) {
+            return false;
+        }
+        const TopoDS_Shape& child = it.Value();
+        *shapes[i] = TopoDS_Iterator(child).More() ? child : TopoDS_Shape();
+    }
+    return i == 10;
 }
 
 //!set up a hidden line remover and project a shape with it
@@ -81,6 +81,33 @@ gp_Ax2 TechDrawExport getViewAxis(const Base::Vector3d origin,
                                   const Base::Vector3d& xAxis,
                                   const bool flip=true);
 
+//! output of the hidden line removal of a shape, see GeometryObject::computeHLR
+struct TechDrawExport HLRResult
+{
+    TopoDS_Shape visHard;
+    TopoDS_Shape visOutline;
+    TopoDS_Shape visSmooth;
+    TopoDS_Shape visSeam;
+    TopoDS_Shape visIso;
+    TopoDS_Shape hidHard;
+    TopoDS_Shape hidOutline;
+    TopoDS_Shape hidSmooth;
+    TopoDS_Shape hidSeam;
+    TopoDS_Shape hidIso;
+
+    double hlrTime = 0.0;             //millisecs in HLRBRep_Algo & co
+    double extractTime = 0.0;         //millisecs in hlrToShape and BuildCurves
+    std::string hlrError;             //OCC error message while projecting
+    std::string extractError;         //OCC error message while extracting edges
+    bool hlrFailed = false;           //unknown error while projecting
+    bool extractFailed = false;       //unknown error while extracting edges
+
+    //! pack the HLR shapes into a compound of 10 compounds, for caching
+    TopoDS_Shape toShape(void) const;
+    //! unpack the HLR shapes from a compound made by toShape()
+    bool fromShape(const TopoDS_Shape& shape);
+};
+
 class TechDrawExport GeometryObject
 {
 public:
@@ -100,6 +127,16 @@ public:
 
     void projectShape(const TopoDS_Shape &input,
                       const gp_Ax2 viewAxis);
+    //! run the hidden line removal without touching any GeometryObject or
+    //! reporting anything, so that it can be called from a worker thread
+    static void computeHLR(const TopoDS_Shape &input,
+                           const gp_Ax2 viewAxis,
+                           int isoCount,
+                           bool isPersp,
+                           double focus,
+                           HLRResult& result);
+    //! use the result of computeHLR as the output of projectShape
+    void setHLRResult(const HLRResult& result);
     void projectShapeWithPolygonAlgo(const TopoDS_Shape &input,
                                      const gp_Ax2 viewAxis);
     
@@ -0,0 +1,177 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+# test script for TechDraw module
+# creates a page with several part views and a projection group
+# compares the projected geometry computed on one and on several threads
+# saves and reopens the page and compares the geometry restored from the HLR cache
+from __future__ import print_function
+
+import FreeCAD
+import Part
+import TechDraw
+import os
+import shutil
+import tempfile
+
+def makePage(docName):
+    path = os.path.dirname(os.path.abspath(__file__))
+    templateFileSpec = path + '/TestTemplate.svg'
+
+    doc = FreeCAD.newDocument(docName)
+    FreeCAD.setActiveDocument(docName)
+
+    box = doc.addObject("Part::Box","Box")
+    cyl = doc.addObject("Part::Cylinder","Cylinder")
+    cyl.Radius = 3.0
+    cyl.Height = 20.0
+    cyl.Placement.Base = FreeCAD.Vector(5.0, 5.0, -5.0)
+    cut = doc.addObject("Part::Cut","Cut")
+    cut.Base = box
+    cut.Tool = cyl
+    cyl2 = doc.addObject("Part::Cylinder","Cylinder2")
+
+    page = doc.addObject('TechDraw::DrawPage','Page')
+    doc.addObject('TechDraw::DrawSVGTemplate','Template')
+    doc.Template.Template = templateFileSpec
+    page.Template = doc.Template
+
+    view = doc.addObject('TechDraw::DrawViewPart','View')
+    page.addView(view)
+    view.Source = [box]
+
+    view = doc.addObject('TechDraw::DrawViewPart','ViewIso')
+    page.addView(view)
+    view.Source = [cut]
+    view.Direction = FreeCAD.Vector(1.0, 1.0, 1.0)
+    view.HardHidden = True
+
+    view = doc.addObject('TechDraw::DrawViewPart','ViewTop')
+    page.addView(view)
+    view.Source = [cyl2]
+    view.Direction = FreeCAD.Vector(0.0, 0.0, 1.0)
+
+    group = doc.addObject('TechDraw::DrawProjGroup','ProjGroup')
+    page.addView(group)
+    group.Source = [cut]
+    group.addProjection("Front")
+    group.Anchor.Direction = FreeCAD.Vector(0.0, 0.0, 1.0)
+    group.Anchor.RotationVector = FreeCAD.Vector(1.0, 0.0, 0.0)
+    group.addProjection("Top")
+    group.addProjection("Right")
+
+    doc.recompute()
+    return doc
+
+def getPartViews(doc):
+    return [v for v in doc.Objects if v.isDerivedFrom("TechDraw::DrawViewPart")]
+
+def getGeometry(doc):
+    result = dict()
+    for v in getPartViews(doc):
+        result[v.Name] = (sorted(round(e.Length, 6) for e in v.getVisibleEdges()),
+                          sorted(round(e.Length, 6) for e in v.getHiddenEdges()),
+                          sorted((round(p.x, 6), round(p.y, 6)) for p in v.getVisibleVertexes()),
+                          sorted((round(p.x, 6), round(p.y, 6)) for p in v.getHiddenVertexes()))
+    return result
+
+def compareGeometry(first, second):
+    rc = (sorted(first.keys()) == sorted(second.keys()))
+    for name in first.keys():
+        if not rc:
+            break
+        edges, hiddenEdges, vertexes, hiddenVertexes = first[name]
+        print("View: {} {} visible, {} hidden edges, {} visible, {} hidden vertexes".format(
+              name, len(edges), len(hiddenEdges), len(vertexes), len(hiddenVertexes)))
+        if not edges or not vertexes:
+            print("View {} has no geometry".format(name))
+            rc = False
+        elif first[name] != second[name]:
+            other = second[name]
+            print("View {} differs: {} visible, {} hidden edges, {} visible, {} hidden vertexes".format(
+                  name, len(other[0]), len(other[1]), len(other[2]), len(other[3])))
+            rc = False
+    return rc
+
+def recomputeViews(doc):
+    for v in getPartViews(doc):
+        v.touch()
+    doc.recompute()
+
+def DVProjectionThreadsTest():
+    hGrp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/TechDraw/General")
+    threads = hGrp.GetInt("ProjectionThreads", 1)
+    cache = hGrp.GetBool("HLRCache", False)
+    hGrp.SetBool("HLRCache", False)
+    try:
+        hGrp.SetInt("ProjectionThreads", 1)
+        doc = makePage("TDProjection")
+        serial = getGeometry(doc)
+
+        # the other views of the page are projected while the first one executes
+        hGrp.SetInt("ProjectionThreads", 4)
+        recomputeViews(doc)
+        parallel = getGeometry(doc)
+
+        rc = compareGeometry(serial, parallel)
+        FreeCAD.closeDocument(doc.Name)
+    finally:
+        hGrp.SetInt("ProjectionThreads", threads)
+        hGrp.SetBool("HLRCache", cache)
+    return rc
+
+def DVHLRCacheTest():
+    hGrp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/TechDraw/General")
+    threads = hGrp.GetInt("ProjectionThreads", 1)
+    cache = hGrp.GetBool("HLRCache", False)
+    # feature shapes are not cached, so the statistics count the HLR results only
+    pGrp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Part/General")
+    shapeCache = pGrp.GetBool("ShapeCache", False)
+    shapeCacheDir = pGrp.GetString("ShapeCacheDir", "")
+    tempDir = tempfile.mkdtemp()
+    cacheDir = os.path.join(tempDir, "cache")
+    try:
+        hGrp.SetInt("ProjectionThreads", 1)
+        hGrp.SetBool("HLRCache", True)
+        pGrp.SetBool("ShapeCache", False)
+        pGrp.SetString("ShapeCacheDir", cacheDir)
+        Part.getShapeCacheStats(True)
+
+        doc = makePage("TDHLRCache")
+        views = len(getPartViews(doc))
+        stats = Part.getShapeCacheStats(True)
+        print("Stores: {} Errors: {}".format(stats["Stores"], stats["Errors"]))
+        rc = (stats["Stores"] >= views) and (stats["Errors"] == 0)
+        computed = getGeometry(doc)
+
+        # unchanged views are taken from the cache
+        recomputeViews(doc)
+        stats = Part.getShapeCacheStats(True)
+        print("Hits: {} Misses: {} Stores: {}".format(stats["Hits"], stats["Misses"], stats["Stores"]))
+        rc = rc and (stats["Hits"] == views) and (stats["Misses"] == 0) and (stats["Stores"] == 0)
+        rc = compareGeometry(computed, getGeometry(doc)) and rc
+
+        fileName = os.path.join(tempDir, "TDHLRCache.FCStd")
+        doc.saveAs(fileName)
+        FreeCAD.closeDocument(doc.Name)
+
+        # the restored views are taken from the cache as well
+        doc = FreeCAD.openDocument(fileName)
+        Part.getShapeCacheStats(True)
+        recomputeViews(doc)
+        stats = Part.getShapeCacheStats(True)
+        print("Hits: {} Misses: {} Stores: {}".format(stats["Hits"], stats["Misses"], stats["Stores"]))
+        rc = rc and (stats["Hits"] == views) and (stats["Misses"] == 0) and (stats["Stores"] == 0)
+        rc = compareGeometry(computed, getGeometry(doc)) and rc
+        FreeCAD.closeDocument(doc.Name)
+    finally:
+        hGrp.SetInt("ProjectionThreads", threads)
+        hGrp.SetBool("HLRCache", cache)
+        pGrp.SetBool("ShapeCache", shapeCache)
+        pGrp.SetString("ShapeCacheDir", shapeCacheDir)
+        shutil.rmtree(tempDir)
+    return rc
+
+if __name__ == '__main__':
+    DVProjectionThreadsTest()
+    DVHLRCacheTest()
@@ -32,6 +32,7 @@ from TDTest.DVDimensionTest    import DVDimensionTest
 from TDTest.DVPartTest         import DVPartTest
 from TDTest.DVSectionTest      import DVSectionTest
 from TDTest.DVBalloonTest      import DVBalloonTest
+from TDTest.DVProjectionTest   import DVProjectionThreadsTest, DVHLRCacheTest
 
 #---------------------------------------------------------------------------
 # define the test cases to test the FreeCAD TechDraw module
@@ -94,3 +95,21 @@ class TechDrawTestCases(unittest.TestCase):
             print("TD DrawViewBalloon test passed")
         else:
             print("TD DrawViewBalloon test failed")
+
+    def testProjectionThreadsCase(self):
+        print("starting TD projection threads test")
+        rc = DVProjectionThreadsTest()
+        if rc:
+            print("TD projection threads test passed")
+        else:
+            print("TD projection threads test failed")
+        self.assertTrue(rc)
+
+    def testHLRCacheCase(self):
+        print("starting TD HLR cache test")
+        rc = DVHLRCacheTest()
+        if rc:
+            print("TD HLR cache test passed")
+        else:
+            print("TD HLR cache test failed")
+        self.assertTrue(rc)
@@ -608,6 +608,42 @@ class DocumentRecomputeCases(unittest.TestCase):
     self.Doc.removeObject(L7.Name)
     self.Doc.removeObject(L8.Name)
 
+  def testRecomputeImpact(self):
+    #    L1     L4
+    #   /  \
+    #  L2   L3
+    L4 = self.Doc.addObject("App::FeatureTest","Label_4")
+    self.L1.LinkList = [self.L2, self.L3]
+    self.Doc.recompute()
+
+    impact = self.Doc.getRecomputeImpact([(self.L2, "Integer")])
+    self.assertEqual([i[0] for i in impact], [self.L2, self.L1])
+    for obj, last, average, count in impact:
+      self.assertEqual(count, 1)
+      self.assertTrue(last >= 0.0)
+      self.assertEqual(last, average)
+
+    # the order of the result follows the recompute order
+    impact = self.Doc.getRecomputeImpact([(self.L1, "Integer"), (self.L3, "Integer"), (L4, "Integer")])
+    objs = [i[0] for i in impact]
+    self.assertEqual(len(objs), 3)
+    self.assertTrue(objs.index(self.L3) < objs.index(self.L1))
+
+    # output properties do not touch the owner, no recompute properties only
+    # touch the dependent objects
+    self.assertEqual(self.Doc.getRecomputeImpact([(self.L2, "TypeOutput")]), [])
+    impact = self.Doc.getRecomputeImpact([(self.L2, "TypeNoRecompute")])
+    self.assertEqual([i[0] for i in impact], [self.L1])
+
+    # the prediction matches the actual recompute
+    self.L2.Integer = 1
+    self.assertEqual(self.Doc.recompute(), 2)
+    impact = self.Doc.getRecomputeImpact([(self.L2, "Integer")])
+    self.assertEqual([i[3] for i in impact], [2, 2])
+
+    with self.assertRaises(AttributeError):
+      self.Doc.getRecomputeImpact([(self.L2, "NoSuchProperty")])
+
   def tearDown(self):
     #closing doc
     FreeCAD.closeDocument("RecomputeTests")
@@ -1393,11 +1429,156 @@ class DocumentExpressionCases(unittest.TestCase):
     # must not raise a topological error
     self.assertEqual(self.Doc.recompute(), 2)
 
+  def testIncrementalExecute(self):
+    param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Expression")
+    incremental = param.GetBool("IncrementalExecute", True)
+    try:
+      param.SetBool("IncrementalExecute", True)
+      self.Obj2.setExpression('Integer', u'%s.Integer + 1' % self.Obj1.Name)
+      self.Obj2.setExpression('Float', u'2.5')
+      self.Doc.recompute()
+      stats = self.Doc.getExpressionStats(True)
+      self.assertEqual(stats['evaluated'], 2)
+      self.assertEqual(stats['graphBuilds'], 1)
+
+      # only the expression depending on the changed input is evaluated
+      self.Obj1.Integer = 5
+      self.Doc.recompute()
+      self.assertEqual(self.Obj2.Integer, 6)
+      stats = self.Doc.getExpressionStats(True)
+      self.assertEqual(stats['evaluated'], 1)
+      self.assertEqual(stats['skipped'], 1)
+      self.assertEqual(stats['graphBuilds'], 0)
+
+      # a bound property changed by the user is evaluated again
+      self.Obj2.Float = 1.0
+      self.Doc.recompute()
+      self.assertEqual(self.Obj2.Float, 2.5)
+      stats = self.Doc.getExpressionStats(True)
+      self.assertEqual(stats['evaluated'], 1)
+      self.assertEqual(stats['skipped'], 1)
+
+      # changing an expression rebuilds the graph
+      self.Obj2.setExpression('Float', u'%s.Integer * 2.0' % self.Obj1.Name)
+      self.Doc.recompute()
+      self.assertEqual(self.Obj2.Float, 10)
+      stats = self.Doc.getExpressionStats(True)
+      self.assertEqual(stats['graphBuilds'], 1)
+
+      param.SetBool("IncrementalExecute", False)
+      self.Obj2.touch()
+      self.Doc.recompute()
+      stats = self.Doc.getExpressionStats(True)
+      self.assertEqual(stats['evaluated'], 2)
+      self.assertEqual(stats['skipped'], 0)
+    finally:
+      param.SetBool("IncrementalExecute", incremental)
+
+  def testIncrementalExecuteOwnerChange(self):
+    # the binding reads a property which the owner changes in its execute()
+    param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Expression")
+    incremental = param.GetBool("IncrementalExecute", True)
+    try:
+      param.SetBool("IncrementalExecute", True)
+      self.Obj1.setExpression('Float', u'ExecCount')
+      self.Obj2.setExpression('Integer', u'%s.Integer + 1' % self.Obj1.Name)
+      self.Doc.recompute()
+      count = self.Obj1.ExecCount
+      self.assertEqual(self.Obj1.Float, count - 1)
+
+      self.Obj1.Integer = 3
+      self.Doc.recompute()
+      self.assertEqual(self.Obj1.ExecCount, count + 1)
+      self.assertEqual(self.Obj1.Float, count)
+      self.assertEqual(self.Obj2.Integer, 4)
+
+      # the bindings of other objects are still skipped if their inputs
+      # are unchanged
+      self.Doc.getExpressionStats(True)
+      self.Obj2.touch()
+      self.Doc.recompute()
+      stats = self.Doc.getExpressionStats(True)
+      self.assertEqual(stats['skipped'], 1)
+    finally:
+      param.SetBool("IncrementalExecute", incremental)
+
   def tearDown(self):
     #closing doc
     FreeCAD.closeDocument(self.Doc.Name)
 
 
+class DocumentCompiledExpressionCases(unittest.TestCase):
+  # Representative expressions evaluated along a chain of objects, where '{0}'
+  # refers to the previous object in the chain
+  Expressions = [
+    ('Float', u'({0}.Float * 3 + 1) % 7 + {0}.Integer / 4'),
+    ('Integer', u'{0}.Integer // 2 + 3 * ({0}.Float > 3 and {0}.Integer != 0 ? 1 : 2)'),
+    ('Distance', u'{0}.Distance + 1.5 mm - sqrt(4 mm^2)'),
+    ('Angle', u'atan2({0}.Distance; 10 mm) + 2 deg'),
+    ('QuantityLength', u'hypot({0}.QuantityLength; 3 mm) * abs(cos({0}.Angle))'),
+  ]
+  Count = 200
+
+  def setUp(self):
+    self.Doc = FreeCAD.newDocument("CompiledExpression")
+    self.Param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Expression")
+    self.Compile = self.Param.GetBool("CompileExpression", False)
+    # evaluate all expressions on each recompute
+    self.Incremental = self.Param.GetBool("IncrementalExecute", True)
+    self.Param.SetBool("IncrementalExecute", False)
+    prev = self.Doc.addObject("App::FeatureTest","Test")
+    self.Objects = [prev]
+    for i in range(self.Count):
+      obj = self.Doc.addObject("App::FeatureTest","Test")
+      for prop,expr in self.Expressions:
+        obj.setExpression(prop, expr.format(prev.Name))
+      self.Objects.append(obj)
+      prev = obj
+
+  def recompute(self, compile):
+    self.Param.SetBool("CompileExpression", compile)
+    for obj in self.Objects:
+      obj.touch()
+    self.Doc.recompute()
+    return [[getattr(obj,prop) for prop,_ in self.Expressions] for obj in self.Objects]
+
+  def testCompiledExpression(self):
+    values1 = self.recompute(False)
+    values2 = self.recompute(True)
+    # the second compiled run reuses the programs and the resolved property slots
+    values3 = self.recompute(True)
+    self.assertEqual(values1, values2)
+    self.assertEqual(values1, values3)
+
+  def testCompiledSlotInvalidation(self):
+    self.Param.SetBool("CompileExpression", True)
+    obj1, obj2 = self.Objects[0], self.Objects[1]
+    obj1.addProperty("App::PropertyFloat","Foo")
+    obj1.Foo = 2
+    obj2.setExpression('Float', u'%s.Foo * 2' % obj1.Name)
+    self.Doc.recompute()
+    self.assertEqual(obj2.Float, 4)
+
+    # the resolved property is gone, and must not be accessed by the compiled expression
+    obj1.removeProperty("Foo")
+    obj1.addProperty("App::PropertyLength","Foo")
+    obj1.Foo = 3
+    obj2.touch()
+    self.Doc.recompute()
+    self.assertEqual(obj2.Float, 6)
+
+    # by label reference
+    obj1.Label = "Source"
+    obj2.setExpression('Float', u'<<Source>>.Foo + 1 mm')
+    self.Doc.recompute()
+    self.assertEqual(obj2.Float, 4)
+
+  def tearDown(self):
+    self.Param.SetBool("CompileExpression", self.Compile)
+    self.Param.SetBool("IncrementalExecute", self.Incremental)
+    FreeCAD.closeDocument(self.Doc.Name)
+
+
 class DocumentObserverCases(unittest.TestCase):
 
   class Observer():
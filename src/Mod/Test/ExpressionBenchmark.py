@@ -0,0 +1,93 @@
+#***************************************************************************
+#*   This file is part of the FreeCAD CAx development system.              *
+#*                                                                         *
+#*   This program is free software; you can redistribute it and/or modify  *
+#*   it under the terms of the GNU Lesser General Public License (LGPL)    *
+#*   as published by the Free Software Foundation; either version 2 of     *
+#*   the License, or (at your option) any later version.                   *
+#*   for detail see the LICENCE text file.                                 *
+#*                                                                         *
+#*   FreeCAD is distributed in the hope that it will be useful,            *
+#*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+#*   GNU Library General Public License for more details.                  *
+#*                                                                         *
+#*   You should have received a copy of the GNU Library General Public     *
+#*   License along with FreeCAD; if not, write to the Free Software        *
+#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+#*   USA                                                                   *
+#*                                                                         *
+#***************************************************************************/
+
+# Micro-benchmarks of the compiled expression evaluator against the tree
+# walker. They are not part of the unit tests, run them explicitly with
+#   FreeCAD -t ExpressionBenchmark
+
+import FreeCAD, unittest
+import time
+
+class ExpressionBenchmarkCases(unittest.TestCase):
+  # Representative expressions evaluated along a chain of objects, where '{0}'
+  # refers to the previous object in the chain
+  Expressions = [
+    ('Arithmetic', 'Float', u'({0}.Float * 3 + 1) % 7 + {0}.Integer / 4'),
+    ('Conditional', 'Integer', u'{0}.Integer // 2 + 3 * ({0}.Float > 3 and {0}.Integer != 0 ? 1 : 2)'),
+    ('Units', 'Distance', u'{0}.Distance + 1.5 mm - sqrt(4 mm^2)'),
+    ('Trigonometry', 'Angle', u'atan2({0}.Distance; 10 mm) + 2 deg'),
+    ('Functions', 'QuantityLength', u'hypot({0}.QuantityLength; 3 mm) * abs(cos({0}.Angle))'),
+  ]
+  Count = 2000
+  Repeat = 5
+
+  def setUp(self):
+    self.Doc = FreeCAD.newDocument("ExpressionBenchmark")
+    self.Param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Expression")
+    self.Compile = self.Param.GetBool("CompileExpression", False)
+    # evaluate all expressions on each recompute
+    self.Incremental = self.Param.GetBool("IncrementalExecute", True)
+    self.Param.SetBool("IncrementalExecute", False)
+
+  def tearDown(self):
+    self.Param.SetBool("CompileExpression", self.Compile)
+    self.Param.SetBool("IncrementalExecute", self.Incremental)
+    FreeCAD.closeDocument(self.Doc.Name)
+
+  def makeChain(self, expressions):
+    for obj in self.Doc.Objects:
+      self.Doc.removeObject(obj.Name)
+    prev = self.Doc.addObject("App::FeatureTest","Test")
+    objects = [prev]
+    for i in range(self.Count):
+      obj = self.Doc.addObject("App::FeatureTest","Test")
+      for _,prop,expr in expressions:
+        obj.setExpression(prop, expr.format(prev.Name))
+      objects.append(obj)
+      prev = obj
+    return objects
+
+  def recompute(self, objects, compile):
+    # best of several runs, the first compiled run includes compiling the programs
+    self.Param.SetBool("CompileExpression", compile)
+    best = None
+    for i in range(self.Repeat):
+      for obj in objects:
+        obj.touch()
+      start = time.time()
+      self.Doc.recompute()
+      t = time.time() - start
+      best = t if best is None else min(best, t)
+    return best
+
+  def report(self, name, objects, expressions):
+    count = len(objects) * len(expressions)
+    t1 = self.recompute(objects, False)
+    t2 = self.recompute(objects, True)
+    FreeCAD.Console.PrintMessage("%-14s %6d expressions: tree walker %8.0f/s, compiled %8.0f/s, speed-up %.2f\n"
+        % (name, count, count / max(t1, 1e-6), count / max(t2, 1e-6), t1 / max(t2, 1e-6)))
+
+  def testEachExpression(self):
+    for expr in self.Expressions:
+      self.report(expr[0], self.makeChain([expr]), [expr])
+
+  def testAllExpressions(self):
+    self.report("All", self.makeChain(self.Expressions), self.Expressions)
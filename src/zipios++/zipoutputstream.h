@@ -54,6 +54,11 @@ public:
   */
   void putNextEntry(const std::string& entryName);
 
+  /** Writes an entry with already deflated content. See
+      ZipOutputStreambuf::putDeflatedEntry(). */
+  void putDeflatedEntry( const std::string &entryName, const char *data, uint32 size,
+                         uint32 crc, uint32 uncompressed_size ) ;
+
   /** Sets the global comment for the Zip archive. */
   void setComment( const std::string& comment ) ;
 
@@ -49,6 +49,18 @@ public:
       entry. */
   void putNextEntry( const ZipCDirEntry &entry ) ;
 
+  /** Writes an entry whose content has already been deflated.
+      The current entry (if one is open) is closed first. The data
+      must be a raw deflate stream (i.e. without zlib header), as
+      produced by DeflateOutputStreambuf.
+      @param entry the entry to write.
+      @param data the deflated data.
+      @param size the size of the deflated data.
+      @param crc the CRC32 of the uncompressed data.
+      @param uncompressed_size the size of the uncompressed data. */
+  void putDeflatedEntry( const ZipCDirEntry &entry, const char *data, uint32 size,
+                         uint32 crc, uint32 uncompressed_size ) ;
+
   /** Sets the global comment for the Zip archive. */
   void setComment( const string &comment ) ;
 